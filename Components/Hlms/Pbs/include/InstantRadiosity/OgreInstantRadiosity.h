@@ -67,8 +67,11 @@ namespace Ogre
             size_t numVertices;
             size_t numIndices;
             bool   useIndices16bit;
+            /// Built from vertexData & indexData, to raycast against the triangles
+            TriangleBvh *bvh;
 
             float *getUvStart( uint8_t uvSet ) const;
+            void   buildBvh();
         };
 
         struct MaterialData
@@ -44,6 +44,7 @@ THE SOFTWARE.
 #include "OgreRay.h"
 #include "OgreSceneManager.h"
 #include "OgreTextureGpu.h"
+#include "OgreTriangleBvh.h"
 #include "Vao/OgreAsyncTicket.h"
 #include "Vao/OgreIndexBufferPacked.h"
 #include "Vao/OgreVertexArrayObject.h"
@@ -875,10 +876,12 @@ namespace Ogre
             {
                 meshData.indexDataConst =
                     reinterpret_cast<const uint8 *>( indexBuffer->getShadowCopy() ) +
-                    vao->getPrimitiveStart();
+                    vao->getPrimitiveStart() * indexBuffer->getBytesPerElement();
             }
         }
 
+        meshData.buildBvh();
+
         mMeshDataMapV2[vao] = meshData;
 
         return &mMeshDataMapV2[vao];
@@ -1005,6 +1008,8 @@ namespace Ogre
                     renderOp.indexData->indexCount * renderOp.indexData->indexBuffer->getIndexSize() );
         }
 
+        meshData.buildBvh();
+
         mMeshDataMapV1[renderOp] = meshData;
 
         return &mMeshDataMapV1[renderOp];
@@ -1183,98 +1188,90 @@ namespace Ogre
                                                   Matrix4 worldMatrix, const MaterialData &material,
                                                   const FastArray<size_t> &raysThatHitObj )
     {
-        const size_t numElements = meshData.indexData ? meshData.numIndices : meshData.numVertices;
-
         const uint16 *RESTRICT_ALIAS indexData16 =
             reinterpret_cast<const uint16 * RESTRICT_ALIAS>( meshData.indexData );
         const uint32 *RESTRICT_ALIAS indexData32 =
             reinterpret_cast<const uint32 * RESTRICT_ALIAS>( meshData.indexData );
 
-        for( size_t i = 0; i < numElements; i += 3 )
+        // Rays are taken to object space instead of transforming every triangle to world space.
+        // Their directions are not normalised, so distances stay in world units.
+        const Matrix4 invWorldMatrix = worldMatrix.inverseAffine();
+
+        FastArray<size_t>::const_iterator itRayIdx = raysThatHitObj.begin();
+        FastArray<size_t>::const_iterator enRayIdx = raysThatHitObj.end();
+        while( itRayIdx != enRayIdx )
         {
-            Vector3 triVerts[3];
+            RayHit &rayHit = mRayHits[*itRayIdx];
 
-            uint32 vertexIdx[3];
+            const Ray localRay( invWorldMatrix.transformAffine( rayHit.ray.getOrigin() ),
+                                invWorldMatrix.transformDirectionAffine( rayHit.ray.getDirection() ) );
 
-            if( meshData.indexData )
+            TriangleRayHit triHit;
+            if( meshData.bvh->raycast( localRay, std::min( rayHit.distance, lightRange ), true, false,
+                                       triHit ) )
             {
-                if( meshData.useIndices16bit )
+                const size_t i = triHit.triangleIdx * 3u;
+
+                uint32 vertexIdx[3];
+
+                if( meshData.indexData )
                 {
-                    vertexIdx[0] = indexData16[i + 0];
-                    vertexIdx[1] = indexData16[i + 1];
-                    vertexIdx[2] = indexData16[i + 2];
+                    if( meshData.useIndices16bit )
+                    {
+                        vertexIdx[0] = indexData16[i + 0];
+                        vertexIdx[1] = indexData16[i + 1];
+                        vertexIdx[2] = indexData16[i + 2];
+                    }
+                    else
+                    {
+                        vertexIdx[0] = indexData32[i + 0];
+                        vertexIdx[1] = indexData32[i + 1];
+                        vertexIdx[2] = indexData32[i + 2];
+                    }
                 }
                 else
                 {
-                    vertexIdx[0] = indexData32[i + 0];
-                    vertexIdx[1] = indexData32[i + 1];
-                    vertexIdx[2] = indexData32[i + 2];
+                    vertexIdx[0] = uint32( i + 0u );
+                    vertexIdx[1] = uint32( i + 1u );
+                    vertexIdx[2] = uint32( i + 2u );
                 }
-            }
-            else
-            {
-                vertexIdx[0] = uint32( i + 0u );
-                vertexIdx[1] = uint32( i + 1u );
-                vertexIdx[2] = uint32( i + 2u );
-            }
 
-            triVerts[0].x = meshData.vertexData[vertexIdx[0] * 3u + 0];
-            triVerts[0].y = meshData.vertexData[vertexIdx[0] * 3u + 1];
-            triVerts[0].z = meshData.vertexData[vertexIdx[0] * 3u + 2];
-            triVerts[1].x = meshData.vertexData[vertexIdx[1] * 3u + 0];
-            triVerts[1].y = meshData.vertexData[vertexIdx[1] * 3u + 1];
-            triVerts[1].z = meshData.vertexData[vertexIdx[1] * 3u + 2];
-            triVerts[2].x = meshData.vertexData[vertexIdx[2] * 3u + 0];
-            triVerts[2].y = meshData.vertexData[vertexIdx[2] * 3u + 1];
-            triVerts[2].z = meshData.vertexData[vertexIdx[2] * 3u + 2];
-
-            triVerts[0] = worldMatrix * triVerts[0];
-            triVerts[1] = worldMatrix * triVerts[1];
-            triVerts[2] = worldMatrix * triVerts[2];
-
-            Vector3 triNormal =
-                Math::calculateBasicFaceNormalWithoutNormalize( triVerts[0], triVerts[1], triVerts[2] );
-            triNormal.normalise();
-
-            FastArray<size_t>::const_iterator itRayIdx = raysThatHitObj.begin();
-            FastArray<size_t>::const_iterator enRayIdx = raysThatHitObj.end();
-            while( itRayIdx != enRayIdx )
-            {
-                Ray ray = mRayHits[*itRayIdx].ray;
+                Vector3 triVerts[3];
+                for( size_t j = 0; j < 3u; ++j )
+                {
+                    triVerts[j].x = meshData.vertexData[vertexIdx[j] * 3u + 0];
+                    triVerts[j].y = meshData.vertexData[vertexIdx[j] * 3u + 1];
+                    triVerts[j].z = meshData.vertexData[vertexIdx[j] * 3u + 2];
+                    triVerts[j] = worldMatrix * triVerts[j];
+                }
 
-                const std::pair<bool, Real> inters = Math::intersects(
-                    ray, triVerts[0], triVerts[1], triVerts[2], triNormal, true, false );
+                Vector3 triNormal = Math::calculateBasicFaceNormalWithoutNormalize(
+                    triVerts[0], triVerts[1], triVerts[2] );
+                triNormal.normalise();
 
-                if( inters.first )
+                rayHit.distance = triHit.distance;
+                rayHit.material = material;
+                rayHit.triVerts[0] = triVerts[0];
+                rayHit.triVerts[1] = triVerts[1];
+                rayHit.triVerts[2] = triVerts[2];
+                rayHit.triNormal = triNormal;
+
+                for( int j = 0; j < 5 && material.image[j]; ++j )
                 {
-                    RayHit &rayHit = mRayHits[*itRayIdx];
-                    if( inters.second < rayHit.distance && inters.second <= lightRange )
-                    {
-                        rayHit.distance = inters.second;
-                        rayHit.material = material;
-                        rayHit.triVerts[0] = triVerts[0];
-                        rayHit.triVerts[1] = triVerts[1];
-                        rayHit.triVerts[2] = triVerts[2];
-                        rayHit.triNormal = triNormal;
-
-                        for( int j = 0; j < 5 && material.image[j]; ++j )
-                        {
-                            const uint8 uvSet = material.uvSet[j];
-                            const float *RESTRICT_ALIAS uvPtr = meshData.getUvStart( uvSet );
-                            rayHit.triUVs[j][0].x = uvPtr[vertexIdx[0] * 2u + 0];
-                            rayHit.triUVs[j][0].y = uvPtr[vertexIdx[0] * 2u + 1];
+                    const uint8 uvSet = material.uvSet[j];
+                    const float *RESTRICT_ALIAS uvPtr = meshData.getUvStart( uvSet );
+                    rayHit.triUVs[j][0].x = uvPtr[vertexIdx[0] * 2u + 0];
+                    rayHit.triUVs[j][0].y = uvPtr[vertexIdx[0] * 2u + 1];
 
-                            rayHit.triUVs[j][1].x = uvPtr[vertexIdx[1] * 2u + 0];
-                            rayHit.triUVs[j][1].y = uvPtr[vertexIdx[1] * 2u + 1];
+                    rayHit.triUVs[j][1].x = uvPtr[vertexIdx[1] * 2u + 0];
+                    rayHit.triUVs[j][1].y = uvPtr[vertexIdx[1] * 2u + 1];
 
-                            rayHit.triUVs[j][2].x = uvPtr[vertexIdx[2] * 2u + 0];
-                            rayHit.triUVs[j][2].y = uvPtr[vertexIdx[2] * 2u + 1];
-                        }
-                    }
+                    rayHit.triUVs[j][2].x = uvPtr[vertexIdx[2] * 2u + 0];
+                    rayHit.triUVs[j][2].y = uvPtr[vertexIdx[2] * 2u + 1];
                 }
-
-                ++itRayIdx;
             }
+
+            ++itRayIdx;
         }
     }
     //-----------------------------------------------------------------------------------
@@ -1492,6 +1489,8 @@ namespace Ogre
                 MeshData &meshData = itor->second;
                 OGRE_FREE_SIMD( meshData.vertexData, MEMCATEGORY_GEOMETRY );
                 meshData.vertexData = 0;
+                OGRE_DELETE meshData.bvh;
+                meshData.bvh = 0;
                 if( meshData.indexData && !itor->first->getIndexBuffer()->getShadowCopy() )
                 {
                     OGRE_FREE_SIMD( meshData.indexData, MEMCATEGORY_GEOMETRY );
@@ -1511,6 +1510,8 @@ namespace Ogre
                 MeshData &meshData = itor->second;
                 OGRE_FREE_SIMD( meshData.vertexData, MEMCATEGORY_GEOMETRY );
                 meshData.vertexData = 0;
+                OGRE_DELETE meshData.bvh;
+                meshData.bvh = 0;
                 if( meshData.indexData )
                 {
                     OGRE_FREE_SIMD( meshData.indexData, MEMCATEGORY_GEOMETRY );
@@ -1895,4 +1896,11 @@ namespace Ogre
     {
         return vertexData + numVertices * 3u + uvSet * 2u;
     }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::MeshData::buildBvh()
+    {
+        bvh = OGRE_NEW TriangleBvh();
+        bvh->build( vertexData, numVertices, indexData ? indexDataConst : 0, useIndices16bit,
+                    numIndices );
+    }
 }  // namespace Ogre
@@ -562,6 +562,23 @@ namespace Ogre
             poseRanges[DescBindingTypes::TexBuffer].end = static_cast<uint16>( poseBufReg + 1 );
         }
 
+        int32 preSkinnedBufReg = getProperty( tid, "preSkinnedBuf", -1 );
+        if( preSkinnedBufReg >= 0 )
+        {
+            DescBindingRange *preSkinnedRanges = rootLayout.mDescBindingRanges[2];
+            if( !bakedRanges[DescBindingTypes::Texture].isInUse() &&
+                !bakedRanges[DescBindingTypes::Sampler].isInUse() )
+            {
+                preSkinnedRanges = rootLayout.mDescBindingRanges[1];
+                rootLayout.mBaked[1] = false;
+            }
+            const DescBindingTypes::DescBindingTypes bindingType =
+                mVaoManager->readOnlyIsTexBuffer() ? DescBindingTypes::TexBuffer
+                                                   : DescBindingTypes::ReadOnlyBuffer;
+            preSkinnedRanges[bindingType].start = static_cast<uint16>( preSkinnedBufReg );
+            preSkinnedRanges[bindingType].end = static_cast<uint16>( preSkinnedBufReg + 1 );
+        }
+
         const int32 numVctProbes = getProperty( tid, PbsProperty::VctNumProbes );
 
         if( numVctProbes > 1 )
@@ -1077,6 +1094,7 @@ namespace Ogre
                      itor->keyName != HlmsBaseProp::Skeleton && itor->keyName != HlmsBaseProp::Pose &&
                      itor->keyName != HlmsBaseProp::PoseHalfPrecision &&
                      itor->keyName != HlmsBaseProp::PoseNormals &&
+                     itor->keyName != HlmsBaseProp::PreSkinned &&
                      itor->keyName != HlmsBaseProp::BonesPerVertex &&
                      itor->keyName != HlmsBaseProp::DualParaboloidMapping &&
                      ( !hasAlphaTestOrHash || !requiredPropertyByAlphaTest( itor->keyName ) ) )
@@ -1151,8 +1169,11 @@ namespace Ogre
         if( !getProperty( tid, PbsProperty::HasPlanarReflections ) )
             setProperty( tid, PbsProperty::UsePlanarReflections, 0 );
 
-        if( getProperty( tid, HlmsBaseProp::Pose ) > 0 )
+        if( getProperty( tid, HlmsBaseProp::Pose ) > 0 ||
+            getProperty( tid, HlmsBaseProp::PreSkinned ) )
+        {
             setProperty( tid, HlmsBaseProp::VertexId, 1 );
+        }
 
         if( getProperty( tid, HlmsBaseProp::UseUvBaking ) )
         {
@@ -1445,6 +1466,14 @@ namespace Ogre
         if( getProperty( tid, HlmsBaseProp::Pose ) )
             setTextureReg( tid, VertexShader, "poseBuf", texUnit++ );
 
+        if( getProperty( tid, HlmsBaseProp::PreSkinned ) )
+        {
+            if( mVaoManager->readOnlyIsTexBuffer() )
+                setTextureReg( tid, VertexShader, "preSkinnedBuf", texUnit++ );
+            else
+                setProperty( tid, "preSkinnedBuf", texUnit++ );
+        }
+
         // This is a regular property!
         setProperty( tid, "samplerStateStart", samplerStateStart );
 
@@ -3370,7 +3399,9 @@ namespace Ogre
         uint32 *RESTRICT_ALIAS currentMappedConstBuffer = mCurrentMappedConstBuffer;
         float *RESTRICT_ALIAS currentMappedTexBuffer = mCurrentMappedTexBuffer;
 
-        bool hasSkeletonAnimation = queuedRenderable.renderable->hasSkeletonAnimation();
+        ReadOnlyBufferPacked *preSkinnedBuf = queuedRenderable.renderable->getPreSkinnedBuffer();
+        bool hasSkeletonAnimation =
+            queuedRenderable.renderable->hasSkeletonAnimation() && !preSkinnedBuf;
         uint32 numPoses = queuedRenderable.renderable->getNumPoses();
         uint32 poseWeightsNumFloats = ( ( numPoses >> 2u ) + std::min( numPoses % 4u, 1u ) ) * 4u;
 
@@ -3380,7 +3411,7 @@ namespace Ogre
         //                          ---- VERTEX SHADER ----
         //---------------------------------------------------------------------------
 
-        if( !hasSkeletonAnimation && numPoses == 0 )
+        if( !hasSkeletonAnimation && numPoses == 0 && !preSkinnedBuf )
         {
             // We need to correct currentMappedConstBuffer to point to the right texture buffer's
             // offset, which may not be in sync if the previous draw had skeletal and/or pose animation.
@@ -3450,6 +3481,59 @@ namespace Ogre
             bool exceedsConstBuffer = (size_t)( ( currentMappedConstBuffer - mStartMappedConstBuffer ) +
                                                 4 ) > mCurrentConstBufferSize;
 
+            if( preSkinnedBuf )
+            {
+                // Already skinned into world space by ComputeSkinning. We only
+                // need 1 vec4 to locate our vertices (base vertex, num vertices)
+                const size_t minimumTexBufferSize = 4u;
+                bool exceedsTexBuffer =
+                    static_cast<size_t>( currentMappedTexBuffer - mStartMappedTexBuffer ) +
+                        minimumTexBufferSize >=
+                    mCurrentTexBufferSize;
+
+                if( exceedsConstBuffer || exceedsTexBuffer )
+                {
+                    currentMappedConstBuffer = mapNextConstBuffer( commandBuffer );
+
+                    if( exceedsTexBuffer )
+                        mapNextTexBuffer( commandBuffer, minimumTexBufferSize * sizeof( float ) );
+                    else
+                        rebindTexBuffer( commandBuffer, true, minimumTexBufferSize * sizeof( float ) );
+
+                    currentMappedTexBuffer = mCurrentMappedTexBuffer;
+                }
+
+                // uint worldMaterialIdx[]
+                size_t distToWorldMatStart =
+                    static_cast<size_t>( mCurrentMappedTexBuffer - mStartMappedTexBuffer );
+                distToWorldMatStart >>= 2;
+                *currentMappedConstBuffer = uint32( ( distToWorldMatStart << 9 ) |
+                                                    ( datablock->getAssignedSlot() & 0x1FF ) );
+
+                uint8 meshLod = queuedRenderable.movableObject->getCurrentMeshLod();
+                const VertexArrayObjectArray &vaos =
+                    queuedRenderable.renderable->getVaos( static_cast<VertexPass>( casterPass ) );
+                VertexArrayObject *vao = vaos[meshLod];
+#ifdef __APPLE__
+                uint32 baseVertex = 0;
+#else
+                uint32 baseVertex =
+                    static_cast<uint32>( vao->getBaseVertexBuffer()->_getFinalBufferStart() );
+#endif
+                memcpy( currentMappedTexBuffer, &baseVertex, sizeof( baseVertex ) );
+                uint32 numVertices = static_cast<uint32>( vao->getBaseVertexBuffer()->getNumElements() );
+                memcpy( currentMappedTexBuffer + 1, &numVertices, sizeof( numVertices ) );
+                currentMappedTexBuffer += 4;
+
+                size_t numTextures = 0u;
+                if( datablock->mTexturesDescSet )
+                    numTextures = datablock->mTexturesDescSet->mTextures.size();
+
+                *commandBuffer->addCommand<CbShaderBuffer>() =
+                    CbShaderBuffer( VertexShader, uint16( mTexUnitSlotStart + numTextures ),
+                                    preSkinnedBuf, 0, (uint32)preSkinnedBuf->getTotalSizeBytes() );
+            }
+
             if( hasSkeletonAnimation )
             {
                 if( isV1 )
@@ -57,6 +57,20 @@ namespace Ogre
     protected:
         // Helper functions:
         bool isBorderVertex( const LodData::Vertex *vertex ) const;
+
+        typedef void ( LodCollapseCost::*RangeJob )( LodData *data, size_t begin, size_t end );
+
+        /** Splits [0; numElements) into data->mNumThreads ranges and runs (this->*job) on each
+            of them in parallel. Returns when all of them are done.
+        @remarks
+            The job must not modify anything shared between ranges.
+        */
+        void parallelFor( LodData *data, size_t numElements, RangeJob job );
+
+        /// Computes the cost of the vertices in [begin; end). Stores them in mInitialCosts.
+        void computeInitialCosts( LodData *data, size_t begin, size_t end );
+
+        vector<Real>::type mInitialCosts;
     };
 
 }  // namespace Ogre
@@ -56,6 +56,10 @@ namespace Ogre
 
         void computeTrianglePlaneQuadric( LodData *data, size_t triangleID );
         void computeVertexQuadric( LodData *data, size_t vertexID );
+
+        /// parallelFor jobs
+        void computeTrianglePlaneQuadrics( LodData *data, size_t begin, size_t end );
+        void computeVertexQuadrics( LodData *data, size_t begin, size_t end );
     };
 
 }  // namespace Ogre
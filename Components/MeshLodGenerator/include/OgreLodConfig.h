@@ -168,6 +168,10 @@ namespace Ogre
             Ogre::Real outsideWalkAngle;
             /// If the algorithm makes errors, you can fix it, by adding the edge to the profile.
             LodProfile profile;
+            /// Number of threads used to compute the initial collapse costs of a mesh. This is what
+            /// dominates the generation time of big meshes. 0 means one per logical core, 1 disables
+            /// threading. The result is the same regardless of the value. (0 by default)
+            size_t numThreads;
             Advanced();
         } advanced;
     };
@@ -68,7 +68,17 @@ namespace Ogre
 
         typedef vector<Vertex>::type          VertexList;
         typedef vector<Triangle>::type        TriangleList;
-        typedef multimap<Real, VertexI>::type CollapseCostHeap;
+
+        struct CollapseCostHeapEntry
+        {
+            Real    collapseCost;
+            VertexI vertexi;
+            /// Breaks ties between equal costs: first come, first served.
+            uint64 insertionOrder;
+        };
+        /// Binary min-heap sorted by collapse cost. Vertex::costHeapPosition tracks where
+        /// each vertex is, so it can be updated or removed in O(log n) without searching.
+        typedef vector<CollapseCostHeapEntry>::type CollapseCostHeap;
         typedef VectorSet<Edge, 8>            VEdges;
         typedef VectorSet<TriangleI, 7>       VTriangles;
 
@@ -114,10 +124,10 @@ namespace Ogre
             VEdges     edges;
             VTriangles triangles;
 
-            VertexI                    collapseToi;
-            bool                       seam;
-            CollapseCostHeap::iterator costHeapPosition;  ///< Iterator pointing to the position in the
-                                                          /// mCollapseCostSet, which allows fast remove.
+            VertexI collapseToi;
+            bool    seam;
+            /// Position in mCollapseCostHeap, or InvalidIndex if it's not there.
+            unsigned costHeapPosition;
 
             void addEdge( const Edge &edge );
             void removeEdge( const Edge &edge );
@@ -185,6 +195,41 @@ namespace Ogre
 #endif
         Real mMeshBoundingSphereRadius;
         bool mUseVertexNormals;
+        /// Number of threads LodCollapseCost may use to compute the initial costs. At least 1.
+        size_t mNumThreads;
+
+        /// Adds the vertex to mCollapseCostHeap. It must not be in it already.
+        void pushCollapseCost( VertexI vertexi, Real collapseCost );
+        /// Changes the cost of a vertex already in mCollapseCostHeap.
+        void updateCollapseCost( VertexI vertexi, Real collapseCost );
+        /// Removes the vertex from mCollapseCostHeap. It must be in it.
+        void removeCollapseCost( VertexI vertexi );
+        /// Returns the cost of a vertex in mCollapseCostHeap.
+        Real getCollapseCost( VertexI vertexi ) const
+        {
+            return mCollapseCostHeap[mVertexList[vertexi].costHeapPosition].collapseCost;
+        }
+        /// Returns the entry with the smallest collapse cost. The heap must not be empty.
+        const CollapseCostHeapEntry &getMinCollapseCost() const { return mCollapseCostHeap.front(); }
+        /** Sorts mCollapseCostHeap, in O(n), after filling it with push_back.
+            Much faster than calling pushCollapseCost for every vertex.
+            CollapseCostHeapEntry::insertionOrder is filled by this function.
+        */
+        void buildCollapseCostHeap();
+
+    protected:
+        static bool isCheaper( const CollapseCostHeapEntry &a, const CollapseCostHeapEntry &b )
+        {
+            return a.collapseCost < b.collapseCost ||
+                   ( a.collapseCost == b.collapseCost && a.insertionOrder < b.insertionOrder );
+        }
+        void siftUp( size_t pos );
+        void siftDown( size_t pos );
+        void placeHeapEntry( size_t pos, const CollapseCostHeapEntry &entry );
+
+        uint64 mNextInsertionOrder;
+
+    public:
 
         template <typename T, typename A>
         static size_t getVectorIDFromPointer( const std::vector<T, A> &vec, const T *pointer )
@@ -217,7 +262,9 @@ namespace Ogre
                               (const UniqueVertexSet::hasher &)VertexHash( this ),
                               (const UniqueVertexSet::key_equal &)VertexEqual( this ) ),
             mMeshBoundingSphereRadius( 0.0f ),
-            mUseVertexNormals( true )
+            mUseVertexNormals( true ),
+            mNumThreads( 1u ),
+            mNextInsertionOrder( 0u )
         {
         }
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
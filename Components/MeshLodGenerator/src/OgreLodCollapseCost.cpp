@@ -29,14 +29,98 @@
 #include "OgreLodCollapseCost.h"
 
 #include "OgreLogManager.h"
+#include "Threading/OgreThreads.h"
 
 #include <sstream>
 
 namespace Ogre
 {
+    namespace
+    {
+        struct LodParallelJob
+        {
+            LodCollapseCost *cost;
+            void ( LodCollapseCost::*job )( LodData *data, size_t begin, size_t end );
+            LodData *data;
+            size_t   numElements;
+            size_t   numThreads;
+
+            void run( size_t threadIdx ) const
+            {
+                const size_t begin = numElements * threadIdx / numThreads;
+                const size_t end = numElements * ( threadIdx + 1u ) / numThreads;
+                ( cost->*job )( data, begin, end );
+            }
+        };
+    }  // namespace
+
+    unsigned long lodCollapseCostThread( ThreadHandle *threadHandle );
+    THREAD_DECLARE( lodCollapseCostThread );
+
+    unsigned long lodCollapseCostThread( ThreadHandle *threadHandle )
+    {
+        const LodParallelJob *job =
+            reinterpret_cast<const LodParallelJob *>( threadHandle->getUserParam() );
+        job->run( threadHandle->getThreadIdx() );
+        return 0;
+    }
+
+    void LodCollapseCost::parallelFor( LodData *data, size_t numElements, RangeJob job )
+    {
+        LodParallelJob jobParams;
+        jobParams.cost = this;
+        jobParams.job = job;
+        jobParams.data = data;
+        jobParams.numElements = numElements;
+        // Don't bother spawning threads for tiny meshes
+        jobParams.numThreads =
+            std::min( data->mNumThreads, std::max<size_t>( numElements / 1024u, 1u ) );
+
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        if( jobParams.numThreads > 1u )
+        {
+            // Threads [1; numThreads) are spawned, this thread runs the first range
+            ThreadHandleVec threads;
+            threads.resize( jobParams.numThreads - 1u );
+            for( size_t i = 1u; i < jobParams.numThreads; ++i )
+            {
+                threads[i - 1u] =
+                    Threads::CreateThread( THREAD_GET( lodCollapseCostThread ), i, &jobParams );
+            }
+            jobParams.run( 0u );
+            Threads::WaitForThreads( threads );
+            return;
+        }
+#endif
+        jobParams.numThreads = 1u;
+        jobParams.run( 0u );
+    }
+
+    void LodCollapseCost::computeInitialCosts( LodData *data, size_t begin, size_t end )
+    {
+        for( size_t i = begin; i < end; ++i )
+        {
+            LodData::Vertex *vertex = &data->mVertexList[i];
+            if( !vertex->edges.empty() )
+            {
+                Real collapseCost = LodData::UNINITIALIZED_COLLAPSE_COST;
+                LodData::VertexI collapseToi = LodData::InvalidIndex;
+                computeVertexCollapseCost( data, static_cast<LodData::VertexI>( i ), collapseCost,
+                                           collapseToi );
+                vertex->collapseToi = collapseToi;
+                mInitialCosts[i] = collapseCost;
+            }
+        }
+    }
+
     void LodCollapseCost::initCollapseCosts( LodData *data )
     {
+        // The costs of each vertex are independent of each other, compute them in parallel
+        mInitialCosts.resize( data->mVertexList.size() );
+        parallelFor( data, data->mVertexList.size(), &LodCollapseCost::computeInitialCosts );
+
         data->mCollapseCostHeap.clear();
+        data->mCollapseCostHeap.reserve( data->mVertexList.size() );
         LodData::VertexList::iterator it = data->mVertexList.begin();
         LodData::VertexList::iterator itEnd = data->mVertexList.end();
         LodData::VertexI vi = 0;
@@ -44,7 +128,11 @@ namespace Ogre
         {
             if( !it->edges.empty() )
             {
-                initVertexCollapseCost( data, vi );
+                LodData::CollapseCostHeapEntry entry;
+                entry.collapseCost = mInitialCosts[vi];
+                entry.vertexi = vi;
+                entry.insertionOrder = 0u;  // Set by buildCollapseCostHeap
+                data->mCollapseCostHeap.push_back( entry );
             }
             else
             {
@@ -58,6 +146,9 @@ namespace Ogre
 #endif
             }
         }
+        data->buildCollapseCostHeap();
+
+        mInitialCosts.clear();
     }
 
     void LodCollapseCost::computeVertexCollapseCost( LodData *data, LodData::VertexI vertexi,
@@ -85,7 +176,7 @@ namespace Ogre
         computeVertexCollapseCost( data, vertexi, collapseCost, collapseToi );
 
         vertex->collapseToi = collapseToi;
-        vertex->costHeapPosition = data->mCollapseCostHeap.emplace( collapseCost, vertexi );
+        data->pushCollapseCost( vertexi, collapseCost );
     }
 
     void LodCollapseCost::updateVertexCollapseCost( LodData *data, LodData::VertexI vertexi )
@@ -95,20 +186,19 @@ namespace Ogre
         computeVertexCollapseCost( data, vertexi, collapseCost, collapseToi );
 
         LodData::Vertex *vertex = &data->mVertexList[vertexi];
-        if( vertex->collapseToi != collapseToi || collapseCost != vertex->costHeapPosition->first )
+        OgreAssert( vertex->costHeapPosition != LodData::InvalidIndex, "" );
+        if( vertex->collapseToi != collapseToi || collapseCost != data->getCollapseCost( vertexi ) )
         {
-            OgreAssert( vertex->costHeapPosition != data->mCollapseCostHeap.end(), "" );
-            data->mCollapseCostHeap.erase( vertex->costHeapPosition );
             if( collapseCost != LodData::UNINITIALIZED_COLLAPSE_COST )
             {
                 vertex->collapseToi = collapseToi;
-                vertex->costHeapPosition = data->mCollapseCostHeap.emplace( collapseCost, vertexi );
+                data->updateCollapseCost( vertexi, collapseCost );
             }
             else
             {
+                data->removeCollapseCost( vertexi );
 #if OGRE_DEBUG_MODE
                 vertex->collapseToi = LodData::InvalidIndex;
-                vertex->costHeapPosition = data->mCollapseCostHeap.end();
 #endif
             }
         }
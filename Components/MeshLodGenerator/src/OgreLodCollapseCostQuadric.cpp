@@ -41,16 +41,28 @@ namespace Ogre
     void LodCollapseCostQuadric::initCollapseCosts( LodData *data )
     {
         mTrianglePlaneQuadricList.resize( data->mTriangleList.size() );
-        for( size_t i = 0; i < mTrianglePlaneQuadricList.size(); i++ )
+        parallelFor( data, mTrianglePlaneQuadricList.size(),
+                     static_cast<RangeJob>( &LodCollapseCostQuadric::computeTrianglePlaneQuadrics ) );
+        mVertexQuadricList.resize( data->mVertexList.size() );
+        parallelFor( data, mVertexQuadricList.size(),
+                     static_cast<RangeJob>( &LodCollapseCostQuadric::computeVertexQuadrics ) );
+        LodCollapseCost::initCollapseCosts( data );
+    }
+
+    void LodCollapseCostQuadric::computeTrianglePlaneQuadrics( LodData *data, size_t begin, size_t end )
+    {
+        for( size_t i = begin; i < end; i++ )
         {
             computeTrianglePlaneQuadric( data, i );
         }
-        mVertexQuadricList.resize( data->mVertexList.size() );
-        for( size_t i = 0; i < mVertexQuadricList.size(); i++ )
+    }
+
+    void LodCollapseCostQuadric::computeVertexQuadrics( LodData *data, size_t begin, size_t end )
+    {
+        for( size_t i = begin; i < end; i++ )
         {
             computeVertexQuadric( data, i );
         }
-        LodCollapseCost::initCollapseCosts( data );
     }
 
     void LodCollapseCostQuadric::computeTrianglePlaneQuadric( LodData *data, size_t triangleID )
@@ -39,10 +39,10 @@ namespace Ogre
     {
         while( data->mCollapseCostHeap.size() > static_cast<size_t>( vertexCountLimit ) )
         {
-            LodData::CollapseCostHeap::iterator nextVertex = data->mCollapseCostHeap.begin();
-            if( nextVertex->first < collapseCostLimit )
+            const LodData::CollapseCostHeapEntry &nextVertex = data->getMinCollapseCost();
+            if( nextVertex.collapseCost < collapseCostLimit )
             {
-                mLastReducedVertex = &data->mVertexList[nextVertex->second];
+                mLastReducedVertex = &data->mVertexList[nextVertex.vertexi];
                 collapseVertex( data, cost, output, mLastReducedVertex );
             }
             else
@@ -62,7 +62,7 @@ namespace Ogre
         LodData::CollapseCostHeap::iterator itEnd = data->mCollapseCostHeap.end();
         while( it != itEnd )
         {
-            assertValidVertex( data, it->second );
+            assertValidVertex( data, it->vertexi );
             it++;
         }
     }
@@ -79,7 +79,7 @@ namespace Ogre
             for( int i = 0; i < 3; i++ )
             {
                 LodData::Vertex *tvi = &data->mVertexList[t->vertexi[i]];
-                OgreAssert( tvi->costHeapPosition != data->mCollapseCostHeap.end(), "" );
+                OgreAssert( tvi->costHeapPosition != LodData::InvalidIndex, "" );
                 tvi->edges.findExists( LodData::Edge( tvi->collapseToi ) );
                 for( int n = 0; n < 3; n++ )
                 {
@@ -231,8 +231,8 @@ namespace Ogre
         assertValidVertex( data, dsti );
         assertValidVertex( data, srci );
 #endif
-        OgreAssert( src->costHeapPosition->first != LodData::NEVER_COLLAPSE_COST, "" );
-        OgreAssert( src->costHeapPosition->first != LodData::UNINITIALIZED_COLLAPSE_COST, "" );
+        OgreAssert( data->getCollapseCost( srci ) != LodData::NEVER_COLLAPSE_COST, "" );
+        OgreAssert( data->getCollapseCost( srci ) != LodData::UNINITIALIZED_COLLAPSE_COST, "" );
         OgreAssert( !src->edges.empty(), "" );
         OgreAssert( !src->triangles.empty(), "" );
         OgreAssert( src->edges.find( LodData::Edge( dsti ) ) != src->edges.end(), "" );
@@ -361,13 +361,12 @@ namespace Ogre
             assertOutdatedCollapseCost( data, cost, it3->dsti );
         }
         assertOutdatedCollapseCost( data, cost, dsti );
-#    endif                                                       // ifndef OGRE_DEBUG_MODE
-#endif                                                           // ifndef MESHLOD_QUALITY
-        data->mCollapseCostHeap.erase( src->costHeapPosition );  // Remove src from collapse costs.
-        src->edges.clear();                                      // Free memory
-        src->triangles.clear();                                  // Free memory
+#    endif                                 // ifndef OGRE_DEBUG_MODE
+#endif                                     // ifndef MESHLOD_QUALITY
+        data->removeCollapseCost( srci );  // Remove src from collapse costs.
+        src->edges.clear();                // Free memory
+        src->triangles.clear();            // Free memory
 #if OGRE_DEBUG_MODE
-        src->costHeapPosition = data->mCollapseCostHeap.end();
         assertValidVertex( data, dsti );
 #endif
     }
@@ -35,7 +35,8 @@ namespace Ogre
         useCompression( true ),
         useVertexNormals( true ),
         outsideWeight( 0.0 ),
-        outsideWalkAngle( 0.0 )
+        outsideWalkAngle( 0.0 ),
+        numThreads( 0u )
     {
     }
 
@@ -61,6 +61,104 @@ namespace Ogre
         }
     }
 
+    void LodData::placeHeapEntry( size_t pos, const CollapseCostHeapEntry &entry )
+    {
+        mCollapseCostHeap[pos] = entry;
+        mVertexList[entry.vertexi].costHeapPosition = static_cast<unsigned>( pos );
+    }
+
+    void LodData::siftUp( size_t pos )
+    {
+        const CollapseCostHeapEntry entry = mCollapseCostHeap[pos];
+        while( pos > 0u )
+        {
+            const size_t parent = ( pos - 1u ) >> 1u;
+            if( !isCheaper( entry, mCollapseCostHeap[parent] ) )
+                break;
+            placeHeapEntry( pos, mCollapseCostHeap[parent] );
+            pos = parent;
+        }
+        placeHeapEntry( pos, entry );
+    }
+
+    void LodData::siftDown( size_t pos )
+    {
+        const size_t heapSize = mCollapseCostHeap.size();
+        const CollapseCostHeapEntry entry = mCollapseCostHeap[pos];
+        while( true )
+        {
+            size_t child = pos * 2u + 1u;
+            if( child >= heapSize )
+                break;
+            if( child + 1u < heapSize &&
+                isCheaper( mCollapseCostHeap[child + 1u], mCollapseCostHeap[child] ) )
+            {
+                ++child;
+            }
+            if( !isCheaper( mCollapseCostHeap[child], entry ) )
+                break;
+            placeHeapEntry( pos, mCollapseCostHeap[child] );
+            pos = child;
+        }
+        placeHeapEntry( pos, entry );
+    }
+
+    void LodData::pushCollapseCost( VertexI vertexi, Real collapseCost )
+    {
+        OgreAssert( mVertexList[vertexi].costHeapPosition == InvalidIndex, "" );
+        CollapseCostHeapEntry entry;
+        entry.collapseCost = collapseCost;
+        entry.vertexi = vertexi;
+        entry.insertionOrder = mNextInsertionOrder++;
+        mCollapseCostHeap.push_back( entry );
+        siftUp( mCollapseCostHeap.size() - 1u );
+    }
+
+    void LodData::updateCollapseCost( VertexI vertexi, Real collapseCost )
+    {
+        const size_t pos = mVertexList[vertexi].costHeapPosition;
+        OgreAssert( pos < mCollapseCostHeap.size(), "" );
+        // Behave like removing and adding it again: it goes after any other vertex with the same cost
+        const Real oldCost = mCollapseCostHeap[pos].collapseCost;
+        mCollapseCostHeap[pos].collapseCost = collapseCost;
+        mCollapseCostHeap[pos].insertionOrder = mNextInsertionOrder++;
+        if( collapseCost < oldCost )
+            siftUp( pos );
+        else
+            siftDown( pos );
+    }
+
+    void LodData::removeCollapseCost( VertexI vertexi )
+    {
+        const size_t pos = mVertexList[vertexi].costHeapPosition;
+        OgreAssert( pos < mCollapseCostHeap.size(), "" );
+        mVertexList[vertexi].costHeapPosition = InvalidIndex;
+
+        const CollapseCostHeapEntry last = mCollapseCostHeap.back();
+        mCollapseCostHeap.pop_back();
+        if( pos < mCollapseCostHeap.size() )
+        {
+            // Move the last entry into the hole and restore the heap from there
+            placeHeapEntry( pos, last );
+            if( pos > 0u && isCheaper( last, mCollapseCostHeap[( pos - 1u ) >> 1u] ) )
+                siftUp( pos );
+            else
+                siftDown( pos );
+        }
+    }
+
+    void LodData::buildCollapseCostHeap()
+    {
+        const size_t heapSize = mCollapseCostHeap.size();
+        for( size_t i = 0u; i < heapSize; ++i )
+        {
+            mCollapseCostHeap[i].insertionOrder = mNextInsertionOrder++;
+            mVertexList[mCollapseCostHeap[i].vertexi].costHeapPosition = static_cast<unsigned>( i );
+        }
+        for( size_t i = heapSize >> 1u; i-- > 0u; )
+            siftDown( i );
+    }
+
     bool LodData::VertexEqual::operator()( const LodData::VertexI lhs, const LodData::VertexI rhs ) const
     {
         return mGen->mVertexList[lhs].position == mGen->mVertexList[rhs].position;
@@ -155,9 +155,7 @@ namespace Ogre
             }
             else
             {
-#if OGRE_DEBUG_MODE
-                v->costHeapPosition = data->mCollapseCostHeap.end();
-#endif
+                v->costHeapPosition = LodData::InvalidIndex;
                 v->seam = false;
                 if( data->mUseVertexNormals )
                 {
@@ -214,10 +214,8 @@ namespace Ogre
             }
             else
             {
-#if OGRE_DEBUG_MODE
-                // Needed for an assert, don't remove it.
-                v->costHeapPosition = data->mCollapseCostHeap.end();
-#endif
+                // Not in the collapse cost heap yet.
+                v->costHeapPosition = LodData::InvalidIndex;
                 v->seam = false;
             }
             lookup.push_back( vi );
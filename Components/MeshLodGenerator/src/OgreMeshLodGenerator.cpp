@@ -46,6 +46,7 @@
 #include "OgreLodWorkQueueWorker.h"
 #include "OgreMesh.h"
 #include "OgrePixelCountLodStrategy.h"
+#include "OgrePlatformInformation.h"
 
 namespace Ogre
 {
@@ -207,6 +208,9 @@ namespace Ogre
     {
         input->initData( data );
         data->mUseVertexNormals = data->mUseVertexNormals && lodConfig.advanced.useVertexNormals;
+        data->mNumThreads = lodConfig.advanced.numThreads;
+        if( !data->mNumThreads )
+            data->mNumThreads = std::max<size_t>( PlatformInformation::getNumLogicalCores(), 1u );
         cost->initCollapseCosts( data );
         output->prepare( data );
         computeLods( lodConfig, data, cost, output, collapser );
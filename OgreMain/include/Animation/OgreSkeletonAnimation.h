@@ -78,6 +78,10 @@ namespace Ogre
         /// One per track
         KnownKeyFramesVec mLastKnownKeyFrames;
 
+        /// One per track. When not empty, tracks set to 0 are not applied.
+        /// See SkeletonInstance::setSkinnedBones
+        FastArray<uint8> mTrackUsed;
+
     public:
         SkeletonAnimation( const SkeletonAnimationDef *definition, const FastArray<size_t> *slotStarts,
                            SkeletonInstance *owner );
@@ -271,6 +275,13 @@ namespace Ogre
 
         void _applyAnimation( const TransformArray &boneTransforms );
 
+        /** Internal use. Only the tracks that animate at least one of the given bones
+            will be applied.
+        @param usedBones
+            One entry per bone in the SkeletonDef. Null to apply all tracks.
+        */
+        void _setUsedBones( const vector<bool>::type *usedBones );
+
         void _swapBoneWeightsUniquePtr(
             RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION> &inOutBoneWeights );
 
@@ -100,6 +100,34 @@ namespace Ogre
 
         void build( const v1::Skeleton *skeleton, const v1::Animation *animation, Real frameRate );
 
+        /** Compresses all the tracks to reduce their memory footprint (typically 5x-10x):
+                1. Keyframes that can be reproduced by interpolating their neighbours
+                   within the given tolerance are removed.
+                2. Channels (position, orientation, scale) that never change are stored
+                   once per track instead of once per keyframe.
+                3. Tracks that are constant and equal to the identity have no effect
+                   and are removed.
+                4. Positions and scales are quantised to 16 bits relative to the range
+                   of each bone. Orientations are quantised with the smallest-three
+                   method (three components of 15 bits each).
+        @remarks
+            Must be called right after build(), before any SkeletonInstance uses this
+            animation. It can only be called once.
+        @par
+            Bones whose track got removed are no longer considered to be affected by this
+            animation, thus SkeletonAnimation::setBoneWeight & co. have no effect on them.
+        @param positionTolerance
+            Maximum distance, in local space, a bone may deviate from the original animation.
+        @param orientationTolerance
+            Maximum angle a bone may deviate from the original animation.
+        @param scaleTolerance
+            Maximum difference per scale component from the original animation.
+        */
+        void compress( Real positionTolerance = 1e-4f,
+                       Radian orientationTolerance = Radian( 1e-3f ), Real scaleTolerance = 1e-4f );
+
+        bool isCompressed() const;
+
         /// Dumps all the tracks in CSV format to the output string argument.
         /// Mostly for debugging purposes. (also easy example to show how to
         /// enumerate all the tracks and get the bones back from its block index)
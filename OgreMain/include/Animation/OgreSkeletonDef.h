@@ -156,6 +156,13 @@ namespace Ogre
         }
         void getBonesPerDepth( vector<size_t>::type &out ) const;
 
+        /** Compresses all animations. See SkeletonAnimationDef::compress.
+            Must be called before creating any SkeletonInstance from this definition.
+        */
+        void compressAnimations( Real positionTolerance = 1e-4f,
+                                 Radian orientationTolerance = Radian( 1e-3f ),
+                                 Real scaleTolerance = 1e-4f );
+
         /** Returns the total number of bone blocks to reach the given level. i.e On SSE2,
             If the skeleton has 1 root node, 3 children, and 5 children of children;
             then the total number of blocks is 1 + 1 + 2 = 4
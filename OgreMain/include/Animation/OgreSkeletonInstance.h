@@ -114,6 +114,13 @@ namespace Ogre
 
         SceneNodeBonePairVec mCustomParentSceneNodes;
 
+        /// One per bone. Empty if all bones are animated. See setSkinnedBones
+        vector<bool>::type mUsedBones;
+
+        /// Spreads the frames in which throttled instances get animated.
+        /// See SceneManager::setAnimationLod
+        uint32 mAnimationLodPhase;
+
         uint16 mRefCount;
 
     public:
@@ -157,6 +164,22 @@ namespace Ogre
         */
         void setSceneNodeAsParentOfBone( Bone *bone, SceneNode *nodeParent );
 
+        /** Stops animating the bones that don't deform any vertex, unless a child bone
+            does. Their pose stays at the binding pose.
+        @remarks
+            Bones with TagPoints attached or parented to a SceneNode (see
+            setSceneNodeAsParentOfBone) at the time of this call are always animated.
+            Call this again after attaching TagPoints to bones that were being skipped.
+        @param skinnedBones
+            Bone indices of the bones referenced by the vertex data of every
+            mesh using this instance (i.e. SubMesh::mBlendIndexToBoneIndexMap).
+            Null to animate all bones again.
+        */
+        void setSkinnedBones( const FastArray<unsigned short> *skinnedBones );
+
+        uint32 _getAnimationLodPhase() const { return mAnimationLodPhase; }
+        void   _setAnimationLodPhase( uint32 phase ) { mAnimationLodPhase = phase; }
+
         /// Gets full transform of a bone by its index.
         FORCEINLINE const SimpleMatrixAf4x3 &_getBoneFullTransform( size_t index ) const
         {
@@ -33,11 +33,17 @@ THE SOFTWARE.
 
 #include "Math/Array/OgreArrayQuaternion.h"
 #include "Math/Array/OgreKfTransform.h"
+#include "OgreRawPtr.h"
 
 #include "ogrestd/vector.h"
 
 namespace Ogre
 {
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+
     class KfTransformArrayMemoryManager;
 
     struct KeyFrameRig
@@ -46,6 +52,7 @@ namespace Ogre
         Real mInvNextFrameDistance;  // 1.0f / (KeyFrameRig[1].mFrame - KeyFrameRig[0].mFrame)
 
         // SoA variable. Packs posrotscale posrotscale ...
+        // Null if the track has been compressed (see SkeletonTrack::compress)
         KfTransform *RESTRICT_ALIAS mBoneTransform;
     };
 
@@ -81,6 +88,49 @@ namespace Ogre
 
         KfTransformArrayMemoryManager *mLocalMemoryManager;
 
+        enum CompressedChannels
+        {
+            ChannelPosition = 1u << 0u,
+            ChannelOrientation = 1u << 1u,
+            ChannelScale = 1u << 2u
+        };
+
+        /// Indices to mQuantisationRanges
+        enum QuantisationRange
+        {
+            RangePositionMin = 0,
+            RangePositionStep = 3,
+            RangeScaleMin = 6,
+            RangeScaleStep = 9,
+            /// Constant orientation (w, x, y, z) when ChannelOrientation isn't stored
+            RangeOrientation = 12,
+            NumQuantisationRanges = 16
+        };
+
+        /** Quantised keyframes. Empty unless the track has been compressed.
+            Each keyframe takes mKeyStride values, in SoA (ARRAY_PACKED_REALS values per
+            component), for the channels in mStoredChannels in the order position (xyz),
+            orientation (smallest three) and scale (xyz).
+        @par
+            Position & scale are range-reduced to 16 bits per track & slot, see
+            mQuantisationRanges. Orientation drops its largest component (which is
+            recomputed, as the quaternion is unit length) and stores the other three in
+            15 bits each. The index of the dropped component goes into the top bit of the
+            first two components.
+        */
+        vector<uint16>::type mQuantisedKeys;
+
+        /// See QuantisationRange. Channels not in mStoredChannels are constant and their
+        /// value is in the *Min (or RangeOrientation) entries.
+        RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION> mQuantisationRanges;
+
+        uint16 mKeyStride;
+        /// See CompressedChannels
+        uint8 mStoredChannels;
+
+        /// Decodes keyframe keyIdx of a compressed track
+        void decompressKeyFrame( size_t keyIdx, KfTransform &outTransform ) const;
+
     public:
         SkeletonTrack( uint32 boneBlockIdx, KfTransformArrayMemoryManager *kfTransformMemoryManager );
         ~SkeletonTrack();
@@ -98,6 +148,28 @@ namespace Ogre
         const KeyFrameRigVec &getKeyFrames() const { return mKeyFrameRigs; }
         KeyFrameRigVec       &_getKeyFrames() { return mKeyFrameRigs; }
 
+        bool isCompressed() const { return !mQuantisedKeys.empty() || mQuantisationRanges.get(); }
+
+        /// Retrieves the transform of the given keyframe & slot.
+        /// Works for both compressed and uncompressed tracks.
+        void getKeyFrameTransform( size_t keyIdx, size_t slot, Vector3 &outPos, Quaternion &outRot,
+                                   Vector3 &outScale ) const;
+
+        /** Compresses the track. Afterwards the keyframes no longer use mLocalMemoryManager
+            (KeyFrameRig::mBoneTransform is null) and new keyframes can't be added.
+            @see SkeletonAnimationDef::compress
+        @param positionTolerance
+            Maximum distance a position may deviate from the original keyframes.
+        @param orientationTolerance
+            Maximum angle (in radians) a rotation may deviate from the original keyframes.
+        @param scaleTolerance
+            Maximum deviation of each scale component from the original keyframes.
+        @return
+            True if the track is constant and equal to the identity transform, meaning
+            it has no effect and can be removed.
+        */
+        bool compress( Real positionTolerance, Real orientationTolerance, Real scaleTolerance );
+
         inline void getKeyFrameRigAt( KeyFrameRigVec::const_iterator &inOutPrevFrame,
                                       KeyFrameRigVec::const_iterator &outNextFrame, Real frame ) const;
 
@@ -130,6 +202,10 @@ namespace Ogre
     };
 
     typedef vector<SkeletonTrack>::type SkeletonTrackVec;
+
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#    pragma GCC diagnostic pop
+#endif
 }  // namespace Ogre
 
 #endif
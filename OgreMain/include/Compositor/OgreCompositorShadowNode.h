@@ -111,6 +111,40 @@ namespace Ogre
             Real    minDistance;
             Real    maxDistance;
             Vector2 scenePassesViewportSize[Light::NUM_LIGHT_TYPES];
+            /// See setShadowMapCaching
+            bool   cachingEnabled;
+            bool   cacheValid;
+            /// When true, the contents rendered in a previous update are kept in this update
+            bool   reuseCachedContents;
+            Real   cacheGuardBand;
+            uint32 cacheMaxStaleFrames;
+            uint32 cacheStaleFrames;
+            uint64 cachedCastersSignature;
+            /// Light & camera the cached contents were rendered for
+            Light const  *cachedLight;
+            Camera const *cachedViewer;
+            /// Shadow camera state the cached contents were rendered with
+            Quaternion cachedOrientation;
+            Vector3    cachedPosition;
+            Vector2    cachedOrthoSize;
+            Real       cachedNear;
+            Real       cachedFar;
+            /// See setReceiverAwareCasterCulling. When active, receiverMaxDepth holds a
+            /// RECEIVER_GRID_RESOLUTION^2 grid over the ortho window with the farthest
+            /// distance (along the light's direction) at which a receiver was found
+            bool            receiverCullingActive;
+            Matrix3         receiverLightRot;
+            Vector2         receiverGridOrigin;
+            Vector2         receiverGridInvCellSize;
+            FastArray<Real> receiverMaxDepth;
+        };
+
+        struct CasterCullingStats
+        {
+            uint32 numTested;
+            uint32 numCulled;
+            /// Keep each thread's counters on their own cache line
+            uint8 padding[56];
         };
 
         typedef vector<ShadowMapCamera>::type ShadowMapCameraVec;
@@ -126,6 +160,18 @@ namespace Ogre
         Camera const *mLastCamera;
         size_t        mLastFrame;
         size_t        mNumActiveShadowMapCastingLights;
+        /// Textures (by name) whose shadow maps all kept their cached contents during
+        /// the current update. See _shouldUpdateTarget
+        IdStringVec mReusedShadowMapTextures;
+        uint32      mNumCachedShadowMapsReused;
+        uint32      mNumCachedShadowMapsRendered;
+
+        bool mReceiverAwareCasterCulling;
+        /// World AABBs of the objects seen by the main camera. See collectShadowReceivers
+        FastArray<Aabb> mShadowReceivers;
+        /// One per worker thread. Written during caster culling
+        mutable FastArray<CasterCullingStats> mCasterCullingStats;
+
         /// mShadowMapCastingLights may have gaps (can happen if no light of
         /// the types the shadow map supports could be assigned at this slot)
         LightClosestArray    mShadowMapCastingLights;
@@ -180,6 +226,32 @@ namespace Ogre
         void clearShadowCastingLights( const LightListInfo &globalLightList );
         void restoreStaticShadowCastingLights( const LightListInfo &globalLightList );
 
+        /** Called right after the shadow camera setup placed the camera of a cached shadow map.
+            If the cached contents still cover what the setup asked for, the camera is restored
+            to the state the cached contents were rendered with. Otherwise the new camera is
+            enlarged by the guard band and becomes the new cached state.
+        @return
+            True if the cached contents may be reused (they may still be discarded later on,
+            e.g. if casters moved).
+        */
+        bool updateCachedShadowCamera( ShadowMapCamera &shadowMapCamera, const Light *light,
+                                       const Camera *viewer, const Vector2 &viewportRealSize );
+
+        /// Decides which cached shadow maps must be rendered in this update. See
+        /// setShadowMapCaching
+        void resolveCachedShadowMaps( const FastArray<bool> &coversCachedWindow,
+                                      SceneManager *sceneManager, const Camera *viewer );
+
+        /** Gathers into mShadowReceivers the world AABBs of every object inside the main camera's
+            frustum (regardless of whether it casts shadows).
+        @return
+            False if a receiver has an infinite AABB, in which case nothing can be culled.
+        */
+        bool collectShadowReceivers( Camera *camera, SceneManager *sceneManager );
+
+        /// Fills the receiver depth grid of a directional shadow map from mShadowReceivers
+        void buildReceiverGrid( ShadowMapCamera &shadowMapCamera );
+
     public:
         CompositorShadowNode( IdType id, const CompositorShadowNodeDef *definition,
                               CompositorWorkspace *workspace, RenderSystem *renderSys,
@@ -209,6 +281,21 @@ namespace Ogre
 
         bool _shouldUpdateShadowMapIdx( uint32 shadowMapIdx ) const;
 
+        /// Returns false if textureName holds only shadow maps that are keeping their cached
+        /// contents in this update. Passes that aren't tied to a shadow map (e.g. clearing the
+        /// atlas) must then be skipped too. See setShadowMapCaching
+        bool _shouldUpdateTarget( IdString textureName ) const;
+
+        /** Removes from casters[firstIdx:] the casters that can't cast a shadow on anything
+            visible by the main camera. See setReceiverAwareCasterCulling.
+            Called by SceneManager::cullFrustum from worker threads.
+        @param shadowCamera
+            Camera used for culling. Does nothing if it's not one of our shadow map cameras.
+        */
+        void _cullCastersByReceivers( const Camera *shadowCamera,
+                                      FastArray<MovableObject *> &casters, size_t firstIdx,
+                                      size_t threadIdx ) const;
+
         /// Do not call this if isShadowMapIdxActive == false or isShadowMapIdxInValidRange == false
         uint8 getShadowMapLightTypeMask( uint32 shadowMapIdx ) const;
 
@@ -331,6 +418,82 @@ namespace Ogre
         /// to call it for every shadow map (otherwise you will trigger a O(N^2) behavior).
         void setStaticShadowMapDirty( size_t shadowMapIdx, bool includeLinked = true );
 
+        /** Keeps the contents of a directional light's shadow map (e.g. a PSSM split) across
+            frames, and only renders it again when needed.
+        @remarks
+            Each time the shadow map is rendered, its window is enlarged by a guard band.
+            Later updates keep the previous contents (and shadow camera) for as long as:
+                1. The light is the same and didn't rotate.
+                2. The region the shadow camera setup asks for is still inside the cached window,
+                   and the cached window isn't much larger than that region.
+                3. No shadow caster overlapping the window was added, removed or moved. Casters
+                   are tracked by their world AABBs. Animated casters (e.g. skeletons) are
+                   always considered to have moved.
+            Therefore in mostly static scenes a cascade only gets rendered again after the
+            camera moved about guardBand times its size.
+        @par
+            Like static shadow maps, cached shadow maps can't be partially cleared.
+            When a shadow map in a texture (e.g. an atlas) gets rendered, all cached shadow maps
+            in that same texture get rendered too. To let cascades be reused independently of
+            each other, give each of them its own texture.
+            When every shadow map in a texture keeps its contents, the passes on that texture
+            that aren't tied to a shadow map (e.g. the atlas clear) are skipped.
+        @par
+            The texture must keep its contents between frames, i.e. it can't have
+            TextureFlags::DiscardableContent (use keep_content in compositor scripts).
+            Textures created by ShadowNodeHelper::createShadowNodeWithSettings have it set
+            by default.
+        @param shadowMapIdx
+            Shadow map to cache. Only directional lights are cached; for other light types
+            this setting is ignored.
+        @param bEnable
+            True to cache. False to render it every frame (default).
+        @param guardBand
+            Extra size added to each side of the window, as a fraction of its size. Bigger values
+            mean fewer updates but lower effective resolution. e.g. 0.1 = 10% on each side.
+        @param maxStaleFrames
+            When casters inside the window move, the shadow map may keep its old contents
+            for up to this many updates before being rendered again. Useful for distant cascades
+            where a few frames of lag go unnoticed. 0 to render on the next update.
+        */
+        void setShadowMapCaching( size_t shadowMapIdx, bool bEnable, Real guardBand = 0.1f,
+                                  uint32 maxStaleFrames = 0u );
+        bool isShadowMapCached( size_t shadowMapIdx ) const;
+
+        /// Discards the contents of all cached shadow maps so they're rendered on the next update.
+        void invalidateCachedShadowMaps();
+
+        /// Number of cached shadow maps that kept their contents during the last update.
+        uint32 getNumCachedShadowMapsReused() const { return mNumCachedShadowMapsReused; }
+        /// Number of cached shadow maps that had to be rendered during the last update.
+        uint32 getNumCachedShadowMapsRendered() const { return mNumCachedShadowMapsRendered; }
+
+        /** Culls shadow casters of directional lights whose shadow would not land on any object
+            visible by the main camera.
+        @remarks
+            Before rendering the shadow maps, the AABBs of all objects inside the main camera's
+            frustum are projected into a coarse grid over each directional shadow map, keeping
+            the farthest depth per cell. Casters that passed the frustum culling of the shadow
+            camera are then rejected if all the cells they cover have no receiver behind them.
+        @par
+            Only objects handled by the SceneManager's regular culling count as receivers. If
+            something else receives shadows (e.g. custom terrain not registered as a
+            MovableObject), keep this disabled or shadows will go missing.
+        @par
+            Point and spot lights are not affected. Neither are static shadow maps (see
+            setLightFixedToShadowMap) nor shadow maps with caching enabled (see
+            setShadowMapCaching): their contents are reused after the camera moved, when
+            other objects may be receiving shadows.
+        */
+        void setReceiverAwareCasterCulling( bool bEnable );
+        bool getReceiverAwareCasterCulling() const { return mReceiverAwareCasterCulling; }
+
+        /// Number of casters tested by setReceiverAwareCasterCulling during the last update.
+        uint32 getNumCastersTestedByReceivers() const;
+        /// Number of casters culled by setReceiverAwareCasterCulling during the last update.
+        /// Divide by getNumCastersTestedByReceivers to get the culled ratio.
+        uint32 getNumCastersCulledByReceivers() const;
+
         /// @copydoc CompositorNode::finalTargetResized01
         void finalTargetResized01( const TextureGpu *finalTarget ) override;
     };
@@ -0,0 +1,161 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-present Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreComputeSkinning_H_
+#define _OgreComputeSkinning_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreResourceTransition.h"
+
+#include "ogrestd/map.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** Skins SubItems with a compute shader once per frame, into a buffer that every pass
+        of that frame (shadow maps, depth prepass, main pass, reflections...) then reads as
+        if it were static geometry; instead of redoing the skinning in the vertex shader of
+        each of those passes.
+    @remarks
+        The skinned positions, normals and tangents are written in world space, to a UAV
+        buffer per SubItem. Vertex buffers can't be bound as UAVs, thus HlmsPbs reads them
+        via vertex pulling (hlms_pre_skinned) while the regular vertex buffer still provides
+        the remaining attributes (UVs, etc).
+    @par
+        Only v2 SubItems animated by a skeleton are supported. SubItems with poses must keep
+        using vertex shader skinning. All LODs and the shadow mapping Vaos must share the same
+        vertex buffer (i.e. don't use independent shadow mapping Vaos for these meshes).
+    @par
+        The compute job is "Compute/Tools/Skinning", from Samples/Media/Compute/Tools.
+        When it's not provided (e.g. NULL RenderSystem) the SubItems are still tracked and
+        their buffers created, but nothing is dispatched and they keep being skinned in the
+        vertex shader.
+    */
+    class _OgreExport ComputeSkinning : public OgreAllocatedObj
+    {
+        /// Vertex data of a SubMesh repacked as 5 float4 per vertex:
+        /// position, normal, tangent, blend indices, blend weights.
+        /// Shared by all SubItems of that SubMesh.
+        struct SourceVertices
+        {
+            ReadOnlyBufferPacked *buffer;
+            uint32                numVertices;
+            uint32                refCount;
+        };
+
+        typedef map<SubMesh *, SourceVertices>::type SourceVerticesMap;
+
+        struct Entry
+        {
+            SubItem              *subItem;
+            SubMesh              *subMesh;
+            UavBufferPacked      *output;
+            ReadOnlyBufferPacked *outputView;
+            uint32                numVertices;
+            /// Offset in float4 units into mBoneMatrices. Updated every frame.
+            /// numeric_limits<uint32>::max() until the first upload.
+            uint32 boneStart;
+        };
+
+        typedef vector<Entry>::type EntryVec;
+
+        SourceVerticesMap mSourceVertices;
+        EntryVec          mEntries;
+
+        /// All bone matrices (3 float4 each) of all entries, uploaded every frame.
+        ReadOnlyBufferPacked *mBoneMatrices;
+
+        VaoManager     *mVaoManager;
+        RenderSystem   *mRenderSystem;
+        HlmsCompute    *mHlmsCompute;
+        HlmsComputeJob *mComputeJob;
+
+        uint32 mLastDispatchedFrame;
+
+        ResourceTransitionArray mResourceTransitions;
+
+        SourceVertices &acquireSourceVertices( SubMesh *subMesh );
+        void            releaseSourceVertices( SubMesh *subMesh );
+
+    public:
+        /**
+        @param hlmsCompute
+            Can be null if computeJob is null.
+        @param computeJob
+            The "Compute/Tools/Skinning" job. Can be null, see class remarks.
+        */
+        ComputeSkinning( RenderSystem *renderSystem, HlmsCompute *hlmsCompute,
+                         HlmsComputeJob *computeJob );
+        ~ComputeSkinning();
+
+        /** Starts skinning the given SubItem with compute. Does nothing if it was already added.
+        @remarks
+            Throws if the SubItem isn't supported (see class remarks).
+        */
+        void addSubItem( SubItem *subItem );
+
+        /// Stops skinning the given SubItem with compute; it goes back to vertex shader skinning.
+        /// Does nothing if it wasn't added.
+        void removeSubItem( SubItem *subItem );
+
+        /// Calls addSubItem on every SubItem of the Item that is supported.
+        /// Unsupported ones (e.g. with poses) silently keep vertex shader skinning.
+        void addItem( Item *item );
+
+        /// Calls removeSubItem on all of the Item's SubItems.
+        void removeItem( Item *item );
+
+        void removeAll();
+
+        /// Uploads the bone matrices of all entries. Called by SceneManager::updateSceneGraph
+        /// once the skeletons have been updated.
+        void _updateBoneMatrices();
+
+        /** Runs the compute skinning for all entries. Only the first call of each frame
+            dispatches, further calls (i.e. from the following passes) do nothing.
+            Called by CompositorPassScene before rendering.
+        @remarks
+            Ends the current render pass (if any) before dispatching.
+        */
+        void _dispatch();
+
+        size_t getNumSubItems() const { return mEntries.size(); }
+        /// Number of distinct SubMeshes whose vertices have been uploaded for skinning
+        size_t getNumSourceBuffers() const { return mSourceVertices.size(); }
+
+        /// Whether the SubItems are actually skinned with compute (i.e. we have a compute job)
+        bool isDispatching() const { return mComputeJob != 0; }
+    };
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
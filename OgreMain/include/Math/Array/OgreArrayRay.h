@@ -31,6 +31,8 @@ THE SOFTWARE.
 #include "OgreArrayAabb.h"
 #include "OgreArrayVector3.h"
 
+#include <limits>
+
 namespace Ogre
 {
     class ArrayRay
@@ -50,7 +52,21 @@ namespace Ogre
         /// See https://tavianator.com/fast-branchless-raybounding-box-intersections-part-2-nans/
         ArrayMaskR intersects( const ArrayAabb &aabb ) const
         {
-            ArrayVector3 invDir = Mathlib::SetAll( 1.0f ) / mDirection;
+            ArrayReal distance;
+            return intersects( aabb, Mathlib::SetAll( 1.0f ) / mDirection, distance );
+        }
+
+        /** Same as intersects( const ArrayAabb & ), for testing the same ray against many
+            aabbs without recalculating 1 / mDirection each time.
+        @param invDir
+            Must be Mathlib::SetAll( 1.0f ) / mDirection
+        @param outDistance [out]
+            Distance along the ray to where it enters the aabb; 0 if mOrigin is inside it.
+            Only meaningful where the returned mask is set.
+        */
+        ArrayMaskR intersects( const ArrayAabb &aabb, const ArrayVector3 &invDir,
+                               ArrayReal &outDistance ) const
+        {
             ArrayVector3 intersectAtMinPlane = ( aabb.getMinimum() - mOrigin ) * invDir;
             ArrayVector3 intersectAtMaxPlane = ( aabb.getMaximum() - mOrigin ) * invDir;
 
@@ -59,27 +75,35 @@ namespace Ogre
             ArrayVector3 maxIntersect = intersectAtMinPlane;
             maxIntersect.makeCeil( intersectAtMaxPlane );
 
-            ArrayReal tmin, tmax;
-            tmin = minIntersect.mChunkBase[0];
-            tmax = maxIntersect.mChunkBase[0];
+            // A ray parallel to a slab that starts on its border gives 0 * inf = NaN.
+            // How min & max handle NaNs depends on the platform and the order of the
+            // arguments, so those slabs are explicitly ignored (i.e. the border is inside).
+            const ArrayReal infinity = Mathlib::SetAll( std::numeric_limits<Real>::infinity() );
+            const ArrayReal negInfinity = Mathlib::SetAll( -std::numeric_limits<Real>::infinity() );
+            for( size_t i = 0u; i < 3u; ++i )
+            {
+                // x <= x is only false for NaNs
+                const ArrayMaskR isNumber =
+                    Mathlib::And( Mathlib::CompareLessEqual( intersectAtMinPlane.mChunkBase[i],
+                                                             intersectAtMinPlane.mChunkBase[i] ),
+                                  Mathlib::CompareLessEqual( intersectAtMaxPlane.mChunkBase[i],
+                                                             intersectAtMaxPlane.mChunkBase[i] ) );
+                minIntersect.mChunkBase[i] =
+                    Mathlib::CmovRobust( minIntersect.mChunkBase[i], negInfinity, isNumber );
+                maxIntersect.mChunkBase[i] =
+                    Mathlib::CmovRobust( maxIntersect.mChunkBase[i], infinity, isNumber );
+            }
 
-#if OGRE_CPU == OGRE_CPU_ARM && OGRE_USE_SIMD == 1
-            // ARM's NEON behaves the way we want, by propagating NaNs. No need to do anything weird
-            tmin = Mathlib::Max( Mathlib::Max( minIntersect.mChunkBase[0], minIntersect.mChunkBase[1] ),
-                                 minIntersect.mChunkBase[2] );
-            tmax = Mathlib::Min( Mathlib::Min( maxIntersect.mChunkBase[0], maxIntersect.mChunkBase[1] ),
-                                 maxIntersect.mChunkBase[2] );
-#else
-            // We need to do weird min/max so that NaNs get propagated
-            //(happens if mOrigin is in the AABB's border)
-            tmin = Mathlib::Max( tmin, Mathlib::Min( minIntersect.mChunkBase[1], tmax ) );
-            tmax = Mathlib::Min( tmax, Mathlib::Max( maxIntersect.mChunkBase[1], tmin ) );
+            const ArrayReal tmin = Mathlib::Max(
+                Mathlib::Max( minIntersect.mChunkBase[0], minIntersect.mChunkBase[1] ),
+                minIntersect.mChunkBase[2] );
+            const ArrayReal tmax = Mathlib::Min(
+                Mathlib::Min( maxIntersect.mChunkBase[0], maxIntersect.mChunkBase[1] ),
+                maxIntersect.mChunkBase[2] );
 
-            tmin = Mathlib::Max( tmin, Mathlib::Min( minIntersect.mChunkBase[2], tmax ) );
-            tmax = Mathlib::Min( tmax, Mathlib::Max( maxIntersect.mChunkBase[2], tmin ) );
-#endif
             // tmax >= max( tmin, 0 )
-            return Mathlib::CompareGreaterEqual( tmax, Mathlib::Max( tmin, ARRAY_REAL_ZERO ) );
+            outDistance = Mathlib::Max( tmin, ARRAY_REAL_ZERO );
+            return Mathlib::CompareGreaterEqual( tmax, outDistance );
         }
     };
 }  // namespace Ogre
@@ -0,0 +1,190 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-present Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreBatchedSceneQuery_H_
+#define _OgreBatchedSceneQuery_H_
+
+#include "OgrePrerequisites.h"
+
+#include "Math/Simple/OgreAabb.h"
+#include "OgreSceneQuery.h"
+#include "Threading/OgreUniformScalableTask.h"
+
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** Tests many rays, spheres or boxes against the scene in one go.
+    @remarks
+        RaySceneQuery & co. test one shape at a time and report each hit through a
+        listener. This query instead takes an array of shapes, tests each one against
+        four objects at a time using the SIMD data in ObjectMemoryManager, splits the
+        shapes across the SceneManager's worker threads, and stores all hits in a single
+        compact array; grouped by query, in the same order the shapes were given.
+    @par
+        Like the other queries, objects are tested with their world bounds
+        (aabbs for rays and boxes, bounding spheres for spheres), which must be up
+        to date (i.e. perform the queries after SceneManager::updateSceneGraph).
+    @par
+        Static objects can optionally be put in a BVH with buildStaticBvh(), so that
+        each shape only visits the static objects near it instead of all of them.
+    @par
+        Execute functions must be called from the main thread, while the worker
+        threads are idle (i.e. not from inside a UniformScalableTask or a listener).
+        Create it with SceneManager::createBatchedQuery and destroy it with
+        SceneManager::destroyQuery.
+    */
+    class _OgreExport BatchedSceneQuery : public SceneQuery, public UniformScalableTask
+    {
+    public:
+        struct Hit
+        {
+            MovableObject *movable;
+            /// Distance along the ray. Always 0 for sphere and box queries
+            Real distance;
+
+            bool operator<( const Hit &other ) const { return this->distance < other.distance; }
+        };
+
+        typedef vector<Hit>::type HitVec;
+
+    protected:
+        enum QueryType
+        {
+            QueryRay,
+            QuerySphere,
+            QueryAabb
+        };
+
+        struct BvhNode
+        {
+            Aabb aabb;
+            /// Leaves: first object in mBvhObjects.
+            /// Inner nodes: index of the second child (the first one is the next node)
+            uint32 firstObjOrRightChild;
+            /// 0 for inner nodes
+            uint32 numObjects;
+        };
+
+        struct BvhObject
+        {
+            MovableObject *movable;
+            Aabb           aabb;
+            Real           worldRadius;
+        };
+
+        typedef vector<BvhNode>::type   BvhNodeVec;
+        typedef vector<BvhObject>::type BvhObjectVec;
+
+        QueryType             mQueryType;
+        Ray const            *mRays;
+        Sphere const         *mSpheres;
+        AxisAlignedBox const *mAabbs;
+        size_t                mNumQueries;
+        bool                  mClosestHitOnly;
+
+        /// mHitStart[i] is the index in mHits of query i's first hit.
+        /// Has mNumQueries + 1 entries so that the last query's count can be calculated.
+        vector<uint32>::type mHitStart;
+        HitVec               mHits;
+
+        /// Per thread. Each thread processes a contiguous range of queries, and
+        /// writes how many hits each of those queries had to mHitStart[query + 1]
+        vector<HitVec>::type mThreadHits;
+
+        BvhNodeVec   mBvhNodes;
+        BvhObjectVec mBvhObjects;
+
+        uint32 buildBvhNode( size_t objStart, size_t objEnd );
+
+        bool passesFilters( const MovableObject *movable ) const;
+
+        /// Tests a single ray/sphere/box against all objects
+        template <typename T>
+        void queryShape( const T &shape, HitVec &outHits ) const;
+        /// Sweeps all non-static objects (or all objects if there is no BVH) 4 at a time
+        template <typename T>
+        void queryDynamic( const T &shape, HitVec &outHits ) const;
+        template <typename T>
+        void queryStaticBvh( const T &shape, HitVec &outHits ) const;
+
+        void dispatch();
+
+    public:
+        BatchedSceneQuery( SceneManager *creator );
+        ~BatchedSceneQuery() override;
+
+        /** Tests all rays against the scene.
+        @param rays
+            Array of rays. Only used during this call.
+        @param numRays
+            Number of elements in rays
+        @param closestHitOnly
+            When true, each ray keeps at most its closest hit. Otherwise every hit is
+            kept, sorted from closest to furthest.
+        */
+        void executeRays( const Ray *rays, size_t numRays, bool closestHitOnly );
+
+        /// Tests all spheres against the scene (against the objects' bounding spheres)
+        void executeSpheres( const Sphere *spheres, size_t numSpheres );
+
+        /// Tests all boxes against the scene (against the objects' aabbs)
+        void executeAabbs( const AxisAlignedBox *aabbs, size_t numAabbs );
+
+        /** Puts all static objects (SCENE_STATIC) in a BVH. From now on, queries will
+            traverse it instead of sweeping every static object.
+        @remarks
+            The BVH is built from the static objects' current world bounds, and holds
+            pointers to them. It must be rebuilt (or cleared) after static objects are
+            moved, added or destroyed.
+        */
+        void buildStaticBvh();
+        void clearStaticBvh();
+        bool hasStaticBvh() const { return !mBvhNodes.empty(); }
+
+        /// Results of the last execute call. Hits of the same query are contiguous.
+        const HitVec &getHits() const { return mHits; }
+
+        /// Index in getHits() of the first hit of the given query
+        size_t getFirstHit( size_t queryIdx ) const { return mHitStart[queryIdx]; }
+        /// Number of hits of the given query
+        size_t getNumHits( size_t queryIdx ) const
+        {
+            return mHitStart[queryIdx + 1u] - mHitStart[queryIdx];
+        }
+
+        /// UniformScalableTask override. Don't call this directly.
+        void execute( size_t threadId, size_t numThreads ) override;
+    };
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 
 #include "OgreForwardPlusBase.h"
+#include "OgrePlane.h"
 #include "OgreRawPtr.h"
 #include "Threading/OgreUniformScalableTask.h"
 
@@ -59,6 +60,25 @@ namespace Ogre
             ArrayAabb    aabb;
             ArrayVector3 corners[8];
         };
+        /// Slice-independent bounding volume of a light, decal or cubemap probe.
+        struct BinVolume
+        {
+            /// Sphere. Only used when numVertices == 0.
+            Vector3 center;
+            Real    radius;
+            /// Convex hull. The planes are only used by lights.
+            Plane   planes[6];
+            Vector3 vertices[8];
+            uint32  numVertices;
+        };
+        /// Inclusive range of cells within a slice.
+        struct TileRange
+        {
+            uint32 minX;
+            uint32 maxX;
+            uint32 minY;
+            uint32 maxY;
+        };
 
         uint32 mWidth;
         uint32 mHeight;
@@ -79,6 +99,14 @@ namespace Ogre
         float mExponentK;
         float mInvExponentK;
 
+        /// See setSliceDepths(). When empty, slices are distributed exponentially.
+        FastArray<float> mSliceDepths;
+
+        /// One per entry in mCurrentLightList. See prepareLightVolumes().
+        FastArray<BinVolume> mLightVolumes;
+        /// getTilePlanesStride() planes per thread. See getTileRange().
+        FastArray<Plane> mTilePlanes;
+
         ObjectMemoryManager   *mObjectMemoryManager;
         NodeMemoryManager     *mNodeMemoryManager;
         vector<Camera *>::type mThreadCameras;
@@ -88,6 +116,8 @@ namespace Ogre
 
         inline size_t getDecalsOffsetStart() const;
         inline size_t getCubemapProbesOffsetStart() const;
+        inline size_t getNumSliceDepthsFloat4() const;
+        inline size_t getTilePlanesStride() const;
 
         /// Performs the reverse of getSliceAtDepth. @see getSliceAtDepth.
         inline float getDepthAtSlice( uint32 slice ) const;
@@ -100,7 +130,25 @@ namespace Ogre
         */
         inline uint32 getSliceAtDepth( Real depth ) const;
 
-        void collectObjsForSlice( const size_t numPackedFrustumsPerSlice, const size_t frustumStartIdx,
+        /** Conservatively finds the cells of a slice the volume may touch, testing it against
+            the planes shared by entire rows & columns of cells. This way the per-cell tests
+            only run on a small subset of the slice.
+        @param tilePlanes
+            Near & far planes of the slice, followed by the left & right planes of each column,
+            followed by the top & bottom planes of each row.
+        @return
+            False if the volume doesn't touch the slice at all.
+        */
+        inline bool getTileRange( const Plane *RESTRICT_ALIAS tilePlanes, const BinVolume &volume,
+                                  TileRange &outRange ) const;
+
+        inline void addLightToCells( size_t packedFrustumIdx, uint32 scalarMask, size_t lightIdx,
+                                     Light::LightTypes lightType );
+
+        /// Builds mLightVolumes out of mCurrentLightList.
+        void prepareLightVolumes();
+
+        void collectObjsForSlice( const Plane *RESTRICT_ALIAS tilePlanes, const size_t frustumStartIdx,
                                   uint16 offsetStart, size_t minRq, size_t maxRq, size_t currObjsPerCell,
                                   size_t cellOffsetStart, ObjTypes objType, uint16 numFloat4PerObj );
         void collectLightForSlice( size_t slice, size_t threadId );
@@ -134,6 +182,17 @@ namespace Ogre
         float  getMinDistance() const { return mMinDistance; }
         float  getMaxDistance() const { return mMaxDistance; }
 
+        /** Replaces the default exponential depth slicing with user-defined slices.
+            e.g. to concentrate slices where most lights are, or to use linear slicing.
+        @param sliceDepths
+            Distances to the camera (positive, view space) where each slice ends, in strictly
+            increasing order. Must contain exactly getNumSlices() - 1 values: the first slice
+            starts at the near plane and the last one extends to the far plane.
+            Pass an empty array to go back to exponential slicing.
+        */
+        void setSliceDepths( const FastArray<float> &sliceDepths );
+        const FastArray<float> &getSliceDepths() const { return mSliceDepths; }
+
         /// Returns the amount of bytes that fillConstBufferData is going to fill.
         size_t getConstBufferSize() const override;
 
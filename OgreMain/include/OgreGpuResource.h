@@ -135,8 +135,8 @@ namespace Ogre
         /// (if memory thresholds are exceeded, and multiplied by rank).
         /// The minimum distance to camera may be saved as well. More distant textures
         /// may be paged out and replaced with 64x64 mips.
-        uint32 mLastFrameUsed;
-        float  mLowestDistanceToCamera;
+        mutable uint32 mLastFrameUsed;
+        float          mLowestDistanceToCamera;
 
         VaoManager *mVaoManager;
 
@@ -195,6 +195,22 @@ namespace Ogre
         */
         uint32 getPendingResidencyChanges() const;
 
+        /** Sets the rank of this resource. See mRank.
+        @param rank
+            0 means the resource must always stay resident and will never be paged out
+            automatically (see TextureResidencyManager).
+            Bigger values make the resource more likely to be paged out when unused.
+        */
+        void  setRank( int32 rank ) { mRank = rank; }
+        int32 getRank() const { return mRank; }
+
+        /// Saves the current frame as the last time this resource was used.
+        /// Called automatically when a texture gets bound for rendering.
+        virtual void _touch() const;
+
+        /// Value of VaoManager::getFrameCount the last time this resource was touched.
+        uint32 getLastFrameUsed() const { return mLastFrameUsed; }
+
         IdString getName() const;
         /// Retrieves a user-friendly name. May involve a look up.
         /// NOT THREAD SAFE. ONLY CALL FROM MAIN THREAD.
@@ -1185,8 +1185,13 @@ namespace Ogre
         static const IdString Pose;
         static const IdString PoseHalfPrecision;
         static const IdString PoseNormals;
+        /// Set when the Renderable was already skinned by ComputeSkinning. hlms_skeleton is
+        /// then unset, and the skinned vertices are read from the preSkinnedBuf buffer.
+        static const IdString PreSkinned;
 
         static const IdString Normal;
+        /// Set along with Normal when the normal is octahedral encoded in 2 components
+        static const IdString NormalOct;
         static const IdString QTangent;
         static const IdString Tangent;
         static const IdString Tangent4;
@@ -1262,6 +1267,7 @@ namespace Ogre
         static const IdString FwdClusteredWidthxHeight;
         static const IdString FwdClusteredWidth;
         static const IdString FwdClusteredLightsPerCell;
+        static const IdString FwdClusteredSliceDepths;
         static const IdString EnableDecals;
         static const IdString FwdPlusDecalsSlotOffset;
         static const IdString DecalsDiffuse;
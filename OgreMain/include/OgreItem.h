@@ -137,6 +137,30 @@ namespace Ogre
          */
         size_t getNumSubItems() const;
 
+        /** Finds the closest triangle of this Item hit by the ray, by traversing the
+            TriangleBvh of each SubMesh (see SubMesh::getTriangleBvh).
+        @remarks
+            Uses the parent node's derived transform, which must be up to date.
+            Skeletal and pose animations are not taken into account.
+        @param ray
+            Ray in world space.
+        @param maxDistance
+            Hits further than this are ignored.
+        @param outHit [out]
+            The hit. distance is in world units if the ray's direction is normalised.
+            Left untouched if nothing was hit.
+        @param outSubMeshIdx [out]
+            The SubMesh (and SubItem) that was hit.
+        @param positiveSide
+            Whether to hit triangles from their front side.
+        @param negativeSide
+            Whether to hit triangles from their back side.
+        @return
+            True if a triangle was hit.
+        */
+        bool raycast( const Ray &ray, Real maxDistance, TriangleRayHit &outHit, size_t &outSubMeshIdx,
+                      bool positiveSide = true, bool negativeSide = false );
+
         /// Sets the given HLMS databloock to all SubEntities
         void setDatablock( HlmsDatablock *datablock );
 
@@ -237,6 +261,16 @@ namespace Ogre
         */
         void setSkeletonEnabled( bool bEnable );
 
+        /** When false, the bones that don't deform any SubItem of this Item (and aren't
+            parents of bones that do) won't be animated. See SkeletonInstance::setSkinnedBones
+        @remarks
+            Does nothing if the Mesh does not have skeletons.
+            If the SkeletonInstance is shared with other Items (see useSkeletonInstanceFrom)
+            only the bones used by this Item are taken into account.
+            Call again after attaching TagPoints to bones without vertices.
+        */
+        void setAnimateUnskinnedBones( bool bAnimate );
+
         /** Returns whether or not this Item is either morph or pose animated.
          */
         // bool hasVertexAnimation() const;
@@ -87,6 +87,7 @@ namespace Ogre
     {
         friend class SubMesh;
         friend class MeshSerializerImpl;
+        friend class MeshSerializerImpl_Flat;
 
     public:
         typedef FastArray<Real>         LodValueArray;
@@ -363,6 +364,12 @@ namespace Ogre
         /// Explicitly set a hash for caches. See Mesh::getHashForCaches
         void _setHashForCaches( const uint64 hash[2] );
 
+        /** Internal use. Hands over the contents of the file, already read into memory
+            (e.g. by MeshManager::loadAsync's worker thread), so that load() doesn't need
+            to read it again. Does nothing unless the mesh is unloaded.
+        */
+        void _notifyPreparedData( const DataStreamPtr &data );
+
         /// Returns an array of [2] containing a hash for use in caches.
         /// A value of { 0, 0 } should be treated as not initialized.
         ///
@@ -454,10 +461,16 @@ namespace Ogre
         void importV1( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents,
                        bool halfPose = true );
 
-        /// Converts this SubMesh to an efficient arrangement. See Mesh::importV1 for an
-        /// explanation on the parameters. @see dearrangeEfficientToInefficient
-        /// to perform the opposite operation.
-        void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents );
+        /** Converts this Mesh to an efficient arrangement. See Mesh::importV1 for an
+            explanation on the parameters. @see dearrangeEfficientToInefficient
+            to perform the opposite operation.
+        @param octahedralNormals
+            Converts normals (3 floats, 12 bytes) to octahedral encoding (2 shorts, 4 bytes).
+            Only applies to vertices that don't get converted to QTangents, i.e. those
+            without tangents or when qTangents is false.
+        */
+        void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                               bool octahedralNormals = false );
 
         /// Reverts the effects from arrangeEfficient by converting all 16-bit half float back
         /// to 32-bit float; and QTangents to Normal, Tangent + Reflection representation,
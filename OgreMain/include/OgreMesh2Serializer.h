@@ -66,7 +66,10 @@ namespace Ogre
 
         /// OGRE version v2.0+
         MESH_VERSION_2_1,
-        MESH_VERSION_LEGACY  // R0 & R1 (beta)
+        MESH_VERSION_LEGACY,  // R0 & R1 (beta)
+        /// Same contents as MESH_VERSION_2_1, laid out to be loaded without parsing.
+        /// Native endianness only. See MeshSerializerImpl_Flat
+        MESH_VERSION_2_1_FLAT
     };
 
     /** \addtogroup Core
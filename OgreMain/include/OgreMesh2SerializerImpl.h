@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreKeyFrame.h"
 #include "OgreSerializer.h"
 #include "OgreVertexBoneAssignment.h"
+#include "Vao/OgreStagingUploadBatch.h"
 #include "Vao/OgreVertexBufferPacked.h"
 
 namespace Ogre
@@ -72,7 +73,8 @@ namespace Ogre
         @param stream The destination stream
         @param endianMode The endian mode for the written file
         */
-        void exportMesh( const Mesh *pMesh, DataStreamPtr stream, Endian endianMode = ENDIAN_NATIVE );
+        virtual void exportMesh( const Mesh *pMesh, DataStreamPtr stream,
+                                 Endian endianMode = ENDIAN_NATIVE );
 
         /** Imports Mesh and (optionally) Material data from a .mesh file DataStream.
         @remarks
@@ -82,7 +84,7 @@ namespace Ogre
         buffer).
         @param pDest Pointer to the Mesh object which will receive the data. Should be blank already.
         */
-        void importMesh( DataStreamPtr &stream, Mesh *pDest, MeshSerializerListener *listener );
+        virtual void importMesh( DataStreamPtr &stream, Mesh *pDest, MeshSerializerListener *listener );
 
     protected:
         typedef vector<uint8>::type                     LodLevelVertexBufferTable;
@@ -105,6 +107,14 @@ namespace Ogre
 
         typedef vector<SubMeshLod>::type SubMeshLodVec;
 
+        /// Throws if pMesh can't be exported to the given stream. Sets mStream otherwise.
+        void validateForExport( const Mesh *pMesh, DataStreamPtr &stream );
+
+        /// For each submesh, fills which LOD owns the vertex buffers used by each LOD level
+        /// (i.e. lodVertexTable[subMeshIdx][lodLevel] <= lodLevel)
+        static void buildLodVertexTable( const Mesh                   *pMesh,
+                                         LodLevelVertexBufferTableVec &outLodVertexTable );
+
         // Internal methods
         virtual void writeSubMeshNameTable( const Mesh *pMesh );
         virtual void writeMeshHashForCaches( const Mesh *pMesh );
@@ -217,6 +227,8 @@ namespace Ogre
         uint64      mCalculatedHash[2];  // Calculated when exporting
         ushort      exportedLodCount;    // Needed to limit exported Edge data, when exporting
         VaoManager *mVaoManager;
+        /// BT_DEFAULT buffers get their data through here, flushed once the whole mesh is read
+        StagingUploadBatch mUploadBatch;
     };
 
     class _OgrePrivate MeshSerializerImpl_v2_1_R1 : public MeshSerializerImpl
@@ -240,6 +252,63 @@ namespace Ogre
         void readMesh( DataStreamPtr &stream, Mesh *pMesh, MeshSerializerListener *listener ) override;
     };
 
+    /** Reads & writes the "[MeshSerializer_v2.1 Flat]" format.
+    @remarks
+        Unlike the chunk-based format, the file is laid out the way it will be used:
+        a fixed-size header, followed by fixed-size submesh & LOD tables, and finally
+        all vertex & index data as a single blob. Every buffer in the blob is aligned
+        to 16 bytes.
+    @par
+        Loading doesn't parse anything per element. The tables are read straight from
+        the memory holding the file, and the blob is copied into StagingBuffers with
+        a single memcpy per StagingBuffer.
+    @par
+        The data is always in native endianness. Files written on a machine with
+        different endianness are rejected; re-export them with OgreMeshTool.
+        Only one vertex buffer source per Vao is supported.
+    @par
+        Pose animation data (see SubMesh::createPoses) is stored in the blob as well.
+    */
+    class _OgrePrivate MeshSerializerImpl_Flat : public MeshSerializerImpl
+    {
+    public:
+        MeshSerializerImpl_Flat( VaoManager *vaoManager );
+        ~MeshSerializerImpl_Flat() override;
+
+        void exportMesh( const Mesh *pMesh, DataStreamPtr stream,
+                         Endian endianMode = ENDIAN_NATIVE ) override;
+        void importMesh( DataStreamPtr &stream, Mesh *pDest, MeshSerializerListener *listener ) override;
+
+    protected:
+        struct PendingUpload
+        {
+            BufferPacked *buffer;
+            /// Offset in the blob, in bytes
+            size_t srcOffset;
+            size_t length;
+        };
+        typedef vector<PendingUpload>::type PendingUploadVec;
+
+        /// Offset in the file where the header starts
+        size_t getHeaderOffset() const;
+
+        /// Reads back the buffer from the GPU and appends it to the blob, aligned
+        /// to 16 bytes. Returns the offset in the blob.
+        size_t appendToBlob( BufferPacked *buffer, vector<uint8>::type &blob );
+
+        void importFromMemory( const uint8 *data, size_t sizeBytes, Mesh *pMesh,
+                               MeshSerializerListener *listener );
+
+        /// Recreates the poses of subMesh from the blob, see SubMesh::createPoses
+        void importPoses( const uint8 *data, size_t sizeBytes, const uint8 *blob, uint64 blobSize,
+                          uint16 numPoses, uint8 poseFlags, uint64 poseDataOffset,
+                          uint32 poseNameTableOffset, uint32 numVertices, SubMesh *subMesh,
+                          const String &meshName );
+
+        /// Copies the blob ranges into as few StagingBuffers as possible
+        void uploadFromBlob( const uint8 *blob, PendingUploadVec &pendingUploads );
+    };
+
     /** @} */
     /** @} */
 }  // namespace Ogre
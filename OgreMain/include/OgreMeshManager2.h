@@ -33,6 +33,9 @@ THE SOFTWARE.
 #include "OgreResourceManager.h"
 #include "OgreSingleton.h"
 #include "OgreVector3.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreWaitableEvent.h"
 #include "Vao/OgreBufferPacked.h"
 
 #include "OgreHeaderPrefix.h"
@@ -45,6 +48,18 @@ namespace Ogre
     /** \addtogroup Resources
      *  @{
      */
+    /** Gets notified when a mesh requested via MeshManager::loadAsync is done loading.
+        Always called from the main thread, from within MeshManager::_update.
+    */
+    class _OgreExport MeshAsyncLoadListener
+    {
+    public:
+        virtual ~MeshAsyncLoadListener();
+
+        /// success is false if the mesh could not be loaded. The error has already been logged.
+        virtual void meshLoadCompleted( Mesh *mesh, bool success ) = 0;
+    };
+
     /** Handles the management of mesh resources.
         @remarks
             This class deals with the runtime management of
@@ -56,6 +71,29 @@ namespace Ogre
                                           public Singleton<MeshManager>,
                                           public ManualResourceLoader
     {
+    public:
+        /// Vertex formats to convert meshes to when they're loaded. See Mesh::arrangeEfficient
+        struct VertexCompression
+        {
+            bool halfPos;
+            bool halfTexCoords;
+            bool qTangents;
+            bool octahedralNormals;
+
+            VertexCompression() :
+                halfPos( false ),
+                halfTexCoords( false ),
+                qTangents( false ),
+                octahedralNormals( false )
+            {
+            }
+
+            bool isEnabled() const
+            {
+                return halfPos || halfTexCoords || qTangents || octahedralNormals;
+            }
+        };
+
     protected:
         /// @copydoc ResourceManager::createImpl
         Resource *createImpl( const String &name, ResourceHandle handle, const String &group,
@@ -67,6 +105,51 @@ namespace Ogre
         // the factor by which the bounding box of an entity is padded
         Real mBoundsPaddingFactor;
 
+        /// See MeshOptimizer::OptimizationFlags
+        uint32 mOptimizationFlags;
+
+        VertexCompression mVertexCompression;
+
+        struct AsyncLoadRequest
+        {
+            MeshPtr                                  mesh;
+            vector<MeshAsyncLoadListener *>::type listeners;
+        };
+        typedef map<Mesh *, AsyncLoadRequest>::type AsyncLoadRequestMap;
+
+        /// What the worker thread gets to see. It never touches the Mesh itself
+        struct AsyncFileRequest
+        {
+            Mesh         *mesh;
+            Archive      *archive;
+            String        name;
+            DataStreamPtr data;
+            String        error;
+        };
+        typedef vector<AsyncFileRequest>::type AsyncFileRequestVec;
+
+        /// Main thread only
+        AsyncLoadRequestMap mAsyncLoadRequests;
+        /// Main thread -> worker thread. Protected by mAsyncMutex
+        AsyncFileRequestVec mAsyncFileRequests;
+        /// Worker thread -> main thread. Protected by mAsyncMutex
+        AsyncFileRequestVec mAsyncFileResults;
+        /// Worker thread only
+        AsyncFileRequestVec mAsyncWorkerRequests;
+        /// Main thread only
+        AsyncFileRequestVec mAsyncMainResults;
+        LightweightMutex    mAsyncMutex;
+        WaitableEvent       mAsyncWorkerEvent;
+        ThreadHandlePtr     mAsyncWorkerThread;
+        bool                mAsyncShuttingDown;
+        uint32              mAsyncLoadBudgetUs;
+
+        /// Reads the files in mAsyncFileRequests into memory. Runs in the worker thread.
+        void processAsyncFileRequests();
+
+        /// Finishes loading a mesh whose file has been read by the worker thread
+        void finishAsyncLoad( AsyncFileRequest &fileRequest );
+
     public:
         MeshManager();
         ~MeshManager() override;
@@ -165,6 +248,48 @@ namespace Ogre
 #    pragma clang diagnostic pop
 #endif
 
+        /** Loads a mesh in the background. The file is read by a worker thread, while
+            deserialisation and buffer creation happen in the main thread during _update
+            (called every frame by Root), within the budget set by setAsyncLoadBudget.
+        @remarks
+            Until it's done, the mesh is marked as background loaded (see
+            Resource::setBackgroundLoaded), thus load() does nothing. Items can be created
+            with it right away: they stay empty and get their SubItems once the mesh is loaded.
+        @par
+            If the mesh is already loaded the listener is called right away.
+            Meshes stored in the "[MeshSerializer_v2.1 Flat]" format are recommended, as
+            they take the least time to deserialise in the main thread.
+        @param listener
+            Optional. Gets notified when loading finishes, successfully or not.
+            Must remain valid until then.
+        @return
+            The mesh, which may not be loaded yet.
+        */
+        MeshPtr loadAsync( const String &filename, const String &groupName,
+                           MeshAsyncLoadListener *listener = 0,
+                           BufferType vertexBufferType = BT_IMMUTABLE,
+                           BufferType indexBufferType = BT_IMMUTABLE,
+                           bool vertexBufferShadowed = true, bool indexBufferShadowed = true );
+
+        /// Returns true if there are meshes requested via loadAsync that are not loaded yet
+        bool hasPendingAsyncLoads() const { return !mAsyncLoadRequests.empty(); }
+
+        /// Blocks until all meshes requested via loadAsync are loaded
+        void waitForAsyncLoads();
+
+        /** Maximum time in microseconds that _update spends loading meshes whose files are
+            ready. At least one mesh is always loaded per call. Default is 2000 (2ms).
+        */
+        void   setAsyncLoadBudget( uint32 microseconds ) { mAsyncLoadBudgetUs = microseconds; }
+        uint32 getAsyncLoadBudget() const { return mAsyncLoadBudgetUs; }
+
+        /// Finishes loading the meshes requested via loadAsync whose files are ready.
+        /// Called by Root every frame.
+        void _update();
+
+        /// Worker thread's main loop. Do not call directly.
+        unsigned long _updateAsyncWorkerThread( ThreadHandle *threadHandle );
+
         /** Creates a new Mesh specifically for manual definition rather
             than loading from an object file.
         @remarks
@@ -263,6 +388,30 @@ namespace Ogre
          */
         void setBoundsPaddingFactor( Real paddingFactor );
 
+        /** Sets the optimizations to apply to every mesh loaded from file from now on.
+            See MeshOptimizer::OptimizationFlags. Default is 0 (none).
+        @remarks
+            Meshes are optimized after being loaded, thus this increases loading times.
+            Prefer optimizing the meshes offline with the MeshTool instead.
+        */
+        void   setOptimizationFlags( uint32 flags ) { mOptimizationFlags = flags; }
+        uint32 getOptimizationFlags() const { return mOptimizationFlags; }
+
+        /** Sets the vertex formats every mesh loaded from file will be converted to from
+            now on (e.g. 16-bit half positions & UVs, QTangents and octahedral normals),
+            roughly halving their memory & bandwidth footprint.
+            Default is to keep the formats stored in the file.
+        @remarks
+            Data that is already compressed is left as is.
+            The conversion happens after loading, thus it increases loading times.
+            Prefer converting the meshes offline with the MeshTool (-O option) instead.
+        */
+        void setVertexCompression( const VertexCompression &vertexCompression )
+        {
+            mVertexCompression = vertexCompression;
+        }
+        const VertexCompression &getVertexCompression() const { return mVertexCompression; }
+
         /** Sets the listener used to control mesh loading through the serializer.
          */
         // void setListener(MeshSerializerListener *listener);
@@ -0,0 +1,227 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreMeshOptimizer_H_
+#define _OgreMeshOptimizer_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreMeshlet.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup Resources
+     *  @{
+     */
+
+    /** Reorders the vertex & index data of v2 meshes so that they are faster to render.
+
+        The following optimizations are available and are applied in this order:
+            - RemoveDuplicateVertices: Vertices that are bitwise identical are merged
+              into one.
+            - OptimizeVertexCache: Reorders triangles to maximize post-transform vertex
+              cache hits (Tom Forsyth's Linear-Speed Vertex Cache Optimisation).
+            - OptimizeOverdraw: Splits the (cache-optimized) triangle list in clusters
+              and sorts them so that triangles on the outer surface are drawn first,
+              reducing overdraw without hurting vertex cache efficiency much.
+            - OptimizeVertexFetch: Reorders the vertices in the order they are first
+              referenced by the index buffer, improving memory locality of vertex fetch.
+              Unreferenced vertices are dropped.
+            - BuildMeshlets: Groups the triangles of LOD 0 into small clusters (Meshlets)
+              with their own bounding sphere and normal cone, so that the RenderQueue
+              can skip the clusters that are out of the frustum or fully back-facing.
+              Reorders the triangles (after OptimizeVertexCache & OptimizeOverdraw),
+              so it's not part of OptimizeAll. Only worth it for big meshes.
+        All LODs sharing the same vertex buffer are taken into account.
+
+        Vertex cache efficiency is measured with ACMR (Average Cache Miss Ratio, vertex
+        shader invocations per triangle; lower is better, optimal is ~0.5) and
+        ATVR (Average Transformed Vertex Ratio, vertex shader invocations per vertex;
+        lower is better, optimal is 1.0).
+    @remarks
+        The low level functions work on 32-bit CPU indices and can be used on any
+        triangle list. optimize( Mesh* ) downloads the data from GPU, optimizes it,
+        and recreates the buffers.
+    */
+    class _OgreExport MeshOptimizer
+    {
+    public:
+        enum OptimizationFlags
+        {
+            OptimizeVertexCache = 1u << 0u,
+            OptimizeOverdraw = 1u << 1u,
+            OptimizeVertexFetch = 1u << 2u,
+            RemoveDuplicateVertices = 1u << 3u,
+            BuildMeshlets = 1u << 4u,
+            OptimizeAll = OptimizeVertexCache | OptimizeOverdraw | OptimizeVertexFetch |
+                          RemoveDuplicateVertices
+        };
+
+        /// Vertices not referenced by any index are set to this value by the remap functions
+        static const uint32 InvalidIndex = 0xFFFFFFFF;
+
+        struct VertexCacheStats
+        {
+            size_t numTriangles;
+            size_t numVertices;
+            /// Simulated vertex shader invocations
+            size_t numTransformed;
+
+            VertexCacheStats() : numTriangles( 0u ), numVertices( 0u ), numTransformed( 0u ) {}
+
+            /// Average Cache Miss Ratio. Vertex shader invocations per triangle.
+            float getAcmr() const
+            {
+                return numTriangles ? float( numTransformed ) / float( numTriangles ) : 0.0f;
+            }
+            /// Average Transformed Vertex Ratio. Vertex shader invocations per vertex.
+            float getAtvr() const
+            {
+                return numVertices ? float( numTransformed ) / float( numVertices ) : 0.0f;
+            }
+
+            void accumulate( const VertexCacheStats &other )
+            {
+                numTriangles += other.numTriangles;
+                numVertices += other.numVertices;
+                numTransformed += other.numTransformed;
+            }
+        };
+
+        /** Simulates a FIFO post-transform vertex cache to measure how efficient the
+            given triangle list is.
+        @param cacheSize
+            Number of entries of the simulated cache. 16 is a reasonable approximation
+            of modern HW.
+        */
+        static VertexCacheStats analyzeVertexCache( const uint32 *indices, size_t numIndices,
+                                                    size_t numVertices, uint32 cacheSize = 16u );
+
+        /// Reorders the triangles in-place to maximize vertex cache hits.
+        static void optimizeVertexCache( uint32 *indices, size_t numIndices, size_t numVertices );
+
+        /** Reorders clusters of triangles in-place to reduce overdraw. Should be called
+            after optimizeVertexCache, since clusters are split where the vertex cache
+            would be flushed anyway.
+        @param positions
+            Array with numVertices positions.
+        */
+        static void optimizeOverdraw( uint32 *indices, size_t numIndices, const Vector3 *positions,
+                                      size_t numVertices );
+
+        /** Groups triangles into clusters of at most maxVertices unique vertices and
+            maxTriangles triangles, reordering them in-place so each cluster is a
+            contiguous range of indices.
+        @remarks
+            Clusters are grown greedily across neighbouring triangles, preferring the
+            ones that add fewer new vertices, then the ones closer to the cluster.
+            This keeps clusters compact (tight bounds) while mostly preserving the
+            vertex cache friendliness of the input order.
+        @param positions
+            Array with numVertices positions.
+        @param outMeshlets [out]
+            Cleared and filled with the clusters, in index buffer order.
+        */
+        static void buildMeshlets( uint32 *indices, size_t numIndices, const Vector3 *positions,
+                                   size_t numVertices, MeshletVec &outMeshlets,
+                                   uint32 maxVertices = 64u, uint32 maxTriangles = 124u );
+
+        /** Generates a remap table that merges bitwise identical vertices.
+        @param outRemap [out]
+            Array of numVertices entries. outRemap[oldIdx] = newIdx.
+        @return
+            Number of unique vertices.
+        */
+        static size_t generateDuplicateRemap( uint32 *outRemap, const uint8 *vertexData,
+                                              size_t numVertices, size_t bytesPerVertex );
+
+        /** Generates a remap table that sorts the vertices in the order they're first
+            referenced by the index buffer.
+        @param outRemap [out]
+            Array of numVertices entries. outRemap[oldIdx] = newIdx. Vertices
+            not referenced by the indices are set to InvalidIndex.
+        @return
+            Number of referenced vertices.
+        */
+        static size_t generateVertexFetchRemap( uint32 *outRemap, const uint32 *indices,
+                                                size_t numIndices, size_t numVertices );
+
+        /// Applies a remap table generated by generateDuplicateRemap or
+        /// generateVertexFetchRemap to the indices, in-place.
+        static void remapIndices( uint32 *indices, size_t numIndices, const uint32 *remap );
+
+        /** Applies a remap table generated by generateDuplicateRemap or
+            generateVertexFetchRemap to the vertices.
+        @param dstData
+            Must hold as many vertices as returned by the function that generated the remap.
+            Can't alias srcData.
+        @param srcData
+            Original vertex data, with numVertices vertices.
+        */
+        static void remapVertices( uint8 *RESTRICT_ALIAS dstData, const uint8 *RESTRICT_ALIAS srcData,
+                                   size_t numVertices, size_t bytesPerVertex, const uint32 *remap );
+
+        /** Optimizes all the submeshes of the given mesh, recreating their vertex and
+            index buffers (using the same buffer type and shadow copy settings).
+        @remarks
+            Submeshes that use something other than indexed triangle lists, or whose
+            Vaos have more than one vertex buffer are left untouched.
+        @par
+            Submeshes with poses only get their triangles reordered since the pose
+            data references the vertices by index.
+        @par
+            Shadow mapping Vaos are regenerated.
+        @param flags
+            Combination of OptimizationFlags.
+        @param outBefore [out]
+            Optional. Vertex cache stats of LOD 0 of all the optimized submeshes, before
+            optimizing.
+        @param outAfter [out]
+            Optional. Same as outBefore, after optimizing.
+        */
+        static void optimize( Mesh *mesh, uint32 flags, VertexCacheStats *outBefore = 0,
+                              VertexCacheStats *outAfter = 0 );
+
+    protected:
+        /// Returns false if the submesh isn't eligible for optimization
+        static bool optimize( SubMesh *subMesh, uint32 flags, VertexCacheStats &outBefore,
+                              VertexCacheStats &outAfter );
+    };
+
+    /** @} */
+    /** @} */
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
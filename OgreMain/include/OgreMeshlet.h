@@ -0,0 +1,107 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreMeshlet_H_
+#define _OgreMeshlet_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgrePlane.h"
+#include "OgreVector3.h"
+
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup Resources
+     *  @{
+     */
+
+    /** A cluster of (usually up to 124) triangles which are contiguous in the index buffer,
+        with the bounds needed to cull it as a whole. See MeshOptimizer::buildMeshlets.
+    */
+    struct Meshlet
+    {
+        /// Bounding sphere, in object space
+        Vector3 center;
+        float   radius;
+        /// All triangle normals are within the cone around coneAxis with half-angle
+        /// acos( coneCos ). When coneCos <= 0 the cone is too wide to be used for culling.
+        Vector3 coneAxis;
+        float   coneCos;
+        float   coneSin;
+        /// Range in the index buffer, in indices (not triangles)
+        uint32 indexStart;
+        uint32 indexCount;
+    };
+
+    typedef vector<Meshlet>::type MeshletVec;
+
+    /** Culls Meshlets of an object against a camera, in object space.
+    @code
+        MeshletCuller culler;
+        culler.setup( camera, worldMatrix, true );
+        for( size_t i = 0; i < meshlets.size(); ++i )
+            if( culler.isVisible( meshlets[i] ) ) ...
+    @endcode
+    */
+    class _OgreExport MeshletCuller
+    {
+        Plane   mPlanes[6];
+        size_t  mNumPlanes;
+        Vector3 mCameraPos;
+        bool    mBackfaceCulling;
+
+    public:
+        MeshletCuller();
+
+        /** Transforms the camera's frustum and position to the object's space.
+        @param worldMatrix
+            Affine transform of the object.
+        @param backfaceCulling
+            Whether clusters whose triangles are all back-facing can be culled.
+            Pass true only when the material culls counter-clockwise triangles
+            (i.e. CULL_CLOCKWISE, the default). Ignored if the transform mirrors.
+        */
+        void setup( const Camera *camera, const Matrix4 &worldMatrix, bool backfaceCulling );
+
+        bool isVisible( const Meshlet &meshlet ) const;
+    };
+
+    /** @} */
+    /** @} */
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
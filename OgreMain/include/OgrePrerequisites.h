@@ -139,6 +139,7 @@ namespace Ogre
     class AxisAlignedBox;
     class AxisAlignedBoxSceneQuery;
     class Barrier;
+    class BatchedSceneQuery;
     class BillboardSet;
     class Bone;
     class BoneMemoryManager;
@@ -152,6 +153,7 @@ namespace Ogre
     class Codec;
     class ColourValue;
     class CommandBuffer;
+    class ComputeSkinning;
     class ComputeTools;
     class ConfigDialog;
     class ConstBufferPacked;
@@ -324,9 +326,13 @@ namespace Ogre
     class TextureGpu;
     class TextureGpuListener;
     class TextureGpuManager;
+    class TextureReadbackQueue;
+    class TextureResidencyManager;
     struct TexturePool;
     struct Transform;
     class Timer;
+    class TriangleBvh;
+    struct TriangleRayHit;
     class UavBufferPacked;
     class UserObjectBindings;
     class VaoManager;
@@ -32,6 +32,7 @@ THE SOFTWARE.
 
 #include "OgreHlmsCommon.h"
 #include "OgreIteratorWrappers.h"
+#include "OgreMeshlet.h"
 #include "OgreSharedPtr.h"
 #include "Threading/OgreLightweightMutex.h"
 #include "Threading/OgreSemaphore.h"
@@ -221,8 +222,13 @@ namespace Ogre
         struct ThreadRenderQueue
         {
             QueuedRenderableArray q;
+            /// Upper bound of the extra draws needed to render the visible
+            /// meshlets of the Renderables in q (on top of one per Renderable)
+            size_t numExtraDraws;
             /// The padding prevents false cache sharing when multithreading.
             uint8 padding[128];
+
+            ThreadRenderQueue() : numExtraDraws( 0u ), padding() {}
         };
 
         typedef FastArray<ThreadRenderQueue> QueuedRenderableArrayPerThread;
@@ -252,6 +258,14 @@ namespace Ogre
         };
         typedef std::vector<PsoCreateEntry> PsoCreateEntryVec;
 
+        /// Consecutive visible meshlets, merged into a single draw
+        struct MeshletRun
+        {
+            uint32 indexStart;
+            uint32 indexCount;
+        };
+        typedef vector<MeshletRun>::type MeshletRunVec;
+
         RenderQueueGroup mRenderQueues[256];
 
         HlmsManager  *mHlmsManager;
@@ -277,6 +291,20 @@ namespace Ogre
 
         ParallelHlmsCompileQueue mParallelHlmsCompileQueue;
 
+        bool          mMeshletCulling;
+        MeshletCuller mMeshletCuller;
+        MeshletRunVec mMeshletRuns;
+
+        /** Culls the meshlets of LOD 0 of the given Renderable and fills mMeshletRuns
+            with the visible ranges.
+        @return
+            False if the Renderable can't use meshlet culling (or all of its meshlets
+            are visible) and should be drawn in one go; in which case mMeshletRuns is
+            left empty.
+        */
+        bool cullMeshlets( const QueuedRenderable &queuedRenderable, const VertexArrayObject *vao,
+                           const Camera *camera );
+
         /** Returns a new (or an existing) indirect buffer that can hold the requested number of
         draws.
         @param numDraws
@@ -424,6 +452,14 @@ namespace Ogre
         */
         void       setSortRenderQueue( uint8 rqId, RqSortMode sortMode );
         RqSortMode getSortRenderQueue( uint8 rqId ) const;
+
+        /** When enabled (default), v2 objects whose LOD 0 has meshlets (see
+            MeshOptimizer::BuildMeshlets) only draw the clusters of triangles that are
+            inside the camera frustum and not fully back-facing.
+            Does not apply to shadow caster passes, animated objects or instanced stereo.
+        */
+        void setMeshletCulling( bool meshletCulling ) { mMeshletCulling = meshletCulling; }
+        bool getMeshletCulling() const { return mMeshletCulling; }
     };
 
 #define OGRE_RQ_MAKE_MASK( x ) ( ( 1 << ( x ) ) - 1 )
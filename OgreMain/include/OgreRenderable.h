@@ -188,6 +188,16 @@ namespace Ogre
 
         TexBufferPacked *getPoseTexBuffer() const;
 
+        /// Buffer with this Renderable's vertices already skinned in world space
+        /// by ComputeSkinning. Null when skinning (if any) happens in the vertex shader.
+        ReadOnlyBufferPacked *getPreSkinnedBuffer() const { return mPreSkinnedBuffer; }
+
+        /** Sets the buffer returned by getPreSkinnedBuffer and recalculates the Hlms hashes
+            if that changes whether this Renderable is pre-skinned. Don't call this directly,
+            it's managed by ComputeSkinning.
+        */
+        void _setPreSkinnedBuffer( ReadOnlyBufferPacked *buffer );
+
         /** Returns whether the world matrix is an identity matrix.
         @remarks
             It is up to the Hlms implementation whether to honour this request. Take in mind
@@ -538,6 +548,8 @@ namespace Ogre
             PoseData();
         };
         SharedPtr<PoseData> mPoseData;
+
+        ReadOnlyBufferPacked *mPreSkinnedBuffer;
     };
 
     class _OgreExport RenderableAnimated : public Renderable
@@ -179,6 +179,24 @@ namespace Ogre
         BuildLightListRequest( size_t _startLightIdx ) : startLightIdx( _startLightIdx ) {}
     };
 
+    /// See SceneManager::setAnimationLod
+    struct AnimationLodLevel
+    {
+        /// Skeletons at this distance or farther from the camera use this level
+        Real distance;
+        /// Animations are sampled once every updateInterval frames. 0 freezes the pose.
+        uint32 updateInterval;
+
+        AnimationLodLevel( Real _distance, uint32 _updateInterval ) :
+            distance( _distance ),
+            updateInterval( _updateInterval )
+        {
+        }
+
+        bool operator<( const AnimationLodLevel &other ) const { return distance < other.distance; }
+    };
+    typedef vector<AnimationLodLevel>::type AnimationLodLevelVec;
+
     /** Struct that holds a number of cameras used in the current rendering pass
      */
     struct CamerasInProgress
@@ -417,6 +435,12 @@ namespace Ogre
         ObjectMemoryManagerVec mForwardPlusMemoryManagerCullList;
         SkeletonAnimManagerVec mSkeletonAnimManagerCulledList;
 
+        /// See setAnimationLod. mAnimationLodLevels is sorted by distance
+        Camera const        *mAnimationLodCamera;
+        AnimationLodLevelVec mAnimationLodLevels;
+        Vector3              mAnimationLodCameraPos;
+        uint32               mAnimationLodFrame;
+
         uint32 mNumDecals;
         uint32 mNumCubemapProbes;
 
@@ -491,6 +515,8 @@ namespace Ogre
 
         ParticleSystemManager2 *mParticleSystemManager2;
 
+        ComputeSkinning *mComputeSkinning;
+
         typedef vector<WireAabb *>::type WireAabbVec;
 
         WireAabbVec mTrackingWireAabbs;
@@ -899,6 +925,9 @@ namespace Ogre
             Must be unique for each worker thread
         */
         void updateAllAnimationsThread( size_t threadIdx );
+        /// Returns false if the skeleton's animations should not be sampled
+        /// this frame due to animation LOD. See setAnimationLod
+        bool needsAnimationUpdate( const SkeletonInstance *skeletonInstance ) const;
         void updateAnimationTransforms( BySkeletonDef &bySkeletonDef, size_t threadIdx );
 
         /** Updates the Nodes from the given request inside a thread. @see updateAllTransforms
@@ -1690,6 +1719,18 @@ namespace Ogre
 
         ParticleSystemManager2 *getParticleSystemManager2() { return mParticleSystemManager2; }
 
+        /** Enables skinning SubItems once per frame with a compute shader, reusing the
+            results in every pass (shadow maps, prepass, main pass...). See ComputeSkinning.
+        @remarks
+            Items must then be added with getComputeSkinning()->addItem().
+            Disabling it destroys the ComputeSkinning and all SubItems go back to
+            vertex shader skinning.
+        */
+        void setComputeSkinningEnabled( bool bEnabled );
+
+        /// Null unless setComputeSkinningEnabled( true ) was called
+        ComputeSkinning *getComputeSkinning() const { return mComputeSkinning; }
+
         /** Empties the entire scene, inluding all SceneNodes, Entities, Lights,
             BillboardSets etc. Cameras are not deleted at this stage since
             they are still referenced by viewports, which are not destroyed during
@@ -1897,6 +1938,27 @@ namespace Ogre
         */
         void updateAllAnimations();
 
+        /** Enables animation LOD: SkeletonInstances far from the camera sample their
+            animations less often, keeping their last pose in the frames in between.
+            Their bones still follow their SceneNode every frame.
+        @remarks
+            The distance is measured from the camera to the skeleton's parent node and is
+            scaled by the camera's LOD bias (see Camera::setLodBias).
+            Throttled skeletons are spread across frames so that, e.g. with
+            updateInterval = 4, a quarter of them gets updated each frame.
+        @par
+            Animations must keep being advanced every frame (e.g. via
+            SkeletonAnimation::addTime) as usual; throttling only affects sampling.
+        @param camera
+            Camera to measure distances from. Null to disable animation LOD (default).
+        @param levels
+            Distance thresholds. Skeletons closer than the first one are updated every frame.
+            Need not be sorted.
+        */
+        void setAnimationLod( const Camera *camera, const AnimationLodLevelVec &levels );
+        const Camera               *getAnimationLodCamera() const { return mAnimationLodCamera; }
+        const AnimationLodLevelVec &getAnimationLodLevels() const { return mAnimationLodLevels; }
+
         /** Updates the derived transforms of all nodes in the scene. This is typically called once
             per frame during render, but the user may want to manually call this function.
         @remarks
@@ -2293,6 +2355,17 @@ namespace Ogre
             certain objects; see SceneQuery for details.
         */
         virtual RaySceneQuery *createRayQuery( const Ray &ray, uint32 mask = QUERY_ENTITY_DEFAULT_MASK );
+        /** Creates a BatchedSceneQuery for this scene manager.
+        @remarks
+            Unlike the queries above, it tests many rays, spheres or boxes per execution,
+            using SIMD and the worker threads. See BatchedSceneQuery.
+        @par
+            The instance returned from this method must be destroyed by calling
+            SceneManager::destroyQuery when it is no longer required.
+        @param mask The query mask to apply to this query; can be used to filter out
+            certain objects; see SceneQuery for details.
+        */
+        virtual BatchedSceneQuery *createBatchedQuery( uint32 mask = QUERY_ENTITY_DEFAULT_MASK );
         // PyramidSceneQuery* createPyramidQuery(const Pyramid& p, unsigned long mask = 0xFFFFFFFF);
         /** Creates an IntersectionSceneQuery for this scene manager.
         @remarks
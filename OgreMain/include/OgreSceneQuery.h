@@ -32,6 +32,7 @@ THE SOFTWARE.
 
 #include "OgreRay.h"
 #include "OgreSphere.h"
+#include "OgreVector2.h"
 
 #include "ogrestd/list.h"
 #include "ogrestd/set.h"
@@ -359,6 +360,12 @@ namespace Ogre
         MovableObject *movable;
         /// The world fragment, or NULL if this is not a fragment result
         SceneQuery::WorldFragment *worldFragment;
+        /// The triangle that was hit (see TriangleRayHit). Only valid when
+        /// RaySceneQuery::setTriangleAccurate is enabled and movable is an Item;
+        /// otherwise triangleIdx is 0xFFFFFFFF
+        uint32  subMeshIdx;
+        uint32  triangleIdx;
+        Vector2 barycentric;
         /// Comparison operator for sorting
         bool operator<( const RaySceneQueryResultEntry &rhs ) const
         {
@@ -374,6 +381,7 @@ namespace Ogre
         Ray                 mRay;
         bool                mSortByDistance;
         ushort              mMaxResults;
+        bool                mTriangleAccurate;
         RaySceneQueryResult mResult;
 
     public:
@@ -407,6 +415,16 @@ namespace Ogre
         /** Gets the maximum number of results returned from the query (only relevant if
         results are being sorted) */
         virtual ushort getMaxResults() const;
+        /** Sets whether Items are tested against their triangles rather than their bounds.
+        @remarks
+            Only applies to the collection-returning version of execute. Items whose bounds are
+            hit but whose triangles aren't are discarded, and the entries of those that are hit
+            contain the exact distance, SubMesh and triangle. See Item::raycast.
+        @par
+            Other kinds of MovableObjects are still tested against their bounds.
+        */
+        void setTriangleAccurate( bool triangleAccurate ) { mTriangleAccurate = triangleAccurate; }
+        bool getTriangleAccurate() const { return mTriangleAccurate; }
         /** Executes the query, returning the results back in one list.
         @remarks
             This method executes the scene query as configured, gathers the results
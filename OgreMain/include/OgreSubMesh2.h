@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 #include "OgrePrerequisites.h"
 
+#include "OgreMeshlet.h"
 #include "OgreVertexBoneAssignment.h"
 #include "Vao/OgreVertexArrayObject.h"
 
@@ -117,10 +118,44 @@ namespace Ogre
         std::map<Ogre::String, size_t> mPoseIndexMap;
         TexBufferPacked               *mPoseTexBuffer;
 
+        /// Clusters of LOD 0 of mVao[VpNormal]. See MeshOptimizer::buildMeshlets
+        MeshletVec mMeshlets;
+
+        /// Triangles of LOD 0 of mVao[VpNormal]. Built on demand. See getTriangleBvh
+        TriangleBvh *mTriangleBvh;
+
     public:
         SubMesh();
         ~SubMesh();
 
+        /** Sets the clusters the triangles of LOD 0 are made of, and exposes them to the
+            RenderQueue through mVao[VpNormal][0] so it can cull them individually.
+        @remarks
+            The meshlets must match the current index buffer of mVao[VpNormal][0]; call this
+            again (or with an empty array) whenever that Vao is recreated.
+            Usually set by MeshOptimizer::optimize with MeshOptimizer::BuildMeshlets.
+        */
+        void              _setMeshlets( const MeshletVec &meshlets );
+        const MeshletVec &getMeshlets() const { return mMeshlets; }
+
+        /** Returns the BVH of the triangles of LOD 0 of mVao[VpNormal], used for exact raycasts
+            (see Item::raycast). It's built the first time it is requested and then shared by
+            all Items using this mesh.
+        @remarks
+            Building it reads the vertex and index buffers. If they don't have a shadow copy,
+            they're downloaded from the GPU, which stalls.
+        @par
+            Not thread safe. Skeletal and pose animation are not taken into account.
+        @return
+            Null if the submesh has no Vao or it isn't a triangle list.
+        */
+        const TriangleBvh *getTriangleBvh();
+
+        /// Destroys the BVH built by getTriangleBvh. Call it if you modify the vertex or index
+        /// data of LOD 0, so it gets rebuilt the next time it is needed. SubMesh and
+        /// MeshOptimizer already do it whenever they replace the Vaos.
+        void _invalidateTriangleBvh();
+
         /** Assigns a vertex to a bone with a given weight, for skeletal animation.
         @remarks
             This method is only valid after calling setSkeletonName.
@@ -193,10 +228,11 @@ namespace Ogre
         void importFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents,
                            bool halfPose );
 
-        /// Converts this SubMesh to an efficient arrangement. See Mesh::importV1 for an
+        /// Converts this SubMesh to an efficient arrangement. See Mesh::arrangeEfficient for an
         /// explanation on the parameters. @see dearrangeEfficientToInefficient
         /// to perform the opposite operation.
-        void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents );
+        void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                               bool octahedralNormals = false );
 
         /// Reverts the effects from arrangeEfficient by converting all 16-bit half float back
         /// to 32-bit float; and QTangents to Normal, Tangent + Reflection representation,
@@ -205,18 +241,21 @@ namespace Ogre
 
         void _prepareForShadowMapping( bool forceSameBuffers );
 
-        uint16 getNumPoses() { return mNumPoses; }
+        uint16 getNumPoses() const { return mNumPoses; }
 
-        bool getPoseHalfPrecision() { return mPoseHalfPrecision; }
+        bool getPoseHalfPrecision() const { return mPoseHalfPrecision; }
 
-        bool getPoseNormals() { return mPoseNormals; }
+        bool getPoseNormals() const { return mPoseNormals; }
 
         size_t getPoseIndex( const Ogre::String &name )
         {
             return mPoseIndexMap.count( name ) ? mPoseIndexMap[name] : SIZE_MAX;
         }
 
-        TexBufferPacked *getPoseTexBuffer() { return mPoseTexBuffer; }
+        /// Maps each pose name to its index in the pose buffer
+        const std::map<Ogre::String, size_t> &getPoseIndexMap() const { return mPoseIndexMap; }
+
+        TexBufferPacked *getPoseTexBuffer() const { return mPoseTexBuffer; }
 
         /** Fills the pose animation buffer with the given poseData.
         @param positionData
@@ -266,7 +305,7 @@ namespace Ogre
             with the original vao.
         */
         static VertexArrayObject *arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
-                                                    VertexArrayObject     *vao,
+                                                    bool octahedralNormals, VertexArrayObject *vao,
                                                     SharedVertexBufferMap &sharedBuffers,
                                                     VaoManager            *vaoManager );
 
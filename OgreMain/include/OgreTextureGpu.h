@@ -648,6 +648,9 @@ namespace Ogre
         /// TODO: This may be moved to a different class.
         virtual void swapBuffers() {}
 
+        /// See TextureFlags::TextureFlags
+        uint32 getTextureFlags() const { return mTextureFlags; }
+
         bool hasAutomaticBatching() const;
         bool isTexture() const;
         bool isRenderToTexture() const;
@@ -759,6 +762,13 @@ namespace Ogre
 
         bool isTextureGpu() const override;
 
+        /** See GpuResource::_touch. If we belong to a TexturePool, all the textures in
+            the pool get touched, as only one texture per pool gets bound (see
+            HlmsTextureBaseClass::bakeTextures) and there's no telling which slices
+            the shader samples.
+        */
+        void _touch() const override;
+
         TextureGpuManager *getTextureManager() const;
 
         TextureBox getEmptyBox( uint8 mipLevel );
@@ -274,10 +274,37 @@ namespace Ogre
             uint32                     poolId;
             TextureTypes::TextureTypes textureType;
             uint8                      numMipmaps;
+
+            /// Information used by prewarmFromTextureMetadataCache. Only valid
+            /// if resourceName is not empty.
+            String resourceName;
+            String resourceGroup;
+            uint32 textureFlags;
+            uint32 filters;
+            /// GpuPageOutStrategy::GpuPageOutStrategy
+            uint8 pageOutStrategy;
+            /// Order in which the texture was first requested to become Resident
+            /// during the recorded session. std::numeric_limits<uint32>::max() if unknown.
+            uint32 loadOrder;
+            /// Frame (relative to restartTextureMetadataCacheRecording) in which the
+            /// texture was first requested to become Resident.
+            uint32 firstUseFrame;
+            /// Size in bytes of the decoded texture (all mips), in GPU memory.
+            size_t sizeBytes;
+
             MetadataCacheEntry();
         };
 
         typedef map<IdString, MetadataCacheEntry>::type MetadataCacheMap;
+        typedef vector<MetadataCacheEntry>::type        MetadataCacheEntryVec;
+
+        struct TextureFirstUse
+        {
+            uint32 loadOrder;
+            uint32 frame;
+        };
+
+        typedef map<IdString, TextureFirstUse>::type TextureFirstUseMap;
 
         struct ResourceEntry
         {
@@ -571,10 +598,23 @@ namespace Ogre
         StagingTextureVec mTmpAvailableStagingTex;
 
         MetadataCacheMap mMetadataCache;
+        /// First time each texture was requested to go Resident since
+        /// restartTextureMetadataCacheRecording. Gets merged into mMetadataCache
+        TextureFirstUseMap mTextureFirstUse;
+        uint32             mNextTextureLoadOrder;
+        uint32             mMetadataCacheRecordingStartFrame;
+        /// Automatic (i.e. not manually reserved) pools that were alive when the metadata
+        /// cache was exported. Only poolId, resolution, numMipmaps & pixelFormat are used.
+        MetadataCacheEntryVec mPrewarmPools;
 
         typedef vector<AsyncTextureTicket *>::type AsyncTextureTicketVec;
         AsyncTextureTicketVec                      mAsyncTextureTickets;
 
+        /// See getReadbackQueue. Created on demand.
+        TextureReadbackQueue *mReadbackQueue;
+        /// See getResidencyManager. Created on demand.
+        TextureResidencyManager *mResidencyManager;
+
         struct DownloadToRamEntry
         {
             TextureGpu *texture;
@@ -873,6 +913,12 @@ namespace Ogre
         /// Do not use directly. See TextureGpu::waitForPendingSyncs
         void _waitForPendingGpuToCpuSyncs( TextureGpu *texture );
 
+    protected:
+        TexturePool &createTexturePool( uint32 poolId, uint32 width, uint32 height, uint32 numSlices,
+                                        uint8 numMipmaps, PixelFormatGpu pixelFormat,
+                                        bool manuallyReserved );
+
+    public:
         /// Reserves and preallocates a pool with the given parameters
         /// Returns the master texture that owns the pool
         ///
@@ -1039,6 +1085,22 @@ namespace Ogre
         void                destroyAsyncTextureTicket( AsyncTextureTicket *ticket );
         void                destroyAllAsyncTextureTicket();
 
+        /** Returns the TextureReadbackQueue, which pools AsyncTextureTickets and
+            delivers downloads several frames later without stalling.
+            Use it instead of createAsyncTextureTicket or Image2::convertFromTexture
+            when downloading textures every frame (e.g. video capture).
+        @remarks
+            Created the first time this function is called.
+        */
+        TextureReadbackQueue *getReadbackQueue();
+
+        /** Returns the TextureResidencyManager, which enforces memory budgets on Resident
+            textures by paging out the ones that haven't been used in a while.
+        @remarks
+            Created the first time this function is called.
+        */
+        TextureResidencyManager *getResidencyManager();
+
         void saveTexture( TextureGpu *texture, const String &folderPath,
                           set<String>::type &savedTextures, bool saveOitd, bool saveOriginal,
                           HlmsTextureExportListener *listener );
@@ -1067,13 +1129,59 @@ namespace Ogre
         /// Returns false if the entry was not found in the cache
         bool applyMetadataCacheTo( TextureGpu *texture );
 
+        /// Records the first time the texture was requested to become Resident
+        void recordTextureFirstUse( TextureGpu *texture );
+
     public:
         void _updateMetadataCache( TextureGpu *texture );
         void _removeMetadataCacheEntry( TextureGpu *texture );
+        /** Imports the metadata cache from a JSON string generated by exportTextureMetadataCache
+        @param filename
+            For logging purposes
+        @param jsonString
+            JSON string to parse
+        @param bCreateReservedPools
+            When true, manually reserved pools are immediately recreated (see reservePoolId).
+            Automatic pools are always remembered so they can be preallocated
+            by prewarmFromTextureMetadataCache.
+        */
         void importTextureMetadataCache( const String &filename, const char *jsonString,
                                          bool bCreateReservedPools );
         void exportTextureMetadataCache( String &outJson );
 
+        /** Begins recording a new session for the metadata cache: the load order & first use
+            frame of textures that get requested to become Resident from now on are tracked
+            from scratch, and stored in the cache once their metadata is known.
+
+            Call this e.g. at the start of a level, play through it, then call
+            exportTextureMetadataCache to obtain a manifest that can be used by
+            prewarmFromTextureMetadataCache in subsequent runs.
+        @remarks
+            Recording is always active. By default it starts when TextureGpuManager is created.
+        */
+        void restartTextureMetadataCacheRecording();
+
+        /** Uses the session recorded in the metadata cache (see importTextureMetadataCache)
+            to make level-load time predictable:
+                1. All texture pools that were alive when the cache was exported
+                   are preallocated.
+                2. All recorded textures are created (if they don't exist already)
+                   and scheduled to become Resident, ordered by first use.
+
+            Loading happens in the background streaming thread like any other texture,
+            thus textures end up being prefetched before they are actually needed.
+        @remarks
+            Textures whose entries are missing prewarm information (e.g. caches exported
+            by older versions) are ignored.
+        @param maxFirstUseFrame
+            Only textures that were first used at or before this frame of the recorded session
+            will be scheduled. Use it to prewarm in batches as the session advances.
+        @return
+            Number of textures that were scheduled for loading.
+        */
+        size_t prewarmFromTextureMetadataCache(
+            uint32 maxFirstUseFrame = std::numeric_limits<uint32>::max() );
+
         void getMemoryStats( size_t &outTextureBytesCpu, size_t &outTextureBytesGpu,
                              size_t &outUsedStagingTextureBytes,
                              size_t &outAvailableStagingTextureBytes );
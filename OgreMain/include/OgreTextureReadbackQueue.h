@@ -0,0 +1,272 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreTextureReadbackQueue_H_
+#define _OgreTextureReadbackQueue_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreIdString.h"
+#include "OgreTextureBox.h"
+#include "OgreTextureGpu.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreSemaphore.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreWaitableEvent.h"
+
+#include "ogrestd/deque.h"
+#include "ogrestd/map.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup Resources
+     *  @{
+     */
+
+    struct TextureReadbackResult
+    {
+        /// Value returned by TextureReadbackQueue::download
+        uint64 requestId;
+        /// Name of the texture the data was downloaded from. The TextureGpu itself
+        /// may have already been destroyed by the time the data is ready.
+        IdString textureName;
+        /// Value passed to TextureReadbackQueue::download
+        void *userData;
+        /// VaoManager::getFrameCount at the time the download was issued
+        uint32 frameIssued;
+        uint8  mipLevel;
+        /// True if the source was an OpenGL render window, in which case the
+        /// rows are stored bottom to top (see Image2::flipAroundX)
+        bool upsideDown;
+        /// Read-only. Only valid during the call to TextureReadbackListener::readbackReady
+        TextureBox     box;
+        PixelFormatGpu pixelFormat;
+    };
+
+    class _OgreExport TextureReadbackListener
+    {
+    public:
+        virtual ~TextureReadbackListener();
+
+        /** Called when the data requested via TextureReadbackQueue::download is available.
+        @remarks
+            When the request was issued with processInWorkerThread = false, this is called
+            from the main thread inside TextureGpuManager::_update and result.box points
+            directly to the mapped AsyncTextureTicket (no extra copy).
+
+            When processInWorkerThread = true, this is called from the TextureReadbackQueue's
+            worker thread on a CPU copy of the data. Your implementation must be thread safe
+            and must not call into Ogre in that case. Useful for encoding, checksumming or
+            writing to disk without stalling the render loop.
+        */
+        virtual void readbackReady( const TextureReadbackResult &result ) = 0;
+    };
+
+    /** Streams GPU -> CPU texture downloads without stalling.
+
+        AsyncTextureTicket (and Image2::convertFromTexture, which maps it right away) is
+        meant for one-off downloads. Sustained readback (i.e. capturing every frame for video
+        or automated image comparison) wants to:
+            1. Reuse the tickets instead of creating and destroying one per download.
+            2. Only map tickets once the GPU is done with them, several frames later.
+            3. Optionally move the CPU-side processing away from the render thread.
+
+        This class does exactly that. Tickets are kept in a pool keyed by resolution, type
+        and pixel format family. Downloads are issued with inaccurate tracking and are only
+        mapped once VaoManager reports the issuing frame has finished, which for a typical
+        triple buffered setup means results arrive ~3 frames after being requested.
+
+        Results are either delivered through a TextureReadbackListener, or kept around
+        until retrieved via retrieve() when no listener is provided (i.e. a poll-able future).
+
+        Get it via TextureGpuManager::getReadbackQueue.
+    */
+    class _OgreExport TextureReadbackQueue : public OgreAllocatedObj
+    {
+    protected:
+        struct PooledTicket
+        {
+            AsyncTextureTicket *ticket;
+            uint32              lastFrameUsed;
+        };
+        typedef vector<PooledTicket>::type PooledTicketVec;
+
+        struct PendingRequest
+        {
+            uint64                     requestId;
+            AsyncTextureTicket        *ticket;
+            TextureReadbackListener   *listener;
+            void                      *userData;
+            IdString                   textureName;
+            PixelFormatGpu             pixelFormat;
+            TextureTypes::TextureTypes textureType;
+            uint32                     frameIssued;
+            uint8                      mipLevel;
+            bool                       upsideDown;
+            bool                       processInWorkerThread;
+        };
+        typedef deque<PendingRequest>::type PendingRequestDeque;
+
+        /// A CPU copy of a ticket's contents. Used by the worker thread and retrieve()
+        struct CompletedDownload
+        {
+            TextureReadbackResult      result;
+            TextureReadbackListener   *listener;
+            uint8                     *data;
+            uint32                     width;
+            uint32                     height;
+            uint32                     depthOrSlices;
+            TextureTypes::TextureTypes textureType;
+        };
+        typedef deque<CompletedDownload>::type       CompletedDownloadDeque;
+        typedef map<uint64, CompletedDownload>::type CompletedDownloadMap;
+
+        TextureGpuManager *mTextureGpuManager;
+        VaoManager        *mVaoManager;
+
+        /// Tickets not currently in use. Kept in order of lastFrameUsed.
+        PooledTicketVec     mAvailableTickets;
+        PendingRequestDeque mPendingRequests;
+        /// Requests issued without a listener, waiting to be retrieved.
+        CompletedDownloadMap mCompletedDownloads;
+
+        uint64 mNextRequestId;
+        size_t mMaxPendingRequests;
+        uint32 mMaxIdleFrames;
+
+        ThreadHandlePtr        mWorkerThread;
+        Semaphore              mWorkerSemaphore;
+        LightweightMutex       mWorkerMutex;
+        CompletedDownloadDeque mWorkerJobs;
+        /// Request ID of the job the worker thread is processing. 0 if idle.
+        uint64 mWorkerJobInProgress;
+        /// Worker wakes, main thread waits. Used by waitFor()
+        WaitableEvent mWorkerJobDoneEvent;
+        bool          mShuttingDown;
+
+        AsyncTextureTicket *getTicket( uint32 width, uint32 height, uint32 depthOrSlices,
+                                       TextureTypes::TextureTypes textureType,
+                                       PixelFormatGpu             pixelFormatFamily );
+        void                releaseTicket( AsyncTextureTicket *ticket );
+
+        /// Copies the ticket's contents into a newly allocated CompletedDownload.
+        /// May stall if the GPU isn't done with it yet.
+        CompletedDownload copyToCpu( const PendingRequest &request );
+
+        /// Maps the ticket and delivers the result. Stalls if the transfer isn't done yet.
+        void processRequest( const PendingRequest &request );
+
+        static void freeCompletedDownload( CompletedDownload &download );
+
+        void startWorkerThread();
+        void stopWorkerThread();
+
+    public:
+        TextureReadbackQueue( TextureGpuManager *textureGpuManager, VaoManager *vaoManager );
+        virtual ~TextureReadbackQueue();
+
+        /** Schedules a download of the given texture.
+        @param texture
+            Texture to download from. Must be Resident, or about to become Resident.
+            Textures with MSAA must be resolved first.
+        @param mipLevel
+            Mip level to download.
+        @param listener
+            Listener to receive the result. When nullptr, the result is kept until
+            retrieve() is called with the returned request ID.
+        @param processInWorkerThread
+            When true, listener->readbackReady is called from a worker thread.
+            Ignored if listener is nullptr.
+        @param userData
+            Arbitrary value forwarded to TextureReadbackResult::userData.
+        @param srcBox
+            Optional region to download. When nullptr the whole mip is downloaded.
+        @return
+            ID of the request, never 0.
+        */
+        uint64 download( TextureGpu *texture, uint8 mipLevel, TextureReadbackListener *listener,
+                         bool processInWorkerThread = false, void *userData = 0,
+                         TextureBox *srcBox = 0 );
+
+        /// Returns true if the request is done and waiting to be retrieved.
+        /// Only requests issued without a listener can be polled this way.
+        bool isReady( uint64 requestId ) const;
+
+        /** Retrieves the data of a request issued without a listener.
+        @return
+            False if the data is not ready yet (or the ID is unknown). True otherwise,
+            in which case outImage takes ownership of the data and the request is forgotten.
+        */
+        bool retrieve( uint64 requestId, Image2 &outImage );
+
+        /** Stalls until the given request is done.
+            For requests with a listener, this ensures readbackReady has been called
+            (and if it runs in the worker thread, that it has returned).
+        */
+        void waitFor( uint64 requestId );
+
+        /// Stalls until all pending requests are done and all worker jobs have finished.
+        void waitForAll();
+
+        /** Sets the maximum number of downloads that can be in flight at the same time.
+            If download is called while at the limit, we will stall to finish the oldest one.
+            This bounds memory consumption (and GPU latency) when the CPU outpaces the GPU.
+            Default is 8.
+        */
+        void   setMaxPendingRequests( size_t maxPendingRequests );
+        size_t getMaxPendingRequests() const { return mMaxPendingRequests; }
+
+        /// Tickets that haven't been used for this many frames are destroyed. Default is 5.
+        void   setMaxIdleFrames( uint32 maxIdleFrames ) { mMaxIdleFrames = maxIdleFrames; }
+        uint32 getMaxIdleFrames() const { return mMaxIdleFrames; }
+
+        size_t getNumPendingRequests() const { return mPendingRequests.size(); }
+        size_t getNumPooledTickets() const { return mAvailableTickets.size(); }
+
+        /// Destroys all unused tickets.
+        void destroyAvailableTickets();
+
+        /// Called by TextureGpuManager::_update. Delivers finished downloads.
+        void _update();
+
+        /// Do not call directly.
+        unsigned long _workerThread( ThreadHandle *threadHandle );
+    };
+
+    /** @} */
+    /** @} */
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,195 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreTextureResidencyManager_H_
+#define _OgreTextureResidencyManager_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreIdString.h"
+
+#include "ogrestd/map.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup Resources
+     *  @{
+     */
+
+    /** Enforces a cap on the memory used by Resident textures.
+
+        Every time a texture gets bound for rendering (via the CommandBuffer, a low level
+        material or a compute job) it gets 'touched' (see GpuResource::getLastFrameUsed).
+        When the Resident textures exceed the global budget, or the budget of their
+        resource group, the ones that haven't been used for the longest time are paged out
+        according to their GpuPageOutStrategy:
+            - Discard: Go back to OnStorage.
+            - SaveToSystemRam & AlwaysKeepSystemRamCopy: Go to OnSystemRam.
+
+        To avoid thrashing:
+            - Eviction starts once usage goes above the budget, but continues until
+              usage is below budget * lowWatermark (hysteresis).
+            - Textures used in the last getMinIdleFrames frames are never paged out.
+            - At most getMaxEvictionsPerFrame textures are paged out per frame.
+
+        Textures paged out by us are scheduled to go Resident again as soon as they get
+        bound again (they will show the blank/fallback texture while loading).
+
+        The following textures are never paged out:
+            - RenderToTexture, Uav, ManualTexture and NotTexture (can't be reloaded).
+            - Textures with rank 0 (see GpuResource::setRank).
+            - Textures still loading, or with pending residency changes.
+
+        Budgets are in bytes as reported by TextureGpu::getSizeBytes. Note that for
+        textures with AutomaticBatching this is the size of its slice; the
+        memory is only returned to the OS once the whole pool is empty.
+
+        Get it via TextureGpuManager::getResidencyManager. It does nothing until
+        a budget is set.
+    */
+    class _OgreExport TextureResidencyManager : public OgreAllocatedObj
+    {
+    public:
+        struct GroupBudget
+        {
+            /// 0 means no limit
+            size_t budgetBytes;
+            /// Resident bytes as of the last update
+            size_t residentBytes;
+            /// Went over budget and hasn't reached budget * lowWatermark yet
+            bool evicting;
+        };
+        typedef map<IdString, GroupBudget>::type GroupBudgetMap;
+
+    protected:
+        struct Candidate
+        {
+            TextureGpu *texture;
+            /// Frames since it was last used, multiplied by its rank
+            uint64       score;
+            size_t       sizeBytes;
+            GroupBudget *group;
+        };
+        typedef vector<Candidate>::type CandidateVec;
+
+        /// Textures we've paged out, and the frame we did it.
+        typedef map<IdString, uint32>::type EvictedTextureMap;
+
+        TextureGpuManager *mTextureGpuManager;
+        VaoManager        *mVaoManager;
+
+        size_t         mGlobalBudgetBytes;
+        size_t         mResidentBytes;
+        bool           mGlobalEvicting;
+        GroupBudgetMap mGroupBudgets;
+
+        float  mLowWatermark;
+        uint32 mMinIdleFrames;
+        uint32 mMaxEvictionsPerFrame;
+        uint32 mLastUpdateFrame;
+
+        EvictedTextureMap mEvictedTextures;
+
+        uint64 mNumEvictions;
+        uint64 mNumReloads;
+
+        CandidateVec mTmpCandidates;
+
+        bool isEvictable( const TextureGpu *texture ) const;
+
+        /** Returns how many bytes must be freed to reach budget * lowWatermark.
+            0 if within budget and we weren't already evicting.
+        @param evicting [in/out]
+            Set when going over budget. Cleared once the low watermark is reached.
+        */
+        size_t calculateBytesToFree( size_t residentBytes, size_t budgetBytes,
+                                     bool &evicting ) const;
+
+        void evict( TextureGpu *texture, uint32 currentFrame );
+
+    public:
+        TextureResidencyManager( TextureGpuManager *textureGpuManager, VaoManager *vaoManager );
+        virtual ~TextureResidencyManager();
+
+        /// Maximum bytes of Resident textures. 0 means no limit (default).
+        void   setGlobalBudget( size_t budgetBytes ) { mGlobalBudgetBytes = budgetBytes; }
+        size_t getGlobalBudget() const { return mGlobalBudgetBytes; }
+
+        /** Maximum bytes of Resident textures belonging to the given resource group.
+            Textures from groups without a budget only count towards the global budget.
+        @param resourceGroup
+            Resource group as passed to TextureGpuManager::createTexture.
+        @param budgetBytes
+            0 to remove the budget.
+        */
+        void   setGroupBudget( const String &resourceGroup, size_t budgetBytes );
+        size_t getGroupBudget( const String &resourceGroup ) const;
+
+        /** Once over budget, we evict until usage is below budget * lowWatermark.
+            Must be in range (0; 1]. Default is 0.9
+        */
+        void  setLowWatermark( float lowWatermark );
+        float getLowWatermark() const { return mLowWatermark; }
+
+        /// Textures used in the last minIdleFrames frames are never evicted. Default is 120.
+        void   setMinIdleFrames( uint32 minIdleFrames ) { mMinIdleFrames = minIdleFrames; }
+        uint32 getMinIdleFrames() const { return mMinIdleFrames; }
+
+        /// Maximum number of textures to page out per frame. Default is 16.
+        void   setMaxEvictionsPerFrame( uint32 maxEvictions ) { mMaxEvictionsPerFrame = maxEvictions; }
+        uint32 getMaxEvictionsPerFrame() const { return mMaxEvictionsPerFrame; }
+
+        /// Bytes used by Resident textures as of the last update, excluding
+        /// those already scheduled to be paged out.
+        size_t getResidentBytes() const { return mResidentBytes; }
+        /// Bytes used by Resident textures of the given group as of the last update.
+        /// Only tracked for groups with a budget.
+        size_t getGroupResidentBytes( const String &resourceGroup ) const;
+
+        /// Number of textures we've paged out so far
+        uint64 getNumEvictions() const { return mNumEvictions; }
+        /// Number of paged out textures that we had to bring back because they got used
+        uint64 getNumReloads() const { return mNumReloads; }
+
+        /// Called by TextureGpuManager::_update. Does nothing if already called this frame.
+        void _update();
+    };
+
+    /** @} */
+    /** @} */
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
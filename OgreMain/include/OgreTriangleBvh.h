@@ -0,0 +1,159 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-present Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreTriangleBvh_H_
+#define _OgreTriangleBvh_H_
+
+#include "OgrePrerequisites.h"
+
+#include "Math/Array/OgreArrayVector3.h"
+#include "OgreRawPtr.h"
+#include "OgreVector2.h"
+
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup Resources
+     *  @{
+     */
+
+    struct TriangleRayHit
+    {
+        /// Distance along the ray, in multiples of the length of the ray's direction
+        Real distance;
+        /// The triangle's vertices are at index buffer entries [triangleIdx * 3; triangleIdx * 3 + 3)
+        /// (relative to the start of the Vao's range, when built from a Vao)
+        uint32 triangleIdx;
+        /// Barycentric coordinates of the hit relative to the 2nd and 3rd vertices.
+        /// The weight of the 1st vertex is 1 - barycentric.x - barycentric.y
+        Vector2 barycentric;
+    };
+
+    /** Bounding volume hierarchy over the triangles of a mesh, to raycast against the actual
+        geometry instead of its bounds.
+    @remarks
+        Triangles are stored in the leaves in packs of ARRAY_PACKED_REALS, so that each ray is
+        tested against several triangles at once.
+    @par
+        For v2 meshes use SubMesh::getTriangleBvh, which builds it once and shares it between
+        all the Items using that mesh.
+    */
+    class _OgreExport TriangleBvh : public OgreAllocatedObj
+    {
+        struct Node
+        {
+            Vector3 vMin;
+            Vector3 vMax;
+            /// Leaves: index of the first pack.
+            /// Inner nodes: index of the second child (the first one goes right after us)
+            uint32 firstPackOrSecondChild;
+            /// 0 for inner nodes
+            uint32 numPacks;
+        };
+
+        struct TrianglePack
+        {
+            ArrayVector3 v0;
+            ArrayVector3 edge1;
+            ArrayVector3 edge2;
+            uint32       triangleIdx[ARRAY_PACKED_REALS];
+        };
+
+        typedef vector<Node>::type NodeVec;
+
+        NodeVec mNodes;
+
+        RawSimdUniquePtr<TrianglePack, MEMCATEGORY_GEOMETRY> mPacks;
+
+        uint32 mNumTriangles;
+
+        struct BuildTriangle;
+        typedef vector<BuildTriangle>::type BuildTriangleVec;
+
+        void buildNode( BuildTriangleVec &triangles, size_t start, size_t end, size_t depth,
+                        BuildTriangleVec &outPackedTriangles );
+
+    public:
+        TriangleBvh();
+
+        /** Builds the hierarchy from a triangle list.
+        @param positions
+            3 floats per vertex
+        @param numVertices
+            Number of vertices in positions
+        @param indexData
+            Index buffer. Can be nullptr, in which case every 3 consecutive vertices are a triangle
+        @param indices16bit
+            Whether indexData is uint16 (otherwise uint32)
+        @param numIndices
+            Number of indices in indexData. Ignored if indexData is nullptr
+        */
+        void build( const float *positions, size_t numVertices, const void *indexData,
+                    bool indices16bit, size_t numIndices );
+
+        /** Builds the hierarchy from the positions of the Vao, which must be a triangle list.
+            Buffers with a shadow copy are read from it; otherwise they're downloaded from
+            the GPU, which stalls.
+        */
+        void build( VertexArrayObject *vao );
+
+        void clear();
+
+        size_t getNumTriangles() const { return mNumTriangles; }
+
+        /** Finds the closest triangle hit by the ray.
+        @param ray
+            Ray in the same space as the positions the BVH was built from.
+            Its direction doesn't need to be normalised.
+        @param maxDistance
+            Hits further than this are ignored
+        @param positiveSide
+            Whether to hit triangles from their front side (counter clockwise winding)
+        @param negativeSide
+            Whether to hit triangles from their back side
+        @param outHit [out]
+            The closest hit. Left untouched if nothing was hit.
+        @return
+            True if a triangle was hit
+        */
+        bool raycast( const Ray &ray, Real maxDistance, bool positiveSide, bool negativeSide,
+                      TriangleRayHit &outHit ) const;
+    };
+
+    /** @} */
+    /** @} */
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
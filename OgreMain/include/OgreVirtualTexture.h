@@ -0,0 +1,218 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreVirtualTexture_H_
+#define _OgreVirtualTexture_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreTextureReadbackQueue.h"
+#include "OgreVector4.h"
+#include "OgreVirtualTextureCache.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup Resources
+     *  @{
+     */
+
+    class _OgreExport VirtualTextureTileLoader
+    {
+    public:
+        virtual ~VirtualTextureTileLoader();
+
+        /** Fills the contents of a tile.
+        @remarks
+            Called from VirtualTexture's worker thread. Must be thread safe.
+        @param x
+            Tile's x coordinate, in tiles, at the given mip.
+        @param y
+            Tile's y coordinate, in tiles, at the given mip.
+        @param mip
+            Mip level of the tile. Mip N covers 2^N x 2^N tiles of mip 0.
+        @param dst
+            Where to write the data. Its resolution is the tile resolution plus the border
+            on each side, thus neighbouring texels must be replicated into the border
+            for filtering to work across tiles.
+        @return
+            False if the tile couldn't be loaded.
+        */
+        virtual bool loadTile( uint32 x, uint32 y, uint8 mip, const TextureBox &dst ) = 0;
+    };
+
+    /** Tile based virtual texture. Allows sampling textures way bigger than what fits in
+        GPU memory (e.g. terrain or large decals) by keeping only the tiles that are
+        actually visible in a physical atlas.
+
+        The pieces are:
+            - The atlas: a regular TextureGpu with getNumSlots() tiles, borders included.
+            - The indirection: a TextureGpu with one RGBA8 texel per tile per mip, telling
+              the shader which slot to sample (see VirtualTextureCache::getIndirection).
+            - Feedback: the shader writes the tile it wants (see vtPackTileId in
+              VirtualTexture_piece_ps.any) to a low resolution PFG_R32_UINT render target.
+              We read it back through the TextureReadbackQueue without stalling.
+            - Loading: tiles are requested from a VirtualTextureTileLoader in a worker
+              thread and uploaded through StagingTextures from the main thread.
+
+        Call update() once per frame (after the feedback pass was rendered).
+        All the CPU side bookkeeping lives in VirtualTextureCache.
+    */
+    class _OgreExport VirtualTexture : public TextureReadbackListener, public OgreAllocatedObj
+    {
+    protected:
+        struct LoadJob
+        {
+            uint32 tileId;
+            uint8 *data;
+            bool   success;
+        };
+        typedef deque<LoadJob>::type  LoadJobDeque;
+        typedef vector<LoadJob>::type LoadJobVec;
+
+        IdString                  mName;
+        TextureGpuManager        *mTextureGpuManager;
+        VirtualTextureTileLoader *mLoader;
+
+        VirtualTextureCache mCache;
+
+        uint32         mTileResolution;
+        uint32         mBorder;
+        PixelFormatGpu mPixelFormat;
+
+        TextureGpu *mAtlas;
+        TextureGpu *mIndirection;
+        TextureGpu *mFeedbackTexture;
+
+        uint32 mMaxTileLoadsPerFrame;
+        uint32 mMaxTileUploadsPerFrame;
+        uint32 mNumFeedbackRequestsInFlight;
+
+        VirtualTextureCache::TileIdVec mTmpTilesToLoad;
+
+        ThreadHandlePtr  mWorkerThread;
+        Semaphore        mWorkerSemaphore;
+        LightweightMutex mWorkerMutex;
+        LoadJobDeque     mPendingLoads;
+        LoadJobVec       mFinishedLoads;
+        LoadJobVec       mTmpFinishedLoads;
+        bool             mShuttingDown;
+
+        uint32 getPaddedTileResolution() const { return mTileResolution + mBorder * 2u; }
+        size_t getTileSizeBytes() const;
+
+        void createTextures();
+        void destroyTextures();
+
+        void uploadTiles();
+        void uploadIndirection();
+
+        static void freeLoadJob( LoadJob &job );
+
+    public:
+        /**
+        @param name
+            Used as prefix for the name of the textures we create.
+        @param textureGpuManager
+        @param loader
+            Provides the contents of each tile. Must outlive us.
+        @param widthInTiles
+            Resolution of the virtual texture at mip 0, in tiles. Must be a power of 2.
+        @param heightInTiles
+            Resolution of the virtual texture at mip 0, in tiles. Must be a power of 2.
+        @param tileResolution
+            Resolution of each tile in texels, without borders. i.e. 128.
+        @param border
+            Texels replicated on each side of the tile for filtering. i.e. 4 for
+            anisotropic filtering. For compressed formats, tileResolution + 2 * border
+            must be a multiple of the block size.
+        @param pixelFormat
+            Format of the atlas.
+        @param atlasSlotsPerRow
+            The atlas holds atlasSlotsPerRow x atlasSlotsPerRow tiles. Max 256.
+        */
+        VirtualTexture( const String &name, TextureGpuManager *textureGpuManager,
+                        VirtualTextureTileLoader *loader, uint32 widthInTiles, uint32 heightInTiles,
+                        uint32 tileResolution, uint32 border, PixelFormatGpu pixelFormat,
+                        uint32 atlasSlotsPerRow );
+        ~VirtualTexture() override;
+
+        /** Sets the PFG_R32_UINT texture the feedback pass renders to.
+            It will be read back every frame. nullptr to disable feedback,
+            in which case tiles must be requested via getCache()->requestTile.
+        */
+        void        setFeedbackTexture( TextureGpu *feedbackTexture );
+        TextureGpu *getFeedbackTexture() const { return mFeedbackTexture; }
+
+        /// Maximum number of new tiles that are sent to the loader each frame.
+        void   setMaxTileLoadsPerFrame( uint32 maxTiles ) { mMaxTileLoadsPerFrame = maxTiles; }
+        uint32 getMaxTileLoadsPerFrame() const { return mMaxTileLoadsPerFrame; }
+
+        /// Maximum number of loaded tiles that are uploaded to the atlas each frame.
+        /// The rest wait for the next frame.
+        void   setMaxTileUploadsPerFrame( uint32 maxTiles ) { mMaxTileUploadsPerFrame = maxTiles; }
+        uint32 getMaxTileUploadsPerFrame() const { return mMaxTileUploadsPerFrame; }
+
+        TextureGpu *getAtlas() const { return mAtlas; }
+        TextureGpu *getIndirection() const { return mIndirection; }
+
+        VirtualTextureCache       *getCache() { return &mCache; }
+        const VirtualTextureCache *getCache() const { return &mCache; }
+
+        /** Values the shader needs to go from virtual UVs to atlas UVs.
+            See vtAtlasUv in VirtualTexture_piece_ps.any
+        @param outParams0
+            x, y = Resolution of mip 0, in tiles.
+            z = Tile resolution, w = border, both in texels.
+        @param outParams1
+            x, y = Resolution of the atlas, in texels.
+            z = Number of mips.
+        */
+        void getShaderParams( Vector4 &outParams0, Vector4 &outParams1 ) const;
+
+        /// Processes feedback, schedules new tile loads and uploads the finished ones.
+        void update();
+
+        /// TextureReadbackListener overload
+        void readbackReady( const TextureReadbackResult &result ) override;
+
+        /// Do not call directly.
+        unsigned long _workerThread( ThreadHandle *threadHandle );
+    };
+
+    /** @} */
+    /** @} */
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
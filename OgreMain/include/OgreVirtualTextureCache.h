@@ -0,0 +1,244 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreVirtualTextureCache_H_
+#define _OgreVirtualTextureCache_H_
+
+#include "OgrePrerequisites.h"
+
+#include "ogrestd/unordered_map.h"
+#include "ogrestd/unordered_set.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup Resources
+     *  @{
+     */
+
+    /// Tiles are identified by a single uint32 so that the GPU can write
+    /// them to the feedback buffer. Layout is 4 bits mip | 14 bits y | 14 bits x.
+    /// Must match vtPackTileId in VirtualTexture_piece_ps.any
+    namespace VirtualTextureTile
+    {
+        static const uint32 c_invalid = 0xFFFFFFFFu;
+        static const uint32 c_maxTilesPerSide = 1u << 14u;
+        static const uint8  c_maxMips = 15u;
+
+        inline uint32 pack( uint32 x, uint32 y, uint32 mip )
+        {
+            return ( mip << 28u ) | ( y << 14u ) | x;
+        }
+        inline uint32 getX( uint32 tileId ) { return tileId & 0x3FFFu; }
+        inline uint32 getY( uint32 tileId ) { return ( tileId >> 14u ) & 0x3FFFu; }
+        inline uint8  getMip( uint32 tileId ) { return static_cast<uint8>( tileId >> 28u ); }
+        /// Returns the tile at mip + 1 that covers the given tile.
+        inline uint32 getParent( uint32 tileId )
+        {
+            return pack( getX( tileId ) >> 1u, getY( tileId ) >> 1u, getMip( tileId ) + 1u );
+        }
+    }  // namespace VirtualTextureTile
+
+    /** CPU side bookkeeping of a virtual (sparse) texture. It does not touch the GPU,
+        thus it can be used & tested without a RenderSystem. VirtualTexture owns one.
+
+        It tracks:
+            - The tile cache: Which tile lives in which slot of the physical atlas.
+              Slots are recycled in LRU order. Tiles of the coarsest mip are pinned
+              so there's always something to fall back to.
+            - The page table: For every tile of every mip, which slot to sample from.
+              When a tile isn't resident, it points to the closest resident ancestor.
+            - Requests: Tiles the GPU asked for via feedback, which get turned into
+              a prioritised list of tiles to load (coarser mips first, then the most
+              requested).
+    */
+    class _OgreExport VirtualTextureCache : public OgreAllocatedObj
+    {
+    public:
+        typedef vector<uint32>::type TileIdVec;
+
+    protected:
+        struct Slot
+        {
+            uint32 tileId;
+            uint32 lastFrameUsed;
+            /// Doubly linked LRU list. c_invalid if not linked (free or pinned).
+            uint32 prev;
+            uint32 next;
+        };
+        typedef vector<Slot>::type SlotVec;
+
+        struct Candidate
+        {
+            uint32 tileId;
+            uint32 numRequests;
+        };
+        typedef vector<Candidate>::type CandidateVec;
+
+        typedef unordered_map<uint32, uint32>::type TileToSlotMap;
+        typedef unordered_map<uint32, uint32>::type TileCountMap;
+        typedef unordered_set<uint32>::type         TileSet;
+
+        uint32 mWidthInTiles;
+        uint32 mHeightInTiles;
+        uint8  mNumMips;
+        uint32 mSlotsPerRow;
+
+        SlotVec mSlots;
+        uint32  mNumUsedSlots;
+        /// Least recently used (evicted first)
+        uint32 mLruHead;
+        /// Most recently used
+        uint32 mLruTail;
+
+        TileToSlotMap mResidentTiles;
+        TileSet       mLoadingTiles;
+        TileCountMap  mRequestCounts;
+
+        /// Indirection entries for all mips, see getIndirection
+        TileIdVec mIndirection;
+        uint32    mMipOffsets[VirtualTextureTile::c_maxMips];
+        bool      mIndirectionDirty;
+
+        CandidateVec mTmpCandidates;
+        TileCountMap mTmpCandidateIdx;
+
+        void unlinkSlot( uint32 slotIdx );
+        void linkSlotAsMostRecent( uint32 slotIdx );
+        void touchSlot( uint32 slotIdx, uint32 currentFrame );
+
+        /// Returns a free slot, or evicts the least recently used tile.
+        /// Returns c_invalid if every slot was used in currentFrame.
+        uint32 allocateSlot( uint32 currentFrame );
+
+        bool isValidTile( uint32 tileId ) const;
+
+    public:
+        /**
+        @param widthInTiles
+            Resolution of mip 0, in tiles. Must be a power of 2.
+        @param heightInTiles
+            Resolution of mip 0, in tiles. Must be a power of 2.
+        @param numMips
+            Number of mips. 0 to use the full chain (i.e. until the texture is 1x1 tiles).
+            Will be clamped to the full chain.
+        @param numSlots
+            Number of tiles the physical atlas can hold. Must be bigger than
+            the number of tiles in the coarsest mip.
+        @param slotsPerRow
+            How many slots are in a row of the atlas. Used to build the indirection.
+        */
+        VirtualTextureCache( uint32 widthInTiles, uint32 heightInTiles, uint8 numMips, uint32 numSlots,
+                             uint32 slotsPerRow );
+        virtual ~VirtualTextureCache();
+
+        uint32 getWidthInTiles( uint8 mip = 0 ) const;
+        uint32 getHeightInTiles( uint8 mip = 0 ) const;
+        uint8  getNumMips() const { return mNumMips; }
+        uint32 getNumSlots() const { return static_cast<uint32>( mSlots.size() ); }
+        uint32 getSlotsPerRow() const { return mSlotsPerRow; }
+
+        size_t getNumResidentTiles() const { return mResidentTiles.size(); }
+        size_t getNumLoadingTiles() const { return mLoadingTiles.size(); }
+
+        /** Parses the contents of the feedback buffer.
+            Can be called multiple times per frame (e.g. multiple feedback buffers).
+        @param tileIds
+            Array of tile IDs as written by the GPU (see VirtualTextureTile::pack).
+            VirtualTextureTile::c_invalid and out of range entries are ignored.
+        @param numEntries
+            Number of elements in tileIds.
+        */
+        void processFeedback( const uint32 *tileIds, size_t numEntries );
+
+        /// Same as the other overload, but reads from a PFG_R32_UINT box
+        /// (e.g. the one from TextureReadbackListener::readbackReady).
+        void processFeedback( const TextureBox &box );
+
+        /// Manually requests a tile, as if it had been reported through feedback.
+        void requestTile( uint32 tileId, uint32 numRequests = 1u );
+
+        /** Turns all the requests received since the last call into a list of tiles to load,
+            and refreshes the LRU timestamp of the ones already resident.
+        @param currentFrame
+            Monotonically increasing value. Tiles used in the current frame are never evicted.
+        @param maxTilesToLoad
+            Maximum number of tiles to put in outTilesToLoad.
+        @param outTilesToLoad [out]
+            Tiles to load, sorted by priority. They're considered 'loading' until either
+            notifyTileLoaded or notifyTileLoadFailed is called. Not cleared.
+        */
+        void update( uint32 currentFrame, size_t maxTilesToLoad, TileIdVec &outTilesToLoad );
+
+        /** Assigns a slot to a tile that finished loading.
+        @param outEvictedTileId [out]
+            The tile that was evicted to make room. c_invalid if none.
+        @return
+            The slot where the tile must be uploaded to. c_invalid if the cache is
+            thrashing (every slot was used this frame), in which case the tile is dropped
+            and will be requested again through feedback.
+        */
+        uint32 notifyTileLoaded( uint32 tileId, uint32 currentFrame, uint32 &outEvictedTileId );
+        void   notifyTileLoadFailed( uint32 tileId );
+
+        /// Returns the slot holding the tile, c_invalid if not resident.
+        uint32 getSlot( uint32 tileId ) const;
+        bool   isResident( uint32 tileId ) const;
+        bool   isLoading( uint32 tileId ) const;
+
+        /// Removes all tiles from the cache.
+        void clear();
+
+        /** Rebuilds the indirection (page table) if tiles were loaded or evicted.
+        @return
+            True if the indirection changed and needs to be uploaded to the GPU.
+        */
+        bool updateIndirection();
+
+        /** Indirection entries of the given mip. There are getWidthInTiles( mip ) x
+            getHeightInTiles( mip ) entries, row by row. Each entry is an RGBA8 texel:
+                R = Slot's x in the atlas
+                G = Slot's y in the atlas
+                B = Mip of the tile that is actually resident
+                A = 255 if there's something to sample, 0 otherwise
+        */
+        const uint32 *getIndirection( uint8 mip ) const { return &mIndirection[mMipOffsets[mip]]; }
+    };
+
+    /** @} */
+    /** @} */
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
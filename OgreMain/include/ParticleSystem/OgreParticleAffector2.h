@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 
 #include "OgreStringInterface.h"
+#include "OgreVector4.h"
 #include "ParticleSystem/OgreParticle2.h"
 
 #include "OgreHeaderPrefix.h"
@@ -40,6 +41,37 @@ namespace Ogre
 {
     OGRE_ASSUME_NONNULL_BEGIN
 
+    namespace ParticleGpuAffectorType
+    {
+        /// Affectors the GPU simulation knows how to run. See ParticleAffector2::getGpuParams().
+        enum ParticleGpuAffectorType
+        {
+            /// values[0].xyz = force.
+            /// direction += force * timeSinceLast
+            LinearForceAdd,
+            /// values[0].xyz = force.
+            /// direction = ( direction + force ) * 0.5
+            LinearForceAverage,
+            /// values[0] = adjustment per second. values[1] = min colour. values[2] = max colour.
+            /// colour = clamp( colour + adjustment * timeSinceLast, min, max )
+            ColourFader,
+            /// values[0].xyz = plane normal. values[0].w = plane distance. values[1].x = bounce.
+            DeflectorPlane,
+            /// values[0].x = adjustment per second.
+            /// dimensions += adjustment * timeSinceLast
+            ScaleAdd,
+            /// values[0].x = factor per second.
+            /// dimensions *= pow( factor, timeSinceLast )
+            ScaleMultiply
+        };
+    }  // namespace ParticleGpuAffectorType
+
+    struct ParticleGpuAffectorParams
+    {
+        ParticleGpuAffectorType::ParticleGpuAffectorType type;
+        Vector4                                          values[3];
+    };
+
     /// Affectors are per ParticleSystemDef
     class _OgreExport ParticleAffector2 : public StringInterface
     {
@@ -69,6 +101,18 @@ namespace Ogre
         virtual void run( ParticleCpuData cpuData, size_t numParticles,
                           ArrayReal timeSinceLast ) const = 0;
 
+        /** Describes this affector so it can run in a compute shader.
+            See ParticleSystemDef::setGpuSimulation().
+        @remarks
+            Called every frame, thus parameters may be changed at any time.
+        @param outParams [out]
+            The parameters. Only written if we return true.
+        @return
+            False if this affector can only run on the CPU, in which case the particle
+            systems using it are simulated on the CPU.
+        */
+        virtual bool getGpuParams( ParticleGpuAffectorParams & /*outParams*/ ) const { return false; }
+
         virtual void _cloneFrom( const ParticleAffector2 *original ) = 0;
 
         /** Returns the name of the type of affector.
@@ -0,0 +1,160 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2023 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef OgreParticleGpuSimulation_H
+#define OgreParticleGpuSimulation_H
+
+#include "OgrePrerequisites.h"
+
+#include "OgreResourceTransition.h"
+#include "ParticleSystem/OgreParticle2.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    OGRE_ASSUME_NONNULL_BEGIN
+
+    class ParticleSystemDef;
+
+    /// GPU side of a ParticleSystemDef simulated by ParticleGpuSimulation.
+    struct ParticleGpuSimData
+    {
+        /// Simulation state. 4 float4 per particle:
+        ///     position & time to live, direction & total time to live,
+        ///     colour, dimensions & rotation.
+        UavBufferPacked *state;
+        /// What we render from (ParticleSystemDef::mGpuData is a view of it).
+        /// 2 uint4 per particle, same layout as ParticleGpuData.
+        UavBufferPacked *output;
+        /// Where we simulate into when sorting, before the sorted gather into output.
+        /// Null if sorting is disabled.
+        UavBufferPacked *ogre_nullable unsorted;
+        /// uint2 ( key, index ) per particle, rounded up to the next power of 2.
+        /// Null if sorting is disabled.
+        UavBufferPacked *ogre_nullable sortKeys;
+
+        /// Newly emitted particles, initialized on the CPU. 5 float4 per particle:
+        /// the 4 of state, plus the particle's handle.
+        ReadOnlyBufferPacked *ogre_nullable emitted;
+        /// Mapped while the worker threads fill it.
+        float *ogre_nullable emittedData;
+        uint32               numEmitted;
+
+        /// 4 float4 per affector: type, then ParticleGpuAffectorParams::values.
+        /// Always has room for at least one.
+        ReadOnlyBufferPacked *affectors;
+        uint32                numAffectors;
+
+        /// Range of particles ticked on the CPU this frame.
+        /// See ParticleSystemDef::getActiveParticlesPackOffset().
+        uint32 firstSlot;
+        /// See ParticleSystemDef::getNumSimdActiveParticles().
+        uint32 numSlots;
+    };
+
+    /** Runs the per-particle simulation of ParticleSystemDefs with compute shaders.
+        See ParticleSystemDef::setGpuSimulation().
+    @remarks
+        Emitters and the affectors' initEmittedParticles still run on the CPU (their cost
+        depends on the emission rate, not the amount of live particles). The CPU also keeps
+        ticking each particle's time to live so that dead particles are returned to the pool.
+        Only the newly emitted particles are uploaded.
+        @par
+        Every frame, on the GPU:
+            1. Newly emitted particles are scattered into the persistent state.
+            2. Affectors run and particles are integrated; writing what the vertex shader reads.
+            3. If ParticleSystem::getSortingEnabled(), particles are bitonic sorted back to front
+               and gathered in order.
+        @par
+        The jobs are "Compute/Tools/Particles/Emit", "Simulate", "BitonicSort" & "Gather",
+        from Samples/Media/Compute/Tools.
+        Particle systems with affectors that can't run on the GPU (see
+        ParticleAffector2::getGpuParams()) are simulated on the CPU.
+        @par
+        Because positions never come back to the CPU, GPU-simulated systems have infinite bounds.
+    */
+    class _OgreExport ParticleGpuSimulation : public OgreAllocatedObj
+    {
+        VaoManager     *mVaoManager;
+        RenderSystem   *mRenderSystem;
+        HlmsCompute    *mHlmsCompute;
+        HlmsComputeJob *mEmitJob;
+        HlmsComputeJob *mSimulateJob;
+        HlmsComputeJob *mSortJob;
+        HlmsComputeJob *mGatherJob;
+
+        ResourceTransitionArray mResourceTransitions;
+
+        void dispatch( HlmsComputeJob *job, uint32 numThreads );
+
+        static void clearJobSlots( HlmsComputeJob *job );
+
+    public:
+        /// All jobs must be valid. See ParticleSystemManager2::_getGpuSimulation().
+        ParticleGpuSimulation( RenderSystem *renderSystem, HlmsCompute *hlmsCompute,
+                               HlmsComputeJob *emitJob, HlmsComputeJob *simulateJob,
+                               HlmsComputeJob *sortJob, HlmsComputeJob *gatherJob );
+
+        /// Returns true if all of the systemDef's affectors can run on the GPU
+        /// and its quota fits in a single dispatch.
+        bool canSimulate( const ParticleSystemDef *systemDef ) const;
+
+        /// Creates the GPU buffers for the given system.
+        /// Called by ParticleSystemDef::init().
+        ParticleGpuSimData *createSimData( const ParticleSystemDef *systemDef );
+
+        void destroySimData( ParticleGpuSimData *simData );
+
+        /** Maps the upload buffer for the particles emitted this frame and records
+            the range of particles to simulate.
+            Called from main thread after ParticleSystemManager2::_prepareParallel().
+        */
+        void _beginUpdate( ParticleSystemDef *systemDef, uint32 numEmitted );
+
+        /** Copies the given newly emitted particles (already initialized in cpuData)
+            into the upload buffer. Called from multiple threads.
+        @param offset
+            Where in the upload buffer to start writing.
+        */
+        static void _uploadEmitted( ParticleGpuSimData *simData, const ParticleCpuData &cpuData,
+                                    const EmittedParticle *newParticles, size_t numParticles,
+                                    size_t offset );
+
+        /// Unmaps and dispatches all the GPU work of the given systems.
+        /// Called from main thread.
+        void _dispatch( const FastArray<ParticleSystemDef *> &systemDefs, float timeSinceLast,
+                        const Vector3 &camPos );
+    };
+
+    OGRE_ASSUME_NONNULL_END
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -47,6 +47,7 @@ namespace Ogre
     class EmitterDefData;
     struct EmitterInstanceData;
     class ParticleSystem2;
+    struct ParticleGpuSimData;
 
     static constexpr uint8 kParticleSystemDefaultRenderQueueId = 15u;
 
@@ -122,6 +123,7 @@ namespace Ogre
 
     protected:
         friend class ParticleSystemManager2;
+        friend class ParticleGpuSimulation;
 
         String mName;
 
@@ -174,6 +176,25 @@ namespace Ogre
         /// One per thread.
         FastArray<Aabb> mAabb;
 
+        /// Only used when getSortingEnabled() == true.
+        ///
+        /// tickParticles() fills this staging copy instead of the mapped buffer, along
+        /// with one depth key per particle. ParticleSystemManager2::_sortParallel() then
+        /// radix sorts the keys and gathers the particles back to front into mMappedGpuData.
+        FastArray<ParticleGpuData> mSortStagingGpuData;
+        /// Double-buffered radix sort keys and indices into mSortStagingGpuData.
+        FastArray<uint32> mSortKeys[2];
+        FastArray<uint32> mSortIndices[2];
+        /// One row of 256 buckets per thread.
+        FastArray<uint32> mSortHistogram;
+        /// The mapped mGpuData while mParticleGpuData points to mSortStagingGpuData.
+        ParticleGpuData *ogre_nullable mMappedGpuData;
+
+        /// See setGpuSimulation().
+        bool mGpuSimulation;
+        /// Non-null if we're actually being simulated on the GPU.
+        ParticleGpuSimData *ogre_nullable mGpuSimData;
+
         ParticleType::ParticleType mParticleType;
 
         uint32 allocParticle();
@@ -244,6 +265,26 @@ namespace Ogre
 
         void setRotationType( ParticleRotationType::ParticleRotationType rotationType );
 
+        /** Simulates the particles with compute shaders instead of the CPU.
+            See ParticleGpuSimulation.
+        @remarks
+            Must be called before init().
+            @par
+            This is a request. We still simulate on the CPU if the compute jobs are not
+            available (e.g. the NULL RenderSystem, or the Compute/Tools resources were not
+            loaded) or if any of our affectors can't run on the GPU. Use isGpuSimulated()
+            after init() to know which one is being used.
+        @param bGpuSimulation
+            True to request GPU simulation. Default is false.
+        */
+        void setGpuSimulation( bool bGpuSimulation );
+        bool getGpuSimulation() const { return mGpuSimulation; }
+
+        /// Returns true if we're actually being simulated on the GPU. See setGpuSimulation().
+        bool isGpuSimulated() const { return mGpuSimData != 0; }
+
+        ParticleGpuSimData *ogre_nullable _getGpuSimData() const { return mGpuSimData; }
+
         ParticleRotationType::ParticleRotationType getRotationType() const;
 
         /// See setCommonDirection() and setCommonUpVector().
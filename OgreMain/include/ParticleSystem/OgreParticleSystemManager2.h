@@ -45,6 +45,7 @@ namespace Ogre
     OGRE_ASSUME_NONNULL_BEGIN
 
     class ParticleSystemDef;
+    class ParticleGpuSimulation;
 
     class ParticleAffectorFactory2;
     class ParticleEmitterDefDataFactory;
@@ -77,13 +78,31 @@ namespace Ogre
         FastArray<ParticleSystemDef *> mActiveParticlesLeftToSort;  // GUARDED_BY( mSortMutex )
         LightweightMutex               mSortMutex;
 
+        /// Systems (and BillboardSets) with getSortingEnabled() == true that have live particles.
+        /// Gathered in prepareForUpdate().
+        FastArray<ParticleSystemDef *> mDepthSortedSystemDefs;
+
+        /// Created on demand by _getGpuSimulation().
+        ParticleGpuSimulation *ogre_nullable mGpuSimulation;
+        /// True once we've tried to create mGpuSimulation, successfully or not.
+        bool mGpuSimulationChecked;
+
         void calculateHighestPossibleQuota( VaoManager *vaoManager );
         void createSharedIndexBuffers( VaoManager *vaoManager );
 
         inline void tickParticles( size_t threadIdx, ArrayReal timeSinceLast, ParticleCpuData cpuData,
-                                   ParticleGpuData *gpuData, const size_t numParticles,
+                                   ParticleGpuData *gpuData, uint32 *ogre_nullable sortKeys,
+                                   const ArrayVector3 &camPos, const size_t numParticles,
                                    ParticleSystemDef *systemDef, ArrayAabb &inOutAabb );
 
+        /// Redirects tickParticles() of a system with sorting enabled to its staging buffers.
+        void prepareDepthSort( ParticleSystemDef *systemDef, ParticleGpuData *mappedGpuData );
+
+        /// Like tickParticles(), but only advances the time to live.
+        /// Used by systems simulated on the GPU to know which particles died.
+        inline void tickTimeToLive( size_t threadIdx, ArrayReal timeSinceLast, ParticleCpuData cpuData,
+                                    const size_t numParticles, ParticleSystemDef *systemDef );
+
         inline void sortAndPrepare( ParticleSystemDef *systemDef, const Vector3 &camPos,
                                     float timeSinceLast );
 
@@ -197,6 +216,13 @@ namespace Ogre
 
         IndexBufferPacked *_getSharedIndexBuffer( size_t maxQuota, VaoManager *vaoManager );
 
+        /** Returns the ParticleGpuSimulation used by systems requesting it
+            (see ParticleSystemDef::setGpuSimulation()), creating it if needed.
+        @return
+            Null if the compute jobs couldn't be found, or if we don't belong to a SceneManager.
+        */
+        ParticleGpuSimulation *ogre_nullable _getGpuSimulation();
+
         /** All instances are sorted every frame to their distance to camera.
 
             Closer instances are given higher priority to emit. If instances reach the shared Quota
@@ -266,6 +292,25 @@ namespace Ogre
         */
         void _updateParallel02( size_t threadIdx, size_t numThreads );
 
+        /// Returns the number of times _sortParallel() must be called (separated by a barrier)
+        /// after _updateParallel02(). Returns 0 if no system needs its particles depth sorted.
+        /// See ParticleSystem::setSortingEnabled().
+        uint32 _getNumSortStages() const;
+
+        /** See _getNumSortStages().
+            This function is called from multiple threads.
+        @remarks
+            Particles of systems with sorting enabled are sorted back to front (relative to
+            getCameraPosition()) using a parallel LSD radix sort. Each pass is split in two stages
+            (per-thread histogram, then scatter); and a final stage copies the sorted particles
+            into the GPU buffer.
+        @param threadIdx
+        @param numThreads
+        @param stage
+            In range [0; _getNumSortStages())
+        */
+        void _sortParallel( size_t threadIdx, size_t numThreads, uint32 stage );
+
         /// See prepareForUpdate()
         ///
         /// Must be called after prepareForUpdate() & _prepareParallel().
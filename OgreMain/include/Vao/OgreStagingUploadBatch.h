@@ -0,0 +1,160 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _Ogre_StagingUploadBatch_H_
+#define _Ogre_StagingUploadBatch_H_
+
+#include "OgrePrerequisites.h"
+
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** Collects many small uploads to BT_DEFAULT buffers and sends them to the GPU
+        with as few StagingBuffers as possible.
+
+        Calling BufferPacked::upload for each buffer grabs a StagingBuffer, maps it and
+        issues a copy every time. Instead:
+        @code
+            StagingUploadBatch batch( vaoManager );
+            batch.enqueue( vertexBuffer, 0, numVertices, vertexData );
+            batch.enqueue( indexBuffer, 0, numIndices, indexData );
+            // ...
+            batch.flush();
+        @endcode
+        flush() packs all the data into a single StagingBuffer map (or a few, if it
+        exceeds getMaxStagingSize) and issues all copies on unmap. Uploads to consecutive
+        regions of the same buffer are merged into a single copy.
+    @remarks
+        The data is copied on enqueue, thus it can be freed right away.
+        The destination buffers must not be destroyed before flush() is called.
+    @par
+        Overlapping uploads to the same region within the same batch are not allowed.
+    @par
+        Dynamic (and shared) buffers, and buffers with a shadow copy are uploaded
+        immediately via BufferPacked::upload; there is nothing to gain from batching
+        them.
+    */
+    class _OgreExport StagingUploadBatch : public OgreAllocatedObj
+    {
+    public:
+        struct Stats
+        {
+            /// Calls to enqueue()
+            size_t numUploads;
+            /// Calls to enqueue() that went straight to BufferPacked::upload
+            size_t numDirectUploads;
+            /// GPU copies issued. Less than numUploads - numDirectUploads
+            /// when uploads could be merged
+            size_t numCopies;
+            /// StagingBuffer maps. Without batching, there would be one per upload
+            size_t numStagingMaps;
+            size_t bytesUploaded;
+
+            Stats() :
+                numUploads( 0u ),
+                numDirectUploads( 0u ),
+                numCopies( 0u ),
+                numStagingMaps( 0u ),
+                bytesUploaded( 0u )
+            {
+            }
+        };
+
+    protected:
+        struct PendingUpload
+        {
+            BufferPacked *buffer;
+            /// In bytes
+            size_t dstOffset;
+            /// Offset in mData, in bytes
+            size_t srcOffset;
+            size_t length;
+        };
+        typedef vector<PendingUpload>::type PendingUploadVec;
+
+        VaoManager *mVaoManager;
+
+        PendingUploadVec mPendingUploads;
+        vector<uint8>::type mData;
+
+        size_t mMaxStagingSize;
+        Stats  mStats;
+
+        /// Maps a StagingBuffer and copies mPendingUploads[start; end)
+        void flushRange( size_t start, size_t end );
+
+    public:
+        StagingUploadBatch( VaoManager *vaoManager );
+        ~StagingUploadBatch();
+
+        /** Schedules data to be uploaded on the next flush().
+        @remarks
+            Throws if the buffer is BT_IMMUTABLE or the range is out of bounds,
+            just like BufferPacked::upload.
+        @param buffer
+            Buffer to upload to.
+        @param elementStart
+            First element to write to.
+        @param elementCount
+            Number of elements to write.
+        @param data
+            Data to upload. Must hold elementCount * buffer->getBytesPerElement() bytes.
+            It gets copied, so it doesn't need to outlive this call.
+        */
+        void enqueue( BufferPacked *buffer, size_t elementStart, size_t elementCount,
+                      const void *data );
+
+        /// Sends all the pending uploads to the GPU
+        void flush();
+
+        /// Forgets all pending uploads without uploading anything.
+        /// Useful if the destination buffers are about to be destroyed.
+        void discardPending();
+
+        bool   hasPendingUploads() const { return !mPendingUploads.empty(); }
+        size_t getPendingBytes() const { return mData.size(); }
+
+        /** Maximum size in bytes of each StagingBuffer map. Batches bigger than this
+            are split across multiple maps. Uploads bigger than this get a map of
+            their own. Default is 32MB.
+        */
+        void   setMaxStagingSize( size_t maxSizeBytes );
+        size_t getMaxStagingSize() const { return mMaxStagingSize; }
+
+        /// Accumulated statistics since construction or the last resetStats call
+        const Stats &getStats() const { return mStats; }
+        void         resetStats() { mStats = Stats(); }
+    };
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
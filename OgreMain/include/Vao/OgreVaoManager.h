@@ -86,6 +86,37 @@ namespace Ogre
 
         DelayedBufferVec mDelayedDestroyBuffers;
 
+        /// Holds the buffers allocateTransientVertices & allocateTransientIndices
+        /// sub-allocate from. There is one ring per vertex format / index type.
+        struct TransientRing
+        {
+            /// Empty for index buffers
+            VertexElement2Vec            vertexElements;
+            IndexBufferPacked::IndexType indexType;
+            uint32                       bytesPerElement;
+
+            /// All of them are BT_DYNAMIC_PERSISTENT. They're never destroyed until
+            /// destroyTransientBuffers is called.
+            /// A buffer is mapped (with bAdvanceFrame = true) at most once per frame, so that
+            /// its _getFinalBufferStart already points to this frame's region when the
+            /// RenderQueue bakes it into the draws. We move on to the next one when the current
+            /// one is full or has been flushed for the RenderQueue.
+            BufferPackedVec buffers;
+            size_t          currentBuffer;
+            /// First buffer that hasn't been mapped yet this frame
+            size_t nextBuffer;
+            /// Next free element in buffers[currentBuffer]
+            size_t offset;
+            /// Null if buffers[currentBuffer] is not mapped (or has been flushed)
+            uint8 *mappedPtr;
+        };
+
+        typedef vector<TransientRing>::type TransientRingVec;
+
+        TransientRingVec mTransientRings;
+        size_t           mTransientBufferDefaultSize;
+        size_t           mTransientBytesAllocated;
+
         uint32 mConstBufferAlignment;
         uint32 mTexBufferAlignment;
         uint32 mUavBufferAlignment;
@@ -163,10 +194,82 @@ namespace Ogre
 
         inline void callDestroyBufferImpl( BufferPacked *bufferPacked );
 
+        TransientRing &getTransientRing( const VertexElement2Vec     &vertexElements,
+                                         IndexBufferPacked::IndexType indexType );
+        void           unmapTransientRing( TransientRing &ring );
+        /// Unmaps all transient buffers and starts over
+        void transientBuffersFrameEnded();
+
         void switchVboPoolIndex( unsigned internalVboBufferType, size_t oldPoolIdx, size_t newPoolIdx );
         virtual void switchVboPoolIndexImpl( unsigned internalVboBufferType, size_t oldPoolIdx,
                                              size_t newPoolIdx, BufferPacked *buffer ) = 0;
 
+    public:
+        struct DefragmentationReport
+        {
+            /// Bytes copied from one pool to another
+            size_t bytesMoved;
+            uint32 numBuffersMoved;
+            /// Pools we've managed to empty. Their memory has been released by the time
+            /// defragmentPools returns (or will be released soon, depending on the RenderSystem)
+            uint32 numPoolsReleased;
+            size_t bytesReleased;
+
+            DefragmentationReport() :
+                bytesMoved( 0u ),
+                numBuffersMoved( 0u ),
+                numPoolsReleased( 0u ),
+                bytesReleased( 0u )
+            {
+            }
+        };
+
+        /// See VaoManager::allocateTransientVertices
+        struct TransientAllocation
+        {
+            /// Either a VertexBufferPacked or an IndexBufferPacked.
+            /// The same pointer is returned frame after frame unless a frame needs more
+            /// than what the existing buffers can hold, or keeps allocating after a
+            /// RenderQueue has executed.
+            BufferPacked *buffer;
+            /// Where to write the data. Valid until the RenderQueue executes its
+            /// commands, or until the frame ends, whichever happens first.
+            void  *data;
+            size_t elementStart;
+            size_t numElements;
+        };
+
+    protected:
+        /** Fills outBuffers with the buffers defragmentPoolsImpl is allowed to move:
+            BT_IMMUTABLE & BT_DEFAULT vertex and index buffers.
+            Vertex buffers that share a Vao with other vertex buffers are left out, because
+            all vertex buffers in a Vao must start at the same element.
+        */
+        void getRelocatableBuffers( BufferPackedVec &outBuffers ) const;
+
+        /** Recreates the API Vaos of all VertexArrayObjects that reference any of the
+            given buffers, so that they point to the buffers' new location.
+            The VertexArrayObject pointers stay the same.
+        */
+        void updateVaosOfRelocatedBuffers( const BufferPackedVec &relocatedBuffers );
+
+        /** Moves buffers (from the given candidates) out of the emptiest pool into the
+            remaining pools, calls updateVaosOfRelocatedBuffers and releases the pool if
+            it became empty. The default implementation does nothing (unsupported).
+        @param maxBytesToMove
+            Stop once this many bytes have been copied.
+        @param candidates
+            See getRelocatableBuffers.
+        @param inOutReport [in/out]
+            Must be updated with the buffers moved and the pools that became empty.
+        */
+        virtual void defragmentPoolsImpl( size_t maxBytesToMove, const BufferPackedVec &candidates,
+                                          DefragmentationReport &inOutReport )
+        {
+        }
+
+        TransientAllocation allocateTransient( TransientRing &ring, size_t numElements );
+
     public:
         VaoManager( const NameValuePairList *params );
         virtual ~VaoManager();
@@ -186,22 +289,40 @@ namespace Ogre
             size_t sizeBytes;
             size_t
                 poolCapacity;  ///< This value is the same for all entries with same getCombinedPoolIdx
+            /// Free bytes in the pool. Same for all entries with same getCombinedPoolIdx
+            size_t poolFreeBytes;
+            /// Largest contiguous free range in the pool, i.e. the largest buffer that
+            /// can still be allocated from it. Same for all entries with same getCombinedPoolIdx
+            size_t poolLargestFreeBlock;
             /// Relevant for Vulkan: when this value is true, the whole pool
             /// may contain texture data (not necessarily this block)
             /// See Tutorial_Memory on how to deal with this parameter
             bool bPoolHasTextures;
 
             MemoryStatsEntry( uint32 _poolType, uint32 _poolIdx, size_t _offset, size_t _sizeBytes,
-                              size_t _poolCapacity, bool _bPoolHasTextures ) :
+                              size_t _poolCapacity, bool _bPoolHasTextures,
+                              size_t _poolFreeBytes = 0u, size_t _poolLargestFreeBlock = 0u ) :
                 poolType( _poolType ),
                 poolIdx( _poolIdx ),
                 offset( _offset ),
                 sizeBytes( _sizeBytes ),
                 poolCapacity( _poolCapacity ),
+                poolFreeBytes( _poolFreeBytes ),
+                poolLargestFreeBlock( _poolLargestFreeBlock ),
                 bPoolHasTextures( _bPoolHasTextures )
             {
             }
 
+            /** Returns a value in range [0; 1]. 0 means all the free memory in the pool is
+                contiguous, values close to 1 mean it is scattered in many small blocks.
+            */
+            float getPoolFragmentation() const
+            {
+                if( !poolFreeBytes )
+                    return 0.0f;
+                return 1.0f - float( double( poolLargestFreeBlock ) / double( poolFreeBytes ) );
+            }
+
             /**
             @brief getCombinedPoolIdx
                 You can use this code to calculate pool capacity per poolType:
@@ -244,12 +365,11 @@ namespace Ogre
 
             These are the chunks of memory currently in use. If there are multiple
             entries belonging to the same pool, that means the memory has been
-            fragmented.
+            fragmented. See MemoryStatsEntry::getPoolFragmentation.
 
             The actual output may vary depending on the RenderSystem.
         @remarks
-            Worst case scenario this function has O(N^2) complexity where N
-            is the number of free blocks.
+            This function has O(N) complexity where N is the number of blocks.
         @param outStats
             Detailed information about each entry.
         @param outCapacityBytes
@@ -274,6 +394,36 @@ namespace Ogre
         /// Frees GPU memory if there are empty, unused pools
         virtual void cleanupEmptyPools() = 0;
 
+        /** Incrementally compacts the GPU pools where BT_IMMUTABLE & BT_DEFAULT buffers live.
+
+            Long running applications that keep creating and destroying buffers end up with
+            pools full of holes, and new pools get created even though the total free
+            memory would be enough.
+
+            Each call picks the emptiest pool and moves its vertex & index buffers into the
+            other pools using GPU-side copies (nothing is downloaded to the CPU), then patches
+            the VertexArrayObjects that reference them. Once the pool is empty, its memory
+            gets released via cleanupEmptyPools.
+
+            Call it once per frame (e.g. between frames or during loading screens) with a
+            budget; the work gets spread over as many frames as needed.
+        @remarks
+            Buffer pointers and VertexArrayObject pointers stay valid. However their internal
+            offsets, VaoName & RenderQueueId change, so don't cache them across this call.
+
+            Pools also holding other types of buffers (or textures, in Vulkan) won't be
+            emptied, but their vertex & index buffers still get moved.
+
+            This function is O(N) where N is the number of buffers.
+
+            Currently supported by GL3Plus, Vulkan and Metal. It does nothing elsewhere.
+        @param maxBytesToMove
+            Maximum number of bytes to copy in this call.
+        @return
+            What has been done in this call.
+        */
+        DefragmentationReport defragmentPools( size_t maxBytesToMove );
+
         /// Returns the size of a single vertex buffer source with the given declaration, in bytes
         static uint32 calculateVertexSize( const VertexElement2Vec &vertexElements );
 
@@ -460,6 +610,65 @@ namespace Ogre
         */
         void destroyVertexArrayObject( VertexArrayObject *vao );
 
+        /** Sub-allocates vertices for data that is only valid for the current frame
+            (e.g. geometry rebuilt every frame, debug lines, UI).
+
+            Unlike creating BT_DYNAMIC_DEFAULT buffers, this is just a pointer bump: all
+            allocations of the same vertex format share a few large BT_DYNAMIC_PERSISTENT
+            buffers that stay mapped for the whole frame. Every allocation is released
+            automatically at the end of the frame; the memory gets reused once the GPU is
+            done with that frame (i.e. every getDynamicBufferMultiplier frames) so there is
+            no need to destroy anything.
+        @remarks
+            Write the data before the RenderQueue that draws it executes its commands.
+            After that, allocations made earlier in the frame must no longer be written to
+            (new allocations are fine, but will come from a different buffer since each
+            buffer is only mapped once per frame).
+        @par
+            To draw it, create a VertexArrayObject with TransientAllocation::buffer once
+            and call VertexArrayObject::setPrimitiveRange every frame:
+                - Non-indexed: setPrimitiveRange( elementStart, numElements ).
+                - Indexed: use allocateTransientIndices for the index buffer and call
+                  setPrimitiveRange on the index allocation. Since all draws from the
+                  same buffer share the same base vertex, the indices must have the
+                  vertex allocation's elementStart added to them.
+            Keep a Vao per buffer, as a different buffer may be returned if a frame
+            allocates more than what the existing buffers can hold.
+        @param vertexElements
+            Vertex format. Allocations with the same format come from the same buffers.
+        @param numVertices
+            Must be > 0
+        */
+        TransientAllocation allocateTransientVertices( const VertexElement2Vec &vertexElements,
+                                                       size_t                   numVertices );
+
+        /** Sub-allocates indices for data that is only valid for the current frame.
+            See allocateTransientVertices.
+        */
+        TransientAllocation allocateTransientIndices( IndexBufferPacked::IndexType indexType,
+                                                      size_t                       numIndices );
+
+        /** Size in bytes of each new buffer used by allocateTransientVertices &
+            allocateTransientIndices. Allocations bigger than this get a buffer of their
+            own size. Default is 4MB. Note the actual memory consumption is multiplied
+            by getDynamicBufferMultiplier.
+        */
+        void   setTransientBufferDefaultSize( size_t sizeBytes );
+        size_t getTransientBufferDefaultSize() const { return mTransientBufferDefaultSize; }
+
+        /// Bytes handed out by allocateTransientVertices & allocateTransientIndices this frame
+        size_t getTransientBytesAllocated() const { return mTransientBytesAllocated; }
+
+        /** Releases the memory used by transient allocations.
+            Allocations from the current frame become invalid, and so do the Vaos
+            created with their buffers. Don't call it while rendering.
+        */
+        void destroyTransientBuffers();
+
+        /// Flushes the transient buffers so the GPU can see their contents.
+        /// Called by the RenderQueue before executing its commands.
+        void _preCommandBufferExecution();
+
         /** Creates a new staging buffer and adds it to the pool. @see getStagingBuffer.
         @remarks
             The returned buffer starts with a reference count of 1. You should decrease
@@ -0,0 +1,189 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _Ogre_VboSubAllocator_H_
+#define _Ogre_VboSubAllocator_H_
+
+#include "OgrePrerequisites.h"
+
+#include "ogrestd/unordered_map.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** Manages the ranges of a single GPU pool (i.e. one Vbo of a VaoManager) using a
+        Two-Level Segregated Fit (TLSF) allocator.
+
+        Both allocate() and deallocate() run in constant time regardless of how many
+        free blocks there are or how fragmented the pool is:
+            - Free blocks are kept in bins. The first level splits sizes by powers of
+              two, the second level splits each power of two into 2^SlLog2 linear bins.
+              Two bitmasks tell which bins are non-empty, so finding a suitable bin is
+              just a couple of bit scans.
+            - Every block (free or used) knows its physical neighbours, so merging on
+              deallocation doesn't need to search.
+        Alignment padding is split off as its own free block instead of being tracked
+        separately, thus deallocate() only needs the offset that allocate() returned.
+    @remarks
+        The allocator only does bookkeeping. It never touches the memory it manages.
+    */
+    class _OgreExport VboSubAllocator
+    {
+    public:
+        struct Block
+        {
+            size_t offset;
+            size_t size;
+
+            Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
+        };
+        typedef vector<Block>::type BlockVec;
+
+    protected:
+        enum
+        {
+            SlLog2 = 4u,
+            SlCount = 1u << SlLog2,
+            FlCount = 64u - SlLog2 + 1u
+        };
+
+        static const uint32 InvalidNode = 0xFFFFFFFF;
+
+        struct Node
+        {
+            size_t offset;
+            size_t size;
+            uint32 prevPhys;
+            uint32 nextPhys;
+            uint32 prevFree;
+            uint32 nextFree;
+            bool   isFree;
+        };
+        typedef vector<Node>::type                  NodeVec;
+        typedef vector<uint32>::type                NodeIdxVec;
+        typedef unordered_map<size_t, uint32>::type OffsetToNodeMap;
+
+        size_t mCapacity;
+        size_t mFreeBytes;
+        uint32 mNumFreeBlocks;
+
+        uint64 mFlBitmap;
+        uint32 mSlBitmap[FlCount];
+        uint32 mFreeHeads[FlCount][SlCount];
+
+        NodeVec    mNodes;
+        NodeIdxVec mUnusedNodes;
+        /// The node at offset 0. It never gets merged away.
+        uint32 mFirstNode;
+        /// Used nodes, by offset
+        OffsetToNodeMap mUsedNodes;
+
+        static void mappingInsert( size_t size, uint32 &outFl, uint32 &outSl );
+        static void mappingSearch( size_t size, uint32 &outFl, uint32 &outSl );
+
+        uint32 createNode( size_t offset, size_t size );
+        void   destroyNode( uint32 nodeIdx );
+
+        void insertFreeNode( uint32 nodeIdx );
+        void removeFreeNode( uint32 nodeIdx );
+
+        /// Returns a free node of at least the requested size, InvalidNode if there's none.
+        /// The node is not removed from its bin.
+        uint32 findSuitableNode( size_t size ) const;
+
+        /// Splits the node so that it ends up being exactly newSize bytes.
+        /// Returns the index of the new node holding the remainder. It is not put in any bin.
+        uint32 splitNode( uint32 nodeIdx, size_t newSize );
+
+        /// Looks in the bin where nodes of exactly 'size' bytes would go for one that fits.
+        /// Unlike findSuitableNode, this is a linear search over a single bin.
+        uint32 findNodeInExactBin( size_t size, size_t alignment ) const;
+
+        /// Merges nodeIdx with nextIdx (its physical neighbour), destroying nextIdx.
+        void mergeWithNext( uint32 nodeIdx, uint32 nextIdx );
+
+    public:
+        VboSubAllocator();
+        explicit VboSubAllocator( size_t capacity );
+
+        /// Forgets about all allocations and starts over with a pool of the given size.
+        void reset( size_t capacity );
+
+        /** Allocates a range within the pool.
+        @param sizeBytes
+            Size in bytes. Must be > 0.
+        @param alignment
+            Must be > 0. Doesn't have to be power of 2.
+        @param outOffset [out]
+            Offset of the allocation. Multiple of alignment.
+        @return
+            False if there is no free range large enough.
+        */
+        bool allocate( size_t sizeBytes, size_t alignment, size_t &outOffset );
+
+        /** Releases a range returned by allocate.
+        @param offset
+            Offset returned by allocate.
+        @param sizeBytes
+            Size passed to allocate. Only used for validation.
+        */
+        void deallocate( size_t offset, size_t sizeBytes );
+
+        size_t getCapacity() const { return mCapacity; }
+        size_t getFreeBytes() const { return mFreeBytes; }
+        size_t getUsedBytes() const { return mCapacity - mFreeBytes; }
+        uint32 getNumFreeBlocks() const { return mNumFreeBlocks; }
+        size_t getNumAllocations() const { return mUsedNodes.size(); }
+
+        /// True if there are no allocations.
+        bool isEmpty() const { return mFreeBytes == mCapacity; }
+
+        /// Size of the largest allocation that could succeed with an alignment of 1.
+        size_t getLargestFreeBlock() const;
+
+        /** Returns a value in range [0; 1]. 0 means all the free memory is contiguous,
+            values close to 1 mean the free memory is scattered in lots of small blocks.
+            Calculated as 1 - largestFreeBlock / freeBytes.
+        */
+        float getFragmentation() const;
+
+        /// Fills outBlocks with all free blocks, sorted by offset. O(N).
+        void getFreeBlocks( BlockVec &outBlocks ) const;
+
+        /** Fills outBlocks with all used ranges, sorted by offset. O(N).
+            Contiguous allocations are reported as a single range.
+        */
+        void getUsedBlocks( BlockVec &outBlocks ) const;
+    };
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include "OgrePrerequisites.h"
 
+#include "OgreMeshlet.h"
 #include "OgreRenderOperation.h"
 #include "OgreVertexBufferPacked.h"
 
@@ -54,15 +55,20 @@ namespace Ogre
         be changed automatically by the VaoManager as it performs maintenance
         and cleanups of these type of buffers (in practice only affects D3D11).
         Don't rely on the contents of these two variables if the Vao contains
+    @par
+        The same applies to Vaos with BT_DEFAULT buffers after calling
+        VaoManager::defragmentPools.
     */
     struct _OgreExport VertexArrayObject : public OgreAllocatedObj
     {
         friend class RenderQueue;
         friend class RenderSystem;
+        friend class VaoManager;
         friend class D3D11RenderSystem;
         friend class GL3PlusRenderSystem;
         friend class GLES2RenderSystem;
         friend class MetalRenderSystem;
+        friend class SubMesh;
 
     protected:
         /// ID of the internal vertex and index buffer layouts. If this ID
@@ -94,6 +100,9 @@ namespace Ogre
         /// The type of operation to perform
         OperationType mOperationType;
 
+        /// Clusters the index range is made of. Owned by the SubMesh. May be null.
+        const MeshletVec *mMeshlets;
+
     public:
         VertexArrayObject( uint32 vaoName, uint32 renderQueueId, uint16 inputLayoutId,
                            const VertexBufferPackedVec &vertexBuffers, IndexBufferPacked *indexBuffer,
@@ -112,6 +121,10 @@ namespace Ogre
         uint32 getPrimitiveStart() const { return mPrimStart; }
         uint32 getPrimitiveCount() const { return mPrimCount; }
 
+        /// Returns the clusters of triangles of this Vao, for per-cluster culling. Null if none.
+        /// See MeshOptimizer::buildMeshlets.
+        const MeshletVec *getMeshlets() const { return mMeshlets; }
+
         /** Limits the range of triangle primitives that is rendered.
             For VAOs with index buffers, this controls the index start & count,
             akin to indexStart & indexCount from the v1 objects.
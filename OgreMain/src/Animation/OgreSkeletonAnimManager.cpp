@@ -112,6 +112,9 @@ namespace Ogre
 
         skeletonsArray.insert( it, newInstance );
 
+        // Throttled animations (see SceneManager::setAnimationLod) get spread across frames
+        newInstance->_setAnimationLodPhase( static_cast<uint32>( skeletonsArray.size() ) );
+
 #if OGRE_DEBUG_MODE >= OGRE_DEBUG_HIGH
         {
             // Check all depth levels respect the same ordering
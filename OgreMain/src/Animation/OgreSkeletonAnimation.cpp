@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "Animation/OgreSkeletonAnimation.h"
 
 #include "Animation/OgreSkeletonAnimationDef.h"
+#include "Animation/OgreSkeletonDef.h"
 #include "Animation/OgreSkeletonInstance.h"
 
 #if defined( __GNUC__ ) && !defined( __clang__ )
@@ -317,16 +318,46 @@ namespace Ogre
         ArrayReal simdWeight = Mathlib::SetAll( mWeight );
         ArrayReal *RESTRICT_ALIAS boneWeights = mBoneWeights.get();
 
+        uint8 const *trackUsed = mTrackUsed.empty() ? 0 : mTrackUsed.begin();
+
         while( itor != endt )
         {
-            itor->applyKeyFrameRigAt( *itLastKnownKeyFrame, mCurrentFrame, simdWeight, boneWeights,
-                                      boneTransforms );
+            if( !trackUsed || *trackUsed++ )
+            {
+                itor->applyKeyFrameRigAt( *itLastKnownKeyFrame, mCurrentFrame, simdWeight, boneWeights,
+                                          boneTransforms );
+            }
             ++itLastKnownKeyFrame;
             ++boneWeights;
             ++itor;
         }
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonAnimation::_setUsedBones( const vector<bool>::type *usedBones )
+    {
+        mTrackUsed.clear();
+        if( !usedBones )
+            return;
+
+        mTrackUsed.resize( mDefinition->mTracks.size(), 0u );
+
+        const SkeletonDef::BoneDataVec &bones = mOwner->getDefinition()->getBones();
+        for( size_t i = 0u; i < bones.size(); ++i )
+        {
+            if( !( *usedBones )[i] )
+                continue;
+
+            map<IdString, size_t>::type::const_iterator itor =
+                mDefinition->mBoneToWeights.find( bones[i].name );
+            if( itor != mDefinition->mBoneToWeights.end() )
+            {
+                // Each track animates a block of ARRAY_PACKED_REALS bones. See setBoneWeight
+                const size_t offset = itor->second & 0x00FFFFFF;
+                mTrackUsed[offset / ARRAY_PACKED_REALS] = 1u;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonAnimation::_swapBoneWeightsUniquePtr(
         RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION> &inOutBoneWeights )
     {
@@ -382,6 +382,73 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonAnimationDef::compress( Real positionTolerance, Radian orientationTolerance,
+                                         Real scaleTolerance )
+    {
+        OGRE_ASSERT_LOW( !isCompressed() && "Animation already compressed" );
+
+        vector<size_t>::type trackRemap;
+        trackRemap.reserve( mTracks.size() );
+
+        SkeletonTrackVec compressedTracks;
+        compressedTracks.reserve( mTracks.size() );
+
+        SkeletonTrackVec::iterator itor = mTracks.begin();
+        SkeletonTrackVec::iterator endt = mTracks.end();
+
+        while( itor != endt )
+        {
+            const bool isIdentity = itor->compress(
+                positionTolerance, orientationTolerance.valueRadians(), scaleTolerance );
+            if( isIdentity )
+            {
+                trackRemap.push_back( std::numeric_limits<size_t>::max() );
+            }
+            else
+            {
+                trackRemap.push_back( compressedTracks.size() );
+                compressedTracks.push_back( *itor );
+            }
+            ++itor;
+        }
+
+        mTracks.swap( compressedTracks );
+
+        // Point mBoneToWeights to the new track indices, and forget about removed ones
+        map<IdString, size_t>::type::iterator itBone = mBoneToWeights.begin();
+        map<IdString, size_t>::type::iterator enBone = mBoneToWeights.end();
+
+        while( itBone != enBone )
+        {
+            const size_t offset = itBone->second & 0x00FFFFFF;
+            const size_t newTrackIdx = trackRemap[offset / ARRAY_PACKED_REALS];
+
+            if( newTrackIdx == std::numeric_limits<size_t>::max() )
+            {
+                mBoneToWeights.erase( itBone++ );
+            }
+            else
+            {
+                itBone->second = ( itBone->second & 0xFF000000 ) |
+                                 ( newTrackIdx * ARRAY_PACKED_REALS + offset % ARRAY_PACKED_REALS );
+                ++itBone;
+            }
+        }
+
+        // No track references the uncompressed keyframes anymore
+        if( mKfTransformMemoryManager )
+        {
+            mKfTransformMemoryManager->destroy();
+            delete mKfTransformMemoryManager;
+            mKfTransformMemoryManager = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonAnimationDef::isCompressed() const
+    {
+        return !mTracks.empty() && mTracks.front().isCompressed();
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonAnimationDef::_dumpCsvTracks( String &outText ) const
     {
         const SkeletonDef::BoneDataVec &mBones = mSkeletonDef->getBones();
@@ -419,14 +486,12 @@ namespace Ogre
                         outText += StringConverter::toString( itKeyFrames->mFrame );
                         outText += ",";
 
-                        const KfTransform *RESTRICT_ALIAS boneTransform = itKeyFrames->mBoneTransform;
-
                         Vector3 vPos, vScale;
                         Quaternion qRot;
 
-                        boneTransform->mPosition.getAsVector3( vPos, i );
-                        boneTransform->mOrientation.getAsQuaternion( qRot, i );
-                        boneTransform->mScale.getAsVector3( vScale, i );
+                        track.getKeyFrameTransform(
+                            static_cast<size_t>( itKeyFrames - keyFrames.begin() ), i, vPos, qRot,
+                            vScale );
 
                         outText += StringConverter::toString( vPos.x ) + ",";
                         outText += StringConverter::toString( vPos.y ) + ",";
@@ -325,6 +325,19 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonDef::compressAnimations( Real positionTolerance, Radian orientationTolerance,
+                                          Real scaleTolerance )
+    {
+        SkeletonAnimationDefVec::iterator itor = mAnimationDefs.begin();
+        SkeletonAnimationDefVec::iterator endt = mAnimationDefs.end();
+
+        while( itor != endt )
+        {
+            itor->compress( positionTolerance, orientationTolerance, scaleTolerance );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     size_t SkeletonDef::getNumberOfBoneBlocks( size_t numLevels ) const
     {
         size_t numBlocks = 0;
@@ -49,6 +49,7 @@ namespace Ogre
                                         BoneMemoryManager *boneMemoryManager ) :
         mDefinition( skeletonDef ),
         mParentNode( 0 ),
+        mAnimationLodPhase( 0u ),
         mRefCount( 1 )
     {
         mBones.resize( mDefinition->getBones().size(), Bone() );
@@ -438,6 +439,8 @@ namespace Ogre
             SkeletonAnimation animation( &( *itor ), &mSlotStarts, this );
             mAnimations.push_back( animation );
             mAnimations.back()._initialize();
+            if( !mUsedBones.empty() )
+                mAnimations.back()._setUsedBones( &mUsedBones );
             ++itor;
         }
 
@@ -446,6 +449,65 @@ namespace Ogre
             mAnimations[i]._swapBoneWeightsUniquePtr( boneWeightPtrs[i] );
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonInstance::setSkinnedBones( const FastArray<unsigned short> *skinnedBones )
+    {
+        mUsedBones.clear();
+
+        if( skinnedBones )
+        {
+            mUsedBones.resize( mBones.size(), false );
+
+            FastArray<unsigned short>::const_iterator itor = skinnedBones->begin();
+            FastArray<unsigned short>::const_iterator endt = skinnedBones->end();
+            while( itor != endt )
+            {
+                if( *itor < mBones.size() )
+                    mUsedBones[*itor] = true;
+                ++itor;
+            }
+
+            for( size_t i = 0u; i < mBones.size(); ++i )
+            {
+                if( mBones[i].getNumTagPoints() )
+                    mUsedBones[i] = true;
+            }
+
+            SceneNodeBonePairVec::const_iterator itCustom = mCustomParentSceneNodes.begin();
+            SceneNodeBonePairVec::const_iterator enCustom = mCustomParentSceneNodes.end();
+            while( itCustom != enCustom )
+            {
+                mUsedBones[static_cast<size_t>( itCustom->boneChild - &mBones[0] )] = true;
+                ++itCustom;
+            }
+
+            // Parents of used bones must be animated too
+            for( size_t i = 0u; i < mBones.size(); ++i )
+            {
+                if( !mUsedBones[i] )
+                    continue;
+
+                const Bone *parent = mBones[i].getParent();
+                while( parent )
+                {
+                    const size_t parentIdx = static_cast<size_t>( parent - &mBones[0] );
+                    if( parentIdx >= mBones.size() || mUsedBones[parentIdx] )
+                        break;
+                    mUsedBones[parentIdx] = true;
+                    parent = parent->getParent();
+                }
+            }
+        }
+
+        const vector<bool>::type *usedBones = mUsedBones.empty() ? 0 : &mUsedBones;
+        SkeletonAnimationVec::iterator itAnim = mAnimations.begin();
+        SkeletonAnimationVec::iterator enAnim = mAnimations.end();
+        while( itAnim != enAnim )
+        {
+            itAnim->_setUsedBones( usedBones );
+            ++itAnim;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonInstance::_enableAnimation( SkeletonAnimation *animation )
     {
         mActiveAnimations.push_back( animation );
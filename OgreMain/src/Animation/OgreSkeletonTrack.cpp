@@ -35,15 +35,137 @@ THE SOFTWARE.
 #include "Math/Array/OgreMathlib.h"
 #include "OgreException.h"
 
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+
 namespace Ogre
 {
+    namespace
+    {
+        const Real kSqrt2 = Real( 1.41421356237309504880 );
+
+        /// Uncompressed keyframes in AoS, one entry per key & slot, used while compressing
+        struct UncompressedKeyFrames
+        {
+            vector<Real>::type       frames;
+            vector<Vector3>::type    positions;
+            vector<Quaternion>::type orientations;
+            vector<Vector3>::type    scales;
+
+            Real positionTolerance;
+            Real orientationTolerance;
+            Real scaleTolerance;
+
+            bool positionMatches( const Vector3 &a, const Vector3 &b ) const
+            {
+                return a.squaredDistance( b ) <= positionTolerance * positionTolerance;
+            }
+
+            bool orientationMatches( const Quaternion &a, const Quaternion &b ) const
+            {
+                // The angle between two unit quaternions is 4 * asin( |a - b| / 2 ),
+                // which (unlike acos( dot )) is precise for small angles
+                const Quaternion diff = a.Dot( b ) >= 0.0f ? a - b : a + b;
+                const Real halfChord = std::min( Math::Sqrt( diff.Norm() ) * 0.5f, Real( 1.0f ) );
+                return 4.0f * Math::ASin( halfChord ).valueRadians() <= orientationTolerance;
+            }
+
+            bool scaleMatches( const Vector3 &a, const Vector3 &b ) const
+            {
+                const Vector3 diff = a - b;
+                return Math::Abs( diff.x ) <= scaleTolerance &&  //
+                       Math::Abs( diff.y ) <= scaleTolerance &&  //
+                       Math::Abs( diff.z ) <= scaleTolerance;
+            }
+
+            /// Returns true if all keys (of all slots) in the open range (keyA; keyB) can be
+            /// reproduced by interpolating keyA and keyB
+            bool canInterpolate( size_t keyA, size_t keyB ) const
+            {
+                const Real invDistance = 1.0f / ( frames[keyB] - frames[keyA] );
+
+                for( size_t k = keyA + 1u; k < keyB; ++k )
+                {
+                    const Real t = ( frames[k] - frames[keyA] ) * invDistance;
+                    for( size_t i = 0u; i < ARRAY_PACKED_REALS; ++i )
+                    {
+                        const size_t a = keyA * ARRAY_PACKED_REALS + i;
+                        const size_t b = keyB * ARRAY_PACKED_REALS + i;
+                        const size_t idx = k * ARRAY_PACKED_REALS + i;
+
+                        if( !positionMatches( positions[idx],
+                                              Math::lerp( positions[a], positions[b], t ) ) ||
+                            !orientationMatches( orientations[idx],
+                                                 Quaternion::nlerp( t, orientations[a],
+                                                                    orientations[b], true ) ) ||
+                            !scaleMatches( scales[idx], Math::lerp( scales[a], scales[b], t ) ) )
+                        {
+                            return false;
+                        }
+                    }
+                }
+
+                return true;
+            }
+        };
+
+        uint16 quantiseRange( Real value, Real minValue, Real step )
+        {
+            if( step <= 0.0f )
+                return 0u;
+            return static_cast<uint16>( std::min( ( value - minValue ) / step + 0.5f, 65535.0f ) );
+        }
+
+        /// Smallest-three encoding. See SkeletonTrack::mQuantisedKeys
+        void encodeOrientation( Quaternion q, uint16 &outA, uint16 &outB, uint16 &outC )
+        {
+            size_t largestIdx = 0u;
+            for( size_t i = 1u; i < 4u; ++i )
+            {
+                if( Math::Abs( q[i] ) > Math::Abs( q[largestIdx] ) )
+                    largestIdx = i;
+            }
+
+            if( q[largestIdx] < 0.0f )
+                q = -q;
+
+            uint16 values[3];
+            for( size_t i = 0u, j = 0u; i < 4u; ++i )
+            {
+                if( i != largestIdx )
+                {
+                    // [-1 / sqrt( 2 ); 1 / sqrt( 2 )] -> [0; 32767]
+                    const Real unorm = Math::saturate( q[i] * kSqrt2 * 0.5f + 0.5f );
+                    values[j++] = static_cast<uint16>( unorm * 32767.0f + 0.5f );
+                }
+            }
+
+            outA = static_cast<uint16>( values[0] | ( ( largestIdx & 0x01u ) << 15u ) );
+            outB = static_cast<uint16>( values[1] | ( ( largestIdx & 0x02u ) << 14u ) );
+            outC = values[2];
+        }
+
+        /// Loads ARRAY_PACKED_REALS quantised values into a SIMD register
+        inline ArrayReal loadQuantised( const uint16 *RESTRICT_ALIAS src, uint32 mask )
+        {
+            OGRE_ALIGNED_DECL( Real, unpacked[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+            for( size_t i = 0u; i < ARRAY_PACKED_REALS; ++i )
+                unpacked[i] = static_cast<Real>( src[i] & mask );
+            return *reinterpret_cast<const ArrayReal *>( unpacked );
+        }
+    }  // namespace
+    //-----------------------------------------------------------------------------------
     SkeletonTrack::SkeletonTrack( uint32 boneBlockIdx,
                                   KfTransformArrayMemoryManager *kfTransformMemoryManager ) :
         mKeyFrameRigs( 0 ),
         mNumFrames( 0 ),
         mBoneBlockIdx( boneBlockIdx ),
         mUsedSlots( 0 ),
-        mLocalMemoryManager( kfTransformMemoryManager )
+        mLocalMemoryManager( kfTransformMemoryManager ),
+        mKeyStride( 0 ),
+        mStoredChannels( 0 )
     {
     }
     //-----------------------------------------------------------------------------------
@@ -54,6 +176,7 @@ namespace Ogre
     void SkeletonTrack::addKeyFrame( Real timestamp, Real frameRate )
     {
         assert( mKeyFrameRigs.empty() || timestamp > mKeyFrameRigs.back().mFrame );
+        OGRE_ASSERT_LOW( !isCompressed() && "Can't add keyframes to a compressed track" );
 
         mKeyFrameRigs.push_back( KeyFrameRig() );
         KeyFrameRig &keyFrame = mKeyFrameRigs.back();
@@ -131,8 +254,26 @@ namespace Ogre
         ArrayVector3 *RESTRICT_ALIAS finalScale = boneTransforms[level].mScale + offset;
         ArrayQuaternion *RESTRICT_ALIAS finalRot = boneTransforms[level].mOrientation + offset;
 
-        KfTransform *RESTRICT_ALIAS prevTransf = prevFrame->mBoneTransform;
-        KfTransform *RESTRICT_ALIAS nextTransf = nextFrame->mBoneTransform;
+        const KfTransform *RESTRICT_ALIAS prevTransf = prevFrame->mBoneTransform;
+        const KfTransform *RESTRICT_ALIAS nextTransf = nextFrame->mBoneTransform;
+
+        KfTransform decompressed[2];
+        if( !prevTransf )
+        {
+            decompressKeyFrame( static_cast<size_t>( prevFrame - mKeyFrameRigs.begin() ),
+                                decompressed[0] );
+            if( nextFrame != prevFrame )
+            {
+                decompressKeyFrame( static_cast<size_t>( nextFrame - mKeyFrameRigs.begin() ),
+                                    decompressed[1] );
+            }
+            else
+            {
+                decompressed[1] = decompressed[0];
+            }
+            prevTransf = &decompressed[0];
+            nextTransf = &decompressed[1];
+        }
 
         ArrayVector3 interpPos, interpScale;
         ArrayQuaternion interpRot;
@@ -159,6 +300,7 @@ namespace Ogre
     void SkeletonTrack::_bakeUnusedSlots()
     {
         assert( mUsedSlots <= ARRAY_PACKED_REALS );
+        OGRE_ASSERT_LOW( !isCompressed() );
 
         if( mUsedSlots <= ( ARRAY_PACKED_REALS >> 1 ) )
         {
@@ -185,4 +327,303 @@ namespace Ogre
             }
         }
     }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::decompressKeyFrame( size_t keyIdx, KfTransform &outTransform ) const
+    {
+        const ArrayReal *RESTRICT_ALIAS ranges = mQuantisationRanges.get();
+        const uint16 *RESTRICT_ALIAS src =
+            mQuantisedKeys.empty() ? 0 : &mQuantisedKeys[keyIdx * mKeyStride];
+
+        if( mStoredChannels & ChannelPosition )
+        {
+            ArrayReal values[3];
+            for( size_t i = 0u; i < 3u; ++i )
+            {
+                values[i] = ranges[RangePositionMin + i] +
+                            loadQuantised( src, 0xFFFFu ) * ranges[RangePositionStep + i];
+                src += ARRAY_PACKED_REALS;
+            }
+            outTransform.mPosition = ArrayVector3( values[0], values[1], values[2] );
+        }
+        else
+        {
+            outTransform.mPosition =
+                ArrayVector3( ranges[RangePositionMin + 0u], ranges[RangePositionMin + 1u],
+                              ranges[RangePositionMin + 2u] );
+        }
+
+        if( mStoredChannels & ChannelOrientation )
+        {
+            // Index of the dropped component, stored in the top bits of the first two
+            OGRE_ALIGNED_DECL( Real, droppedIdx[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+            for( size_t i = 0u; i < ARRAY_PACKED_REALS; ++i )
+            {
+                droppedIdx[i] = static_cast<Real>( ( src[i] >> 15u ) |
+                                                   ( ( src[ARRAY_PACKED_REALS + i] >> 15u ) << 1u ) );
+            }
+            const ArrayReal largest = *reinterpret_cast<const ArrayReal *>( droppedIdx );
+
+            // [0; 32767] -> [-1 / sqrt( 2 ); 1 / sqrt( 2 )]
+            const ArrayReal scale = Mathlib::SetAll( kSqrt2 / 32767.0f );
+            const ArrayReal bias = Mathlib::SetAll( -0.5f * kSqrt2 );
+
+            ArrayReal values[3];
+            for( size_t i = 0u; i < 3u; ++i )
+            {
+                values[i] = loadQuantised( src, 0x7FFFu ) * scale + bias;
+                src += ARRAY_PACKED_REALS;
+            }
+
+            // The dropped component is the largest, thus always positive
+            ArrayReal sqLargest = Mathlib::ONE - ( values[0] * values[0] + values[1] * values[1] +
+                                                   values[2] * values[2] );
+            sqLargest = Mathlib::Max( sqLargest, Mathlib::fSqEpsilon );
+            const ArrayReal d = sqLargest * Mathlib::InvSqrtNonZero4( sqLargest );
+
+            const ArrayMaskR isW = Mathlib::CompareLess( largest, Mathlib::SetAll( 0.5f ) );
+            const ArrayMaskR upToX = Mathlib::CompareLess( largest, Mathlib::SetAll( 1.5f ) );
+            const ArrayMaskR upToY = Mathlib::CompareLess( largest, Mathlib::SetAll( 2.5f ) );
+
+            outTransform.mOrientation = ArrayQuaternion(
+                Mathlib::Cmov4( d, values[0], isW ),
+                Mathlib::Cmov4( values[0], Mathlib::Cmov4( d, values[1], upToX ), isW ),
+                Mathlib::Cmov4( values[1], Mathlib::Cmov4( d, values[2], upToY ), upToX ),
+                Mathlib::Cmov4( values[2], d, upToY ) );
+        }
+        else
+        {
+            outTransform.mOrientation =
+                ArrayQuaternion( ranges[RangeOrientation + 0u], ranges[RangeOrientation + 1u],
+                                 ranges[RangeOrientation + 2u], ranges[RangeOrientation + 3u] );
+        }
+
+        if( mStoredChannels & ChannelScale )
+        {
+            ArrayReal values[3];
+            for( size_t i = 0u; i < 3u; ++i )
+            {
+                values[i] = ranges[RangeScaleMin + i] +
+                            loadQuantised( src, 0xFFFFu ) * ranges[RangeScaleStep + i];
+                src += ARRAY_PACKED_REALS;
+            }
+            outTransform.mScale = ArrayVector3( values[0], values[1], values[2] );
+        }
+        else
+        {
+            outTransform.mScale = ArrayVector3( ranges[RangeScaleMin + 0u], ranges[RangeScaleMin + 1u],
+                                                ranges[RangeScaleMin + 2u] );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::getKeyFrameTransform( size_t keyIdx, size_t slot, Vector3 &outPos,
+                                              Quaternion &outRot, Vector3 &outScale ) const
+    {
+        KfTransform decompressed;
+        const KfTransform *transform = mKeyFrameRigs[keyIdx].mBoneTransform;
+        if( !transform )
+        {
+            decompressKeyFrame( keyIdx, decompressed );
+            transform = &decompressed;
+        }
+
+        transform->mPosition.getAsVector3( outPos, slot );
+        transform->mOrientation.getAsQuaternion( outRot, slot );
+        transform->mScale.getAsVector3( outScale, slot );
+    }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonTrack::compress( Real positionTolerance, Real orientationTolerance,
+                                  Real scaleTolerance )
+    {
+        OGRE_ASSERT_LOW( !isCompressed() && !mKeyFrameRigs.empty() );
+
+        const size_t numKeys = mKeyFrameRigs.size();
+
+        // Unpack everything to AoS. It's easier to work per slot
+        UncompressedKeyFrames keyFrames;
+        keyFrames.positionTolerance = positionTolerance;
+        keyFrames.orientationTolerance = orientationTolerance;
+        keyFrames.scaleTolerance = scaleTolerance;
+        keyFrames.frames.resize( numKeys );
+        keyFrames.positions.resize( numKeys * ARRAY_PACKED_REALS );
+        keyFrames.orientations.resize( numKeys * ARRAY_PACKED_REALS );
+        keyFrames.scales.resize( numKeys * ARRAY_PACKED_REALS );
+
+        for( size_t k = 0u; k < numKeys; ++k )
+        {
+            keyFrames.frames[k] = mKeyFrameRigs[k].mFrame;
+            for( size_t i = 0u; i < ARRAY_PACKED_REALS; ++i )
+            {
+                const size_t idx = k * ARRAY_PACKED_REALS + i;
+                getKeyFrameTransform( k, i, keyFrames.positions[idx], keyFrames.orientations[idx],
+                                      keyFrames.scales[idx] );
+                // build() stores unnormalized quaternions, but smallest-three needs unit ones
+                keyFrames.orientations[idx].normalise();
+            }
+        }
+
+        // Find which channels never change
+        bool positionConstant = true;
+        bool orientationConstant = true;
+        bool scaleConstant = true;
+        for( size_t idx = ARRAY_PACKED_REALS; idx < numKeys * ARRAY_PACKED_REALS; ++idx )
+        {
+            const size_t firstIdx = idx % ARRAY_PACKED_REALS;
+            positionConstant &=
+                keyFrames.positionMatches( keyFrames.positions[idx], keyFrames.positions[firstIdx] );
+            orientationConstant &= keyFrames.orientationMatches( keyFrames.orientations[idx],
+                                                                 keyFrames.orientations[firstIdx] );
+            scaleConstant &= keyFrames.scaleMatches( keyFrames.scales[idx], keyFrames.scales[firstIdx] );
+        }
+
+        // Keyframe reduction: Greedily keep extending the segment that starts at the last
+        // kept key while interpolation reproduces every key it skips. A constant track
+        // only needs its first key.
+        vector<size_t>::type keptKeys;
+        keptKeys.push_back( 0u );
+        if( !positionConstant || !orientationConstant || !scaleConstant )
+        {
+            size_t anchor = 0u;
+            while( anchor + 1u < numKeys )
+            {
+                size_t next = anchor + 1u;
+                while( next + 1u < numKeys && keyFrames.canInterpolate( anchor, next + 1u ) )
+                    ++next;
+                keptKeys.push_back( next );
+                anchor = next;
+            }
+        }
+
+        const size_t numKeptKeys = keptKeys.size();
+
+        KeyFrameRigVec keyFrameRigs;
+        keyFrameRigs.reserve( numKeptKeys );
+        for( size_t k = 0u; k < numKeptKeys; ++k )
+        {
+            KeyFrameRig keyFrame;
+            keyFrame.mFrame = keyFrames.frames[keptKeys[k]];
+            keyFrame.mInvNextFrameDistance = 1.0f;
+            keyFrame.mBoneTransform = 0;
+            if( k != 0u )
+            {
+                keyFrameRigs.back().mInvNextFrameDistance =
+                    1.0f / ( keyFrame.mFrame - keyFrameRigs.back().mFrame );
+            }
+            keyFrameRigs.push_back( keyFrame );
+        }
+
+        mStoredChannels = 0u;
+        if( !positionConstant )
+            mStoredChannels |= ChannelPosition;
+        if( !orientationConstant )
+            mStoredChannels |= ChannelOrientation;
+        if( !scaleConstant )
+            mStoredChannels |= ChannelScale;
+
+        size_t numComponents = 0u;
+        for( size_t i = 0u; i < 3u; ++i )
+        {
+            if( mStoredChannels & ( 1u << i ) )
+                numComponents += 3u;
+        }
+        mKeyStride = static_cast<uint16>( numComponents * ARRAY_PACKED_REALS );
+
+        // Ranges for position and scale. Constant channels just store their value
+        RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION> quantisationRanges( NumQuantisationRanges );
+        Real *RESTRICT_ALIAS ranges = reinterpret_cast<Real *>( quantisationRanges.get() );
+        memset( ranges, 0, NumQuantisationRanges * sizeof( ArrayReal ) );
+
+        for( size_t i = 0u; i < ARRAY_PACKED_REALS; ++i )
+        {
+            for( size_t c = 0u; c < 3u; ++c )
+            {
+                Real minPos = keyFrames.positions[i][c];
+                Real maxPos = minPos;
+                Real minScale = keyFrames.scales[i][c];
+                Real maxScale = minScale;
+                for( size_t k = 1u; k < numKeptKeys; ++k )
+                {
+                    const size_t idx = keptKeys[k] * ARRAY_PACKED_REALS + i;
+                    minPos = std::min( minPos, keyFrames.positions[idx][c] );
+                    maxPos = std::max( maxPos, keyFrames.positions[idx][c] );
+                    minScale = std::min( minScale, keyFrames.scales[idx][c] );
+                    maxScale = std::max( maxScale, keyFrames.scales[idx][c] );
+                }
+
+                ranges[( RangePositionMin + c ) * ARRAY_PACKED_REALS + i] = minPos;
+                ranges[( RangePositionStep + c ) * ARRAY_PACKED_REALS + i] =
+                    ( maxPos - minPos ) / 65535.0f;
+                ranges[( RangeScaleMin + c ) * ARRAY_PACKED_REALS + i] = minScale;
+                ranges[( RangeScaleStep + c ) * ARRAY_PACKED_REALS + i] =
+                    ( maxScale - minScale ) / 65535.0f;
+            }
+
+            for( size_t c = 0u; c < 4u; ++c )
+                ranges[( RangeOrientation + c ) * ARRAY_PACKED_REALS + i] = keyFrames.orientations[i][c];
+        }
+
+        vector<uint16>::type quantisedKeys( numKeptKeys * mKeyStride );
+        for( size_t k = 0u; k < numKeptKeys && mKeyStride; ++k )
+        {
+            uint16 *RESTRICT_ALIAS dst = &quantisedKeys[k * mKeyStride];
+
+            for( size_t i = 0u; i < ARRAY_PACKED_REALS; ++i )
+            {
+                const size_t idx = keptKeys[k] * ARRAY_PACKED_REALS + i;
+                size_t component = 0u;
+
+                if( mStoredChannels & ChannelPosition )
+                {
+                    for( size_t c = 0u; c < 3u; ++c )
+                    {
+                        dst[( component + c ) * ARRAY_PACKED_REALS + i] = quantiseRange(
+                            keyFrames.positions[idx][c],
+                            ranges[( RangePositionMin + c ) * ARRAY_PACKED_REALS + i],
+                            ranges[( RangePositionStep + c ) * ARRAY_PACKED_REALS + i] );
+                    }
+                    component += 3u;
+                }
+
+                if( mStoredChannels & ChannelOrientation )
+                {
+                    encodeOrientation( keyFrames.orientations[idx],
+                                       dst[( component + 0u ) * ARRAY_PACKED_REALS + i],
+                                       dst[( component + 1u ) * ARRAY_PACKED_REALS + i],
+                                       dst[( component + 2u ) * ARRAY_PACKED_REALS + i] );
+                    component += 3u;
+                }
+
+                if( mStoredChannels & ChannelScale )
+                {
+                    for( size_t c = 0u; c < 3u; ++c )
+                    {
+                        dst[( component + c ) * ARRAY_PACKED_REALS + i] = quantiseRange(
+                            keyFrames.scales[idx][c],
+                            ranges[( RangeScaleMin + c ) * ARRAY_PACKED_REALS + i],
+                            ranges[( RangeScaleStep + c ) * ARRAY_PACKED_REALS + i] );
+                    }
+                }
+            }
+        }
+
+        // The KfTransforms belong to mLocalMemoryManager, which gets destroyed by our owner
+        mKeyFrameRigs.swap( keyFrameRigs );
+        mQuantisedKeys.swap( quantisedKeys );
+        mQuantisationRanges.swap( quantisationRanges );
+        mLocalMemoryManager = 0;
+
+        bool isIdentity = mStoredChannels == 0u;
+        for( size_t i = 0u; i < ARRAY_PACKED_REALS && isIdentity; ++i )
+        {
+            isIdentity = keyFrames.positionMatches( keyFrames.positions[i], Vector3::ZERO ) &&
+                         keyFrames.orientationMatches( keyFrames.orientations[i],
+                                                       Quaternion::IDENTITY ) &&
+                         keyFrames.scaleMatches( keyFrames.scales[i], Vector3::UNIT_SCALE );
+        }
+
+        return isIdentity;
+    }
 }  // namespace Ogre
+
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#    pragma GCC diagnostic pop
+#endif
@@ -31,7 +31,9 @@ THE SOFTWARE.
 #include "CommandBuffer/OgreCbTexture.h"
 
 #include "CommandBuffer/OgreCommandBuffer.h"
+#include "OgreDescriptorSetTexture.h"
 #include "OgreRenderSystem.h"
+#include "OgreTextureGpu.h"
 
 namespace Ogre
 {
@@ -49,6 +51,8 @@ namespace Ogre
     {
         const CbTexture *cmd = static_cast<const CbTexture *>( _cmd );
         _this->mRenderSystem->_setTexture( cmd->texUnit, cmd->texture, cmd->bDepthReadOnly );
+        if( cmd->texture )
+            cmd->texture->_touch();
 
         if( cmd->samplerBlock )
         {
@@ -70,6 +74,15 @@ namespace Ogre
     {
         const CbTextures *cmd = static_cast<const CbTextures *>( _cmd );
         _this->mRenderSystem->_setTextures( cmd->texUnit, cmd->descSet, cmd->hazardousTexIdx );
+
+        FastArray<const TextureGpu *>::const_iterator itor = cmd->descSet->mTextures.begin();
+        FastArray<const TextureGpu *>::const_iterator endt = cmd->descSet->mTextures.end();
+        while( itor != endt )
+        {
+            if( *itor )
+                ( *itor )->_touch();
+            ++itor;
+        }
     }
 
     CbSamplers::CbSamplers( uint16 _texUnit, const DescriptorSetSampler *_descSet ) :
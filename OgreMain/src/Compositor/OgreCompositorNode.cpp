@@ -812,10 +812,12 @@ namespace Ogre
             const CompositorTargetDef *targetDef = passDef->getParentTargetDef();
 
             if( executionMask & passDef->mExecutionMask &&
-                ( !shadowNode || ( !shadowNode->isShadowMapIdxInValidRange( passDef->mShadowMapIdx ) ||
-                                   ( shadowNode->_shouldUpdateShadowMapIdx( passDef->mShadowMapIdx ) &&
-                                     ( shadowNode->getShadowMapLightTypeMask( passDef->mShadowMapIdx ) &
-                                       targetDef->getShadowMapSupportedLightTypes() ) ) ) ) )
+                ( !shadowNode ||
+                  ( !shadowNode->isShadowMapIdxInValidRange( passDef->mShadowMapIdx )
+                        ? shadowNode->_shouldUpdateTarget( targetDef->getRenderTargetName() )
+                        : ( shadowNode->_shouldUpdateShadowMapIdx( passDef->mShadowMapIdx ) &&
+                            ( shadowNode->getShadowMapLightTypeMask( passDef->mShadowMapIdx ) &
+                              targetDef->getShadowMapSupportedLightTypes() ) ) ) ) )
             {
                 // Make explicitly exposed textures available to materials during this pass.
                 const size_t oldNumTextures = sceneManager->getNumCompositorTextures();
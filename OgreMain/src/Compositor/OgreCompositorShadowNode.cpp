@@ -48,6 +48,10 @@ THE SOFTWARE.
 #include "OgreShadowCameraSetupPSSM.h"
 #include "OgreViewport.h"
 
+#include "Math/Array/OgreArrayAabb.h"
+#include "Math/Array/OgreArrayMatrix4.h"
+#include "Math/Array/OgreBooleanMask.h"
+
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
 #    include <intrin.h>
 #    pragma intrinsic( _BitScanForward )
@@ -77,6 +81,154 @@ namespace Ogre
 #endif
     }
 
+    /// Resolution of the grids used by CompositorShadowNode::setReceiverAwareCasterCulling
+    static const size_t c_receiverGridResolution = 32u;
+
+    /// Transforms a world AABB into light space; rot being the rotation world -> light space.
+    static inline void toLightSpace( const Matrix3 &rot, const Aabb &aabb, Vector3 &outCenter,
+                                     Vector3 &outHalfSize )
+    {
+        outCenter = rot * aabb.mCenter;
+        for( size_t i = 0u; i < 3u; ++i )
+        {
+            outHalfSize[i] = Math::Abs( rot[i][0] ) * aabb.mHalfSize.x +
+                             Math::Abs( rot[i][1] ) * aabb.mHalfSize.y +
+                             Math::Abs( rot[i][2] ) * aabb.mHalfSize.z;
+        }
+    }
+
+    /** Converts the light space range [minVal; maxVal] into the range of receiver grid cells
+        it covers, both inclusive.
+    @return
+        False if the range is entirely outside the grid.
+    */
+    static inline bool getReceiverCellRange( Real minVal, Real maxVal, Real gridOrigin,
+                                             Real invCellSize, size_t &outFirst, size_t &outLast )
+    {
+        const Real firstCell = std::floor( ( minVal - gridOrigin ) * invCellSize );
+        const Real lastCell = std::floor( ( maxVal - gridOrigin ) * invCellSize );
+
+        if( lastCell < Real( 0.0 ) || firstCell >= Real( c_receiverGridResolution ) )
+            return false;
+
+        outFirst = static_cast<size_t>( std::max( firstCell, Real( 0.0 ) ) );
+        outLast = static_cast<size_t>(
+            std::min( lastCell, Real( c_receiverGridResolution - 1u ) ) );
+        return true;
+    }
+
+    /// FNV-1a
+    static inline uint64 hashCastersSignature( uint64 hash, const void *data, size_t sizeBytes )
+    {
+        const uint8 *bytes = reinterpret_cast<const uint8 *>( data );
+        for( size_t i = 0; i < sizeBytes; ++i )
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /** Hashes the world AABBs of all shadow casters whose light space projection overlaps the
+        given window. Any caster that gets added, removed or moved in or out of the window changes
+        the signature. Casters with a skeleton are assumed to change every frame.
+    @param lightView
+        Rotation from world space to light space.
+    @param windowCenter
+        Center of the window in light space. Z is ignored.
+    @param windowHalfSize
+        Half size of the window in light space. Z is ignored.
+    */
+    static uint64 calculateCastersSignature( SceneManager *sceneManager, uint32 visibilityMask,
+                                             uint8 firstRq, uint8 lastRq, const Matrix4 &lightView,
+                                             const Vector2 &windowCenter,
+                                             const Vector2 &windowHalfSize, size_t frameCount )
+    {
+        uint64 retVal = 14695981039346656037ull;
+
+        const ArrayMatrix4 arrayLightView = ArrayMatrix4::createAllFromMatrix4( lightView );
+        ArrayAabb window( ArrayVector3::ZERO, ArrayVector3::ZERO );
+        window.setAll( Aabb( Vector3( windowCenter.x, windowCenter.y, 0.0f ),
+                             Vector3( windowHalfSize.x, windowHalfSize.y,
+                                      std::numeric_limits<Real>::infinity() ) ) );
+
+        // Same criteria as SceneManager::_calculateCurrentCastersBox
+        const uint32 sceneVisibilityFlags =
+            ( visibilityMask & sceneManager->getVisibilityMask() ) |
+            ( visibilityMask & ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS );
+        const ArrayInt sceneFlags = Mathlib::SetAll( sceneVisibilityFlags );
+        const ArrayInt layerVisibility = Mathlib::SetAll( VisibilityFlags::LAYER_VISIBILITY );
+        const ArrayInt layerShadowCaster = Mathlib::SetAll( VisibilityFlags::LAYER_SHADOW_CASTER );
+
+        for( size_t i = 0; i < NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+        {
+            ObjectMemoryManager &memoryManager =
+                sceneManager->_getEntityMemoryManager( static_cast<SceneMemoryMgrTypes>( i ) );
+
+            const size_t numRenderQueues = memoryManager.getNumRenderQueues();
+            const size_t firstRqClamped = std::min<size_t>( firstRq, numRenderQueues );
+            const size_t lastRqClamped = std::min<size_t>( lastRq, numRenderQueues );
+
+            for( size_t j = firstRqClamped; j < lastRqClamped; ++j )
+            {
+                ObjectData objData;
+                const size_t totalObjs = memoryManager.getFirstObjectData( objData, j );
+
+                for( size_t k = 0; k < totalObjs; k += ARRAY_PACKED_REALS )
+                {
+                    ArrayInt *RESTRICT_ALIAS visibilityFlags =
+                        reinterpret_cast<ArrayInt * RESTRICT_ALIAS>( objData.mVisibilityFlags );
+
+                    ArrayAabb lightSpaceAabb = *objData.mWorldAabb;
+                    lightSpaceAabb.transformAffine( arrayLightView );
+
+                    // Ignore casters with infinite boxes
+                    const ArrayMaskR infMask = Mathlib::Or(
+                        Mathlib::Or(
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[0] ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) ),
+                        Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ) );
+
+                    const ArrayMaskI isVisible =
+                        Mathlib::TestFlags4( *visibilityFlags, layerVisibility );
+                    ArrayMaskI casterMask =
+                        Mathlib::TestFlags4( Mathlib::And( sceneFlags, *visibilityFlags ),
+                                             Mathlib::AndNot( isVisible, CastRealToInt( infMask ) ) );
+                    casterMask = Mathlib::And(
+                        casterMask, Mathlib::TestFlags4( *visibilityFlags, layerShadowCaster ) );
+                    casterMask =
+                        Mathlib::And( casterMask, CastRealToInt( window.intersects( lightSpaceAabb ) ) );
+
+                    const uint32 scalarMask = BooleanMask4::getScalarMask( casterMask );
+
+                    for( size_t l = 0; l < ARRAY_PACKED_REALS; ++l )
+                    {
+                        // There's no need to check objData.mOwner[l] is null because
+                        // we set mVisibilityFlags to 0 on slot removals
+                        if( IS_BIT_SET( l, scalarMask ) )
+                        {
+                            const MovableObject *owner = objData.mOwner[l];
+                            Aabb worldAabb;
+                            objData.mWorldAabb->getAsAabb( worldAabb, l );
+
+                            retVal = hashCastersSignature( retVal, &owner, sizeof( owner ) );
+                            retVal = hashCastersSignature( retVal, &worldAabb, sizeof( worldAabb ) );
+                            if( owner->getSkeletonInstance() )
+                            {
+                                retVal =
+                                    hashCastersSignature( retVal, &frameCount, sizeof( frameCount ) );
+                            }
+                        }
+                    }
+
+                    objData.advancePack();
+                }
+            }
+        }
+
+        return retVal;
+    }
+
     CompositorShadowNode::CompositorShadowNode( IdType id, const CompositorShadowNodeDef *definition,
                                                 CompositorWorkspace *workspace, RenderSystem *renderSys,
                                                 TextureGpu *finalTarget ) :
@@ -84,7 +236,10 @@ namespace Ogre
         mDefinition( definition ),
         mLastCamera( 0 ),
         mLastFrame( std::numeric_limits<size_t>::max() ),
-        mNumActiveShadowMapCastingLights( 0 )
+        mNumActiveShadowMapCastingLights( 0 ),
+        mNumCachedShadowMapsReused( 0u ),
+        mNumCachedShadowMapsRendered( 0u ),
+        mReceiverAwareCasterCulling( false )
     {
         mShadowMapCameras.reserve( definition->mShadowMapTexDefinitions.size() );
         mLocalTextures.reserve( mLocalTextures.size() + definition->mShadowMapTexDefinitions.size() );
@@ -132,6 +287,24 @@ namespace Ogre
             shadowMapCamera.maxDistance = 100000.0f;
             for( size_t i = 0; i < Light::NUM_LIGHT_TYPES; ++i )
                 shadowMapCamera.scenePassesViewportSize[i] = -Vector2::UNIT_SCALE;
+            shadowMapCamera.cachingEnabled = false;
+            shadowMapCamera.cacheValid = false;
+            shadowMapCamera.reuseCachedContents = false;
+            shadowMapCamera.cacheGuardBand = 0.1f;
+            shadowMapCamera.cacheMaxStaleFrames = 0u;
+            shadowMapCamera.cacheStaleFrames = 0u;
+            shadowMapCamera.cachedCastersSignature = 0u;
+            shadowMapCamera.cachedLight = 0;
+            shadowMapCamera.cachedViewer = 0;
+            shadowMapCamera.cachedOrientation = Quaternion::IDENTITY;
+            shadowMapCamera.cachedPosition = Vector3::ZERO;
+            shadowMapCamera.cachedOrthoSize = Vector2::ZERO;
+            shadowMapCamera.cachedNear = 0.0f;
+            shadowMapCamera.cachedFar = 0.0f;
+            shadowMapCamera.receiverCullingActive = false;
+            shadowMapCamera.receiverLightRot = Matrix3::IDENTITY;
+            shadowMapCamera.receiverGridOrigin = Vector2::ZERO;
+            shadowMapCamera.receiverGridInvCellSize = Vector2::ZERO;
 
             {
                 // Find out the index to our texture in both mLocalTextures & mContiguousShadowMapTex
@@ -217,6 +390,10 @@ namespace Ogre
         createPasses();
 
         mShadowMapCastingLights.resize( mDefinition->mNumLights );
+
+        CasterCullingStats emptyStats;
+        memset( &emptyStats, 0, sizeof( emptyStats ) );
+        mCasterCullingStats.resize( sceneManager->getNumWorkerThreads(), emptyStats );
     }
     //-----------------------------------------------------------------------------------
     CompositorShadowNode::~CompositorShadowNode()
@@ -540,6 +717,328 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    bool CompositorShadowNode::updateCachedShadowCamera( ShadowMapCamera &shadowMapCamera,
+                                                         const Light *light, const Camera *viewer,
+                                                         const Vector2 &viewportRealSize )
+    {
+        Camera *texCamera = shadowMapCamera.camera;
+        const Real guardBand = shadowMapCamera.cacheGuardBand;
+
+        const Quaternion orientation = texCamera->getOrientation();
+        const Quaternion invOrientation = orientation.Inverse();
+
+        // What the shadow camera setup asked for, in light space
+        const Vector2 neededSize( texCamera->getOrthoWindowWidth(), texCamera->getOrthoWindowHeight() );
+        const Vector3 neededPos = invOrientation * texCamera->getPosition();
+        const Real neededNear = texCamera->getNearClipDistance();
+        const Real neededFar = texCamera->getFarClipDistance();
+
+        if( shadowMapCamera.cacheValid && shadowMapCamera.cachedLight == light &&
+            shadowMapCamera.cachedViewer == viewer && shadowMapCamera.cachedOrientation == orientation )
+        {
+            const Vector3 cachedPos = invOrientation * shadowMapCamera.cachedPosition;
+            const Vector2 cachedSize = shadowMapCamera.cachedOrthoSize;
+
+            const bool containsXY =
+                Math::Abs( neededPos.x - cachedPos.x ) + neededSize.x * 0.5f <= cachedSize.x * 0.5f &&
+                Math::Abs( neededPos.y - cachedPos.y ) + neededSize.y * 0.5f <= cachedSize.y * 0.5f;
+            // Cameras look towards -Z
+            const bool containsZ = neededPos.z - neededFar >= cachedPos.z - shadowMapCamera.cachedFar &&
+                                   neededPos.z - neededNear <= cachedPos.z - shadowMapCamera.cachedNear;
+            // Don't keep a window that became far bigger than what is needed (e.g. the casters
+            // got closer together), as it's wasting resolution.
+            const Real maxGrowth = Math::Sqr( Real( 1.0 ) + Real( 2.0 ) * guardBand );
+            const bool resolutionOk =
+                cachedSize.x <= neededSize.x * maxGrowth && cachedSize.y <= neededSize.y * maxGrowth;
+
+            if( containsXY && containsZ && resolutionOk )
+            {
+                texCamera->setPosition( shadowMapCamera.cachedPosition );
+                texCamera->setOrthoWindow( cachedSize.x, cachedSize.y );
+                texCamera->setNearClipDistance( shadowMapCamera.cachedNear );
+                texCamera->setFarClipDistance( shadowMapCamera.cachedFar );
+                shadowMapCamera.minDistance = shadowMapCamera.cachedNear;
+                shadowMapCamera.maxDistance = shadowMapCamera.cachedFar;
+                return true;
+            }
+        }
+
+        // The cached window can't be used. Enlarge the new one by the guard band so
+        // that it takes a while until the camera moves out of it again.
+        const Real depthRange = neededFar - neededNear;
+
+        const Vector2 newSize = neededSize * ( Real( 1.0 ) + Real( 2.0 ) * guardBand );
+        Vector3 newPos = neededPos;
+        newPos.z += guardBand * depthRange;
+        const Real newFar = neededFar + Real( 2.0 ) * guardBand * depthRange;
+
+        if( guardBand > Real( 0.0 ) && viewportRealSize.x > Real( 0.0 ) &&
+            viewportRealSize.y > Real( 0.0 ) )
+        {
+            // Snap to the new texel size to prevent jittering every time the window is moved
+            const Real texelSizeX = newSize.x / viewportRealSize.x;
+            const Real texelSizeY = newSize.y / viewportRealSize.y;
+            newPos.x = std::floor( newPos.x / texelSizeX ) * texelSizeX;
+            newPos.y = std::floor( newPos.y / texelSizeY ) * texelSizeY;
+        }
+
+        texCamera->setPosition( orientation * newPos );
+        texCamera->setOrthoWindow( newSize.x, newSize.y );
+        texCamera->setFarClipDistance( newFar );
+        shadowMapCamera.minDistance = neededNear;
+        shadowMapCamera.maxDistance = newFar;
+
+        shadowMapCamera.cacheValid = true;
+        shadowMapCamera.cachedLight = light;
+        shadowMapCamera.cachedViewer = viewer;
+        shadowMapCamera.cachedOrientation = orientation;
+        shadowMapCamera.cachedPosition = texCamera->getPosition();
+        shadowMapCamera.cachedOrthoSize = newSize;
+        shadowMapCamera.cachedNear = neededNear;
+        shadowMapCamera.cachedFar = newFar;
+
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::resolveCachedShadowMaps( const FastArray<bool> &coversCachedWindow,
+                                                        SceneManager *sceneManager,
+                                                        const Camera *viewer )
+    {
+        const size_t numShadowMaps = mShadowMapCameras.size();
+        const size_t frameCount = mWorkspace->getFrameCount();
+        const uint32 visibilityMask = viewer->getLastViewport()->getVisibilityMask();
+
+        FastArray<uint64> castersSignatures;
+        castersSignatures.resize( numShadowMaps, 0u );
+
+        for( size_t i = 0u; i < numShadowMaps; ++i )
+        {
+            // cacheValid was cleared in _update if this shadow map can't be cached this time
+            ShadowMapCamera &shadowMapCamera = mShadowMapCameras[i];
+            if( !shadowMapCamera.cachingEnabled || !shadowMapCamera.cacheValid )
+                continue;
+
+            Matrix4 lightView;
+            lightView.makeTransform( Vector3::ZERO, Vector3::UNIT_SCALE,
+                                     shadowMapCamera.cachedOrientation.Inverse() );
+            const Vector3 windowCenter =
+                shadowMapCamera.cachedOrientation.Inverse() * shadowMapCamera.cachedPosition;
+
+            castersSignatures[i] = calculateCastersSignature(
+                sceneManager, visibilityMask, (uint8)mDefinition->mMinRq, (uint8)mDefinition->mMaxRq,
+                lightView, Vector2( windowCenter.x, windowCenter.y ),
+                shadowMapCamera.cachedOrthoSize * 0.5f, frameCount );
+
+            if( coversCachedWindow[i] &&
+                ( castersSignatures[i] == shadowMapCamera.cachedCastersSignature ||
+                  shadowMapCamera.cacheStaleFrames < shadowMapCamera.cacheMaxStaleFrames ) )
+            {
+                shadowMapCamera.reuseCachedContents = true;
+                if( castersSignatures[i] != shadowMapCamera.cachedCastersSignature )
+                    ++shadowMapCamera.cacheStaleFrames;
+            }
+            else
+            {
+                shadowMapCamera.cachedCastersSignature = castersSignatures[i];
+                shadowMapCamera.cacheStaleFrames = 0u;
+            }
+        }
+
+        // Shadow maps sharing the same texture (e.g. an atlas) get cleared together. If any of
+        // them gets rendered, we can't keep the contents of the others.
+        for( size_t i = 0u; i < numShadowMaps; ++i )
+        {
+            ShadowMapCamera &shadowMapCamera = mShadowMapCameras[i];
+            if( !shadowMapCamera.reuseCachedContents )
+                continue;
+
+            const IdString textureName = mDefinition->mShadowMapTexDefinitions[i].getTextureName();
+
+            for( size_t j = 0u; j < numShadowMaps && shadowMapCamera.reuseCachedContents; ++j )
+            {
+                if( i != j &&
+                    mDefinition->mShadowMapTexDefinitions[j].getTextureName() == textureName &&
+                    _shouldUpdateShadowMapIdx( static_cast<uint32>( j ) ) )
+                {
+                    shadowMapCamera.reuseCachedContents = false;
+                    shadowMapCamera.cachedCastersSignature = castersSignatures[i];
+                    shadowMapCamera.cacheStaleFrames = 0u;
+                }
+            }
+        }
+
+        for( size_t i = 0u; i < numShadowMaps; ++i )
+        {
+            if( !mShadowMapCameras[i].cachingEnabled || !mShadowMapCameras[i].cacheValid )
+                continue;
+
+            if( mShadowMapCameras[i].reuseCachedContents )
+            {
+                ++mNumCachedShadowMapsReused;
+
+                const IdString textureName =
+                    mDefinition->mShadowMapTexDefinitions[i].getTextureName();
+                if( std::find( mReusedShadowMapTextures.begin(), mReusedShadowMapTextures.end(),
+                               textureName ) == mReusedShadowMapTextures.end() )
+                {
+                    mReusedShadowMapTextures.push_back( textureName );
+                }
+            }
+            else if( _shouldUpdateShadowMapIdx( static_cast<uint32>( i ) ) )
+            {
+                ++mNumCachedShadowMapsRendered;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool CompositorShadowNode::collectShadowReceivers( Camera *camera, SceneManager *sceneManager )
+    {
+        mShadowReceivers.clear();
+
+        // Same criteria as SceneManager::cullFrustum
+        const uint32 viewportVisibilityMask = camera->getLastViewport()->getVisibilityMask();
+        const uint32 sceneVisibilityFlags =
+            ( ( viewportVisibilityMask & sceneManager->getVisibilityMask() ) |
+              ( viewportVisibilityMask & ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS ) ) &
+            VisibilityFlags::RESERVED_VISIBILITY_FLAGS;
+        const ArrayInt sceneFlags = Mathlib::SetAll( sceneVisibilityFlags );
+        const ArrayInt layerVisibility = Mathlib::SetAll( VisibilityFlags::LAYER_VISIBILITY );
+
+        ArrayPlane planes[6];
+        const Plane *frustumPlanes = camera->getFrustumPlanes();
+        for( size_t i = 0; i < 6; ++i )
+        {
+            planes[i].planeNormal.setAll( frustumPlanes[i].normal );
+            planes[i].signFlip.setAll( frustumPlanes[i].normal );
+            planes[i].signFlip.setToSign();
+            planes[i].planeNegD = Mathlib::SetAll( -frustumPlanes[i].d );
+        }
+
+        for( size_t i = 0; i < NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+        {
+            ObjectMemoryManager &memoryManager =
+                sceneManager->_getEntityMemoryManager( static_cast<SceneMemoryMgrTypes>( i ) );
+
+            const size_t numRenderQueues = memoryManager.getNumRenderQueues();
+
+            for( size_t j = 0; j < numRenderQueues; ++j )
+            {
+                ObjectData objData;
+                const size_t totalObjs = memoryManager.getFirstObjectData( objData, j );
+
+                for( size_t k = 0; k < totalObjs; k += ARRAY_PACKED_REALS )
+                {
+                    ArrayInt *RESTRICT_ALIAS visibilityFlags =
+                        reinterpret_cast<ArrayInt * RESTRICT_ALIAS>( objData.mVisibilityFlags );
+
+                    ArrayMaskR mask = CastIntToReal( Mathlib::SetAll( 0xffffffff ) );
+                    for( size_t l = 0; l < 6; ++l )
+                    {
+                        const ArrayVector3 centerPlusFlippedHS =
+                            objData.mWorldAabb->mCenter +
+                            objData.mWorldAabb->mHalfSize * planes[l].signFlip;
+                        const ArrayReal dotResult =
+                            planes[l].planeNormal.dotProduct( centerPlusFlippedHS );
+                        mask = Mathlib::And( mask,
+                                             Mathlib::CompareGreater( dotResult, planes[l].planeNegD ) );
+                    }
+
+                    // Infinite boxes always pass (the dot products above may have produced NaNs)
+                    const ArrayMaskR infMask = Mathlib::Or(
+                        Mathlib::Or(
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[0] ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) ),
+                        Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ) );
+                    mask = Mathlib::Or( mask, infMask );
+
+                    ArrayMaskI finalMask = Mathlib::TestFlags4(
+                        CastRealToInt( mask ), Mathlib::And( sceneFlags, *visibilityFlags ) );
+                    finalMask = Mathlib::And(
+                        finalMask, Mathlib::TestFlags4( *visibilityFlags, layerVisibility ) );
+
+                    const uint32 scalarMask = BooleanMask4::getScalarMask( finalMask );
+                    const uint32 scalarInfMask = BooleanMask4::getScalarMask( infMask );
+
+                    for( size_t l = 0; l < ARRAY_PACKED_REALS; ++l )
+                    {
+                        // Objects that render nothing (e.g. Cameras, which have infinite
+                        // boxes) can't receive shadows
+                        if( IS_BIT_SET( l, scalarMask ) && !objData.mOwner[l]->mRenderables.empty() )
+                        {
+                            // A visible receiver of infinite size can be shadowed by anything
+                            if( IS_BIT_SET( l, scalarInfMask ) )
+                                return false;
+
+                            Aabb aabb;
+                            objData.mWorldAabb->getAsAabb( aabb, l );
+                            mShadowReceivers.push_back( aabb );
+                        }
+                    }
+
+                    objData.advancePack();
+                }
+            }
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::buildReceiverGrid( ShadowMapCamera &shadowMapCamera )
+    {
+        const Camera *texCamera = shadowMapCamera.camera;
+
+        const Vector2 windowSize( texCamera->getOrthoWindowWidth(), texCamera->getOrthoWindowHeight() );
+        if( windowSize.x <= Real( 0.0 ) || windowSize.y <= Real( 0.0 ) )
+            return;
+
+        const Quaternion invOrientation = texCamera->getOrientation().Inverse();
+        invOrientation.ToRotationMatrix( shadowMapCamera.receiverLightRot );
+
+        const Vector3 lightSpacePos = invOrientation * texCamera->getPosition();
+        shadowMapCamera.receiverGridOrigin =
+            Vector2( lightSpacePos.x, lightSpacePos.y ) - windowSize * 0.5f;
+        shadowMapCamera.receiverGridInvCellSize = Real( c_receiverGridResolution ) / windowSize;
+
+        const Matrix3 &lightRot = shadowMapCamera.receiverLightRot;
+        const Vector2 gridOrigin = shadowMapCamera.receiverGridOrigin;
+        const Vector2 invCellSize = shadowMapCamera.receiverGridInvCellSize;
+
+        FastArray<Real> &receiverMaxDepth = shadowMapCamera.receiverMaxDepth;
+        receiverMaxDepth.clear();
+        receiverMaxDepth.resize( c_receiverGridResolution * c_receiverGridResolution,
+                                 -std::numeric_limits<Real>::max() );
+
+        FastArray<Aabb>::const_iterator itor = mShadowReceivers.begin();
+        FastArray<Aabb>::const_iterator endt = mShadowReceivers.end();
+
+        while( itor != endt )
+        {
+            Vector3 center, halfSize;
+            toLightSpace( lightRot, *itor, center, halfSize );
+
+            size_t firstX, lastX, firstY, lastY;
+            if( getReceiverCellRange( center.x - halfSize.x, center.x + halfSize.x, gridOrigin.x,
+                                      invCellSize.x, firstX, lastX ) &&
+                getReceiverCellRange( center.y - halfSize.y, center.y + halfSize.y, gridOrigin.y,
+                                      invCellSize.y, firstY, lastY ) )
+            {
+                // The light looks towards -Z. Depth grows away from the light
+                const Real farthestDepth = halfSize.z - center.z;
+
+                for( size_t y = firstY; y <= lastY; ++y )
+                {
+                    Real *RESTRICT_ALIAS row = &receiverMaxDepth[y * c_receiverGridResolution];
+                    for( size_t x = firstX; x <= lastX; ++x )
+                        row[x] = std::max( row[x], farthestDepth );
+                }
+            }
+
+            ++itor;
+        }
+
+        shadowMapCamera.receiverCullingActive = true;
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorShadowNode::_update( Camera *camera, const Camera *lodCamera,
                                         SceneManager *sceneManager )
     {
@@ -547,6 +1046,14 @@ namespace Ogre
 
         buildClosestLightList( camera, lodCamera );
 
+        mReusedShadowMapTextures.clear();
+        mNumCachedShadowMapsReused = 0u;
+        mNumCachedShadowMapsRendered = 0u;
+
+        bool anyCachedShadowMap = false;
+        FastArray<bool> coversCachedWindow;
+        coversCachedWindow.resize( mShadowMapCameras.size(), false );
+
         // Setup all the cameras
         CompositorShadowNodeDef::ShadowMapTexDefVec::const_iterator itor =
             mDefinition->mShadowMapTexDefinitions.begin();
@@ -557,6 +1064,8 @@ namespace Ogre
         {
             Light const *light = mShadowMapCastingLights[itor->light].light;
 
+            itShadowCamera->reuseCachedContents = false;
+
             if( light )
             {
                 Camera *texCamera = itShadowCamera->camera;
@@ -615,6 +1124,24 @@ namespace Ogre
                 itShadowCamera->minDistance = itShadowCamera->shadowCameraSetup->getMinDistance();
                 itShadowCamera->maxDistance = itShadowCamera->shadowCameraSetup->getMaxDistance();
 
+                if( itShadowCamera->cachingEnabled )
+                {
+                    if( light->getType() == Light::LT_DIRECTIONAL &&
+                        texCamera->getProjectionType() == PT_ORTHOGRAPHIC &&
+                        !mShadowMapCastingLights[itor->light].isStatic )
+                    {
+                        const size_t shadowMapIdx =
+                            static_cast<size_t>( itor - mDefinition->mShadowMapTexDefinitions.begin() );
+                        coversCachedWindow[shadowMapIdx] =
+                            updateCachedShadowCamera( *itShadowCamera, light, camera, vpRealSize );
+                        anyCachedShadowMap = true;
+                    }
+                    else
+                    {
+                        itShadowCamera->cacheValid = false;
+                    }
+                }
+
                 float fAutoConstantBiasScale = 1.0f;
                 if( itor->autoConstantBiasScale != 0.0f )
                 {
@@ -632,13 +1159,54 @@ namespace Ogre
                 texCamera->_setNeedsDepthClamp( light->getType() == Light::LT_DIRECTIONAL &&
                                                 caps->hasCapability( RSC_DEPTH_CLAMP ) );
             }
-            // Else... this shadow map shouldn't be rendered and when used, return a blank one.
-            // The Nth closest lights don't cast shadows
+            else
+            {
+                // Else... this shadow map shouldn't be rendered and when used, return a blank one.
+                // The Nth closest lights don't cast shadows
+                itShadowCamera->cacheValid = false;
+            }
 
             ++itShadowCamera;
             ++itor;
         }
 
+        if( anyCachedShadowMap )
+            resolveCachedShadowMaps( coversCachedWindow, sceneManager, camera );
+
+        {
+            FastArray<CasterCullingStats>::iterator itStats = mCasterCullingStats.begin();
+            FastArray<CasterCullingStats>::iterator enStats = mCasterCullingStats.end();
+            while( itStats != enStats )
+            {
+                itStats->numTested = 0u;
+                itStats->numCulled = 0u;
+                ++itStats;
+            }
+
+            const bool receiversCollected =
+                mReceiverAwareCasterCulling && collectShadowReceivers( camera, sceneManager );
+
+            for( size_t i = 0u; i < mShadowMapCameras.size(); ++i )
+            {
+                ShadowMapCamera &shadowMapCamera = mShadowMapCameras[i];
+                shadowMapCamera.receiverCullingActive = false;
+
+                // Static and cached shadow maps are reused in later frames, when the receivers
+                // visible now may no longer be the only ones. Never cull their casters.
+                const ShadowTextureDefinition &shadowTexDef =
+                    mDefinition->mShadowMapTexDefinitions[i];
+                const Light *light = getLightAssociatedWith( i );
+                if( receiversCollected && light && light->getType() == Light::LT_DIRECTIONAL &&
+                    shadowMapCamera.camera->getProjectionType() == PT_ORTHOGRAPHIC &&
+                    !mShadowMapCastingLights[shadowTexDef.light].isStatic &&
+                    !shadowMapCamera.cachingEnabled &&
+                    _shouldUpdateShadowMapIdx( static_cast<uint32>( i ) ) )
+                {
+                    buildReceiverGrid( shadowMapCamera );
+                }
+            }
+        }
+
         SceneManager::IlluminationRenderStage previous = sceneManager->_getCurrentRenderStage();
         sceneManager->_setCurrentRenderStage( SceneManager::IRS_RENDER_TO_TEXTURE );
 
@@ -733,7 +1301,8 @@ namespace Ogre
 
             if( !mShadowMapCastingLights[shadowTexDef.light].light ||
                 ( mShadowMapCastingLights[shadowTexDef.light].isStatic &&
-                  !mShadowMapCastingLights[shadowTexDef.light].isDirty ) )
+                  !mShadowMapCastingLights[shadowTexDef.light].isDirty ) ||
+                mShadowMapCameras[shadowMapIdx].reuseCachedContents )
             {
                 retVal = false;
             }
@@ -742,6 +1311,12 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
+    bool CompositorShadowNode::_shouldUpdateTarget( IdString textureName ) const
+    {
+        return std::find( mReusedShadowMapTextures.begin(), mReusedShadowMapTextures.end(),
+                          textureName ) == mReusedShadowMapTextures.end();
+    }
+    //-----------------------------------------------------------------------------------
     uint8 CompositorShadowNode::getShadowMapLightTypeMask( uint32 shadowMapIdx ) const
     {
         const ShadowTextureDefinition &shadowTexDef =
@@ -949,10 +1524,187 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::_cullCastersByReceivers( const Camera *shadowCamera,
+                                                        FastArray<MovableObject *> &casters,
+                                                        size_t firstIdx, size_t threadIdx ) const
+    {
+        if( !mReceiverAwareCasterCulling )
+            return;
+
+        ShadowMapCameraVec::const_iterator itShadowCamera = mShadowMapCameras.begin();
+        ShadowMapCameraVec::const_iterator enShadowCamera = mShadowMapCameras.end();
+
+        while( itShadowCamera != enShadowCamera && itShadowCamera->camera != shadowCamera )
+            ++itShadowCamera;
+
+        if( itShadowCamera == enShadowCamera || !itShadowCamera->receiverCullingActive )
+            return;
+
+        OGRE_ASSERT_LOW( threadIdx < mCasterCullingStats.size() );
+        CasterCullingStats &stats = mCasterCullingStats[threadIdx];
+
+        const Matrix3 &lightRot = itShadowCamera->receiverLightRot;
+        const Vector2 gridOrigin = itShadowCamera->receiverGridOrigin;
+        const Vector2 invCellSize = itShadowCamera->receiverGridInvCellSize;
+        const FastArray<Real> &receiverMaxDepth = itShadowCamera->receiverMaxDepth;
+
+        size_t numKept = firstIdx;
+        size_t numNotRendered = 0u;
+        const size_t numCasters = casters.size();
+
+        for( size_t i = firstIdx; i < numCasters; ++i )
+        {
+            MovableObject *caster = casters[i];
+
+            // Objects that render nothing (e.g. Cameras) aren't casters. Leave them alone
+            if( caster->mRenderables.empty() )
+            {
+                casters[numKept++] = caster;
+                ++numNotRendered;
+                continue;
+            }
+
+            const Aabb aabb = caster->getWorldAabb();
+
+            // Never cull casters with infinite boxes
+            const Real maxHalfSize =
+                std::max( std::max( aabb.mHalfSize.x, aabb.mHalfSize.y ), aabb.mHalfSize.z );
+
+            bool castsOnReceiver = true;
+            if( maxHalfSize < std::numeric_limits<Real>::infinity() )
+            {
+                Vector3 center, halfSize;
+                toLightSpace( lightRot, aabb, center, halfSize );
+
+                // The caster's shadow extends from its closest point to the light, away from it.
+                // It is only needed if a receiver lies behind that point.
+                const Real nearestDepth = -( center.z + halfSize.z );
+
+                castsOnReceiver = false;
+                size_t firstX, lastX, firstY, lastY;
+                if( getReceiverCellRange( center.x - halfSize.x, center.x + halfSize.x,
+                                          gridOrigin.x, invCellSize.x, firstX, lastX ) &&
+                    getReceiverCellRange( center.y - halfSize.y, center.y + halfSize.y,
+                                          gridOrigin.y, invCellSize.y, firstY, lastY ) )
+                {
+                    for( size_t y = firstY; y <= lastY && !castsOnReceiver; ++y )
+                    {
+                        const Real *RESTRICT_ALIAS row =
+                            &receiverMaxDepth[y * c_receiverGridResolution];
+                        for( size_t x = firstX; x <= lastX && !castsOnReceiver; ++x )
+                            castsOnReceiver = row[x] >= nearestDepth;
+                    }
+                }
+            }
+
+            if( castsOnReceiver )
+                casters[numKept++] = caster;
+        }
+
+        stats.numTested += static_cast<uint32>( numCasters - firstIdx - numNotRendered );
+        stats.numCulled += static_cast<uint32>( numCasters - numKept );
+
+        casters.resizePOD( numKept );
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::setReceiverAwareCasterCulling( bool bEnable )
+    {
+        mReceiverAwareCasterCulling = bEnable;
+        if( !bEnable )
+        {
+            mShadowReceivers.destroy();
+
+            ShadowMapCameraVec::iterator itor = mShadowMapCameras.begin();
+            ShadowMapCameraVec::iterator endt = mShadowMapCameras.end();
+
+            while( itor != endt )
+            {
+                itor->receiverCullingActive = false;
+                itor->receiverMaxDepth.destroy();
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 CompositorShadowNode::getNumCastersTestedByReceivers() const
+    {
+        uint32 retVal = 0u;
+        FastArray<CasterCullingStats>::const_iterator itor = mCasterCullingStats.begin();
+        FastArray<CasterCullingStats>::const_iterator endt = mCasterCullingStats.end();
+        while( itor != endt )
+        {
+            retVal += itor->numTested;
+            ++itor;
+        }
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 CompositorShadowNode::getNumCastersCulledByReceivers() const
+    {
+        uint32 retVal = 0u;
+        FastArray<CasterCullingStats>::const_iterator itor = mCasterCullingStats.begin();
+        FastArray<CasterCullingStats>::const_iterator endt = mCasterCullingStats.end();
+        while( itor != endt )
+        {
+            retVal += itor->numCulled;
+            ++itor;
+        }
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::setShadowMapCaching( size_t shadowMapIdx, bool bEnable, Real guardBand,
+                                                    uint32 maxStaleFrames )
+    {
+        OGRE_ASSERT_LOW( shadowMapIdx < mShadowMapCameras.size() );
+        OGRE_ASSERT_LOW( guardBand >= Real( 0.0 ) );
+
+        ShadowMapCamera &shadowMapCamera = mShadowMapCameras[shadowMapIdx];
+
+        if( bEnable && mLocalTextures[shadowMapCamera.idxToLocalTextures]->isDiscardableContent() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Shadow map " + StringConverter::toString( shadowMapIdx ) +
+                             " can't be cached because its texture '" +
+                             mLocalTextures[shadowMapCamera.idxToLocalTextures]->getNameStr() +
+                             "' has DiscardableContent. Use keep_content in the compositor "
+                             "script or clear TextureFlags::DiscardableContent from its "
+                             "definition.",
+                         "CompositorShadowNode::setShadowMapCaching" );
+        }
+
+        shadowMapCamera.cachingEnabled = bEnable;
+        shadowMapCamera.cacheValid = false;
+        shadowMapCamera.reuseCachedContents = false;
+        shadowMapCamera.cacheGuardBand = guardBand;
+        shadowMapCamera.cacheMaxStaleFrames = maxStaleFrames;
+        shadowMapCamera.cacheStaleFrames = 0u;
+    }
+    //-----------------------------------------------------------------------------------
+    bool CompositorShadowNode::isShadowMapCached( size_t shadowMapIdx ) const
+    {
+        OGRE_ASSERT_LOW( shadowMapIdx < mShadowMapCameras.size() );
+        return mShadowMapCameras[shadowMapIdx].cachingEnabled;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::invalidateCachedShadowMaps()
+    {
+        ShadowMapCameraVec::iterator itor = mShadowMapCameras.begin();
+        ShadowMapCameraVec::iterator endt = mShadowMapCameras.end();
+
+        while( itor != endt )
+        {
+            itor->cacheValid = false;
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorShadowNode::finalTargetResized01( const TextureGpu *finalTarget )
     {
         CompositorNode::finalTargetResized01( finalTarget );
 
+        // The textures may have been recreated
+        invalidateCachedShadowMaps();
+
         mContiguousShadowMapTex.clear();
 
         CompositorShadowNodeDef::ShadowMapTexDefVec::const_iterator itDef =
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "Compositor/OgreCompositorShadowNode.h"
 #include "Compositor/OgreCompositorWorkspace.h"
 #include "Compositor/OgreCompositorWorkspaceListener.h"
+#include "Compute/OgreComputeSkinning.h"
 #include "OgreCamera.h"
 #include "OgreHlms.h"
 #include "OgreHlmsManager.h"
@@ -185,6 +186,11 @@ namespace Ogre
 
         SceneManager *sceneManager = mCamera->getSceneManager();
 
+        // Skins once per frame; every later pass reuses the same skinned vertices.
+        // Must happen before setRenderPassDescToCurrent, as it closes any open render pass.
+        if( sceneManager->getComputeSkinning() )
+            sceneManager->getComputeSkinning()->_dispatch();
+
         Camera const *usedLodCamera = mLodCamera;
         if( lodCamera && mDefinition->mLodCameraName == IdString() )
             usedLodCamera = lodCamera;
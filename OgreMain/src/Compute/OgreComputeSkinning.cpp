@@ -0,0 +1,506 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-present Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Compute/OgreComputeSkinning.h"
+
+#include "Animation/OgreSkeletonInstance.h"
+#include "OgreBitwise.h"
+#include "OgreException.h"
+#include "OgreHlmsCompute.h"
+#include "OgreHlmsComputeJob.h"
+#include "OgreItem.h"
+#include "OgreProfiler.h"
+#include "OgreRenderSystem.h"
+#include "OgreSubItem.h"
+#include "OgreSubMesh2.h"
+#include "Vao/OgreAsyncTicket.h"
+#include "Vao/OgreReadOnlyBufferPacked.h"
+#include "Vao/OgreUavBufferPacked.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+namespace Ogre
+{
+    namespace
+    {
+        /// Number of float4 per vertex in SourceVertices::buffer
+        static const uint32 c_sourceVertexStride = 5u;
+        /// Number of float4 per vertex in Entry::output
+        static const uint32 c_outputVertexStride = 3u;
+
+        /// Reads a vertex element (already converted by SubMesh::_dearrangeEfficient, thus no
+        /// halfs, QTangents nor octahedral normals) into dst. Components not present are not written.
+        void readVertexElement( const char *src, VertexElementType type, float *dst )
+        {
+            const size_t typeCount = v1::VertexElement::getTypeCount( type );
+
+            switch( v1::VertexElement::getBaseType( type ) )
+            {
+            case VET_FLOAT1:
+                memcpy( dst, src, typeCount * sizeof( float ) );
+                break;
+            case VET_UBYTE4:
+                for( size_t i = 0u; i < typeCount; ++i )
+                    dst[i] = static_cast<float>( reinterpret_cast<const uint8 *>( src )[i] );
+                break;
+            case VET_UBYTE4_NORM:
+                for( size_t i = 0u; i < typeCount; ++i )
+                    dst[i] = static_cast<float>( reinterpret_cast<const uint8 *>( src )[i] ) / 255.0f;
+                break;
+            case VET_BYTE4_SNORM:
+                for( size_t i = 0u; i < typeCount; ++i )
+                    dst[i] = Bitwise::snorm8ToFloat( reinterpret_cast<const int8 *>( src )[i] );
+                break;
+            case VET_USHORT2:
+            case VET_USHORT2_NORM:
+            case VET_SHORT2_SNORM:
+            {
+                uint16 values[4];
+                memcpy( values, src, typeCount * sizeof( uint16 ) );
+                for( size_t i = 0u; i < typeCount; ++i )
+                {
+                    if( type == VET_USHORT2 || type == VET_USHORT4 )
+                        dst[i] = static_cast<float>( values[i] );
+                    else if( type == VET_USHORT2_NORM || type == VET_USHORT4_NORM )
+                        dst[i] = static_cast<float>( values[i] ) / 65535.0f;
+                    else
+                        dst[i] = Bitwise::snorm16ToFloat( static_cast<int16>( values[i] ) );
+                }
+                break;
+            }
+            default:
+                OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                             "Vertex format not supported by compute skinning",
+                             "ComputeSkinning::addSubItem" );
+            }
+        }
+    }  // namespace
+    //-------------------------------------------------------------------------
+    ComputeSkinning::ComputeSkinning( RenderSystem *renderSystem, HlmsCompute *hlmsCompute,
+                                      HlmsComputeJob *computeJob ) :
+        mBoneMatrices( 0 ),
+        mVaoManager( renderSystem->getVaoManager() ),
+        mRenderSystem( renderSystem ),
+        mHlmsCompute( hlmsCompute ),
+        mComputeJob( computeJob ),
+        mLastDispatchedFrame( std::numeric_limits<uint32>::max() )
+    {
+    }
+    //-------------------------------------------------------------------------
+    ComputeSkinning::~ComputeSkinning()
+    {
+        removeAll();
+
+        if( mBoneMatrices )
+        {
+            if( mBoneMatrices->getMappingState() != MS_UNMAPPED )
+                mBoneMatrices->unmap( UO_UNMAP_ALL );
+            mVaoManager->destroyReadOnlyBuffer( mBoneMatrices );
+            mBoneMatrices = 0;
+        }
+    }
+    //-------------------------------------------------------------------------
+    ComputeSkinning::SourceVertices &ComputeSkinning::acquireSourceVertices( SubMesh *subMesh )
+    {
+        SourceVerticesMap::iterator itor = mSourceVertices.find( subMesh );
+        if( itor != mSourceVertices.end() )
+        {
+            ++itor->second.refCount;
+            return itor->second;
+        }
+
+        const VertexBufferPackedVec &vertexBuffers = subMesh->mVao[VpNormal][0]->getVertexBuffers();
+        const size_t numVertices = vertexBuffers[0]->getNumElements();
+
+        const size_t sizeBytes = numVertices * c_sourceVertexStride * 4u * sizeof( float );
+        float *data = reinterpret_cast<float *>( OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_GEOMETRY ) );
+        FreeOnDestructor dataPtrContainer( data );
+        memset( data, 0, sizeBytes );
+        for( size_t i = 0u; i < numVertices; ++i )
+            data[i * c_sourceVertexStride * 4u + 3u] = 1.0f;  // position.w
+
+        VertexBufferPackedVec::const_iterator itBuffer = vertexBuffers.begin();
+        VertexBufferPackedVec::const_iterator enBuffer = vertexBuffers.end();
+
+        while( itBuffer != enBuffer )
+        {
+            // Let SubMesh decode halfs, QTangents & octahedral normals for us.
+            VertexElement2Vec vertexElements;
+            AsyncTicketPtr asyncTicket = ( *itBuffer )->readRequest( 0, numVertices );
+            const char *srcData = reinterpret_cast<const char *>( asyncTicket->map() );
+            char *decodedData = SubMesh::_dearrangeEfficient(
+                srcData, numVertices, ( *itBuffer )->getVertexElements(), &vertexElements );
+            asyncTicket->unmap();
+            FreeOnDestructor decodedPtrContainer( decodedData );
+
+            const size_t bytesPerVertex = VaoManager::calculateVertexSize( vertexElements );
+            size_t elementOffset = 0u;
+
+            VertexElement2Vec::const_iterator itElement = vertexElements.begin();
+            VertexElement2Vec::const_iterator enElement = vertexElements.end();
+
+            while( itElement != enElement )
+            {
+                size_t dstIdx = c_sourceVertexStride;
+                switch( itElement->mSemantic )
+                {
+                case VES_POSITION:
+                    dstIdx = 0u;
+                    break;
+                case VES_NORMAL:
+                    dstIdx = 1u;
+                    break;
+                case VES_TANGENT:
+                    dstIdx = 2u;
+                    break;
+                case VES_BLEND_INDICES:
+                    dstIdx = 3u;
+                    break;
+                case VES_BLEND_WEIGHTS:
+                    dstIdx = 4u;
+                    break;
+                default:
+                    break;
+                }
+
+                if( dstIdx != c_sourceVertexStride )
+                {
+                    for( size_t i = 0u; i < numVertices; ++i )
+                    {
+                        readVertexElement( decodedData + i * bytesPerVertex + elementOffset,
+                                           itElement->mType,
+                                           data + ( i * c_sourceVertexStride + dstIdx ) * 4u );
+                    }
+                }
+
+                elementOffset += v1::VertexElement::getTypeSize( itElement->mType );
+                ++itElement;
+            }
+
+            ++itBuffer;
+        }
+
+        SourceVertices sourceVertices;
+        sourceVertices.buffer =
+            mVaoManager->createReadOnlyBuffer( PFG_RGBA32_FLOAT, sizeBytes, BT_IMMUTABLE, data, false );
+        sourceVertices.numVertices = static_cast<uint32>( numVertices );
+        sourceVertices.refCount = 1u;
+
+        return mSourceVertices.insert( std::make_pair( subMesh, sourceVertices ) ).first->second;
+    }
+    //-------------------------------------------------------------------------
+    void ComputeSkinning::releaseSourceVertices( SubMesh *subMesh )
+    {
+        SourceVerticesMap::iterator itor = mSourceVertices.find( subMesh );
+        OGRE_ASSERT_LOW( itor != mSourceVertices.end() );
+
+        if( --itor->second.refCount == 0u )
+        {
+            mVaoManager->destroyReadOnlyBuffer( itor->second.buffer );
+            mSourceVertices.erase( itor );
+        }
+    }
+    //-------------------------------------------------------------------------
+    void ComputeSkinning::addSubItem( SubItem *subItem )
+    {
+        EntryVec::const_iterator itor = mEntries.begin();
+        EntryVec::const_iterator endt = mEntries.end();
+        while( itor != endt && itor->subItem != subItem )
+            ++itor;
+
+        if( itor != endt )
+            return;
+
+        if( !subItem->hasSkeletonAnimation() || subItem->getVaos( VpNormal ).empty() ||
+            !subItem->getBlendIndexToBoneIndexMap() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Only v2 SubItems with skeletal animation can use compute skinning",
+                         "ComputeSkinning::addSubItem" );
+        }
+
+        if( subItem->getNumPoses() > 0u )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "SubItems with pose animation can't use compute skinning",
+                         "ComputeSkinning::addSubItem" );
+        }
+
+        SubMesh *subMesh = subItem->getSubMesh();
+
+        // The shader indexes the output with the vertex ID. Every Vao we may be
+        // rendered with must thus use the same vertex buffer we skinned.
+        const VertexBufferPacked *baseVertexBuffer =
+            subMesh->mVao[VpNormal][0]->getBaseVertexBuffer();
+        for( size_t i = 0u; i < NumVertexPass; ++i )
+        {
+            VertexArrayObjectArray::const_iterator itVao = subMesh->mVao[i].begin();
+            VertexArrayObjectArray::const_iterator enVao = subMesh->mVao[i].end();
+            while( itVao != enVao )
+            {
+                if( ( *itVao )->getBaseVertexBuffer() != baseVertexBuffer )
+                {
+                    OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                                 "Compute skinning needs all LODs and shadow mapping Vaos of "
+                                 "the SubMesh to share the same vertex buffer",
+                                 "ComputeSkinning::addSubItem" );
+                }
+                ++itVao;
+            }
+        }
+
+        const SourceVertices &sourceVertices = acquireSourceVertices( subMesh );
+
+        Entry entry;
+        entry.subItem = subItem;
+        entry.subMesh = subMesh;
+        entry.numVertices = sourceVertices.numVertices;
+        entry.output =
+            mVaoManager->createUavBuffer( entry.numVertices * c_outputVertexStride, 4u * sizeof( float ),
+                                          BB_FLAG_UAV | BB_FLAG_READONLY, 0, false );
+        entry.outputView = entry.output->getAsReadOnlyBufferView();
+        // Its bones haven't been uploaded yet. Until its first dispatch, the
+        // SubItem keeps rendering with vertex shader skinning.
+        entry.boneStart = std::numeric_limits<uint32>::max();
+        mEntries.push_back( entry );
+    }
+    //-------------------------------------------------------------------------
+    void ComputeSkinning::removeSubItem( SubItem *subItem )
+    {
+        EntryVec::iterator itor = mEntries.begin();
+        EntryVec::iterator endt = mEntries.end();
+        while( itor != endt && itor->subItem != subItem )
+            ++itor;
+
+        if( itor == endt )
+            return;
+
+        subItem->_setPreSkinnedBuffer( 0 );
+        mVaoManager->destroyUavBuffer( itor->output );
+        releaseSourceVertices( itor->subMesh );
+
+        efficientVectorRemove( mEntries, itor );
+    }
+    //-------------------------------------------------------------------------
+    void ComputeSkinning::addItem( Item *item )
+    {
+        const size_t numSubItems = item->getNumSubItems();
+        for( size_t i = 0u; i < numSubItems; ++i )
+        {
+            SubItem *subItem = item->getSubItem( i );
+            if( subItem->hasSkeletonAnimation() && subItem->getNumPoses() == 0u &&
+                !subItem->getVaos( VpNormal ).empty() )
+            {
+                addSubItem( subItem );
+            }
+        }
+    }
+    //-------------------------------------------------------------------------
+    void ComputeSkinning::removeItem( Item *item )
+    {
+        const size_t numSubItems = item->getNumSubItems();
+        for( size_t i = 0u; i < numSubItems; ++i )
+            removeSubItem( item->getSubItem( i ) );
+    }
+    //-------------------------------------------------------------------------
+    void ComputeSkinning::removeAll()
+    {
+        EntryVec::const_iterator itor = mEntries.begin();
+        EntryVec::const_iterator endt = mEntries.end();
+
+        while( itor != endt )
+        {
+            itor->subItem->_setPreSkinnedBuffer( 0 );
+            mVaoManager->destroyUavBuffer( itor->output );
+            ++itor;
+        }
+
+        mEntries.clear();
+
+        SourceVerticesMap::const_iterator itSource = mSourceVertices.begin();
+        SourceVerticesMap::const_iterator enSource = mSourceVertices.end();
+
+        while( itSource != enSource )
+        {
+            mVaoManager->destroyReadOnlyBuffer( itSource->second.buffer );
+            ++itSource;
+        }
+
+        mSourceVertices.clear();
+    }
+    //-------------------------------------------------------------------------
+    void ComputeSkinning::_updateBoneMatrices()
+    {
+        OgreProfileExhaustive( "ComputeSkinning::_updateBoneMatrices" );
+
+        size_t numBoneVec4 = 0u;
+
+        EntryVec::iterator itor = mEntries.begin();
+        EntryVec::iterator endt = mEntries.end();
+
+        while( itor != endt )
+        {
+            itor->boneStart = static_cast<uint32>( numBoneVec4 );
+            numBoneVec4 += itor->subItem->getBlendIndexToBoneIndexMap()->size() * 3u;
+            ++itor;
+        }
+
+        if( numBoneVec4 == 0u )
+            return;
+
+        const size_t sizeBytes = numBoneVec4 * 4u * sizeof( float );
+
+        if( !mBoneMatrices || mBoneMatrices->getNumElements() < sizeBytes )
+        {
+            if( mBoneMatrices )
+            {
+                if( mBoneMatrices->getMappingState() != MS_UNMAPPED )
+                    mBoneMatrices->unmap( UO_UNMAP_ALL );
+                mVaoManager->destroyReadOnlyBuffer( mBoneMatrices );
+            }
+
+            // Grow with some slack, so that adding a few more SubItems doesn't reallocate
+            mBoneMatrices = mVaoManager->createReadOnlyBuffer(
+                PFG_RGBA32_FLOAT, sizeBytes + ( sizeBytes >> 1u ), BT_DYNAMIC_PERSISTENT, 0, false );
+        }
+
+        float *RESTRICT_ALIAS boneMatrices =
+            reinterpret_cast<float * RESTRICT_ALIAS>( mBoneMatrices->map( 0u, sizeBytes ) );
+
+        itor = mEntries.begin();
+
+        while( itor != endt )
+        {
+            const SkeletonInstance *skeleton = itor->subItem->getParent()->getSkeletonInstance();
+            const RenderableAnimated::IndexMap *indexMap =
+                itor->subItem->getBlendIndexToBoneIndexMap();
+
+            RenderableAnimated::IndexMap::const_iterator itBone = indexMap->begin();
+            RenderableAnimated::IndexMap::const_iterator enBone = indexMap->end();
+
+            while( itBone != enBone )
+            {
+                skeleton->_getBoneFullTransform( *itBone ).streamTo4x3( boneMatrices );
+                boneMatrices += 12u;
+                ++itBone;
+            }
+
+            ++itor;
+        }
+
+        mBoneMatrices->unmap( UO_KEEP_PERSISTENT, 0u, sizeBytes );
+    }
+    //-------------------------------------------------------------------------
+    void ComputeSkinning::_dispatch()
+    {
+        if( !mComputeJob || mEntries.empty() || !mBoneMatrices )
+            return;
+
+        const uint32 frameCount = mVaoManager->getFrameCount();
+        if( mLastDispatchedFrame == frameCount )
+            return;
+        mLastDispatchedFrame = frameCount;
+
+        // Compute can't be dispatched inside a render pass (i.e. if the previous pass
+        // left it open). The pass that called us will begin its own afterwards.
+        mRenderSystem->endRenderPassDescriptor();
+
+        OgreProfileGpuBegin( "Compute Skinning" );
+
+        ShaderParams::Param paramSkinning;
+        paramSkinning.name = "numVertices_boneStart";
+
+        const uint32 threadsPerGroupX = mComputeJob->getThreadsPerGroupX();
+
+        DescriptorSetTexture2::BufferSlot boneSlot( DescriptorSetTexture2::BufferSlot::makeEmpty() );
+        boneSlot.buffer = mBoneMatrices;
+        mComputeJob->setTexBuffer( 1, boneSlot );
+
+        EntryVec::const_iterator itor = mEntries.begin();
+        EntryVec::const_iterator endt = mEntries.end();
+
+        while( itor != endt )
+        {
+            if( itor->boneStart == std::numeric_limits<uint32>::max() )
+            {
+                // Added after _updateBoneMatrices, we'll get it next frame
+                ++itor;
+                continue;
+            }
+
+            DescriptorSetUav::BufferSlot bufferSlot( DescriptorSetUav::BufferSlot::makeEmpty() );
+            bufferSlot.buffer = itor->output;
+            bufferSlot.access = ResourceAccess::Write;
+            mComputeJob->_setUavBuffer( 0, bufferSlot );
+
+            DescriptorSetTexture2::BufferSlot texBufSlot(
+                DescriptorSetTexture2::BufferSlot::makeEmpty() );
+            texBufSlot.buffer = mSourceVertices[itor->subMesh].buffer;
+            mComputeJob->setTexBuffer( 0, texBufSlot );
+
+            const uint32 skinningParams[2] = { itor->numVertices, itor->boneStart };
+            paramSkinning.setManualValue( skinningParams, 2u );
+
+            ShaderParams &shaderParams = mComputeJob->getShaderParams( "default" );
+            shaderParams.mParams.clear();
+            shaderParams.mParams.push_back( paramSkinning );
+            shaderParams.setDirty();
+
+            mComputeJob->setNumThreadGroups(
+                ( itor->numVertices + threadsPerGroupX - 1u ) / threadsPerGroupX, 1u, 1u );
+
+            mComputeJob->analyzeBarriers( mResourceTransitions );
+            mRenderSystem->executeResourceTransition( mResourceTransitions );
+            mHlmsCompute->dispatch( mComputeJob, 0, 0 );
+
+            if( itor->subItem->getPreSkinnedBuffer() != itor->outputView )
+                itor->subItem->_setPreSkinnedBuffer( itor->outputView );
+
+            ++itor;
+        }
+
+        // Every pass this frame reads the results from the vertex shader.
+        BarrierSolver &solver = mRenderSystem->getBarrierSolver();
+        mResourceTransitions.clear();
+
+        itor = mEntries.begin();
+
+        while( itor != endt )
+        {
+            solver.resolveTransition( mResourceTransitions, itor->output, ResourceAccess::Read,
+                                      1u << GPT_VERTEX_PROGRAM );
+            ++itor;
+        }
+
+        mRenderSystem->executeResourceTransition( mResourceTransitions );
+
+        OgreProfileGpuEnd( "Compute Skinning" );
+    }
+}  // namespace Ogre
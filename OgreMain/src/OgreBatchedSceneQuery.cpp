@@ -0,0 +1,535 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreBatchedSceneQuery.h"
+
+#include "Math/Array/OgreArrayRay.h"
+#include "Math/Array/OgreArraySphere.h"
+#include "Math/Array/OgreBooleanMask.h"
+#include "Math/Array/OgreMathlib.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+#include "OgreMath.h"
+#include "OgreProfiler.h"
+#include "OgreSceneManager.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Ogre
+{
+    namespace
+    {
+        /// Below this many queries per thread, waking up the worker threads costs more
+        /// than what they save
+        static const size_t c_minQueriesPerThread = 16u;
+        static const size_t c_maxObjectsPerBvhLeaf = 4u;
+        static const size_t c_maxBvhDepth = 64u;
+
+        /// Tests a ray against 4 objects at a time (ObjectData) or against a single aabb
+        struct RayShape
+        {
+            ArrayRay     arrayRay;
+            ArrayVector3 arrayInvDir;
+            Vector3      origin;
+            Vector3      invDir;
+
+            RayShape( const Ray &ray ) :
+                origin( ray.getOrigin() ),
+                invDir( Vector3::UNIT_SCALE / ray.getDirection() )
+            {
+                arrayRay.mOrigin.setAll( ray.getOrigin() );
+                arrayRay.mDirection.setAll( ray.getDirection() );
+                arrayInvDir.setAll( invDir );
+            }
+
+            ArrayMaskR intersects( const ObjectData &objData, ArrayReal &outDistance ) const
+            {
+                return arrayRay.intersects( *objData.mWorldAabb, arrayInvDir, outDistance );
+            }
+
+            /// Scalar version of ArrayRay::intersects
+            bool intersects( const Aabb &aabb, Real &outDistance ) const
+            {
+                const Vector3 intersectAtMinPlane = ( aabb.getMinimum() - origin ) * invDir;
+                const Vector3 intersectAtMaxPlane = ( aabb.getMaximum() - origin ) * invDir;
+
+                Real tmin = -std::numeric_limits<Real>::infinity();
+                Real tmax = std::numeric_limits<Real>::infinity();
+
+                for( size_t i = 0u; i < 3u; ++i )
+                {
+                    const Real t0 = intersectAtMinPlane[i];
+                    const Real t1 = intersectAtMaxPlane[i];
+                    // 0 * inf = NaN when the ray is parallel to this slab and starts on its
+                    // border. std::min & std::max don't handle NaNs consistently (the result
+                    // depends on the argument order) so, like the SIMD version, a NaN slab
+                    // is ignored instead of rejecting the hit.
+                    if( Math::isNaN( t0 ) || Math::isNaN( t1 ) )
+                        continue;
+                    tmin = std::max( tmin, std::min( t0, t1 ) );
+                    tmax = std::min( tmax, std::max( t0, t1 ) );
+                }
+
+                outDistance = std::max( tmin, Real( 0.0 ) );
+                return tmax >= outDistance;
+            }
+
+            bool intersects( const Aabb &aabb, Real /*worldRadius*/, Real &outDistance ) const
+            {
+                return intersects( aabb, outDistance );
+            }
+        };
+
+        /// Tests a sphere against the objects' bounding spheres
+        struct SphereShape
+        {
+            ArraySphere arraySphere;
+            Sphere      sphere;
+
+            SphereShape( const Sphere &_sphere ) : sphere( _sphere ) { arraySphere.setAll( sphere ); }
+
+            ArrayMaskR intersects( const ObjectData &objData, ArrayReal &outDistance ) const
+            {
+                outDistance = ARRAY_REAL_ZERO;
+                const ArrayReal *RESTRICT_ALIAS worldRadius =
+                    reinterpret_cast<const ArrayReal * RESTRICT_ALIAS>( objData.mWorldRadius );
+                const ArraySphere testSphere( *worldRadius, objData.mWorldAabb->mCenter );
+                return arraySphere.intersects( testSphere );
+            }
+
+            bool intersects( const Aabb &aabb, Real &outDistance ) const
+            {
+                outDistance = 0;
+                const Real radius = sphere.getRadius();
+                return aabb.squaredDistance( sphere.getCenter() ) <= radius * radius;
+            }
+
+            bool intersects( const Aabb &aabb, Real worldRadius, Real &outDistance ) const
+            {
+                outDistance = 0;
+                return sphere.intersects( Sphere( aabb.mCenter, worldRadius ) );
+            }
+        };
+
+        /// Tests a box against the objects' aabbs
+        struct AabbShape
+        {
+            ArrayAabb arrayAabb;
+            Aabb      aabb;
+
+            AabbShape( const AxisAlignedBox &box ) :
+                arrayAabb( ArrayVector3::ZERO, ArrayVector3::ZERO ),
+                aabb( Aabb::newFromExtents( box.getMinimum(), box.getMaximum() ) )
+            {
+                arrayAabb.setAll( aabb );
+            }
+
+            ArrayMaskR intersects( const ObjectData &objData, ArrayReal &outDistance ) const
+            {
+                outDistance = ARRAY_REAL_ZERO;
+                return arrayAabb.intersects( *objData.mWorldAabb );
+            }
+
+            bool intersects( const Aabb &other, Real &outDistance ) const
+            {
+                outDistance = 0;
+                return aabb.intersects( other );
+            }
+
+            bool intersects( const Aabb &other, Real /*worldRadius*/, Real &outDistance ) const
+            {
+                return intersects( other, outDistance );
+            }
+        };
+
+        struct BvhObjectCenterLess
+        {
+            size_t axis;
+
+            BvhObjectCenterLess( size_t _axis ) : axis( _axis ) {}
+
+            template <typename T>
+            bool operator()( const T &a, const T &b ) const
+            {
+                return a.aabb.mCenter[axis] < b.aabb.mCenter[axis];
+            }
+        };
+    }  // namespace
+    //-------------------------------------------------------------------------
+    BatchedSceneQuery::BatchedSceneQuery( SceneManager *creator ) :
+        SceneQuery( creator ),
+        mQueryType( QueryRay ),
+        mRays( 0 ),
+        mSpheres( 0 ),
+        mAabbs( 0 ),
+        mNumQueries( 0u ),
+        mClosestHitOnly( false )
+    {
+        // No world geometry results supported
+        mSupportedWorldFragments.insert( SceneQuery::WFT_NONE );
+        mHitStart.push_back( 0u );
+    }
+    //-------------------------------------------------------------------------
+    BatchedSceneQuery::~BatchedSceneQuery() {}
+    //-------------------------------------------------------------------------
+    void BatchedSceneQuery::executeRays( const Ray *rays, size_t numRays, bool closestHitOnly )
+    {
+        mQueryType = QueryRay;
+        mRays = rays;
+        mNumQueries = numRays;
+        mClosestHitOnly = closestHitOnly;
+        dispatch();
+        mRays = 0;
+    }
+    //-------------------------------------------------------------------------
+    void BatchedSceneQuery::executeSpheres( const Sphere *spheres, size_t numSpheres )
+    {
+        mQueryType = QuerySphere;
+        mSpheres = spheres;
+        mNumQueries = numSpheres;
+        mClosestHitOnly = false;
+        dispatch();
+        mSpheres = 0;
+    }
+    //-------------------------------------------------------------------------
+    void BatchedSceneQuery::executeAabbs( const AxisAlignedBox *aabbs, size_t numAabbs )
+    {
+        mQueryType = QueryAabb;
+        mAabbs = aabbs;
+        mNumQueries = numAabbs;
+        mClosestHitOnly = false;
+        dispatch();
+        mAabbs = 0;
+    }
+    //-------------------------------------------------------------------------
+    void BatchedSceneQuery::dispatch()
+    {
+        OgreProfileExhaustive( "BatchedSceneQuery::dispatch" );
+
+        assert( mFirstRq < mLastRq && "This query will never hit any result!" );
+
+        const size_t numThreads = std::max<size_t>( mParentSceneMgr->getNumWorkerThreads(), 1u );
+
+        mThreadHits.resize( numThreads );
+        vector<HitVec>::type::iterator itor = mThreadHits.begin();
+        vector<HitVec>::type::iterator endt = mThreadHits.end();
+        while( itor != endt )
+        {
+            itor->clear();
+            ++itor;
+        }
+
+        mHitStart.resize( mNumQueries + 1u );
+        mHitStart[0] = 0u;
+
+        if( numThreads > 1u && mNumQueries >= numThreads * c_minQueriesPerThread )
+            mParentSceneMgr->executeUserScalableTask( this, true );
+        else
+            execute( 0u, 1u );
+
+        // Threads stored each query's hit count in mHitStart[i + 1]. Turn them into offsets.
+        for( size_t i = 0u; i < mNumQueries; ++i )
+            mHitStart[i + 1u] += mHitStart[i];
+
+        // Threads processed contiguous, ascending ranges of queries,
+        // so concatenating their results keeps them in query order.
+        mHits.clear();
+        mHits.reserve( mHitStart.back() );
+        itor = mThreadHits.begin();
+        while( itor != endt )
+        {
+            mHits.insert( mHits.end(), itor->begin(), itor->end() );
+            ++itor;
+        }
+    }
+    //-------------------------------------------------------------------------
+    void BatchedSceneQuery::execute( size_t threadId, size_t numThreads )
+    {
+        const size_t queriesPerThread = ( mNumQueries + numThreads - 1u ) / numThreads;
+        const size_t queryStart = std::min( threadId * queriesPerThread, mNumQueries );
+        const size_t queryEnd = std::min( queryStart + queriesPerThread, mNumQueries );
+
+        HitVec &hits = mThreadHits[threadId];
+
+        for( size_t i = queryStart; i < queryEnd; ++i )
+        {
+            const size_t firstHit = hits.size();
+
+            switch( mQueryType )
+            {
+            case QueryRay:
+                queryShape( RayShape( mRays[i] ), hits );
+                break;
+            case QuerySphere:
+                queryShape( SphereShape( mSpheres[i] ), hits );
+                break;
+            case QueryAabb:
+                if( !mAabbs[i].isNull() )
+                    queryShape( AabbShape( mAabbs[i] ), hits );
+                break;
+            }
+
+            if( mQueryType == QueryRay && hits.size() > firstHit )
+            {
+                HitVec::iterator firstHitIt = hits.begin() + static_cast<ptrdiff_t>( firstHit );
+                if( mClosestHitOnly )
+                {
+                    *firstHitIt = *std::min_element( firstHitIt, hits.end() );
+                    hits.resize( firstHit + 1u );
+                }
+                else
+                {
+                    std::sort( firstHitIt, hits.end() );
+                }
+            }
+
+            mHitStart[i + 1u] = static_cast<uint32>( hits.size() - firstHit );
+        }
+    }
+    //-------------------------------------------------------------------------
+    bool BatchedSceneQuery::passesFilters( const MovableObject *movable ) const
+    {
+        const uint8 rqId = movable->getRenderQueueGroup();
+        return ( movable->getQueryFlags() & mQueryMask ) && movable->getVisible() &&
+               rqId >= mFirstRq && rqId < mLastRq;
+    }
+    //-------------------------------------------------------------------------
+    template <typename T>
+    void BatchedSceneQuery::queryShape( const T &shape, HitVec &outHits ) const
+    {
+        queryDynamic( shape, outHits );
+        if( !mBvhNodes.empty() )
+            queryStaticBvh( shape, outHits );
+    }
+    //-------------------------------------------------------------------------
+    template <typename T>
+    void BatchedSceneQuery::queryDynamic( const T &shape, HitVec &outHits ) const
+    {
+        const ArrayInt ourQueryMask = Mathlib::SetAll( mQueryMask );
+        const ArrayInt layerVisibility = Mathlib::SetAll( VisibilityFlags::LAYER_VISIBILITY );
+
+        for( size_t i = 0; i < NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+        {
+            // Static objects are in the BVH, if we have one
+            if( i == SCENE_STATIC && !mBvhNodes.empty() )
+                continue;
+
+            ObjectMemoryManager &memoryManager =
+                mParentSceneMgr->_getEntityMemoryManager( static_cast<SceneMemoryMgrTypes>( i ) );
+
+            const size_t numRenderQueues = memoryManager.getNumRenderQueues();
+            const size_t firstRq = std::min<size_t>( mFirstRq, numRenderQueues );
+            const size_t lastRq = std::min<size_t>( mLastRq, numRenderQueues );
+
+            for( size_t j = firstRq; j < lastRq; ++j )
+            {
+                ObjectData objData;
+                const size_t totalObjs = memoryManager.getFirstObjectData( objData, j );
+
+                for( size_t k = 0; k < totalObjs; k += ARRAY_PACKED_REALS )
+                {
+                    ArrayInt *RESTRICT_ALIAS visibilityFlags =
+                        reinterpret_cast<ArrayInt * RESTRICT_ALIAS>( objData.mVisibilityFlags );
+                    ArrayInt *RESTRICT_ALIAS queryFlags =
+                        reinterpret_cast<ArrayInt * RESTRICT_ALIAS>( objData.mQueryFlags );
+
+                    ArrayReal distance;
+                    const ArrayMaskR hitMaskR = shape.intersects( objData, distance );
+
+                    // hitMask = hitMask && ( (*queryFlags & ourQueryMask) != 0 ) && isVisble;
+                    ArrayMaskI hitMask = CastRealToInt( hitMaskR );
+                    hitMask = Mathlib::And( hitMask, Mathlib::TestFlags4( *queryFlags, ourQueryMask ) );
+                    hitMask = Mathlib::And( hitMask,
+                                            Mathlib::TestFlags4( *visibilityFlags, layerVisibility ) );
+
+                    const uint32 scalarMask = BooleanMask4::getScalarMask( hitMask );
+
+                    if( scalarMask )
+                    {
+                        OGRE_ALIGNED_DECL( Real, scalarDistance[ARRAY_PACKED_REALS],
+                                           OGRE_SIMD_ALIGNMENT );
+                        CastArrayToReal( scalarDistance, distance );
+
+                        for( size_t l = 0; l < ARRAY_PACKED_REALS; ++l )
+                        {
+                            // There's no need to check objData.mOwner[l] is null because
+                            // we set mVisibilityFlags to 0 on slot removals
+                            if( IS_BIT_SET( l, scalarMask ) )
+                            {
+                                Hit hit;
+                                hit.movable = objData.mOwner[l];
+                                hit.distance = scalarDistance[l];
+                                outHits.push_back( hit );
+                            }
+                        }
+                    }
+
+                    objData.advancePack();
+                }
+            }
+        }
+    }
+    //-------------------------------------------------------------------------
+    template <typename T>
+    void BatchedSceneQuery::queryStaticBvh( const T &shape, HitVec &outHits ) const
+    {
+        uint32 stack[c_maxBvhDepth];
+        size_t stackSize = 0u;
+        stack[stackSize++] = 0u;
+
+        while( stackSize > 0u )
+        {
+            const uint32 nodeIdx = stack[--stackSize];
+            const BvhNode &node = mBvhNodes[nodeIdx];
+
+            Real distance;
+            if( !shape.intersects( node.aabb, distance ) )
+                continue;
+
+            if( node.numObjects == 0u )
+            {
+                OGRE_ASSERT_LOW( stackSize + 2u <= c_maxBvhDepth );
+                stack[stackSize++] = node.firstObjOrRightChild;
+                stack[stackSize++] = nodeIdx + 1u;
+                continue;
+            }
+
+            const uint32 objEnd = node.firstObjOrRightChild + node.numObjects;
+            for( uint32 i = node.firstObjOrRightChild; i < objEnd; ++i )
+            {
+                const BvhObject &object = mBvhObjects[i];
+
+                if( shape.intersects( object.aabb, object.worldRadius, distance ) &&
+                    passesFilters( object.movable ) )
+                {
+                    Hit hit;
+                    hit.movable = object.movable;
+                    hit.distance = distance;
+                    outHits.push_back( hit );
+                }
+            }
+        }
+    }
+    //-------------------------------------------------------------------------
+    void BatchedSceneQuery::buildStaticBvh()
+    {
+        OgreProfileExhaustive( "BatchedSceneQuery::buildStaticBvh" );
+
+        clearStaticBvh();
+
+        ObjectMemoryManager &memoryManager = mParentSceneMgr->_getEntityMemoryManager( SCENE_STATIC );
+        const SceneNode *dummyNode = memoryManager._getDummyNode();
+
+        const size_t numRenderQueues = memoryManager.getNumRenderQueues();
+        for( size_t i = 0u; i < numRenderQueues; ++i )
+        {
+            ObjectData objData;
+            const size_t totalObjs = memoryManager.getFirstObjectData( objData, i );
+
+            for( size_t j = 0; j < totalObjs; j += ARRAY_PACKED_REALS )
+            {
+                for( size_t k = 0; k < ARRAY_PACKED_REALS; ++k )
+                {
+                    // Skip empty slots and detached objects
+                    if( objData.mParents[k] != dummyNode )
+                    {
+                        BvhObject object;
+                        object.movable = objData.mOwner[k];
+                        objData.mWorldAabb->getAsAabb( object.aabb, k );
+                        object.worldRadius = objData.mWorldRadius[k];
+                        mBvhObjects.push_back( object );
+                    }
+                }
+
+                objData.advancePack();
+            }
+        }
+
+        if( !mBvhObjects.empty() )
+        {
+            mBvhNodes.reserve( ( mBvhObjects.size() / c_maxObjectsPerBvhLeaf + 1u ) * 2u );
+            buildBvhNode( 0u, mBvhObjects.size() );
+        }
+    }
+    //-------------------------------------------------------------------------
+    void BatchedSceneQuery::clearStaticBvh()
+    {
+        mBvhNodes.clear();
+        mBvhObjects.clear();
+    }
+    //-------------------------------------------------------------------------
+    uint32 BatchedSceneQuery::buildBvhNode( size_t objStart, size_t objEnd )
+    {
+        const uint32 nodeIdx = static_cast<uint32>( mBvhNodes.size() );
+        mBvhNodes.push_back( BvhNode() );
+
+        // The node must enclose both the aabbs (ray & box queries)
+        // and the bounding spheres (sphere queries) of its objects.
+        Aabb bounds = mBvhObjects[objStart].aabb;
+        Aabb centerBounds( mBvhObjects[objStart].aabb.mCenter, Vector3::ZERO );
+        for( size_t i = objStart; i < objEnd; ++i )
+        {
+            const BvhObject &object = mBvhObjects[i];
+            bounds.merge( object.aabb );
+            bounds.merge( Aabb( object.aabb.mCenter, Vector3( object.worldRadius ) ) );
+            centerBounds.merge( object.aabb.mCenter );
+        }
+
+        mBvhNodes[nodeIdx].aabb = bounds;
+
+        if( objEnd - objStart <= c_maxObjectsPerBvhLeaf )
+        {
+            mBvhNodes[nodeIdx].firstObjOrRightChild = static_cast<uint32>( objStart );
+            mBvhNodes[nodeIdx].numObjects = static_cast<uint32>( objEnd - objStart );
+            return nodeIdx;
+        }
+
+        // Median split along the axis where the objects are most spread out
+        size_t axis = 0u;
+        if( centerBounds.mHalfSize.y > centerBounds.mHalfSize[axis] )
+            axis = 1u;
+        if( centerBounds.mHalfSize.z > centerBounds.mHalfSize[axis] )
+            axis = 2u;
+
+        const size_t objMid = objStart + ( objEnd - objStart ) / 2u;
+        std::nth_element( mBvhObjects.begin() + static_cast<ptrdiff_t>( objStart ),
+                          mBvhObjects.begin() + static_cast<ptrdiff_t>( objMid ),
+                          mBvhObjects.begin() + static_cast<ptrdiff_t>( objEnd ),
+                          BvhObjectCenterLess( axis ) );
+
+        buildBvhNode( objStart, objMid );
+        const uint32 rightChild = buildBvhNode( objMid, objEnd );
+
+        mBvhNodes[nodeIdx].firstObjOrRightChild = rightChild;
+        mBvhNodes[nodeIdx].numObjects = 0u;
+
+        return nodeIdx;
+    }
+}  // namespace Ogre
@@ -82,7 +82,7 @@ namespace Ogre
             else if( slot.isBuffer() )
             {
                 const BufferSlot &bufferSlot = slot.getBuffer();
-                if( bufferSlot.buffer->getBufferType() >= BT_DYNAMIC_DEFAULT )
+                if( bufferSlot.buffer && bufferSlot.buffer->getBufferType() >= BT_DYNAMIC_DEFAULT )
                 {
                     OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
                                  "Dynamic buffers cannot be baked into a static DescriptorSet",
@@ -39,11 +39,15 @@ THE SOFTWARE.
 #include "OgreHlms.h"
 #include "OgreProfiler.h"
 #include "OgreSceneManager.h"
+#include "OgreStringConverter.h"
 #include "OgreViewport.h"
 #include "OgreWireAabb.h"
 #include "Vao/OgreReadOnlyBufferPacked.h"
 #include "Vao/OgreVaoManager.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace Ogre
 {
     static const size_t c_reservedLightSlotsPerCell = 3u;
@@ -88,6 +92,8 @@ namespace Ogre
         mFrustumRegions = RawSimdUniquePtr<FrustumRegion, MEMCATEGORY_SCENE_CONTROL>(
             ( mWidth / ARRAY_PACKED_REALS ) * mHeight * mNumSlices );
 
+        mTilePlanes.resize( mSceneManager->getNumWorkerThreads() * getTilePlanesStride() );
+
         mObjectMemoryManager = new ObjectMemoryManager();
         mNodeMemoryManager = new NodeMemoryManager();
 
@@ -123,25 +129,39 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     inline float ForwardClustered::getDepthAtSlice( uint32 uSlice ) const
     {
+        if( !mSliceDepths.empty() )
+        {
+            if( uSlice == 0u )
+                return -mMinDistance;
+            if( uSlice >= mNumSlices )
+                return -std::max( mMaxDistance, mSliceDepths.back() );
+            return -mSliceDepths[uSlice - 1u];
+        }
+
         return -( powf( 2.0f, mExponentK * float( uSlice ) ) + mMinDistance );
     }
     //-----------------------------------------------------------------------------------
     inline uint32 ForwardClustered::getSliceAtDepth( Real depth ) const
     {
+        if( !mSliceDepths.empty() )
+        {
+            // Same as the shader: count how many slice boundaries we're past.
+            return static_cast<uint32>(
+                std::upper_bound( mSliceDepths.begin(), mSliceDepths.end(), float( -depth ) ) -
+                mSliceDepths.begin() );
+        }
+
         return static_cast<uint32>(
             floorf( Math::Log2( std::max( -depth - mMinDistance, Real( 1 ) ) ) * mInvExponentK ) );
     }
     //-----------------------------------------------------------------------------------
     void ForwardClustered::execute( size_t threadId, size_t numThreads )
     {
-        const size_t slicesPerThread = mNumSlices / numThreads;
-
-        for( size_t i = 0; i < slicesPerThread; ++i )
-            collectLightForSlice( i + threadId * slicesPerThread, threadId );
-
-        const size_t slicesRemainder = mNumSlices % numThreads;
-        if( slicesRemainder > threadId )
-            collectLightForSlice( threadId + numThreads * slicesPerThread, threadId );
+        // Interleave the slices instead of giving each thread a contiguous block.
+        // The slices closest to the camera are thinner and tend to be the most crowded,
+        // so contiguous blocks are very unbalanced.
+        for( size_t slice = threadId; slice < mNumSlices; slice += numThreads )
+            collectLightForSlice( slice, threadId );
     }
     //-----------------------------------------------------------------------------------
     inline size_t ForwardClustered::getDecalsOffsetStart() const
@@ -156,12 +176,145 @@ namespace Ogre
                ( hasDecals ? ( c_reservedDecalsSlotsPerCell + mDecalsPerCell ) : 0u );
     }
     //-----------------------------------------------------------------------------------
-    void ForwardClustered::collectObjsForSlice( const size_t numPackedFrustumsPerSlice,
+    inline size_t ForwardClustered::getNumSliceDepthsFloat4() const
+    {
+        return ( mSliceDepths.size() + 3u ) / 4u;
+    }
+    //-----------------------------------------------------------------------------------
+    inline size_t ForwardClustered::getTilePlanesStride() const
+    {
+        // Near & far, left & right per column, top & bottom per row.
+        return 2u + 2u * ( mWidth + mHeight );
+    }
+    //-----------------------------------------------------------------------------------
+    /// Returns true if the volume is entirely in the negative side of the plane.
+    /// Must match the per-cell tests in collectLightForSlice & collectObjsForSlice.
+    static inline bool isOutside( const Plane &plane, const Vector3 &center, const Real radius,
+                                  const Vector3 *RESTRICT_ALIAS vertices, const uint32 numVertices )
+    {
+        if( !numVertices )
+            return !( plane.normal.dotProduct( center ) + radius > -plane.d );
+
+        for( uint32 i = 0u; i < numVertices; ++i )
+        {
+            if( plane.normal.dotProduct( vertices[i] ) - ( -plane.d ) > Real( 0 ) )
+                return false;
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    /// Returns the bits of the cells in the packed frustum that lie inside [minX; maxX]
+    static inline uint32 getColumnMask( const size_t packedColumn, const uint32 minX,
+                                        const uint32 maxX )
+    {
+        uint32 mask = 0u;
+        for( size_t k = 0u; k < ARRAY_PACKED_REALS; ++k )
+        {
+            const size_t column = packedColumn * ARRAY_PACKED_REALS + k;
+            if( column >= minX && column <= maxX )
+                mask |= 1u << k;
+        }
+        return mask;
+    }
+    //-----------------------------------------------------------------------------------
+    inline bool ForwardClustered::getTileRange( const Plane *RESTRICT_ALIAS tilePlanes,
+                                                const BinVolume &volume, TileRange &outRange ) const
+    {
+        const Vector3 &center = volume.center;
+        const Real radius = volume.radius;
+        const Vector3 *RESTRICT_ALIAS vertices = volume.vertices;
+        const uint32 numVertices = volume.numVertices;
+
+        if( isOutside( tilePlanes[0], center, radius, vertices, numVertices ) ||
+            isOutside( tilePlanes[1], center, radius, vertices, numVertices ) )
+        {
+            return false;
+        }
+
+        const Plane *RESTRICT_ALIAS columnPlanes = tilePlanes + 2u;
+        const Plane *RESTRICT_ALIAS rowPlanes = columnPlanes + mWidth * 2u;
+
+        uint32 minX = 0u;
+        while( minX < mWidth &&
+               ( isOutside( columnPlanes[minX * 2u + 0u], center, radius, vertices, numVertices ) ||
+                 isOutside( columnPlanes[minX * 2u + 1u], center, radius, vertices, numVertices ) ) )
+        {
+            ++minX;
+        }
+
+        if( minX == mWidth )
+            return false;
+
+        uint32 maxX = mWidth - 1u;
+        while( maxX > minX &&
+               ( isOutside( columnPlanes[maxX * 2u + 0u], center, radius, vertices, numVertices ) ||
+                 isOutside( columnPlanes[maxX * 2u + 1u], center, radius, vertices, numVertices ) ) )
+        {
+            --maxX;
+        }
+
+        uint32 minY = 0u;
+        while( minY < mHeight &&
+               ( isOutside( rowPlanes[minY * 2u + 0u], center, radius, vertices, numVertices ) ||
+                 isOutside( rowPlanes[minY * 2u + 1u], center, radius, vertices, numVertices ) ) )
+        {
+            ++minY;
+        }
+
+        if( minY == mHeight )
+            return false;
+
+        uint32 maxY = mHeight - 1u;
+        while( maxY > minY &&
+               ( isOutside( rowPlanes[maxY * 2u + 0u], center, radius, vertices, numVertices ) ||
+                 isOutside( rowPlanes[maxY * 2u + 1u], center, radius, vertices, numVertices ) ) )
+        {
+            --maxY;
+        }
+
+        outRange.minX = minX;
+        outRange.maxX = maxX;
+        outRange.minY = minY;
+        outRange.maxY = maxY;
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    inline void ForwardClustered::addLightToCells( const size_t packedFrustumIdx,
+                                                   const uint32 scalarMask, const size_t lightIdx,
+                                                   const Light::LightTypes lightType )
+    {
+        for( size_t k = 0; k < ARRAY_PACKED_REALS; ++k )
+        {
+            if( IS_BIT_SET( k, scalarMask ) )
+            {
+                const size_t idx = packedFrustumIdx * ARRAY_PACKED_REALS + k;
+                FastArray<LightCount>::iterator numLightsInCell = mLightCountInCell.begin() + idx;
+
+                // assert( numLightsInCell < mLightCountInCell.end() );
+
+                if( numLightsInCell->lightCount[0] < mLightsPerCell )
+                {
+                    uint16 *RESTRICT_ALIAS cellElem =
+                        mGridBuffer + idx * mObjsPerCell +
+                        ( numLightsInCell->lightCount[0] + c_reservedLightSlotsPerCell );
+                    *cellElem = static_cast<uint16>( lightIdx * c_ForwardPlusNumFloat4PerLight );
+                    ++numLightsInCell->lightCount[0];
+                    ++numLightsInCell->lightCount[lightType];
+                }
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ForwardClustered::collectObjsForSlice( const Plane *RESTRICT_ALIAS tilePlanes,
                                                 const size_t frustumStartIdx, uint16 offsetStart,
                                                 size_t minRq, size_t maxRq, size_t currObjsPerCell,
                                                 size_t cellOffsetStart, ObjTypes objType,
                                                 uint16 numFloat4PerObj )
     {
+        const size_t numPacksPerRow = mWidth / ARRAY_PACKED_REALS;
+
         const VisibleObjectsPerRq &objsPerRqInThread0 = mSceneManager->_getTmpVisibleObjectsList()[0];
         const size_t actualMaxRq = std::min( maxRq, objsPerRqInThread0.size() );
         for( size_t rqId = minRq; rqId <= actualMaxRq; ++rqId )
@@ -180,6 +333,28 @@ namespace Ogre
                 localAabbScalar.mCenter = node->_getDerivedPosition();
                 localAabbScalar.mHalfSize = node->_getDerivedScale() * 0.5f;
 
+                BinVolume volume;
+                {
+                    const Quaternion scalarOrientation = node->_getDerivedOrientation();
+                    for( uint32 k = 0u; k < 8u; ++k )
+                    {
+                        const Vector3 corner(
+                            ( k & 0x01u ) ? localAabbScalar.mHalfSize.x : -localAabbScalar.mHalfSize.x,
+                            ( k & 0x02u ) ? localAabbScalar.mHalfSize.y : -localAabbScalar.mHalfSize.y,
+                            ( k & 0x04u ) ? localAabbScalar.mHalfSize.z : -localAabbScalar.mHalfSize.z );
+                        volume.vertices[k] = localAabbScalar.mCenter + scalarOrientation * corner;
+                    }
+                    volume.numVertices = 8u;
+                }
+
+                TileRange range;
+                if( !getTileRange( tilePlanes, volume, range ) )
+                {
+                    offsetStart += numFloat4PerObj;
+                    ++itor;
+                    continue;
+                }
+
                 ArrayQuaternion objOrientation;
                 objOrientation.setAll( node->_getDerivedOrientation() );
 
@@ -204,88 +379,71 @@ namespace Ogre
 
                 objOrientation = objOrientation.Inverse();
 
-                for( size_t j = 0; j < numPackedFrustumsPerSlice; ++j )
+                for( size_t y = range.minY; y <= range.maxY; ++y )
                 {
-                    const FrustumRegion *RESTRICT_ALIAS frustumRegion =
-                        mFrustumRegions.get() + frustumStartIdx + j;
-
-                    ArrayReal dotResult;
-                    ArrayMaskR mask;
-                    ArrayVector3 newPlaneNormal;
-
-                    newPlaneNormal = objOrientation * frustumRegion->plane[0].normal;
-                    dotResult = frustumRegion->plane[0].normal.dotProduct( localObb.mCenter ) +
-                                newPlaneNormal.absDotProduct( localObb.mHalfSize );
-                    mask = Mathlib::CompareGreater( dotResult, frustumRegion->plane[0].negD );
-
-                    newPlaneNormal = objOrientation * frustumRegion->plane[1].normal;
-                    dotResult = frustumRegion->plane[1].normal.dotProduct( localObb.mCenter ) +
-                                newPlaneNormal.absDotProduct( localObb.mHalfSize );
-                    mask = Mathlib::And(
-                        mask, Mathlib::CompareGreater( dotResult, frustumRegion->plane[1].negD ) );
-
-                    newPlaneNormal = objOrientation * frustumRegion->plane[2].normal;
-                    dotResult = frustumRegion->plane[2].normal.dotProduct( localObb.mCenter ) +
-                                newPlaneNormal.absDotProduct( localObb.mHalfSize );
-                    mask = Mathlib::And(
-                        mask, Mathlib::CompareGreater( dotResult, frustumRegion->plane[2].negD ) );
-
-                    newPlaneNormal = objOrientation * frustumRegion->plane[3].normal;
-                    dotResult = frustumRegion->plane[3].normal.dotProduct( localObb.mCenter ) +
-                                newPlaneNormal.absDotProduct( localObb.mHalfSize );
-                    mask = Mathlib::And(
-                        mask, Mathlib::CompareGreater( dotResult, frustumRegion->plane[3].negD ) );
-
-                    newPlaneNormal = objOrientation * frustumRegion->plane[4].normal;
-                    dotResult = frustumRegion->plane[4].normal.dotProduct( localObb.mCenter ) +
-                                newPlaneNormal.absDotProduct( localObb.mHalfSize );
-                    mask = Mathlib::And(
-                        mask, Mathlib::CompareGreater( dotResult, frustumRegion->plane[4].negD ) );
-
-                    newPlaneNormal = objOrientation * frustumRegion->plane[5].normal;
-                    dotResult = frustumRegion->plane[5].normal.dotProduct( localObb.mCenter ) +
-                                newPlaneNormal.absDotProduct( localObb.mHalfSize );
-                    mask = Mathlib::And(
-                        mask, Mathlib::CompareGreater( dotResult, frustumRegion->plane[5].negD ) );
-
-                    if( BooleanMask4::getScalarMask( mask ) != 0 )
+                    for( size_t x = range.minX / ARRAY_PACKED_REALS;
+                         x <= range.maxX / ARRAY_PACKED_REALS; ++x )
                     {
-                        // Test all 8 frustum corners against each of the 6 obb planes.
+                        const size_t j = y * numPacksPerRow + x;
+                        const FrustumRegion *RESTRICT_ALIAS frustumRegion =
+                            mFrustumRegions.get() + frustumStartIdx + j;
+
+                        ArrayReal dotResult;
+                        ArrayMaskR mask = BooleanMask4::getAllSetMask();
+
                         for( int k = 0; k < 6; ++k )
                         {
-                            ArrayMaskR vertexMask = ARRAY_MASK_ZERO;
+                            const ArrayVector3 newPlaneNormal =
+                                objOrientation * frustumRegion->plane[k].normal;
+                            dotResult = frustumRegion->plane[k].normal.dotProduct( localObb.mCenter ) +
+                                        newPlaneNormal.absDotProduct( localObb.mHalfSize );
+                            const ArrayMaskR planeMask =
+                                Mathlib::CompareGreater( dotResult, frustumRegion->plane[k].negD );
+                            mask = Mathlib::And( mask, planeMask );
+                        }
 
-                            for( int l = 0; l < 8; ++l )
+                        if( BooleanMask4::getScalarMask( mask ) != 0 )
+                        {
+                            // Test all 8 frustum corners against each of the 6 obb planes.
+                            for( int k = 0; k < 6; ++k )
                             {
-                                dotResult = obbPlane[k].normal.dotProduct( frustumRegion->corners[l] ) -
-                                            obbPlane[k].negD;
-                                vertexMask = Mathlib::Or(
-                                    vertexMask, Mathlib::CompareGreater( dotResult, ARRAY_REAL_ZERO ) );
+                                ArrayMaskR vertexMask = ARRAY_MASK_ZERO;
+
+                                for( int l = 0; l < 8; ++l )
+                                {
+                                    dotResult =
+                                        obbPlane[k].normal.dotProduct( frustumRegion->corners[l] ) -
+                                        obbPlane[k].negD;
+                                    const ArrayMaskR isPositive =
+                                        Mathlib::CompareGreater( dotResult, ARRAY_REAL_ZERO );
+                                    vertexMask = Mathlib::Or( vertexMask, isPositive );
+                                }
+
+                                mask = Mathlib::And( mask, vertexMask );
                             }
-
-                            mask = Mathlib::And( mask, vertexMask );
                         }
-                    }
 
-                    const uint32 scalarMask = BooleanMask4::getScalarMask( mask );
+                        const uint32 columnMask = getColumnMask( x, range.minX, range.maxX );
+                        const uint32 scalarMask = BooleanMask4::getScalarMask( mask ) & columnMask;
 
-                    for( size_t k = 0; k < ARRAY_PACKED_REALS; ++k )
-                    {
-                        if( IS_BIT_SET( k, scalarMask ) )
+                        for( size_t k = 0; k < ARRAY_PACKED_REALS; ++k )
                         {
-                            const size_t idx = ( frustumStartIdx + j ) * ARRAY_PACKED_REALS + k;
-                            FastArray<LightCount>::iterator numLightsInCell =
-                                mLightCountInCell.begin() + idx;
-
-                            // assert( numLightsInCell < mLightCountInCell.end() );
-
-                            if( numLightsInCell->objCount[objType] < currObjsPerCell )
+                            if( IS_BIT_SET( k, scalarMask ) )
                             {
-                                uint16 *RESTRICT_ALIAS cellElem = mGridBuffer + idx * mObjsPerCell +
-                                                                  cellOffsetStart +
-                                                                  numLightsInCell->objCount[objType];
-                                *cellElem = offsetStart;
-                                ++numLightsInCell->objCount[objType];
+                                const size_t idx = ( frustumStartIdx + j ) * ARRAY_PACKED_REALS + k;
+                                FastArray<LightCount>::iterator numLightsInCell =
+                                    mLightCountInCell.begin() + idx;
+
+                                // assert( numLightsInCell < mLightCountInCell.end() );
+
+                                if( numLightsInCell->objCount[objType] < currObjsPerCell )
+                                {
+                                    uint16 *RESTRICT_ALIAS cellElem =
+                                        mGridBuffer + idx * mObjsPerCell + cellOffsetStart +
+                                        numLightsInCell->objCount[objType];
+                                    *cellElem = offsetStart;
+                                    ++numLightsInCell->objCount[objType];
+                                }
                             }
                         }
                     }
@@ -342,6 +500,10 @@ namespace Ogre
         const Real frustumHorizLength = ( origFrustumRight - origFrustumLeft ) / (Real)mWidth;
         const Real frustumVertLength = ( origFrustumTop - origFrustumBottom ) / (Real)mHeight;
 
+        Plane *RESTRICT_ALIAS tilePlanes = mTilePlanes.begin() + threadId * getTilePlanesStride();
+        Plane *RESTRICT_ALIAS columnPlanes = tilePlanes + 2u;
+        Plane *RESTRICT_ALIAS rowPlanes = columnPlanes + mWidth * 2u;
+
         for( size_t y = 0; y < mHeight; ++y )
         {
             const Real yStep = static_cast<Real>( y );
@@ -381,386 +543,181 @@ namespace Ogre
                         frustumRegion.plane[j].normal.setFromVector3( planes[j].normal, i );
                         Mathlib::Set( frustumRegion.plane[j].negD, -planes[j].d, i );
                     }
+
+                    // All cells in the same column share the same left & right planes, and all
+                    // cells in the same row share the same top & bottom planes. See getTileRange.
+                    if( y == 0u )
+                    {
+                        const size_t column = x * ARRAY_PACKED_REALS + i;
+                        columnPlanes[column * 2u + 0u] = planes[FRUSTUM_PLANE_LEFT];
+                        columnPlanes[column * 2u + 1u] = planes[FRUSTUM_PLANE_RIGHT];
+                    }
+                    if( x == 0u && i == 0u )
+                    {
+                        rowPlanes[y * 2u + 0u] = planes[FRUSTUM_PLANE_TOP];
+                        rowPlanes[y * 2u + 1u] = planes[FRUSTUM_PLANE_BOTTOM];
+                        if( y == 0u )
+                        {
+                            tilePlanes[0] = planes[FRUSTUM_PLANE_NEAR];
+                            tilePlanes[1] = planes[FRUSTUM_PLANE_FAR];
+                        }
+                    }
                 }
             }
         }
 
-        const size_t numPackedFrustumsPerSlice = ( mWidth / ARRAY_PACKED_REALS ) * mHeight;
+#if OGRE_NO_VIEWPORT_ORIENTATIONMODE == 0
+        if( mCurrentCamera->getOrientationMode() != OR_DEGREE_0 )
+        {
+            // Rows & columns no longer share planes. Use planes that never reject anything.
+            const Plane neverOutside( Vector3::ZERO, Real( 1 ) );
+            for( size_t i = 0u; i < ( mWidth + mHeight ) * 2u; ++i )
+                columnPlanes[i] = neverOutside;
+        }
+#endif
+
+        const size_t numPacksPerRow = mWidth / ARRAY_PACKED_REALS;
+        const size_t numPackedFrustumsPerSlice = numPacksPerRow * mHeight;
 
         // Initialize light counts to 0
         silent_memset( mLightCountInCell.begin() + frustumStartIdx * ARRAY_PACKED_REALS, 0,
                        numPackedFrustumsPerSlice * ARRAY_PACKED_REALS * sizeof( LightCount ) );
 
         const size_t numLights = mCurrentLightList.size();
-        LightArray::const_iterator itLight = mCurrentLightList.begin();
 
-        // Test all lights against every frustum in this slice.
+        // Test all lights against the cells of this slice they may touch.
         for( size_t i = 0; i < numLights; ++i )
         {
-            const Light::LightTypes lightType = ( *itLight )->getType();
+            const BinVolume &volume = mLightVolumes[i];
 
-            if( lightType == Light::LT_POINT || lightType == Light::LT_VPL )
+            TileRange range;
+            if( !getTileRange( tilePlanes, volume, range ) )
+                continue;
+
+            const Light::LightTypes lightType = mCurrentLightList[i]->getType();
+
+            if( !volume.numVertices )
             {
-                // Perform 6 planes vs sphere intersection then frustum's AABB vs sphere.
-                // to rule out very big spheres behind the frustum (false positives).
+                // Point light. Perform 6 planes vs sphere intersection then frustum's AABB vs
+                // sphere, to rule out very big spheres behind the frustum (false positives).
                 // There's still a few false positives in some edge case, but it's still very good.
                 // See http://www.iquilezles.org/www/articles/frustumcorrect/frustumcorrect.htm
-
-                Vector3 scalarLightPos = ( *itLight )->getParentNode()->_getDerivedPosition();
                 ArrayVector3 lightPos;
                 ArrayReal lightRadius;
-                lightPos.setAll( scalarLightPos );
-                lightRadius = Mathlib::SetAll( ( *itLight )->getAttenuationRange() );
+                lightPos.setAll( volume.center );
+                lightRadius = Mathlib::SetAll( volume.radius );
 
                 ArraySphere sphere( lightRadius, lightPos );
 
-                for( size_t j = 0; j < numPackedFrustumsPerSlice; ++j )
-                {
-                    const FrustumRegion *RESTRICT_ALIAS frustumRegion =
-                        mFrustumRegions.get() + frustumStartIdx + j;
-
-                    // Test all 6 planes and AND the dot product. If one is false, then we're not visible
-                    // We perform (both lines are equivalent):
-                    //  plane[i].normal.dotProduct( lightPos ) + plane[i].d > -radius;
-                    //  plane[i].normal.dotProduct( lightPos ) + radius > -plane[i].d;
-                    ArrayReal dotResult;
-                    ArrayMaskR mask;
-
-                    dotResult = frustumRegion->plane[0].normal.dotProduct( lightPos ) + lightRadius;
-                    mask = Mathlib::CompareGreater( dotResult, frustumRegion->plane[0].negD );
-
-                    dotResult = frustumRegion->plane[1].normal.dotProduct( lightPos ) + lightRadius;
-                    mask = Mathlib::And(
-                        mask, Mathlib::CompareGreater( dotResult, frustumRegion->plane[1].negD ) );
-
-                    dotResult = frustumRegion->plane[2].normal.dotProduct( lightPos ) + lightRadius;
-                    mask = Mathlib::And(
-                        mask, Mathlib::CompareGreater( dotResult, frustumRegion->plane[2].negD ) );
-
-                    dotResult = frustumRegion->plane[3].normal.dotProduct( lightPos ) + lightRadius;
-                    mask = Mathlib::And(
-                        mask, Mathlib::CompareGreater( dotResult, frustumRegion->plane[3].negD ) );
-
-                    dotResult = frustumRegion->plane[4].normal.dotProduct( lightPos ) + lightRadius;
-                    mask = Mathlib::And(
-                        mask, Mathlib::CompareGreater( dotResult, frustumRegion->plane[4].negD ) );
-
-                    dotResult = frustumRegion->plane[5].normal.dotProduct( lightPos ) + lightRadius;
-                    mask = Mathlib::And(
-                        mask, Mathlib::CompareGreater( dotResult, frustumRegion->plane[5].negD ) );
-
-                    // Test the frustum's AABB vs sphere. If they don't intersect, we're not visible.
-                    ArrayMaskR aabbVsSphere = sphere.intersects( frustumRegion->aabb );
-
-                    mask = Mathlib::And( mask, aabbVsSphere );
-
-                    const uint32 scalarMask = BooleanMask4::getScalarMask( mask );
-
-                    for( size_t k = 0; k < ARRAY_PACKED_REALS; ++k )
-                    {
-                        if( IS_BIT_SET( k, scalarMask ) )
-                        {
-                            const size_t idx = ( frustumStartIdx + j ) * ARRAY_PACKED_REALS + k;
-                            FastArray<LightCount>::iterator numLightsInCell =
-                                mLightCountInCell.begin() + idx;
-
-                            // assert( numLightsInCell < mLightCountInCell.end() );
-
-                            if( numLightsInCell->lightCount[0] < mLightsPerCell )
-                            {
-                                uint16 *RESTRICT_ALIAS cellElem =
-                                    mGridBuffer + idx * mObjsPerCell +
-                                    ( numLightsInCell->lightCount[0] + c_reservedLightSlotsPerCell );
-                                *cellElem = static_cast<uint16>( i * c_ForwardPlusNumFloat4PerLight );
-                                ++numLightsInCell->lightCount[0];
-                                ++numLightsInCell->lightCount[lightType];
-                            }
-                        }
-                    }
-                }
-            }
-            else if( ( *itLight )->getSpotlightTanHalfAngle() <= 1.0f )
-            {
-                // Spotlight. Do pyramid vs frustum intersection. This pyramid
-                // has 5 sides and encloses the spotlight's cone.
-                // See www.yosoygames.com.ar/wp/2016/12/
-                // frustum-vs-pyramid-intersection-also-frustum-vs-frustum/
-
-                Node *lightNode = ( *itLight )->getParentNode();
-
-                // Generate the 5 pyramid vertices
-                const Real lightRange = ( *itLight )->getAttenuationRange();
-                const Real lenOpposite = ( *itLight )->getSpotlightTanHalfAngle() * lightRange;
-
-                const Quaternion lightRot = lightNode->_getDerivedOrientation();
-
-                const Vector3 leftCorner = lightRot * Vector3( -lenOpposite, lenOpposite, 0 );
-                const Vector3 rightCorner = lightRot * Vector3( lenOpposite, lenOpposite, 0 );
-
-                const Vector3 scalarLightPos = ( *itLight )->getParentNode()->_getDerivedPosition();
-                const Vector3 scalarLightDir = ( *itLight )->getDerivedDirection() * lightRange;
-
-                Plane scalarPlane[6];
-
-                scalarPlane[FRUSTUM_PLANE_FAR] =
-                    Plane( scalarLightPos + scalarLightDir + leftCorner, scalarLightPos + scalarLightDir,
-                           scalarLightPos + scalarLightDir + rightCorner );
-                scalarPlane[FRUSTUM_PLANE_NEAR] =
-                    Plane( -scalarPlane[FRUSTUM_PLANE_FAR].normal, scalarLightPos );
-
-                scalarPlane[FRUSTUM_PLANE_LEFT] =
-                    Plane( scalarLightPos + scalarLightDir - rightCorner,
-                           scalarLightPos + scalarLightDir + leftCorner, scalarLightPos );
-                scalarPlane[FRUSTUM_PLANE_RIGHT] =
-                    Plane( scalarLightPos + scalarLightDir + rightCorner,
-                           scalarLightPos + scalarLightDir - leftCorner, scalarLightPos );
-
-                scalarPlane[FRUSTUM_PLANE_TOP] =
-                    Plane( scalarLightPos + scalarLightDir + leftCorner,
-                           scalarLightPos + scalarLightDir + rightCorner, scalarLightPos );
-                scalarPlane[FRUSTUM_PLANE_BOTTOM] =
-                    Plane( scalarLightPos + scalarLightDir - leftCorner,
-                           scalarLightPos + scalarLightDir - rightCorner, scalarLightPos );
-
-                ArrayPlane pyramidPlane[6];
-                pyramidPlane[0].normal.setAll( scalarPlane[0].normal );
-                pyramidPlane[0].negD = Mathlib::SetAll( -scalarPlane[0].d );
-                pyramidPlane[1].normal.setAll( scalarPlane[1].normal );
-                pyramidPlane[1].negD = Mathlib::SetAll( -scalarPlane[1].d );
-                pyramidPlane[2].normal.setAll( scalarPlane[2].normal );
-                pyramidPlane[2].negD = Mathlib::SetAll( -scalarPlane[2].d );
-                pyramidPlane[3].normal.setAll( scalarPlane[3].normal );
-                pyramidPlane[3].negD = Mathlib::SetAll( -scalarPlane[3].d );
-                pyramidPlane[4].normal.setAll( scalarPlane[4].normal );
-                pyramidPlane[4].negD = Mathlib::SetAll( -scalarPlane[4].d );
-                pyramidPlane[5].normal.setAll( scalarPlane[5].normal );
-                pyramidPlane[5].negD = Mathlib::SetAll( -scalarPlane[5].d );
-
-                ArrayVector3 pyramidVertex[5];
-
-                pyramidVertex[0].setAll( scalarLightPos );
-                pyramidVertex[1].setAll( scalarLightPos + scalarLightDir + leftCorner );
-                pyramidVertex[2].setAll( scalarLightPos + scalarLightDir + rightCorner );
-                pyramidVertex[3].setAll( scalarLightPos + scalarLightDir - leftCorner );
-                pyramidVertex[4].setAll( scalarLightPos + scalarLightDir - rightCorner );
-
-                for( size_t j = 0; j < numPackedFrustumsPerSlice; ++j )
+                for( size_t y = range.minY; y <= range.maxY; ++y )
                 {
-                    const FrustumRegion *RESTRICT_ALIAS frustumRegion =
-                        mFrustumRegions.get() + frustumStartIdx + j;
-
-                    ArrayReal dotResult;
-                    ArrayMaskR mask;
-
-                    mask = BooleanMask4::getAllSetMask();
-
-                    // There is no intersection if for at least one of the 12 planes
-                    //(6+6) all the vertices (5+8 verts.) are on the negative side.
-
-                    // Test all 5 pyramid vertices against each of the 6 frustum planes.
-                    for( int k = 0; k < 6; ++k )
+                    for( size_t x = range.minX / ARRAY_PACKED_REALS;
+                         x <= range.maxX / ARRAY_PACKED_REALS; ++x )
                     {
-                        ArrayMaskR vertexMask = ARRAY_MASK_ZERO;
-
-                        for( int l = 0; l < 5; ++l )
-                        {
-                            dotResult = frustumRegion->plane[k].normal.dotProduct( pyramidVertex[l] ) -
-                                        frustumRegion->plane[k].negD;
-                            vertexMask = Mathlib::Or(
-                                vertexMask, Mathlib::CompareGreater( dotResult, ARRAY_REAL_ZERO ) );
-                        }
-
-                        mask = Mathlib::And( mask, vertexMask );
-                    }
-
-                    if( BooleanMask4::getScalarMask( mask ) != 0 )
-                    {
-                        // Test all 8 frustum corners against each of the 6 pyramid planes.
+                        const size_t j = y * numPacksPerRow + x;
+                        const FrustumRegion *RESTRICT_ALIAS frustumRegion =
+                            mFrustumRegions.get() + frustumStartIdx + j;
+
+                        // Test all 6 planes and AND the dot product. If one is false, then we're
+                        // not visible. We perform (both lines are equivalent):
+                        //  plane[i].normal.dotProduct( lightPos ) + plane[i].d > -radius;
+                        //  plane[i].normal.dotProduct( lightPos ) + radius > -plane[i].d;
+                        ArrayMaskR mask = BooleanMask4::getAllSetMask();
                         for( int k = 0; k < 6; ++k )
                         {
-                            ArrayMaskR vertexMask = ARRAY_MASK_ZERO;
-
-                            for( int l = 0; l < 8; ++l )
-                            {
-                                dotResult =
-                                    pyramidPlane[k].normal.dotProduct( frustumRegion->corners[l] ) -
-                                    pyramidPlane[k].negD;
-                                vertexMask = Mathlib::Or(
-                                    vertexMask, Mathlib::CompareGreater( dotResult, ARRAY_REAL_ZERO ) );
-                            }
-
-                            mask = Mathlib::And( mask, vertexMask );
+                            const ArrayReal dotResult =
+                                frustumRegion->plane[k].normal.dotProduct( lightPos ) + lightRadius;
+                            const ArrayMaskR planeMask =
+                                Mathlib::CompareGreater( dotResult, frustumRegion->plane[k].negD );
+                            mask = Mathlib::And( mask, planeMask );
                         }
-                    }
-
-                    const uint32 scalarMask = BooleanMask4::getScalarMask( mask );
-
-                    for( size_t k = 0; k < ARRAY_PACKED_REALS; ++k )
-                    {
-                        if( IS_BIT_SET( k, scalarMask ) )
-                        {
-                            const size_t idx = ( frustumStartIdx + j ) * ARRAY_PACKED_REALS + k;
-                            FastArray<LightCount>::iterator numLightsInCell =
-                                mLightCountInCell.begin() + idx;
 
-                            // assert( numLightsInCell < mLightCountInCell.end() );
+                        // Test the frustum's AABB vs sphere. If they don't intersect, we're not
+                        // visible.
+                        mask = Mathlib::And( mask, sphere.intersects( frustumRegion->aabb ) );
 
-                            if( numLightsInCell->lightCount[0] < mLightsPerCell )
-                            {
-                                uint16 *RESTRICT_ALIAS cellElem =
-                                    mGridBuffer + idx * mObjsPerCell +
-                                    ( numLightsInCell->lightCount[0] + c_reservedLightSlotsPerCell );
-                                *cellElem = static_cast<uint16>( i * c_ForwardPlusNumFloat4PerLight );
-                                ++numLightsInCell->lightCount[0];
-                                ++numLightsInCell->lightCount[lightType];
-                            }
-                        }
+                        const uint32 columnMask = getColumnMask( x, range.minX, range.maxX );
+                        const uint32 scalarMask = BooleanMask4::getScalarMask( mask ) & columnMask;
+                        addLightToCells( frustumStartIdx + j, scalarMask, i, lightType );
                     }
                 }
             }
             else
             {
-                // Spotlight with outer angle > 90°. tan(45°) starts growing too large very quickly,
-                // yet the spotlight's light reach is limited by its radius, causing the "false"
-                // positives to blow up (they're not technically false positives because light is
-                // infinite, but for practical purposes, they are).
-                // Just doing the OBB that encloses the spotlight is much more conservative.
-
-                Node *lightNode = ( *itLight )->getParentNode();
-
-                // Generate the 6 OBB vertices
-                const Real lightRange = ( *itLight )->getAttenuationRange();
-                const Real lenOpposite = ( *itLight )->getSpotlightSinHalfAngle() * lightRange;
-
-                const Quaternion lightRot = lightNode->_getDerivedOrientation();
-
-                const Vector3 bottomLeftCorner = lightRot * Vector3( -lenOpposite, -lenOpposite, 0 );
-                const Vector3 topRightCorner = -bottomLeftCorner;
-
-                const Vector3 scalarLightPos = ( *itLight )->getParentNode()->_getDerivedPosition();
-                const Vector3 scalarLightDir = ( *itLight )->getDerivedDirection() * lightRange;
-
-                Plane scalarPlane[6];
-
-                scalarPlane[FRUSTUM_PLANE_FAR] =
-                    Plane( lightRot.zAxis(), scalarLightPos + scalarLightDir );
-                scalarPlane[FRUSTUM_PLANE_NEAR] =
-                    Plane( -scalarPlane[FRUSTUM_PLANE_FAR].normal, scalarLightPos );
-
-                scalarPlane[FRUSTUM_PLANE_LEFT] =
-                    Plane( lightRot.xAxis(), scalarLightPos + bottomLeftCorner );
-                scalarPlane[FRUSTUM_PLANE_RIGHT] =
-                    Plane( -scalarPlane[FRUSTUM_PLANE_LEFT].normal, scalarLightPos + topRightCorner );
-
-                scalarPlane[FRUSTUM_PLANE_TOP] =
-                    Plane( -lightRot.yAxis(), scalarLightPos + topRightCorner );
-                scalarPlane[FRUSTUM_PLANE_BOTTOM] =
-                    Plane( -scalarPlane[FRUSTUM_PLANE_TOP].normal, scalarLightPos + bottomLeftCorner );
-
-                ArrayPlane obbPlane[6];
-                obbPlane[0].normal.setAll( scalarPlane[0].normal );
-                obbPlane[0].negD = Mathlib::SetAll( -scalarPlane[0].d );
-                obbPlane[1].normal.setAll( scalarPlane[1].normal );
-                obbPlane[1].negD = Mathlib::SetAll( -scalarPlane[1].d );
-                obbPlane[2].normal.setAll( scalarPlane[2].normal );
-                obbPlane[2].negD = Mathlib::SetAll( -scalarPlane[2].d );
-                obbPlane[3].normal.setAll( scalarPlane[3].normal );
-                obbPlane[3].negD = Mathlib::SetAll( -scalarPlane[3].d );
-                obbPlane[4].normal.setAll( scalarPlane[4].normal );
-                obbPlane[4].negD = Mathlib::SetAll( -scalarPlane[4].d );
-                obbPlane[5].normal.setAll( scalarPlane[5].normal );
-                obbPlane[5].negD = Mathlib::SetAll( -scalarPlane[5].d );
-
-                const Vector3 topLeftCorner = lightRot * Vector3( -lenOpposite, lenOpposite, 0 );
-                const Vector3 bottomRightCorner = -topLeftCorner;
-
-                ArrayVector3 obbVertex[8];
-
-                obbVertex[0].setAll( scalarLightPos + bottomLeftCorner );
-                obbVertex[0].setAll( scalarLightPos + topRightCorner );
-                obbVertex[1].setAll( scalarLightPos + scalarLightDir + bottomLeftCorner );
-                obbVertex[2].setAll( scalarLightPos + scalarLightDir + topRightCorner );
-
-                obbVertex[3].setAll( scalarLightPos + topLeftCorner );
-                obbVertex[4].setAll( scalarLightPos + bottomRightCorner );
-                obbVertex[5].setAll( scalarLightPos + scalarLightDir + topLeftCorner );
-                obbVertex[6].setAll( scalarLightPos + scalarLightDir + bottomRightCorner );
-
-                for( size_t j = 0; j < numPackedFrustumsPerSlice; ++j )
+                // Spotlight. Do convex hull vs frustum intersection. See prepareLightVolumes
+                // and www.yosoygames.com.ar/wp/2016/12/
+                // frustum-vs-pyramid-intersection-also-frustum-vs-frustum/
+                ArrayPlane hullPlane[6];
+                for( int k = 0; k < 6; ++k )
                 {
-                    const FrustumRegion *RESTRICT_ALIAS frustumRegion =
-                        mFrustumRegions.get() + frustumStartIdx + j;
-
-                    ArrayReal dotResult;
-                    ArrayMaskR mask;
-
-                    mask = BooleanMask4::getAllSetMask();
+                    hullPlane[k].normal.setAll( volume.planes[k].normal );
+                    hullPlane[k].negD = Mathlib::SetAll( -volume.planes[k].d );
+                }
 
-                    // There is no intersection if for at least one of the 12 planes
-                    //(6+6) all the vertices (8+8 verts.) are on the negative side.
+                const uint32 numVertices = volume.numVertices;
+                ArrayVector3 hullVertex[8];
+                for( uint32 l = 0; l < numVertices; ++l )
+                    hullVertex[l].setAll( volume.vertices[l] );
 
-                    // Test all 8 obb vertices against each of the 6 frustum planes.
-                    for( int k = 0; k < 6; ++k )
+                for( size_t y = range.minY; y <= range.maxY; ++y )
+                {
+                    for( size_t x = range.minX / ARRAY_PACKED_REALS;
+                         x <= range.maxX / ARRAY_PACKED_REALS; ++x )
                     {
-                        ArrayMaskR vertexMask = ARRAY_MASK_ZERO;
+                        const size_t j = y * numPacksPerRow + x;
+                        const FrustumRegion *RESTRICT_ALIAS frustumRegion =
+                            mFrustumRegions.get() + frustumStartIdx + j;
 
-                        for( int l = 0; l < 8; ++l )
-                        {
-                            dotResult = frustumRegion->plane[k].normal.dotProduct( obbVertex[l] ) -
-                                        frustumRegion->plane[k].negD;
-                            vertexMask = Mathlib::Or(
-                                vertexMask, Mathlib::CompareGreater( dotResult, ARRAY_REAL_ZERO ) );
-                        }
+                        ArrayReal dotResult;
+                        ArrayMaskR mask = BooleanMask4::getAllSetMask();
 
-                        mask = Mathlib::And( mask, vertexMask );
-                    }
+                        // There is no intersection if for at least one of the 12 planes
+                        //(6+6) all the vertices (5+8 or 8+8 verts.) are on the negative side.
 
-                    if( BooleanMask4::getScalarMask( mask ) != 0 )
-                    {
-                        // Test all 8 frustum corners against each of the 6 obb planes.
+                        // Test all hull vertices against each of the 6 frustum planes.
                         for( int k = 0; k < 6; ++k )
                         {
                             ArrayMaskR vertexMask = ARRAY_MASK_ZERO;
 
-                            for( int l = 0; l < 8; ++l )
+                            for( uint32 l = 0; l < numVertices; ++l )
                             {
-                                dotResult = obbPlane[k].normal.dotProduct( frustumRegion->corners[l] ) -
-                                            obbPlane[k].negD;
+                                dotResult =
+                                    frustumRegion->plane[k].normal.dotProduct( hullVertex[l] ) -
+                                    frustumRegion->plane[k].negD;
                                 vertexMask = Mathlib::Or(
                                     vertexMask, Mathlib::CompareGreater( dotResult, ARRAY_REAL_ZERO ) );
                             }
 
                             mask = Mathlib::And( mask, vertexMask );
                         }
-                    }
 
-                    const uint32 scalarMask = BooleanMask4::getScalarMask( mask );
-
-                    for( size_t k = 0; k < ARRAY_PACKED_REALS; ++k )
-                    {
-                        if( IS_BIT_SET( k, scalarMask ) )
+                        if( BooleanMask4::getScalarMask( mask ) != 0 )
                         {
-                            const size_t idx = ( frustumStartIdx + j ) * ARRAY_PACKED_REALS + k;
-                            FastArray<LightCount>::iterator numLightsInCell =
-                                mLightCountInCell.begin() + idx;
-
-                            // assert( numLightsInCell < mLightCountInCell.end() );
-
-                            if( numLightsInCell->lightCount[0] < mLightsPerCell )
+                            // Test all 8 frustum corners against each of the 6 hull planes.
+                            for( int k = 0; k < 6; ++k )
                             {
-                                uint16 *RESTRICT_ALIAS cellElem =
-                                    mGridBuffer + idx * mObjsPerCell +
-                                    ( numLightsInCell->lightCount[0] + c_reservedLightSlotsPerCell );
-                                *cellElem = static_cast<uint16>( i * c_ForwardPlusNumFloat4PerLight );
-                                ++numLightsInCell->lightCount[0];
-                                ++numLightsInCell->lightCount[lightType];
+                                ArrayMaskR vertexMask = ARRAY_MASK_ZERO;
+
+                                for( int l = 0; l < 8; ++l )
+                                {
+                                    dotResult =
+                                        hullPlane[k].normal.dotProduct( frustumRegion->corners[l] ) -
+                                        hullPlane[k].negD;
+                                    const ArrayMaskR isPositive =
+                                        Mathlib::CompareGreater( dotResult, ARRAY_REAL_ZERO );
+                                    vertexMask = Mathlib::Or( vertexMask, isPositive );
+                                }
+
+                                mask = Mathlib::And( mask, vertexMask );
                             }
                         }
+
+                        const uint32 columnMask = getColumnMask( x, range.minX, range.maxX );
+                        const uint32 scalarMask = BooleanMask4::getScalarMask( mask ) & columnMask;
+                        addLightToCells( frustumStartIdx + j, scalarMask, i, lightType );
                     }
                 }
             }
-
-            ++itLight;
         }
 
         const bool hasDecals = mDecalsEnabled;
@@ -770,14 +727,14 @@ namespace Ogre
 
         const VisibleObjectsPerRq &objsPerRqInThread0 = mSceneManager->_getTmpVisibleObjectsList()[0];
         const size_t actualMaxDecalRq = std::min<size_t>( MaxDecalRq, objsPerRqInThread0.size() );
-        collectObjsForSlice( numPackedFrustumsPerSlice, frustumStartIdx, mDecalFloat4Offset, MinDecalRq,
+        collectObjsForSlice( tilePlanes, frustumStartIdx, mDecalFloat4Offset, MinDecalRq,
                              actualMaxDecalRq, mDecalsPerCell,
                              decalOffsetStart + c_reservedDecalsSlotsPerCell, ObjType_Decal,
                              (uint16)c_ForwardPlusNumFloat4PerDecal );
 
         const size_t actualMaxCubemapProbeRq =
             std::min<size_t>( MaxCubemapProbeRq, objsPerRqInThread0.size() );
-        collectObjsForSlice( numPackedFrustumsPerSlice, frustumStartIdx, mCubemapProbeFloat4Offset,
+        collectObjsForSlice( tilePlanes, frustumStartIdx, mCubemapProbeFloat4Offset,
                              MinCubemapProbeRq, actualMaxCubemapProbeRq, mCubemapProbesPerCell,
                              cubemapOffsetStart + c_reservedCubemapProbeSlotsPerCell,
                              ObjType_CubemapProbe, (uint16)c_ForwardPlusNumFloat4PerCubemapProbe );
@@ -822,6 +779,110 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void ForwardClustered::prepareLightVolumes()
+    {
+        const size_t numLights = mCurrentLightList.size();
+        mLightVolumes.resize( numLights );
+
+        for( size_t i = 0; i < numLights; ++i )
+        {
+            const Light *light = mCurrentLightList[i];
+            BinVolume &volume = mLightVolumes[i];
+
+            const Vector3 scalarLightPos = light->getParentNode()->_getDerivedPosition();
+            const Real lightRange = light->getAttenuationRange();
+
+            volume.center = scalarLightPos;
+            volume.radius = lightRange;
+            volume.numVertices = 0u;
+
+            const Light::LightTypes lightType = light->getType();
+            if( lightType == Light::LT_POINT || lightType == Light::LT_VPL )
+                continue;
+
+            const Quaternion lightRot = light->getParentNode()->_getDerivedOrientation();
+            const Vector3 scalarLightDir = light->getDerivedDirection() * lightRange;
+
+            Plane *RESTRICT_ALIAS scalarPlane = volume.planes;
+
+            if( light->getSpotlightTanHalfAngle() <= 1.0f )
+            {
+                // Spotlight. Do pyramid vs frustum intersection. This pyramid
+                // has 5 sides and encloses the spotlight's cone.
+                const Real lenOpposite = light->getSpotlightTanHalfAngle() * lightRange;
+
+                const Vector3 leftCorner = lightRot * Vector3( -lenOpposite, lenOpposite, 0 );
+                const Vector3 rightCorner = lightRot * Vector3( lenOpposite, lenOpposite, 0 );
+
+                scalarPlane[FRUSTUM_PLANE_FAR] =
+                    Plane( scalarLightPos + scalarLightDir + leftCorner, scalarLightPos + scalarLightDir,
+                           scalarLightPos + scalarLightDir + rightCorner );
+                scalarPlane[FRUSTUM_PLANE_NEAR] =
+                    Plane( -scalarPlane[FRUSTUM_PLANE_FAR].normal, scalarLightPos );
+
+                scalarPlane[FRUSTUM_PLANE_LEFT] =
+                    Plane( scalarLightPos + scalarLightDir - rightCorner,
+                           scalarLightPos + scalarLightDir + leftCorner, scalarLightPos );
+                scalarPlane[FRUSTUM_PLANE_RIGHT] =
+                    Plane( scalarLightPos + scalarLightDir + rightCorner,
+                           scalarLightPos + scalarLightDir - leftCorner, scalarLightPos );
+
+                scalarPlane[FRUSTUM_PLANE_TOP] =
+                    Plane( scalarLightPos + scalarLightDir + leftCorner,
+                           scalarLightPos + scalarLightDir + rightCorner, scalarLightPos );
+                scalarPlane[FRUSTUM_PLANE_BOTTOM] =
+                    Plane( scalarLightPos + scalarLightDir - leftCorner,
+                           scalarLightPos + scalarLightDir - rightCorner, scalarLightPos );
+
+                volume.vertices[0] = scalarLightPos;
+                volume.vertices[1] = scalarLightPos + scalarLightDir + leftCorner;
+                volume.vertices[2] = scalarLightPos + scalarLightDir + rightCorner;
+                volume.vertices[3] = scalarLightPos + scalarLightDir - leftCorner;
+                volume.vertices[4] = scalarLightPos + scalarLightDir - rightCorner;
+                volume.numVertices = 5u;
+            }
+            else
+            {
+                // Spotlight with outer angle > 90°. tan(45°) starts growing too large very quickly,
+                // yet the spotlight's light reach is limited by its radius, causing the "false"
+                // positives to blow up (they're not technically false positives because light is
+                // infinite, but for practical purposes, they are).
+                // Just doing the OBB that encloses the spotlight is much more conservative.
+                const Real lenOpposite = light->getSpotlightSinHalfAngle() * lightRange;
+
+                const Vector3 bottomLeftCorner = lightRot * Vector3( -lenOpposite, -lenOpposite, 0 );
+                const Vector3 topRightCorner = -bottomLeftCorner;
+                const Vector3 topLeftCorner = lightRot * Vector3( -lenOpposite, lenOpposite, 0 );
+                const Vector3 bottomRightCorner = -topLeftCorner;
+
+                scalarPlane[FRUSTUM_PLANE_FAR] =
+                    Plane( lightRot.zAxis(), scalarLightPos + scalarLightDir );
+                scalarPlane[FRUSTUM_PLANE_NEAR] =
+                    Plane( -scalarPlane[FRUSTUM_PLANE_FAR].normal, scalarLightPos );
+
+                scalarPlane[FRUSTUM_PLANE_LEFT] =
+                    Plane( lightRot.xAxis(), scalarLightPos + bottomLeftCorner );
+                scalarPlane[FRUSTUM_PLANE_RIGHT] =
+                    Plane( -scalarPlane[FRUSTUM_PLANE_LEFT].normal, scalarLightPos + topRightCorner );
+
+                scalarPlane[FRUSTUM_PLANE_TOP] =
+                    Plane( -lightRot.yAxis(), scalarLightPos + topRightCorner );
+                scalarPlane[FRUSTUM_PLANE_BOTTOM] =
+                    Plane( -scalarPlane[FRUSTUM_PLANE_TOP].normal, scalarLightPos + bottomLeftCorner );
+
+                volume.vertices[0] = scalarLightPos + bottomLeftCorner;
+                volume.vertices[1] = scalarLightPos + topRightCorner;
+                volume.vertices[2] = scalarLightPos + scalarLightDir + bottomLeftCorner;
+                volume.vertices[3] = scalarLightPos + scalarLightDir + topRightCorner;
+                volume.vertices[4] = scalarLightPos + topLeftCorner;
+                volume.vertices[5] = scalarLightPos + bottomRightCorner;
+                volume.vertices[6] = scalarLightPos + scalarLightDir + topLeftCorner;
+                volume.vertices[7] = scalarLightPos + scalarLightDir + bottomRightCorner;
+                volume.numVertices = 8u;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
     inline bool OrderObjsByDistanceToCamera( const MovableObject *left, const MovableObject *right )
     {
         return left->getCachedDistanceToCameraAsReal() < right->getCachedDistanceToCameraAsReal();
@@ -958,6 +1019,9 @@ namespace Ogre
         // Sort by distance to camera
         std::sort( mCurrentLightList.begin(), mCurrentLightList.end(), OrderLightByDistanceToCamera );
 
+        // Build the bounding volumes once. All slices test against them.
+        prepareLightVolumes();
+
         // Allocate the buffers if not already.
         CachedGridBuffer &gridBuffers = cachedGrid->gridBuffers[cachedGrid->currentBufIdx];
         if( !gridBuffers.gridBuffer )
@@ -1027,8 +1091,8 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     size_t ForwardClustered::getConstBufferSize() const
     {
-        // (4 (vec4) + vec4 fwdScreenToGrid) * 4 bytes = 16
-        return ( 4 + 4 ) * 4;
+        // (4 (vec4) + vec4 fwdScreenToGrid + vec4 fwdSliceDepths[]) * 4 bytes = 16
+        return ( 4 + 4 + getNumSliceDepthsFloat4() * 4u ) * 4;
     }
     //-----------------------------------------------------------------------------------
     void ForwardClustered::fillConstBufferData( Viewport *viewport, bool bRequiresTextureFlipping,
@@ -1067,6 +1131,14 @@ namespace Ogre
         *passBufferPtr++ = static_cast<float>( mHeight ) / viewportHeight;
         *passBufferPtr++ = viewportWidthOffset;
         *passBufferPtr++ = viewportHeightOffset;
+
+        // vec4 fwdSliceDepths[]
+        const size_t numSliceDepths = mSliceDepths.size();
+        const size_t numSliceDepthsPadded = getNumSliceDepthsFloat4() * 4u;
+        for( size_t i = 0u; i < numSliceDepths; ++i )
+            *passBufferPtr++ = mSliceDepths[i];
+        for( size_t i = numSliceDepths; i < numSliceDepthsPadded; ++i )
+            *passBufferPtr++ = std::numeric_limits<float>::max();
     }
     //-----------------------------------------------------------------------------------
     void ForwardClustered::setHlmsPassProperties( const size_t tid, Hlms *hlms )
@@ -1081,6 +1153,11 @@ namespace Ogre
         hlms->_setProperty( tid, HlmsBaseProp::FwdClusteredWidth, static_cast<int32>( mWidth ) );
         hlms->_setProperty( tid, HlmsBaseProp::FwdClusteredLightsPerCell,
                             static_cast<int32>( mObjsPerCell ) );
+        if( !mSliceDepths.empty() )
+        {
+            hlms->_setProperty( tid, HlmsBaseProp::FwdClusteredSliceDepths,
+                                static_cast<int32>( getNumSliceDepthsFloat4() ) );
+        }
 
         if( mDecalsEnabled )
         {
@@ -1118,6 +1195,37 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void ForwardClustered::setSliceDepths( const FastArray<float> &sliceDepths )
+    {
+        if( !sliceDepths.empty() )
+        {
+            if( sliceDepths.size() != mNumSlices - 1u )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "sliceDepths must contain exactly getNumSlices() - 1 = " +
+                                 StringConverter::toString( mNumSlices - 1u ) + " values",
+                             "ForwardClustered::setSliceDepths" );
+            }
+
+            float prevDepth = 0.0f;
+            FastArray<float>::const_iterator itor = sliceDepths.begin();
+            FastArray<float>::const_iterator endt = sliceDepths.end();
+            while( itor != endt )
+            {
+                if( !( *itor > prevDepth ) )
+                {
+                    OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                                 "sliceDepths must be positive and strictly increasing",
+                                 "ForwardClustered::setSliceDepths" );
+                }
+                prevDepth = *itor;
+                ++itor;
+            }
+        }
+
+        mSliceDepths = sliceDepths;
+    }
+    //-----------------------------------------------------------------------------------
     void ForwardClustered::setDebugFrustum( bool bEnableDebugFrustumWireAabb )
     {
         if( bEnableDebugFrustumWireAabb )
@@ -76,6 +76,8 @@ namespace Ogre
         return mNextResidencyStatus;
     }
     //-----------------------------------------------------------------------------------
+    void GpuResource::_touch() const { mLastFrameUsed = mVaoManager->getFrameCount(); }
+    //-----------------------------------------------------------------------------------
     GpuPageOutStrategy::GpuPageOutStrategy GpuResource::getGpuPageOutStrategy() const
     {
         return mPageOutStrategy;
@@ -92,8 +92,10 @@ namespace Ogre
     const IdString HlmsBaseProp::Pose = IdString( "hlms_pose" );
     const IdString HlmsBaseProp::PoseHalfPrecision = IdString( "hlms_pose_half" );
     const IdString HlmsBaseProp::PoseNormals = IdString( "hlms_pose_normals" );
+    const IdString HlmsBaseProp::PreSkinned = IdString( "hlms_pre_skinned" );
 
     const IdString HlmsBaseProp::Normal = IdString( "hlms_normal" );
+    const IdString HlmsBaseProp::NormalOct = IdString( "hlms_normal_oct" );
     const IdString HlmsBaseProp::QTangent = IdString( "hlms_qtangent" );
     const IdString HlmsBaseProp::Tangent = IdString( "hlms_tangent" );
     const IdString HlmsBaseProp::Tangent4 = IdString( "hlms_tangent4" );
@@ -171,6 +173,7 @@ namespace Ogre
     const IdString HlmsBaseProp::FwdClusteredWidthxHeight = IdString( "fwd_clustered_width_x_height" );
     const IdString HlmsBaseProp::FwdClusteredWidth = IdString( "fwd_clustered_width" );
     const IdString HlmsBaseProp::FwdClusteredLightsPerCell = IdString( "fwd_clustered_lights_per_cell" );
+    const IdString HlmsBaseProp::FwdClusteredSliceDepths = IdString( "fwd_clustered_slice_depths" );
     const IdString HlmsBaseProp::EnableDecals = IdString( "hlms_enable_decals" );
     const IdString HlmsBaseProp::FwdPlusDecalsSlotOffset =
         IdString( "hlms_forwardplus_decals_slot_offset" );
@@ -3016,6 +3019,8 @@ namespace Ogre
             if( v1::VertexElement::getTypeCount( type ) < 4 )
             {
                 setProperty( kNoTid, HlmsBaseProp::Normal, 1 );
+                if( v1::VertexElement::getTypeCount( type ) == 2 )
+                    setProperty( kNoTid, HlmsBaseProp::NormalOct, 1 );
             }
             else
             {
@@ -3125,7 +3130,9 @@ namespace Ogre
 
         mT[kNoTid].setProperties.clear();
 
-        setProperty( kNoTid, HlmsBaseProp::Skeleton, renderable->hasSkeletonAnimation() );
+        const bool preSkinned = renderable->getPreSkinnedBuffer() != 0;
+        setProperty( kNoTid, HlmsBaseProp::Skeleton, renderable->hasSkeletonAnimation() && !preSkinned );
+        setProperty( kNoTid, HlmsBaseProp::PreSkinned, preSkinned );
 
         setProperty( kNoTid, HlmsBaseProp::Pose, renderable->getNumPoses() );
         setProperty( kNoTid, HlmsBaseProp::PoseHalfPrecision, renderable->getPoseHalfPrecision() );
@@ -3158,6 +3165,7 @@ namespace Ogre
 
         // For shadow casters, turn normals off. UVs & diffuse also off unless there's alpha testing.
         setProperty( kNoTid, HlmsBaseProp::Normal, 0 );
+        setProperty( kNoTid, HlmsBaseProp::NormalOct, 0 );
         setProperty( kNoTid, HlmsBaseProp::QTangent, 0 );
         setProperty( kNoTid, HlmsBaseProp::AlphaBlend,
                      datablock->getBlendblock( true )->isAutoTransparent() );
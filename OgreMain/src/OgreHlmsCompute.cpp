@@ -545,7 +545,20 @@ namespace Ogre
         }
 
         if( job->mTexturesDescSet )
+        {
             mRenderSystem->_setTexturesCS( job->getGlTexSlotStart(), job->mTexturesDescSet );
+
+            FastArray<DescriptorSetTexture2::Slot>::const_iterator itTex =
+                job->mTexturesDescSet->mTextures.begin();
+            FastArray<DescriptorSetTexture2::Slot>::const_iterator enTex =
+                job->mTexturesDescSet->mTextures.end();
+            while( itTex != enTex )
+            {
+                if( itTex->isTexture() && itTex->getTexture().texture )
+                    itTex->getTexture().texture->_touch();
+                ++itTex;
+            }
+        }
         if( job->mSamplersDescSet )
             mRenderSystem->_setSamplersCS( job->getGlTexSlotStart(), job->mSamplersDescSet );
         if( job->mUavsDescSet )
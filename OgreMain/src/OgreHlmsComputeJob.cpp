@@ -1253,7 +1253,7 @@ namespace Ogre
                     solver.resolveTransition( resourceTransitions, tex, ResourceLayout::Uav,
                                               itor->getTexture().access, 1u << GPT_COMPUTE_PROGRAM );
                 }
-                else
+                else if( itor->getBuffer().buffer )
                 {
                     const DescriptorSetUav::BufferSlot &bufferSlot = itor->getBuffer();
                     solver.resolveTransition( resourceTransitions, bufferSlot.buffer, bufferSlot.access,
@@ -31,17 +31,20 @@ Copyright (c) 2000-2014 Torus Knot Software Ltd
 #include "OgreItem.h"
 
 #include "Animation/OgreSkeletonInstance.h"
+#include "Compute/OgreComputeSkinning.h"
 #include "OgreException.h"
 #include "OgreHlmsManager.h"
 #include "OgreLogManager.h"
 #include "OgreMesh2.h"
 #include "OgreMeshManager.h"
 #include "OgreMeshManager2.h"
+#include "OgreRay.h"
 #include "OgreRoot.h"
 #include "OgreSceneManager.h"
 #include "OgreSceneNode.h"
 #include "OgreSubItem.h"
 #include "OgreSubMesh2.h"
+#include "OgreTriangleBvh.h"
 
 namespace Ogre
 {
@@ -67,9 +70,12 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void Item::loadingComplete( Resource *res )
     {
-        if( res == mMesh.get() && mInitialised )
+        if( res == mMesh.get() )
         {
-            _initialise( true );
+            if( mInitialised )
+                _initialise( true );
+            else if( mMesh->isBackgroundLoaded() )
+                _initialise();  // Deferred loading (e.g. MeshManager::loadAsync) is done
         }
     }
     //-----------------------------------------------------------------------
@@ -140,6 +146,9 @@ namespace Ogre
         if( !mInitialised )
             return;
 
+        if( mManager && mManager->getComputeSkinning() )
+            mManager->getComputeSkinning()->removeItem( this );
+
         // Delete submeshes
         mSubItems.clear();
         mRenderables.clear();
@@ -183,6 +192,35 @@ namespace Ogre
     //-----------------------------------------------------------------------
     size_t Item::getNumSubItems() const { return mSubItems.size(); }
     //-----------------------------------------------------------------------
+    bool Item::raycast( const Ray &ray, Real maxDistance, TriangleRayHit &outHit,
+                        size_t &outSubMeshIdx, bool positiveSide, bool negativeSide )
+    {
+        if( !mInitialised || !mParentNode )
+            return false;
+
+        // Take the ray to object space. The direction isn't normalised so
+        // that distances along the ray are the same in both spaces.
+        const Matrix4 invWorld = mParentNode->_getFullTransform().inverseAffine();
+        const Ray localRay( invWorld.transformAffine( ray.getOrigin() ),
+                            invWorld.transformDirectionAffine( ray.getDirection() ) );
+
+        bool bHit = false;
+
+        const unsigned numSubMeshes = mMesh->getNumSubMeshes();
+        for( unsigned i = 0; i < numSubMeshes; ++i )
+        {
+            const TriangleBvh *bvh = mMesh->getSubMesh( i )->getTriangleBvh();
+            if( bvh && bvh->raycast( localRay, maxDistance, positiveSide, negativeSide, outHit ) )
+            {
+                maxDistance = outHit.distance;
+                outSubMeshIdx = i;
+                bHit = true;
+            }
+        }
+
+        return bHit;
+    }
+    //-----------------------------------------------------------------------
     void Item::setDatablock( HlmsDatablock *datablock )
     {
         for( SubItem &subitem : mSubItems )
@@ -327,6 +365,37 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------
+    void Item::setAnimateUnskinnedBones( bool bAnimate )
+    {
+        if( !mSkeletonInstance )
+            return;
+
+        if( bAnimate )
+        {
+            mSkeletonInstance->setSkinnedBones( 0 );
+            return;
+        }
+
+        FastArray<unsigned short> skinnedBones;
+        for( const SubItem &subitem : mSubItems )
+        {
+            if( !subitem.hasSkeletonAnimation() )
+                continue;
+
+            const RenderableAnimated::IndexMap *indexMap = subitem.getBlendIndexToBoneIndexMap();
+            if( !indexMap || indexMap->empty() )
+            {
+                // Blend indices are bone indices; we'd have to look at the vertex data
+                mSkeletonInstance->setSkinnedBones( 0 );
+                return;
+            }
+
+            skinnedBones.appendPOD( indexMap->begin(), indexMap->end() );
+        }
+
+        mSkeletonInstance->setSkinnedBones( &skinnedBones );
+    }
+    //-----------------------------------------------------------------------
     void Item::_notifyParentNodeMemoryChanged()
     {
         if( mSkeletonInstance /*&& !mSharedTransformEntity*/ )
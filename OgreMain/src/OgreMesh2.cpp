@@ -40,6 +40,7 @@ THE SOFTWARE.
 #include "OgreMesh2Serializer.h"
 #include "OgreMeshManager.h"
 #include "OgreMeshManager2.h"
+#include "OgreMeshOptimizer.h"
 #include "OgreMovableObject.h"
 #include "OgreOldSkeletonManager.h"
 #include "OgreOptimisedUtil.h"
@@ -163,6 +164,16 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void Mesh::unprepareImpl() { mFreshFromDisk.reset(); }
     //-----------------------------------------------------------------------
+    void Mesh::_notifyPreparedData( const DataStreamPtr &data )
+    {
+        if( mLoadingState.get() != LOADSTATE_UNLOADED )
+            return;
+
+        mFreshFromDisk = data;
+        if( !mLoadingState.cas( LOADSTATE_UNLOADED, LOADSTATE_PREPARED ) )
+            mFreshFromDisk.reset();
+    }
+    //-----------------------------------------------------------------------
     void Mesh::loadImpl()
     {
         OgreProfileExhaustive( "Mesh2::loadImpl" );
@@ -183,6 +194,20 @@ namespace Ogre
 
         serializer.importMesh( data, this );
 
+        MeshManager &meshManager = MeshManager::getSingleton();
+
+        // Compress first, so that the optimizer can merge vertices that became identical
+        const MeshManager::VertexCompression &vertexCompression = meshManager.getVertexCompression();
+        if( vertexCompression.isEnabled() )
+        {
+            arrangeEfficient( vertexCompression.halfPos, vertexCompression.halfTexCoords,
+                              vertexCompression.qTangents, vertexCompression.octahedralNormals );
+        }
+
+        const uint32 optimizationFlags = meshManager.getOptimizationFlags();
+        if( optimizationFlags )
+            MeshOptimizer::optimize( this, optimizationFlags );
+
         if( mHashForCaches[0] == 0u && mHashForCaches[1] == 0u && Mesh::msUseTimestampAsHash )
         {
             try
@@ -561,10 +586,11 @@ namespace Ogre
         setToLoaded();
     }
     //---------------------------------------------------------------------
-    void Mesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents )
+    void Mesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                                 bool octahedralNormals )
     {
         for( SubMesh *submesh : mSubMeshes )
-            submesh->arrangeEfficient( halfPos, halfTexCoords, qTangents );
+            submesh->arrangeEfficient( halfPos, halfTexCoords, qTangents, octahedralNormals );
     }
     //---------------------------------------------------------------------
     void Mesh::dearrangeToInefficient()
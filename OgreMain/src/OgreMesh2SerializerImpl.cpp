@@ -61,7 +61,9 @@ namespace Ogre
     /// stream overhead = ID + size
     const long MSTREAM_OVERHEAD_SIZE = sizeof( uint16 ) + sizeof( uint32 );
     //---------------------------------------------------------------------
-    MeshSerializerImpl::MeshSerializerImpl( VaoManager *vaoManager ) : mVaoManager( vaoManager )
+    MeshSerializerImpl::MeshSerializerImpl( VaoManager *vaoManager ) :
+        mVaoManager( vaoManager ),
+        mUploadBatch( vaoManager )
     {
         // Version number
         mVersion = "[MeshSerializer_v2.1 R2]";
@@ -80,34 +82,7 @@ namespace Ogre
         // Decide on endian mode
         determineEndianness( endianMode );
 
-        // Check that the mesh has it's bounds set
-
-        if( pMesh->getAabb().mHalfSize == Vector3::ZERO || pMesh->getBoundingSphereRadius() == 0.0f )
-        {
-            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
-                         "The Mesh you have supplied does not have its"
-                         " bounds completely defined. Define them first before exporting.",
-                         "MeshSerializerImpl::exportMesh" );
-        }
-        mStream = stream;
-        if( !mStream->isWriteable() )
-        {
-            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
-                         "Unable to use stream " + mStream->getName() + " for writing",
-                         "MeshSerializerImpl::exportMesh" );
-        }
-
-        for( unsigned i = 0; i < pMesh->getNumSubMeshes(); ++i )
-        {
-            if( pMesh->getSubMesh( i )->mVao[VpNormal].empty() )
-            {
-                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
-                             "The Mesh you have supplied does not have all"
-                             " of its submeshes properfly initialized. Initialize their vertex buffers "
-                             "before exporting.",
-                             "MeshSerializerImpl::exportMesh" );
-            }
-        }
+        validateForExport( pMesh, stream );
 
         writeFileHeader();
         LogManager::getSingleton().logMessage( "File header written." );
@@ -134,54 +109,102 @@ namespace Ogre
         readFileHeader( stream );
         pushInnerChunk( stream );
         uint16 streamID;
-        while( !stream->eof() )
+        try
         {
-            streamID = readChunk( stream );
-            switch( streamID )
+            while( !stream->eof() )
             {
-            case M_MESH:
-                readMesh( stream, pMesh, listener );
-                break;
+                streamID = readChunk( stream );
+                switch( streamID )
+                {
+                case M_MESH:
+                    readMesh( stream, pMesh, listener );
+                    break;
+                }
             }
         }
+        catch( Exception & )
+        {
+            mUploadBatch.discardPending();
+            throw;
+        }
         popInnerChunk( stream );
 
+        // Upload the data of all submeshes & LODs at once
+        mUploadBatch.flush();
+
         if( !pMesh->hasValidShadowMappingVaos() )
             pMesh->prepareForShadowMapping( false );
     }
     //---------------------------------------------------------------------
-    void MeshSerializerImpl::writeMesh( const Mesh *pMesh )
+    void MeshSerializerImpl::validateForExport( const Mesh *pMesh, DataStreamPtr &stream )
     {
-        exportedLodCount = 1;  // generate edge data for original mesh
+        // Check that the mesh has it's bounds set
+        if( pMesh->getAabb().mHalfSize == Vector3::ZERO || pMesh->getBoundingSphereRadius() == 0.0f )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "The Mesh you have supplied does not have its"
+                         " bounds completely defined. Define them first before exporting.",
+                         "MeshSerializerImpl::exportMesh" );
+        }
+        mStream = stream;
+        if( !mStream->isWriteable() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Unable to use stream " + mStream->getName() + " for writing",
+                         "MeshSerializerImpl::exportMesh" );
+        }
 
-        LodLevelVertexBufferTableVec lodVertexTable;
-        lodVertexTable.resize( pMesh->getNumSubMeshes() );
+        for( unsigned i = 0; i < pMesh->getNumSubMeshes(); ++i )
+        {
+            if( pMesh->getSubMesh( i )->mVao[VpNormal].empty() )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "The Mesh you have supplied does not have all"
+                             " of its submeshes properfly initialized. Initialize their vertex buffers "
+                             "before exporting.",
+                             "MeshSerializerImpl::exportMesh" );
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::buildLodVertexTable( const Mesh                   *pMesh,
+                                                  LodLevelVertexBufferTableVec &outLodVertexTable )
+    {
+        outLodVertexTable.resize( pMesh->getNumSubMeshes() );
 
         for( unsigned i = 0; i < pMesh->getNumSubMeshes(); ++i )
         {
             const SubMesh *s = pMesh->getSubMesh( i );
 
             size_t numLodLevels = s->mVao[VpNormal].size();
-            lodVertexTable[i].reserve( numLodLevels );
-            lodVertexTable[i].push_back( 0 );
+            outLodVertexTable[i].reserve( numLodLevels );
+            outLodVertexTable[i].push_back( 0 );
 
             for( uint8 lodLevel = 1; lodLevel < numLodLevels; ++lodLevel )
             {
-                for( uint8 j = 0; j < lodLevel && lodVertexTable[i].size() == lodLevel; ++j )
+                for( uint8 j = 0; j < lodLevel && outLodVertexTable[i].size() == lodLevel; ++j )
                 {
                     // Find if a previous LOD already uses these vertex buffers.
                     if( s->mVao[VpNormal][lodLevel]->getVertexBuffers() ==
                         s->mVao[VpNormal][j]->getVertexBuffers() )
                     {
-                        lodVertexTable[i].push_back( j );
+                        outLodVertexTable[i].push_back( j );
                     }
                 }
 
                 // Couldn't find a previous LOD sharing the vertex buffer with us.
-                if( lodVertexTable[i].size() == lodLevel )
-                    lodVertexTable[i].push_back( lodLevel );
+                if( outLodVertexTable[i].size() == lodLevel )
+                    outLodVertexTable[i].push_back( lodLevel );
             }
         }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeMesh( const Mesh *pMesh )
+    {
+        exportedLodCount = 1;  // generate edge data for original mesh
+
+        LodLevelVertexBufferTableVec lodVertexTable;
+        buildLodVertexTable( pMesh, lodVertexTable );
 
         // Header
         writeChunkHeader( M_MESH, calcMeshSize( pMesh, lodVertexTable ) );
@@ -941,11 +964,21 @@ namespace Ogre
             {
                 if( subMeshLod.vertexDeclarations.size() == 1 )
                 {
+                    const BufferType bufferType = sm->mParent->getVertexBufferDefaultType();
+                    const bool bBatchUpload =
+                        bufferType == BT_DEFAULT && !sm->mParent->isVertexBufferShadowed();
+
                     VertexBufferPacked *vertexBuffer = mVaoManager->createVertexBuffer(
-                        subMeshLod.vertexDeclarations[0], subMeshLod.numVertices,
-                        sm->mParent->getVertexBufferDefaultType(), subMeshLod.vertexBuffers[0],
+                        subMeshLod.vertexDeclarations[0], subMeshLod.numVertices, bufferType,
+                        bBatchUpload ? 0 : subMeshLod.vertexBuffers[0],
                         sm->mParent->isVertexBufferShadowed() );
 
+                    if( bBatchUpload )
+                    {
+                        mUploadBatch.enqueue( vertexBuffer, 0, subMeshLod.numVertices,
+                                              subMeshLod.vertexBuffers[0] );
+                    }
+
                     if( !sm->mParent->isVertexBufferShadowed() )
                     {
                         OGRE_FREE_SIMD( submeshLods[i].vertexBuffers[0], MEMCATEGORY_GEOMETRY );
@@ -987,10 +1020,17 @@ namespace Ogre
             IndexBufferPacked *indexBuffer = 0;
             if( subMeshLod.indexData )
             {
+                const BufferType bufferType = sm->mParent->getIndexBufferDefaultType();
+                const bool bBatchUpload =
+                    bufferType == BT_DEFAULT && !sm->mParent->isIndexBufferShadowed();
+
                 indexBuffer = mVaoManager->createIndexBuffer(
                     subMeshLod.index32Bit ? IndexBufferPacked::IT_32BIT : IndexBufferPacked::IT_16BIT,
-                    subMeshLod.numIndices, sm->mParent->getIndexBufferDefaultType(),
-                    subMeshLod.indexData, sm->mParent->isIndexBufferShadowed() );
+                    subMeshLod.numIndices, bufferType, bBatchUpload ? 0 : subMeshLod.indexData,
+                    sm->mParent->isIndexBufferShadowed() );
+
+                if( bBatchUpload )
+                    mUploadBatch.enqueue( indexBuffer, 0, subMeshLod.numIndices, subMeshLod.indexData );
 
                 if( !sm->mParent->isIndexBufferShadowed() )
                 {
@@ -0,0 +1,841 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreMesh2SerializerImpl.h"
+
+#include "OgreBitwise.h"
+#include "OgreCommon.h"
+#include "OgreException.h"
+#include "OgreLogManager.h"
+#include "OgreMesh2.h"
+#include "OgreMesh2Serializer.h"
+#include "OgreProfiler.h"
+#include "OgreSubMesh2.h"
+#include "Vao/OgreAsyncTicket.h"
+#include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreStagingBuffer.h"
+#include "Vao/OgreTexBufferPacked.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+namespace Ogre
+{
+    // File layout:
+    //  uint16 HEADER_STREAM_ID
+    //  "[MeshSerializer_v2.1 Flat]\n"
+    //  Padding up to 16 bytes
+    //  Mesh2FlatHeader
+    //  Metadata: submesh, LOD & name tables; bone maps, vertex declarations, LOD values
+    //            and null-terminated strings. Referenced by offset from the start of the file.
+    //  Padding up to 16 bytes
+    //  Blob: vertex, index & pose data, each buffer aligned to 16 bytes.
+    //        Referenced by offset from the start of the blob.
+    static const uint32 c_flatMeshMagic = 0x46324D4F;  // "OM2F" in little endian
+    static const uint32 c_flatMeshMagicSwapped = 0x4F4D3246;
+    static const size_t c_flatMeshAlignment = 16u;
+
+    struct Mesh2FlatHeader
+    {
+        uint32 magic;
+        uint32 headerSize;
+        uint32 numSubMeshes;
+        uint32 subMeshTableOffset;
+        uint32 numSubMeshLods;
+        uint32 subMeshLodTableOffset;
+        uint32 numSubMeshNames;
+        uint32 subMeshNameTableOffset;
+        uint32 numLodValues;
+        uint32 lodValuesOffset;
+        uint32 lodStrategyName;
+        /// 0 if there is no skeleton
+        uint32 skeletonName;
+        uint8  numVaoPasses;
+        uint8  padding[3];
+        float  aabbCenter[3];
+        float  aabbHalfSize[3];
+        float  boundingSphereRadius;
+        uint64 hashForCaches[2];
+        uint64 blobOffset;
+        uint64 blobSize;
+    };
+
+    enum Mesh2FlatPoseFlags
+    {
+        FlatPoseHalfPrecision = 1u << 0u,
+        FlatPoseNormals = 1u << 1u
+    };
+
+    struct Mesh2FlatSubMesh
+    {
+        uint32 materialName;
+        uint32 boneMapOffset;
+        /// Index of the first entry in the LOD table.
+        /// There are numVaoPasses * numLodLevels consecutive entries.
+        uint32 firstLod;
+        uint16 numBoneMapEntries;
+        uint8  numLodLevels;
+        uint8  padding;
+        /// numPoses offsets to the name of each pose, in pose order. 0 if a pose has no name
+        uint32 poseNameTableOffset;
+        uint16 numPoses;
+        /// See Mesh2FlatPoseFlags
+        uint8  poseFlags;
+        uint8  padding2;
+        /// Raw contents of SubMesh::getPoseTexBuffer, one pose after another.
+        /// Each vertex is a position (and a normal, if FlatPoseNormals) as 4 floats or halfs.
+        uint64 poseDataOffset;
+    };
+
+    struct Mesh2FlatSubMeshLod
+    {
+        uint64 vertexDataOffset;
+        uint64 indexDataOffset;
+        uint32 numVertices;
+        uint32 numIndices;
+        /// Pairs of uint8 (VertexElementType, VertexElementSemantic)
+        uint32 vertexDeclOffset;
+        uint8  numVertexElements;
+        /// When != LOD level, the vertex buffer of that LOD is reused
+        uint8 lodSource;
+        uint8 index32Bit;
+        uint8 operationType;
+    };
+
+    struct Mesh2FlatSubMeshName
+    {
+        uint32 name;
+        uint32 subMeshIdx;
+    };
+
+    struct OrderPendingUploadBySrcOffset
+    {
+        template <typename T>
+        bool operator()( const T &a, const T &b ) const
+        {
+            return a.srcOffset < b.srcOffset;
+        }
+    };
+    //---------------------------------------------------------------------
+    /// Appends data to the metadata section and returns its offset from the start of the file
+    static uint32 appendToMetadata( vector<uint8>::type &metadata, size_t metadataStart,
+                                    const void *data, size_t sizeBytes, size_t alignment )
+    {
+        const size_t offset = alignToNextMultiple<size_t>( metadata.size(), alignment );
+        metadata.resize( offset + sizeBytes );
+        if( sizeBytes )
+            memcpy( &metadata[offset], data, sizeBytes );
+        return static_cast<uint32>( metadataStart + offset );
+    }
+    //---------------------------------------------------------------------
+    static uint32 appendToMetadata( vector<uint8>::type &metadata, size_t metadataStart,
+                                    const String &value )
+    {
+        return appendToMetadata( metadata, metadataStart, value.c_str(), value.size() + 1u, 1u );
+    }
+    //---------------------------------------------------------------------
+    static void checkFlatRange( size_t fileSize, uint64 offset, uint64 sizeBytes,
+                                const String &meshName )
+    {
+        if( offset > fileSize || sizeBytes > fileSize - offset )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Corrupted or truncated flat mesh " + meshName,
+                         "MeshSerializerImpl_Flat::importMesh" );
+        }
+    }
+    //---------------------------------------------------------------------
+    static String readFlatString( const uint8 *data, size_t fileSize, uint32 offset,
+                                  const String &meshName )
+    {
+        checkFlatRange( fileSize, offset, 1u, meshName );
+        const char *str = reinterpret_cast<const char *>( data + offset );
+        if( !memchr( str, 0, fileSize - offset ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Corrupted or truncated flat mesh " + meshName,
+                         "MeshSerializerImpl_Flat::importMesh" );
+        }
+        return String( str );
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_Flat::MeshSerializerImpl_Flat( VaoManager *vaoManager ) :
+        MeshSerializerImpl( vaoManager )
+    {
+        // Version number
+        mVersion = "[MeshSerializer_v2.1 Flat]";
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_Flat::~MeshSerializerImpl_Flat() {}
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl_Flat::getHeaderOffset() const
+    {
+        // HEADER_STREAM_ID + version string + '\n'
+        return alignToNextMultiple<size_t>( sizeof( uint16 ) + mVersion.size() + 1u,
+                                            c_flatMeshAlignment );
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl_Flat::appendToBlob( BufferPacked *buffer, vector<uint8>::type &blob )
+    {
+        const size_t offset = alignToNextMultiple<size_t>( blob.size(), c_flatMeshAlignment );
+        const size_t sizeBytes = buffer->getTotalSizeBytes();
+        blob.resize( offset + sizeBytes );
+
+        AsyncTicketPtr asyncTicket = buffer->readRequest( 0, buffer->getNumElements() );
+        const void *data = asyncTicket->map();
+        memcpy( &blob[offset], data, sizeBytes );
+        addToHash( data, sizeBytes );
+        asyncTicket->unmap();
+
+        return offset;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_Flat::exportMesh( const Mesh *pMesh, DataStreamPtr stream,
+                                              Endian endianMode )
+    {
+        LogManager::getSingleton().logMessage( "MeshSerializer writing flat mesh data to stream " +
+                                               stream->getName() + "..." );
+
+        mCalculatedHash[0] = 0u;
+        mCalculatedHash[1] = 0u;
+
+        determineEndianness( endianMode );
+        if( mFlipEndian )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Flat meshes can only be written in native endianness",
+                         "MeshSerializerImpl_Flat::exportMesh" );
+        }
+
+        validateForExport( pMesh, stream );
+
+        LodLevelVertexBufferTableVec lodVertexTable;
+        buildLodVertexTable( pMesh, lodVertexTable );
+
+        const size_t headerOffset = getHeaderOffset();
+        const size_t metadataStart = headerOffset + sizeof( Mesh2FlatHeader );
+
+        vector<uint8>::type metadata;
+        vector<uint8>::type blob;
+
+        vector<Mesh2FlatSubMesh>::type flatSubMeshes;
+        vector<Mesh2FlatSubMeshLod>::type flatSubMeshLods;
+        flatSubMeshes.reserve( pMesh->getNumSubMeshes() );
+
+        const uint8 numVaoPasses = pMesh->hasIndependentShadowMappingVaos() + 1u;
+
+        for( unsigned i = 0; i < pMesh->getNumSubMeshes(); ++i )
+        {
+            const SubMesh *s = pMesh->getSubMesh( i );
+
+            OGRE_ASSERT_LOW( s->mBlendIndexToBoneIndexMap.size() <= std::numeric_limits<uint8>::max() );
+
+            Mesh2FlatSubMesh flatSubMesh;
+            memset( &flatSubMesh, 0, sizeof( flatSubMesh ) );
+            flatSubMesh.materialName = appendToMetadata( metadata, metadataStart, s->getMaterialName() );
+            flatSubMesh.numBoneMapEntries = static_cast<uint16>( s->mBlendIndexToBoneIndexMap.size() );
+            flatSubMesh.boneMapOffset = appendToMetadata(
+                metadata, metadataStart, s->mBlendIndexToBoneIndexMap.begin(),
+                sizeof( uint16 ) * flatSubMesh.numBoneMapEntries, sizeof( uint16 ) );
+            flatSubMesh.numLodLevels = static_cast<uint8>( s->mVao[VpNormal].size() );
+            flatSubMesh.firstLod = static_cast<uint32>( flatSubMeshLods.size() );
+
+            for( uint8 pass = 0; pass < numVaoPasses; ++pass )
+            {
+                for( uint8 lodLevel = 0; lodLevel < flatSubMesh.numLodLevels; ++lodLevel )
+                {
+                    const VertexArrayObject *vao = s->mVao[pass][lodLevel];
+
+                    Mesh2FlatSubMeshLod flatLod;
+                    memset( &flatLod, 0, sizeof( flatLod ) );
+                    flatLod.lodSource = lodVertexTable[i][lodLevel];
+                    flatLod.operationType = static_cast<uint8>( vao->getOperationType() );
+
+                    if( flatLod.lodSource == lodLevel )
+                    {
+                        const VertexBufferPackedVec &vertexBuffers = vao->getVertexBuffers();
+                        if( vertexBuffers.size() != 1u )
+                        {
+                            OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                                         "Flat meshes only support exactly one vertex buffer source "
+                                         "per Vao. Mesh: " + pMesh->getName(),
+                                         "MeshSerializerImpl_Flat::exportMesh" );
+                        }
+
+                        const VertexElement2Vec &vertexElements = vertexBuffers[0]->getVertexElements();
+                        vector<uint8>::type vertexDecl;
+                        vertexDecl.reserve( vertexElements.size() * 2u );
+                        VertexElement2Vec::const_iterator itElement = vertexElements.begin();
+                        VertexElement2Vec::const_iterator enElement = vertexElements.end();
+                        while( itElement != enElement )
+                        {
+                            vertexDecl.push_back( static_cast<uint8>( itElement->mType ) );
+                            vertexDecl.push_back( static_cast<uint8>( itElement->mSemantic ) );
+                            ++itElement;
+                        }
+
+                        flatLod.numVertexElements = static_cast<uint8>( vertexElements.size() );
+                        flatLod.vertexDeclOffset =
+                            appendToMetadata( metadata, metadataStart, &vertexDecl[0],
+                                              vertexDecl.size(), 1u );
+                        flatLod.numVertices =
+                            static_cast<uint32>( vertexBuffers[0]->getNumElements() );
+
+                        addToHash( flatLod.numVertices );
+                        addToHash( &vertexDecl[0], vertexDecl.size() );
+                        flatLod.vertexDataOffset = appendToBlob( vertexBuffers[0], blob );
+                    }
+
+                    IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+                    if( indexBuffer )
+                    {
+                        flatLod.numIndices = static_cast<uint32>( indexBuffer->getNumElements() );
+                        flatLod.index32Bit =
+                            indexBuffer->getIndexType() == IndexBufferPacked::IT_32BIT ? 1u : 0u;
+                        addToHash( flatLod.numIndices );
+                        flatLod.indexDataOffset = appendToBlob( indexBuffer, blob );
+                    }
+
+                    flatSubMeshLods.push_back( flatLod );
+                }
+            }
+
+            if( s->getNumPoses() )
+            {
+                flatSubMesh.numPoses = s->getNumPoses();
+                if( s->getPoseHalfPrecision() )
+                    flatSubMesh.poseFlags |= FlatPoseHalfPrecision;
+                if( s->getPoseNormals() )
+                    flatSubMesh.poseFlags |= FlatPoseNormals;
+                addToHash( flatSubMesh.numPoses );
+                flatSubMesh.poseDataOffset = appendToBlob( s->getPoseTexBuffer(), blob );
+
+                vector<uint32>::type poseNames( flatSubMesh.numPoses, 0u );
+                const std::map<String, size_t> &poseIndexMap = s->getPoseIndexMap();
+                std::map<String, size_t>::const_iterator itor = poseIndexMap.begin();
+                std::map<String, size_t>::const_iterator endt = poseIndexMap.end();
+                while( itor != endt )
+                {
+                    if( itor->second < poseNames.size() )
+                    {
+                        poseNames[itor->second] =
+                            appendToMetadata( metadata, metadataStart, itor->first );
+                    }
+                    ++itor;
+                }
+                flatSubMesh.poseNameTableOffset =
+                    appendToMetadata( metadata, metadataStart, &poseNames[0],
+                                      poseNames.size() * sizeof( uint32 ), sizeof( uint32 ) );
+            }
+
+            flatSubMeshes.push_back( flatSubMesh );
+        }
+
+        vector<Mesh2FlatSubMeshName>::type flatSubMeshNames;
+        {
+            const Mesh::SubMeshNameMap &subMeshNameMap = pMesh->getSubMeshNameMap();
+            Mesh::SubMeshNameMap::const_iterator itor = subMeshNameMap.begin();
+            Mesh::SubMeshNameMap::const_iterator endt = subMeshNameMap.end();
+            while( itor != endt )
+            {
+                Mesh2FlatSubMeshName flatName;
+                flatName.name = appendToMetadata( metadata, metadataStart, itor->first );
+                flatName.subMeshIdx = itor->second;
+                flatSubMeshNames.push_back( flatName );
+                ++itor;
+            }
+        }
+
+        Mesh2FlatHeader header;
+        memset( &header, 0, sizeof( header ) );
+        header.magic = c_flatMeshMagic;
+        header.headerSize = sizeof( Mesh2FlatHeader );
+        header.numVaoPasses = numVaoPasses;
+
+        header.numSubMeshes = static_cast<uint32>( flatSubMeshes.size() );
+        if( !flatSubMeshes.empty() )
+        {
+            header.subMeshTableOffset =
+                appendToMetadata( metadata, metadataStart, &flatSubMeshes[0],
+                                  flatSubMeshes.size() * sizeof( Mesh2FlatSubMesh ), 8u );
+        }
+        header.numSubMeshLods = static_cast<uint32>( flatSubMeshLods.size() );
+        if( !flatSubMeshLods.empty() )
+        {
+            header.subMeshLodTableOffset =
+                appendToMetadata( metadata, metadataStart, &flatSubMeshLods[0],
+                                  flatSubMeshLods.size() * sizeof( Mesh2FlatSubMeshLod ), 8u );
+        }
+        header.numSubMeshNames = static_cast<uint32>( flatSubMeshNames.size() );
+        if( !flatSubMeshNames.empty() )
+        {
+            header.subMeshNameTableOffset =
+                appendToMetadata( metadata, metadataStart, &flatSubMeshNames[0],
+                                  flatSubMeshNames.size() * sizeof( Mesh2FlatSubMeshName ), 8u );
+        }
+
+        header.lodStrategyName =
+            appendToMetadata( metadata, metadataStart, pMesh->getLodStrategyName() );
+        if( pMesh->mLodValues.size() > 1u )
+        {
+            header.numLodValues = static_cast<uint32>( pMesh->mLodValues.size() );
+            header.lodValuesOffset =
+                appendToMetadata( metadata, metadataStart, pMesh->mLodValues.begin(),
+                                  pMesh->mLodValues.size() * sizeof( float ), sizeof( float ) );
+        }
+        if( pMesh->hasSkeleton() )
+        {
+            header.skeletonName =
+                appendToMetadata( metadata, metadataStart, pMesh->getSkeletonName() );
+        }
+
+        const Aabb aabb = pMesh->getAabb();
+        for( size_t i = 0; i < 3u; ++i )
+        {
+            header.aabbCenter[i] = aabb.mCenter[i];
+            header.aabbHalfSize[i] = aabb.mHalfSize[i];
+        }
+        header.boundingSphereRadius = pMesh->getBoundingSphereRadius();
+
+        header.hashForCaches[0] = mCalculatedHash[0];
+        header.hashForCaches[1] = mCalculatedHash[1];
+
+        header.blobOffset =
+            alignToNextMultiple<size_t>( metadataStart + metadata.size(), c_flatMeshAlignment );
+        header.blobSize = blob.size();
+
+        const uint8 zeroes[c_flatMeshAlignment] = {};
+
+        writeFileHeader();
+        writeData( zeroes, 1u, headerOffset - ( sizeof( uint16 ) + mVersion.size() + 1u ) );
+        writeData( &header, sizeof( header ), 1u );
+        if( !metadata.empty() )
+            writeData( &metadata[0], 1u, metadata.size() );
+        writeData( zeroes, 1u, header.blobOffset - ( metadataStart + metadata.size() ) );
+        if( !blob.empty() )
+            writeData( &blob[0], 1u, blob.size() );
+
+        LogManager::getSingleton().logMessage( "MeshSerializer export successful." );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_Flat::importMesh( DataStreamPtr &stream, Mesh *pMesh,
+                                              MeshSerializerListener *listener )
+    {
+        OgreProfileExhaustive( "MeshSerializerImpl_Flat::importMesh" );
+
+        // Mesh::prepareImpl already prebuffers the whole file, in which
+        // case we can use it in place. Otherwise read it in one go.
+        MemoryDataStream *memoryStream = dynamic_cast<MemoryDataStream *>( stream.get() );
+        if( memoryStream )
+        {
+            importFromMemory( memoryStream->getPtr(), memoryStream->size(), pMesh, listener );
+        }
+        else
+        {
+            MemoryDataStream prebuffered( stream );
+            importFromMemory( prebuffered.getPtr(), prebuffered.size(), pMesh, listener );
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_Flat::importFromMemory( const uint8 *data, size_t sizeBytes, Mesh *pMesh,
+                                                    MeshSerializerListener *listener )
+    {
+        const String &meshName = pMesh->getName();
+
+        const size_t headerOffset = getHeaderOffset();
+        checkFlatRange( sizeBytes, headerOffset, sizeof( Mesh2FlatHeader ), meshName );
+
+        Mesh2FlatHeader header;
+        memcpy( &header, data + headerOffset, sizeof( header ) );
+
+        if( header.magic == c_flatMeshMagicSwapped )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Flat mesh " + meshName +
+                             " was written with a different endianness. Re-export it with "
+                             "OgreMeshTool on this platform",
+                         "MeshSerializerImpl_Flat::importMesh" );
+        }
+        if( header.magic != c_flatMeshMagic || header.headerSize != sizeof( Mesh2FlatHeader ) ||
+            ( header.numVaoPasses != 1u && header.numVaoPasses != 2u ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Invalid flat mesh header in " + meshName,
+                         "MeshSerializerImpl_Flat::importMesh" );
+        }
+
+        checkFlatRange( sizeBytes, header.subMeshTableOffset,
+                        uint64( header.numSubMeshes ) * sizeof( Mesh2FlatSubMesh ), meshName );
+        checkFlatRange( sizeBytes, header.subMeshLodTableOffset,
+                        uint64( header.numSubMeshLods ) * sizeof( Mesh2FlatSubMeshLod ), meshName );
+        checkFlatRange( sizeBytes, header.subMeshNameTableOffset,
+                        uint64( header.numSubMeshNames ) * sizeof( Mesh2FlatSubMeshName ), meshName );
+        checkFlatRange( sizeBytes, header.lodValuesOffset,
+                        uint64( header.numLodValues ) * sizeof( float ), meshName );
+        checkFlatRange( sizeBytes, header.blobOffset, header.blobSize, meshName );
+
+        const uint8 *blob = data + header.blobOffset;
+
+        pMesh->setLodStrategyName( readFlatString( data, sizeBytes, header.lodStrategyName, meshName ) );
+
+        const BufferType vertexBufferType = pMesh->getVertexBufferDefaultType();
+        const BufferType indexBufferType = pMesh->getIndexBufferDefaultType();
+        const bool vertexBufferShadowed = pMesh->isVertexBufferShadowed();
+        const bool indexBufferShadowed = pMesh->isIndexBufferShadowed();
+
+        PendingUploadVec pendingUploads;
+        VertexElement2Vec vertexElements;
+
+        for( uint32 i = 0; i < header.numSubMeshes; ++i )
+        {
+            Mesh2FlatSubMesh flatSubMesh;
+            memcpy( &flatSubMesh, data + header.subMeshTableOffset + i * sizeof( Mesh2FlatSubMesh ),
+                    sizeof( flatSubMesh ) );
+
+            if( uint64( flatSubMesh.firstLod ) + flatSubMesh.numLodLevels * header.numVaoPasses >
+                header.numSubMeshLods )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Corrupted or truncated flat mesh " + meshName,
+                             "MeshSerializerImpl_Flat::importMesh" );
+            }
+
+            SubMesh *sm = pMesh->createSubMesh();
+
+            String materialName =
+                readFlatString( data, sizeBytes, flatSubMesh.materialName, meshName );
+            if( listener )
+                listener->processMaterialName( pMesh, &materialName );
+            sm->setMaterialName( materialName );
+
+            if( flatSubMesh.numBoneMapEntries )
+            {
+                checkFlatRange( sizeBytes, flatSubMesh.boneMapOffset,
+                                flatSubMesh.numBoneMapEntries * sizeof( uint16 ), meshName );
+                sm->mBlendIndexToBoneIndexMap.resize( flatSubMesh.numBoneMapEntries );
+                memcpy( sm->mBlendIndexToBoneIndexMap.begin(), data + flatSubMesh.boneMapOffset,
+                        flatSubMesh.numBoneMapEntries * sizeof( uint16 ) );
+            }
+
+            const uint8 *boneVertexData = 0;
+            uint32 numPoseVertices = 0u;
+
+            for( uint8 pass = 0; pass < header.numVaoPasses; ++pass )
+            {
+                sm->mVao[pass].reserve( flatSubMesh.numLodLevels );
+
+                for( uint8 lodLevel = 0; lodLevel < flatSubMesh.numLodLevels; ++lodLevel )
+                {
+                    Mesh2FlatSubMeshLod flatLod;
+                    memcpy( &flatLod,
+                            data + header.subMeshLodTableOffset +
+                                ( flatSubMesh.firstLod + pass * flatSubMesh.numLodLevels +
+                                  lodLevel ) *
+                                    sizeof( Mesh2FlatSubMeshLod ),
+                            sizeof( flatLod ) );
+
+                    VertexBufferPackedVec vertexBuffers;
+
+                    if( flatLod.lodSource == lodLevel )
+                    {
+                        checkFlatRange( sizeBytes, flatLod.vertexDeclOffset,
+                                        flatLod.numVertexElements * 2u, meshName );
+                        const uint8 *vertexDecl = data + flatLod.vertexDeclOffset;
+
+                        vertexElements.clear();
+                        for( uint8 j = 0; j < flatLod.numVertexElements; ++j )
+                        {
+                            vertexElements.push_back( VertexElement2(
+                                static_cast<VertexElementType>( vertexDecl[j * 2u + 0u] ),
+                                static_cast<VertexElementSemantic>( vertexDecl[j * 2u + 1u] ) ) );
+                        }
+
+                        const size_t vertexDataSize =
+                            flatLod.numVertices * VaoManager::calculateVertexSize( vertexElements );
+                        checkFlatRange( header.blobSize, flatLod.vertexDataOffset, vertexDataSize,
+                                        meshName );
+                        const uint8 *vertexData = blob + flatLod.vertexDataOffset;
+
+                        // BT_DEFAULT buffers get their data later on, straight from the blob.
+                        // The rest need it now. If shadowed, the buffer takes ownership.
+                        const bool bDeferUpload =
+                            vertexBufferType == BT_DEFAULT && !vertexBufferShadowed;
+                        void *initialData = 0;
+                        if( vertexBufferShadowed )
+                        {
+                            initialData = OGRE_MALLOC_SIMD( vertexDataSize, MEMCATEGORY_GEOMETRY );
+                            memcpy( initialData, vertexData, vertexDataSize );
+                        }
+                        else if( !bDeferUpload )
+                        {
+                            initialData = const_cast<uint8 *>( vertexData );
+                        }
+
+                        VertexBufferPacked *vertexBuffer = mVaoManager->createVertexBuffer(
+                            vertexElements, flatLod.numVertices, vertexBufferType, initialData,
+                            vertexBufferShadowed );
+
+                        if( bDeferUpload && vertexDataSize )
+                        {
+                            PendingUpload pendingUpload;
+                            pendingUpload.buffer = vertexBuffer;
+                            pendingUpload.srcOffset = static_cast<size_t>( flatLod.vertexDataOffset );
+                            pendingUpload.length = vertexDataSize;
+                            pendingUploads.push_back( pendingUpload );
+                        }
+
+                        if( pass == 0u && lodLevel == 0u )
+                        {
+                            boneVertexData = vertexData;
+                            numPoseVertices = flatLod.numVertices;
+                        }
+
+                        vertexBuffers.push_back( vertexBuffer );
+                    }
+                    else
+                    {
+                        if( flatLod.lodSource > lodLevel )
+                        {
+                            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                                         "Corrupted or truncated flat mesh " + meshName,
+                                         "MeshSerializerImpl_Flat::importMesh" );
+                        }
+                        vertexBuffers = sm->mVao[pass][flatLod.lodSource]->getVertexBuffers();
+                    }
+
+                    IndexBufferPacked *indexBuffer = 0;
+                    if( flatLod.numIndices )
+                    {
+                        const size_t indexDataSize =
+                            flatLod.numIndices * ( flatLod.index32Bit ? sizeof( uint32 )
+                                                                       : sizeof( uint16 ) );
+                        checkFlatRange( header.blobSize, flatLod.indexDataOffset, indexDataSize,
+                                        meshName );
+                        const uint8 *indexData = blob + flatLod.indexDataOffset;
+
+                        const bool bDeferUpload = indexBufferType == BT_DEFAULT && !indexBufferShadowed;
+                        void *initialData = 0;
+                        if( indexBufferShadowed )
+                        {
+                            initialData = OGRE_MALLOC_SIMD( indexDataSize, MEMCATEGORY_GEOMETRY );
+                            memcpy( initialData, indexData, indexDataSize );
+                        }
+                        else if( !bDeferUpload )
+                        {
+                            initialData = const_cast<uint8 *>( indexData );
+                        }
+
+                        indexBuffer = mVaoManager->createIndexBuffer(
+                            flatLod.index32Bit ? IndexBufferPacked::IT_32BIT
+                                               : IndexBufferPacked::IT_16BIT,
+                            flatLod.numIndices, indexBufferType, initialData, indexBufferShadowed );
+
+                        if( bDeferUpload )
+                        {
+                            PendingUpload pendingUpload;
+                            pendingUpload.buffer = indexBuffer;
+                            pendingUpload.srcOffset = static_cast<size_t>( flatLod.indexDataOffset );
+                            pendingUpload.length = indexDataSize;
+                            pendingUploads.push_back( pendingUpload );
+                        }
+                    }
+
+                    VertexArrayObject *vao = mVaoManager->createVertexArrayObject(
+                        vertexBuffers, indexBuffer,
+                        static_cast<OperationType>( flatLod.operationType ) );
+                    sm->mVao[pass].push_back( vao );
+                }
+            }
+
+            // Populate mBoneAssignments
+            if( boneVertexData && !sm->mVao[VpNormal].empty() )
+            {
+                size_t indexSource = 0;
+                size_t unusedVar = 0;
+                if( sm->mVao[VpNormal][0]->findBySemantic( VES_BLEND_INDICES, indexSource, unusedVar ) )
+                    sm->_buildBoneAssignmentsFromVertexData( boneVertexData );
+            }
+
+            if( flatSubMesh.numPoses )
+            {
+                importPoses( data, sizeBytes, blob, header.blobSize, flatSubMesh.numPoses,
+                             flatSubMesh.poseFlags, flatSubMesh.poseDataOffset,
+                             flatSubMesh.poseNameTableOffset, numPoseVertices, sm, meshName );
+            }
+        }
+
+        if( header.skeletonName )
+        {
+            String skeletonName = readFlatString( data, sizeBytes, header.skeletonName, meshName );
+            if( listener )
+                listener->processSkeletonName( pMesh, &skeletonName );
+            pMesh->setSkeletonName( skeletonName );
+        }
+
+        if( header.numLodValues )
+        {
+            pMesh->mLodValues.clear();
+            pMesh->mLodValues.resize( header.numLodValues );
+            memcpy( pMesh->mLodValues.begin(), data + header.lodValuesOffset,
+                    header.numLodValues * sizeof( float ) );
+        }
+
+        pMesh->_setBounds( Aabb( Vector3( header.aabbCenter[0], header.aabbCenter[1],
+                                          header.aabbCenter[2] ),
+                                 Vector3( header.aabbHalfSize[0], header.aabbHalfSize[1],
+                                          header.aabbHalfSize[2] ) ),
+                           false );
+        pMesh->_setBoundingSphereRadius( header.boundingSphereRadius );
+
+        for( uint32 i = 0; i < header.numSubMeshNames; ++i )
+        {
+            Mesh2FlatSubMeshName flatName;
+            memcpy( &flatName,
+                    data + header.subMeshNameTableOffset + i * sizeof( Mesh2FlatSubMeshName ),
+                    sizeof( flatName ) );
+            pMesh->nameSubMesh( readFlatString( data, sizeBytes, flatName.name, meshName ),
+                                flatName.subMeshIdx );
+        }
+
+        pMesh->_setHashForCaches( header.hashForCaches );
+
+        uploadFromBlob( blob, pendingUploads );
+
+        if( !pMesh->hasValidShadowMappingVaos() )
+            pMesh->prepareForShadowMapping( false );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_Flat::importPoses( const uint8 *data, size_t sizeBytes, const uint8 *blob,
+                                               uint64 blobSize, uint16 numPoses, uint8 poseFlags,
+                                               uint64 poseDataOffset, uint32 poseNameTableOffset,
+                                               uint32 numVertices, SubMesh *subMesh,
+                                               const String &meshName )
+    {
+        const bool halfPrecision = ( poseFlags & FlatPoseHalfPrecision ) != 0u;
+        const bool hasNormals = ( poseFlags & FlatPoseNormals ) != 0u;
+        const size_t elementSize = halfPrecision ? sizeof( uint16 ) : sizeof( float );
+        const size_t elementsPerVertex = hasNormals ? 8u : 4u;
+        const size_t elementsPerPose = numVertices * elementsPerVertex;
+
+        checkFlatRange( blobSize, poseDataOffset, numPoses * elementsPerPose * elementSize,
+                        meshName );
+        checkFlatRange( sizeBytes, poseNameTableOffset, numPoses * sizeof( uint32 ), meshName );
+
+        // SubMesh::createPoses wants the positions & normals as 3 floats per vertex
+        vector<float>::type positions( numPoses * numVertices * 3u );
+        vector<float>::type normals( hasNormals ? positions.size() : 0u );
+        vector<uint8>::type rawPose( elementsPerPose * elementSize );
+        vector<const float *>::type positionPtrs( numPoses );
+        vector<const float *>::type normalPtrs( numPoses );
+        vector<String>::type names( numPoses );
+        bool allPosesNamed = true;
+
+        for( size_t i = 0; i < numPoses; ++i )
+        {
+            memcpy( rawPose.data(), blob + poseDataOffset + i * rawPose.size(), rawPose.size() );
+
+            float *dstPosition = positions.data() + i * numVertices * 3u;
+            float *dstNormal = hasNormals ? normals.data() + i * numVertices * 3u : 0;
+            positionPtrs[i] = dstPosition;
+            normalPtrs[i] = dstNormal;
+
+            const uint16 *srcHalf = reinterpret_cast<const uint16 *>( rawPose.data() );
+            const float *srcFloat = reinterpret_cast<const float *>( rawPose.data() );
+            for( size_t v = 0; v < numVertices; ++v )
+            {
+                for( size_t k = 0; k < 3u; ++k )
+                {
+                    const size_t idx = v * elementsPerVertex + k;
+                    *dstPosition++ =
+                        halfPrecision ? Bitwise::halfToFloat( srcHalf[idx] ) : srcFloat[idx];
+                    if( hasNormals )
+                    {
+                        *dstNormal++ = halfPrecision ? Bitwise::halfToFloat( srcHalf[idx + 4u] )
+                                                     : srcFloat[idx + 4u];
+                    }
+                }
+            }
+
+            uint32 nameOffset;
+            memcpy( &nameOffset, data + poseNameTableOffset + i * sizeof( uint32 ), sizeof( uint32 ) );
+            if( nameOffset )
+                names[i] = readFlatString( data, sizeBytes, nameOffset, meshName );
+            else
+                allPosesNamed = false;
+        }
+
+        subMesh->createPoses( &positionPtrs[0], hasNormals ? &normalPtrs[0] : 0, numPoses,
+                              numVertices, allPosesNamed ? &names[0] : 0, halfPrecision );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_Flat::uploadFromBlob( const uint8 *blob, PendingUploadVec &pendingUploads )
+    {
+        // The exporter writes the buffers in the same order we create them, thus this is
+        // normally already sorted. That's what makes it possible to copy whole ranges at once.
+        std::sort( pendingUploads.begin(), pendingUploads.end(), OrderPendingUploadBySrcOffset() );
+
+        const size_t maxStagingSize = mUploadBatch.getMaxStagingSize();
+        const size_t numPendingUploads = pendingUploads.size();
+
+        StagingBuffer::DestinationVec destinations;
+
+        size_t start = 0u;
+        while( start < numPendingUploads )
+        {
+            // Grab as many uploads as fit in maxStagingSize (at least one)
+            const size_t srcStart = pendingUploads[start].srcOffset;
+            size_t end = start + 1u;
+            while( end < numPendingUploads &&
+                   pendingUploads[end].srcOffset + pendingUploads[end].length - srcStart <=
+                       maxStagingSize )
+            {
+                ++end;
+            }
+
+            const size_t srcEnd = pendingUploads[end - 1u].srcOffset + pendingUploads[end - 1u].length;
+            const size_t sizeBytes = srcEnd - srcStart;
+
+            StagingBuffer *stagingBuffer = mVaoManager->getStagingBuffer( sizeBytes, true );
+            void *dstData = stagingBuffer->map( sizeBytes );
+            memcpy( dstData, blob + srcStart, sizeBytes );
+
+            destinations.clear();
+            destinations.reserve( end - start );
+            for( size_t i = start; i < end; ++i )
+            {
+                destinations.push_back(
+                    StagingBuffer::Destination( pendingUploads[i].buffer, 0u,
+                                                pendingUploads[i].srcOffset - srcStart,
+                                                pendingUploads[i].length ) );
+            }
+
+            stagingBuffer->unmap( destinations );
+            stagingBuffer->removeReferenceCount();
+
+            start = end;
+        }
+    }
+}  // namespace Ogre
@@ -29,18 +29,28 @@ THE SOFTWARE.
 
 #include "OgreMeshManager2.h"
 
+#include "OgreArchive.h"
 #include "OgreException.h"
+#include "OgreLogManager.h"
 #include "OgreMatrix4.h"
 #include "OgreMesh2.h"
 #include "OgreMeshManager.h"
 #include "OgrePatchMesh.h"
 #include "OgrePrefabFactory.h"
+#include "OgreProfiler.h"
+#include "OgreStringConverter.h"
 #include "OgreSubMesh2.h"
+#include "OgreTimer.h"
 
 namespace Ogre
 {
     template <>
     MeshManager *Singleton<MeshManager>::msSingleton = 0;
+
+    unsigned long updateMeshAsyncWorkerThread( ThreadHandle *threadHandle );
+    THREAD_DECLARE( updateMeshAsyncWorkerThread );
+    //-----------------------------------------------------------------------
+    MeshAsyncLoadListener::~MeshAsyncLoadListener() {}
     //-----------------------------------------------------------------------
     MeshManager *MeshManager::getSingletonPtr() { return msSingleton; }
     MeshManager &MeshManager::getSingleton()
@@ -49,7 +59,12 @@ namespace Ogre
         return ( *msSingleton );
     }
     //-----------------------------------------------------------------------
-    MeshManager::MeshManager() : mVaoManager( 0 ), mBoundsPaddingFactor( Real( 0.01 ) )
+    MeshManager::MeshManager() :
+        mVaoManager( 0 ),
+        mBoundsPaddingFactor( Real( 0.01 ) ),
+        mOptimizationFlags( 0u ),
+        mAsyncShuttingDown( false ),
+        mAsyncLoadBudgetUs( 2000u )
     {
         mLoadOrder = 300.0f;
         mResourceType = "Mesh2";
@@ -59,6 +74,13 @@ namespace Ogre
     //-----------------------------------------------------------------------
     MeshManager::~MeshManager()
     {
+        if( mAsyncWorkerThread )
+        {
+            mAsyncShuttingDown = true;
+            mAsyncWorkerEvent.wake();
+            Threads::WaitForThreads( 1u, &mAsyncWorkerThread );
+        }
+
         ResourceGroupManager::getSingleton()._unregisterResourceManager( mResourceType );
     }
     //-----------------------------------------------------------------------
@@ -112,6 +134,247 @@ namespace Ogre
         return pMesh;
     }
     //-----------------------------------------------------------------------
+    MeshPtr MeshManager::loadAsync( const String &filename, const String &groupName,
+                                    MeshAsyncLoadListener *listener, BufferType vertexBufferType,
+                                    BufferType indexBufferType, bool vertexBufferShadowed,
+                                    bool indexBufferShadowed )
+    {
+        MeshPtr pMesh = std::static_pointer_cast<Mesh>(
+            createOrRetrieve( filename, groupName, false, 0, 0, vertexBufferType, indexBufferType,
+                              vertexBufferShadowed, indexBufferShadowed )
+                .first );
+
+        AsyncLoadRequestMap::iterator itor = mAsyncLoadRequests.find( pMesh.get() );
+        if( itor != mAsyncLoadRequests.end() )
+        {
+            // Already on its way
+            if( listener )
+                itor->second.listeners.push_back( listener );
+            return pMesh;
+        }
+
+        if( pMesh->isLoaded() )
+        {
+            if( listener )
+                listener->meshLoadCompleted( pMesh.get(), true );
+            return pMesh;
+        }
+
+        AsyncLoadRequest loadRequest;
+        loadRequest.mesh = pMesh;
+        if( listener )
+            loadRequest.listeners.push_back( listener );
+        mAsyncLoadRequests[pMesh.get()] = loadRequest;
+
+        // Prevent regular load() calls from loading it synchronously behind our back
+        pMesh->setBackgroundLoaded( true );
+
+        AsyncFileRequest fileRequest;
+        fileRequest.mesh = pMesh.get();
+        fileRequest.archive = 0;
+        fileRequest.name = pMesh->getName();
+
+        if( pMesh->getLoadingState() == Resource::LOADSTATE_PREPARED )
+        {
+            // Already in memory. Nothing for the worker thread to do
+            mAsyncMainResults.push_back( fileRequest );
+            return pMesh;
+        }
+
+        // Resolve the Archive here, ResourceGroupManager is not meant to be used
+        // from other threads. Reading from the Archive itself is fine.
+        try
+        {
+            ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+            String group = pMesh->getGroup();
+            if( group == ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME )
+                group = resourceGroupManager.findGroupContainingResource( fileRequest.name );
+            fileRequest.archive =
+                resourceGroupManager._getArchiveToResource( fileRequest.name, group, true );
+        }
+        catch( Exception &e )
+        {
+            fileRequest.error = e.getFullDescription();
+            mAsyncMainResults.push_back( fileRequest );
+            return pMesh;
+        }
+
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        if( !mAsyncWorkerThread )
+        {
+            mAsyncWorkerThread =
+                Threads::CreateThread( THREAD_GET( updateMeshAsyncWorkerThread ), 0, this );
+        }
+#endif
+
+        mAsyncMutex.lock();
+        mAsyncFileRequests.push_back( fileRequest );
+        mAsyncMutex.unlock();
+
+        mAsyncWorkerEvent.wake();
+
+        return pMesh;
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::waitForAsyncLoads()
+    {
+        const uint32 oldBudget = mAsyncLoadBudgetUs;
+        mAsyncLoadBudgetUs = std::numeric_limits<uint32>::max();
+
+        while( !mAsyncLoadRequests.empty() )
+        {
+            _update();
+            if( !mAsyncLoadRequests.empty() )
+                Threads::Sleep( 1 );
+        }
+
+        mAsyncLoadBudgetUs = oldBudget;
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::processAsyncFileRequests()
+    {
+        mAsyncMutex.lock();
+        mAsyncWorkerRequests.swap( mAsyncFileRequests );
+        mAsyncMutex.unlock();
+
+        AsyncFileRequestVec::iterator itor = mAsyncWorkerRequests.begin();
+        AsyncFileRequestVec::iterator endt = mAsyncWorkerRequests.end();
+
+        while( itor != endt )
+        {
+            try
+            {
+                DataStreamPtr stream = itor->archive->open( itor->name );
+                itor->data = DataStreamPtr( OGRE_NEW MemoryDataStream( itor->name, stream ) );
+            }
+            catch( Exception &e )
+            {
+                itor->error = e.getFullDescription();
+            }
+            ++itor;
+        }
+
+        if( !mAsyncWorkerRequests.empty() )
+        {
+            mAsyncMutex.lock();
+            mAsyncFileResults.insert( mAsyncFileResults.end(), mAsyncWorkerRequests.begin(),
+                                      mAsyncWorkerRequests.end() );
+            mAsyncMutex.unlock();
+            mAsyncWorkerRequests.clear();
+        }
+    }
+    //-----------------------------------------------------------------------
+    unsigned long updateMeshAsyncWorkerThread( ThreadHandle *threadHandle )
+    {
+        Threads::SetThreadName( threadHandle, "MeshAsync" );
+
+        MeshManager *meshManager = reinterpret_cast<MeshManager *>( threadHandle->getUserParam() );
+        return meshManager->_updateAsyncWorkerThread( threadHandle );
+    }
+    //-----------------------------------------------------------------------
+    unsigned long MeshManager::_updateAsyncWorkerThread( ThreadHandle *threadHandle )
+    {
+        while( !mAsyncShuttingDown )
+        {
+            mAsyncWorkerEvent.wait();
+            processAsyncFileRequests();
+        }
+
+        return 0;
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::finishAsyncLoad( AsyncFileRequest &fileRequest )
+    {
+        AsyncLoadRequestMap::iterator itor = mAsyncLoadRequests.find( fileRequest.mesh );
+        OGRE_ASSERT_LOW( itor != mAsyncLoadRequests.end() );
+
+        // Keep it alive until we're done, even if it gets removed from the manager
+        AsyncLoadRequest loadRequest = itor->second;
+        mAsyncLoadRequests.erase( itor );
+
+        Mesh *mesh = loadRequest.mesh.get();
+
+        if( fileRequest.error.empty() )
+        {
+            try
+            {
+                if( fileRequest.data )
+                    mesh->_notifyPreparedData( fileRequest.data );
+                mesh->load( true );
+            }
+            catch( Exception &e )
+            {
+                fileRequest.error = e.getFullDescription();
+            }
+        }
+
+        const bool success = fileRequest.error.empty() && mesh->isLoaded();
+
+        if( success )
+        {
+            // load( true ) doesn't notify listeners. Do it while the mesh is still flagged as
+            // background loaded, so that Items created in the meantime get their SubItems.
+            mesh->_fireLoadingComplete( true );
+        }
+        else
+        {
+            LogManager::getSingleton().logMessage(
+                "MeshManager::loadAsync: Could not load mesh '" + mesh->getName() +
+                    "'. Reason: " + fileRequest.error,
+                LML_CRITICAL );
+        }
+
+        mesh->setBackgroundLoaded( false );
+
+        vector<MeshAsyncLoadListener *>::type::const_iterator itListener =
+            loadRequest.listeners.begin();
+        vector<MeshAsyncLoadListener *>::type::const_iterator enListener =
+            loadRequest.listeners.end();
+        while( itListener != enListener )
+        {
+            ( *itListener )->meshLoadCompleted( mesh, success );
+            ++itListener;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::_update()
+    {
+        if( mAsyncLoadRequests.empty() )
+            return;
+
+        OgreProfileExhaustive( "MeshManager::_update" );
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_EMSCRIPTEN
+        processAsyncFileRequests();
+#endif
+
+        mAsyncMutex.lock();
+        mAsyncMainResults.insert( mAsyncMainResults.end(), mAsyncFileResults.begin(),
+                                  mAsyncFileResults.end() );
+        mAsyncFileResults.clear();
+        mAsyncMutex.unlock();
+
+        if( mAsyncMainResults.empty() )
+            return;
+
+        Timer timer;
+
+        // Always finish at least one mesh so that we make progress no matter the budget
+        size_t numProcessed = 0u;
+        const size_t numResults = mAsyncMainResults.size();
+        do
+        {
+            // Copy it: listeners may call loadAsync, which may push to mAsyncMainResults
+            AsyncFileRequest fileRequest = mAsyncMainResults[numProcessed];
+            mAsyncMainResults[numProcessed].data.reset();
+            ++numProcessed;
+            finishAsyncLoad( fileRequest );
+        } while( numProcessed < numResults && timer.getMicroseconds() < mAsyncLoadBudgetUs );
+
+        mAsyncMainResults.erase( mAsyncMainResults.begin(),
+                                 mAsyncMainResults.begin() + ptrdiff_t( numProcessed ) );
+    }
+    //-----------------------------------------------------------------------
     MeshPtr MeshManager::create( const String &name, const String &group, bool isManual,
                                  ManualResourceLoader *loader, const NameValuePairList *createParams )
     {
@@ -0,0 +1,1023 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreMeshOptimizer.h"
+
+#include "OgreBitwise.h"
+#include "OgreException.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreMesh2.h"
+#include "OgreProfiler.h"
+#include "OgreSubMesh2.h"
+#include "OgreVector3.h"
+#include "Vao/OgreAsyncTicket.h"
+#include "Vao/OgreVaoManager.h"
+
+namespace Ogre
+{
+    // Tunables from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+    static const uint32 c_forsythCacheSize = 32u;
+    static const uint32 c_forsythMaxPrecomputedValence = 32u;
+    static const float c_forsythCacheDecayPower = 1.5f;
+    static const float c_forsythLastTriScore = 0.75f;
+    static const float c_forsythValenceBoostScale = 2.0f;
+    static const float c_forsythValenceBoostPower = 0.5f;
+
+    static const uint32 c_invalidTriangle = 0xFFFFFFFF;
+
+    struct ForsythScoreTable
+    {
+        float cacheScore[c_forsythCacheSize];
+        float valenceScore[c_forsythMaxPrecomputedValence];
+
+        ForsythScoreTable()
+        {
+            for( uint32 i = 0u; i < c_forsythCacheSize; ++i )
+            {
+                if( i < 3u )
+                {
+                    // The vertices of the last triangle get a fixed score so
+                    // that the same triangle isn't picked twice in a row
+                    cacheScore[i] = c_forsythLastTriScore;
+                }
+                else
+                {
+                    const float scaler = 1.0f / float( c_forsythCacheSize - 3u );
+                    cacheScore[i] =
+                        std::pow( 1.0f - float( i - 3u ) * scaler, c_forsythCacheDecayPower );
+                }
+            }
+
+            valenceScore[0] = 0.0f;
+            for( uint32 i = 1u; i < c_forsythMaxPrecomputedValence; ++i )
+            {
+                valenceScore[i] =
+                    c_forsythValenceBoostScale * std::pow( float( i ), -c_forsythValenceBoostPower );
+            }
+        }
+
+        float getVertexScore( int32 cachePos, uint32 numLiveTriangles ) const
+        {
+            if( numLiveTriangles == 0u )
+                return -1.0f;  // No triangles left that use this vertex
+
+            float score = cachePos >= 0 ? cacheScore[cachePos] : 0.0f;
+            if( numLiveTriangles < c_forsythMaxPrecomputedValence )
+            {
+                score += valenceScore[numLiveTriangles];
+            }
+            else
+            {
+                score += c_forsythValenceBoostScale *
+                         std::pow( float( numLiveTriangles ), -c_forsythValenceBoostPower );
+            }
+            return score;
+        }
+    };
+
+    struct VertexBytesLess
+    {
+        const uint8 *vertexData;
+        size_t bytesPerVertex;
+
+        VertexBytesLess( const uint8 *_vertexData, size_t _bytesPerVertex ) :
+            vertexData( _vertexData ),
+            bytesPerVertex( _bytesPerVertex )
+        {
+        }
+
+        bool operator()( uint32 a, uint32 b ) const
+        {
+            return memcmp( vertexData + a * bytesPerVertex, vertexData + b * bytesPerVertex,
+                           bytesPerVertex ) < 0;
+        }
+    };
+
+    struct OverdrawCluster
+    {
+        uint32 triangleStart;
+        uint32 triangleEnd;
+        float sortKey;
+    };
+
+    struct OrderOverdrawClusterByKey
+    {
+        bool operator()( const OverdrawCluster &a, const OverdrawCluster &b ) const
+        {
+            return a.sortKey > b.sortKey;
+        }
+    };
+    //-----------------------------------------------------------------------------------
+    const uint32 MeshOptimizer::InvalidIndex;
+    //-----------------------------------------------------------------------------------
+    MeshOptimizer::VertexCacheStats MeshOptimizer::analyzeVertexCache( const uint32 *indices,
+                                                                       size_t numIndices,
+                                                                       size_t numVertices,
+                                                                       uint32 cacheSize )
+    {
+        VertexCacheStats stats;
+        stats.numTriangles = numIndices / 3u;
+        stats.numVertices = numVertices;
+
+        // A vertex is in the FIFO if it was added less than cacheSize insertions ago
+        vector<size_t>::type cacheTimestamps( numVertices, 0u );
+        size_t timestamp = cacheSize + 1u;
+
+        for( size_t i = 0u; i < numIndices; ++i )
+        {
+            const uint32 vertexIdx = indices[i];
+            OGRE_ASSERT_LOW( vertexIdx < numVertices );
+            if( timestamp - cacheTimestamps[vertexIdx] > cacheSize )
+            {
+                cacheTimestamps[vertexIdx] = timestamp++;
+                ++stats.numTransformed;
+            }
+        }
+
+        return stats;
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimizer::optimizeVertexCache( uint32 *indices, size_t numIndices, size_t numVertices )
+    {
+        const size_t numTriangles = numIndices / 3u;
+        if( numTriangles < 2u )
+            return;
+
+        OgreProfileExhaustive( "MeshOptimizer::optimizeVertexCache" );
+
+        static const ForsythScoreTable scoreTable;
+
+        // Build the vertex -> triangle adjacency. The triangles of each vertex that
+        // haven't been emitted yet are kept at the front of its range.
+        vector<uint32>::type numLiveTriangles( numVertices, 0u );
+        for( size_t i = 0u; i < numTriangles * 3u; ++i )
+        {
+            OGRE_ASSERT_LOW( indices[i] < numVertices );
+            ++numLiveTriangles[indices[i]];
+        }
+
+        vector<uint32>::type adjacencyOffsets( numVertices, 0u );
+        {
+            uint32 accumOffset = 0u;
+            for( size_t i = 0u; i < numVertices; ++i )
+            {
+                adjacencyOffsets[i] = accumOffset;
+                accumOffset += numLiveTriangles[i];
+            }
+        }
+
+        vector<uint32>::type adjacency( numTriangles * 3u );
+        {
+            vector<uint32>::type fillOffsets( adjacencyOffsets );
+            for( size_t i = 0u; i < numTriangles * 3u; ++i )
+                adjacency[fillOffsets[indices[i]]++] = static_cast<uint32>( i / 3u );
+        }
+
+        vector<int32>::type cachePositions( numVertices, -1 );
+        vector<float>::type vertexScores( numVertices );
+        for( size_t i = 0u; i < numVertices; ++i )
+            vertexScores[i] = scoreTable.getVertexScore( -1, numLiveTriangles[i] );
+
+        uint32 bestTriangle = c_invalidTriangle;
+        float bestScore = -1.0f;
+
+        vector<float>::type triangleScores( numTriangles );
+        for( size_t i = 0u; i < numTriangles; ++i )
+        {
+            triangleScores[i] = vertexScores[indices[i * 3u + 0u]] +
+                                vertexScores[indices[i * 3u + 1u]] +
+                                vertexScores[indices[i * 3u + 2u]];
+            if( triangleScores[i] > bestScore )
+            {
+                bestScore = triangleScores[i];
+                bestTriangle = static_cast<uint32>( i );
+            }
+        }
+
+        vector<uint8>::type emittedTriangles( numTriangles, 0u );
+        size_t nextUnemittedTriangle = 0u;
+
+        uint32 cacheA[c_forsythCacheSize + 3u];
+        uint32 cacheB[c_forsythCacheSize + 3u];
+        uint32 *cache = cacheA;
+        uint32 *newCache = cacheB;
+        size_t cacheSize = 0u;
+
+        vector<uint32>::type newIndices( numTriangles * 3u );
+
+        for( size_t i = 0u; i < numTriangles; ++i )
+        {
+            if( bestTriangle == c_invalidTriangle )
+            {
+                // None of the vertices in the cache have triangles left. Start
+                // somewhere else; picking the next one in the original order is
+                // good enough and keeps this linear.
+                while( emittedTriangles[nextUnemittedTriangle] )
+                    ++nextUnemittedTriangle;
+                bestTriangle = static_cast<uint32>( nextUnemittedTriangle );
+            }
+
+            const uint32 *triangle = &indices[bestTriangle * 3u];
+            memcpy( &newIndices[i * 3u], triangle, 3u * sizeof( uint32 ) );
+            emittedTriangles[bestTriangle] = 1u;
+
+            // Remove the triangle from the live triangles of its vertices
+            for( size_t j = 0u; j < 3u; ++j )
+            {
+                const uint32 vertexIdx = triangle[j];
+                uint32 *vertexTriangles = &adjacency[adjacencyOffsets[vertexIdx]];
+                const uint32 numVertexTriangles = numLiveTriangles[vertexIdx];
+                for( uint32 k = 0u; k < numVertexTriangles; ++k )
+                {
+                    if( vertexTriangles[k] == bestTriangle )
+                    {
+                        std::swap( vertexTriangles[k], vertexTriangles[numVertexTriangles - 1u] );
+                        break;
+                    }
+                }
+                --numLiveTriangles[vertexIdx];
+            }
+
+            // The vertices of the emitted triangle go to the front of the LRU cache
+            size_t newCacheSize = 0u;
+            for( size_t j = 0u; j < 3u; ++j )
+            {
+                if( std::find( newCache, newCache + newCacheSize, triangle[j] ) ==
+                    newCache + newCacheSize )
+                {
+                    newCache[newCacheSize++] = triangle[j];
+                }
+            }
+            for( size_t j = 0u; j < cacheSize; ++j )
+            {
+                if( cache[j] != triangle[0] && cache[j] != triangle[1] && cache[j] != triangle[2] )
+                    newCache[newCacheSize++] = cache[j];
+            }
+
+            // Update the scores of the vertices in the cache (and of those that just
+            // fell off) and of their triangles
+            for( size_t j = 0u; j < newCacheSize; ++j )
+            {
+                const uint32 vertexIdx = newCache[j];
+                const int32 cachePos = j < c_forsythCacheSize ? static_cast<int32>( j ) : -1;
+                cachePositions[vertexIdx] = cachePos;
+
+                const float newScore =
+                    scoreTable.getVertexScore( cachePos, numLiveTriangles[vertexIdx] );
+                const float scoreDelta = newScore - vertexScores[vertexIdx];
+                vertexScores[vertexIdx] = newScore;
+
+                const uint32 *vertexTriangles = &adjacency[adjacencyOffsets[vertexIdx]];
+                const uint32 numVertexTriangles = numLiveTriangles[vertexIdx];
+                for( uint32 k = 0u; k < numVertexTriangles; ++k )
+                    triangleScores[vertexTriangles[k]] += scoreDelta;
+            }
+
+            newCacheSize = std::min<size_t>( newCacheSize, c_forsythCacheSize );
+
+            // Next triangle is the best one among those touching the cache
+            bestTriangle = c_invalidTriangle;
+            bestScore = -1.0f;
+            for( size_t j = 0u; j < newCacheSize; ++j )
+            {
+                const uint32 vertexIdx = newCache[j];
+                const uint32 *vertexTriangles = &adjacency[adjacencyOffsets[vertexIdx]];
+                const uint32 numVertexTriangles = numLiveTriangles[vertexIdx];
+                for( uint32 k = 0u; k < numVertexTriangles; ++k )
+                {
+                    if( triangleScores[vertexTriangles[k]] > bestScore )
+                    {
+                        bestScore = triangleScores[vertexTriangles[k]];
+                        bestTriangle = vertexTriangles[k];
+                    }
+                }
+            }
+
+            std::swap( cache, newCache );
+            cacheSize = newCacheSize;
+        }
+
+        memcpy( indices, &newIndices[0], numTriangles * 3u * sizeof( uint32 ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimizer::optimizeOverdraw( uint32 *indices, size_t numIndices, const Vector3 *positions,
+                                          size_t numVertices )
+    {
+        const size_t numTriangles = numIndices / 3u;
+        if( numTriangles < 2u )
+            return;
+
+        OgreProfileExhaustive( "MeshOptimizer::optimizeOverdraw" );
+
+        // Split in clusters where a triangle misses the cache on all of its vertices.
+        // Those spots already restart the cache, so moving the clusters around
+        // barely affects ACMR.
+        const uint32 cacheSize = 16u;
+        vector<size_t>::type cacheTimestamps( numVertices, 0u );
+        size_t timestamp = cacheSize + 1u;
+
+        vector<OverdrawCluster>::type clusters;
+        for( size_t i = 0u; i < numTriangles; ++i )
+        {
+            uint32 numMisses = 0u;
+            for( size_t j = 0u; j < 3u; ++j )
+            {
+                const uint32 vertexIdx = indices[i * 3u + j];
+                OGRE_ASSERT_LOW( vertexIdx < numVertices );
+                if( timestamp - cacheTimestamps[vertexIdx] > cacheSize )
+                {
+                    cacheTimestamps[vertexIdx] = timestamp++;
+                    ++numMisses;
+                }
+            }
+
+            if( numMisses == 3u || clusters.empty() )
+            {
+                if( !clusters.empty() )
+                    clusters.back().triangleEnd = static_cast<uint32>( i );
+                OverdrawCluster cluster;
+                cluster.triangleStart = static_cast<uint32>( i );
+                cluster.triangleEnd = static_cast<uint32>( numTriangles );
+                cluster.sortKey = 0.0f;
+                clusters.push_back( cluster );
+            }
+        }
+
+        if( clusters.size() < 2u )
+            return;
+
+        // Area-weighted centroid & normal of each cluster
+        vector<Vector3>::type clusterCentroids( clusters.size(), Vector3::ZERO );
+        vector<Vector3>::type clusterNormals( clusters.size(), Vector3::ZERO );
+        Vector3 meshCentroid( Vector3::ZERO );
+        Real meshArea = 0;
+
+        for( size_t i = 0u; i < clusters.size(); ++i )
+        {
+            Real clusterArea = 0;
+            for( size_t j = clusters[i].triangleStart; j < clusters[i].triangleEnd; ++j )
+            {
+                const Vector3 &p0 = positions[indices[j * 3u + 0u]];
+                const Vector3 &p1 = positions[indices[j * 3u + 1u]];
+                const Vector3 &p2 = positions[indices[j * 3u + 2u]];
+
+                const Vector3 normal = ( p1 - p0 ).crossProduct( p2 - p0 );
+                const Real area = normal.length();
+
+                clusterCentroids[i] += ( p0 + p1 + p2 ) * ( area / Real( 3.0 ) );
+                clusterNormals[i] += normal;
+                clusterArea += area;
+            }
+
+            meshCentroid += clusterCentroids[i];
+            meshArea += clusterArea;
+
+            if( clusterArea > Real( 0 ) )
+                clusterCentroids[i] /= clusterArea;
+        }
+
+        if( meshArea > Real( 0 ) )
+            meshCentroid /= meshArea;
+
+        // Clusters facing away from the center are likely on the outer hull of
+        // the mesh and should occlude the rest, so they're drawn first.
+        for( size_t i = 0u; i < clusters.size(); ++i )
+        {
+            Vector3 normal = clusterNormals[i];
+            if( normal.normalise() > Real( 0 ) )
+            {
+                clusters[i].sortKey =
+                    static_cast<float>( ( clusterCentroids[i] - meshCentroid ).dotProduct( normal ) );
+            }
+        }
+
+        std::stable_sort( clusters.begin(), clusters.end(), OrderOverdrawClusterByKey() );
+
+        vector<uint32>::type newIndices;
+        newIndices.reserve( numTriangles * 3u );
+        for( size_t i = 0u; i < clusters.size(); ++i )
+        {
+            newIndices.insert( newIndices.end(), indices + clusters[i].triangleStart * 3u,
+                               indices + clusters[i].triangleEnd * 3u );
+        }
+
+        memcpy( indices, &newIndices[0], numTriangles * 3u * sizeof( uint32 ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimizer::buildMeshlets( uint32 *indices, size_t numIndices, const Vector3 *positions,
+                                       size_t numVertices, MeshletVec &outMeshlets,
+                                       uint32 maxVertices, uint32 maxTriangles )
+    {
+        OGRE_ASSERT_LOW( maxVertices >= 3u && maxTriangles >= 1u );
+
+        outMeshlets.clear();
+
+        const size_t numTriangles = numIndices / 3u;
+        if( !numTriangles )
+            return;
+
+        OgreProfileExhaustive( "MeshOptimizer::buildMeshlets" );
+
+        // Vertex -> triangles adjacency
+        vector<uint32>::type adjacencyOffsets( numVertices + 1u, 0u );
+        for( size_t i = 0u; i < numTriangles * 3u; ++i )
+        {
+            OGRE_ASSERT_LOW( indices[i] < numVertices );
+            ++adjacencyOffsets[indices[i] + 1u];
+        }
+        for( size_t i = 0u; i < numVertices; ++i )
+            adjacencyOffsets[i + 1u] += adjacencyOffsets[i];
+
+        vector<uint32>::type adjacency( numTriangles * 3u );
+        {
+            vector<uint32>::type writePos( adjacencyOffsets.begin(), adjacencyOffsets.end() - 1u );
+            for( size_t i = 0u; i < numTriangles * 3u; ++i )
+                adjacency[writePos[indices[i]]++] = static_cast<uint32>( i / 3u );
+        }
+
+        vector<Vector3>::type triCentroids( numTriangles );
+        for( size_t i = 0u; i < numTriangles; ++i )
+        {
+            triCentroids[i] = ( positions[indices[i * 3u + 0u]] + positions[indices[i * 3u + 1u]] +
+                                positions[indices[i * 3u + 2u]] ) /
+                              Real( 3.0 );
+        }
+
+        vector<bool>::type emitted( numTriangles, false );
+        // Index of the meshlet (+1) that last used each vertex
+        vector<uint32>::type vertexMeshlet( numVertices, 0u );
+
+        vector<uint32>::type newIndices;
+        newIndices.reserve( numTriangles * 3u );
+
+        vector<uint32>::type candidates;
+        vector<Vector3>::type normals;
+        size_t nextUnemitted = 0u;
+        size_t numEmitted = 0u;
+
+        while( numEmitted < numTriangles )
+        {
+            const uint32 meshletId = static_cast<uint32>( outMeshlets.size() + 1u );
+            uint32 meshletVertices = 0u;
+            uint32 meshletTriangles = 0u;
+            Vector3 centroidSum( Vector3::ZERO );
+
+            Meshlet meshlet;
+            meshlet.indexStart = static_cast<uint32>( newIndices.size() );
+            candidates.clear();
+
+            while( meshletTriangles < maxTriangles )
+            {
+                // Pick the neighbour that adds the fewest vertices, then the closest one
+                uint32 bestTri = c_invalidTriangle;
+                uint32 bestNewVertices = 4u;
+                Real bestDistance = std::numeric_limits<Real>::max();
+
+                const Vector3 centroid = meshletTriangles
+                                             ? centroidSum / Real( meshletTriangles )
+                                             : Vector3::ZERO;
+
+                size_t numCandidates = 0u;
+                for( size_t i = 0u; i < candidates.size(); ++i )
+                {
+                    const uint32 tri = candidates[i];
+                    if( emitted[tri] )
+                        continue;
+                    candidates[numCandidates++] = tri;  // Compact while we're at it
+
+                    uint32 newVertices = 0u;
+                    for( size_t j = 0u; j < 3u; ++j )
+                    {
+                        if( vertexMeshlet[indices[tri * 3u + j]] != meshletId )
+                            ++newVertices;
+                    }
+
+                    if( newVertices <= bestNewVertices )
+                    {
+                        const Real distance = centroid.squaredDistance( triCentroids[tri] );
+                        if( newVertices < bestNewVertices || distance < bestDistance )
+                        {
+                            bestTri = tri;
+                            bestNewVertices = newVertices;
+                            bestDistance = distance;
+                        }
+                    }
+                }
+                candidates.resize( numCandidates );
+
+                if( bestTri == c_invalidTriangle )
+                {
+                    // Nothing connected is left. Continue with the next triangle in
+                    // the original order, which is likely nearby if the indices were
+                    // optimized for the vertex cache.
+                    while( emitted[nextUnemitted] )
+                        ++nextUnemitted;
+                    bestTri = static_cast<uint32>( nextUnemitted );
+                    bestNewVertices = 0u;
+                    for( size_t j = 0u; j < 3u; ++j )
+                    {
+                        if( vertexMeshlet[indices[bestTri * 3u + j]] != meshletId )
+                            ++bestNewVertices;
+                    }
+                }
+
+                if( meshletVertices + bestNewVertices > maxVertices )
+                    break;
+
+                emitted[bestTri] = true;
+                ++numEmitted;
+                ++meshletTriangles;
+                meshletVertices += bestNewVertices;
+                centroidSum += triCentroids[bestTri];
+
+                for( size_t j = 0u; j < 3u; ++j )
+                {
+                    const uint32 vertexIdx = indices[bestTri * 3u + j];
+                    newIndices.push_back( vertexIdx );
+                    if( vertexMeshlet[vertexIdx] != meshletId )
+                    {
+                        vertexMeshlet[vertexIdx] = meshletId;
+                        for( uint32 k = adjacencyOffsets[vertexIdx];
+                             k < adjacencyOffsets[vertexIdx + 1u]; ++k )
+                        {
+                            if( !emitted[adjacency[k]] )
+                                candidates.push_back( adjacency[k] );
+                        }
+                    }
+                }
+
+                if( numEmitted == numTriangles )
+                    break;
+            }
+
+            meshlet.indexCount = static_cast<uint32>( newIndices.size() ) - meshlet.indexStart;
+
+            // Bounding sphere around the centroid of the vertices
+            const uint32 *meshletIndices = &newIndices[meshlet.indexStart];
+            Vector3 center( Vector3::ZERO );
+            for( size_t i = 0u; i < meshlet.indexCount; ++i )
+                center += positions[meshletIndices[i]];
+            center /= Real( meshlet.indexCount );
+
+            Real radiusSq = 0;
+            for( size_t i = 0u; i < meshlet.indexCount; ++i )
+            {
+                radiusSq =
+                    std::max( radiusSq, center.squaredDistance( positions[meshletIndices[i]] ) );
+            }
+
+            meshlet.center = center;
+            meshlet.radius = static_cast<float>( std::sqrt( radiusSq ) );
+
+            // Normal cone. Degenerate triangles can't be seen, so they don't matter
+            normals.clear();
+            Vector3 axis( Vector3::ZERO );
+            for( size_t i = 0u; i < meshlet.indexCount; i += 3u )
+            {
+                const Vector3 &p0 = positions[meshletIndices[i + 0u]];
+                const Vector3 &p1 = positions[meshletIndices[i + 1u]];
+                const Vector3 &p2 = positions[meshletIndices[i + 2u]];
+                Vector3 normal = ( p1 - p0 ).crossProduct( p2 - p0 );
+                if( normal.normalise() > Real( 0 ) )
+                {
+                    axis += normal;
+                    normals.push_back( normal );
+                }
+            }
+
+            meshlet.coneAxis = Vector3::UNIT_Z;
+            meshlet.coneCos = 0.0f;
+            meshlet.coneSin = 1.0f;
+            if( axis.normalise() > Real( 0 ) )
+            {
+                Real minDot = 1;
+                for( size_t i = 0u; i < normals.size(); ++i )
+                    minDot = std::min( minDot, axis.dotProduct( normals[i] ) );
+
+                meshlet.coneAxis = axis;
+                if( minDot > Real( 0 ) )
+                {
+                    meshlet.coneCos = static_cast<float>( minDot );
+                    meshlet.coneSin = static_cast<float>( std::sqrt( Real( 1 ) - minDot * minDot ) );
+                }
+            }
+
+            outMeshlets.push_back( meshlet );
+        }
+
+        memcpy( indices, &newIndices[0], numTriangles * 3u * sizeof( uint32 ) );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t MeshOptimizer::generateDuplicateRemap( uint32 *outRemap, const uint8 *vertexData,
+                                                  size_t numVertices, size_t bytesPerVertex )
+    {
+        if( !numVertices )
+            return 0u;
+
+        OgreProfileExhaustive( "MeshOptimizer::generateDuplicateRemap" );
+
+        vector<uint32>::type sortedVertices( numVertices );
+        for( size_t i = 0u; i < numVertices; ++i )
+            sortedVertices[i] = static_cast<uint32>( i );
+
+        // Stable so that the first vertex of each group of duplicates
+        // is also the one with the lowest index
+        const VertexBytesLess vertexBytesLess( vertexData, bytesPerVertex );
+        std::stable_sort( sortedVertices.begin(), sortedVertices.end(), vertexBytesLess );
+
+        // Temporarily store in outRemap the vertex each one is a duplicate of
+        uint32 firstDuplicate = sortedVertices[0];
+        outRemap[firstDuplicate] = firstDuplicate;
+        for( size_t i = 1u; i < numVertices; ++i )
+        {
+            if( vertexBytesLess( firstDuplicate, sortedVertices[i] ) )
+                firstDuplicate = sortedVertices[i];
+            outRemap[sortedVertices[i]] = firstDuplicate;
+        }
+
+        // Since a duplicate always has a higher index than its original,
+        // the original's final index is known by the time we get to it
+        uint32 numUniqueVertices = 0u;
+        for( size_t i = 0u; i < numVertices; ++i )
+        {
+            if( outRemap[i] == i )
+                outRemap[i] = numUniqueVertices++;
+            else
+                outRemap[i] = outRemap[outRemap[i]];
+        }
+
+        return numUniqueVertices;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t MeshOptimizer::generateVertexFetchRemap( uint32 *outRemap, const uint32 *indices,
+                                                    size_t numIndices, size_t numVertices )
+    {
+        std::fill( outRemap, outRemap + numVertices, InvalidIndex );
+
+        uint32 numUsedVertices = 0u;
+        for( size_t i = 0u; i < numIndices; ++i )
+        {
+            OGRE_ASSERT_LOW( indices[i] < numVertices );
+            if( outRemap[indices[i]] == InvalidIndex )
+                outRemap[indices[i]] = numUsedVertices++;
+        }
+
+        return numUsedVertices;
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimizer::remapIndices( uint32 *indices, size_t numIndices, const uint32 *remap )
+    {
+        for( size_t i = 0u; i < numIndices; ++i )
+        {
+            OGRE_ASSERT_LOW( remap[indices[i]] != InvalidIndex );
+            indices[i] = remap[indices[i]];
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimizer::remapVertices( uint8 *RESTRICT_ALIAS dstData,
+                                       const uint8 *RESTRICT_ALIAS srcData, size_t numVertices,
+                                       size_t bytesPerVertex, const uint32 *remap )
+    {
+        for( size_t i = 0u; i < numVertices; ++i )
+        {
+            if( remap[i] != InvalidIndex )
+            {
+                memcpy( dstData + remap[i] * bytesPerVertex, srcData + i * bytesPerVertex,
+                        bytesPerVertex );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimizer::optimize( Mesh *mesh, uint32 flags, VertexCacheStats *outBefore,
+                                  VertexCacheStats *outAfter )
+    {
+        OgreProfileExhaustive( "MeshOptimizer::optimize" );
+
+        VertexCacheStats statsBefore;
+        VertexCacheStats statsAfter;
+
+        const bool hadIndependentShadowMappingVaos = mesh->hasIndependentShadowMappingVaos();
+        bool anyOptimized = false;
+
+        const unsigned numSubMeshes = mesh->getNumSubMeshes();
+        for( unsigned i = 0u; i < numSubMeshes; ++i )
+            anyOptimized |= optimize( mesh->getSubMesh( i ), flags, statsBefore, statsAfter );
+
+        if( anyOptimized )
+            mesh->prepareForShadowMapping( !hadIndependentShadowMappingVaos );
+
+        if( outBefore )
+            *outBefore = statsBefore;
+        if( outAfter )
+            *outAfter = statsAfter;
+    }
+    //-----------------------------------------------------------------------------------
+    bool MeshOptimizer::optimize( SubMesh *subMesh, uint32 flags, VertexCacheStats &outBefore,
+                                  VertexCacheStats &outAfter )
+    {
+        VertexArrayObjectArray &vaos = subMesh->mVao[VpNormal];
+        if( vaos.empty() || !flags )
+            return false;
+
+        VertexBufferPacked *vertexBuffer = 0;
+        {
+            set<IndexBufferPacked *>::type indexBuffers;
+            VertexArrayObjectArray::const_iterator itor = vaos.begin();
+            VertexArrayObjectArray::const_iterator endt = vaos.end();
+            while( itor != endt )
+            {
+                const VertexArrayObject *vao = *itor;
+                IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+
+                // Indexed triangle lists only. All LODs must share the vertex buffer
+                // (which is what both the serializer & the LOD generator produce)
+                if( vao->getOperationType() != OT_TRIANGLE_LIST || !indexBuffer ||
+                    vao->getVertexBuffers().size() != 1u ||
+                    ( vertexBuffer && vertexBuffer != vao->getVertexBuffers()[0] ) ||
+                    vao->getPrimitiveStart() != 0u ||
+                    vao->getPrimitiveCount() != indexBuffer->getNumElements() ||
+                    !indexBuffers.insert( indexBuffer ).second )
+                {
+                    return false;
+                }
+
+                vertexBuffer = vao->getVertexBuffers()[0];
+                ++itor;
+            }
+        }
+
+        VaoManager *vaoManager = subMesh->mParent->_getVaoManager();
+
+        const size_t bytesPerVertex = vertexBuffer->getBytesPerElement();
+        size_t numVertices = vertexBuffer->getNumElements();
+
+        // Download the vertex data
+        vector<uint8>::type vertexData( numVertices * bytesPerVertex );
+        {
+            AsyncTicketPtr asyncTicket = vertexBuffer->readRequest( 0, numVertices );
+            memcpy( &vertexData[0], asyncTicket->map(), vertexData.size() );
+            asyncTicket->unmap();
+        }
+
+        // Download the indices of all LODs
+        const size_t numLods = vaos.size();
+        vector<vector<uint32>::type>::type lodIndices( numLods );
+        for( size_t lodIdx = 0u; lodIdx < numLods; ++lodIdx )
+        {
+            IndexBufferPacked *indexBuffer = vaos[lodIdx]->getIndexBuffer();
+            const size_t numIndices = indexBuffer->getNumElements();
+            vector<uint32>::type &indices = lodIndices[lodIdx];
+            indices.resize( numIndices );
+
+            AsyncTicketPtr asyncTicket = indexBuffer->readRequest( 0, numIndices );
+            const void *srcData = asyncTicket->map();
+            if( indexBuffer->getIndexType() == IndexBufferPacked::IT_16BIT )
+            {
+                const uint16 *srcData16 = reinterpret_cast<const uint16 *>( srcData );
+                std::copy( srcData16, srcData16 + numIndices, indices.begin() );
+            }
+            else
+            {
+                memcpy( &indices[0], srcData, numIndices * sizeof( uint32 ) );
+            }
+            asyncTicket->unmap();
+        }
+
+        if( !lodIndices[0].empty() )
+        {
+            outBefore.accumulate(
+                analyzeVertexCache( &lodIndices[0][0], lodIndices[0].size(), numVertices ) );
+        }
+
+        // Poses reference vertices by index, so the vertices can't be touched
+        const bool canModifyVertices = subMesh->getNumPoses() == 0u;
+
+        if( canModifyVertices && ( flags & RemoveDuplicateVertices ) )
+        {
+            vector<uint32>::type remap( numVertices );
+            const size_t numUniqueVertices =
+                generateDuplicateRemap( &remap[0], &vertexData[0], numVertices, bytesPerVertex );
+            if( numUniqueVertices != numVertices )
+            {
+                vector<uint8>::type newVertexData( numUniqueVertices * bytesPerVertex );
+                remapVertices( &newVertexData[0], &vertexData[0], numVertices, bytesPerVertex,
+                               &remap[0] );
+                vertexData.swap( newVertexData );
+
+                for( size_t lodIdx = 0u; lodIdx < numLods; ++lodIdx )
+                {
+                    if( !lodIndices[lodIdx].empty() )
+                    {
+                        remapIndices( &lodIndices[lodIdx][0], lodIndices[lodIdx].size(),
+                                      &remap[0] );
+                    }
+                }
+                numVertices = numUniqueVertices;
+            }
+        }
+
+        // Extract the positions for the overdraw optimization & meshlets
+        vector<Vector3>::type positions;
+        if( flags & ( OptimizeOverdraw | BuildMeshlets ) )
+        {
+            const VertexElement2Vec &vertexElements = vertexBuffer->getVertexElements();
+            size_t posOffset = 0u;
+            VertexElement2Vec::const_iterator itor = vertexElements.begin();
+            VertexElement2Vec::const_iterator endt = vertexElements.end();
+            while( itor != endt && itor->mSemantic != VES_POSITION )
+            {
+                posOffset += v1::VertexElement::getTypeSize( itor->mType );
+                ++itor;
+            }
+
+            if( itor != endt && v1::VertexElement::getTypeCount( itor->mType ) >= 3u )
+            {
+                const VertexElementType baseType = v1::VertexElement::getBaseType( itor->mType );
+                if( baseType == VET_FLOAT1 || baseType == VET_HALF2 )
+                {
+                    positions.resize( numVertices );
+                    const uint8 *srcData = &vertexData[posOffset];
+                    for( size_t i = 0u; i < numVertices; ++i )
+                    {
+                        if( baseType == VET_FLOAT1 )
+                        {
+                            float pos[3];
+                            memcpy( pos, srcData, sizeof( pos ) );
+                            positions[i] = Vector3( pos[0], pos[1], pos[2] );
+                        }
+                        else
+                        {
+                            uint16 pos[3];
+                            memcpy( pos, srcData, sizeof( pos ) );
+                            positions[i] = Vector3( Bitwise::halfToFloat( pos[0] ),
+                                                    Bitwise::halfToFloat( pos[1] ),
+                                                    Bitwise::halfToFloat( pos[2] ) );
+                        }
+                        srcData += bytesPerVertex;
+                    }
+                }
+            }
+        }
+
+        for( size_t lodIdx = 0u; lodIdx < numLods; ++lodIdx )
+        {
+            vector<uint32>::type &indices = lodIndices[lodIdx];
+            if( indices.empty() )
+                continue;
+
+            if( flags & OptimizeVertexCache )
+                optimizeVertexCache( &indices[0], indices.size(), numVertices );
+            if( ( flags & OptimizeOverdraw ) && !positions.empty() )
+                optimizeOverdraw( &indices[0], indices.size(), &positions[0], numVertices );
+        }
+
+        // Meshlets are only used by LOD 0; lower LODs are small enough already.
+        // Any other reordering of LOD 0 invalidates existing meshlets.
+        MeshletVec meshlets;
+        if( ( flags & BuildMeshlets ) && !positions.empty() && !lodIndices[0].empty() )
+        {
+            buildMeshlets( &lodIndices[0][0], lodIndices[0].size(), &positions[0], numVertices,
+                           meshlets );
+        }
+
+        if( canModifyVertices && ( flags & OptimizeVertexFetch ) )
+        {
+            // LOD 0 goes first, so that it gets the best locality
+            vector<uint32>::type allIndices;
+            for( size_t lodIdx = 0u; lodIdx < numLods; ++lodIdx )
+                allIndices.insert( allIndices.end(), lodIndices[lodIdx].begin(),
+                                   lodIndices[lodIdx].end() );
+
+            if( !allIndices.empty() )
+            {
+                vector<uint32>::type remap( numVertices );
+                const size_t numUsedVertices = generateVertexFetchRemap(
+                    &remap[0], &allIndices[0], allIndices.size(), numVertices );
+
+                vector<uint8>::type newVertexData( numUsedVertices * bytesPerVertex );
+                remapVertices( &newVertexData[0], &vertexData[0], numVertices, bytesPerVertex,
+                               &remap[0] );
+                vertexData.swap( newVertexData );
+
+                for( size_t lodIdx = 0u; lodIdx < numLods; ++lodIdx )
+                {
+                    if( !lodIndices[lodIdx].empty() )
+                    {
+                        remapIndices( &lodIndices[lodIdx][0], lodIndices[lodIdx].size(),
+                                      &remap[0] );
+                    }
+                }
+                numVertices = numUsedVertices;
+            }
+        }
+
+        if( !lodIndices[0].empty() )
+        {
+            outAfter.accumulate(
+                analyzeVertexCache( &lodIndices[0][0], lodIndices[0].size(), numVertices ) );
+        }
+
+        // Recreate the buffers with the optimized data
+        VertexBufferPacked *newVertexBuffer = 0;
+        {
+            uint8 *data = reinterpret_cast<uint8 *>(
+                OGRE_MALLOC_SIMD( numVertices * bytesPerVertex, MEMCATEGORY_GEOMETRY ) );
+            FreeOnDestructor dataPtrContainer( data );
+            memcpy( data, &vertexData[0], numVertices * bytesPerVertex );
+
+            const bool keepAsShadow = vertexBuffer->getShadowCopy() != 0;
+            newVertexBuffer = vaoManager->createVertexBuffer( vertexBuffer->getVertexElements(),
+                                                              numVertices,
+                                                              vertexBuffer->getBufferType(), data,
+                                                              keepAsShadow );
+            if( keepAsShadow )  // Don't free the pointer ourselves
+                dataPtrContainer.ptr = 0;
+        }
+
+        VertexArrayObjectArray newVaos;
+        newVaos.reserve( numLods );
+        for( size_t lodIdx = 0u; lodIdx < numLods; ++lodIdx )
+        {
+            const IndexBufferPacked *indexBuffer = vaos[lodIdx]->getIndexBuffer();
+            const vector<uint32>::type &indices = lodIndices[lodIdx];
+            const size_t numIndices = indices.size();
+
+            void *data = OGRE_MALLOC_SIMD( numIndices * indexBuffer->getBytesPerElement(),
+                                           MEMCATEGORY_GEOMETRY );
+            FreeOnDestructor dataPtrContainer( data );
+            if( indexBuffer->getIndexType() == IndexBufferPacked::IT_16BIT )
+            {
+                uint16 *dstData16 = reinterpret_cast<uint16 *>( data );
+                for( size_t i = 0u; i < numIndices; ++i )
+                    dstData16[i] = static_cast<uint16>( indices[i] );
+            }
+            else if( numIndices )
+            {
+                memcpy( data, &indices[0], numIndices * sizeof( uint32 ) );
+            }
+
+            const bool keepAsShadow = indexBuffer->getShadowCopy() != 0;
+            IndexBufferPacked *newIndexBuffer = vaoManager->createIndexBuffer(
+                indexBuffer->getIndexType(), numIndices, indexBuffer->getBufferType(), data,
+                keepAsShadow );
+            if( keepAsShadow )  // Don't free the pointer ourselves
+                dataPtrContainer.ptr = 0;
+
+            VertexBufferPackedVec vertexBuffers;
+            vertexBuffers.push_back( newVertexBuffer );
+            newVaos.push_back( vaoManager->createVertexArrayObject(
+                vertexBuffers, newIndexBuffer, vaos[lodIdx]->getOperationType() ) );
+        }
+
+        // Shadow mapping Vaos get regenerated by our caller. If they're the same
+        // as the ones we're about to destroy, just forget about them.
+        VertexArrayObjectArray &shadowVaos = subMesh->mVao[VpShadow];
+        if( !shadowVaos.empty() && shadowVaos[0] == vaos[0] )
+            shadowVaos.clear();
+
+        vaos.swap( newVaos );
+        // Now 'newVaos' contains the old ones
+        SubMesh::destroyVaos( newVaos, vaoManager );
+        // Triangles were reordered (and vertices remapped)
+        subMesh->_invalidateTriangleBvh();
+
+        if( ( flags & BuildMeshlets ) || ( flags & ( OptimizeVertexCache | OptimizeOverdraw ) ) )
+            subMesh->_setMeshlets( meshlets );
+
+        if( canModifyVertices && !subMesh->getBoneAssignments().empty() )
+        {
+            // Vertex indices changed
+            subMesh->clearBoneAssignments();
+            subMesh->_buildBoneAssignmentsFromVertexData( &vertexData[0] );
+        }
+
+        return true;
+    }
+}  // namespace Ogre
@@ -0,0 +1,106 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreMeshlet.h"
+
+#include "OgreCamera.h"
+#include "OgreMatrix4.h"
+
+namespace Ogre
+{
+    MeshletCuller::MeshletCuller() : mNumPlanes( 0u ), mBackfaceCulling( false ) {}
+    //-----------------------------------------------------------------------------------
+    void MeshletCuller::setup( const Camera *camera, const Matrix4 &worldMatrix, bool backfaceCulling )
+    {
+        // A plane (n, d) in world space is (M^T * (n, d)) in object space, where M is the
+        // object's world matrix. The planes don't need to be unit length, but
+        // isVisible compares distances against the radius, so normalise them.
+        const Plane *worldPlanes = camera->getFrustumPlanes();
+
+        // An infinite far plane is just as good as no far plane
+        const bool infiniteFarPlane = camera->getFarClipDistance() == 0;
+        mNumPlanes = 0u;
+        for( size_t i = 0u; i < 6u; ++i )
+        {
+            if( i == FRUSTUM_PLANE_FAR && infiniteFarPlane )
+                continue;
+
+            const Plane &wp = worldPlanes[i];
+            Plane &op = mPlanes[mNumPlanes++];
+            op.normal.x = worldMatrix[0][0] * wp.normal.x + worldMatrix[1][0] * wp.normal.y +
+                          worldMatrix[2][0] * wp.normal.z;
+            op.normal.y = worldMatrix[0][1] * wp.normal.x + worldMatrix[1][1] * wp.normal.y +
+                          worldMatrix[2][1] * wp.normal.z;
+            op.normal.z = worldMatrix[0][2] * wp.normal.x + worldMatrix[1][2] * wp.normal.y +
+                          worldMatrix[2][2] * wp.normal.z;
+            op.d = worldMatrix[0][3] * wp.normal.x + worldMatrix[1][3] * wp.normal.y +
+                   worldMatrix[2][3] * wp.normal.z + wp.d;
+            op.normalise();
+        }
+
+        // Whether a triangle faces the camera doesn't change with affine transforms,
+        // unless they mirror the object (which flips the winding)
+        mBackfaceCulling = backfaceCulling && !worldMatrix.hasNegativeScale();
+        if( mBackfaceCulling )
+            mCameraPos = worldMatrix.inverseAffine().transformAffine( camera->getDerivedPosition() );
+    }
+    //-----------------------------------------------------------------------------------
+    bool MeshletCuller::isVisible( const Meshlet &meshlet ) const
+    {
+        for( size_t i = 0u; i < mNumPlanes; ++i )
+        {
+            if( mPlanes[i].getDistance( meshlet.center ) < -meshlet.radius )
+                return false;
+        }
+
+        if( mBackfaceCulling && meshlet.coneCos > 0.0f )
+        {
+            // Every triangle is back-facing if the angle between the view direction and
+            // any normal in the cone is below 90° by enough margin to cover the sphere:
+            //  cos( viewAngle + coneAngle ) * distance >= radius
+            const Vector3 viewDir = meshlet.center - mCameraPos;
+            const Real distance = viewDir.length();
+            if( distance > meshlet.radius )
+            {
+                const Real viewCos = viewDir.dotProduct( meshlet.coneAxis ) / distance;
+                if( viewCos > Real( 0 ) )
+                {
+                    const Real viewSin =
+                        std::sqrt( std::max( Real( 1 ) - viewCos * viewCos, Real( 0 ) ) );
+                    const Real cosSum = viewCos * meshlet.coneCos - viewSin * meshlet.coneSin;
+                    if( cosSum * distance >= meshlet.radius )
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+}  // namespace Ogre
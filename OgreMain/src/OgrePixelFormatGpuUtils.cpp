@@ -38,6 +38,10 @@ THE SOFTWARE.
 #include "OgreProfiler.h"
 #include "OgreTextureBox.h"
 
+#if __OGRE_HAVE_SSE
+#    include <emmintrin.h>
+#endif
+
 namespace Ogre
 {
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC && OGRE_COMP_VER < 1800
@@ -1335,17 +1339,13 @@ namespace Ogre
         }
         void convRG16toRGB16(uint8* _src, uint8* _dst, size_t width) {
             uint16* src = (uint16*)_src; uint16* dst = (uint16*)_dst;
-            while (width--) { dst[0] = src[0]; dst[1] = src[1]; dst[0] = 0u; src += 2; dst += 3; }
+            while (width--) { dst[0] = src[0]; dst[1] = src[1]; dst[2] = 0u; src += 2; dst += 3; }
         }
         void convRG16toR16(uint8* _src, uint8* _dst, size_t width) {
             uint16* src = (uint16*)_src; uint16* dst = (uint16*)_dst;
             while (width--) { dst[0] = src[0]; src += 2; dst += 1; }
         }
 
-        void convRGBAtoBGRA(uint8* src, uint8* dst, size_t width) {
-            while (width--)
-            { dst[0] = src[2]; dst[1] = src[1]; dst[2] = src[0]; dst[3] = src[3]; src += 4; dst += 4; }
-        }
         void convRGBAtoRGB(uint8* src, uint8* dst, size_t width) {
             while (width--) { dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; src += 4; dst += 3; }
         }
@@ -1378,14 +1378,6 @@ namespace Ogre
             while (width--) { dst[0] = src[2]; src += 4; dst += 1; }
         }
 
-        void convBGRXtoRGBA(uint8* src, uint8* dst, size_t width) {
-            while (width--)
-            { dst[0] = src[2]; dst[1] = src[1]; dst[2] = src[0]; dst[3] = 0xFF; src += 4; dst += 4; }
-        }
-        void convBGRXtoBGRA(uint8* src, uint8* dst, size_t width) {
-            while (width--)
-            { dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 0xFF; src += 4; dst += 4; }
-        }
 
         void convRGBtoRGBA(uint8* src, uint8* dst, size_t width) {
             while (width--)
@@ -1440,6 +1432,376 @@ namespace Ogre
             while (width--) { dst[0] = src[0]; src += 2; dst += 1; }
         }
         // clang-format on
+
+        /// Swaps the R & B channels of 8-bit 4-channel pixels. Optionally forces alpha to 0xFF.
+        template <bool forceOpaque, bool swapRB>
+        void convSwizzle8x4( uint8 *src, uint8 *dst, size_t width )
+        {
+            size_t x = 0u;
+#if __OGRE_HAVE_SSE
+            const __m128i maskRB = _mm_set1_epi32( 0x00FF00FF );
+            const __m128i maskGA = _mm_set1_epi32( (int)0xFF00FF00 );
+            const __m128i opaque = _mm_set1_epi32( (int)0xFF000000 );
+            for( ; x + 4u <= width; x += 4u )
+            {
+                __m128i px = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src + x * 4u ) );
+                if( swapRB )
+                {
+                    const __m128i rb = _mm_and_si128( px, maskRB );
+                    px = _mm_or_si128( _mm_and_si128( px, maskGA ),
+                                       _mm_or_si128( _mm_slli_epi32( rb, 16 ), _mm_srli_epi32( rb, 16 ) ) );
+                }
+                if( forceOpaque )
+                    px = _mm_or_si128( px, opaque );
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( dst + x * 4u ), px );
+            }
+#endif
+            for( ; x < width; ++x )
+            {
+                uint32 px;
+                memcpy( &px, src + x * 4u, sizeof( px ) );
+                if( swapRB )
+                {
+                    const uint32 rb = px & 0x00FF00FFu;
+                    px = ( px & 0xFF00FF00u ) | ( rb << 16u ) | ( rb >> 16u );
+                }
+                if( forceOpaque )
+                    px |= 0xFF000000u;
+                memcpy( dst + x * 4u, &px, sizeof( px ) );
+            }
+        }
+
+        void convRGBAtoBGRA( uint8 *src, uint8 *dst, size_t width )
+        {
+            convSwizzle8x4<false, true>( src, dst, width );
+        }
+        void convBGRXtoRGBA( uint8 *src, uint8 *dst, size_t width )
+        {
+            convSwizzle8x4<true, true>( src, dst, width );
+        }
+        void convBGRXtoBGRA( uint8 *src, uint8 *dst, size_t width )
+        {
+            convSwizzle8x4<true, false>( src, dst, width );
+        }
+
+        /// Lookup tables for 8-bit conversions that would otherwise require evaluating
+        /// fromSRGB / toSRGB per channel. Values match exactly what unpackColour & packColour
+        /// produce.
+        struct Unorm8Luts
+        {
+            float linearToFloat[256];
+            float srgbToFloat[256];
+            uint8 srgbToLinear[256];
+            uint8 linearToSrgb[256];
+
+            Unorm8Luts()
+            {
+                for( size_t i = 0u; i < 256u; ++i )
+                {
+                    const float val = static_cast<float>( i ) / 255.0f;
+                    linearToFloat[i] = val;
+                    srgbToFloat[i] = PixelFormatGpuUtils::fromSRGB( val );
+                    srgbToLinear[i] =
+                        static_cast<uint8>( roundf( Math::saturate( srgbToFloat[i] ) * 255.0f ) );
+                    linearToSrgb[i] = static_cast<uint8>(
+                        roundf( Math::saturate( PixelFormatGpuUtils::toSRGB( val ) ) * 255.0f ) );
+                }
+            }
+        };
+
+        const Unorm8Luts &getUnorm8Luts()
+        {
+            static const Unorm8Luts luts;
+            return luts;
+        }
+
+        /// RGBA8 <-> RGBA8_SRGB. Alpha is never gamma corrected.
+        template <bool toSrgb>
+        void convRGBA8SrgbRemap( uint8 *src, uint8 *dst, size_t width )
+        {
+            const Unorm8Luts &luts = getUnorm8Luts();
+            const uint8 *RESTRICT_ALIAS lut = toSrgb ? luts.linearToSrgb : luts.srgbToLinear;
+            while( width-- )
+            {
+                dst[0] = lut[src[0]];
+                dst[1] = lut[src[1]];
+                dst[2] = lut[src[2]];
+                dst[3] = src[3];
+                src += 4;
+                dst += 4;
+            }
+        }
+
+        /// 8-bit UNORM with srcComponents channels to RGBA32_FLOAT. Missing channels
+        /// are filled with 0, alpha with 1. swapRB handles BGRA/BGRX sources.
+        template <size_t srcComponents, bool srgb, bool swapRB, bool forceOpaque>
+        void convUnorm8toRGBA32F( uint8 *src, uint8 *_dst, size_t width )
+        {
+            const Unorm8Luts &luts = getUnorm8Luts();
+            const float *RESTRICT_ALIAS lut = srgb ? luts.srgbToFloat : luts.linearToFloat;
+            float *RESTRICT_ALIAS dst = reinterpret_cast<float *>( _dst );
+
+            size_t x = 0u;
+#if __OGRE_HAVE_SSE
+            if( srcComponents == 4u && !srgb )
+            {
+                // 4 pixels per iteration: widen u8 -> u16 -> i32 -> float
+                const __m128i zero = _mm_setzero_si128();
+                const __m128  maxVal = _mm_set1_ps( 255.0f );
+                const __m128  one = _mm_set1_ps( 1.0f );
+                for( ; x + 4u <= width; x += 4u )
+                {
+                    const __m128i px = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src ) );
+                    const __m128i lo16 = _mm_unpacklo_epi8( px, zero );
+                    const __m128i hi16 = _mm_unpackhi_epi8( px, zero );
+                    __m128        rgba[4];
+                    rgba[0] = _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo16, zero ) );
+                    rgba[1] = _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo16, zero ) );
+                    rgba[2] = _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi16, zero ) );
+                    rgba[3] = _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi16, zero ) );
+                    for( size_t i = 0u; i < 4u; ++i )
+                    {
+                        // Use div rather than mul by reciprocal so that results are bit-exact
+                        // with unpackColour.
+                        __m128 val = _mm_div_ps( rgba[i], maxVal );
+                        if( swapRB )
+                            val = _mm_shuffle_ps( val, val, _MM_SHUFFLE( 3, 0, 1, 2 ) );
+                        if( forceOpaque )
+                        {
+                            // Replace w with 1.0: move (1, z) into (z, w) lanes
+                            const __m128 zw = _mm_shuffle_ps( val, one, _MM_SHUFFLE( 0, 0, 2, 2 ) );
+                            val = _mm_shuffle_ps( val, zw, _MM_SHUFFLE( 2, 0, 1, 0 ) );
+                        }
+                        _mm_storeu_ps( dst, val );
+                        dst += 4;
+                    }
+                    src += 16;
+                }
+            }
+#endif
+            for( ; x < width; ++x )
+            {
+                dst[0] = lut[src[swapRB ? 2 : 0]];
+                dst[1] = srcComponents > 1u ? lut[src[1]] : 0.0f;
+                dst[2] = srcComponents > 2u ? lut[src[swapRB ? 0 : 2]] : 0.0f;
+                dst[3] = ( srcComponents > 3u && !forceOpaque ) ? luts.linearToFloat[src[3]] : 1.0f;
+                src += srcComponents;
+                dst += 4;
+            }
+        }
+
+        /// RGBA32_FLOAT to 8-bit UNORM 4 channel pixels.
+        template <bool srgb, bool swapRB, bool forceOpaque>
+        void convRGBA32FtoUnorm8( uint8 *_src, uint8 *dst, size_t width )
+        {
+            const float *RESTRICT_ALIAS src = reinterpret_cast<const float *>( _src );
+
+            size_t x = 0u;
+#if __OGRE_HAVE_SSE
+            if( !srgb )
+            {
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 one = _mm_set1_ps( 1.0f );
+                const __m128 maxVal = _mm_set1_ps( 255.0f );
+                const __m128 half = _mm_set1_ps( 0.5f );
+                for( ; x + 4u <= width; x += 4u )
+                {
+                    __m128i px[4];
+                    for( size_t i = 0u; i < 4u; ++i )
+                    {
+                        __m128 val = _mm_loadu_ps( src + i * 4u );
+                        if( swapRB )
+                            val = _mm_shuffle_ps( val, val, _MM_SHUFFLE( 3, 0, 1, 2 ) );
+                        // NaN maps to 0, same as Math::saturate
+                        val = _mm_min_ps( _mm_max_ps( val, zero ), one );
+                        px[i] = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( val, maxVal ), half ) );
+                    }
+                    // Values are in [0; 255] so saturating packs are lossless
+                    __m128i packed = _mm_packus_epi16( _mm_packs_epi32( px[0], px[1] ),
+                                                       _mm_packs_epi32( px[2], px[3] ) );
+                    if( forceOpaque )
+                        packed = _mm_or_si128( packed, _mm_set1_epi32( (int)0xFF000000 ) );
+                    _mm_storeu_si128( reinterpret_cast<__m128i *>( dst ), packed );
+                    src += 16;
+                    dst += 16;
+                }
+            }
+#endif
+            for( ; x < width; ++x )
+            {
+                for( size_t i = 0u; i < 3u; ++i )
+                {
+                    float val = Math::saturate( src[swapRB ? ( 2u - i ) : i] );
+                    if( srgb )
+                        val = Math::saturate( PixelFormatGpuUtils::toSRGB( val ) );
+                    dst[i] = static_cast<uint8>( val * 255.0f + 0.5f );
+                }
+                dst[3] =
+                    forceOpaque ? 255u : static_cast<uint8>( Math::saturate( src[3] ) * 255.0f + 0.5f );
+                src += 4;
+                dst += 4;
+            }
+        }
+
+        /// Expands R8 / RG8 UNORM to 4 channel RGBA8 / BGRA8 UNORM.
+        template <size_t srcComponents, bool swapRB>
+        void convUnorm8ExpandToRGBA8( uint8 *src, uint8 *dst, size_t width )
+        {
+            while( width-- )
+            {
+                const uint8 r = src[0];
+                const uint8 g = srcComponents > 1u ? src[1] : 0u;
+                dst[swapRB ? 2 : 0] = r;
+                dst[1] = g;
+                dst[swapRB ? 0 : 2] = 0u;
+                dst[3] = 0xFF;
+                src += srcComponents;
+                dst += 4;
+            }
+        }
+
+        void convRGBA16FtoRGBA32F( uint8 *_src, uint8 *_dst, size_t width )
+        {
+            const uint16 *RESTRICT_ALIAS src = reinterpret_cast<const uint16 *>( _src );
+            uint32 *RESTRICT_ALIAS dst = reinterpret_cast<uint32 *>( _dst );
+
+            size_t numValues = width * 4u;
+            size_t x = 0u;
+#if __OGRE_HAVE_SSE
+            // Branchless half -> float conversion. Handles zero, denormals, inf & NaN
+            // producing the same bit patterns as Bitwise::halfToFloatI
+            const __m128i maskNoSign = _mm_set1_epi32( 0x7fff );
+            const __m128  magic = _mm_castsi128_ps( _mm_set1_epi32( ( 254 - 15 ) << 23 ) );
+            const __m128i wasInfNan = _mm_set1_epi32( 0x7bff );
+            const __m128i expInfNan = _mm_set1_epi32( 255 << 23 );
+            const __m128i zero = _mm_setzero_si128();
+            for( ; x + 8u <= numValues; x += 8u )
+            {
+                const __m128i halves = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src + x ) );
+                __m128i       h32[2];
+                h32[0] = _mm_unpacklo_epi16( halves, zero );
+                h32[1] = _mm_unpackhi_epi16( halves, zero );
+                for( size_t i = 0u; i < 2u; ++i )
+                {
+                    const __m128i expMant = _mm_and_si128( maskNoSign, h32[i] );
+                    const __m128i justSign = _mm_xor_si128( h32[i], expMant );
+                    const __m128i shifted = _mm_slli_epi32( expMant, 13 );
+                    const __m128  scaled = _mm_mul_ps( _mm_castsi128_ps( shifted ), magic );
+                    const __m128i bWasInfNan = _mm_cmpgt_epi32( expMant, wasInfNan );
+                    const __m128i sign = _mm_slli_epi32( justSign, 16 );
+                    const __m128i infNanExp = _mm_and_si128( bWasInfNan, expInfNan );
+                    const __m128i signInf = _mm_or_si128( sign, infNanExp );
+                    const __m128i result = _mm_or_si128( _mm_castps_si128( scaled ), signInf );
+                    _mm_storeu_si128( reinterpret_cast<__m128i *>( dst + x + i * 4u ), result );
+                }
+            }
+#endif
+            for( ; x < numValues; ++x )
+                dst[x] = Bitwise::halfToFloatI( src[x] );
+        }
+
+        void convRGBA32FtoRGBA16F( uint8 *_src, uint8 *_dst, size_t width )
+        {
+            const uint32 *RESTRICT_ALIAS src = reinterpret_cast<const uint32 *>( _src );
+            uint16 *RESTRICT_ALIAS dst = reinterpret_cast<uint16 *>( _dst );
+
+            const size_t numValues = width * 4u;
+            for( size_t x = 0u; x < numValues; ++x )
+                dst[x] = Bitwise::floatToHalfI( src[x] );
+        }
+
+        void convD16toR32F( uint8 *_src, uint8 *_dst, size_t width )
+        {
+            const uint16 *RESTRICT_ALIAS src = reinterpret_cast<const uint16 *>( _src );
+            float *RESTRICT_ALIAS dst = reinterpret_cast<float *>( _dst );
+            for( size_t x = 0u; x < width; ++x )
+                dst[x] = static_cast<float>( src[x] ) / 65535.0f;
+        }
+
+        template <uint32 depthMask>
+        void convD24toR32F( uint8 *_src, uint8 *_dst, size_t width )
+        {
+            const uint32 *RESTRICT_ALIAS src = reinterpret_cast<const uint32 *>( _src );
+            float *RESTRICT_ALIAS dst = reinterpret_cast<float *>( _dst );
+            for( size_t x = 0u; x < width; ++x )
+                dst[x] = static_cast<float>( src[x] & depthMask ) / 16777215.0f;
+        }
+
+        void convD32S8X24toR32F( uint8 *_src, uint8 *_dst, size_t width )
+        {
+            const uint32 *RESTRICT_ALIAS src = reinterpret_cast<const uint32 *>( _src );
+            uint32 *RESTRICT_ALIAS dst = reinterpret_cast<uint32 *>( _dst );
+            for( size_t x = 0u; x < width; ++x )
+                dst[x] = src[x * 2u];
+        }
+
+        struct FastRowConversion
+        {
+            PixelFormatGpu        srcFormat;
+            PixelFormatGpu        dstFormat;
+            row_conversion_func_t func;
+        };
+
+        /// Specialised conversions between formats whose PixelFormatFlags differ, and thus
+        /// can't be handled by the typeless PFL_PAIR dispatch in bulkPixelConversion.
+        /// Every entry must produce the same results as the unpackColour / packColour fallback,
+        /// except that float -> unorm rounding follows the +0.5 convention used by packColour's
+        /// BGRA paths, and the X channel of BGRX sources is always treated as opaque.
+        // clang-format off
+        const FastRowConversion c_fastRowConversions[] = {
+            { PFG_RGBA8_UNORM,          PFG_RGBA8_UNORM_SRGB,   convRGBA8SrgbRemap<true> },
+            { PFG_RGBA8_UNORM_SRGB,     PFG_RGBA8_UNORM,        convRGBA8SrgbRemap<false> },
+            { PFG_BGRA8_UNORM,          PFG_BGRA8_UNORM_SRGB,   convRGBA8SrgbRemap<true> },
+            { PFG_BGRA8_UNORM_SRGB,     PFG_BGRA8_UNORM,        convRGBA8SrgbRemap<false> },
+
+            { PFG_RGBA8_UNORM,          PFG_RGBA32_FLOAT,       convUnorm8toRGBA32F<4u, false, false, false> },
+            { PFG_RGBA8_UNORM_SRGB,     PFG_RGBA32_FLOAT,       convUnorm8toRGBA32F<4u, true, false, false> },
+            { PFG_BGRA8_UNORM,          PFG_RGBA32_FLOAT,       convUnorm8toRGBA32F<4u, false, true, false> },
+            { PFG_BGRA8_UNORM_SRGB,     PFG_RGBA32_FLOAT,       convUnorm8toRGBA32F<4u, true, true, false> },
+            { PFG_BGRX8_UNORM,          PFG_RGBA32_FLOAT,       convUnorm8toRGBA32F<4u, false, true, true> },
+            { PFG_BGRX8_UNORM_SRGB,     PFG_RGBA32_FLOAT,       convUnorm8toRGBA32F<4u, true, true, true> },
+            { PFG_RG8_UNORM,            PFG_RGBA32_FLOAT,       convUnorm8toRGBA32F<2u, false, false, false> },
+            { PFG_R8_UNORM,             PFG_RGBA32_FLOAT,       convUnorm8toRGBA32F<1u, false, false, false> },
+
+            { PFG_RGBA32_FLOAT,         PFG_RGBA8_UNORM,        convRGBA32FtoUnorm8<false, false, false> },
+            { PFG_RGBA32_FLOAT,         PFG_RGBA8_UNORM_SRGB,   convRGBA32FtoUnorm8<true, false, false> },
+            { PFG_RGBA32_FLOAT,         PFG_BGRA8_UNORM,        convRGBA32FtoUnorm8<false, true, false> },
+            { PFG_RGBA32_FLOAT,         PFG_BGRA8_UNORM_SRGB,   convRGBA32FtoUnorm8<true, true, false> },
+            { PFG_RGBA32_FLOAT,         PFG_BGRX8_UNORM,        convRGBA32FtoUnorm8<false, true, true> },
+            { PFG_RGBA32_FLOAT,         PFG_BGRX8_UNORM_SRGB,   convRGBA32FtoUnorm8<true, true, true> },
+
+            { PFG_RGBA16_FLOAT,         PFG_RGBA32_FLOAT,       convRGBA16FtoRGBA32F },
+            { PFG_RGBA32_FLOAT,         PFG_RGBA16_FLOAT,       convRGBA32FtoRGBA16F },
+
+            { PFG_R8_UNORM,             PFG_RGBA8_UNORM,        convUnorm8ExpandToRGBA8<1u, false> },
+            { PFG_RG8_UNORM,            PFG_RGBA8_UNORM,        convUnorm8ExpandToRGBA8<2u, false> },
+            { PFG_R8_UNORM,             PFG_BGRA8_UNORM,        convUnorm8ExpandToRGBA8<1u, true> },
+            { PFG_RG8_UNORM,            PFG_BGRA8_UNORM,        convUnorm8ExpandToRGBA8<2u, true> },
+            { PFG_R8_UNORM,             PFG_BGRX8_UNORM,        convUnorm8ExpandToRGBA8<1u, true> },
+            { PFG_RG8_UNORM,            PFG_BGRX8_UNORM,        convUnorm8ExpandToRGBA8<2u, true> },
+
+            { PFG_D32_FLOAT,            PFG_R32_FLOAT,          convCopy4Bpx },
+            { PFG_D16_UNORM,            PFG_R32_FLOAT,          convD16toR32F },
+            { PFG_D24_UNORM,            PFG_R32_FLOAT,          convD24toR32F<0xFFFFFFFFu> },
+            { PFG_D24_UNORM_S8_UINT,    PFG_R32_FLOAT,          convD24toR32F<0x00FFFFFFu> },
+            { PFG_D32_FLOAT_S8X24_UINT, PFG_R32_FLOAT,          convD32S8X24toR32F },
+        };
+        // clang-format on
+
+        row_conversion_func_t findFastRowConversion( PixelFormatGpu srcFormat,
+                                                     PixelFormatGpu dstFormat )
+        {
+            const size_t numEntries = sizeof( c_fastRowConversions ) / sizeof( c_fastRowConversions[0] );
+            for( size_t i = 0u; i < numEntries; ++i )
+            {
+                if( c_fastRowConversions[i].srcFormat == srcFormat &&
+                    c_fastRowConversions[i].dstFormat == dstFormat )
+                {
+                    return c_fastRowConversions[i].func;
+                }
+            }
+            return 0;
+        }
     }  // namespace
     //-----------------------------------------------------------------------------------
     void PixelFormatGpuUtils::bulkPixelConversion( const TextureBox &src, PixelFormatGpu srcFormat,
@@ -1474,10 +1836,14 @@ namespace Ogre
         const size_t depthOrSlices = src.getDepthOrSlices();
 
         // Is there a optimized row conversion?
-        row_conversion_func_t rowConversionFunc = 0;
+        row_conversion_func_t rowConversionFunc = findFastRowConversion( srcFormat, dstFormat );
         assert( PFL_COUNT <= 16 );  // adjust PFL_PAIR definition if assertion failed
 #define PFL_PAIR( a, b ) ( ( a << 4 ) | b )
-        if( srcFormat == dstFormat )
+        if( rowConversionFunc )
+        {
+            // Specialised conversion found
+        }
+        else if( srcFormat == dstFormat )
         {
             switch( srcBytesPerPixel )
             {
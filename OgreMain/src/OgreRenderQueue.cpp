@@ -98,7 +98,8 @@ namespace Ogre
         mLastIndexData( 0 ),
         mLastTextureHash( 0 ),
         mCommandBuffer( 0 ),
-        mRenderingStarted( 0u )
+        mRenderingStarted( 0u ),
+        mMeshletCulling( true )
     {
         mCommandBuffer = new CommandBuffer();
 
@@ -195,6 +196,7 @@ namespace Ogre
             while( itor != endt )
             {
                 itor->q.clear();
+                itor->numExtraDraws = 0u;
                 ++itor;
             }
 
@@ -275,6 +277,14 @@ namespace Ogre
 
             VertexArrayObject *vao = vaos[meshLod];
             meshHash = vao->getRenderQueueId();
+
+            if( !casterPass && meshLod == 0u && vao->getMeshlets() )
+            {
+                // Worst case: every other meshlet is visible, i.e. ceil( n / 2 ) draws
+                const size_t numMeshlets = vao->getMeshlets()->size();
+                mRenderQueues[rqId].mQueuedRenderablesPerThread[threadIdx].numExtraDraws +=
+                    ( numMeshlets + 1u ) / 2u - 1u;
+            }
         }
         // TODO: Account for skeletal animation in any of the hashes (preferently on the material side)
         // TODO: Account for auto instancing animation in any of the hashes
@@ -366,7 +376,7 @@ namespace Ogre
                 for( const ThreadRenderQueue &threadRenderQueue :
                      mRenderQueues[i].mQueuedRenderablesPerThread )
                 {
-                    numNeededV2Draws += threadRenderQueue.q.size();
+                    numNeededV2Draws += threadRenderQueue.q.size() + threadRenderQueue.numExtraDraws;
                 }
             }
             else if( mRenderQueues[i].mMode == PARTICLE_SYSTEM )
@@ -517,6 +527,7 @@ namespace Ogre
             if( hlms )
                 hlms->preCommandBufferExecution( mCommandBuffer );
         }
+        mVaoManager->_preCommandBufferExecution();
 
         mCommandBuffer->execute();
 
@@ -864,6 +875,10 @@ namespace Ogre
 
         RenderingMetrics stats;
 
+        const Camera *meshletCamera = 0;
+        if( mMeshletCulling && !casterPass && !dualParaboloid && !isUsingInstancedStereo )
+            meshletCamera = mSceneManager->getCamerasInProgress().cullingCamera;
+
         const QueuedRenderableArray &queuedRenderables = renderQueueGroup.mQueuedRenderables;
 
         QueuedRenderableArray::const_iterator itor = queuedRenderables.begin();
@@ -877,6 +892,19 @@ namespace Ogre
                 queuedRenderable.renderable->getVaos( static_cast<VertexPass>( casterPass ) );
 
             VertexArrayObject *vao = vaos[meshLod];
+
+            bool drawMeshletRuns = false;
+            if( meshletCamera && meshLod == 0u && vao->mMeshlets )
+            {
+                drawMeshletRuns = cullMeshlets( queuedRenderable, vao, meshletCamera );
+                if( drawMeshletRuns && mMeshletRuns.empty() )
+                {
+                    // Not a single cluster is visible
+                    ++itor;
+                    continue;
+                }
+            }
+
             const HlmsDatablock *datablock = queuedRenderable.renderable->getDatablock();
 
             Hlms *hlms = mHlmsManager->getHlms( static_cast<HlmsTypes>( datablock->mType ) );
@@ -935,7 +963,41 @@ namespace Ogre
                 stats.mDrawCount += 1u;
             }
 
-            if( lastVao != vao )
+            uint32 primCount = vao->mPrimCount;
+
+            if( drawMeshletRuns )
+            {
+                // One draw per range of visible clusters, all sharing the same instance data
+                primCount = 0u;
+                const uint32 indexStart = uint32( vao->mIndexBuffer->_getFinalBufferStart() );
+                const uint32 baseVertex = uint32( vao->mBaseVertexBuffer->_getFinalBufferStart() );
+
+                MeshletRunVec::const_iterator itRun = mMeshletRuns.begin();
+                MeshletRunVec::const_iterator enRun = mMeshletRuns.end();
+                while( itRun != enRun )
+                {
+                    ++drawCmd->numDraws;
+
+                    CbDrawIndexed *drawIndexedPtr = reinterpret_cast<CbDrawIndexed *>( indirectDraw );
+                    indirectDraw += sizeof( CbDrawIndexed );
+
+                    drawCountPtr = drawIndexedPtr;
+                    drawIndexedPtr->primCount = itRun->indexCount;
+                    drawIndexedPtr->instanceCount = instancesPerDraw;
+                    drawIndexedPtr->firstVertexIndex = indexStart + itRun->indexStart;
+                    drawIndexedPtr->baseVertex = baseVertex;
+                    drawIndexedPtr->baseInstance = baseInstance << baseInstanceShift;
+
+                    primCount += itRun->indexCount;
+                    ++itRun;
+                }
+
+                instanceCount = instancesPerDraw;
+                // The next Renderable can't instance on top of a partial draw
+                lastVao = 0;
+                stats.mInstanceCount += instancesPerDraw;
+            }
+            else if( lastVao != vao )
             {
                 // Different mesh, but same vertex buffers & layouts. Advance indirection buffer.
                 ++drawCmd->numDraws;
@@ -986,17 +1048,17 @@ namespace Ogre
             switch( vao->getOperationType() )
             {
             case OT_TRIANGLE_LIST:
-                stats.mFaceCount += ( vao->mPrimCount / 3u ) * instancesPerDraw;
+                stats.mFaceCount += ( primCount / 3u ) * instancesPerDraw;
                 break;
             case OT_TRIANGLE_STRIP:
             case OT_TRIANGLE_FAN:
-                stats.mFaceCount += ( vao->mPrimCount - 2u ) * instancesPerDraw;
+                stats.mFaceCount += ( primCount - 2u ) * instancesPerDraw;
                 break;
             default:
                 break;
             }
 
-            stats.mVertexCount += vao->mPrimCount * instancesPerDraw;
+            stats.mVertexCount += primCount * instancesPerDraw;
 
             ++itor;
         }
@@ -1011,6 +1073,59 @@ namespace Ogre
         return indirectDraw;
     }
     //-----------------------------------------------------------------------
+    bool RenderQueue::cullMeshlets( const QueuedRenderable &queuedRenderable,
+                                    const VertexArrayObject *vao, const Camera *camera )
+    {
+        mMeshletRuns.clear();
+
+        // Meshlet bounds are in bind pose; animation could move the triangles anywhere.
+        // Meshlets must also cover exactly what we'd draw.
+        const Renderable *renderable = queuedRenderable.renderable;
+        if( renderable->hasSkeletonAnimation() || renderable->getNumPoses() ||
+            !vao->mIndexBuffer || vao->mPrimStart != 0u ||
+            vao->mPrimCount != vao->mIndexBuffer->getNumElements() )
+        {
+            return false;
+        }
+
+        const HlmsMacroblock *macroblock = renderable->getDatablock()->getMacroblock( false );
+        mMeshletCuller.setup( camera, queuedRenderable.movableObject->_getParentNodeFullTransform(),
+                              macroblock->mCullMode == CULL_CLOCKWISE );
+
+        const MeshletVec &meshlets = *vao->mMeshlets;
+        MeshletVec::const_iterator itor = meshlets.begin();
+        MeshletVec::const_iterator endt = meshlets.end();
+        while( itor != endt )
+        {
+            if( mMeshletCuller.isVisible( *itor ) )
+            {
+                if( !mMeshletRuns.empty() &&
+                    mMeshletRuns.back().indexStart + mMeshletRuns.back().indexCount ==
+                        itor->indexStart )
+                {
+                    mMeshletRuns.back().indexCount += itor->indexCount;
+                }
+                else
+                {
+                    MeshletRun run;
+                    run.indexStart = itor->indexStart;
+                    run.indexCount = itor->indexCount;
+                    mMeshletRuns.push_back( run );
+                }
+            }
+            ++itor;
+        }
+
+        if( mMeshletRuns.size() == 1u && mMeshletRuns[0].indexCount == vao->mPrimCount )
+        {
+            // Everything is visible. A regular draw can still be instanced
+            mMeshletRuns.clear();
+            return false;
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------
     void RenderQueue::renderGL3V1( RenderSystem *rs, bool casterPass, bool dualParaboloid,
                                    HlmsCache passCache[], const RenderQueueGroup &renderQueueGroup,
                                    ParallelHlmsCompileQueue *parallelCompileQueue )
@@ -270,6 +270,9 @@ namespace Ogre
         TextureGpu *tex = tl._getTexturePtr();
         bool isValidBinding = false;
 
+        if( tex )
+            tex->_touch();
+
         if( mCurrentCapabilities->hasCapability( RSC_COMPLETE_TEXTURE_BINDING ) )
             _setBindingType( tl.getBindingType() );
 
@@ -55,7 +55,8 @@ namespace Ogre
         mRenderableVisible( true ),
         mPolygonModeOverrideable( true ),
         mUseIdentityProjection( false ),
-        mUseIdentityView( false )
+        mUseIdentityView( false ),
+        mPreSkinnedBuffer( 0 )
     {
     }
     //-----------------------------------------------------------------------------------
@@ -261,6 +262,19 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     TexBufferPacked *Renderable::getPoseTexBuffer() const { return mPoseData ? mPoseData->buffer : 0; }
     //-----------------------------------------------------------------------------------
+    void Renderable::_setPreSkinnedBuffer( ReadOnlyBufferPacked *buffer )
+    {
+        const bool wasPreSkinned = mPreSkinnedBuffer != 0;
+        mPreSkinnedBuffer = buffer;
+
+        if( wasPreSkinned != ( buffer != 0 ) && mHlmsDatablock )
+        {
+            uint32 hash, casterHash;
+            mHlmsDatablock->getCreator()->calculateHashFor( this, hash, casterHash );
+            this->_setHlmsHashes( hash, casterHash );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     RenderableAnimated::RenderableAnimated() : Renderable(), mBlendIndexToBoneIndexMap( 0 ) {}
     //-----------------------------------------------------------------------------------
     Renderable::PoseData::PoseData() :
@@ -1576,6 +1576,8 @@ namespace Ogre
     {
         // update all targets but don't swap buffers
         // mActiveRenderer->_updateAllRenderTargets(false);
+        // Finish loading meshes requested via loadAsync before culling & rendering
+        mMeshManager->_update();
         mCompositorManager2->_update();
 
         // give client app opportunity to use queued GPU time
@@ -1601,6 +1603,8 @@ namespace Ogre
     bool Root::_updateAllRenderTargets( FrameEvent &evt )
     {
         // update all targets but don't swap buffers
+        // Finish loading meshes requested via loadAsync before culling & rendering
+        mMeshManager->_update();
         mCompositorManager2->_update();
         // give client app opportunity to use queued GPU time
         bool ret = _fireFrameRenderingQueued( evt );
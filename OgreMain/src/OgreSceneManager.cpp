@@ -34,9 +34,11 @@ THE SOFTWARE.
 #include "Animation/OgreTagPoint2.h"
 #include "Compositor/OgreCompositorShadowNode.h"
 #include "Compositor/Pass/PassScene/OgreCompositorPassSceneDef.h"
+#include "Compute/OgreComputeSkinning.h"
 #include "Math/Array/OgreBooleanMask.h"
 #include "OgreAnimation.h"
 #include "OgreAtmosphereComponent.h"
+#include "OgreBatchedSceneQuery.h"
 #include "OgreBillboardChain.h"
 #include "OgreBillboardSet.h"
 #include "OgreCamera.h"
@@ -48,6 +50,7 @@ THE SOFTWARE.
 #include "OgreForwardClustered.h"
 #include "OgreGpuProgram.h"
 #include "OgreGpuProgramManager.h"
+#include "OgreHlmsCompute.h"
 #include "OgreHlmsManager.h"
 #include "OgreInternalCubemapProbe.h"
 #include "OgreItem.h"
@@ -116,6 +119,9 @@ namespace Ogre
     //-----------------------------------------------------------------------
     SceneManager::SceneManager( const String &name, size_t numWorkerThreads ) :
         IdObject( Id::generateNewId<SceneManager>() ),
+        mAnimationLodCamera( 0 ),
+        mAnimationLodCameraPos( Vector3::ZERO ),
+        mAnimationLodFrame( 0u ),
         mNumDecals( 0 ),
         mNumCubemapProbes( 0 ),
         mStaticMinDepthLevelDirty( 0 ),
@@ -135,6 +141,7 @@ namespace Ogre
         mEnvFeatures( 0u ),
         mParticleSystemManager2(
             new ParticleSystemManager2( this, Root::getSingleton().getParticleSystemManager2() ) ),
+        mComputeSkinning( 0 ),
         mCamerasInProgress( 0 ),
         mCurrentViewport0( 0 ),
         mCurrentPass( 0 ),
@@ -321,6 +328,9 @@ namespace Ogre
 
         delete mParticleSystemManager2;
 
+        OGRE_DELETE mComputeSkinning;
+        mComputeSkinning = 0;
+
         stopWorkerThreads();
     }
     //-----------------------------------------------------------------------
@@ -399,6 +409,9 @@ namespace Ogre
 
         checkMovableObjectIntegrity( mCameras, cam );
 
+        if( mAnimationLodCamera == cam )
+            mAnimationLodCamera = 0;
+
         {
             FrustumVec::iterator it = std::find( mVisibleCameras.begin(), mVisibleCameras.end(), cam );
             if( it != mVisibleCameras.end() )
@@ -841,6 +854,31 @@ namespace Ogre
         return mParticleSystemManager2->destroyAllBillboardSets();
     }
     //-----------------------------------------------------------------------
+    void SceneManager::setComputeSkinningEnabled( bool bEnabled )
+    {
+        if( bEnabled && !mComputeSkinning )
+        {
+            HlmsCompute *hlmsCompute = Root::getSingleton().getHlmsManager()->getComputeHlms();
+            HlmsComputeJob *computeJob =
+                hlmsCompute ? hlmsCompute->findComputeJobNoThrow( "Compute/Tools/Skinning" ) : 0;
+
+            if( !computeJob )
+            {
+                LogManager::getSingleton().logMessage(
+                    "Compute/Tools/Skinning not found. Include the resources bundled at "
+                    "Samples/Media/Compute/Tools. SubItems will keep using vertex shader skinning.",
+                    LML_CRITICAL );
+            }
+
+            mComputeSkinning = OGRE_NEW ComputeSkinning( mDestRenderSystem, hlmsCompute, computeJob );
+        }
+        else if( !bEnabled && mComputeSkinning )
+        {
+            OGRE_DELETE mComputeSkinning;
+            mComputeSkinning = 0;
+        }
+    }
+    //-----------------------------------------------------------------------
     void SceneManager::clearScene( bool deleteIndestructibleToo, bool reattachCameras )
     {
         destroyAllMovableObjects();
@@ -1731,7 +1769,10 @@ namespace Ogre
         {
             mWorkerThreadsBarrier->sync();  // Fire threads.
             mWorkerThreadsBarrier->sync();  // Wait them to complete stage 01.
-            mWorkerThreadsBarrier->sync();  // Wait them to complete stage 02.
+            const uint32 numSortStages = mParticleSystemManager2->_getNumSortStages();
+            for( uint32 i = 0u; i < numSortStages; ++i )
+                mWorkerThreadsBarrier->sync();  // Wait them to complete the previous stage.
+            mWorkerThreadsBarrier->sync();  // Wait them to complete stage 02 (or the last sort stage).
         }
     }
     //-----------------------------------------------------------------------
@@ -1826,7 +1867,8 @@ namespace Ogre
                     itByDef->skeletons.begin() + itByDef->threadStarts[threadIdx + 1];
                 while( itor != endt )
                 {
-                    ( *itor )->update();
+                    if( needsAnimationUpdate( *itor ) )
+                        ( *itor )->update();
                     ++itor;
                 }
 
@@ -1891,12 +1933,52 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------
+    bool SceneManager::needsAnimationUpdate( const SkeletonInstance *skeletonInstance ) const
+    {
+        const Node *parentNode = skeletonInstance->getParentNode();
+        if( !mAnimationLodCamera || !parentNode )
+            return true;
+
+        const Real lodBiasInverse = mAnimationLodCamera->_getLodBiasInverse();
+        const Real sqDistance =
+            mAnimationLodCameraPos.squaredDistance( parentNode->_getDerivedPosition() ) *
+            lodBiasInverse * lodBiasInverse;
+
+        uint32 updateInterval = 1u;
+        AnimationLodLevelVec::const_iterator itor = mAnimationLodLevels.begin();
+        AnimationLodLevelVec::const_iterator endt = mAnimationLodLevels.end();
+        while( itor != endt && sqDistance >= itor->distance * itor->distance )
+        {
+            updateInterval = itor->updateInterval;
+            ++itor;
+        }
+
+        if( updateInterval <= 1u )
+            return updateInterval == 1u;
+
+        return ( mAnimationLodFrame + skeletonInstance->_getAnimationLodPhase() ) % updateInterval ==
+               0u;
+    }
+    //-----------------------------------------------------------------------
     void SceneManager::updateAllAnimations()
     {
+        if( mAnimationLodCamera )
+        {
+            mAnimationLodCameraPos = mAnimationLodCamera->getDerivedPosition();
+            ++mAnimationLodFrame;
+        }
+
         mRequestType = UPDATE_ALL_ANIMATIONS;
         fireWorkerThreadsAndWait();
     }
     //-----------------------------------------------------------------------
+    void SceneManager::setAnimationLod( const Camera *camera, const AnimationLodLevelVec &levels )
+    {
+        mAnimationLodCamera = camera;
+        mAnimationLodLevels = levels;
+        std::sort( mAnimationLodLevels.begin(), mAnimationLodLevels.end() );
+    }
+    //-----------------------------------------------------------------------
     void SceneManager::updateAllTransformsThread( const UpdateTransformRequest &request,
                                                   size_t threadIdx )
     {
@@ -2192,9 +2274,16 @@ namespace Ogre
                     numObjs = std::min( numObjs, totalObjs - toAdvance );
                     objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
 
+                    const size_t prevNumVisibleObjs = outVisibleObjects.size();
                     MovableObject::cullFrustum( numObjs, objData, camera, outVisibleObjects,
                                                 preparedData );
 
+                    if( request.casterPass && mCurrentShadowNode )
+                    {
+                        mCurrentShadowNode->_cullCastersByReceivers( camera, outVisibleObjects,
+                                                                     prevNumVisibleObjs, threadIdx );
+                    }
+
                     if( mRenderQueue->getRenderQueueMode( currRqId ) == RenderQueue::FAST &&
                         request.addToRenderQueue )
                     {
@@ -2777,6 +2866,9 @@ namespace Ogre
 
         mParticleSystemManager2->update();
 
+        if( mComputeSkinning )
+            mComputeSkinning->_updateBoneMatrices();
+
         // Reset these
         mStaticMinDepthLevelDirty = std::numeric_limits<uint16>::max();
         mStaticEntitiesDirty = false;
@@ -4136,6 +4228,13 @@ namespace Ogre
         return q;
     }
     //---------------------------------------------------------------------
+    BatchedSceneQuery *SceneManager::createBatchedQuery( uint32 mask )
+    {
+        BatchedSceneQuery *q = OGRE_NEW BatchedSceneQuery( this );
+        q->setQueryMask( mask );
+        return q;
+    }
+    //---------------------------------------------------------------------
     IntersectionSceneQuery *SceneManager::createIntersectionQuery( uint32 mask )
     {
         DefaultIntersectionSceneQuery *q = OGRE_NEW DefaultIntersectionSceneQuery( this );
@@ -4776,11 +4875,21 @@ namespace Ogre
             mRenderQueue->_compileShadersThread( threadIdx );
             break;
         case PARTICLE_SYSTEM_MANAGER2:
+        {
             mParticleSystemManager2->_updateParallel01( threadIdx, mNumWorkerThreads );
             if( !mForceMainThread )
                 mWorkerThreadsBarrier->sync();
             mParticleSystemManager2->_updateParallel02( threadIdx, mNumWorkerThreads );
+
+            const uint32 numSortStages = mParticleSystemManager2->_getNumSortStages();
+            for( uint32 i = 0u; i < numSortStages; ++i )
+            {
+                if( !mForceMainThread )
+                    mWorkerThreadsBarrier->sync();
+                mParticleSystemManager2->_sortParallel( threadIdx, mNumWorkerThreads, i );
+            }
             break;
+        }
         case USER_UNIFORM_SCALABLE_TASK:
             mUserTask->execute( threadIdx, mNumWorkerThreads );
             break;
@@ -30,7 +30,9 @@ THE SOFTWARE.
 #include "OgreSceneQuery.h"
 
 #include "OgreException.h"
+#include "OgreItem.h"
 #include "OgreSceneManager.h"
+#include "OgreTriangleBvh.h"
 
 namespace Ogre
 {
@@ -143,6 +145,7 @@ namespace Ogre
     {
         mSortByDistance = false;
         mMaxResults = 0;
+        mTriangleAccurate = false;
     }
     //-----------------------------------------------------------------------
     RaySceneQuery::~RaySceneQuery() {}
@@ -202,6 +205,23 @@ namespace Ogre
         dets.distance = distance;
         dets.movable = obj;
         dets.worldFragment = NULL;
+        dets.subMeshIdx = 0u;
+        dets.triangleIdx = 0xFFFFFFFF;
+        dets.barycentric = Vector2::ZERO;
+
+        if( mTriangleAccurate && obj->getMovableType() == ItemFactory::FACTORY_TYPE_NAME )
+        {
+            TriangleRayHit hit;
+            size_t subMeshIdx;
+            if( !static_cast<Item *>( obj )->raycast( mRay, Math::POS_INFINITY, hit, subMeshIdx ) )
+                return true;  // The bounds were hit, but not the triangles
+
+            dets.distance = hit.distance;
+            dets.subMeshIdx = static_cast<uint32>( subMeshIdx );
+            dets.triangleIdx = hit.triangleIdx;
+            dets.barycentric = hit.barycentric;
+        }
+
         mResult.push_back( dets );
         // Continue
         return true;
@@ -214,6 +234,9 @@ namespace Ogre
         dets.distance = distance;
         dets.movable = NULL;
         dets.worldFragment = fragment;
+        dets.subMeshIdx = 0u;
+        dets.triangleIdx = 0xFFFFFFFF;
+        dets.barycentric = Vector2::ZERO;
         mResult.push_back( dets );
         // Continue
         return true;
@@ -37,12 +37,41 @@ THE SOFTWARE.
 #include "OgreMesh2.h"
 #include "OgreStringConverter.h"
 #include "OgreSubMesh.h"
+#include "OgreTriangleBvh.h"
 #include "OgreVertexShadowMapHelper.h"
 #include "Vao/OgreAsyncTicket.h"
 #include "Vao/OgreVaoManager.h"
 
 namespace Ogre
 {
+    /// Maps a unit vector to the [-1; 1] square by projecting it onto an octahedron
+    /// and unfolding the lower half. Must match the decoding done by the Hlms shaders.
+    static void octahedralEncode( Vector3 normal, float outOct[2] )
+    {
+        const Real sumAbs = Math::Abs( normal.x ) + Math::Abs( normal.y ) + Math::Abs( normal.z );
+        if( sumAbs > Real( 0 ) )
+            normal /= sumAbs;
+        if( normal.z >= 0 )
+        {
+            outOct[0] = normal.x;
+            outOct[1] = normal.y;
+        }
+        else
+        {
+            outOct[0] = ( 1.0f - Math::Abs( normal.y ) ) * ( normal.x >= 0 ? 1.0f : -1.0f );
+            outOct[1] = ( 1.0f - Math::Abs( normal.x ) ) * ( normal.y >= 0 ? 1.0f : -1.0f );
+        }
+    }
+    //-----------------------------------------------------------------------
+    static Vector3 octahedralDecode( const float oct[2] )
+    {
+        Vector3 normal( oct[0], oct[1], 1.0f - Math::Abs( oct[0] ) - Math::Abs( oct[1] ) );
+        const Real fold = Math::saturate( -normal.z );
+        normal.x += normal.x >= 0 ? -fold : fold;
+        normal.y += normal.y >= 0 ? -fold : fold;
+        normal.normalise();
+        return normal;
+    }
     //-----------------------------------------------------------------------
     SubMesh::SubMesh() :
         mParent( 0 ),
@@ -50,12 +79,14 @@ namespace Ogre
         mNumPoses( 0 ),
         mPoseHalfPrecision( false ),
         mPoseNormals( false ),
-        mPoseTexBuffer( 0 )
+        mPoseTexBuffer( 0 ),
+        mTriangleBvh( 0 )
     {
     }
     //-----------------------------------------------------------------------
     SubMesh::~SubMesh()
     {
+        _invalidateTriangleBvh();
         destroyShadowMappingVaos();
         destroyVaos( mVao[VpNormal], mParent->mVaoManager );
 
@@ -297,6 +328,7 @@ namespace Ogre
             const OperationType opType = mVao[VpNormal][0]->getOperationType();
             IndexBufferPacked *indexBuffer = mVao[VpNormal][0]->getIndexBuffer();
             destroyVaos( mVao[VpNormal], mParent->mVaoManager, false );
+            _invalidateTriangleBvh();
 
             VertexBufferPackedVec vertexBuffers( 1u, vertexBuffer );
             VertexArrayObject *vao =
@@ -460,6 +492,31 @@ namespace Ogre
         mBoneAssignmentsOutOfDate = false;
     }
     //---------------------------------------------------------------------
+    void SubMesh::_setMeshlets( const MeshletVec &meshlets )
+    {
+        mMeshlets = meshlets;
+        if( !mVao[VpNormal].empty() )
+            mVao[VpNormal][0]->mMeshlets = mMeshlets.empty() ? 0 : &mMeshlets;
+    }
+    //---------------------------------------------------------------------
+    const TriangleBvh *SubMesh::getTriangleBvh()
+    {
+        if( !mTriangleBvh && !mVao[VpNormal].empty() &&
+            mVao[VpNormal][0]->getOperationType() == OT_TRIANGLE_LIST )
+        {
+            mTriangleBvh = OGRE_NEW TriangleBvh();
+            mTriangleBvh->build( mVao[VpNormal][0] );
+        }
+
+        return mTriangleBvh;
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::_invalidateTriangleBvh()
+    {
+        OGRE_DELETE mTriangleBvh;
+        mTriangleBvh = 0;
+    }
+    //---------------------------------------------------------------------
     SubMesh *SubMesh::clone( Mesh *parentMesh, int vertexBufferType, int indexBufferType )
     {
         SubMesh *newSub;
@@ -497,6 +554,9 @@ namespace Ogre
         if( numVaoPasses == 1 )
             newSub->mVao[VpShadow] = newSub->mVao[VpNormal];
 
+        if( !mMeshlets.empty() )
+            newSub->_setMeshlets( mMeshlets );
+
         return 0;
     }
     //---------------------------------------------------------------------
@@ -526,6 +586,7 @@ namespace Ogre
         mBlendIndexToBoneIndexMap = subMesh->blendIndexToBoneIndexMap;
         mBoneAssignmentsOutOfDate = false;
 
+        _invalidateTriangleBvh();
         importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, halfPose, 0 );
 
         assert( subMesh->parent->hasValidShadowMappingBuffers() );
@@ -804,7 +865,8 @@ namespace Ogre
                                                                 buffer, false );
     }
     //---------------------------------------------------------------------
-    void SubMesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents )
+    void SubMesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                                    bool octahedralNormals )
     {
         uint8 numVaoPasses = mParent->hasIndependentShadowMappingVaos() + 1;
 
@@ -818,8 +880,9 @@ namespace Ogre
 
             while( itor != endt )
             {
-                newVaos.push_back( arrangeEfficient( halfPos, halfTexCoords, qTangents, *itor,
-                                                     sharedBuffers, mParent->mVaoManager ) );
+                newVaos.push_back( arrangeEfficient( halfPos, halfTexCoords, qTangents,
+                                                     octahedralNormals, *itor, sharedBuffers,
+                                                     mParent->mVaoManager ) );
                 ++itor;
             }
 
@@ -832,10 +895,12 @@ namespace Ogre
         // If we shared vaos, we need to share the new Vaos (and remove the dangling pointers)
         if( numVaoPasses == 1 )
             mVao[VpShadow] = mVao[VpNormal];
+
+        _invalidateTriangleBvh();
     }
     //---------------------------------------------------------------------
     VertexArrayObject *SubMesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
-                                                  VertexArrayObject *vao,
+                                                  bool octahedralNormals, VertexArrayObject *vao,
                                                   SharedVertexBufferMap &sharedBuffers,
                                                   VaoManager *vaoManager )
     {
@@ -924,6 +989,16 @@ namespace Ogre
                 }
             }
 
+            // Normals that didn't become QTangents can still be packed into 2 shorts
+            if( octahedralNormals )
+            {
+                VertexElement2Vec::iterator it =
+                    std::find( vertexElements.begin(), vertexElements.end(),
+                               VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+                if( it != vertexElements.end() )
+                    it->mType = VET_SHORT2_SNORM;
+            }
+
             char *data =
                 _arrangeEfficient( srcData, vertexElements, vertexBuffers[0]->getNumElements() );
             FreeOnDestructor dataPtrContainer( data );
@@ -1266,6 +1341,20 @@ namespace Ogre
                     dstData16[2] = Bitwise::floatToSnorm16( qTangent.z );
                     dstData16[3] = Bitwise::floatToSnorm16( qTangent.w );
                 }
+                else if( vElement.mSemantic == VES_NORMAL && vElement.mType == VET_SHORT2_SNORM &&
+                         itSrc->element.mType == VET_FLOAT3 )
+                {
+                    // Octahedral normals
+                    float normal[3];
+                    memcpy( normal, itSrc->data, sizeof( normal ) );
+
+                    float octNormal[2];
+                    octahedralEncode( Vector3( normal[0], normal[1], normal[2] ), octNormal );
+
+                    int16 *dstData16 = reinterpret_cast<int16 *>( dstData + acumOffset );
+                    dstData16[0] = Bitwise::floatToSnorm16( octNormal[0] );
+                    dstData16[1] = Bitwise::floatToSnorm16( octNormal[1] );
+                }
                 else if( v1::VertexElement::getBaseType( vElement.mType ) == VET_HALF2 &&
                          v1::VertexElement::getBaseType( itSrc->element.mType ) == VET_FLOAT1 )
                 {
@@ -1330,6 +1419,8 @@ namespace Ogre
         // If we shared vaos, we need to share the new Vaos (and remove the dangling pointers)
         if( numVaoPasses == 1 )
             mVao[VpShadow] = mVao[VpNormal];
+
+        _invalidateTriangleBvh();
     }
     //---------------------------------------------------------------------
     VertexArrayObject *SubMesh::dearrangeEfficient( const VertexArrayObject *vao,
@@ -1413,6 +1504,11 @@ namespace Ogre
                 newVertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
                 newVertexElements.push_back( VertexElement2( VET_FLOAT4, VES_TANGENT ) );
             }
+            else if( element.mSemantic == VES_NORMAL && element.mType == VET_SHORT2_SNORM )
+            {
+                // Dealing with octahedral normals.
+                newVertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+            }
             else
             {
                 // Send through
@@ -1479,6 +1575,21 @@ namespace Ogre
 
                     dstData += 7 * sizeof( float );
                 }
+                else if( itElements->mSemantic == VES_NORMAL && itElements->mType == VET_SHORT2_SNORM )
+                {
+                    // Dealing with octahedral normals.
+                    const int16 *srcData16 = reinterpret_cast<const int16 *>( srcData );
+                    const float octNormal[2] = { Bitwise::snorm16ToFloat( srcData16[0] ),
+                                                 Bitwise::snorm16ToFloat( srcData16[1] ) };
+                    const Vector3 vNormal = octahedralDecode( octNormal );
+
+                    float *dstDataF32 = reinterpret_cast<float *>( dstData );
+                    dstDataF32[0] = vNormal.x;
+                    dstDataF32[1] = vNormal.y;
+                    dstDataF32[2] = vNormal.z;
+
+                    dstData += 3 * sizeof( float );
+                }
                 else
                 {
                     // Raw. Transfer as is.
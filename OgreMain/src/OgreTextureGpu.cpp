@@ -941,6 +941,24 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     bool TextureGpu::isTextureGpu() const { return true; }
     //-----------------------------------------------------------------------------------
+    void TextureGpu::_touch() const
+    {
+        GpuResource::_touch();
+
+        if( mTexturePool && mTexturePool->masterTexture->mLastFrameUsed != mLastFrameUsed )
+        {
+            mTexturePool->masterTexture->mLastFrameUsed = mLastFrameUsed;
+
+            TextureGpuVec::const_iterator itor = mTexturePool->usedSlots.begin();
+            TextureGpuVec::const_iterator endt = mTexturePool->usedSlots.end();
+            while( itor != endt )
+            {
+                ( *itor )->mLastFrameUsed = mLastFrameUsed;
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
     TextureGpuManager *TextureGpu::getTextureManager() const { return mTextureManager; }
     //-----------------------------------------------------------------------------------
     TextureBox TextureGpu::getEmptyBox( uint8 mipLevel )
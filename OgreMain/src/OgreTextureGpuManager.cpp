@@ -47,9 +47,12 @@ THE SOFTWARE.
 #include "OgreResourceGroupManager.h"
 #include "OgreStagingTexture.h"
 #include "OgreString.h"
+#include "OgreStringConverter.h"
 #include "OgreTextureFilters.h"
 #include "OgreTextureGpu.h"
 #include "OgreTextureGpuManagerListener.h"
+#include "OgreTextureReadbackQueue.h"
+#include "OgreTextureResidencyManager.h"
 #ifdef OGRE_PROFILING_TEXTURES
 #    include "OgreTimer.h"
 #endif
@@ -119,6 +122,10 @@ namespace Ogre
 #else
         mStagingTextureMaxBudgetBytes( 128u * 1024u * 1024u ),
 #endif
+        mNextTextureLoadOrder( 0u ),
+        mMetadataCacheRecordingStartFrame( 0u ),
+        mReadbackQueue( 0 ),
+        mResidencyManager( 0 ),
         mDelayListenerCalls( false ),
         mIgnoreScheduledTasks( false ),
 #ifdef OGRE_PROFILING_TEXTURES
@@ -222,6 +229,12 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void TextureGpuManager::destroyAll()
     {
+        // Must go before destroyAllAsyncTextureTicket, it owns some of them
+        delete mReadbackQueue;
+        mReadbackQueue = 0;
+        delete mResidencyManager;
+        mResidencyManager = 0;
+
         mMutex.lock();
         abortAllRequests();
         destroyAllStagingBuffers();
@@ -337,19 +350,20 @@ namespace Ogre
         mTexturePool.clear();
     }
     //-----------------------------------------------------------------------------------
-    TextureGpu *TextureGpuManager::reservePoolId( uint32 poolId, uint32 width, uint32 height,
-                                                  uint32 numSlices, uint8 numMipmaps,
-                                                  PixelFormatGpu pixelFormat )
+    TexturePool &TextureGpuManager::createTexturePool( uint32 poolId, uint32 width, uint32 height,
+                                                       uint32 numSlices, uint8 numMipmaps,
+                                                       PixelFormatGpu pixelFormat,
+                                                       bool manuallyReserved )
     {
         IdType newId = Id::generateNewId<TextureGpuManager>();
         char tmpBuffer[64];
         LwString texName( LwString::FromEmptyPointer( tmpBuffer, sizeof( tmpBuffer ) ) );
-        texName.a( "_ReservedTex", newId );
+        texName.a( manuallyReserved ? "_ReservedTex" : "_InternalTex", newId );
 
         TexturePool newPool;
         newPool.masterTexture = createTextureImpl( GpuPageOutStrategy::Discard, texName.c_str(),
                                                    TextureFlags::PoolOwner, TextureTypes::Type2DArray );
-        newPool.manuallyReserved = true;
+        newPool.manuallyReserved = manuallyReserved;
         newPool.usedMemory = 0;
         newPool.usedSlots.reserve( numSlices );
 
@@ -364,6 +378,15 @@ namespace Ogre
         newPool.masterTexture->_transitionTo( GpuResidency::Resident, 0 );
         newPool.masterTexture->notifyDataIsReady();
 
+        return mTexturePool.back();
+    }
+    //-----------------------------------------------------------------------------------
+    TextureGpu *TextureGpuManager::reservePoolId( uint32 poolId, uint32 width, uint32 height,
+                                                  uint32 numSlices, uint8 numMipmaps,
+                                                  PixelFormatGpu pixelFormat )
+    {
+        TexturePool &newPool =
+            createTexturePool( poolId, width, height, numSlices, numMipmaps, pixelFormat, true );
         return newPool.masterTexture;
     }
     //-----------------------------------------------------------------------------------
@@ -786,6 +809,20 @@ namespace Ogre
         efficientVectorRemove( mAsyncTextureTickets, itor );
     }
     //-----------------------------------------------------------------------------------
+    TextureReadbackQueue *TextureGpuManager::getReadbackQueue()
+    {
+        if( !mReadbackQueue )
+            mReadbackQueue = new TextureReadbackQueue( this, mVaoManager );
+        return mReadbackQueue;
+    }
+    //-----------------------------------------------------------------------------------
+    TextureResidencyManager *TextureGpuManager::getResidencyManager()
+    {
+        if( !mResidencyManager )
+            mResidencyManager = new TextureResidencyManager( this, mVaoManager );
+        return mResidencyManager;
+    }
+    //-----------------------------------------------------------------------------------
     void TextureGpuManager::destroyAllAsyncTextureTicket()
     {
         AsyncTextureTicketVec::const_iterator itor = mAsyncTextureTickets.begin();
@@ -912,7 +949,13 @@ namespace Ogre
         pixelFormat( PFG_UNKNOWN ),
         poolId( 0 ),
         textureType( TextureTypes::Unknown ),
-        numMipmaps( 0 )
+        numMipmaps( 0 ),
+        textureFlags( 0 ),
+        filters( 0 ),
+        pageOutStrategy( GpuPageOutStrategy::Discard ),
+        loadOrder( std::numeric_limits<uint32>::max() ),
+        firstUseFrame( std::numeric_limits<uint32>::max() ),
+        sizeBytes( 0 )
     {
     }
     //-----------------------------------------------------------------------------------
@@ -933,6 +976,17 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
+    void TextureGpuManager::recordTextureFirstUse( TextureGpu *texture )
+    {
+        if( mTextureFirstUse.find( texture->getName() ) == mTextureFirstUse.end() )
+        {
+            TextureFirstUse firstUse;
+            firstUse.loadOrder = mNextTextureLoadOrder++;
+            firstUse.frame = mVaoManager->getFrameCount() - mMetadataCacheRecordingStartFrame;
+            mTextureFirstUse[texture->getName()] = firstUse;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void TextureGpuManager::_updateMetadataCache( TextureGpu *texture )
     {
         ResourceEntryMap::const_iterator itor = mEntries.find( texture->getName() );
@@ -941,7 +995,6 @@ namespace Ogre
         {
             MetadataCacheEntry entry;
             entry.aliasName = itor->second.alias;
-            // entry.resourceName = itor->second.name;
             entry.width = texture->getWidth();
             entry.height = texture->getHeight();
             entry.depthOrSlices = texture->getDepthOrSlices();
@@ -950,6 +1003,30 @@ namespace Ogre
             entry.textureType = texture->getTextureType();
             entry.numMipmaps = texture->getNumMipmaps();
 
+            entry.resourceName = itor->second.name;
+            entry.resourceGroup = itor->second.resourceGroup;
+            entry.textureFlags = texture->getTextureFlags();
+            entry.filters = itor->second.filters;
+            entry.pageOutStrategy = static_cast<uint8>( texture->getGpuPageOutStrategy() );
+            entry.sizeBytes = texture->getSizeBytes();
+
+            TextureFirstUseMap::const_iterator itFirstUse = mTextureFirstUse.find( texture->getName() );
+            if( itFirstUse != mTextureFirstUse.end() )
+            {
+                entry.loadOrder = itFirstUse->second.loadOrder;
+                entry.firstUseFrame = itFirstUse->second.frame;
+            }
+            else
+            {
+                // Keep what was recorded in a previous session (i.e. imported from file)
+                MetadataCacheMap::const_iterator itOld = mMetadataCache.find( texture->getName() );
+                if( itOld != mMetadataCache.end() )
+                {
+                    entry.loadOrder = itOld->second.loadOrder;
+                    entry.firstUseFrame = itOld->second.firstUseFrame;
+                }
+            }
+
             mMetadataCache[texture->getName()] = entry;
         }
     }
@@ -1025,6 +1102,54 @@ namespace Ogre
             }
         }
 
+        itor = d.FindMember( "pools" );
+        if( itor != d.MemberEnd() && itor->value.IsArray() )
+        {
+            mPrewarmPools.clear();
+
+            const rapidjson::Value &jsonVal = itor->value;
+            const rapidjson::SizeType arraySize = jsonVal.Size();
+            for( rapidjson::SizeType i = 0; i < arraySize; ++i )
+            {
+                if( jsonVal[i].IsObject() )
+                {
+                    MetadataCacheEntry entry;
+
+                    itor = jsonVal[i].FindMember( "poolId" );
+                    if( itor != jsonVal[i].MemberEnd() && itor->value.IsUint() )
+                        entry.poolId = itor->value.GetUint();
+
+                    itor = jsonVal[i].FindMember( "resolution" );
+                    if( itor != jsonVal[i].MemberEnd() && itor->value.IsArray() &&
+                        itor->value.Size() >= 3u && itor->value[0].IsUint() && itor->value[1].IsUint() &&
+                        itor->value[2].IsUint() )
+                    {
+                        entry.width = itor->value[0].GetUint();
+                        entry.height = itor->value[1].GetUint();
+                        entry.depthOrSlices = itor->value[2].GetUint();
+                    }
+
+                    entry.numMipmaps = 1u;
+                    itor = jsonVal[i].FindMember( "mipmaps" );
+                    if( itor != jsonVal[i].MemberEnd() && itor->value.IsUint() )
+                        entry.numMipmaps = static_cast<uint8>( itor->value.GetUint() );
+
+                    itor = jsonVal[i].FindMember( "format" );
+                    if( itor != jsonVal[i].MemberEnd() && itor->value.IsString() )
+                    {
+                        entry.pixelFormat =
+                            PixelFormatGpuUtils::getFormatFromName( itor->value.GetString() );
+                    }
+
+                    if( entry.width > 0u && entry.height > 0u && entry.depthOrSlices > 0u &&
+                        entry.pixelFormat != PFG_UNKNOWN )
+                    {
+                        mPrewarmPools.push_back( entry );
+                    }
+                }
+            }
+        }
+
         itor = d.FindMember( "textures" );
         if( itor != d.MemberEnd() && itor->value.IsObject() )
         {
@@ -1074,6 +1199,42 @@ namespace Ogre
                             PixelFormatGpuUtils::getFormatFromName( itor->value.GetString() );
                     }
 
+                    itor = itTex->value.FindMember( "resource" );
+                    if( itor != itTex->value.MemberEnd() && itor->value.IsString() )
+                        entry.resourceName = itor->value.GetString();
+
+                    itor = itTex->value.FindMember( "resource_group" );
+                    if( itor != itTex->value.MemberEnd() && itor->value.IsString() )
+                        entry.resourceGroup = itor->value.GetString();
+
+                    itor = itTex->value.FindMember( "texture_flags" );
+                    if( itor != itTex->value.MemberEnd() && itor->value.IsUint() )
+                        entry.textureFlags = itor->value.GetUint();
+
+                    itor = itTex->value.FindMember( "filters" );
+                    if( itor != itTex->value.MemberEnd() && itor->value.IsUint() )
+                        entry.filters = itor->value.GetUint();
+
+                    itor = itTex->value.FindMember( "page_out_strategy" );
+                    if( itor != itTex->value.MemberEnd() && itor->value.IsUint() )
+                    {
+                        entry.pageOutStrategy = static_cast<uint8>( Math::Clamp<uint32>(
+                            itor->value.GetUint(), 0u,
+                            GpuPageOutStrategy::AlwaysKeepSystemRamCopy ) );
+                    }
+
+                    itor = itTex->value.FindMember( "load_order" );
+                    if( itor != itTex->value.MemberEnd() && itor->value.IsUint() )
+                        entry.loadOrder = itor->value.GetUint();
+
+                    itor = itTex->value.FindMember( "first_use_frame" );
+                    if( itor != itTex->value.MemberEnd() && itor->value.IsUint() )
+                        entry.firstUseFrame = itor->value.GetUint();
+
+                    itor = itTex->value.FindMember( "size_bytes" );
+                    if( itor != itTex->value.MemberEnd() && itor->value.IsUint64() )
+                        entry.sizeBytes = static_cast<size_t>( itor->value.GetUint64() );
+
                     mMetadataCache[aliasName] = entry;
                 }
 
@@ -1125,6 +1286,38 @@ namespace Ogre
             }
         }
 
+        jsonStr.a( "\n\t],\n\t\"pools\" :\n\t[" );
+
+        firstIteration = true;
+        {
+            TexturePoolList::const_iterator itor = mTexturePool.begin();
+            TexturePoolList::const_iterator endt = mTexturePool.end();
+
+            while( itor != endt )
+            {
+                const TexturePool &pool = *itor;
+                if( !pool.manuallyReserved )
+                {
+                    if( !firstIteration )
+                        jsonStr.a( "," );
+                    jsonStr.a( "\n\t\t{\n\t\t\t\"poolId\" : ", pool.masterTexture->getTexturePoolId() );
+                    jsonStr.a( ",\n\t\t\t\"resolution\" : [", pool.masterTexture->getWidth(), ", ",
+                               pool.masterTexture->getHeight(), ", ",
+                               pool.masterTexture->getDepthOrSlices(), "]" );
+                    jsonStr.a( ",\n\t\t\t\"mipmaps\" : ", pool.masterTexture->getNumMipmaps() );
+                    jsonStr.a( ",\n\t\t\t\"format\" : \"",
+                               PixelFormatGpuUtils::toString( pool.masterTexture->getPixelFormat() ),
+                               "\"" );
+                    jsonStr.a( "\n\t\t}" );
+                    firstIteration = false;
+
+                    outJson += jsonStr.c_str();
+                    jsonStr.clear();
+                }
+                ++itor;
+            }
+        }
+
         jsonStr.a( "\n\t],\n\t\"textures\" :\n\t{" );
         firstIteration = true;
         MetadataCacheMap::const_iterator itor = mMetadataCache.begin();
@@ -1146,6 +1339,20 @@ namespace Ogre
                        "\"" );
             jsonStr.a( ",\n\t\t\t\"texture_type\" : ", (int)entry.textureType );
             jsonStr.a( ",\n\t\t\t\"poolId\" : ", entry.poolId );
+            if( !entry.resourceName.empty() )
+            {
+                jsonStr.a( ",\n\t\t\t\"resource\" : \"", entry.resourceName.c_str(), "\"" );
+                jsonStr.a( ",\n\t\t\t\"resource_group\" : \"", entry.resourceGroup.c_str(), "\"" );
+                jsonStr.a( ",\n\t\t\t\"texture_flags\" : ", entry.textureFlags );
+                jsonStr.a( ",\n\t\t\t\"filters\" : ", entry.filters );
+                jsonStr.a( ",\n\t\t\t\"page_out_strategy\" : ", (uint32)entry.pageOutStrategy );
+                if( entry.loadOrder != std::numeric_limits<uint32>::max() )
+                {
+                    jsonStr.a( ",\n\t\t\t\"load_order\" : ", entry.loadOrder );
+                    jsonStr.a( ",\n\t\t\t\"first_use_frame\" : ", entry.firstUseFrame );
+                }
+                jsonStr.a( ",\n\t\t\t\"size_bytes\" : ", (uint64)entry.sizeBytes );
+            }
             jsonStr.a( "\n\t\t}" );
 
             outJson += jsonStr.c_str();
@@ -1160,6 +1367,131 @@ namespace Ogre
         jsonStr.clear();
     }
     //-----------------------------------------------------------------------------------
+    void TextureGpuManager::restartTextureMetadataCacheRecording()
+    {
+        mTextureFirstUse.clear();
+        mNextTextureLoadOrder = 0u;
+        mMetadataCacheRecordingStartFrame = mVaoManager->getFrameCount();
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TextureGpuManager::prewarmFromTextureMetadataCache( uint32 maxFirstUseFrame )
+    {
+        OgreProfileExhaustive( "TextureGpuManager::prewarmFromTextureMetadataCache" );
+
+        // Preallocate pools. We only create the ones that are missing; a pool recorded
+        // N times (because the first one got full) gets recreated N times.
+        {
+            MetadataCacheEntryVec::const_iterator itor = mPrewarmPools.begin();
+            MetadataCacheEntryVec::const_iterator endt = mPrewarmPools.end();
+
+            while( itor != endt )
+            {
+                size_t numRecorded = 0u;
+                size_t numExisting = 0u;
+
+                MetadataCacheEntryVec::const_iterator itOther = mPrewarmPools.begin();
+                while( itOther != itor )
+                {
+                    if( itOther->poolId == itor->poolId && itOther->width == itor->width &&
+                        itOther->height == itor->height && itOther->numMipmaps == itor->numMipmaps &&
+                        itOther->pixelFormat == itor->pixelFormat )
+                    {
+                        ++numRecorded;
+                    }
+                    ++itOther;
+                }
+
+                TexturePoolList::const_iterator itPool = mTexturePool.begin();
+                TexturePoolList::const_iterator enPool = mTexturePool.end();
+                while( itPool != enPool )
+                {
+                    const TextureGpu *masterTex = itPool->masterTexture;
+                    if( !itPool->manuallyReserved && masterTex->getTexturePoolId() == itor->poolId &&
+                        masterTex->getWidth() == itor->width && masterTex->getHeight() == itor->height &&
+                        masterTex->getNumMipmaps() == itor->numMipmaps &&
+                        masterTex->getPixelFormat() == itor->pixelFormat )
+                    {
+                        ++numExisting;
+                    }
+                    ++itPool;
+                }
+
+                if( numExisting <= numRecorded )
+                {
+                    createTexturePool( itor->poolId, itor->width, itor->height, itor->depthOrSlices,
+                                       itor->numMipmaps, itor->pixelFormat, false );
+                }
+
+                ++itor;
+            }
+        }
+
+        // Sort by first use. Ties are broken by load order
+        typedef std::pair<uint64, const MetadataCacheEntry *> OrderedEntry;
+        vector<OrderedEntry>::type orderedEntries;
+        orderedEntries.reserve( mMetadataCache.size() );
+
+        {
+            MetadataCacheMap::const_iterator itor = mMetadataCache.begin();
+            MetadataCacheMap::const_iterator endt = mMetadataCache.end();
+
+            while( itor != endt )
+            {
+                const MetadataCacheEntry &entry = itor->second;
+                if( !entry.resourceName.empty() &&
+                    entry.loadOrder != std::numeric_limits<uint32>::max() &&
+                    entry.firstUseFrame <= maxFirstUseFrame )
+                {
+                    const uint64 key = ( uint64( entry.firstUseFrame ) << 32u ) | entry.loadOrder;
+                    orderedEntries.push_back( OrderedEntry( key, &entry ) );
+                }
+                ++itor;
+            }
+        }
+
+        std::sort( orderedEntries.begin(), orderedEntries.end() );
+
+        size_t numScheduled = 0u;
+        size_t bytesScheduled = 0u;
+
+        vector<OrderedEntry>::type::const_iterator itor = orderedEntries.begin();
+        vector<OrderedEntry>::type::const_iterator endt = orderedEntries.end();
+
+        while( itor != endt )
+        {
+            const MetadataCacheEntry &entry = *itor->second;
+
+            TextureGpu *texture = findTextureNoThrow( entry.aliasName );
+            if( !texture )
+            {
+                const TextureTypes::TextureTypes textureType =
+                    ( entry.textureFlags & TextureFlags::AutomaticBatching ) ? TextureTypes::Type2D
+                                                                             : entry.textureType;
+                texture = createTexture(
+                    entry.resourceName, entry.aliasName,
+                    static_cast<GpuPageOutStrategy::GpuPageOutStrategy>( entry.pageOutStrategy ),
+                    entry.textureFlags, textureType, entry.resourceGroup, entry.filters,
+                    entry.poolId );
+            }
+
+            if( texture->getNextResidencyStatus() == GpuResidency::OnStorage &&
+                texture->getPendingResidencyChanges() == 0u )
+            {
+                texture->scheduleTransitionTo( GpuResidency::Resident );
+                ++numScheduled;
+                bytesScheduled += entry.sizeBytes;
+            }
+
+            ++itor;
+        }
+
+        LogManager::getSingleton().logMessage(
+            "Texture metadata cache prewarm: scheduled " + StringConverter::toString( numScheduled ) +
+            " textures (" + StringConverter::toString( bytesScheduled / ( 1024u * 1024u ) ) + " MB)" );
+
+        return numScheduled;
+    }
+    //-----------------------------------------------------------------------------------
     void TextureGpuManager::getMemoryStats( size_t &outTextureBytesCpu, size_t &outTextureBytesGpu,
                                             size_t &outUsedStagingTextureBytes,
                                             size_t &outAvailableStagingTextureBytes )
@@ -1784,6 +2116,9 @@ namespace Ogre
             }
         }
 
+        if( !toSysRam && !reuploadOnly && sliceOrDepth == std::numeric_limits<uint32>::max() )
+            recordTextureFirstUse( texture );
+
         if( !skipMetadataCache && !toSysRam && !reuploadOnly &&
             texture->getGpuPageOutStrategy() != GpuPageOutStrategy::AlwaysKeepSystemRamCopy )
         {
@@ -2137,33 +2472,11 @@ namespace Ogre
 
         if( itor == endt )
         {
-            IdType newId = Id::generateNewId<TextureGpuManager>();
-            char tmpBuffer[64];
-            LwString texName( LwString::FromEmptyPointer( tmpBuffer, sizeof( tmpBuffer ) ) );
-            texName.a( "_InternalTex", newId );
-
-            TexturePool newPool;
-            newPool.masterTexture =
-                createTextureImpl( GpuPageOutStrategy::Discard, texName.c_str(), TextureFlags::PoolOwner,
-                                   TextureTypes::Type2DArray );
             const uint16 numSlices =
                 (uint16)mTextureGpuManagerListener->getNumSlicesFor( texture, this );
-            newPool.masterTexture->_setSourceType( TextureSourceType::PoolOwner );
-
-            newPool.manuallyReserved = false;
-            newPool.usedMemory = 0;
-            newPool.usedSlots.reserve( numSlices );
-
-            newPool.masterTexture->setResolution( texture->getWidth(), texture->getHeight(), numSlices );
-            newPool.masterTexture->setPixelFormat( texture->getPixelFormat() );
-            newPool.masterTexture->setNumMipmaps( texture->getNumMipmaps() );
-            newPool.masterTexture->setTexturePoolId( texture->getTexturePoolId() );
-
-            mTexturePool.push_back( newPool );
+            createTexturePool( texture->getTexturePoolId(), texture->getWidth(), texture->getHeight(),
+                               numSlices, texture->getNumMipmaps(), texture->getPixelFormat(), false );
             itor = --mTexturePool.end();
-
-            itor->masterTexture->_transitionTo( GpuResidency::Resident, 0 );
-            itor->masterTexture->notifyDataIsReady();
         }
 
         uint16 sliceIdx = 0;
@@ -3590,6 +3903,11 @@ namespace Ogre
 
         processDownloadToRamQueue();
 
+        if( mReadbackQueue )
+            mReadbackQueue->_update();
+        if( mResidencyManager )
+            mResidencyManager->_update();
+
         // After we've checked mainData.loadRequests.empty() inside the lock;
         // we may have added more entries to it due to pending ScheduledTasks that got
         // flushed either by mainData.objCmdBuffer or processDownloadToRamQueue,
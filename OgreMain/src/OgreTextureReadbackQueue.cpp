@@ -0,0 +1,502 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreTextureReadbackQueue.h"
+
+#include "OgreAsyncTextureTicket.h"
+#include "OgreException.h"
+#include "OgreImage2.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreProfiler.h"
+#include "OgreTextureGpuManager.h"
+#include "Vao/OgreVaoManager.h"
+
+namespace Ogre
+{
+    unsigned long textureReadbackWorkerThread( ThreadHandle *threadHandle );
+    THREAD_DECLARE( textureReadbackWorkerThread );
+
+    TextureReadbackListener::~TextureReadbackListener() {}
+    //-----------------------------------------------------------------------------------
+    TextureReadbackQueue::TextureReadbackQueue( TextureGpuManager *textureGpuManager,
+                                                VaoManager        *vaoManager ) :
+        mTextureGpuManager( textureGpuManager ),
+        mVaoManager( vaoManager ),
+        mNextRequestId( 1u ),
+        mMaxPendingRequests( 8u ),
+        mMaxIdleFrames( 5u ),
+        mWorkerSemaphore( 0u ),
+        mWorkerJobInProgress( 0u ),
+        mShuttingDown( false )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    TextureReadbackQueue::~TextureReadbackQueue()
+    {
+        // Lets the worker finish what it already has
+        stopWorkerThread();
+
+        PendingRequestDeque::const_iterator itor = mPendingRequests.begin();
+        PendingRequestDeque::const_iterator endt = mPendingRequests.end();
+
+        while( itor != endt )
+        {
+            mTextureGpuManager->destroyAsyncTextureTicket( itor->ticket );
+            ++itor;
+        }
+        mPendingRequests.clear();
+
+        CompletedDownloadMap::iterator itDownload = mCompletedDownloads.begin();
+        CompletedDownloadMap::iterator enDownload = mCompletedDownloads.end();
+
+        while( itDownload != enDownload )
+        {
+            freeCompletedDownload( itDownload->second );
+            ++itDownload;
+        }
+        mCompletedDownloads.clear();
+
+        destroyAvailableTickets();
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureReadbackQueue::startWorkerThread()
+    {
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        if( !mWorkerThread )
+        {
+            mShuttingDown = false;
+            mWorkerThread =
+                Threads::CreateThread( THREAD_GET( textureReadbackWorkerThread ), 0, this );
+        }
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureReadbackQueue::stopWorkerThread()
+    {
+        if( mWorkerThread )
+        {
+            mWorkerMutex.lock();
+            mShuttingDown = true;
+            mWorkerMutex.unlock();
+            mWorkerSemaphore.increment();
+            Threads::WaitForThreads( 1u, &mWorkerThread );
+            mWorkerThread.reset();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    AsyncTextureTicket *TextureReadbackQueue::getTicket( uint32 width, uint32 height,
+                                                         uint32                     depthOrSlices,
+                                                         TextureTypes::TextureTypes textureType,
+                                                         PixelFormatGpu pixelFormatFamily )
+    {
+        pixelFormatFamily = PixelFormatGpuUtils::getFamily( pixelFormatFamily );
+
+        // Search backwards. The most recently used tickets are at the end, and
+        // when capturing every frame that's the one we're most likely after.
+        PooledTicketVec::reverse_iterator ritor = mAvailableTickets.rbegin();
+        PooledTicketVec::reverse_iterator rend = mAvailableTickets.rend();
+
+        while( ritor != rend )
+        {
+            AsyncTextureTicket *ticket = ritor->ticket;
+            if( ticket->getWidth() == width && ticket->getHeight() == height &&
+                ticket->getDepthOrSlices() == depthOrSlices &&
+                ticket->getPixelFormatFamily() == pixelFormatFamily &&
+                ticket->getTextureType() == textureType )
+            {
+                mAvailableTickets.erase( ritor.base() - 1u );
+                return ticket;
+            }
+            ++ritor;
+        }
+
+        return mTextureGpuManager->createAsyncTextureTicket( width, height, depthOrSlices, textureType,
+                                                             pixelFormatFamily );
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureReadbackQueue::releaseTicket( AsyncTextureTicket *ticket )
+    {
+        PooledTicket pooledTicket;
+        pooledTicket.ticket = ticket;
+        pooledTicket.lastFrameUsed = mVaoManager->getFrameCount();
+        mAvailableTickets.push_back( pooledTicket );
+    }
+    //-----------------------------------------------------------------------------------
+    uint64 TextureReadbackQueue::download( TextureGpu *texture, uint8 mipLevel,
+                                           TextureReadbackListener *listener,
+                                           bool processInWorkerThread, void *userData,
+                                           TextureBox *srcBox )
+    {
+        OgreProfileExhaustive( "TextureReadbackQueue::download" );
+
+        if( texture->getResidencyStatus() != GpuResidency::Resident &&
+            texture->getNextResidencyStatus() != GpuResidency::Resident )
+        {
+            OGRE_EXCEPT(
+                Exception::ERR_INVALIDPARAMS,
+                "Texture '" + texture->getNameStr() + "' must be resident or becoming resident!!!",
+                "TextureReadbackQueue::download" );
+        }
+
+        texture->waitForMetadata();
+
+        if( texture->isMultisample() && texture->hasMsaaExplicitResolves() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Texture '" + texture->getNameStr() +
+                             "' has MSAA with explicit resolves. Resolve it first.",
+                         "TextureReadbackQueue::download" );
+        }
+
+        if( mipLevel >= texture->getNumMipmaps() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Mip level out of bounds for texture '" + texture->getNameStr() + "'",
+                         "TextureReadbackQueue::download" );
+        }
+
+        // Keep the ring bounded. If the CPU is too far ahead, wait for the oldest one.
+        while( mPendingRequests.size() >= mMaxPendingRequests )
+        {
+            const PendingRequest oldest = mPendingRequests.front();
+            mPendingRequests.pop_front();
+            processRequest( oldest );
+        }
+
+        uint32 width, height, depthOrSlices;
+        if( srcBox )
+        {
+            width = srcBox->width;
+            height = srcBox->height;
+            depthOrSlices = std::max( srcBox->depth, srcBox->numSlices );
+        }
+        else
+        {
+            width = std::max( 1u, texture->getInternalWidth() >> mipLevel );
+            height = std::max( 1u, texture->getInternalHeight() >> mipLevel );
+            depthOrSlices = std::max( 1u, texture->getDepth() >> mipLevel );
+            depthOrSlices = std::max( depthOrSlices, texture->getNumSlices() );
+        }
+
+        AsyncTextureTicket *ticket = getTicket( width, height, depthOrSlices,
+                                                texture->getTextureType(), texture->getPixelFormat() );
+        ticket->download( texture, mipLevel, false, srcBox );
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_EMSCRIPTEN
+        processInWorkerThread = false;
+#endif
+
+        PendingRequest request;
+        request.requestId = mNextRequestId++;
+        request.ticket = ticket;
+        request.listener = listener;
+        request.userData = userData;
+        request.textureName = texture->getName();
+        request.pixelFormat = texture->getPixelFormat();
+        request.textureType = texture->getTextureType();
+        request.frameIssued = mVaoManager->getFrameCount();
+        request.mipLevel = mipLevel;
+        request.upsideDown = texture->isOpenGLRenderWindow();
+        request.processInWorkerThread = listener && processInWorkerThread;
+        mPendingRequests.push_back( request );
+
+        if( request.processInWorkerThread )
+            startWorkerThread();
+
+        return request.requestId;
+    }
+    //-----------------------------------------------------------------------------------
+    TextureReadbackQueue::CompletedDownload TextureReadbackQueue::copyToCpu(
+        const PendingRequest &request )
+    {
+        OgreProfileExhaustive( "TextureReadbackQueue::copyToCpu" );
+
+        AsyncTextureTicket *ticket = request.ticket;
+
+        CompletedDownload retVal;
+        retVal.listener = request.listener;
+        retVal.width = ticket->getWidth();
+        retVal.height = ticket->getHeight();
+        retVal.depthOrSlices = ticket->getDepthOrSlices();
+        retVal.textureType = request.textureType;
+
+        const size_t sizeBytes = PixelFormatGpuUtils::calculateSizeBytes(
+            retVal.width, retVal.height, ticket->getDepth(), ticket->getNumSlices(),
+            request.pixelFormat, 1u, 4u );
+        retVal.data =
+            reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_RESOURCE ) );
+
+        Image2 image;  // Use an Image2 as helper for calculating offsets
+        image.loadDynamicImage( retVal.data, retVal.width, retVal.height, retVal.depthOrSlices,
+                                retVal.textureType, request.pixelFormat, false );
+        TextureBox dstBox = image.getData( 0 );
+
+        TextureReadbackResult &result = retVal.result;
+        result.requestId = request.requestId;
+        result.textureName = request.textureName;
+        result.userData = request.userData;
+        result.frameIssued = request.frameIssued;
+        result.mipLevel = request.mipLevel;
+        result.upsideDown = request.upsideDown;
+        result.box = dstBox;
+        result.pixelFormat = request.pixelFormat;
+
+        if( ticket->canMapMoreThanOneSlice() )
+        {
+            const TextureBox srcBox = ticket->map( 0 );
+            dstBox.copyFrom( srcBox );
+            ticket->unmap();
+        }
+        else
+        {
+            const uint32 numSlices = ticket->getNumSlices();
+            for( uint32 i = 0; i < numSlices; ++i )
+            {
+                const TextureBox srcBox = ticket->map( i );
+                dstBox.copyFrom( srcBox );
+                dstBox.data = dstBox.at( 0, 0, 1u );
+                --dstBox.numSlices;
+                ticket->unmap();
+            }
+        }
+
+        releaseTicket( ticket );
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureReadbackQueue::processRequest( const PendingRequest &request )
+    {
+        OgreProfileExhaustive( "TextureReadbackQueue::processRequest" );
+
+        AsyncTextureTicket *ticket = request.ticket;
+
+        if( request.listener && !request.processInWorkerThread && ticket->canMapMoreThanOneSlice() )
+        {
+            // Fast path: Let the listener read straight from the ticket.
+            TextureReadbackResult result;
+            result.requestId = request.requestId;
+            result.textureName = request.textureName;
+            result.userData = request.userData;
+            result.frameIssued = request.frameIssued;
+            result.mipLevel = request.mipLevel;
+            result.upsideDown = request.upsideDown;
+            result.box = ticket->map( 0 );
+            result.pixelFormat = request.pixelFormat;
+
+            request.listener->readbackReady( result );
+
+            ticket->unmap();
+            releaseTicket( ticket );
+            return;
+        }
+
+        CompletedDownload download = copyToCpu( request );
+
+        if( !request.listener )
+        {
+            mCompletedDownloads[request.requestId] = download;
+        }
+        else if( !request.processInWorkerThread )
+        {
+            request.listener->readbackReady( download.result );
+            freeCompletedDownload( download );
+        }
+        else
+        {
+            mWorkerMutex.lock();
+            mWorkerJobs.push_back( download );
+            mWorkerMutex.unlock();
+            mWorkerSemaphore.increment();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureReadbackQueue::freeCompletedDownload( CompletedDownload &download )
+    {
+        if( download.data )
+        {
+            OGRE_FREE_SIMD( download.data, MEMCATEGORY_RESOURCE );
+            download.data = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool TextureReadbackQueue::isReady( uint64 requestId ) const
+    {
+        return mCompletedDownloads.find( requestId ) != mCompletedDownloads.end();
+    }
+    //-----------------------------------------------------------------------------------
+    bool TextureReadbackQueue::retrieve( uint64 requestId, Image2 &outImage )
+    {
+        CompletedDownloadMap::iterator itor = mCompletedDownloads.find( requestId );
+        if( itor == mCompletedDownloads.end() )
+            return false;
+
+        const CompletedDownload &download = itor->second;
+        outImage.loadDynamicImage( download.data, download.width, download.height,
+                                   download.depthOrSlices, download.textureType,
+                                   download.result.pixelFormat, true );
+        if( download.result.upsideDown )
+            outImage.flipAroundX();
+
+        mCompletedDownloads.erase( itor );
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureReadbackQueue::waitFor( uint64 requestId )
+    {
+        OgreProfileExhaustive( "TextureReadbackQueue::waitFor" );
+
+        // Requests are delivered in order. Flush everything up to requestId.
+        while( !mPendingRequests.empty() && mPendingRequests.front().requestId <= requestId )
+        {
+            const PendingRequest request = mPendingRequests.front();
+            mPendingRequests.pop_front();
+            processRequest( request );
+        }
+
+        if( mWorkerThread )
+        {
+            // The worker processes its jobs in order too.
+            bool isDone = false;
+            while( !isDone )
+            {
+                mWorkerMutex.lock();
+                isDone = ( mWorkerJobs.empty() || mWorkerJobs.front().result.requestId > requestId ) &&
+                         ( mWorkerJobInProgress == 0u || mWorkerJobInProgress > requestId );
+                mWorkerMutex.unlock();
+
+                if( !isDone )
+                    mWorkerJobDoneEvent.wait();
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureReadbackQueue::waitForAll() { waitFor( mNextRequestId - 1u ); }
+    //-----------------------------------------------------------------------------------
+    void TextureReadbackQueue::setMaxPendingRequests( size_t maxPendingRequests )
+    {
+        mMaxPendingRequests = std::max<size_t>( maxPendingRequests, 1u );
+
+        while( mPendingRequests.size() > mMaxPendingRequests )
+        {
+            const PendingRequest oldest = mPendingRequests.front();
+            mPendingRequests.pop_front();
+            processRequest( oldest );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureReadbackQueue::destroyAvailableTickets()
+    {
+        PooledTicketVec::const_iterator itor = mAvailableTickets.begin();
+        PooledTicketVec::const_iterator endt = mAvailableTickets.end();
+
+        while( itor != endt )
+        {
+            mTextureGpuManager->destroyAsyncTextureTicket( itor->ticket );
+            ++itor;
+        }
+
+        mAvailableTickets.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureReadbackQueue::_update()
+    {
+        OgreProfileExhaustive( "TextureReadbackQueue::_update" );
+
+        const uint32 currentFrame = mVaoManager->getFrameCount();
+
+        while( !mPendingRequests.empty() )
+        {
+            const PendingRequest &request = mPendingRequests.front();
+
+            // The tickets use inaccurate tracking. Asking in the same frame it was
+            // issued is always going to return false (and AsyncTextureTicket warns)
+            if( request.frameIssued == currentFrame || !request.ticket->queryIsTransferDone() )
+                break;
+
+            const PendingRequest readyRequest = request;
+            mPendingRequests.pop_front();
+            processRequest( readyRequest );
+        }
+
+        // Tickets are kept in order. Destroy the ones that haven't been used in a while
+        PooledTicketVec::iterator itor = mAvailableTickets.begin();
+        PooledTicketVec::iterator endt = mAvailableTickets.end();
+
+        while( itor != endt && currentFrame - itor->lastFrameUsed > mMaxIdleFrames )
+        {
+            mTextureGpuManager->destroyAsyncTextureTicket( itor->ticket );
+            ++itor;
+        }
+
+        mAvailableTickets.erase( mAvailableTickets.begin(), itor );
+    }
+    //-----------------------------------------------------------------------------------
+    unsigned long textureReadbackWorkerThread( ThreadHandle *threadHandle )
+    {
+        Threads::SetThreadName( threadHandle, "TexReadback" );
+        TextureReadbackQueue *readbackQueue =
+            reinterpret_cast<TextureReadbackQueue *>( threadHandle->getUserParam() );
+        return readbackQueue->_workerThread( threadHandle );
+    }
+    //-----------------------------------------------------------------------------------
+    unsigned long TextureReadbackQueue::_workerThread( ThreadHandle * )
+    {
+        while( true )
+        {
+            mWorkerSemaphore.decrementOrWait();
+
+            mWorkerMutex.lock();
+            if( mWorkerJobs.empty() )
+            {
+                const bool shuttingDown = mShuttingDown;
+                mWorkerMutex.unlock();
+                if( shuttingDown )
+                    break;
+                continue;
+            }
+
+            CompletedDownload job = mWorkerJobs.front();
+            mWorkerJobs.pop_front();
+            mWorkerJobInProgress = job.result.requestId;
+            mWorkerMutex.unlock();
+
+            job.listener->readbackReady( job.result );
+            freeCompletedDownload( job );
+
+            mWorkerMutex.lock();
+            mWorkerJobInProgress = 0u;
+            mWorkerMutex.unlock();
+            mWorkerJobDoneEvent.wake();
+        }
+
+        return 0;
+    }
+}  // namespace Ogre
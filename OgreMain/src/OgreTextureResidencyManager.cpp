@@ -0,0 +1,311 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreTextureResidencyManager.h"
+
+#include "OgreException.h"
+#include "OgreLogManager.h"
+#include "OgreProfiler.h"
+#include "OgreStringConverter.h"
+#include "OgreTextureGpu.h"
+#include "OgreTextureGpuManager.h"
+#include "Vao/OgreVaoManager.h"
+
+namespace Ogre
+{
+    struct OrderResidencyCandidateByScore
+    {
+        template <typename T>
+        bool operator()( const T &a, const T &b ) const
+        {
+            return a.score > b.score;
+        }
+    };
+    //-----------------------------------------------------------------------------------
+    TextureResidencyManager::TextureResidencyManager( TextureGpuManager *textureGpuManager,
+                                                      VaoManager        *vaoManager ) :
+        mTextureGpuManager( textureGpuManager ),
+        mVaoManager( vaoManager ),
+        mGlobalBudgetBytes( 0u ),
+        mResidentBytes( 0u ),
+        mGlobalEvicting( false ),
+        mLowWatermark( 0.9f ),
+        mMinIdleFrames( 120u ),
+        mMaxEvictionsPerFrame( 16u ),
+        mLastUpdateFrame( std::numeric_limits<uint32>::max() ),
+        mNumEvictions( 0u ),
+        mNumReloads( 0u )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    TextureResidencyManager::~TextureResidencyManager() {}
+    //-----------------------------------------------------------------------------------
+    void TextureResidencyManager::setGroupBudget( const String &resourceGroup, size_t budgetBytes )
+    {
+        if( budgetBytes == 0u )
+        {
+            mGroupBudgets.erase( resourceGroup );
+        }
+        else
+        {
+            GroupBudget &groupBudget = mGroupBudgets[resourceGroup];
+            groupBudget.budgetBytes = budgetBytes;
+            groupBudget.residentBytes = 0u;
+            groupBudget.evicting = false;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TextureResidencyManager::getGroupBudget( const String &resourceGroup ) const
+    {
+        GroupBudgetMap::const_iterator itor = mGroupBudgets.find( resourceGroup );
+        return itor != mGroupBudgets.end() ? itor->second.budgetBytes : 0u;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TextureResidencyManager::getGroupResidentBytes( const String &resourceGroup ) const
+    {
+        GroupBudgetMap::const_iterator itor = mGroupBudgets.find( resourceGroup );
+        return itor != mGroupBudgets.end() ? itor->second.residentBytes : 0u;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureResidencyManager::setLowWatermark( float lowWatermark )
+    {
+        if( lowWatermark <= 0.0f || lowWatermark > 1.0f )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "lowWatermark must be in range (0; 1]",
+                         "TextureResidencyManager::setLowWatermark" );
+        }
+        mLowWatermark = lowWatermark;
+    }
+    //-----------------------------------------------------------------------------------
+    bool TextureResidencyManager::isEvictable( const TextureGpu *texture ) const
+    {
+        return texture->getResidencyStatus() == GpuResidency::Resident &&
+               texture->getNextResidencyStatus() == GpuResidency::Resident &&
+               texture->getPendingResidencyChanges() == 0u && texture->isTexture() &&
+               !texture->isManualTexture() && !texture->isRenderWindowSpecific() &&
+               texture->getRank() != 0 && texture->isDataReady();
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TextureResidencyManager::calculateBytesToFree( size_t residentBytes, size_t budgetBytes,
+                                                          bool &evicting ) const
+    {
+        if( budgetBytes == 0u )
+        {
+            evicting = false;
+            return 0u;
+        }
+
+        // Once over budget, keep going across frames (mMaxEvictionsPerFrame may have cut us
+        // short) until we reach the low watermark. Otherwise we'd start evicting again as soon
+        // as usage creeps over the budget.
+        const size_t target = static_cast<size_t>( double( budgetBytes ) * double( mLowWatermark ) );
+        if( residentBytes > budgetBytes )
+            evicting = true;
+        else if( residentBytes <= target )
+            evicting = false;
+
+        return evicting ? residentBytes - target : 0u;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureResidencyManager::evict( TextureGpu *texture, uint32 currentFrame )
+    {
+        const GpuResidency::GpuResidency nextResidency =
+            texture->getGpuPageOutStrategy() == GpuPageOutStrategy::Discard
+                ? GpuResidency::OnStorage
+                : GpuResidency::OnSystemRam;
+        texture->scheduleTransitionTo( nextResidency );
+        mEvictedTextures[texture->getName()] = currentFrame;
+        ++mNumEvictions;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureResidencyManager::_update()
+    {
+        const uint32 currentFrame = mVaoManager->getFrameCount();
+        if( mLastUpdateFrame == currentFrame )
+            return;
+        mLastUpdateFrame = currentFrame;
+
+        if( mGlobalBudgetBytes == 0u && mGroupBudgets.empty() && mEvictedTextures.empty() )
+            return;
+
+        OgreProfileExhaustive( "TextureResidencyManager::_update" );
+
+        mResidentBytes = 0u;
+        {
+            GroupBudgetMap::iterator itor = mGroupBudgets.begin();
+            GroupBudgetMap::iterator endt = mGroupBudgets.end();
+            while( itor != endt )
+                ( itor++ )->second.residentBytes = 0u;
+        }
+
+        mTmpCandidates.clear();
+
+        const TextureGpuManager::ResourceEntryMap &entries = mTextureGpuManager->getEntries();
+        TextureGpuManager::ResourceEntryMap::const_iterator itor = entries.begin();
+        TextureGpuManager::ResourceEntryMap::const_iterator endt = entries.end();
+
+        while( itor != endt )
+        {
+            const TextureGpuManager::ResourceEntry &entry = itor->second;
+            TextureGpu *texture = entry.texture;
+
+            if( texture->getResidencyStatus() != GpuResidency::Resident )
+            {
+                if( !mEvictedTextures.empty() )
+                {
+                    // Bring it back if it got bound after we paged it out
+                    EvictedTextureMap::iterator itEvicted = mEvictedTextures.find( texture->getName() );
+                    if( itEvicted != mEvictedTextures.end() &&
+                        texture->getLastFrameUsed() != itEvicted->second &&
+                        texture->getLastFrameUsed() - itEvicted->second < 0x80000000u )
+                    {
+                        if( texture->getNextResidencyStatus() != GpuResidency::Resident )
+                        {
+                            texture->scheduleTransitionTo( GpuResidency::Resident );
+                            ++mNumReloads;
+                        }
+                        mEvictedTextures.erase( itEvicted );
+                    }
+                }
+            }
+            else if( texture->getNextResidencyStatus() == GpuResidency::Resident )
+            {
+                // Textures already scheduled to be paged out don't count, otherwise we'd
+                // evict more than needed while the transitions are in flight.
+                const size_t sizeBytes = texture->getSizeBytes();
+                mResidentBytes += sizeBytes;
+
+                GroupBudget *group = 0;
+                if( !mGroupBudgets.empty() )
+                {
+                    GroupBudgetMap::iterator itGroup = mGroupBudgets.find( entry.resourceGroup );
+                    if( itGroup != mGroupBudgets.end() )
+                    {
+                        group = &itGroup->second;
+                        group->residentBytes += sizeBytes;
+                    }
+                }
+
+                const uint32 framesIdle = currentFrame - texture->getLastFrameUsed();
+                if( framesIdle >= mMinIdleFrames && isEvictable( texture ) )
+                {
+                    Candidate candidate;
+                    candidate.texture = texture;
+                    candidate.score = uint64( framesIdle ) * uint64( texture->getRank() );
+                    candidate.sizeBytes = sizeBytes;
+                    candidate.group = group;
+                    mTmpCandidates.push_back( candidate );
+                }
+            }
+
+            ++itor;
+        }
+
+        // Forget the textures that no longer exist, or someone else made resident
+        if( !mEvictedTextures.empty() )
+        {
+            EvictedTextureMap::iterator itEvicted = mEvictedTextures.begin();
+            EvictedTextureMap::iterator enEvicted = mEvictedTextures.end();
+            while( itEvicted != enEvicted )
+            {
+                TextureGpu *texture = mTextureGpuManager->findTextureNoThrow( itEvicted->first );
+                if( !texture || texture->getNextResidencyStatus() == GpuResidency::Resident )
+                    mEvictedTextures.erase( itEvicted++ );
+                else
+                    ++itEvicted;
+            }
+        }
+
+        // Always evaluated, even without candidates, so the evicting flags stay up to date
+        size_t globalBytesToFree =
+            calculateBytesToFree( mResidentBytes, mGlobalBudgetBytes, mGlobalEvicting );
+
+        // Bytes each group over budget has yet to free
+        map<GroupBudget *, size_t>::type groupBytesToFree;
+        {
+            GroupBudgetMap::iterator itGroup = mGroupBudgets.begin();
+            GroupBudgetMap::iterator enGroup = mGroupBudgets.end();
+            while( itGroup != enGroup )
+            {
+                GroupBudget &groupBudget = itGroup->second;
+                const size_t bytesToFree = calculateBytesToFree(
+                    groupBudget.residentBytes, groupBudget.budgetBytes, groupBudget.evicting );
+                if( bytesToFree )
+                    groupBytesToFree[&groupBudget] = bytesToFree;
+                ++itGroup;
+            }
+        }
+
+        if( mTmpCandidates.empty() || ( globalBytesToFree == 0u && groupBytesToFree.empty() ) )
+            return;
+
+        // Oldest (and least important) first
+        std::sort( mTmpCandidates.begin(), mTmpCandidates.end(), OrderResidencyCandidateByScore() );
+
+        uint32 numEvicted = 0u;
+        CandidateVec::const_iterator itCandidate = mTmpCandidates.begin();
+        CandidateVec::const_iterator enCandidate = mTmpCandidates.end();
+
+        while( itCandidate != enCandidate && numEvicted < mMaxEvictionsPerFrame &&
+               ( globalBytesToFree > 0u || !groupBytesToFree.empty() ) )
+        {
+            map<GroupBudget *, size_t>::type::iterator itGroup =
+                itCandidate->group ? groupBytesToFree.find( itCandidate->group )
+                                   : groupBytesToFree.end();
+            const bool groupOverBudget = itGroup != groupBytesToFree.end();
+
+            if( globalBytesToFree > 0u || groupOverBudget )
+            {
+                evict( itCandidate->texture, currentFrame );
+                ++numEvicted;
+
+                globalBytesToFree -= std::min( globalBytesToFree, itCandidate->sizeBytes );
+                if( groupOverBudget )
+                {
+                    if( itGroup->second <= itCandidate->sizeBytes )
+                        groupBytesToFree.erase( itGroup );
+                    else
+                        itGroup->second -= itCandidate->sizeBytes;
+                }
+            }
+
+            ++itCandidate;
+        }
+
+        if( numEvicted )
+        {
+            LogManager::getSingleton().logMessage(
+                "TextureResidencyManager: paged out " + StringConverter::toString( numEvicted ) +
+                    " textures. Resident: " + StringConverter::toString( mResidentBytes / 1024u ) +
+                    " kB",
+                LML_TRIVIAL );
+        }
+    }
+}  // namespace Ogre
@@ -0,0 +1,447 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-present Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreTriangleBvh.h"
+
+#include "Math/Array/OgreBooleanMask.h"
+#include "Math/Array/OgreMathlib.h"
+#include "OgreBitwise.h"
+#include "OgreHardwareVertexBuffer.h"
+#include "OgreRay.h"
+#include "Vao/OgreAsyncTicket.h"
+#include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreVertexArrayObject.h"
+#include "Vao/OgreVertexBufferPacked.h"
+
+namespace Ogre
+{
+    namespace
+    {
+        const size_t c_maxTrianglesPerLeaf = ARRAY_PACKED_REALS * 2u;
+        const size_t c_maxBvhDepth = 64u;
+
+        template <typename T>
+        struct TriangleCenterLess
+        {
+            size_t axis;
+            TriangleCenterLess( size_t _axis ) : axis( _axis ) {}
+            bool operator()( const T &a, const T &b ) const { return a.center[axis] < b.center[axis]; }
+        };
+
+        /// Slab test. NaNs (ray parallel to a slab and starting on its border) don't limit the range.
+        inline bool intersectsNode( const Vector3 &vMin, const Vector3 &vMax, const Vector3 &origin,
+                                    const Vector3 &invDir, Real maxDistance, Real &outDistance )
+        {
+            const Vector3 t0 = ( vMin - origin ) * invDir;
+            const Vector3 t1 = ( vMax - origin ) * invDir;
+
+            Real tmin = 0;
+            Real tmax = maxDistance;
+            for( size_t i = 0; i < 3u; ++i )
+            {
+                const Real tNear = std::min( t0[i], t1[i] );
+                const Real tFar = std::max( t0[i], t1[i] );
+                if( tNear > tmin )
+                    tmin = tNear;
+                if( tFar < tmax )
+                    tmax = tFar;
+            }
+
+            outDistance = tmin;
+            return tmin <= tmax;
+        }
+    }  // namespace
+
+    struct TriangleBvh::BuildTriangle
+    {
+        Vector3 v0;
+        Vector3 v1;
+        Vector3 v2;
+        Vector3 center;
+        uint32  triangleIdx;
+    };
+    //-------------------------------------------------------------------------
+    TriangleBvh::TriangleBvh() : mNumTriangles( 0 ) {}
+    //-------------------------------------------------------------------------
+    void TriangleBvh::clear()
+    {
+        mNodes.clear();
+        RawSimdUniquePtr<TrianglePack, MEMCATEGORY_GEOMETRY> emptyPacks;
+        mPacks.swap( emptyPacks );
+        mNumTriangles = 0;
+    }
+    //-------------------------------------------------------------------------
+    void TriangleBvh::buildNode( BuildTriangleVec &triangles, size_t start, size_t end, size_t depth,
+                                 BuildTriangleVec &outPackedTriangles )
+    {
+        const size_t nodeIdx = mNodes.size();
+        mNodes.push_back( Node() );
+
+        Vector3 vMin = triangles[start].v0;
+        Vector3 vMax = vMin;
+        Vector3 centerMin = triangles[start].center;
+        Vector3 centerMax = centerMin;
+
+        for( size_t i = start; i < end; ++i )
+        {
+            const BuildTriangle &tri = triangles[i];
+            vMin.makeFloor( tri.v0 );
+            vMin.makeFloor( tri.v1 );
+            vMin.makeFloor( tri.v2 );
+            vMax.makeCeil( tri.v0 );
+            vMax.makeCeil( tri.v1 );
+            vMax.makeCeil( tri.v2 );
+            centerMin.makeFloor( tri.center );
+            centerMax.makeCeil( tri.center );
+        }
+
+        mNodes[nodeIdx].vMin = vMin;
+        mNodes[nodeIdx].vMax = vMax;
+
+        const size_t numTriangles = end - start;
+
+        if( numTriangles <= c_maxTrianglesPerLeaf || depth + 1u >= c_maxBvhDepth )
+        {
+            const size_t firstPack = outPackedTriangles.size() / ARRAY_PACKED_REALS;
+            outPackedTriangles.insert( outPackedTriangles.end(),
+                                       triangles.begin() + static_cast<ptrdiff_t>( start ),
+                                       triangles.begin() + static_cast<ptrdiff_t>( end ) );
+
+            // Pad with degenerate triangles, which can never be hit
+            BuildTriangle padding;
+            padding.v0 = Vector3::ZERO;
+            padding.v1 = Vector3::ZERO;
+            padding.v2 = Vector3::ZERO;
+            padding.center = Vector3::ZERO;
+            padding.triangleIdx = 0;
+            while( outPackedTriangles.size() % ARRAY_PACKED_REALS )
+                outPackedTriangles.push_back( padding );
+
+            mNodes[nodeIdx].firstPackOrSecondChild = static_cast<uint32>( firstPack );
+            mNodes[nodeIdx].numPacks =
+                static_cast<uint32>( outPackedTriangles.size() / ARRAY_PACKED_REALS - firstPack );
+            return;
+        }
+
+        // Median split along the axis where the triangles are the most spread
+        const Vector3 centerExtents = centerMax - centerMin;
+        size_t axis = 0;
+        if( centerExtents.y > centerExtents[axis] )
+            axis = 1u;
+        if( centerExtents.z > centerExtents[axis] )
+            axis = 2u;
+
+        const size_t mid = start + numTriangles / 2u;
+        std::nth_element( triangles.begin() + static_cast<ptrdiff_t>( start ),
+                          triangles.begin() + static_cast<ptrdiff_t>( mid ),
+                          triangles.begin() + static_cast<ptrdiff_t>( end ),
+                          TriangleCenterLess<BuildTriangle>( axis ) );
+
+        mNodes[nodeIdx].numPacks = 0u;
+        buildNode( triangles, start, mid, depth + 1u, outPackedTriangles );
+        mNodes[nodeIdx].firstPackOrSecondChild = static_cast<uint32>( mNodes.size() );
+        buildNode( triangles, mid, end, depth + 1u, outPackedTriangles );
+    }
+    //-------------------------------------------------------------------------
+    void TriangleBvh::build( const float *positions, size_t numVertices, const void *indexData,
+                             bool indices16bit, size_t numIndices )
+    {
+        clear();
+
+        const size_t numTriangles = ( indexData ? numIndices : numVertices ) / 3u;
+        if( !numTriangles )
+            return;
+
+        const uint16 *indexData16 = reinterpret_cast<const uint16 *>( indexData );
+        const uint32 *indexData32 = reinterpret_cast<const uint32 *>( indexData );
+
+        BuildTriangleVec triangles;
+        triangles.reserve( numTriangles );
+
+        for( size_t i = 0; i < numTriangles; ++i )
+        {
+            Vector3 triVerts[3];
+            for( size_t j = 0; j < 3u; ++j )
+            {
+                size_t vertexIdx = i * 3u + j;
+                if( indexData )
+                    vertexIdx = indices16bit ? indexData16[vertexIdx] : indexData32[vertexIdx];
+
+                OGRE_ASSERT_LOW( vertexIdx < numVertices );
+
+                triVerts[j] = Vector3( static_cast<Real>( positions[vertexIdx * 3u + 0u] ),
+                                       static_cast<Real>( positions[vertexIdx * 3u + 1u] ),
+                                       static_cast<Real>( positions[vertexIdx * 3u + 2u] ) );
+            }
+
+            BuildTriangle tri;
+            tri.v0 = triVerts[0];
+            tri.v1 = triVerts[1];
+            tri.v2 = triVerts[2];
+            tri.center = ( triVerts[0] + triVerts[1] + triVerts[2] ) / Real( 3.0 );
+            tri.triangleIdx = static_cast<uint32>( i );
+            triangles.push_back( tri );
+        }
+
+        mNumTriangles = static_cast<uint32>( numTriangles );
+
+        BuildTriangleVec packedTriangles;
+        packedTriangles.reserve( numTriangles + numTriangles / 2u );
+        mNodes.reserve( ( numTriangles * 2u ) / c_maxTrianglesPerLeaf + 1u );
+        buildNode( triangles, 0u, numTriangles, 0u, packedTriangles );
+
+        const size_t numPacks = packedTriangles.size() / ARRAY_PACKED_REALS;
+        RawSimdUniquePtr<TrianglePack, MEMCATEGORY_GEOMETRY> packs( numPacks );
+        TrianglePack *RESTRICT_ALIAS packsPtr = packs.get();
+
+        for( size_t i = 0; i < numPacks; ++i )
+        {
+            for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
+            {
+                const BuildTriangle &tri = packedTriangles[i * ARRAY_PACKED_REALS + j];
+                packsPtr[i].v0.setFromVector3( tri.v0, j );
+                packsPtr[i].edge1.setFromVector3( tri.v1 - tri.v0, j );
+                packsPtr[i].edge2.setFromVector3( tri.v2 - tri.v0, j );
+                packsPtr[i].triangleIdx[j] = tri.triangleIdx;
+            }
+        }
+
+        mPacks.swap( packs );
+    }
+    //-------------------------------------------------------------------------
+    void TriangleBvh::build( VertexArrayObject *vao )
+    {
+        clear();
+
+        if( vao->getOperationType() != OT_TRIANGLE_LIST )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Only triangle lists are supported",
+                         "TriangleBvh::build" );
+        }
+
+        IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+
+        VertexArrayObject::ReadRequestsVec readRequests;
+        readRequests.push_back( VertexArrayObject::ReadRequests( VES_POSITION ) );
+
+        // Non-indexed Vaos only use the vertices in their range. Indexed Vaos
+        // may reference anything in the vertex buffer.
+        size_t vertexStart = 0u;
+        size_t numVertices;
+        if( indexBuffer )
+        {
+            vao->readRequests( readRequests, 0u, 0u, true );
+            numVertices = readRequests[0].vertexBuffer->getNumElements();
+        }
+        else
+        {
+            vertexStart = vao->getPrimitiveStart();
+            numVertices = vao->getPrimitiveCount();
+            vao->readRequests( readRequests, vertexStart, numVertices, true );
+        }
+
+        AsyncTicketPtr indexTicket;
+        if( indexBuffer && !indexBuffer->getShadowCopy() )
+            indexTicket = indexBuffer->readRequest( vao->getPrimitiveStart(), vao->getPrimitiveCount() );
+
+        vector<float>::type positions;
+        positions.resize( numVertices * 3u );
+
+        const bool isHalf = v1::VertexElement::getBaseType( readRequests[0].type ) == VET_HALF2;
+
+        vao->mapAsyncTickets( readRequests );
+        const size_t bytesPerVertex = readRequests[0].vertexBuffer->getBytesPerElement();
+        for( size_t i = 0; i < numVertices; ++i )
+        {
+            if( isHalf )
+            {
+                const uint16 *srcData16 = reinterpret_cast<const uint16 *>( readRequests[0].data );
+                positions[i * 3u + 0u] = Bitwise::halfToFloat( srcData16[0] );
+                positions[i * 3u + 1u] = Bitwise::halfToFloat( srcData16[1] );
+                positions[i * 3u + 2u] = Bitwise::halfToFloat( srcData16[2] );
+            }
+            else
+            {
+                memcpy( &positions[i * 3u], readRequests[0].data, sizeof( float ) * 3u );
+            }
+            readRequests[0].data += bytesPerVertex;
+        }
+        vao->unmapAsyncTickets( readRequests );
+
+        if( !indexBuffer )
+        {
+            build( positions.empty() ? 0 : &positions[0], numVertices, 0, false, 0u );
+            return;
+        }
+
+        const bool indices16bit = indexBuffer->getIndexType() == IndexBufferPacked::IT_16BIT;
+        if( indexTicket )
+        {
+            const void *indexData = indexTicket->map();
+            build( &positions[0], numVertices, indexData, indices16bit, vao->getPrimitiveCount() );
+            indexTicket->unmap();
+        }
+        else
+        {
+            const uint8 *indexData = reinterpret_cast<const uint8 *>( indexBuffer->getShadowCopy() ) +
+                                     vao->getPrimitiveStart() * indexBuffer->getBytesPerElement();
+            build( &positions[0], numVertices, indexData, indices16bit, vao->getPrimitiveCount() );
+        }
+    }
+    //-------------------------------------------------------------------------
+    bool TriangleBvh::raycast( const Ray &ray, Real maxDistance, bool positiveSide, bool negativeSide,
+                               TriangleRayHit &outHit ) const
+    {
+        if( mNodes.empty() || ( !positiveSide && !negativeSide ) )
+            return false;
+
+        const Vector3 origin = ray.getOrigin();
+        const Vector3 invDir = Vector3::UNIT_SCALE / ray.getDirection();
+
+        ArrayVector3 arrayOrigin;
+        ArrayVector3 arrayDir;
+        arrayOrigin.setAll( origin );
+        arrayDir.setAll( ray.getDirection() );
+
+        const TrianglePack *RESTRICT_ALIAS packs = mPacks.get();
+
+        Real bestDistance = maxDistance;
+        bool bHit = false;
+
+        uint32 stack[c_maxBvhDepth];
+        size_t stackSize = 0u;
+
+        Real nodeDistance;
+        if( intersectsNode( mNodes[0].vMin, mNodes[0].vMax, origin, invDir, bestDistance,
+                            nodeDistance ) )
+        {
+            stack[stackSize++] = 0u;
+        }
+
+        while( stackSize )
+        {
+            const Node &node = mNodes[stack[--stackSize]];
+
+            // bestDistance may have shrunk since this node was pushed
+            if( !intersectsNode( node.vMin, node.vMax, origin, invDir, bestDistance, nodeDistance ) )
+                continue;
+
+            if( node.numPacks )
+            {
+                const ArrayReal arrayBestDistance = Mathlib::SetAll( bestDistance );
+
+                for( size_t i = 0; i < node.numPacks; ++i )
+                {
+                    // Möller-Trumbore, ARRAY_PACKED_REALS triangles at a time
+                    const TrianglePack &pack = packs[node.firstPackOrSecondChild + i];
+
+                    const ArrayVector3 pVec = arrayDir.crossProduct( pack.edge2 );
+                    const ArrayReal det = pack.edge1.dotProduct( pVec );
+                    const ArrayReal invDet = Mathlib::ONE / det;
+
+                    const ArrayVector3 tVec = arrayOrigin - pack.v0;
+                    const ArrayReal u = tVec.dotProduct( pVec ) * invDet;
+                    const ArrayVector3 qVec = tVec.crossProduct( pack.edge1 );
+                    const ArrayReal v = arrayDir.dotProduct( qVec ) * invDet;
+                    const ArrayReal t = pack.edge2.dotProduct( qVec ) * invDet;
+
+                    // det > 0 means the ray sees the front (counter clockwise) side.
+                    // Degenerate triangles (i.e. padding) have det = 0.
+                    ArrayMaskR hitMask;
+                    if( positiveSide && negativeSide )
+                    {
+                        hitMask = Mathlib::Or( Mathlib::CompareGreater( det, ARRAY_REAL_ZERO ),
+                                               Mathlib::CompareLess( det, ARRAY_REAL_ZERO ) );
+                    }
+                    else if( positiveSide )
+                        hitMask = Mathlib::CompareGreater( det, ARRAY_REAL_ZERO );
+                    else
+                        hitMask = Mathlib::CompareLess( det, ARRAY_REAL_ZERO );
+
+                    // hitMask &= u >= 0 && v >= 0 && u + v <= 1 && t >= 0 && t < bestDistance
+                    const ArrayReal zero = ARRAY_REAL_ZERO;
+                    hitMask = Mathlib::And( hitMask, Mathlib::CompareGreaterEqual( u, zero ) );
+                    hitMask = Mathlib::And( hitMask, Mathlib::CompareGreaterEqual( v, zero ) );
+                    hitMask = Mathlib::And( hitMask, Mathlib::CompareLessEqual( u + v, Mathlib::ONE ) );
+                    hitMask = Mathlib::And( hitMask, Mathlib::CompareGreaterEqual( t, zero ) );
+                    hitMask = Mathlib::And( hitMask, Mathlib::CompareLess( t, arrayBestDistance ) );
+
+                    const uint32 scalarMask = BooleanMask4::getScalarMask( hitMask );
+                    if( scalarMask )
+                    {
+                        OGRE_ALIGNED_DECL( Real, scalarT[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+                        OGRE_ALIGNED_DECL( Real, scalarU[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+                        OGRE_ALIGNED_DECL( Real, scalarV[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+                        CastArrayToReal( scalarT, t );
+                        CastArrayToReal( scalarU, u );
+                        CastArrayToReal( scalarV, v );
+
+                        for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
+                        {
+                            if( IS_BIT_SET( j, scalarMask ) && scalarT[j] < bestDistance )
+                            {
+                                bestDistance = scalarT[j];
+                                outHit.distance = scalarT[j];
+                                outHit.triangleIdx = pack.triangleIdx[j];
+                                outHit.barycentric = Vector2( scalarU[j], scalarV[j] );
+                                bHit = true;
+                            }
+                        }
+                    }
+                }
+            }
+            else
+            {
+                // Visit the closest child first, which is pushed last
+                const uint32 childIdx[2] = { static_cast<uint32>( &node - &mNodes[0] ) + 1u,
+                                             node.firstPackOrSecondChild };
+                Real childDistance[2];
+                bool childHit[2];
+                for( size_t i = 0; i < 2u; ++i )
+                {
+                    const Node &child = mNodes[childIdx[i]];
+                    childHit[i] = intersectsNode( child.vMin, child.vMax, origin, invDir, bestDistance,
+                                                  childDistance[i] );
+                }
+
+                const size_t nearIdx = ( childHit[1] && childDistance[1] < childDistance[0] ) ? 1u : 0u;
+                const size_t farIdx = 1u - nearIdx;
+
+                OGRE_ASSERT_LOW( stackSize + 2u <= c_maxBvhDepth );
+                if( childHit[farIdx] )
+                    stack[stackSize++] = childIdx[farIdx];
+                if( childHit[nearIdx] )
+                    stack[stackSize++] = childIdx[nearIdx];
+            }
+        }
+
+        return bHit;
+    }
+}  // namespace Ogre
@@ -0,0 +1,424 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreVirtualTexture.h"
+
+#include "OgreException.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreProfiler.h"
+#include "OgreStagingTexture.h"
+#include "OgreTextureGpuManager.h"
+#include "Vao/OgreVaoManager.h"
+
+namespace Ogre
+{
+    unsigned long virtualTextureWorkerThread( ThreadHandle *threadHandle );
+    THREAD_DECLARE( virtualTextureWorkerThread );
+
+    /// Never keep more than this many feedback downloads in flight. If the GPU
+    /// is that far behind, there's no point in asking for more.
+    static const uint32 c_maxFeedbackRequestsInFlight = 3u;
+
+    VirtualTextureTileLoader::~VirtualTextureTileLoader() {}
+    //-----------------------------------------------------------------------------------
+    VirtualTexture::VirtualTexture( const String &name, TextureGpuManager *textureGpuManager,
+                                    VirtualTextureTileLoader *loader, uint32 widthInTiles,
+                                    uint32 heightInTiles, uint32 tileResolution, uint32 border,
+                                    PixelFormatGpu pixelFormat, uint32 atlasSlotsPerRow ) :
+        mName( name ),
+        mTextureGpuManager( textureGpuManager ),
+        mLoader( loader ),
+        mCache( widthInTiles, heightInTiles, 0u, atlasSlotsPerRow * atlasSlotsPerRow,
+                atlasSlotsPerRow ),
+        mTileResolution( tileResolution ),
+        mBorder( border ),
+        mPixelFormat( pixelFormat ),
+        mAtlas( 0 ),
+        mIndirection( 0 ),
+        mFeedbackTexture( 0 ),
+        mMaxTileLoadsPerFrame( 16u ),
+        mMaxTileUploadsPerFrame( 16u ),
+        mNumFeedbackRequestsInFlight( 0u ),
+        mWorkerSemaphore( 0u ),
+        mShuttingDown( false )
+    {
+        if( atlasSlotsPerRow > 256u )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "atlasSlotsPerRow can't be bigger than 256 (the indirection is 8-bit)",
+                         "VirtualTexture::VirtualTexture" );
+        }
+
+        createTextures();
+
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        mWorkerThread = Threads::CreateThread( THREAD_GET( virtualTextureWorkerThread ), 0, this );
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    VirtualTexture::~VirtualTexture()
+    {
+        if( mWorkerThread )
+        {
+            mWorkerMutex.lock();
+            mShuttingDown = true;
+            mWorkerMutex.unlock();
+            mWorkerSemaphore.increment();
+            Threads::WaitForThreads( 1u, &mWorkerThread );
+            mWorkerThread.reset();
+        }
+
+        // The readback queue holds a pointer to us
+        if( mNumFeedbackRequestsInFlight )
+            mTextureGpuManager->getReadbackQueue()->waitForAll();
+
+        LoadJobDeque::iterator itor = mPendingLoads.begin();
+        LoadJobDeque::iterator endt = mPendingLoads.end();
+        while( itor != endt )
+            freeLoadJob( *itor++ );
+        mPendingLoads.clear();
+
+        LoadJobVec::iterator itFinished = mFinishedLoads.begin();
+        LoadJobVec::iterator enFinished = mFinishedLoads.end();
+        while( itFinished != enFinished )
+            freeLoadJob( *itFinished++ );
+        mFinishedLoads.clear();
+
+        destroyTextures();
+    }
+    //-----------------------------------------------------------------------------------
+    size_t VirtualTexture::getTileSizeBytes() const
+    {
+        const uint32 paddedRes = getPaddedTileResolution();
+        return PixelFormatGpuUtils::getSizeBytes( paddedRes, paddedRes, 1u, 1u, mPixelFormat, 4u );
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTexture::createTextures()
+    {
+        const uint32 slotsPerRow = mCache.getSlotsPerRow();
+        const uint32 paddedRes = getPaddedTileResolution();
+
+        mAtlas = mTextureGpuManager->createTexture(
+            mName.getFriendlyText() + "/VirtualTextureAtlas", GpuPageOutStrategy::Discard,
+            TextureFlags::ManualTexture, TextureTypes::Type2D );
+        mAtlas->setResolution( slotsPerRow * paddedRes, slotsPerRow * paddedRes );
+        mAtlas->setPixelFormat( mPixelFormat );
+        mAtlas->scheduleTransitionTo( GpuResidency::Resident );
+
+        mIndirection = mTextureGpuManager->createTexture(
+            mName.getFriendlyText() + "/VirtualTextureIndirection", GpuPageOutStrategy::Discard,
+            TextureFlags::ManualTexture, TextureTypes::Type2D );
+        mIndirection->setResolution( mCache.getWidthInTiles(), mCache.getHeightInTiles() );
+        mIndirection->setNumMipmaps( mCache.getNumMips() );
+        mIndirection->setPixelFormat( PFG_RGBA8_UNORM );
+        mIndirection->scheduleTransitionTo( GpuResidency::Resident );
+        // The (all-zero) page table gets uploaded in the first update()
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTexture::destroyTextures()
+    {
+        if( mAtlas )
+        {
+            mTextureGpuManager->destroyTexture( mAtlas );
+            mAtlas = 0;
+        }
+        if( mIndirection )
+        {
+            mTextureGpuManager->destroyTexture( mIndirection );
+            mIndirection = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTexture::freeLoadJob( LoadJob &job )
+    {
+        if( job.data )
+        {
+            OGRE_FREE_SIMD( job.data, MEMCATEGORY_RESOURCE );
+            job.data = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTexture::setFeedbackTexture( TextureGpu *feedbackTexture )
+    {
+        if( feedbackTexture && feedbackTexture->getPixelFormat() != PFG_R32_UINT )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Feedback texture '" + feedbackTexture->getNameStr() +
+                             "' must be PFG_R32_UINT",
+                         "VirtualTexture::setFeedbackTexture" );
+        }
+        mFeedbackTexture = feedbackTexture;
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTexture::getShaderParams( Vector4 &outParams0, Vector4 &outParams1 ) const
+    {
+        outParams0.x = static_cast<Real>( mCache.getWidthInTiles() );
+        outParams0.y = static_cast<Real>( mCache.getHeightInTiles() );
+        outParams0.z = static_cast<Real>( mTileResolution );
+        outParams0.w = static_cast<Real>( mBorder );
+
+        outParams1.x = static_cast<Real>( mAtlas->getWidth() );
+        outParams1.y = static_cast<Real>( mAtlas->getHeight() );
+        outParams1.z = static_cast<Real>( mCache.getNumMips() );
+        outParams1.w = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTexture::uploadTiles()
+    {
+        OgreProfileExhaustive( "VirtualTexture::uploadTiles" );
+
+        mWorkerMutex.lock();
+        mTmpFinishedLoads.swap( mFinishedLoads );
+        mWorkerMutex.unlock();
+
+        // Anything we don't get to this frame goes back to the queue
+        const size_t numToProcess =
+            std::min<size_t>( mTmpFinishedLoads.size(), mMaxTileUploadsPerFrame );
+
+        const uint32 currentFrame = mTextureGpuManager->getVaoManager()->getFrameCount();
+        const uint32 paddedRes = getPaddedTileResolution();
+        const uint32 slotsPerRow = mCache.getSlotsPerRow();
+        const uint32 bytesPerPixel = PixelFormatGpuUtils::getBytesPerPixel( mPixelFormat );
+        const uint32 bytesPerRow = static_cast<uint32>(
+            PixelFormatGpuUtils::getSizeBytes( paddedRes, 1u, 1u, 1u, mPixelFormat, 4u ) );
+        const size_t tileSizeBytes = getTileSizeBytes();
+
+        StagingTexture *stagingTexture = 0;
+
+        for( size_t i = 0u; i < numToProcess; ++i )
+        {
+            LoadJob &job = mTmpFinishedLoads[i];
+
+            if( !job.success )
+            {
+                mCache.notifyTileLoadFailed( job.tileId );
+                freeLoadJob( job );
+                continue;
+            }
+
+            uint32 evictedTileId;
+            const uint32 slot = mCache.notifyTileLoaded( job.tileId, currentFrame, evictedTileId );
+
+            if( slot != VirtualTextureTile::c_invalid )
+            {
+                if( !stagingTexture )
+                {
+                    stagingTexture = mTextureGpuManager->getStagingTexture(
+                        paddedRes, paddedRes, 1u, static_cast<uint32>( numToProcess - i ),
+                        mPixelFormat );
+                    stagingTexture->startMapRegion();
+                }
+
+                TextureBox dstBox =
+                    stagingTexture->mapRegion( paddedRes, paddedRes, 1u, 1u, mPixelFormat );
+                OGRE_ASSERT_LOW( dstBox.data && "getStagingTexture gave us not enough room" );
+
+                TextureBox srcBox( paddedRes, paddedRes, 1u, 1u, bytesPerPixel, bytesPerRow,
+                                   tileSizeBytes );
+                srcBox.data = job.data;
+                if( PixelFormatGpuUtils::isCompressed( mPixelFormat ) )
+                    srcBox.setCompressedPixelFormat( mPixelFormat );
+                dstBox.copyFrom( srcBox );
+
+                TextureBox slotBox = dstBox;
+                slotBox.x = ( slot % slotsPerRow ) * paddedRes;
+                slotBox.y = ( slot / slotsPerRow ) * paddedRes;
+                slotBox.z = 0u;
+                slotBox.sliceStart = 0u;
+                stagingTexture->upload( dstBox, mAtlas, 0u, 0, &slotBox );
+            }
+
+            freeLoadJob( job );
+        }
+
+        if( stagingTexture )
+        {
+            stagingTexture->stopMapRegion();
+            mTextureGpuManager->removeStagingTexture( stagingTexture );
+        }
+
+        if( numToProcess < mTmpFinishedLoads.size() )
+        {
+            mWorkerMutex.lock();
+            mFinishedLoads.insert( mFinishedLoads.begin(),
+                                   mTmpFinishedLoads.begin() + (ptrdiff_t)numToProcess,
+                                   mTmpFinishedLoads.end() );
+            mWorkerMutex.unlock();
+        }
+        mTmpFinishedLoads.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTexture::uploadIndirection()
+    {
+        OgreProfileExhaustive( "VirtualTexture::uploadIndirection" );
+
+        const uint8 numMips = mCache.getNumMips();
+
+        // The whole mip chain fits in 2 slices worth of mip 0
+        StagingTexture *stagingTexture = mTextureGpuManager->getStagingTexture(
+            mCache.getWidthInTiles(), mCache.getHeightInTiles(), 1u, 2u, PFG_RGBA8_UNORM );
+        stagingTexture->startMapRegion();
+
+        for( uint8 mip = 0u; mip < numMips; ++mip )
+        {
+            const uint32 width = mCache.getWidthInTiles( mip );
+            const uint32 height = mCache.getHeightInTiles( mip );
+
+            TextureBox dstBox = stagingTexture->mapRegion( width, height, 1u, 1u, PFG_RGBA8_UNORM );
+            OGRE_ASSERT_LOW( dstBox.data && "getStagingTexture gave us not enough room" );
+
+            TextureBox srcBox( width, height, 1u, 1u, 4u, width * 4u, width * height * 4u );
+            srcBox.data = const_cast<uint32 *>( mCache.getIndirection( mip ) );
+            dstBox.copyFrom( srcBox );
+
+            stagingTexture->upload( dstBox, mIndirection, mip );
+        }
+
+        stagingTexture->stopMapRegion();
+        mTextureGpuManager->removeStagingTexture( stagingTexture );
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTexture::update()
+    {
+        OgreProfileExhaustive( "VirtualTexture::update" );
+
+        if( mFeedbackTexture && mFeedbackTexture->isRenderToTexture() &&
+            mFeedbackTexture->getResidencyStatus() == GpuResidency::Resident &&
+            mNumFeedbackRequestsInFlight < c_maxFeedbackRequestsInFlight )
+        {
+            ++mNumFeedbackRequestsInFlight;
+            mTextureGpuManager->getReadbackQueue()->download( mFeedbackTexture, 0u, this );
+        }
+
+        if( !mAtlas->isDataReady() || !mIndirection->isDataReady() )
+            return;
+
+        // Tiles the loader finished since last frame
+        uploadTiles();
+
+        // Tiles we need to start loading
+        const uint32 currentFrame = mTextureGpuManager->getVaoManager()->getFrameCount();
+        mCache.update( currentFrame, mMaxTileLoadsPerFrame, mTmpTilesToLoad );
+
+        if( !mTmpTilesToLoad.empty() )
+        {
+            mWorkerMutex.lock();
+            VirtualTextureCache::TileIdVec::const_iterator itor = mTmpTilesToLoad.begin();
+            VirtualTextureCache::TileIdVec::const_iterator endt = mTmpTilesToLoad.end();
+            while( itor != endt )
+            {
+                LoadJob job;
+                job.tileId = *itor++;
+                job.data = 0;
+                job.success = false;
+                mPendingLoads.push_back( job );
+            }
+            mWorkerMutex.unlock();
+
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+            for( size_t i = 0u; i < mTmpTilesToLoad.size(); ++i )
+                mWorkerSemaphore.increment();
+#else
+            _workerThread( 0 );
+#endif
+            mTmpTilesToLoad.clear();
+        }
+
+        if( mCache.updateIndirection() )
+            uploadIndirection();
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTexture::readbackReady( const TextureReadbackResult &result )
+    {
+        OGRE_ASSERT_LOW( mNumFeedbackRequestsInFlight > 0u );
+        --mNumFeedbackRequestsInFlight;
+        mCache.processFeedback( result.box );
+    }
+    //-----------------------------------------------------------------------------------
+    unsigned long virtualTextureWorkerThread( ThreadHandle *threadHandle )
+    {
+        Threads::SetThreadName( threadHandle, "VirtualTexture" );
+        VirtualTexture *virtualTexture =
+            reinterpret_cast<VirtualTexture *>( threadHandle->getUserParam() );
+        return virtualTexture->_workerThread( threadHandle );
+    }
+    //-----------------------------------------------------------------------------------
+    unsigned long VirtualTexture::_workerThread( ThreadHandle * )
+    {
+        const uint32 paddedRes = getPaddedTileResolution();
+        const uint32 bytesPerPixel = PixelFormatGpuUtils::getBytesPerPixel( mPixelFormat );
+        const uint32 bytesPerRow = static_cast<uint32>(
+            PixelFormatGpuUtils::getSizeBytes( paddedRes, 1u, 1u, 1u, mPixelFormat, 4u ) );
+        const size_t tileSizeBytes = getTileSizeBytes();
+
+        while( true )
+        {
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+            mWorkerSemaphore.decrementOrWait();
+#endif
+
+            mWorkerMutex.lock();
+            if( mPendingLoads.empty() )
+            {
+                const bool shuttingDown = mShuttingDown;
+                mWorkerMutex.unlock();
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+                if( shuttingDown )
+                    break;
+                continue;
+#else
+                break;
+#endif
+            }
+
+            LoadJob job = mPendingLoads.front();
+            mPendingLoads.pop_front();
+            mWorkerMutex.unlock();
+
+            job.data =
+                reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( tileSizeBytes, MEMCATEGORY_RESOURCE ) );
+
+            TextureBox box( paddedRes, paddedRes, 1u, 1u, bytesPerPixel, bytesPerRow, tileSizeBytes );
+            box.data = job.data;
+            if( PixelFormatGpuUtils::isCompressed( mPixelFormat ) )
+                box.setCompressedPixelFormat( mPixelFormat );
+
+            job.success = mLoader->loadTile( VirtualTextureTile::getX( job.tileId ),
+                                             VirtualTextureTile::getY( job.tileId ),
+                                             VirtualTextureTile::getMip( job.tileId ), box );
+
+            mWorkerMutex.lock();
+            mFinishedLoads.push_back( job );
+            mWorkerMutex.unlock();
+        }
+
+        return 0;
+    }
+}  // namespace Ogre
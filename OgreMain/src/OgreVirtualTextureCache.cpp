@@ -0,0 +1,453 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreVirtualTextureCache.h"
+
+#include "OgreBitwise.h"
+#include "OgreException.h"
+#include "OgreProfiler.h"
+#include "OgreTextureBox.h"
+
+namespace Ogre
+{
+    using namespace VirtualTextureTile;
+
+    struct OrderVirtualTextureCandidates
+    {
+        template <typename T>
+        bool operator()( const T &a, const T &b ) const
+        {
+            // Coarser mips first, they're the fallback of everything below them.
+            const uint8 mipA = getMip( a.tileId );
+            const uint8 mipB = getMip( b.tileId );
+            if( mipA != mipB )
+                return mipA > mipB;
+            if( a.numRequests != b.numRequests )
+                return a.numRequests > b.numRequests;
+            return a.tileId < b.tileId;
+        }
+    };
+    //-----------------------------------------------------------------------------------
+    VirtualTextureCache::VirtualTextureCache( uint32 widthInTiles, uint32 heightInTiles, uint8 numMips,
+                                              uint32 numSlots, uint32 slotsPerRow ) :
+        mWidthInTiles( widthInTiles ),
+        mHeightInTiles( heightInTiles ),
+        mNumMips( 0u ),
+        mSlotsPerRow( slotsPerRow ),
+        mNumUsedSlots( 0u ),
+        mLruHead( c_invalid ),
+        mLruTail( c_invalid ),
+        mIndirectionDirty( true )
+    {
+        if( widthInTiles == 0u || heightInTiles == 0u || widthInTiles > c_maxTilesPerSide ||
+            heightInTiles > c_maxTilesPerSide )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Virtual texture resolution in tiles must be in range [1; 16384]",
+                         "VirtualTextureCache::VirtualTextureCache" );
+        }
+
+        // The indirection texture is a regular TextureGpu with getNumMips() mips. Its mip sizes
+        // only match ours (every tile of mip N having exactly one parent in mip N + 1) when the
+        // resolution is a power of 2.
+        if( !Bitwise::isPO2( widthInTiles ) || !Bitwise::isPO2( heightInTiles ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Virtual texture resolution in tiles must be a power of 2",
+                         "VirtualTextureCache::VirtualTextureCache" );
+        }
+
+        if( slotsPerRow == 0u || slotsPerRow > 256u ||
+            ( numSlots + slotsPerRow - 1u ) / slotsPerRow > 256u )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "The atlas can't have more than 256x256 slots",
+                         "VirtualTextureCache::VirtualTextureCache" );
+        }
+
+        // Count the full mip chain, same as TextureGpu does.
+        uint8 maxMips = 1u;
+        while( maxMips < c_maxMips &&
+               ( getWidthInTiles( maxMips - 1u ) > 1u || getHeightInTiles( maxMips - 1u ) > 1u ) )
+        {
+            ++maxMips;
+        }
+        mNumMips = numMips == 0u ? maxMips : std::min( numMips, maxMips );
+
+        const uint8 coarsestMip = static_cast<uint8>( mNumMips - 1u );
+        if( numSlots <= getWidthInTiles( coarsestMip ) * getHeightInTiles( coarsestMip ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "numSlots must be bigger than the number of tiles in the coarsest mip",
+                         "VirtualTextureCache::VirtualTextureCache" );
+        }
+
+        size_t totalEntries = 0u;
+        for( uint8 mip = 0u; mip < mNumMips; ++mip )
+        {
+            mMipOffsets[mip] = static_cast<uint32>( totalEntries );
+            totalEntries += getWidthInTiles( mip ) * getHeightInTiles( mip );
+        }
+        mIndirection.resize( totalEntries, 0u );
+
+        Slot emptySlot;
+        emptySlot.tileId = c_invalid;
+        emptySlot.lastFrameUsed = 0u;
+        emptySlot.prev = c_invalid;
+        emptySlot.next = c_invalid;
+        mSlots.resize( numSlots, emptySlot );
+    }
+    //-----------------------------------------------------------------------------------
+    VirtualTextureCache::~VirtualTextureCache() {}
+    //-----------------------------------------------------------------------------------
+    uint32 VirtualTextureCache::getWidthInTiles( uint8 mip ) const
+    {
+        return std::max( mWidthInTiles >> mip, 1u );
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 VirtualTextureCache::getHeightInTiles( uint8 mip ) const
+    {
+        return std::max( mHeightInTiles >> mip, 1u );
+    }
+    //-----------------------------------------------------------------------------------
+    bool VirtualTextureCache::isValidTile( uint32 tileId ) const
+    {
+        const uint8 mip = getMip( tileId );
+        return tileId != c_invalid && mip < mNumMips && getX( tileId ) < getWidthInTiles( mip ) &&
+               getY( tileId ) < getHeightInTiles( mip );
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTextureCache::unlinkSlot( uint32 slotIdx )
+    {
+        Slot &slot = mSlots[slotIdx];
+
+        if( slot.prev != c_invalid )
+            mSlots[slot.prev].next = slot.next;
+        else if( mLruHead == slotIdx )
+            mLruHead = slot.next;
+
+        if( slot.next != c_invalid )
+            mSlots[slot.next].prev = slot.prev;
+        else if( mLruTail == slotIdx )
+            mLruTail = slot.prev;
+
+        slot.prev = c_invalid;
+        slot.next = c_invalid;
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTextureCache::linkSlotAsMostRecent( uint32 slotIdx )
+    {
+        Slot &slot = mSlots[slotIdx];
+        slot.prev = mLruTail;
+        slot.next = c_invalid;
+
+        if( mLruTail != c_invalid )
+            mSlots[mLruTail].next = slotIdx;
+        else
+            mLruHead = slotIdx;
+        mLruTail = slotIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTextureCache::touchSlot( uint32 slotIdx, uint32 currentFrame )
+    {
+        Slot &slot = mSlots[slotIdx];
+        slot.lastFrameUsed = currentFrame;
+
+        // Pinned tiles aren't in the list
+        if( getMip( slot.tileId ) != mNumMips - 1u && mLruTail != slotIdx )
+        {
+            unlinkSlot( slotIdx );
+            linkSlotAsMostRecent( slotIdx );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 VirtualTextureCache::allocateSlot( uint32 currentFrame )
+    {
+        if( mNumUsedSlots < mSlots.size() )
+            return mNumUsedSlots++;
+
+        if( mLruHead == c_invalid || mSlots[mLruHead].lastFrameUsed == currentFrame )
+            return c_invalid;
+
+        const uint32 slotIdx = mLruHead;
+        unlinkSlot( slotIdx );
+
+        Slot &slot = mSlots[slotIdx];
+        mResidentTiles.erase( slot.tileId );
+        mIndirectionDirty = true;
+
+        return slotIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTextureCache::processFeedback( const uint32 *RESTRICT_ALIAS tileIds, size_t numEntries )
+    {
+        OgreProfileExhaustive( "VirtualTextureCache::processFeedback" );
+
+        // Feedback buffers are full of repeated values (neighbouring pixels sample
+        // the same tile). Avoid hashing them over and over.
+        uint32 lastTileId = c_invalid;
+        uint32 lastCount = 0u;
+
+        for( size_t i = 0u; i < numEntries; ++i )
+        {
+            const uint32 tileId = tileIds[i];
+            if( tileId == lastTileId )
+            {
+                ++lastCount;
+            }
+            else
+            {
+                if( lastCount )
+                    requestTile( lastTileId, lastCount );
+                lastTileId = tileId;
+                lastCount = 1u;
+            }
+        }
+
+        if( lastCount )
+            requestTile( lastTileId, lastCount );
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTextureCache::processFeedback( const TextureBox &box )
+    {
+        OGRE_ASSERT_LOW( box.bytesPerPixel == sizeof( uint32 ) );
+
+        for( uint32 slice = 0u; slice < box.getDepthOrSlices(); ++slice )
+        {
+            for( uint32 y = 0u; y < box.height; ++y )
+            {
+                const uint32 *row =
+                    reinterpret_cast<const uint32 *>( box.atFromOffsettedOrigin( 0u, y, slice ) );
+                processFeedback( row, box.width );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTextureCache::requestTile( uint32 tileId, uint32 numRequests )
+    {
+        if( isValidTile( tileId ) )
+            mRequestCounts[tileId] += numRequests;
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTextureCache::update( uint32 currentFrame, size_t maxTilesToLoad,
+                                      TileIdVec &outTilesToLoad )
+    {
+        OgreProfileExhaustive( "VirtualTextureCache::update" );
+
+        mTmpCandidates.clear();
+        mTmpCandidateIdx.clear();
+
+        TileCountMap::const_iterator itor = mRequestCounts.begin();
+        TileCountMap::const_iterator endt = mRequestCounts.end();
+
+        while( itor != endt )
+        {
+            // Walk up the mip chain until we find something resident. Everything
+            // in between must be loaded too, since that's what we'll fall back to.
+            uint32 tileId = itor->first;
+            bool bFoundResident = false;
+
+            while( !bFoundResident && getMip( tileId ) < mNumMips )
+            {
+                TileToSlotMap::const_iterator itSlot = mResidentTiles.find( tileId );
+                if( itSlot != mResidentTiles.end() )
+                {
+                    touchSlot( itSlot->second, currentFrame );
+                    bFoundResident = true;
+                }
+                else if( mLoadingTiles.find( tileId ) == mLoadingTiles.end() )
+                {
+                    TileCountMap::iterator itIdx = mTmpCandidateIdx.find( tileId );
+                    if( itIdx == mTmpCandidateIdx.end() )
+                    {
+                        mTmpCandidateIdx[tileId] = static_cast<uint32>( mTmpCandidates.size() );
+                        Candidate candidate;
+                        candidate.tileId = tileId;
+                        candidate.numRequests = itor->second;
+                        mTmpCandidates.push_back( candidate );
+                    }
+                    else
+                    {
+                        mTmpCandidates[itIdx->second].numRequests += itor->second;
+                    }
+                }
+
+                tileId = getParent( tileId );
+            }
+
+            ++itor;
+        }
+
+        mRequestCounts.clear();
+
+        const size_t numToLoad = std::min( maxTilesToLoad, mTmpCandidates.size() );
+        if( numToLoad < mTmpCandidates.size() )
+        {
+            std::partial_sort( mTmpCandidates.begin(), mTmpCandidates.begin() + ptrdiff_t( numToLoad ),
+                               mTmpCandidates.end(), OrderVirtualTextureCandidates() );
+        }
+        else
+        {
+            std::sort( mTmpCandidates.begin(), mTmpCandidates.end(), OrderVirtualTextureCandidates() );
+        }
+
+        for( size_t i = 0u; i < numToLoad; ++i )
+        {
+            const uint32 tileId = mTmpCandidates[i].tileId;
+            mLoadingTiles.insert( tileId );
+            outTilesToLoad.push_back( tileId );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 VirtualTextureCache::notifyTileLoaded( uint32 tileId, uint32 currentFrame,
+                                                  uint32 &outEvictedTileId )
+    {
+        outEvictedTileId = c_invalid;
+        mLoadingTiles.erase( tileId );
+
+        if( !isValidTile( tileId ) )
+            return c_invalid;
+
+        TileToSlotMap::const_iterator itSlot = mResidentTiles.find( tileId );
+        if( itSlot != mResidentTiles.end() )
+        {
+            // Already there (i.e. loaded twice because of a clear() in the middle)
+            touchSlot( itSlot->second, currentFrame );
+            return itSlot->second;
+        }
+
+        const uint32 slotIdx = allocateSlot( currentFrame );
+        if( slotIdx == c_invalid )
+            return c_invalid;
+
+        Slot &slot = mSlots[slotIdx];
+        outEvictedTileId = slot.tileId;
+
+        slot.tileId = tileId;
+        slot.lastFrameUsed = currentFrame;
+        // Tiles from the coarsest mip are pinned: they're never linked, thus never evicted.
+        if( getMip( tileId ) != mNumMips - 1u )
+            linkSlotAsMostRecent( slotIdx );
+
+        mResidentTiles[tileId] = slotIdx;
+        mIndirectionDirty = true;
+
+        return slotIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTextureCache::notifyTileLoadFailed( uint32 tileId ) { mLoadingTiles.erase( tileId ); }
+    //-----------------------------------------------------------------------------------
+    uint32 VirtualTextureCache::getSlot( uint32 tileId ) const
+    {
+        TileToSlotMap::const_iterator itor = mResidentTiles.find( tileId );
+        return itor != mResidentTiles.end() ? itor->second : c_invalid;
+    }
+    //-----------------------------------------------------------------------------------
+    bool VirtualTextureCache::isResident( uint32 tileId ) const
+    {
+        return mResidentTiles.find( tileId ) != mResidentTiles.end();
+    }
+    //-----------------------------------------------------------------------------------
+    bool VirtualTextureCache::isLoading( uint32 tileId ) const
+    {
+        return mLoadingTiles.find( tileId ) != mLoadingTiles.end();
+    }
+    //-----------------------------------------------------------------------------------
+    void VirtualTextureCache::clear()
+    {
+        SlotVec::iterator itor = mSlots.begin();
+        SlotVec::iterator endt = mSlots.end();
+
+        while( itor != endt )
+        {
+            itor->tileId = c_invalid;
+            itor->lastFrameUsed = 0u;
+            itor->prev = c_invalid;
+            itor->next = c_invalid;
+            ++itor;
+        }
+
+        mNumUsedSlots = 0u;
+        mLruHead = c_invalid;
+        mLruTail = c_invalid;
+        mResidentTiles.clear();
+        // Tiles being loaded will still call notifyTileLoaded / notifyTileLoadFailed
+        mRequestCounts.clear();
+        mIndirectionDirty = true;
+    }
+    //-----------------------------------------------------------------------------------
+    bool VirtualTextureCache::updateIndirection()
+    {
+        if( !mIndirectionDirty )
+            return false;
+
+        OgreProfileExhaustive( "VirtualTextureCache::updateIndirection" );
+
+        // Go from coarsest to finest, so that non-resident tiles can just copy their parent.
+        for( int mip = mNumMips - 1; mip >= 0; --mip )
+        {
+            const uint8 currMip = static_cast<uint8>( mip );
+            const uint32 width = getWidthInTiles( currMip );
+            const uint32 height = getHeightInTiles( currMip );
+
+            uint32 *RESTRICT_ALIAS entries = &mIndirection[mMipOffsets[currMip]];
+            const uint32 *RESTRICT_ALIAS parentEntries =
+                currMip + 1u < mNumMips ? &mIndirection[mMipOffsets[currMip + 1u]] : 0;
+            const uint32 parentWidth = getWidthInTiles( static_cast<uint8>( currMip + 1u ) );
+
+            for( uint32 y = 0u; y < height; ++y )
+            {
+                for( uint32 x = 0u; x < width; ++x )
+                {
+                    uint32 entry = 0u;
+
+                    TileToSlotMap::const_iterator itSlot =
+                        mResidentTiles.find( pack( x, y, currMip ) );
+                    if( itSlot != mResidentTiles.end() )
+                    {
+                        const uint32 slotIdx = itSlot->second;
+                        const uint32 slotX = slotIdx % mSlotsPerRow;
+                        const uint32 slotY = slotIdx / mSlotsPerRow;
+                        entry = slotX | ( slotY << 8u ) | ( uint32( currMip ) << 16u ) | 0xFF000000u;
+                    }
+                    else if( parentEntries )
+                    {
+                        entry = parentEntries[( y >> 1u ) * parentWidth + ( x >> 1u )];
+                    }
+
+                    entries[y * width + x] = entry;
+                }
+            }
+        }
+
+        mIndirectionDirty = false;
+        return true;
+    }
+}  // namespace Ogre
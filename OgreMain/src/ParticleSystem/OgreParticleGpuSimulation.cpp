@@ -0,0 +1,450 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2023 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "ParticleSystem/OgreParticleGpuSimulation.h"
+
+#include "OgreBitwise.h"
+#include "OgreHlmsCompute.h"
+#include "OgreHlmsComputeJob.h"
+#include "OgreProfiler.h"
+#include "OgreRenderSystem.h"
+#include "ParticleSystem/OgreParticleAffector2.h"
+#include "ParticleSystem/OgreParticleSystem2.h"
+#include "Vao/OgreReadOnlyBufferPacked.h"
+#include "Vao/OgreUavBufferPacked.h"
+#include "Vao/OgreVaoManager.h"
+
+using namespace Ogre;
+
+/// Number of float4 per particle in ParticleGpuSimData::state
+static constexpr uint32 kStateStride = 4u;
+/// Number of float4 per particle in ParticleGpuSimData::emitted
+static constexpr uint32 kEmittedStride = 5u;
+/// Number of float4 per affector in ParticleGpuSimData::affectors
+static constexpr uint32 kAffectorStride = 4u;
+/// Number of uint4 per particle in ParticleGpuSimData::output (i.e. sizeof( ParticleGpuData ))
+static constexpr uint32 kOutputStride = 2u;
+
+ParticleGpuSimulation::ParticleGpuSimulation( RenderSystem *renderSystem, HlmsCompute *hlmsCompute,
+                                              HlmsComputeJob *emitJob, HlmsComputeJob *simulateJob,
+                                              HlmsComputeJob *sortJob, HlmsComputeJob *gatherJob ) :
+    mVaoManager( renderSystem->getVaoManager() ),
+    mRenderSystem( renderSystem ),
+    mHlmsCompute( hlmsCompute ),
+    mEmitJob( emitJob ),
+    mSimulateJob( simulateJob ),
+    mSortJob( sortJob ),
+    mGatherJob( gatherJob )
+{
+}
+//-----------------------------------------------------------------------------
+bool ParticleGpuSimulation::canSimulate( const ParticleSystemDef *systemDef ) const
+{
+    // All our jobs are 1D. The sort needs the quota rounded up to a power of 2.
+    const size_t maxThreads = 65535u * mSortJob->getThreadsPerGroupX();
+    if( Bitwise::firstPO2From( systemDef->getQuota() ) > maxThreads )
+        return false;
+
+    ParticleGpuAffectorParams params;
+    for( const ParticleAffector2 *affector : systemDef->getAffectors() )
+    {
+        if( !affector->getGpuParams( params ) )
+            return false;
+    }
+
+    return true;
+}
+//-----------------------------------------------------------------------------
+ParticleGpuSimData *ParticleGpuSimulation::createSimData( const ParticleSystemDef *systemDef )
+{
+    const uint32 quota = systemDef->getQuota();
+
+    ParticleGpuSimData *simData = new ParticleGpuSimData();
+
+    {
+        // Everything starts dead (time to live = 0), like the CPU data.
+        const size_t sizeBytes = quota * kStateStride * 4u * sizeof( float );
+        void *zeroData = OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_GEOMETRY );
+        FreeOnDestructor dataPtrContainer( zeroData );
+        memset( zeroData, 0, sizeBytes );
+        simData->state = mVaoManager->createUavBuffer( quota * kStateStride, 4u * sizeof( float ),
+                                                       BB_FLAG_UAV, zeroData, false );
+    }
+
+    simData->output =
+        mVaoManager->createUavBuffer( quota * kOutputStride, 4u * sizeof( uint32 ),
+                                      BB_FLAG_UAV | BB_FLAG_READONLY, 0, false );
+
+    if( systemDef->getSortingEnabled() )
+    {
+        simData->unsorted = mVaoManager->createUavBuffer( quota * kOutputStride, 4u * sizeof( uint32 ),
+                                                          BB_FLAG_UAV, 0, false );
+        simData->sortKeys = mVaoManager->createUavBuffer( Bitwise::firstPO2From( quota ),
+                                                          2u * sizeof( uint32 ), BB_FLAG_UAV, 0, false );
+    }
+
+    // Always create it (even without affectors) so there's always something bound.
+    simData->numAffectors = static_cast<uint32>( systemDef->getAffectors().size() );
+    simData->affectors = mVaoManager->createReadOnlyBuffer(
+        PFG_RGBA32_FLOAT, std::max( simData->numAffectors, 1u ) * kAffectorStride * 4u * sizeof( float ),
+        BT_DYNAMIC_PERSISTENT, 0, false );
+
+    return simData;
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::clearJobSlots( HlmsComputeJob *job )
+{
+    const uint8 numUavUnits = static_cast<uint8>( job->getNumUavUnits() );
+    for( uint8 i = 0u; i < numUavUnits; ++i )
+        job->_setUavBuffer( i, DescriptorSetUav::BufferSlot::makeEmpty() );
+
+    const uint8 numTexUnits = static_cast<uint8>( job->getNumTexUnits() );
+    for( uint8 i = 0u; i < numTexUnits; ++i )
+        job->setTexBuffer( i, DescriptorSetTexture2::BufferSlot::makeEmpty() );
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::destroySimData( ParticleGpuSimData *simData )
+{
+    // The jobs may still reference the buffers we're about to destroy
+    clearJobSlots( mEmitJob );
+    clearJobSlots( mSimulateJob );
+    clearJobSlots( mSortJob );
+    clearJobSlots( mGatherJob );
+
+    if( simData->affectors->getMappingState() != MS_UNMAPPED )
+        simData->affectors->unmap( UO_UNMAP_ALL );
+    mVaoManager->destroyReadOnlyBuffer( simData->affectors );
+    if( simData->emitted )
+    {
+        if( simData->emitted->getMappingState() != MS_UNMAPPED )
+            simData->emitted->unmap( UO_UNMAP_ALL );
+        mVaoManager->destroyReadOnlyBuffer( simData->emitted );
+    }
+    if( simData->sortKeys )
+        mVaoManager->destroyUavBuffer( simData->sortKeys );
+    if( simData->unsorted )
+        mVaoManager->destroyUavBuffer( simData->unsorted );
+    mVaoManager->destroyUavBuffer( simData->output );
+    mVaoManager->destroyUavBuffer( simData->state );
+
+    delete simData;
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::_beginUpdate( ParticleSystemDef *systemDef, const uint32 numEmitted )
+{
+    ParticleGpuSimData *simData = systemDef->_getGpuSimData();
+    OGRE_ASSERT_LOW( simData );
+
+    simData->firstSlot =
+        static_cast<uint32>( systemDef->getActiveParticlesPackOffset() * ARRAY_PACKED_REALS );
+    simData->numSlots = static_cast<uint32>( systemDef->getNumSimdActiveParticles() );
+    simData->numEmitted = numEmitted;
+
+    if( numEmitted == 0u )
+        return;
+
+    const size_t sizeBytes = numEmitted * kEmittedStride * 4u * sizeof( float );
+
+    if( !simData->emitted || simData->emitted->getNumElements() < sizeBytes )
+    {
+        if( simData->emitted )
+        {
+            if( simData->emitted->getMappingState() != MS_UNMAPPED )
+                simData->emitted->unmap( UO_UNMAP_ALL );
+            mVaoManager->destroyReadOnlyBuffer( simData->emitted );
+        }
+
+        // Grow with some slack, emission rates tend to fluctuate
+        simData->emitted = mVaoManager->createReadOnlyBuffer(
+            PFG_RGBA32_FLOAT, sizeBytes + ( sizeBytes >> 1u ), BT_DYNAMIC_PERSISTENT, 0, false );
+    }
+
+    simData->emittedData = reinterpret_cast<float *>( simData->emitted->map( 0u, sizeBytes ) );
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::_uploadEmitted( ParticleGpuSimData *simData,
+                                            const ParticleCpuData &cpuData,
+                                            const EmittedParticle *newParticles,
+                                            const size_t numParticles, const size_t offset )
+{
+    float *RESTRICT_ALIAS dst = simData->emittedData + offset * kEmittedStride * 4u;
+
+    for( size_t i = 0u; i < numParticles; ++i )
+    {
+        const size_t h = newParticles[i].handle;
+        const size_t j = h / ARRAY_PACKED_REALS;
+        const size_t idx = h % ARRAY_PACKED_REALS;
+
+        Vector3 position, direction;
+        Vector2 dimensions;
+        Vector4 colour;
+        cpuData.mPosition[j].getAsVector3( position, idx );
+        cpuData.mDirection[j].getAsVector3( direction, idx );
+        cpuData.mDimensions[j].getAsVector2( dimensions, idx );
+        cpuData.mColour[j].getAsVector4( colour, idx );
+
+        const Real *RESTRICT_ALIAS timeToLive =
+            reinterpret_cast<const Real * RESTRICT_ALIAS>( cpuData.mTimeToLive );
+        const Real *RESTRICT_ALIAS totalTimeToLive =
+            reinterpret_cast<const Real * RESTRICT_ALIAS>( cpuData.mTotalTimeToLive );
+        const Real *RESTRICT_ALIAS rotation =
+            reinterpret_cast<const Real * RESTRICT_ALIAS>( cpuData.mRotation );
+
+        *dst++ = static_cast<float>( position.x );
+        *dst++ = static_cast<float>( position.y );
+        *dst++ = static_cast<float>( position.z );
+        *dst++ = static_cast<float>( timeToLive[h] );
+
+        *dst++ = static_cast<float>( direction.x );
+        *dst++ = static_cast<float>( direction.y );
+        *dst++ = static_cast<float>( direction.z );
+        *dst++ = static_cast<float>( totalTimeToLive[h] );
+
+        *dst++ = static_cast<float>( colour.x );
+        *dst++ = static_cast<float>( colour.y );
+        *dst++ = static_cast<float>( colour.z );
+        *dst++ = static_cast<float>( colour.w );
+
+        *dst++ = static_cast<float>( dimensions.x );
+        *dst++ = static_cast<float>( dimensions.y );
+        *dst++ = static_cast<float>( rotation[h] );
+        *dst++ = 0.0f;
+
+        // canSimulate() guarantees the quota (hence the handle) is exactly representable.
+        *dst++ = static_cast<float>( h );
+        *dst++ = 0.0f;
+        *dst++ = 0.0f;
+        *dst++ = 0.0f;
+    }
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::dispatch( HlmsComputeJob *job, const uint32 numThreads )
+{
+    const uint32 threadsPerGroupX = job->getThreadsPerGroupX();
+    job->setNumThreadGroups( ( numThreads + threadsPerGroupX - 1u ) / threadsPerGroupX, 1u, 1u );
+
+    mResourceTransitions.clear();
+    job->analyzeBarriers( mResourceTransitions );
+    mRenderSystem->executeResourceTransition( mResourceTransitions );
+    mHlmsCompute->dispatch( job, 0, 0 );
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::_dispatch( const FastArray<ParticleSystemDef *> &systemDefs,
+                                       const float timeSinceLast, const Vector3 &camPos )
+{
+    OgreProfileGpuBegin( "Particle GPU Simulation" );
+
+    ShaderParams::Param paramEmit;
+    paramEmit.name = "emitParams";
+    ShaderParams::Param paramSim;
+    paramSim.name = "simParams";
+    ShaderParams::Param paramSimF;
+    paramSimF.name = "simParamsF";
+    ShaderParams::Param paramSort;
+    paramSort.name = "sortParams";
+    ShaderParams::Param paramGather;
+    paramGather.name = "gatherParams";
+
+    BarrierSolver &solver = mRenderSystem->getBarrierSolver();
+
+    for( ParticleSystemDef *systemDef : systemDefs )
+    {
+        ParticleGpuSimData *simData = systemDef->_getGpuSimData();
+        if( !simData )
+            continue;
+
+        DescriptorSetUav::BufferSlot uavSlot( DescriptorSetUav::BufferSlot::makeEmpty() );
+        DescriptorSetTexture2::BufferSlot texSlot( DescriptorSetTexture2::BufferSlot::makeEmpty() );
+
+        // 1. Scatter the newly emitted particles into the state.
+        if( simData->numEmitted > 0u )
+        {
+            const size_t sizeBytes = simData->numEmitted * kEmittedStride * 4u * sizeof( float );
+            simData->emitted->unmap( UO_KEEP_PERSISTENT, 0u, sizeBytes );
+            simData->emittedData = 0;
+
+            uavSlot.buffer = simData->state;
+            uavSlot.access = ResourceAccess::Write;
+            mEmitJob->_setUavBuffer( 0, uavSlot );
+
+            texSlot.buffer = simData->emitted;
+            mEmitJob->setTexBuffer( 0, texSlot );
+
+            const uint32 emitParams[4] = { simData->numEmitted, 0u, 0u, 0u };
+            paramEmit.setManualValue( emitParams, 4u );
+            ShaderParams &shaderParams = mEmitJob->getShaderParams( "default" );
+            shaderParams.mParams.clear();
+            shaderParams.mParams.push_back( paramEmit );
+            shaderParams.setDirty();
+
+            dispatch( mEmitJob, simData->numEmitted );
+        }
+
+        const uint32 numSlots = simData->numSlots;
+        if( numSlots == 0u )
+            continue;
+
+        // 2. Run the affectors & integrate.
+        const bool bSorted = simData->sortKeys != 0;
+        const uint32 numSortKeys = bSorted ? Bitwise::firstPO2From( numSlots ) : 0u;
+
+        if( simData->numAffectors > 0u )
+        {
+            const size_t sizeBytes = simData->numAffectors * kAffectorStride * 4u * sizeof( float );
+            float *RESTRICT_ALIAS affectorData =
+                reinterpret_cast<float * RESTRICT_ALIAS>( simData->affectors->map( 0u, sizeBytes ) );
+
+            for( const ParticleAffector2 *affector : systemDef->getAffectors() )
+            {
+                ParticleGpuAffectorParams params;
+                if( !affector->getGpuParams( params ) )
+                {
+                    OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                                 "Affector " + affector->getType() +
+                                     " stopped supporting the GPU simulation after init().",
+                                     "ParticleGpuSimulation::_dispatch" );
+                }
+
+                *affectorData++ = static_cast<float>( params.type );
+                *affectorData++ = 0.0f;
+                *affectorData++ = 0.0f;
+                *affectorData++ = 0.0f;
+                for( size_t i = 0u; i < 3u; ++i )
+                {
+                    for( size_t j = 0u; j < 4u; ++j )
+                        *affectorData++ = static_cast<float>( params.values[i][j] );
+                }
+            }
+
+            simData->affectors->unmap( UO_KEEP_PERSISTENT, 0u, sizeBytes );
+        }
+
+        texSlot.buffer = simData->affectors;
+        mSimulateJob->setTexBuffer( 0, texSlot );
+
+        mSimulateJob->setProperty( "sort_keys", bSorted ? 1 : 0 );
+
+        uavSlot.buffer = simData->state;
+        uavSlot.access = ResourceAccess::ReadWrite;
+        mSimulateJob->_setUavBuffer( 0, uavSlot );
+
+        uavSlot.buffer = bSorted ? simData->unsorted : simData->output;
+        uavSlot.access = ResourceAccess::Write;
+        mSimulateJob->_setUavBuffer( 1, uavSlot );
+
+        if( bSorted )
+        {
+            uavSlot.buffer = simData->sortKeys;
+            uavSlot.access = ResourceAccess::Write;
+            mSimulateJob->_setUavBuffer( 2, uavSlot );
+        }
+        else
+        {
+            // Don't leave the sort keys of the previous (possibly destroyed) system bound.
+            mSimulateJob->_setUavBuffer( 2, DescriptorSetUav::BufferSlot::makeEmpty() );
+        }
+
+        {
+            const uint32 simParams[4] = { systemDef->getQuota(), simData->firstSlot, numSlots,
+                                          simData->numAffectors };
+            const float simParamsF[4] = { timeSinceLast, static_cast<float>( camPos.x ),
+                                          static_cast<float>( camPos.y ),
+                                          static_cast<float>( camPos.z ) };
+            paramSim.setManualValue( simParams, 4u );
+            paramSimF.setManualValue( simParamsF, 4u );
+            ShaderParams &shaderParams = mSimulateJob->getShaderParams( "default" );
+            shaderParams.mParams.clear();
+            shaderParams.mParams.push_back( paramSim );
+            shaderParams.mParams.push_back( paramSimF );
+            shaderParams.setDirty();
+        }
+
+        // When sorting, the padding up to the next power of 2 must be written too (as dead).
+        dispatch( mSimulateJob, bSorted ? numSortKeys : numSlots );
+
+        // 3. Bitonic sort back to front & gather in order.
+        if( bSorted )
+        {
+            uavSlot.buffer = simData->sortKeys;
+            uavSlot.access = ResourceAccess::ReadWrite;
+            mSortJob->_setUavBuffer( 0, uavSlot );
+
+            ShaderParams &shaderParams = mSortJob->getShaderParams( "default" );
+
+            for( uint32 k = 2u; k <= numSortKeys; k <<= 1u )
+            {
+                for( uint32 j = k >> 1u; j > 0u; j >>= 1u )
+                {
+                    const uint32 sortParams[4] = { k, j, numSortKeys, 0u };
+                    paramSort.setManualValue( sortParams, 4u );
+                    shaderParams.mParams.clear();
+                    shaderParams.mParams.push_back( paramSort );
+                    shaderParams.setDirty();
+
+                    dispatch( mSortJob, numSortKeys );
+                }
+            }
+
+            uavSlot.buffer = simData->output;
+            uavSlot.access = ResourceAccess::Write;
+            mGatherJob->_setUavBuffer( 0, uavSlot );
+            uavSlot.buffer = simData->unsorted;
+            uavSlot.access = ResourceAccess::Read;
+            mGatherJob->_setUavBuffer( 1, uavSlot );
+            uavSlot.buffer = simData->sortKeys;
+            uavSlot.access = ResourceAccess::Read;
+            mGatherJob->_setUavBuffer( 2, uavSlot );
+
+            const uint32 gatherParams[4] = { numSlots, 0u, 0u, 0u };
+            paramGather.setManualValue( gatherParams, 4u );
+            ShaderParams &gatherShaderParams = mGatherJob->getShaderParams( "default" );
+            gatherShaderParams.mParams.clear();
+            gatherShaderParams.mParams.push_back( paramGather );
+            gatherShaderParams.setDirty();
+
+            dispatch( mGatherJob, numSlots );
+        }
+    }
+
+    // The vertex shader reads the results.
+    mResourceTransitions.clear();
+    for( ParticleSystemDef *systemDef : systemDefs )
+    {
+        const ParticleGpuSimData *simData = systemDef->_getGpuSimData();
+        if( simData && simData->numSlots > 0u )
+        {
+            solver.resolveTransition( mResourceTransitions, simData->output, ResourceAccess::Read,
+                                      1u << GPT_VERTEX_PROGRAM );
+        }
+    }
+    mRenderSystem->executeResourceTransition( mResourceTransitions );
+
+    OgreProfileGpuEnd( "Particle GPU Simulation" );
+}
@@ -38,9 +38,11 @@ THE SOFTWARE.
 #include "OgreSceneManager.h"
 #include "ParticleSystem/OgreEmitter2.h"
 #include "ParticleSystem/OgreParticleAffector2.h"
+#include "ParticleSystem/OgreParticleGpuSimulation.h"
 #include "ParticleSystem/OgreParticleSystemManager2.h"
 #include "Vao/OgreConstBufferPacked.h"
 #include "Vao/OgreReadOnlyBufferPacked.h"
+#include "Vao/OgreUavBufferPacked.h"
 #include "Vao/OgreVaoManager.h"
 
 using namespace Ogre;
@@ -86,6 +88,9 @@ ParticleSystemDef::ParticleSystemDef( IdType id, ObjectMemoryManager *objectMemo
     mParticleQuotaFull( false ),
     mIsBillboardSet( bIsBillboardSet ),
     mRotationType( ParticleRotationType::None ),
+    mMappedGpuData( 0 ),
+    mGpuSimulation( false ),
+    mGpuSimData( 0 ),
     mParticleType( ParticleType::Point )
 {
     memset( &mParticleCpuData, 0, sizeof( mParticleCpuData ) );
@@ -236,8 +241,19 @@ void ParticleSystemDef::init( VaoManager *vaoManager )
     mGpuCommonData =
         vaoManager->createConstBuffer( sizeof( GpuParticleCommon ), BT_DEFAULT, &particleCommon, false );
 
-    mGpuData = vaoManager->createReadOnlyBuffer(
-        PFG_RGBA32_UINT, sizeof( ParticleGpuData ) * numParticles, BT_DYNAMIC_PERSISTENT, 0, false );
+    ParticleGpuSimulation *gpuSimulation =
+        mGpuSimulation && !mIsBillboardSet ? mParticleSystemManager->_getGpuSimulation() : 0;
+    if( gpuSimulation && gpuSimulation->canSimulate( this ) )
+    {
+        mGpuSimData = gpuSimulation->createSimData( this );
+        mGpuData = mGpuSimData->output->getAsReadOnlyBufferView();
+    }
+    else
+    {
+        mGpuData = vaoManager->createReadOnlyBuffer( PFG_RGBA32_UINT,
+                                                     sizeof( ParticleGpuData ) * numParticles,
+                                                     BT_DYNAMIC_PERSISTENT, 0, false );
+    }
 
     mVaoPerLod[VpNormal].push_back( vaoManager->createVertexArrayObject(
         {}, mParticleSystemManager->_getSharedIndexBuffer( numParticles, vaoManager ),
@@ -278,16 +294,28 @@ void ParticleSystemDef::_destroy( VaoManager *vaoManager )
 
         mParticleCpuData.mPosition = 0;
 
-        if( mGpuData->getMappingState() != MS_UNMAPPED )
+        if( mGpuSimData )
+        {
+            // mGpuData is a view of mGpuSimData->output. It's destroyed along with it.
+            if( vaoManager )
+                mParticleSystemManager->_getGpuSimulation()->destroySimData( mGpuSimData );
+            mGpuSimData = 0;
+            mGpuData = 0;
+        }
+        else if( mGpuData->getMappingState() != MS_UNMAPPED )
         {
             mGpuData->unmap( UO_UNMAP_ALL );
             mParticleGpuData = 0;
+            mMappedGpuData = 0;
         }
 
         if( vaoManager )
         {
-            vaoManager->destroyReadOnlyBuffer( mGpuData );
-            mGpuData = 0;
+            if( mGpuData )
+            {
+                vaoManager->destroyReadOnlyBuffer( mGpuData );
+                mGpuData = 0;
+            }
 
             vaoManager->destroyConstBuffer( mGpuCommonData );
             mGpuCommonData = 0;
@@ -332,6 +360,12 @@ void ParticleSystemDef::setRotationType( ParticleRotationType::ParticleRotationT
     mRotationType = rotationType;
 }
 //-----------------------------------------------------------------------------
+void ParticleSystemDef::setGpuSimulation( bool bGpuSimulation )
+{
+    OGRE_ASSERT_LOW( !isInitialized() );
+    mGpuSimulation = bGpuSimulation;
+}
+//-----------------------------------------------------------------------------
 ParticleRotationType::ParticleRotationType ParticleSystemDef::getRotationType() const
 {
     return mRotationType;
@@ -644,6 +678,7 @@ void ParticleSystemDef::cloneTo( ParticleSystemDef *toClone )
     toClone->mCommonDirection = this->mCommonDirection;
     toClone->mCommonUpVector = this->mCommonUpVector;
     toClone->mRotationType = this->mRotationType;
+    toClone->mGpuSimulation = this->mGpuSimulation;
     toClone->mParticleType = this->mParticleType;
     toClone->setParticleQuota( this->getQuota() );
 
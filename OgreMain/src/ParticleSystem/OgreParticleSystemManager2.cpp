@@ -32,12 +32,18 @@ THE SOFTWARE.
 
 #include "Math/Array/OgreArrayConfig.h"
 #include "Math/Array/OgreBooleanMask.h"
+#include "OgreHlmsCompute.h"
+#include "OgreHlmsManager.h"
+#include "OgreLogManager.h"
 #include "OgreRenderQueue.h"
+#include "OgreRenderSystem.h"
+#include "OgreRoot.h"
 #include "OgreSceneManager.h"
 #include "ParticleSystem/OgreBillboardSet2.h"
 #include "ParticleSystem/OgreEmitter2.h"
 #include "ParticleSystem/OgreParticle2.h"
 #include "ParticleSystem/OgreParticleAffector2.h"
+#include "ParticleSystem/OgreParticleGpuSimulation.h"
 #include "ParticleSystem/OgreParticleSystem2.h"
 #include "Vao/OgreIndexBufferPacked.h"
 #include "Vao/OgreReadOnlyBufferPacked.h"
@@ -49,6 +55,21 @@ using namespace Ogre;
 static std::map<IdString, ParticleAffectorFactory2 *> sAffectorFactories;
 static std::map<IdString, ParticleEmitterDefDataFactory *> sEmitterDefFactories;
 
+/// Depth keys are sorted in 4 passes of 8 bits each.
+static constexpr uint32 kNumRadixPasses = 4u;
+static constexpr uint32 kNumRadixBuckets = 256u;
+
+/// Converts a squared distance to camera into a radix key that sorts back to front.
+/// Non-negative IEEE floats sort like integers, so we only need to flip the order.
+/// Dead particles use 0xFFFFFFFF so they always end up last.
+static inline uint32 toDepthSortKey( const float sqDistance )
+{
+    uint32 bits;
+    memcpy( &bits, &sqDistance, sizeof( bits ) );
+    // Clamps +Inf & NaN (and anything with the sign bit set) to the farthest key.
+    return 0x7F7FFFFFu - std::min( bits, 0x7F7FFFFFu );
+}
+
 ParticleSystemManager2::ParticleSystemManager2( SceneManager *sceneManager,
                                                 ParticleSystemManager2 *master ) :
     mSceneManager( sceneManager ),
@@ -58,7 +79,9 @@ ParticleSystemManager2::ParticleSystemManager2( SceneManager *sceneManager,
     mHighestPossibleQuota32( 0u ),
     mTimeSinceLast( 0 ),
     mMaster( master ),
-    mCameraPos( Vector3::ZERO )
+    mCameraPos( Vector3::ZERO ),
+    mGpuSimulation( 0 ),
+    mGpuSimulationChecked( false )
 {
     if( sceneManager )
         mMemoryManager = &sceneManager->_getParticleSysDefMemoryManager();
@@ -82,6 +105,9 @@ ParticleSystemManager2::~ParticleSystemManager2()
     mActiveParticleSystemDefs.clear();
     mParticleSystemDefMap.clear();
 
+    OGRE_DELETE mGpuSimulation;
+    mGpuSimulation = 0;
+
     if( !mSceneManager )
         delete mMemoryManager;
     mMemoryManager = 0;
@@ -89,6 +115,7 @@ ParticleSystemManager2::~ParticleSystemManager2()
 //-----------------------------------------------------------------------------
 void ParticleSystemManager2::tickParticles( const size_t threadIdx, const ArrayReal timeSinceLast,
                                             ParticleCpuData cpuData, ParticleGpuData *gpuData,
+                                            uint32 *sortKeys, const ArrayVector3 &camPos,
                                             const size_t numParticles, ParticleSystemDef *systemDef,
                                             ArrayAabb &inOutAabb )
 {
@@ -155,8 +182,19 @@ void ParticleSystemManager2::tickParticles( const size_t threadIdx, const ArrayR
         Mathlib::extractS16( Mathlib::ToSnorm16( vColour.mChunkBase[2] ), colour[2] );
         Mathlib::extractS8( Mathlib::ToSnorm8Unsafe( vColour.mChunkBase[3] ), alpha );
 
+        OGRE_ALIGNED_DECL( Real, sqDistances[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+        if( sortKeys )
+            CastArrayToReal( sqDistances, cpuData.mPosition->squaredDistance( camPos ) );
+
         for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
         {
+            if( sortKeys )
+            {
+                sortKeys[j] = IS_BIT_SET( j, scalarIsDead )
+                                  ? 0xFFFFFFFFu
+                                  : toDepthSortKey( static_cast<float>( sqDistances[j] ) );
+            }
+
             if( IS_BIT_SET( j, scalarIsDead ) )
             {
                 if( !IS_BIT_SET( j, scalarWasDead ) )
@@ -197,12 +235,44 @@ void ParticleSystemManager2::tickParticles( const size_t threadIdx, const ArrayR
             ++gpuData;
         }
 
+        if( sortKeys )
+            sortKeys += ARRAY_PACKED_REALS;
+
         cpuData.advancePack();
     }
 
     inOutAabb = aabb;
 }
 //-----------------------------------------------------------------------------
+void ParticleSystemManager2::tickTimeToLive( const size_t threadIdx, const ArrayReal timeSinceLast,
+                                             ParticleCpuData cpuData, const size_t numParticles,
+                                             ParticleSystemDef *systemDef )
+{
+    for( size_t i = 0u; i < numParticles; i += ARRAY_PACKED_REALS )
+    {
+        const ArrayMaskR wasDead = Mathlib::CompareLessEqual( *cpuData.mTimeToLive, ARRAY_REAL_ZERO );
+        *cpuData.mTimeToLive = Mathlib::Max( *cpuData.mTimeToLive - timeSinceLast, ARRAY_REAL_ZERO );
+        const ArrayMaskR isDead = Mathlib::CompareLessEqual( *cpuData.mTimeToLive, ARRAY_REAL_ZERO );
+
+        const uint32 scalarJustDied =
+            BooleanMask4::getScalarMask( isDead ) & ~BooleanMask4::getScalarMask( wasDead );
+
+        if( scalarJustDied )
+        {
+            for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
+            {
+                if( IS_BIT_SET( j, scalarJustDied ) )
+                {
+                    systemDef->mParticlesToKill[threadIdx].push_back(
+                        systemDef->getHandle( cpuData, j ) );
+                }
+            }
+        }
+
+        cpuData.advancePack();
+    }
+}
+//-----------------------------------------------------------------------------
 void ParticleSystemManager2::sortAndPrepare( ParticleSystemDef *systemDef, const Vector3 &camPos,
                                              const float timeSinceLast )
 {
@@ -256,6 +326,7 @@ void ParticleSystemManager2::updateSerialPos()
             billboardSet->mGpuData->unmap( UO_KEEP_PERSISTENT, 0u,
                                            sizeof( ParticleGpuData ) * numParticlesToFlush );
             billboardSet->mParticleGpuData = 0;
+            billboardSet->mMappedGpuData = 0;
         }
 
         Aabb aabb = Aabb::BOX_NULL;
@@ -282,6 +353,7 @@ void ParticleSystemManager2::updateSerialPos()
             systemDef->mGpuData->unmap( UO_KEEP_PERSISTENT, 0u,
                                         sizeof( ParticleGpuData ) * numParticlesToFlush );
             systemDef->mParticleGpuData = 0;
+            systemDef->mMappedGpuData = 0;
         }
 
         for( FastArray<uint32> &threadParticlesToKill : systemDef->mParticlesToKill )
@@ -372,6 +444,14 @@ void ParticleSystemManager2::_updateParallel01( const size_t threadIdx, const si
                         numParticlesToProcess );
                 }
 
+                if( systemDef->mGpuSimData )
+                {
+                    ParticleGpuSimulation::_uploadEmitted(
+                        systemDef->mGpuSimData, cpuData,
+                        systemDef->mNewParticles.begin() + currOffset + toAdvance,
+                        numParticlesToProcess, currOffset + toAdvance );
+                }
+
                 // We've processed numParticlesToProcess but we need to skip newParticlesPerEmitter
                 // because the gap "newParticlesPerEmitter - numParticlesToProcess" is being
                 // processed by other threads.
@@ -387,6 +467,8 @@ void ParticleSystemManager2::_updateParallel01( const size_t threadIdx, const si
 void ParticleSystemManager2::_updateParallel02( const size_t threadIdx, const size_t numThreads )
 {
     const ArrayReal timeSinceLast = Mathlib::SetAll( mTimeSinceLast );
+    const ArrayVector3 camPos( Mathlib::SetAll( mCameraPos.x ), Mathlib::SetAll( mCameraPos.y ),
+                               Mathlib::SetAll( mCameraPos.z ) );
 
     for( ParticleSystemDef *systemDef : mActiveParticleSystemDefs )
     {
@@ -460,13 +542,24 @@ void ParticleSystemManager2::_updateParallel02( const size_t threadIdx, const si
             OGRE_ASSERT_MEDIUM( threadAdvance <= quota || numParticlesToProcess == 0u );
             cpuData.advancePack( threadAdvance / ARRAY_PACKED_REALS );
 
-            ParticleGpuData *gpuData = systemDef->mParticleGpuData + gpuAdvance;
+            if( systemDef->mGpuSimData )
+            {
+                // Affectors & the rest of the simulation run on the GPU. We just need to
+                // know which particles die. The AABB stays null (i.e. infinite).
+                tickTimeToLive( threadIdx, timeSinceLast, cpuData, numParticlesToProcess, systemDef );
+            }
+            else
+            {
+                ParticleGpuData *gpuData = systemDef->mParticleGpuData + gpuAdvance;
+                uint32 *sortKeys =
+                    systemDef->mMappedGpuData ? systemDef->mSortKeys[0].begin() + gpuAdvance : 0;
 
-            for( const ParticleAffector2 *affector : systemDef->mAffectors )
-                affector->run( cpuData, numParticlesToProcess, timeSinceLast );
+                for( const ParticleAffector2 *affector : systemDef->mAffectors )
+                    affector->run( cpuData, numParticlesToProcess, timeSinceLast );
 
-            tickParticles( threadIdx, timeSinceLast, cpuData, gpuData, numParticlesToProcess, systemDef,
-                           aabb );
+                tickParticles( threadIdx, timeSinceLast, cpuData, gpuData, sortKeys, camPos,
+                               numParticlesToProcess, systemDef, aabb );
+            }
 
             gpuAdvance += numParticlesToProcess;
             totalThreadNumParticlesToProcess = particleExcess;
@@ -540,8 +633,10 @@ void ParticleSystemManager2::_updateParallel02( const size_t threadIdx, const si
             cpuData.advancePack( threadAdvance / ARRAY_PACKED_REALS );
 
             ParticleGpuData *gpuData = billboardSet->mParticleGpuData + gpuAdvance;
-            tickParticles( threadIdx, ARRAY_REAL_ZERO, cpuData, gpuData, numParticlesToProcess,
-                           billboardSet, aabb );
+            uint32 *sortKeys =
+                billboardSet->mMappedGpuData ? billboardSet->mSortKeys[0].begin() + gpuAdvance : 0;
+            tickParticles( threadIdx, ARRAY_REAL_ZERO, cpuData, gpuData, sortKeys, camPos,
+                           numParticlesToProcess, billboardSet, aabb );
 
             gpuAdvance += numParticlesToProcess;
             totalThreadNumParticlesToProcess = particleExcess;
@@ -565,6 +660,100 @@ void ParticleSystemManager2::_updateParallel02( const size_t threadIdx, const si
     }
 }
 //-----------------------------------------------------------------------------
+uint32 ParticleSystemManager2::_getNumSortStages() const
+{
+    // Histogram + scatter per pass, plus the final copy to the GPU buffer.
+    return mDepthSortedSystemDefs.empty() ? 0u : kNumRadixPasses * 2u + 1u;
+}
+//-----------------------------------------------------------------------------
+void ParticleSystemManager2::_sortParallel( const size_t threadIdx, const size_t numThreads,
+                                            const uint32 stage )
+{
+    const uint32 pass = stage >> 1u;
+    const uint32 shift = pass * 8u;
+
+    for( ParticleSystemDef *systemDef : mDepthSortedSystemDefs )
+    {
+        OGRE_ASSERT_MEDIUM( systemDef->mSortHistogram.size() >= numThreads * kNumRadixBuckets );
+
+        const size_t numParticles = systemDef->getNumSimdActiveParticles();
+        const size_t particlesPerThread = ( numParticles + numThreads - 1u ) / numThreads;
+        const size_t begin = std::min( threadIdx * particlesPerThread, numParticles );
+        const size_t end = std::min( begin + particlesPerThread, numParticles );
+
+        if( pass == kNumRadixPasses )
+        {
+            // An even number of passes leaves the result in buffer 0.
+            const uint32 *RESTRICT_ALIAS sortedIndices = systemDef->mSortIndices[0].begin();
+            const ParticleGpuData *RESTRICT_ALIAS stagingData = systemDef->mSortStagingGpuData.begin();
+            ParticleGpuData *RESTRICT_ALIAS gpuData = systemDef->mMappedGpuData;
+            for( size_t i = begin; i < end; ++i )
+                gpuData[i] = stagingData[sortedIndices[i]];
+            continue;
+        }
+
+        // Each pass reads from buffer ( pass & 1 ) and writes into the other one.
+        // The first pass has no source indices: they're implicitly the identity.
+        const uint32 *RESTRICT_ALIAS srcKeys = systemDef->mSortKeys[pass & 1u].begin();
+        const uint32 *RESTRICT_ALIAS srcIndices = systemDef->mSortIndices[pass & 1u].begin();
+        uint32 *RESTRICT_ALIAS histogram = systemDef->mSortHistogram.begin();
+
+        if( !( stage & 1u ) )
+        {
+            uint32 *RESTRICT_ALIAS threadHistogram = histogram + threadIdx * kNumRadixBuckets;
+            memset( threadHistogram, 0, sizeof( uint32 ) * kNumRadixBuckets );
+            for( size_t i = begin; i < end; ++i )
+                ++threadHistogram[( srcKeys[i] >> shift ) & 0xFFu];
+            continue;
+        }
+
+        // Our slice of bucket d starts after every smaller bucket (from all threads) plus
+        // bucket d of the threads before us. That's what keeps the sort stable.
+        uint32 offsets[kNumRadixBuckets];
+        uint32 bucketStart = 0u;
+        bool bSingleBucket = false;
+        for( size_t d = 0u; d < kNumRadixBuckets; ++d )
+        {
+            uint32 bucketTotal = 0u;
+            uint32 threadStart = 0u;
+            for( size_t t = 0u; t < numThreads; ++t )
+            {
+                if( t == threadIdx )
+                    threadStart = bucketTotal;
+                bucketTotal += histogram[t * kNumRadixBuckets + d];
+            }
+            offsets[d] = bucketStart + threadStart;
+            bucketStart += bucketTotal;
+            bSingleBucket |= bucketTotal == numParticles;
+        }
+
+        uint32 *RESTRICT_ALIAS dstKeys = systemDef->mSortKeys[( pass + 1u ) & 1u].begin();
+        uint32 *RESTRICT_ALIAS dstIndices = systemDef->mSortIndices[( pass + 1u ) & 1u].begin();
+
+        if( bSingleBucket )
+        {
+            // Every key has the same digit (common for the top byte). The order doesn't change.
+            memcpy( dstKeys + begin, srcKeys + begin, ( end - begin ) * sizeof( uint32 ) );
+            if( pass == 0u )
+            {
+                for( size_t i = begin; i < end; ++i )
+                    dstIndices[i] = static_cast<uint32>( i );
+            }
+            else
+                memcpy( dstIndices + begin, srcIndices + begin, ( end - begin ) * sizeof( uint32 ) );
+        }
+        else
+        {
+            for( size_t i = begin; i < end; ++i )
+            {
+                const uint32 dstIdx = offsets[( srcKeys[i] >> shift ) & 0xFFu]++;
+                dstKeys[dstIdx] = srcKeys[i];
+                dstIndices[dstIdx] = pass == 0u ? static_cast<uint32>( i ) : srcIndices[i];
+            }
+        }
+    }
+}
+//-----------------------------------------------------------------------------
 void ParticleSystemManager2::addEmitterFactory( ParticleEmitterDefDataFactory *factory )
 {
     const auto insertionResult = sEmitterDefFactories.insert( { factory->getName(), factory } );
@@ -941,6 +1130,50 @@ IndexBufferPacked *ParticleSystemManager2::_getSharedIndexBuffer( size_t maxQuot
     return mSharedIndexBuffer32;
 }
 //-----------------------------------------------------------------------------
+ParticleGpuSimulation *ParticleSystemManager2::_getGpuSimulation()
+{
+    if( !mGpuSimulationChecked && mSceneManager )
+    {
+        mGpuSimulationChecked = true;
+
+        const char *jobNames[4] = { "Compute/Tools/Particles/Emit", "Compute/Tools/Particles/Simulate",
+                                    "Compute/Tools/Particles/BitonicSort",
+                                    "Compute/Tools/Particles/Gather" };
+        HlmsComputeJob *jobs[4] = { 0, 0, 0, 0 };
+
+        RenderSystem *renderSystem = mSceneManager->getDestinationRenderSystem();
+        if( !renderSystem->getCapabilities()->hasCapability( RSC_COMPUTE_PROGRAM ) )
+        {
+            LogManager::getSingleton().logMessage(
+                "Compute shaders not supported. Particle systems will be simulated on the CPU." );
+            return 0;
+        }
+
+        HlmsCompute *hlmsCompute = Root::getSingleton().getHlmsManager()->getComputeHlms();
+        bool bAllFound = hlmsCompute != 0;
+        for( size_t i = 0u; i < 4u && bAllFound; ++i )
+        {
+            jobs[i] = hlmsCompute->findComputeJobNoThrow( jobNames[i] );
+            bAllFound = jobs[i] != 0;
+        }
+
+        if( bAllFound )
+        {
+            mGpuSimulation = OGRE_NEW ParticleGpuSimulation( renderSystem, hlmsCompute, jobs[0], jobs[1],
+                                                             jobs[2], jobs[3] );
+        }
+        else
+        {
+            LogManager::getSingleton().logMessage(
+                "Compute/Tools/Particles jobs not found. Include the resources bundled at "
+                "Samples/Media/Compute/Tools. Particle systems will be simulated on the CPU.",
+                LML_CRITICAL );
+        }
+    }
+
+    return mGpuSimulation;
+}
+//-----------------------------------------------------------------------------
 void ParticleSystemManager2::prepareForUpdate( const Real timeSinceLast )
 {
     mActiveParticlesLeftToSort.clear();
@@ -951,17 +1184,60 @@ void ParticleSystemManager2::prepareForUpdate( const Real timeSinceLast )
     mActiveParticlesLeftToSort.appendPOD( mActiveParticleSystemDefs.begin(),
                                           mActiveParticleSystemDefs.end() );
 
+    // _prepareParallel() pops from the back. Hand out the most expensive systems first so
+    // that one heavy system picked up last doesn't leave the other threads idle.
+    std::sort( mActiveParticlesLeftToSort.begin(), mActiveParticlesLeftToSort.end(),
+               []( const ParticleSystemDef *a, const ParticleSystemDef *b )
+               {
+                   return a->mParticleSystems.size() * ( a->mEmitters.size() + 1u ) <
+                          b->mParticleSystems.size() * ( b->mEmitters.size() + 1u );
+               } );
+
+    mDepthSortedSystemDefs.clear();
+
     for( ParticleSystemDef *systemDef : mActiveParticleSystemDefs )
     {
-        systemDef->mParticleGpuData = reinterpret_cast<ParticleGpuData *>(
+        // Written by ParticleGpuSimulation instead.
+        if( systemDef->mGpuSimData )
+            continue;
+
+        ParticleGpuData *mappedGpuData = reinterpret_cast<ParticleGpuData *>(
             systemDef->mGpuData->map( 0u, systemDef->mGpuData->getNumElements() ) );
+        if( systemDef->getSortingEnabled() )
+            prepareDepthSort( systemDef, mappedGpuData );
+        else
+            systemDef->mParticleGpuData = mappedGpuData;
     }
 
     for( BillboardSet *billboardSet : mBillboardSets )
     {
-        billboardSet->mParticleGpuData = reinterpret_cast<ParticleGpuData *>(
+        ParticleGpuData *mappedGpuData = reinterpret_cast<ParticleGpuData *>(
             billboardSet->mGpuData->map( 0u, billboardSet->mGpuData->getNumElements() ) );
+        if( billboardSet->getSortingEnabled() )
+            prepareDepthSort( billboardSet, mappedGpuData );
+        else
+            billboardSet->mParticleGpuData = mappedGpuData;
+    }
+}
+//-----------------------------------------------------------------------------
+void ParticleSystemManager2::prepareDepthSort( ParticleSystemDef *systemDef,
+                                               ParticleGpuData *mappedGpuData )
+{
+    const size_t quota = systemDef->getQuota();
+    if( systemDef->mSortStagingGpuData.size() != quota )
+    {
+        systemDef->mSortStagingGpuData.resizePOD( quota );
+        for( size_t i = 0u; i < 2u; ++i )
+        {
+            systemDef->mSortKeys[i].resizePOD( quota );
+            systemDef->mSortIndices[i].resizePOD( quota );
+        }
     }
+    systemDef->mSortHistogram.resizePOD( mSceneManager->getNumWorkerThreads() * kNumRadixBuckets );
+
+    systemDef->mMappedGpuData = mappedGpuData;
+    systemDef->mParticleGpuData = systemDef->mSortStagingGpuData.begin();
+    mDepthSortedSystemDefs.push_back( systemDef );
 }
 //-----------------------------------------------------------------------------
 void ParticleSystemManager2::update()
@@ -969,8 +1245,23 @@ void ParticleSystemManager2::update()
     if( mActiveParticleSystemDefs.empty() && mBillboardSets.empty() )
         return;
 
+    if( mGpuSimulation )
+    {
+        for( ParticleSystemDef *systemDef : mActiveParticleSystemDefs )
+        {
+            if( systemDef->mGpuSimData )
+            {
+                mGpuSimulation->_beginUpdate( systemDef,
+                                              static_cast<uint32>( systemDef->mNewParticles.size() ) );
+            }
+        }
+    }
+
     mSceneManager->_fireParticleSystemManager2Update();
     updateSerialPos();
+
+    if( mGpuSimulation )
+        mGpuSimulation->_dispatch( mActiveParticleSystemDefs, mTimeSinceLast, mCameraPos );
 }
 //-----------------------------------------------------------------------------
 void ParticleSystemManager2::_addParticleSystemDefAsActive( ParticleSystemDef *def )
@@ -0,0 +1,188 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Vao/OgreStagingUploadBatch.h"
+
+#include "OgreCommon.h"
+#include "OgreException.h"
+#include "OgreProfiler.h"
+#include "Vao/OgreBufferPacked.h"
+#include "Vao/OgreStagingBuffer.h"
+#include "Vao/OgreVaoManager.h"
+
+namespace Ogre
+{
+    StagingUploadBatch::StagingUploadBatch( VaoManager *vaoManager ) :
+        mVaoManager( vaoManager ),
+        mMaxStagingSize( 32u * 1024u * 1024u )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    StagingUploadBatch::~StagingUploadBatch()
+    {
+        OGRE_ASSERT_LOW( mPendingUploads.empty() &&
+                         "StagingUploadBatch destroyed without calling flush or discardPending" );
+    }
+    //-----------------------------------------------------------------------------------
+    void StagingUploadBatch::enqueue( BufferPacked *buffer, size_t elementStart, size_t elementCount,
+                                      const void *data )
+    {
+        if( buffer->getBufferType() == BT_IMMUTABLE )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE, "Cannot upload to an immutable buffer!",
+                         "StagingUploadBatch::enqueue" );
+        }
+
+        if( elementCount + elementStart > buffer->getNumElements() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Size of the provided data goes out of bounds!",
+                         "StagingUploadBatch::enqueue" );
+        }
+
+        ++mStats.numUploads;
+
+        if( !elementCount )
+            return;
+
+        const size_t bytesPerElement = buffer->getBytesPerElement();
+        mStats.bytesUploaded += elementCount * bytesPerElement;
+
+        if( buffer->getBufferType() >= BT_DEFAULT_SHARED || buffer->getShadowCopy() )
+        {
+            ++mStats.numDirectUploads;
+            buffer->upload( data, elementStart, elementCount );
+            return;
+        }
+
+        PendingUpload pendingUpload;
+        pendingUpload.buffer = buffer;
+        pendingUpload.dstOffset = elementStart * bytesPerElement;
+        pendingUpload.length = elementCount * bytesPerElement;
+
+        // Keep the source 4-byte aligned unless it continues the previous upload,
+        // in which case both get merged into one copy.
+        pendingUpload.srcOffset = mData.size();
+        if( !mPendingUploads.empty() )
+        {
+            const PendingUpload &prev = mPendingUploads.back();
+            if( prev.buffer != buffer || prev.dstOffset + prev.length != pendingUpload.dstOffset )
+                pendingUpload.srcOffset = alignToNextMultiple<size_t>( mData.size(), 4u );
+        }
+
+        mData.resize( pendingUpload.srcOffset + pendingUpload.length );
+        memcpy( &mData[pendingUpload.srcOffset], data, pendingUpload.length );
+
+        mPendingUploads.push_back( pendingUpload );
+    }
+    //-----------------------------------------------------------------------------------
+    void StagingUploadBatch::flushRange( size_t start, size_t end )
+    {
+        const size_t srcStart = mPendingUploads[start].srcOffset;
+        const size_t sizeBytes =
+            mPendingUploads[end - 1u].srcOffset + mPendingUploads[end - 1u].length - srcStart;
+
+        StagingBuffer *stagingBuffer = mVaoManager->getStagingBuffer( sizeBytes, true );
+
+        void *dstData = stagingBuffer->map( sizeBytes );
+        memcpy( dstData, &mData[srcStart], sizeBytes );
+
+        StagingBuffer::DestinationVec destinations;
+        destinations.reserve( end - start );
+
+        for( size_t i = start; i < end; ++i )
+        {
+            const PendingUpload &pendingUpload = mPendingUploads[i];
+            const size_t srcOffset = pendingUpload.srcOffset - srcStart;
+
+            if( !destinations.empty() )
+            {
+                StagingBuffer::Destination &prev = destinations.back();
+                if( prev.destination == pendingUpload.buffer &&
+                    prev.dstOffset + prev.length == pendingUpload.dstOffset &&
+                    prev.srcOffset + prev.length == srcOffset )
+                {
+                    prev.length += pendingUpload.length;
+                    continue;
+                }
+            }
+
+            destinations.push_back( StagingBuffer::Destination(
+                pendingUpload.buffer, pendingUpload.dstOffset, srcOffset, pendingUpload.length ) );
+        }
+
+        stagingBuffer->unmap( destinations );
+        stagingBuffer->removeReferenceCount();
+
+        mStats.numCopies += destinations.size();
+        ++mStats.numStagingMaps;
+    }
+    //-----------------------------------------------------------------------------------
+    void StagingUploadBatch::flush()
+    {
+        if( mPendingUploads.empty() )
+            return;
+
+        OgreProfileExhaustive( "StagingUploadBatch::flush" );
+
+        const size_t numPendingUploads = mPendingUploads.size();
+
+        size_t start = 0u;
+        while( start < numPendingUploads )
+        {
+            // Grab as many uploads as fit in mMaxStagingSize (at least one)
+            const size_t srcStart = mPendingUploads[start].srcOffset;
+            size_t end = start + 1u;
+            while( end < numPendingUploads )
+            {
+                const PendingUpload &pendingUpload = mPendingUploads[end];
+                if( pendingUpload.srcOffset + pendingUpload.length - srcStart > mMaxStagingSize )
+                    break;
+                ++end;
+            }
+
+            flushRange( start, end );
+            start = end;
+        }
+
+        discardPending();
+    }
+    //-----------------------------------------------------------------------------------
+    void StagingUploadBatch::discardPending()
+    {
+        mPendingUploads.clear();
+        mData.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void StagingUploadBatch::setMaxStagingSize( size_t maxSizeBytes )
+    {
+        OGRE_ASSERT_LOW( maxSizeBytes > 0u );
+        mMaxStagingSize = maxSizeBytes;
+    }
+}  // namespace Ogre
@@ -32,6 +32,7 @@ THE SOFTWARE.
 
 #include "OgreCommon.h"
 #include "OgreLogManager.h"
+#include "OgreProfiler.h"
 #include "OgreRoot.h"
 #include "OgreStringConverter.h"
 #include "OgreTimer.h"
@@ -58,6 +59,8 @@ namespace Ogre
         mNextStagingBufferTimestampCheckpoint( std::numeric_limits<uint64>::max() ),
         mFrameCount( 0 ),
         mNumGeneratedVaos( 0 ),
+        mTransientBufferDefaultSize( 4u * 1024u * 1024u ),
+        mTransientBytesAllocated( 0u ),
         mConstBufferAlignment( 256 ),
         mTexBufferAlignment( 256 ),
         mUavBufferAlignment( 256 ),
@@ -487,6 +490,30 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void VaoManager::deleteAllBuffers()
     {
+        {
+            TransientRingVec::iterator itor = mTransientRings.begin();
+            TransientRingVec::iterator endt = mTransientRings.end();
+
+            while( itor != endt )
+            {
+                BufferPackedVec::const_iterator itBuf = itor->buffers.begin();
+                BufferPackedVec::const_iterator enBuf = itor->buffers.end();
+
+                while( itBuf != enBuf )
+                {
+                    if( ( *itBuf )->getMappingState() != MS_UNMAPPED )
+                        ( *itBuf )->unmap( UO_UNMAP_ALL );
+                    ++itBuf;
+                }
+
+                ++itor;
+            }
+
+            // The buffers themselves are deleted below
+            mTransientRings.clear();
+            mTransientBytesAllocated = 0u;
+        }
+
         for( int i = 0; i < NUM_BUFFER_PACKED_TYPES; ++i )
         {
             BufferPackedSet::const_iterator itor = mBuffers[i].begin();
@@ -675,9 +702,299 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void VaoManager::getRelocatableBuffers( BufferPackedVec &outBuffers ) const
+    {
+        outBuffers.clear();
+
+        // All vertex buffers in a Vao must start at the same element. Leave those alone.
+        BufferPackedSet pinnedBuffers;
+        {
+            VertexArrayObjectSet::const_iterator itor = mVertexArrayObjects.begin();
+            VertexArrayObjectSet::const_iterator endt = mVertexArrayObjects.end();
+
+            while( itor != endt )
+            {
+                const VertexBufferPackedVec &vertexBuffers = ( *itor )->getVertexBuffers();
+                if( vertexBuffers.size() > 1u )
+                    pinnedBuffers.insert( vertexBuffers.begin(), vertexBuffers.end() );
+                ++itor;
+            }
+        }
+
+        const BufferPackedTypes bufferPackedTypes[2] = { BP_TYPE_VERTEX, BP_TYPE_INDEX };
+
+        for( size_t i = 0u; i < 2u; ++i )
+        {
+            BufferPackedSet::const_iterator itor = mBuffers[bufferPackedTypes[i]].begin();
+            BufferPackedSet::const_iterator endt = mBuffers[bufferPackedTypes[i]].end();
+
+            while( itor != endt )
+            {
+                BufferPacked *buffer = *itor;
+                if( ( buffer->getBufferType() == BT_IMMUTABLE ||
+                      buffer->getBufferType() == BT_DEFAULT ) &&
+                    pinnedBuffers.find( buffer ) == pinnedBuffers.end() )
+                {
+#ifdef _OGRE_MULTISOURCE_VBO
+                    if( bufferPackedTypes[i] != BP_TYPE_VERTEX ||
+                        !static_cast<VertexBufferPacked *>( buffer )->getMultiSourcePool() )
+#endif
+                    {
+                        outBuffers.push_back( buffer );
+                    }
+                }
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::updateVaosOfRelocatedBuffers( const BufferPackedVec &relocatedBuffers )
+    {
+        if( relocatedBuffers.empty() )
+            return;
+
+        BufferPackedSet relocated;
+        relocated.insert( relocatedBuffers.begin(), relocatedBuffers.end() );
+
+        VertexArrayObjectSet::const_iterator itor = mVertexArrayObjects.begin();
+        VertexArrayObjectSet::const_iterator endt = mVertexArrayObjects.end();
+
+        while( itor != endt )
+        {
+            VertexArrayObject *vao = *itor;
+
+            bool needsUpdate = vao->getIndexBuffer() &&
+                               relocated.find( vao->getIndexBuffer() ) != relocated.end();
+
+            VertexBufferPackedVec::const_iterator itBuf = vao->getVertexBuffers().begin();
+            VertexBufferPackedVec::const_iterator enBuf = vao->getVertexBuffers().end();
+
+            while( itBuf != enBuf && !needsUpdate )
+            {
+                needsUpdate = relocated.find( *itBuf ) != relocated.end();
+                ++itBuf;
+            }
+
+            if( needsUpdate )
+            {
+                // Create an API Vao that points to the new location and give it to the
+                // existing VertexArrayObject. The temporary one takes the old API Vao
+                // with it, so the old one gets released if nobody else uses it.
+                VertexArrayObject *tmpVao = createVertexArrayObjectImpl(
+                    vao->getVertexBuffers(), vao->getIndexBuffer(), vao->getOperationType() );
+                ++mNumGeneratedVaos;
+
+                std::swap( vao->mVaoName, tmpVao->mVaoName );
+                std::swap( vao->mRenderQueueId, tmpVao->mRenderQueueId );
+                std::swap( vao->mInputLayoutId, tmpVao->mInputLayoutId );
+
+                destroyVertexArrayObjectImpl( tmpVao );
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    VaoManager::DefragmentationReport VaoManager::defragmentPools( size_t maxBytesToMove )
+    {
+        DefragmentationReport report;
+
+        if( !maxBytesToMove )
+            return report;
+
+        OgreProfileExhaustive( "VaoManager::defragmentPools" );
+
+        BufferPackedVec candidates;
+        getRelocatableBuffers( candidates );
+
+        if( !candidates.empty() )
+            defragmentPoolsImpl( maxBytesToMove, candidates, report );
+
+        return report;
+    }
+    //-----------------------------------------------------------------------------------
+    VaoManager::TransientRing &VaoManager::getTransientRing(
+        const VertexElement2Vec &vertexElements, IndexBufferPacked::IndexType indexType )
+    {
+        TransientRingVec::iterator itor = mTransientRings.begin();
+        TransientRingVec::iterator endt = mTransientRings.end();
+
+        while( itor != endt &&
+               ( itor->vertexElements != vertexElements || itor->indexType != indexType ) )
+        {
+            ++itor;
+        }
+
+        if( itor == endt )
+        {
+            TransientRing ring;
+            ring.vertexElements = vertexElements;
+            ring.indexType = indexType;
+            if( vertexElements.empty() )
+                ring.bytesPerElement = indexType == IndexBufferPacked::IT_16BIT ? 2u : 4u;
+            else
+                ring.bytesPerElement = calculateVertexSize( vertexElements );
+            ring.currentBuffer = 0u;
+            ring.nextBuffer = 0u;
+            ring.offset = 0u;
+            ring.mappedPtr = 0;
+            mTransientRings.push_back( ring );
+            itor = mTransientRings.end() - 1u;
+        }
+
+        return *itor;
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::unmapTransientRing( TransientRing &ring )
+    {
+        if( ring.mappedPtr )
+        {
+            ring.buffers[ring.currentBuffer]->unmap( UO_KEEP_PERSISTENT, 0u, ring.offset );
+            ring.mappedPtr = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    VaoManager::TransientAllocation VaoManager::allocateTransient( TransientRing &ring,
+                                                                   size_t         numElements )
+    {
+        OGRE_ASSERT_LOW( numElements > 0u );
+
+        BufferPacked *buffer = ring.mappedPtr ? ring.buffers[ring.currentBuffer] : 0;
+
+        if( !buffer || ring.offset + numElements > buffer->getNumElements() )
+        {
+            // Current buffer is full or was already flushed for the RenderQueue (and
+            // can't be mapped again this frame). Move on to the next one that can hold us.
+            unmapTransientRing( ring );
+
+            size_t nextBuffer = ring.nextBuffer;
+            while( nextBuffer < ring.buffers.size() &&
+                   ring.buffers[nextBuffer]->getNumElements() < numElements )
+            {
+                ++nextBuffer;
+            }
+
+            if( nextBuffer == ring.buffers.size() )
+            {
+                const size_t bufferNumElements =
+                    std::max( mTransientBufferDefaultSize / ring.bytesPerElement, numElements );
+                if( ring.vertexElements.empty() )
+                {
+                    ring.buffers.push_back( createIndexBuffer(
+                        ring.indexType, bufferNumElements, BT_DYNAMIC_PERSISTENT, 0, false ) );
+                }
+                else
+                {
+                    ring.buffers.push_back( createVertexBuffer(
+                        ring.vertexElements, bufferNumElements, BT_DYNAMIC_PERSISTENT, 0, false ) );
+                }
+            }
+
+            ring.currentBuffer = nextBuffer;
+            ring.nextBuffer = nextBuffer + 1u;
+            ring.offset = 0u;
+            buffer = ring.buffers[nextBuffer];
+
+            // Map the whole buffer, advancing to this frame's region right away so that
+            // _getFinalBufferStart is already correct when the RenderQueue builds its draws.
+            // We keep handing out pointers from this mapping until the RenderQueue needs
+            // the data or the buffer runs out.
+            ring.mappedPtr =
+                reinterpret_cast<uint8 *>( buffer->map( 0u, buffer->getNumElements(), true ) );
+        }
+
+        TransientAllocation retVal;
+        retVal.buffer = buffer;
+        retVal.data = ring.mappedPtr + ring.offset * ring.bytesPerElement;
+        retVal.elementStart = ring.offset;
+        retVal.numElements = numElements;
+
+        ring.offset += numElements;
+        mTransientBytesAllocated += numElements * ring.bytesPerElement;
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    VaoManager::TransientAllocation VaoManager::allocateTransientVertices(
+        const VertexElement2Vec &vertexElements, size_t numVertices )
+    {
+        OGRE_ASSERT_LOW( !vertexElements.empty() );
+        return allocateTransient( getTransientRing( vertexElements, IndexBufferPacked::IT_16BIT ),
+                                  numVertices );
+    }
+    //-----------------------------------------------------------------------------------
+    VaoManager::TransientAllocation VaoManager::allocateTransientIndices(
+        IndexBufferPacked::IndexType indexType, size_t numIndices )
+    {
+        return allocateTransient( getTransientRing( VertexElement2Vec(), indexType ), numIndices );
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::setTransientBufferDefaultSize( size_t sizeBytes )
+    {
+        OGRE_ASSERT_LOW( sizeBytes > 0u );
+        mTransientBufferDefaultSize = sizeBytes;
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::destroyTransientBuffers()
+    {
+        TransientRingVec::iterator itor = mTransientRings.begin();
+        TransientRingVec::iterator endt = mTransientRings.end();
+
+        while( itor != endt )
+        {
+            BufferPackedVec::const_iterator itBuf = itor->buffers.begin();
+            BufferPackedVec::const_iterator enBuf = itor->buffers.end();
+
+            while( itBuf != enBuf )
+            {
+                if( ( *itBuf )->getMappingState() != MS_UNMAPPED )
+                    ( *itBuf )->unmap( UO_UNMAP_ALL );
+
+                if( itor->vertexElements.empty() )
+                    destroyIndexBuffer( static_cast<IndexBufferPacked *>( *itBuf ) );
+                else
+                    destroyVertexBuffer( static_cast<VertexBufferPacked *>( *itBuf ) );
+                ++itBuf;
+            }
+
+            ++itor;
+        }
+
+        mTransientRings.clear();
+        mTransientBytesAllocated = 0u;
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::_preCommandBufferExecution()
+    {
+        TransientRingVec::iterator itor = mTransientRings.begin();
+        TransientRingVec::iterator endt = mTransientRings.end();
+
+        while( itor != endt )
+            unmapTransientRing( *itor++ );
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::transientBuffersFrameEnded()
+    {
+        TransientRingVec::iterator itor = mTransientRings.begin();
+        TransientRingVec::iterator endt = mTransientRings.end();
+
+        while( itor != endt )
+        {
+            unmapTransientRing( *itor );
+
+            itor->currentBuffer = 0u;
+            itor->nextBuffer = 0u;
+            itor->offset = 0u;
+            ++itor;
+        }
+
+        mTransientBytesAllocated = 0u;
+    }
+    //-----------------------------------------------------------------------------------
     void VaoManager::_update()
     {
         Root::getSingleton()._renderingFrameEnded();
+        transientBuffersFrameEnded();
         ++mFrameCount;
     }
     //-----------------------------------------------------------------------------------
@@ -0,0 +1,415 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+
+#include "OgreStableHeaders.h"
+
+#include "Vao/OgreVboSubAllocator.h"
+
+#include "OgreBitwise.h"
+
+namespace Ogre
+{
+    static inline size_t alignToNextMultiple( size_t offset, size_t alignment )
+    {
+        return ( ( offset + alignment - 1u ) / alignment ) * alignment;
+    }
+    //-----------------------------------------------------------------------------------
+    VboSubAllocator::VboSubAllocator() { reset( 0u ); }
+    //-----------------------------------------------------------------------------------
+    VboSubAllocator::VboSubAllocator( size_t capacity ) { reset( capacity ); }
+    //-----------------------------------------------------------------------------------
+    void VboSubAllocator::reset( size_t capacity )
+    {
+        mCapacity = capacity;
+        mFreeBytes = capacity;
+        mNumFreeBlocks = 0u;
+
+        mFlBitmap = 0u;
+        for( size_t i = 0u; i < FlCount; ++i )
+        {
+            mSlBitmap[i] = 0u;
+            for( size_t j = 0u; j < SlCount; ++j )
+                mFreeHeads[i][j] = InvalidNode;
+        }
+
+        mNodes.clear();
+        mUnusedNodes.clear();
+        mUsedNodes.clear();
+        mFirstNode = InvalidNode;
+
+        if( capacity > 0u )
+        {
+            mFirstNode = createNode( 0u, capacity );
+            insertFreeNode( mFirstNode );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void VboSubAllocator::mappingInsert( size_t size, uint32 &outFl, uint32 &outSl )
+    {
+        if( size < SlCount )
+        {
+            // Small sizes all go to the first level, linearly
+            outFl = 0u;
+            outSl = static_cast<uint32>( size );
+        }
+        else
+        {
+            const uint32 msb = 63u - Bitwise::clz64( static_cast<uint64>( size ) );
+            outFl = msb - SlLog2 + 1u;
+            outSl = static_cast<uint32>( size >> ( msb - SlLog2 ) ) ^ SlCount;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void VboSubAllocator::mappingSearch( size_t size, uint32 &outFl, uint32 &outSl )
+    {
+        // Round up to the next bin, so that any block in it is guaranteed to be big enough
+        if( size >= SlCount )
+        {
+            const uint32 msb = 63u - Bitwise::clz64( static_cast<uint64>( size ) );
+            size += ( size_t( 1u ) << ( msb - SlLog2 ) ) - 1u;
+        }
+        mappingInsert( size, outFl, outSl );
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 VboSubAllocator::createNode( size_t offset, size_t size )
+    {
+        uint32 nodeIdx;
+        if( !mUnusedNodes.empty() )
+        {
+            nodeIdx = mUnusedNodes.back();
+            mUnusedNodes.pop_back();
+        }
+        else
+        {
+            nodeIdx = static_cast<uint32>( mNodes.size() );
+            mNodes.push_back( Node() );
+        }
+
+        Node &node = mNodes[nodeIdx];
+        node.offset = offset;
+        node.size = size;
+        node.prevPhys = InvalidNode;
+        node.nextPhys = InvalidNode;
+        node.prevFree = InvalidNode;
+        node.nextFree = InvalidNode;
+        node.isFree = false;
+
+        return nodeIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void VboSubAllocator::destroyNode( uint32 nodeIdx ) { mUnusedNodes.push_back( nodeIdx ); }
+    //-----------------------------------------------------------------------------------
+    void VboSubAllocator::insertFreeNode( uint32 nodeIdx )
+    {
+        Node &node = mNodes[nodeIdx];
+
+        uint32 fl, sl;
+        mappingInsert( node.size, fl, sl );
+
+        const uint32 oldHead = mFreeHeads[fl][sl];
+        node.isFree = true;
+        node.prevFree = InvalidNode;
+        node.nextFree = oldHead;
+        if( oldHead != InvalidNode )
+            mNodes[oldHead].prevFree = nodeIdx;
+        mFreeHeads[fl][sl] = nodeIdx;
+
+        mFlBitmap |= uint64( 1u ) << fl;
+        mSlBitmap[fl] |= 1u << sl;
+
+        ++mNumFreeBlocks;
+    }
+    //-----------------------------------------------------------------------------------
+    void VboSubAllocator::removeFreeNode( uint32 nodeIdx )
+    {
+        Node &node = mNodes[nodeIdx];
+        OGRE_ASSERT_MEDIUM( node.isFree );
+
+        uint32 fl, sl;
+        mappingInsert( node.size, fl, sl );
+
+        if( node.prevFree != InvalidNode )
+            mNodes[node.prevFree].nextFree = node.nextFree;
+        if( node.nextFree != InvalidNode )
+            mNodes[node.nextFree].prevFree = node.prevFree;
+
+        if( mFreeHeads[fl][sl] == nodeIdx )
+        {
+            mFreeHeads[fl][sl] = node.nextFree;
+            if( node.nextFree == InvalidNode )
+            {
+                mSlBitmap[fl] &= ~( 1u << sl );
+                if( !mSlBitmap[fl] )
+                    mFlBitmap &= ~( uint64( 1u ) << fl );
+            }
+        }
+
+        node.isFree = false;
+        node.prevFree = InvalidNode;
+        node.nextFree = InvalidNode;
+
+        --mNumFreeBlocks;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 VboSubAllocator::findSuitableNode( size_t size ) const
+    {
+        uint32 fl, sl;
+        mappingSearch( size, fl, sl );
+
+        if( fl >= FlCount )
+            return InvalidNode;
+
+        uint32 slMap = mSlBitmap[fl] & ( 0xFFFFFFFFu << sl );
+        if( !slMap )
+        {
+            // Nothing left in this first level. Look in the next non-empty one
+            if( fl + 1u >= FlCount )
+                return InvalidNode;
+
+            const uint64 flMap = mFlBitmap & ( ~uint64( 0u ) << ( fl + 1u ) );
+            if( !flMap )
+                return InvalidNode;
+
+            fl = Bitwise::ctz64( flMap );
+            slMap = mSlBitmap[fl];
+        }
+
+        sl = Bitwise::ctz32( slMap );
+        return mFreeHeads[fl][sl];
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 VboSubAllocator::findNodeInExactBin( size_t size, size_t alignment ) const
+    {
+        uint32 fl, sl;
+        mappingInsert( size, fl, sl );
+
+        uint32 nodeIdx = mFreeHeads[fl][sl];
+        while( nodeIdx != InvalidNode )
+        {
+            const Node &node = mNodes[nodeIdx];
+            const size_t padding = alignToNextMultiple( node.offset, alignment ) - node.offset;
+            if( size + padding <= node.size )
+                return nodeIdx;
+            nodeIdx = node.nextFree;
+        }
+
+        return InvalidNode;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 VboSubAllocator::splitNode( uint32 nodeIdx, size_t newSize )
+    {
+        OGRE_ASSERT_MEDIUM( newSize < mNodes[nodeIdx].size );
+
+        const uint32 remainderIdx =
+            createNode( mNodes[nodeIdx].offset + newSize, mNodes[nodeIdx].size - newSize );
+
+        // createNode may have reallocated mNodes
+        Node &node = mNodes[nodeIdx];
+        Node &remainder = mNodes[remainderIdx];
+
+        node.size = newSize;
+
+        remainder.prevPhys = nodeIdx;
+        remainder.nextPhys = node.nextPhys;
+        if( node.nextPhys != InvalidNode )
+            mNodes[node.nextPhys].prevPhys = remainderIdx;
+        node.nextPhys = remainderIdx;
+
+        return remainderIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void VboSubAllocator::mergeWithNext( uint32 nodeIdx, uint32 nextIdx )
+    {
+        Node &node = mNodes[nodeIdx];
+        const Node &next = mNodes[nextIdx];
+
+        OGRE_ASSERT_MEDIUM( node.nextPhys == nextIdx && node.offset + node.size == next.offset );
+
+        node.size += next.size;
+        node.nextPhys = next.nextPhys;
+        if( next.nextPhys != InvalidNode )
+            mNodes[next.nextPhys].prevPhys = nodeIdx;
+
+        destroyNode( nextIdx );
+    }
+    //-----------------------------------------------------------------------------------
+    bool VboSubAllocator::allocate( size_t sizeBytes, size_t alignment, size_t &outOffset )
+    {
+        OGRE_ASSERT_LOW( sizeBytes > 0u && alignment > 0u );
+
+        uint32 nodeIdx = findSuitableNode( sizeBytes );
+
+        if( nodeIdx != InvalidNode && alignment > 1u )
+        {
+            // The block is big enough, but may not be after aligning its start
+            const Node &node = mNodes[nodeIdx];
+            const size_t padding = alignToNextMultiple( node.offset, alignment ) - node.offset;
+            if( sizeBytes + padding > node.size )
+                nodeIdx = InvalidNode;
+        }
+
+        if( nodeIdx == InvalidNode && alignment > 1u )
+            nodeIdx = findSuitableNode( sizeBytes + alignment - 1u );
+
+        if( nodeIdx == InvalidNode )
+        {
+            // The bins we looked at guarantee a fit, but there may still be a block
+            // in a smaller bin that is big enough (e.g. a pool of exactly sizeBytes).
+            nodeIdx = findNodeInExactBin( sizeBytes, alignment );
+            if( nodeIdx == InvalidNode )
+                return false;
+        }
+
+        removeFreeNode( nodeIdx );
+
+        const size_t alignedOffset = alignToNextMultiple( mNodes[nodeIdx].offset, alignment );
+        const size_t padding = alignedOffset - mNodes[nodeIdx].offset;
+        if( padding > 0u )
+        {
+            // Keep the padding as its own free block
+            const uint32 alignedIdx = splitNode( nodeIdx, padding );
+            insertFreeNode( nodeIdx );
+            nodeIdx = alignedIdx;
+        }
+
+        if( mNodes[nodeIdx].size > sizeBytes )
+        {
+            const uint32 remainderIdx = splitNode( nodeIdx, sizeBytes );
+            insertFreeNode( remainderIdx );
+        }
+
+        OGRE_ASSERT_MEDIUM( mNodes[nodeIdx].offset == alignedOffset &&
+                            mNodes[nodeIdx].size == sizeBytes );
+
+        mUsedNodes[alignedOffset] = nodeIdx;
+        mFreeBytes -= sizeBytes;
+
+        outOffset = alignedOffset;
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void VboSubAllocator::deallocate( size_t offset, size_t sizeBytes )
+    {
+        OffsetToNodeMap::iterator itor = mUsedNodes.find( offset );
+        OGRE_ASSERT_LOW( itor != mUsedNodes.end() && "Offset was not allocated by us!" );
+        if( itor == mUsedNodes.end() )
+            return;
+
+        uint32 nodeIdx = itor->second;
+        mUsedNodes.erase( itor );
+
+        OGRE_ASSERT_LOW( mNodes[nodeIdx].size == sizeBytes &&
+                         "sizeBytes does not match the size passed to allocate" );
+        mFreeBytes += mNodes[nodeIdx].size;
+
+        const uint32 nextIdx = mNodes[nodeIdx].nextPhys;
+        if( nextIdx != InvalidNode && mNodes[nextIdx].isFree )
+        {
+            removeFreeNode( nextIdx );
+            mergeWithNext( nodeIdx, nextIdx );
+        }
+
+        const uint32 prevIdx = mNodes[nodeIdx].prevPhys;
+        if( prevIdx != InvalidNode && mNodes[prevIdx].isFree )
+        {
+            removeFreeNode( prevIdx );
+            mergeWithNext( prevIdx, nodeIdx );
+            nodeIdx = prevIdx;
+        }
+
+        insertFreeNode( nodeIdx );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t VboSubAllocator::getLargestFreeBlock() const
+    {
+        if( !mFlBitmap )
+            return 0u;
+
+        // The largest block lives in the highest non-empty bin, but
+        // blocks within the same bin aren't sorted.
+        const uint32 fl = 63u - Bitwise::clz64( mFlBitmap );
+        const uint32 sl = 31u - Bitwise::clz32( mSlBitmap[fl] );
+
+        size_t largest = 0u;
+        uint32 nodeIdx = mFreeHeads[fl][sl];
+        while( nodeIdx != InvalidNode )
+        {
+            largest = std::max( largest, mNodes[nodeIdx].size );
+            nodeIdx = mNodes[nodeIdx].nextFree;
+        }
+
+        return largest;
+    }
+    //-----------------------------------------------------------------------------------
+    float VboSubAllocator::getFragmentation() const
+    {
+        if( mFreeBytes == 0u )
+            return 0.0f;
+        return 1.0f - static_cast<float>( double( getLargestFreeBlock() ) / double( mFreeBytes ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void VboSubAllocator::getFreeBlocks( BlockVec &outBlocks ) const
+    {
+        outBlocks.clear();
+        outBlocks.reserve( mNumFreeBlocks );
+
+        uint32 nodeIdx = mFirstNode;
+        while( nodeIdx != InvalidNode )
+        {
+            const Node &node = mNodes[nodeIdx];
+            if( node.isFree )
+                outBlocks.push_back( Block( node.offset, node.size ) );
+            nodeIdx = node.nextPhys;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void VboSubAllocator::getUsedBlocks( BlockVec &outBlocks ) const
+    {
+        outBlocks.clear();
+
+        uint32 nodeIdx = mFirstNode;
+        while( nodeIdx != InvalidNode )
+        {
+            const Node &node = mNodes[nodeIdx];
+            if( !node.isFree )
+            {
+                if( !outBlocks.empty() &&
+                    outBlocks.back().offset + outBlocks.back().size == node.offset )
+                {
+                    outBlocks.back().size += node.size;
+                }
+                else
+                {
+                    outBlocks.push_back( Block( node.offset, node.size ) );
+                }
+            }
+            nodeIdx = node.nextPhys;
+        }
+    }
+}  // namespace Ogre
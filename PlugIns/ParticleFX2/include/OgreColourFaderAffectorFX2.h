@@ -109,6 +109,8 @@ namespace Ogre
 
         void run( ParticleCpuData cpuData, size_t numParticles, ArrayReal timeSinceLast ) const override;
 
+        bool getGpuParams( ParticleGpuAffectorParams &outParams ) const override;
+
         /** Sets the minimum value to which the particles will be clamped against.
         @param rgba
             RGBA components stored in xyzw.
@@ -94,6 +94,8 @@ namespace Ogre
 
         void run( ParticleCpuData cpuData, size_t numParticles, ArrayReal timeSinceLast ) const override;
 
+        bool getGpuParams( ParticleGpuAffectorParams &outParams ) const override;
+
         /// Sets the force vector to apply to the particles in a system.
         void setForceVector( const Vector3 &force );
 
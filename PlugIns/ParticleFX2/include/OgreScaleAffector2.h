@@ -71,6 +71,8 @@ namespace Ogre
 
         void run( ParticleCpuData cpuData, size_t numParticles, ArrayReal timeSinceLast ) const override;
 
+        bool getGpuParams( ParticleGpuAffectorParams &outParams ) const override;
+
         /** Sets the scale adjustment to be made per second to particles.
         @param rate
             Sets the adjustment to be made to the x and y scale components per second. These
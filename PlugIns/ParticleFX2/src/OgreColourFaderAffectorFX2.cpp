@@ -97,6 +97,15 @@ void ColourFaderAffectorFX2::run( ParticleCpuData cpuData, const size_t numParti
     }
 }
 //-----------------------------------------------------------------------------
+bool ColourFaderAffectorFX2::getGpuParams( ParticleGpuAffectorParams &outParams ) const
+{
+    outParams.type = ParticleGpuAffectorType::ColourFader;
+    outParams.values[0] = mColourAdj;
+    outParams.values[1] = mMinColour;
+    outParams.values[2] = mMaxColour;
+    return true;
+}
+//-----------------------------------------------------------------------------
 void ColourFaderAffectorFX2::setMaxColour( const Vector4 &rgba )
 {
     mMaxColour = rgba;
@@ -124,6 +124,17 @@ void DeflectorPlaneAffector2::run( ParticleCpuData cpuData, const size_t numPart
     }
 }
 //-----------------------------------------------------------------------------
+bool DeflectorPlaneAffector2::getGpuParams( ParticleGpuAffectorParams &outParams ) const
+{
+    // Same as run(): the distance is normalized, the normal is not.
+    outParams.type = ParticleGpuAffectorType::DeflectorPlane;
+    const Real planeDistance = -mPlaneNormal.dotProduct( mPlanePoint ) /
+                               Math::Sqrt( mPlaneNormal.dotProduct( mPlaneNormal ) );
+    outParams.values[0] = Vector4( mPlaneNormal, planeDistance );
+    outParams.values[1] = Vector4( mBounce, 0, 0, 0 );
+    return true;
+}
+//-----------------------------------------------------------------------------
 void DeflectorPlaneAffector2::setPlanePoint( const Vector3 &pos )
 {
     mPlanePoint = pos;
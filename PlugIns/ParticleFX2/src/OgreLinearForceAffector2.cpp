@@ -80,6 +80,14 @@ void LinearForceAffector2::run( ParticleCpuData cpuData, const size_t numParticl
     }
 }
 //-----------------------------------------------------------------------------
+bool LinearForceAffector2::getGpuParams( ParticleGpuAffectorParams &outParams ) const
+{
+    outParams.type = mForceApplication == FA_ADD ? ParticleGpuAffectorType::LinearForceAdd
+                                                 : ParticleGpuAffectorType::LinearForceAverage;
+    outParams.values[0] = Vector4( mForceVector );
+    return true;
+}
+//-----------------------------------------------------------------------------
 void LinearForceAffector2::setForceVector( const Vector3 &force )
 {
     mForceVector = force;
@@ -84,6 +84,14 @@ void ScaleAffector2::run( ParticleCpuData cpuData, const size_t numParticles,
     }
 }
 //-----------------------------------------------------------------------------
+bool ScaleAffector2::getGpuParams( ParticleGpuAffectorParams &outParams ) const
+{
+    outParams.type =
+        mMultiplyMode ? ParticleGpuAffectorType::ScaleMultiply : ParticleGpuAffectorType::ScaleAdd;
+    outParams.values[0] = Vector4( mScaleAdj, 0, 0, 0 );
+    return true;
+}
+//-----------------------------------------------------------------------------
 void ScaleAffector2::setAdjust( Real rate )
 {
     mScaleAdj = rate;
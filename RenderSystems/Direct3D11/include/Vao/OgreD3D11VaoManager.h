@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreD3D11Prerequisites.h"
 
 #include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVboSubAllocator.h"
 
 namespace Ogre
 {
@@ -46,41 +47,8 @@ namespace Ogre
         };
 
     public:
-        struct Block
-        {
-            size_t offset;
-            size_t size;
-
-            Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
-        };
-        struct StrideChanger
-        {
-            size_t offsetAfterPadding;
-            size_t paddedBytes;
-
-            StrideChanger() : offsetAfterPadding( 0 ), paddedBytes( 0 ) {}
-            StrideChanger( size_t _offsetAfterPadding, size_t _paddedBytes ) :
-                offsetAfterPadding( _offsetAfterPadding ),
-                paddedBytes( _paddedBytes )
-            {
-            }
-
-            bool operator()( const StrideChanger &left, size_t right ) const
-            {
-                return left.offsetAfterPadding < right;
-            }
-            bool operator()( size_t left, const StrideChanger &right ) const
-            {
-                return left < right.offsetAfterPadding;
-            }
-            bool operator()( const StrideChanger &left, const StrideChanger &right ) const
-            {
-                return left.offsetAfterPadding < right.offsetAfterPadding;
-            }
-        };
-
-        typedef vector<Block>::type         BlockVec;
-        typedef vector<StrideChanger>::type StrideChangerVec;
+        typedef VboSubAllocator::Block    Block;
+        typedef VboSubAllocator::BlockVec BlockVec;
 
     protected:
         struct Vbo
@@ -89,8 +57,7 @@ namespace Ogre
             size_t               sizeBytes;
             D3D11DynamicBuffer  *dynamicBuffer;  // Null for non BT_DYNAMIC_* BOs.
 
-            BlockVec         freeBlocks;
-            StrideChangerVec strideChangers;
+            VboSubAllocator allocator;
         };
 
         struct Vao
@@ -269,8 +236,8 @@ namespace Ogre
                                                                  uint32     structureByteStride = 0 );
 
         inline void getMemoryStats( const Block &block, uint32 vboIdx0, uint32 vboIdx1, size_t poolIdx,
-                                    size_t poolCapacity, LwString &text, MemoryStatsEntryVec &outStats,
-                                    Log *log ) const;
+                                    const VboSubAllocator &pool, size_t poolLargestFreeBlock,
+                                    LwString &text, MemoryStatsEntryVec &outStats, Log *log ) const;
 
         void switchVboPoolIndexImpl( unsigned internalVboBufferType, size_t oldPoolIdx,
                                      size_t newPoolIdx, BufferPacked *buffer ) override;
@@ -2659,7 +2659,9 @@ namespace Ogre
                 const DescriptorSetUav::BufferSlot &bufferSlot = itor->getBuffer();
                 const D3D11UavBufferPacked *uavBuffer =
                     static_cast<const D3D11UavBufferPacked *>( bufferSlot.buffer );
-                uavList[i] = uavBuffer->createUav( bufferSlot );
+                // Empty slots stay unbound
+                if( uavBuffer )
+                    uavList[i] = uavBuffer->createUav( bufferSlot );
             }
 
             ++itor;
@@ -267,7 +267,8 @@ namespace Ogre
     }
     //-----------------------------------------------------------------------------------
     void D3D11VaoManager::getMemoryStats( const Block &block, uint32 vboIdx0, uint32 vboIdx1,
-                                          size_t poolIdx, size_t poolCapacity, LwString &text,
+                                          size_t poolIdx, const VboSubAllocator &pool,
+                                          size_t poolLargestFreeBlock, LwString &text,
                                           MemoryStatsEntryVec &outStats, Log *log ) const
     {
         if( log )
@@ -275,12 +276,14 @@ namespace Ogre
             text.clear();
             text.a( c_vboTypes[vboIdx0][vboIdx1], ";", (uint64)block.offset, ";", (uint64)block.size,
                     ";" );
-            text.a( (uint64)poolIdx, ";", (uint64)poolCapacity );
+            text.a( (uint64)poolIdx, ";", (uint64)pool.getCapacity(), ";" );
+            text.a( (uint64)pool.getFreeBytes(), ";", (uint64)poolLargestFreeBlock );
             log->logMessage( text.c_str(), LML_CRITICAL );
         }
 
         const uint32 vboIdx = ( vboIdx0 << 16u ) | ( vboIdx1 & 0xFFFF );
-        MemoryStatsEntry entry( vboIdx, (uint32)poolIdx, block.offset, block.size, poolCapacity, false );
+        MemoryStatsEntry entry( vboIdx, (uint32)poolIdx, block.offset, block.size, pool.getCapacity(),
+                                false, pool.getFreeBytes(), poolLargestFreeBlock );
         outStats.push_back( entry );
     }
     //-----------------------------------------------------------------------------------
@@ -298,7 +301,13 @@ namespace Ogre
         LwString text( LwString::FromEmptyPointer( &tmpBuffer[0], tmpBuffer.size() ) );
 
         if( log )
-            log->logMessage( "Pool Type;Offset;Size Bytes;Pool Idx;Pool Capacity", LML_CRITICAL );
+        {
+            log->logMessage(
+                "Pool Type;Offset;Size Bytes;Pool Idx;Pool Capacity;Pool Free Bytes;Largest Free Block",
+                LML_CRITICAL );
+        }
+
+        BlockVec usedBlocks;
 
         for( uint32 idx0 = 0; idx0 < NumInternalBufferTypes; ++idx0 )
         {
@@ -313,56 +322,21 @@ namespace Ogre
                     const size_t poolIdx = static_cast<size_t>( itor - mVbos[idx0][idx1].begin() );
                     capacityBytes += vbo.sizeBytes;
 
-                    Block usedBlock( 0, 0 );
+                    const size_t largestFreeBlock = vbo.allocator.getLargestFreeBlock();
+                    freeBytes += vbo.allocator.getFreeBytes();
 
-                    BlockVec freeBlocks = vbo.freeBlocks;
-                    while( !freeBlocks.empty() )
-                    {
-                        // Find the free block that comes next
-                        BlockVec::iterator nextBlock;
-                        {
-                            BlockVec::iterator itBlock = freeBlocks.begin();
-                            BlockVec::iterator enBlock = freeBlocks.end();
-
-                            nextBlock = itBlock;
-
-                            while( itBlock != enBlock )
-                            {
-                                if( itBlock->offset < nextBlock->offset )
-                                    nextBlock = itBlock;
-                                ++itBlock;
-                            }
-                        }
-
-                        freeBytes += nextBlock->size;
-                        usedBlock.size = nextBlock->offset - usedBlock.offset;
-
-                        // usedBlock.size could be 0 if:
-                        //  1. All of memory is free
-                        //  2. There's two contiguous free blocks, which should not happen
-                        //     due to mergeContiguousBlocks
-                        if( usedBlock.size > 0u )
-                        {
-                            getMemoryStats( usedBlock, idx0, idx1, poolIdx, vbo.sizeBytes, text,
-                                            statsVec, log );
-                        }
-
-                        usedBlock.offset += usedBlock.size;
-                        usedBlock.size = 0;
-                        efficientVectorRemove( freeBlocks, nextBlock );
-                    }
+                    vbo.allocator.getUsedBlocks( usedBlocks );
+                    if( usedBlocks.empty() )
+                        usedBlocks.push_back( Block( 0u, 0u ) );  // Still report empty pools
 
-                    if( usedBlock.size > 0u || ( usedBlock.offset == 0 && usedBlock.size == 0 ) )
+                    BlockVec::const_iterator itBlock = usedBlocks.begin();
+                    BlockVec::const_iterator enBlock = usedBlocks.end();
+
+                    while( itBlock != enBlock )
                     {
-                        if( vbo.freeBlocks.empty() )
-                        {
-                            // Deal with edge case when we're 100% full
-                            OGRE_ASSERT_LOW( usedBlock.offset == 0 && usedBlock.size == 0 );
-                            usedBlock.offset = 0u;
-                            usedBlock.size = vbo.sizeBytes;
-                        }
-                        getMemoryStats( usedBlock, idx0, idx1, poolIdx, vbo.sizeBytes, text, statsVec,
-                                        log );
+                        getMemoryStats( *itBlock, idx0, idx1, poolIdx, vbo.allocator, largestFreeBlock,
+                                        text, statsVec, log );
+                        ++itBlock;
                     }
 
                     ++itor;
@@ -419,7 +393,7 @@ namespace Ogre
                 while( itor != end )
                 {
                     Vbo &vbo = *itor;
-                    if( vbo.freeBlocks.size() == 1u && vbo.sizeBytes == vbo.freeBlocks.back().size )
+                    if( vbo.allocator.isEmpty() )
                     {
                         vbo.vboName.Reset();
                         delete vbo.dynamicBuffer;
@@ -459,49 +433,23 @@ namespace Ogre
             sizeBytes *= mDynamicBufferMultiplier;
         }
 
-        VboVec::const_iterator itor = mVbos[internalType][bufferType].begin();
-        VboVec::const_iterator end = mVbos[internalType][bufferType].end();
-
-        // Find a suitable VBO that can hold the requested size. We prefer those free
-        // blocks that have a matching stride (the current offset is a multiple of
-        // bytesPerElement) in order to minimize the amount of memory padding.
+        // Find a suitable VBO that can hold the requested size.
         size_t bestVboIdx = std::numeric_limits<size_t>::max();
-        ptrdiff_t bestBlockIdx = -1;
-        bool foundMatchingStride = false;
-
-        while( itor != end && !foundMatchingStride )
-        {
-            BlockVec::const_iterator blockIt = itor->freeBlocks.begin();
-            BlockVec::const_iterator blockEn = itor->freeBlocks.end();
+        size_t bufferOffset = 0u;
 
-            while( blockIt != blockEn && !foundMatchingStride )
-            {
-                const Block &block = *blockIt;
-
-                // Round to next multiple of alignment
-                size_t newOffset = ( ( block.offset + alignment - 1 ) / alignment ) * alignment;
-                size_t padding = newOffset - block.offset;
-
-                if( sizeBytes + padding <= block.size )
-                {
-                    bestVboIdx = static_cast<size_t>( itor - mVbos[internalType][bufferType].begin() );
-                    bestBlockIdx = blockIt - itor->freeBlocks.begin();
-
-                    if( newOffset == block.offset )
-                        foundMatchingStride = true;
-                }
-
-                ++blockIt;
-            }
+        VboVec::iterator itor = mVbos[internalType][bufferType].begin();
+        VboVec::iterator end = mVbos[internalType][bufferType].end();
 
+        while( itor != end && bestVboIdx == std::numeric_limits<size_t>::max() )
+        {
+            if( itor->allocator.allocate( sizeBytes, alignment, bufferOffset ) )
+                bestVboIdx = static_cast<size_t>( itor - mVbos[internalType][bufferType].begin() );
             ++itor;
         }
 
-        if( bestBlockIdx == -1 )
+        if( bestVboIdx == std::numeric_limits<size_t>::max() )
         {
             bestVboIdx = mVbos[internalType][bufferType].size();
-            bestBlockIdx = 0;
-            foundMatchingStride = true;
 
             Vbo newVbo;
 
@@ -544,7 +492,11 @@ namespace Ogre
             }
 
             newVbo.sizeBytes = poolSize;
-            newVbo.freeBlocks.push_back( Block( 0, poolSize ) );
+            newVbo.allocator.reset( poolSize );
+            const bool allocated =
+                newVbo.allocator.allocate( sizeBytes, alignment, bufferOffset );
+            OGRE_ASSERT_LOW( allocated && "A new pool must fit the buffer it was created for" );
+            OGRE_UNUSED_VAR( allocated );
             newVbo.dynamicBuffer = 0;
 
             if( bufferType >= BT_DYNAMIC_DEFAULT )
@@ -556,32 +508,11 @@ namespace Ogre
             mVbos[internalType][bufferType].push_back( newVbo );
         }
 
-        Vbo &bestVbo = mVbos[internalType][bufferType][bestVboIdx];
-        Block &bestBlock = bestVbo.freeBlocks[static_cast<size_t>( bestBlockIdx )];
-
-        size_t newOffset = ( ( bestBlock.offset + alignment - 1 ) / alignment ) * alignment;
-        size_t padding = newOffset - bestBlock.offset;
-        // Shrink our records about available data.
-        bestBlock.size -= sizeBytes + padding;
-        bestBlock.offset = newOffset + sizeBytes;
-
-        if( !foundMatchingStride )
-        {
-            // This is a stride changer, record as such.
-            StrideChangerVec::iterator itStride =
-                std::lower_bound( bestVbo.strideChangers.begin(), bestVbo.strideChangers.end(),
-                                  newOffset, StrideChanger() );
-            bestVbo.strideChangers.insert( itStride, StrideChanger( newOffset, padding ) );
-        }
-
-        if( bestBlock.size == 0 )
-            bestVbo.freeBlocks.erase( bestVbo.freeBlocks.begin() + bestBlockIdx );
-
         // To trace allocations in VS you can add conditional breakpoint with following action:
         // allocateVbo[{(int)internalType}][{(int)bufferType}][{bestVboIdx}] => bufferOffset =
-        // {newOffset}, sizeBytes = {sizeBytes}+{padding} at $CALLSTACK
+        // {bufferOffset}, sizeBytes = {sizeBytes} at $CALLSTACK
         outVboIdx = bestVboIdx;
-        outBufferOffset = newOffset;
+        outBufferOffset = bufferOffset;
     }
     //-----------------------------------------------------------------------------------
     void D3D11VaoManager::deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes,
@@ -594,22 +525,9 @@ namespace Ogre
         }
 
         Vbo &vbo = mVbos[internalType][bufferType][vboIdx];
-        StrideChangerVec::iterator itStride = std::lower_bound(
-            vbo.strideChangers.begin(), vbo.strideChangers.end(), bufferOffset, StrideChanger() );
+        vbo.allocator.deallocate( bufferOffset, sizeBytes );
 
-        if( itStride != vbo.strideChangers.end() && itStride->offsetAfterPadding == bufferOffset )
-        {
-            bufferOffset -= itStride->paddedBytes;
-            sizeBytes += itStride->paddedBytes;
-
-            vbo.strideChangers.erase( itStride );
-        }
-
-        // See if we're contiguous to a free block and make that block grow.
-        vbo.freeBlocks.push_back( Block( bufferOffset, sizeBytes ) );
-        mergeContiguousBlocks( vbo.freeBlocks.end() - 1, vbo.freeBlocks );
-
-        if( vbo.freeBlocks.back().size == vbo.sizeBytes && bufferType == BT_IMMUTABLE )
+        if( vbo.allocator.isEmpty() && bufferType == BT_IMMUTABLE )
         {
             // Immutable buffer is empty. It can't be filled again. Release the GPU memory.
             // The vbo is not removed from mVbos since that would alter the index of other
@@ -663,7 +581,6 @@ namespace Ogre
         }
 
         inOutVbo.sizeBytes = poolSize;
-        inOutVbo.freeBlocks.clear();  // No free blocks
         inOutVbo.dynamicBuffer = 0;
 
         mVbos[internalType][BT_IMMUTABLE].push_back( inOutVbo );
@@ -870,6 +787,8 @@ namespace Ogre
                     reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( totalBytes, MEMCATEGORY_GEOMETRY ) );
                 size_t dstOffset = 0;
 
+                newVbo.allocator.reset( totalBytes );
+
                 // Merge the binary data as a contiguous array
                 itor = start;
                 while( itor != end )
@@ -877,19 +796,12 @@ namespace Ogre
                     D3D11BufferInterface *bufferInterface =
                         static_cast<D3D11BufferInterface *>( ( *itor )->getBufferInterface() );
 
-                    const size_t dstOffsetBeforeAlignment = dstOffset;
-                    dstOffset =
-                        alignToNextMultiple<size_t>( dstOffset, ( *itor )->getBytesPerElement() );
-
-                    if( dstOffsetBeforeAlignment != dstOffset )
-                    {
-                        // This is a stride changer, record as such.
-                        StrideChangerVec::iterator itStride =
-                            std::lower_bound( newVbo.strideChangers.begin(), newVbo.strideChangers.end(),
-                                              dstOffset, StrideChanger() );
-                        const size_t padding = dstOffset - dstOffsetBeforeAlignment;
-                        newVbo.strideChangers.insert( itStride, StrideChanger( dstOffset, padding ) );
-                    }
+                    // The pool is filled front to back, so the allocator hands out the same
+                    // offsets we calculated. We need them reserved for deallocateVbo.
+                    const bool allocated = newVbo.allocator.allocate(
+                        ( *itor )->getTotalSizeBytes(), ( *itor )->getBytesPerElement(), dstOffset );
+                    OGRE_ASSERT_LOW( allocated && "Merged pool too small for its buffers" );
+                    OGRE_UNUSED_VAR( allocated );
 
                     memcpy( mergedData + dstOffset, bufferInterface->_getInitialData(),
                             ( *itor )->getTotalSizeBytes() );
@@ -45,6 +45,18 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     GL3PlusBufferInterface::~GL3PlusBufferInterface() {}
     //-----------------------------------------------------------------------------------
+    void GL3PlusBufferInterface::_setVboName( size_t vboPoolIdx, GLuint vboName,
+                                              size_t internalBufferStartBytes )
+    {
+        OGRE_ASSERT_LOW( !mDynamicBuffer && "Dynamic buffers can't be moved" );
+
+        mVboPoolIdx = vboPoolIdx;
+        mVboName = vboName;
+
+        mBuffer->mInternalBufferStart = internalBufferStartBytes / mBuffer->mBytesPerElement;
+        mBuffer->mFinalBufferStart = internalBufferStartBytes / mBuffer->mBytesPerElement;
+    }
+    //-----------------------------------------------------------------------------------
     void GL3PlusBufferInterface::_firstUpload( void *data, size_t elementStart, size_t elementCount )
     {
         // In OpenGL; immutable buffers are a charade. They're mostly there to satisfy D3D11's needs.
@@ -251,19 +251,21 @@ namespace Ogre
     }
     //-----------------------------------------------------------------------------------
     void GL3PlusVaoManager::getMemoryStats( const Block &block, size_t vboIdx, size_t poolIdx,
-                                            size_t poolCapacity, LwString &text,
-                                            MemoryStatsEntryVec &outStats, Log *log ) const
+                                            const VboSubAllocator &pool, size_t poolLargestFreeBlock,
+                                            LwString &text, MemoryStatsEntryVec &outStats,
+                                            Log *log ) const
     {
         if( log )
         {
             text.clear();
             text.a( c_vboTypes[vboIdx], ";", (uint64)block.offset, ";", (uint64)block.size, ";" );
-            text.a( (uint64)poolIdx, ";", (uint64)poolCapacity );
+            text.a( (uint64)poolIdx, ";", (uint64)pool.getCapacity(), ";" );
+            text.a( (uint64)pool.getFreeBytes(), ";", (uint64)poolLargestFreeBlock );
             log->logMessage( text.c_str(), LML_CRITICAL );
         }
 
-        MemoryStatsEntry entry( (uint32)vboIdx, (uint32)poolIdx, block.offset, block.size, poolCapacity,
-                                false );
+        MemoryStatsEntry entry( (uint32)vboIdx, (uint32)poolIdx, block.offset, block.size,
+                                pool.getCapacity(), false, pool.getFreeBytes(), poolLargestFreeBlock );
         outStats.push_back( entry );
     }
     //-----------------------------------------------------------------------------------
@@ -281,7 +283,13 @@ namespace Ogre
         LwString text( LwString::FromEmptyPointer( &tmpBuffer[0], tmpBuffer.size() ) );
 
         if( log )
-            log->logMessage( "Pool Type;Offset;Size Bytes;Pool Idx;Pool Capacity", LML_CRITICAL );
+        {
+            log->logMessage(
+                "Pool Type;Offset;Size Bytes;Pool Idx;Pool Capacity;Pool Free Bytes;Largest Free Block",
+                LML_CRITICAL );
+        }
+
+        BlockVec usedBlocks;
 
         for( unsigned vboIdx = 0; vboIdx < MAX_VBO_FLAG; ++vboIdx )
         {
@@ -294,54 +302,20 @@ namespace Ogre
                 const size_t poolIdx = static_cast<size_t>( itor - mVbos[vboIdx].begin() );
                 capacityBytes += vbo.sizeBytes;
 
-                Block usedBlock( 0, 0 );
-
-                BlockVec freeBlocks = vbo.freeBlocks;
-                while( !freeBlocks.empty() )
-                {
-                    // Find the free block that comes next
-                    BlockVec::iterator nextBlock;
-                    {
-                        BlockVec::iterator itBlock = freeBlocks.begin();
-                        BlockVec::iterator enBlock = freeBlocks.end();
-
-                        nextBlock = itBlock;
-
-                        while( itBlock != enBlock )
-                        {
-                            if( itBlock->offset < nextBlock->offset )
-                                nextBlock = itBlock;
-                            ++itBlock;
-                        }
-                    }
-
-                    freeBytes += nextBlock->size;
-                    usedBlock.size = nextBlock->offset - usedBlock.offset;
-
-                    // usedBlock.size could be 0 if:
-                    //  1. All of memory is free
-                    //  2. There's two contiguous free blocks, which should not happen
-                    //     due to mergeContiguousBlocks
-                    if( usedBlock.size > 0u )
-                    {
-                        getMemoryStats( usedBlock, vboIdx, poolIdx, vbo.sizeBytes, text, statsVec, log );
-                    }
+                const size_t largestFreeBlock = vbo.allocator.getLargestFreeBlock();
+                freeBytes += vbo.allocator.getFreeBytes();
 
-                    usedBlock.offset += usedBlock.size;
-                    usedBlock.size = 0;
-                    efficientVectorRemove( freeBlocks, nextBlock );
-                }
+                vbo.allocator.getUsedBlocks( usedBlocks );
+                if( usedBlocks.empty() )
+                    usedBlocks.push_back( Block( 0u, 0u ) );  // Still report empty pools
+                BlockVec::const_iterator itBlock = usedBlocks.begin();
+                BlockVec::const_iterator enBlock = usedBlocks.end();
 
-                if( usedBlock.size > 0u || ( usedBlock.offset == 0 && usedBlock.size == 0 ) )
+                while( itBlock != enBlock )
                 {
-                    if( vbo.freeBlocks.empty() )
-                    {
-                        // Deal with edge case when we're 100% full
-                        OGRE_ASSERT_LOW( usedBlock.offset == 0 && usedBlock.size == 0 );
-                        usedBlock.offset = 0u;
-                        usedBlock.size = vbo.sizeBytes;
-                    }
-                    getMemoryStats( usedBlock, vboIdx, poolIdx, vbo.sizeBytes, text, statsVec, log );
+                    getMemoryStats( *itBlock, vboIdx, poolIdx, vbo.allocator, largestFreeBlock, text,
+                                    statsVec, log );
+                    ++itBlock;
                 }
 
                 ++itor;
@@ -370,6 +344,107 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void GL3PlusVaoManager::defragmentPoolsImpl( size_t maxBytesToMove,
+                                                 const BufferPackedVec &candidates,
+                                                 DefragmentationReport &inOutReport )
+    {
+        // BT_IMMUTABLE & BT_DEFAULT buffers live in CPU_INACCESSIBLE pools
+        VboVec &vbos = mVbos[CPU_INACCESSIBLE];
+
+        // Evacuate the pool with the least used bytes. It's the cheapest to empty.
+        size_t srcPoolIdx = std::numeric_limits<size_t>::max();
+        size_t totalFreeBytes = 0u;
+        {
+            size_t minUsedBytes = std::numeric_limits<size_t>::max();
+
+            VboVec::const_iterator itor = vbos.begin();
+            VboVec::const_iterator endt = vbos.end();
+
+            while( itor != endt )
+            {
+                const size_t usedBytes = itor->allocator.getUsedBytes();
+                if( usedBytes && usedBytes < minUsedBytes )
+                {
+                    minUsedBytes = usedBytes;
+                    srcPoolIdx = static_cast<size_t>( itor - vbos.begin() );
+                }
+                totalFreeBytes += itor->allocator.getFreeBytes();
+                ++itor;
+            }
+
+            // Don't bother if the rest of the pools can't take it all
+            if( srcPoolIdx == std::numeric_limits<size_t>::max() ||
+                totalFreeBytes - vbos[srcPoolIdx].allocator.getFreeBytes() < minUsedBytes )
+            {
+                return;
+            }
+        }
+
+        Vbo &srcVbo = vbos[srcPoolIdx];
+        BufferPackedVec relocatedBuffers;
+
+        OCGE( glBindBuffer( GL_COPY_READ_BUFFER, srcVbo.vboName ) );
+
+        BufferPackedVec::const_iterator itor = candidates.begin();
+        BufferPackedVec::const_iterator endt = candidates.end();
+
+        while( itor != endt && inOutReport.bytesMoved < maxBytesToMove )
+        {
+            BufferPacked *buffer = *itor;
+            GL3PlusBufferInterface *bufferInterface =
+                static_cast<GL3PlusBufferInterface *>( buffer->getBufferInterface() );
+            const size_t sizeBytes = buffer->_getInternalTotalSizeBytes();
+
+            if( bufferInterface->getVboPoolIndex() == srcPoolIdx &&
+                inOutReport.bytesMoved + sizeBytes <= maxBytesToMove )
+            {
+                const size_t alignment = buffer->getBytesPerElement();
+                size_t dstPoolIdx = std::numeric_limits<size_t>::max();
+                size_t dstOffset = 0u;
+
+                for( size_t i = 0u; i < vbos.size() && dstPoolIdx == std::numeric_limits<size_t>::max();
+                     ++i )
+                {
+                    if( i != srcPoolIdx &&
+                        vbos[i].allocator.allocate( sizeBytes, alignment, dstOffset ) )
+                    {
+                        dstPoolIdx = i;
+                    }
+                }
+
+                if( dstPoolIdx != std::numeric_limits<size_t>::max() )
+                {
+                    const size_t srcOffset =
+                        buffer->_getInternalBufferStart() * buffer->getBytesPerElement();
+
+                    OCGE( glBindBuffer( GL_COPY_WRITE_BUFFER, vbos[dstPoolIdx].vboName ) );
+                    OCGE( glCopyBufferSubData( GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                               static_cast<GLintptr>( srcOffset ),
+                                               static_cast<GLintptr>( dstOffset ),
+                                               static_cast<GLsizeiptr>( sizeBytes ) ) );
+
+                    bufferInterface->_setVboName( dstPoolIdx, vbos[dstPoolIdx].vboName, dstOffset );
+                    srcVbo.allocator.deallocate( srcOffset, sizeBytes );
+
+                    inOutReport.bytesMoved += sizeBytes;
+                    ++inOutReport.numBuffersMoved;
+                    relocatedBuffers.push_back( buffer );
+                }
+            }
+
+            ++itor;
+        }
+
+        updateVaosOfRelocatedBuffers( relocatedBuffers );
+
+        if( srcVbo.allocator.isEmpty() )
+        {
+            ++inOutReport.numPoolsReleased;
+            inOutReport.bytesReleased += srcVbo.sizeBytes;
+            cleanupEmptyPools();
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void GL3PlusVaoManager::cleanupEmptyPools()
     {
         FastArray<GLuint> bufferNames;
@@ -382,7 +457,7 @@ namespace Ogre
             while( itor != end )
             {
                 Vbo &vbo = *itor;
-                if( vbo.freeBlocks.size() == 1u && vbo.sizeBytes == vbo.freeBlocks.back().size )
+                if( vbo.allocator.isEmpty() )
                 {
 #if OGRE_DEBUG_MODE >= OGRE_DEBUG_LOW
                     VaoVec::const_iterator itVao = mVaos.begin();
@@ -445,49 +520,23 @@ namespace Ogre
         if( bufferType >= BT_DYNAMIC_DEFAULT )
             sizeBytes *= mDynamicBufferMultiplier;
 
-        VboVec::const_iterator itor = mVbos[vboFlag].begin();
-        VboVec::const_iterator end = mVbos[vboFlag].end();
-
-        // Find a suitable VBO that can hold the requested size. We prefer those free
-        // blocks that have a matching stride (the current offset is a multiple of
-        // bytesPerElement) in order to minimize the amount of memory padding.
+        // Find a suitable VBO that can hold the requested size.
         size_t bestVboIdx = std::numeric_limits<size_t>::max();
-        ptrdiff_t bestBlockIdx = -1;
-        bool foundMatchingStride = false;
-
-        while( itor != end && !foundMatchingStride )
-        {
-            BlockVec::const_iterator blockIt = itor->freeBlocks.begin();
-            BlockVec::const_iterator blockEn = itor->freeBlocks.end();
+        size_t bufferOffset = 0u;
 
-            while( blockIt != blockEn && !foundMatchingStride )
-            {
-                const Block &block = *blockIt;
-
-                // Round to next multiple of alignment
-                size_t newOffset = ( ( block.offset + alignment - 1 ) / alignment ) * alignment;
-                size_t padding = newOffset - block.offset;
-
-                if( sizeBytes + padding <= block.size )
-                {
-                    bestVboIdx = static_cast<size_t>( itor - mVbos[vboFlag].begin() );
-                    bestBlockIdx = blockIt - itor->freeBlocks.begin();
-
-                    if( newOffset == block.offset )
-                        foundMatchingStride = true;
-                }
-
-                ++blockIt;
-            }
+        VboVec::iterator itor = mVbos[vboFlag].begin();
+        VboVec::iterator endt = mVbos[vboFlag].end();
 
+        while( itor != endt && bestVboIdx == std::numeric_limits<size_t>::max() )
+        {
+            if( itor->allocator.allocate( sizeBytes, alignment, bufferOffset ) )
+                bestVboIdx = static_cast<size_t>( itor - mVbos[vboFlag].begin() );
             ++itor;
         }
 
-        if( bestBlockIdx == -1 )
+        if( bestVboIdx == std::numeric_limits<size_t>::max() )
         {
             bestVboIdx = mVbos[vboFlag].size();
-            bestBlockIdx = 0;
-            foundMatchingStride = true;
 
             Vbo newVbo;
 
@@ -550,7 +599,11 @@ namespace Ogre
             OCGE( glBindBuffer( GL_ARRAY_BUFFER, 0 ) );
 
             newVbo.sizeBytes = poolSize;
-            newVbo.freeBlocks.push_back( Block( 0, poolSize ) );
+            newVbo.allocator.reset( poolSize );
+            const bool allocated =
+                newVbo.allocator.allocate( sizeBytes, alignment, bufferOffset );
+            OGRE_ASSERT_LOW( allocated && "A new pool must fit the buffer it was created for" );
+            OGRE_UNUSED_VAR( allocated );
             newVbo.dynamicBuffer = 0;
 
             if( vboFlag != CPU_INACCESSIBLE )
@@ -562,29 +615,8 @@ namespace Ogre
             mVbos[vboFlag].push_back( newVbo );
         }
 
-        Vbo &bestVbo = mVbos[vboFlag][bestVboIdx];
-        Block &bestBlock = bestVbo.freeBlocks[static_cast<size_t>( bestBlockIdx )];
-
-        size_t newOffset = ( ( bestBlock.offset + alignment - 1 ) / alignment ) * alignment;
-        size_t padding = newOffset - bestBlock.offset;
-        // Shrink our records about available data.
-        bestBlock.size -= sizeBytes + padding;
-        bestBlock.offset = newOffset + sizeBytes;
-
-        if( !foundMatchingStride )
-        {
-            // This is a stride changer, record as such.
-            StrideChangerVec::iterator itStride =
-                std::lower_bound( bestVbo.strideChangers.begin(), bestVbo.strideChangers.end(),
-                                  newOffset, StrideChanger() );
-            bestVbo.strideChangers.insert( itStride, StrideChanger( newOffset, padding ) );
-        }
-
-        if( bestBlock.size == 0 )
-            bestVbo.freeBlocks.erase( bestVbo.freeBlocks.begin() + bestBlockIdx );
-
         outVboIdx = bestVboIdx;
-        outBufferOffset = newOffset;
+        outBufferOffset = bufferOffset;
     }
     //-----------------------------------------------------------------------------------
     void GL3PlusVaoManager::deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes,
@@ -595,21 +627,7 @@ namespace Ogre
         if( bufferType >= BT_DYNAMIC_DEFAULT )
             sizeBytes *= mDynamicBufferMultiplier;
 
-        Vbo &vbo = mVbos[vboFlag][vboIdx];
-        StrideChangerVec::iterator itStride = std::lower_bound(
-            vbo.strideChangers.begin(), vbo.strideChangers.end(), bufferOffset, StrideChanger() );
-
-        if( itStride != vbo.strideChangers.end() && itStride->offsetAfterPadding == bufferOffset )
-        {
-            bufferOffset -= itStride->paddedBytes;
-            sizeBytes += itStride->paddedBytes;
-
-            vbo.strideChangers.erase( itStride );
-        }
-
-        // See if we're contiguous to a free block and make that block grow.
-        vbo.freeBlocks.push_back( Block( bufferOffset, sizeBytes ) );
-        mergeContiguousBlocks( vbo.freeBlocks.end() - 1, vbo.freeBlocks );
+        mVbos[vboFlag][vboIdx].allocator.deallocate( bufferOffset, sizeBytes );
     }
     //-----------------------------------------------------------------------------------
     void GL3PlusVaoManager::mergeContiguousBlocks( BlockVec::iterator blockToMerge, BlockVec &blocks )
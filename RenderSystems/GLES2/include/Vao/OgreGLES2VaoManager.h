@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include "OgreGLES2Prerequisites.h"
 #include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVboSubAllocator.h"
 
 namespace Ogre
 {
@@ -47,38 +48,8 @@ namespace Ogre
         };
 
     public:
-        struct Block
-        {
-            size_t offset;
-            size_t size;
-
-            Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
-        };
-        struct StrideChanger
-        {
-            size_t offsetAfterPadding;
-            size_t paddedBytes;
-
-            StrideChanger() : offsetAfterPadding( 0 ), paddedBytes( 0 ) {}
-            StrideChanger( size_t _offsetAfterPadding, size_t _paddedBytes ) :
-                offsetAfterPadding( _offsetAfterPadding ), paddedBytes( _paddedBytes ) {}
-
-            bool operator () ( const StrideChanger &left, size_t right ) const
-            {
-                return left.offsetAfterPadding < right;
-            }
-            bool operator () ( size_t left, const StrideChanger &right ) const
-            {
-                return left < right.offsetAfterPadding;
-            }
-            bool operator () ( const StrideChanger &left, const StrideChanger &right ) const
-            {
-                return left.offsetAfterPadding < right.offsetAfterPadding;
-            }
-        };
-
-        typedef vector<Block>::type BlockVec;
-        typedef vector<StrideChanger>::type StrideChangerVec;
+        typedef VboSubAllocator::Block    Block;
+        typedef VboSubAllocator::BlockVec BlockVec;
 
     protected:
         struct Vbo
@@ -87,8 +58,7 @@ namespace Ogre
             size_t sizeBytes;
             GLES2DynamicBuffer *dynamicBuffer; //Null for CPU_INACCESSIBLE BOs.
 
-            BlockVec            freeBlocks;
-            StrideChangerVec    strideChangers;
+            VboSubAllocator allocator;
         };
 
         struct Vao
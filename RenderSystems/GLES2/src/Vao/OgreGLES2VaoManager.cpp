@@ -221,49 +221,23 @@ namespace Ogre
         if( bufferType >= BT_DYNAMIC_DEFAULT )
             sizeBytes   *= mDynamicBufferMultiplier;
 
-        VboVec::const_iterator itor = mVbos[vboFlag].begin();
-        VboVec::const_iterator end  = mVbos[vboFlag].end();
-
-        //Find a suitable VBO that can hold the requested size. We prefer those free
-        //blocks that have a matching stride (the current offset is a multiple of
-        //bytesPerElement) in order to minimize the amount of memory padding.
+        //Find a suitable VBO that can hold the requested size.
         size_t bestVboIdx   = ~0;
-        size_t bestBlockIdx = ~0;
-        bool foundMatchingStride = false;
-
-        while( itor != end && !foundMatchingStride )
-        {
-            BlockVec::const_iterator blockIt = itor->freeBlocks.begin();
-            BlockVec::const_iterator blockEn = itor->freeBlocks.end();
-
-            while( blockIt != blockEn && !foundMatchingStride )
-            {
-                const Block &block = *blockIt;
-
-                //Round to next multiple of alignment
-                size_t newOffset = ( (block.offset + alignment - 1) / alignment ) * alignment;
-                size_t padding = newOffset - block.offset;
-
-                if( sizeBytes + padding <= block.size )
-                {
-                    bestVboIdx      = itor - mVbos[vboFlag].begin();
-                    bestBlockIdx    = blockIt - itor->freeBlocks.begin();
-
-                    if( newOffset == block.offset )
-                        foundMatchingStride = true;
-                }
+        size_t bufferOffset = 0;
 
-                ++blockIt;
-            }
+        VboVec::iterator itor = mVbos[vboFlag].begin();
+        VboVec::iterator end  = mVbos[vboFlag].end();
 
+        while( itor != end && bestVboIdx == (size_t)~0 )
+        {
+            if( itor->allocator.allocate( sizeBytes, alignment, bufferOffset ) )
+                bestVboIdx = itor - mVbos[vboFlag].begin();
             ++itor;
         }
 
-        if( bestBlockIdx == (size_t)~0 )
+        if( bestVboIdx == (size_t)~0 )
         {
             bestVboIdx      = mVbos[vboFlag].size();
-            bestBlockIdx    = 0;
-            foundMatchingStride = true;
 
             Vbo newVbo;
 
@@ -322,7 +296,8 @@ namespace Ogre
             OCGE( glBindBuffer( GL_ARRAY_BUFFER, 0 ) );
 
             newVbo.sizeBytes = poolSize;
-            newVbo.freeBlocks.push_back( Block( 0, poolSize ) );
+            newVbo.allocator.reset( poolSize );
+            newVbo.allocator.allocate( sizeBytes, alignment, bufferOffset );
             newVbo.dynamicBuffer = 0;
 
             if( vboFlag != CPU_INACCESSIBLE )
@@ -334,29 +309,8 @@ namespace Ogre
             mVbos[vboFlag].push_back( newVbo );
         }
 
-        Vbo &bestVbo        = mVbos[vboFlag][bestVboIdx];
-        Block &bestBlock    = bestVbo.freeBlocks[bestBlockIdx];
-
-        size_t newOffset = ( (bestBlock.offset + alignment - 1) / alignment ) * alignment;
-        size_t padding = newOffset - bestBlock.offset;
-        //Shrink our records about available data.
-        bestBlock.size   -= sizeBytes + padding;
-        bestBlock.offset = newOffset + sizeBytes;
-
-        if( !foundMatchingStride )
-        {
-            //This is a stride changer, record as such.
-            StrideChangerVec::iterator itStride = std::lower_bound( bestVbo.strideChangers.begin(),
-                                                                    bestVbo.strideChangers.end(),
-                                                                    newOffset, StrideChanger() );
-            bestVbo.strideChangers.insert( itStride, StrideChanger( newOffset, padding ) );
-        }
-
-        if( bestBlock.size == 0 )
-            bestVbo.freeBlocks.erase( bestVbo.freeBlocks.begin() + bestBlockIdx );
-
         outVboIdx       = bestVboIdx;
-        outBufferOffset = newOffset;
+        outBufferOffset = bufferOffset;
     }
     //-----------------------------------------------------------------------------------
     void GLES2VaoManager::deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes,
@@ -367,22 +321,7 @@ namespace Ogre
         if( bufferType >= BT_DYNAMIC_DEFAULT )
             sizeBytes *= mDynamicBufferMultiplier;
 
-        Vbo &vbo = mVbos[vboFlag][vboIdx];
-        StrideChangerVec::iterator itStride = std::lower_bound( vbo.strideChangers.begin(),
-                                                                vbo.strideChangers.end(),
-                                                                bufferOffset, StrideChanger() );
-
-        if( itStride != vbo.strideChangers.end() && itStride->offsetAfterPadding == bufferOffset )
-        {
-            bufferOffset    -= itStride->paddedBytes;
-            sizeBytes       += itStride->paddedBytes;
-
-            vbo.strideChangers.erase( itStride );
-        }
-
-        //See if we're contiguous to a free block and make that block grow.
-        vbo.freeBlocks.push_back( Block( bufferOffset, sizeBytes ) );
-        mergeContiguousBlocks( vbo.freeBlocks.end() - 1, vbo.freeBlocks );
+        mVbos[vboFlag][vboIdx].allocator.deallocate( bufferOffset, sizeBytes );
     }
     //-----------------------------------------------------------------------------------
     void GLES2VaoManager::mergeContiguousBlocks( BlockVec::iterator blockToMerge,
@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include "OgreMetalPrerequisites.h"
 #include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVboSubAllocator.h"
 
 #import <dispatch/dispatch.h>
 
@@ -52,41 +53,8 @@ namespace Ogre
         };
 
     public:
-        struct Block
-        {
-            size_t offset;
-            size_t size;
-
-            Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
-        };
-        struct StrideChanger
-        {
-            size_t offsetAfterPadding;
-            size_t paddedBytes;
-
-            StrideChanger() : offsetAfterPadding( 0 ), paddedBytes( 0 ) {}
-            StrideChanger( size_t _offsetAfterPadding, size_t _paddedBytes ) :
-                offsetAfterPadding( _offsetAfterPadding ),
-                paddedBytes( _paddedBytes )
-            {
-            }
-
-            bool operator()( const StrideChanger &left, size_t right ) const
-            {
-                return left.offsetAfterPadding < right;
-            }
-            bool operator()( size_t left, const StrideChanger &right ) const
-            {
-                return left < right.offsetAfterPadding;
-            }
-            bool operator()( const StrideChanger &left, const StrideChanger &right ) const
-            {
-                return left.offsetAfterPadding < right.offsetAfterPadding;
-            }
-        };
-
-        typedef vector<Block>::type         BlockVec;
-        typedef vector<StrideChanger>::type StrideChangerVec;
+        typedef VboSubAllocator::Block    Block;
+        typedef VboSubAllocator::BlockVec BlockVec;
 
     protected:
         struct Vbo
@@ -95,8 +63,7 @@ namespace Ogre
             size_t              sizeBytes;
             MetalDynamicBuffer *dynamicBuffer;  // Null for CPU_INACCESSIBLE BOs.
 
-            BlockVec         freeBlocks;
-            StrideChangerVec strideChangers;
+            VboSubAllocator allocator;
         };
 
         struct Vao
@@ -262,12 +229,15 @@ namespace Ogre
         static VboFlag bufferTypeToVboFlag( BufferType bufferType );
 
         inline void getMemoryStats( const Block &block, size_t vboIdx, size_t poolIdx,
-                                    size_t poolCapacity, LwString &text, MemoryStatsEntryVec &outStats,
-                                    Log *log ) const;
+                                    const VboSubAllocator &pool, size_t poolLargestFreeBlock,
+                                    LwString &text, MemoryStatsEntryVec &outStats, Log *log ) const;
 
         void switchVboPoolIndexImpl( unsigned internalVboBufferType, size_t oldPoolIdx,
                                      size_t newPoolIdx, BufferPacked *buffer ) override;
 
+        void defragmentPoolsImpl( size_t maxBytesToMove, const BufferPackedVec &candidates,
+                                  DefragmentationReport &inOutReport ) override;
+
     public:
         MetalVaoManager( MetalDevice *device, const NameValuePairList *params );
         ~MetalVaoManager() override;
@@ -2010,11 +2010,19 @@ namespace Ogre
 
                 const typename TDescriptorSetTexture::BufferSlot &bufferSlot = itor->getBuffer();
 
-                assert( dynamic_cast<TBufferPacked *>( bufferSlot.buffer ) );
-                TBufferPacked *metalBuf = static_cast<TBufferPacked *>( bufferSlot.buffer );
-
                 MetalBufferRegion &bufferRegion = metalSet->buffers.back();
-                metalBuf->bindBufferForDescriptor( buffers, offsets, bufferSlot.offset );
+                if( bufferSlot.buffer )
+                {
+                    assert( dynamic_cast<TBufferPacked *>( bufferSlot.buffer ) );
+                    TBufferPacked *metalBuf = static_cast<TBufferPacked *>( bufferSlot.buffer );
+                    metalBuf->bindBufferForDescriptor( buffers, offsets, bufferSlot.offset );
+                }
+                else
+                {
+                    // Empty slot
+                    *buffers = nil;
+                    *offsets = 0;
+                }
                 ++bufferRegion.range.length;
 
                 ++buffers;
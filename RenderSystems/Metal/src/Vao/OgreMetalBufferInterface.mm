@@ -49,6 +49,18 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     MetalBufferInterface::~MetalBufferInterface() {}
     //-----------------------------------------------------------------------------------
+    void MetalBufferInterface::_setVboName( size_t vboPoolIdx, id<MTLBuffer> vboName,
+                                            size_t internalBufferStartBytes )
+    {
+        OGRE_ASSERT_LOW( !mDynamicBuffer && "Dynamic buffers can't be moved" );
+
+        mVboPoolIdx = vboPoolIdx;
+        mVboName = vboName;
+
+        mBuffer->mInternalBufferStart = internalBufferStartBytes / mBuffer->mBytesPerElement;
+        mBuffer->mFinalBufferStart = internalBufferStartBytes / mBuffer->mBytesPerElement;
+    }
+    //-----------------------------------------------------------------------------------
     void MetalBufferInterface::_firstUpload( const void *data, size_t elementStart, size_t elementCount )
     {
         // In OpenGL; immutable buffers are a charade. They're mostly there to satisfy D3D11's needs.
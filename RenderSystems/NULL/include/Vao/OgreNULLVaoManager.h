@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreNULLPrerequisites.h"
 
 #include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVboSubAllocator.h"
 
 namespace Ogre
 {
@@ -48,49 +49,15 @@ namespace Ogre
         };
 
     public:
-        struct Block
-        {
-            size_t offset;
-            size_t size;
-
-            Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
-        };
-        struct StrideChanger
-        {
-            size_t offsetAfterPadding;
-            size_t paddedBytes;
-
-            StrideChanger() : offsetAfterPadding( 0 ), paddedBytes( 0 ) {}
-            StrideChanger( size_t _offsetAfterPadding, size_t _paddedBytes ) :
-                offsetAfterPadding( _offsetAfterPadding ),
-                paddedBytes( _paddedBytes )
-            {
-            }
-
-            bool operator()( const StrideChanger &left, size_t right ) const
-            {
-                return left.offsetAfterPadding < right;
-            }
-            bool operator()( size_t left, const StrideChanger &right ) const
-            {
-                return left < right.offsetAfterPadding;
-            }
-            bool operator()( const StrideChanger &left, const StrideChanger &right ) const
-            {
-                return left.offsetAfterPadding < right.offsetAfterPadding;
-            }
-        };
-
-        typedef vector<Block>::type         BlockVec;
-        typedef vector<StrideChanger>::type StrideChangerVec;
+        typedef VboSubAllocator::Block    Block;
+        typedef VboSubAllocator::BlockVec BlockVec;
 
     protected:
         struct Vbo
         {
             size_t sizeBytes;
 
-            BlockVec         freeBlocks;
-            StrideChangerVec strideChangers;
+            VboSubAllocator allocator;
         };
 
         struct Vao
@@ -186,7 +153,7 @@ namespace Ogre
                                      size_t newPoolIdx, BufferPacked *buffer ) override;
 
     public:
-        NULLVaoManager();
+        NULLVaoManager( const NameValuePairList *params );
         ~NULLVaoManager() override;
 
         void getMemoryStats( MemoryStatsEntryVec &outStats, size_t &outCapacityBytes,
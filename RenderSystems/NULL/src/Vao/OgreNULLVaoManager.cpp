@@ -45,7 +45,9 @@ THE SOFTWARE.
 
 namespace Ogre
 {
-    NULLVaoManager::NULLVaoManager() : VaoManager( 0 ), mDrawId( 0 )
+    NULLVaoManager::NULLVaoManager( const NameValuePairList *params ) :
+        VaoManager( params ),
+        mDrawId( 0 )
     {
         mConstBufferAlignment = 256;
         mTexBufferAlignment = 256;
@@ -56,7 +58,10 @@ namespace Ogre
         mSupportsPersistentMapping = true;
         mSupportsIndirectBuffers = false;
 
-        mDynamicBufferMultiplier = 1;
+        // There is no GPU to wait for, so don't multi-buffer unless explicitly asked
+        // (e.g. to exercise the code paths that depend on it)
+        if( !params || params->find( "VaoManager::mDynamicBufferMultiplier" ) == params->end() )
+            mDynamicBufferMultiplier = 1;
 
         VertexElement2Vec vertexElements;
         vertexElements.push_back( VertexElement2( VET_UINT1, VES_COUNT ) );
@@ -173,8 +173,13 @@ namespace Ogre
     {
         BufferInterface::_notifyBuffer( buffer );
 
-        mNullDataPtr = reinterpret_cast<uint8 *>(
-            OGRE_MALLOC_SIMD( mBuffer->getTotalSizeBytes(), MEMCATEGORY_RENDERSYS ) );
+        // Dynamic buffers hold one copy per buffered frame. See advanceFrame
+        size_t sizeBytes = mBuffer->_getInternalTotalSizeBytes();
+        if( mBuffer->mBufferType >= BT_DYNAMIC_DEFAULT )
+            sizeBytes *= mBuffer->mVaoManager->getDynamicBufferMultiplier();
+
+        mNullDataPtr =
+            reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_RENDERSYS ) );
     }
     //-----------------------------------------------------------------------------------
     void NULLBufferInterface::copyTo( BufferInterface *dstBuffer, size_t dstOffsetBytes,
@@ -69,6 +69,9 @@ namespace Ogre
 
         void _setVboPoolIndex( size_t newVboPool ) { mVboPoolIdx = newVboPool; }
 
+        /// Points this buffer to a new location. Used when moving the buffer to another pool.
+        void _setVboName( size_t vboPoolIdx, VkBuffer vboName, size_t internalBufferStartBytes );
+
         /// Only use this function for the first upload
         void _firstUpload( void *data, size_t elementStart, size_t elementCount );
 
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreVulkanPrerequisites.h"
 
 #include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVboSubAllocator.h"
 #include "ogrestd/set.h"
 
 #include "vulkan/vulkan_core.h"
@@ -73,39 +74,6 @@ namespace Ogre
         };
 
     public:
-        struct Block
-        {
-            size_t offset;
-            size_t size;
-
-            Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
-        };
-        struct StrideChanger
-        {
-            size_t offsetAfterPadding;
-            size_t paddedBytes;
-
-            StrideChanger() : offsetAfterPadding( 0 ), paddedBytes( 0 ) {}
-            StrideChanger( size_t _offsetAfterPadding, size_t _paddedBytes ) :
-                offsetAfterPadding( _offsetAfterPadding ),
-                paddedBytes( _paddedBytes )
-            {
-            }
-
-            bool operator()( const StrideChanger &left, size_t right ) const
-            {
-                return left.offsetAfterPadding < right;
-            }
-            bool operator()( size_t left, const StrideChanger &right ) const
-            {
-                return left < right.offsetAfterPadding;
-            }
-            bool operator()( const StrideChanger &left, const StrideChanger &right ) const
-            {
-                return left.offsetAfterPadding < right.offsetAfterPadding;
-            }
-        };
-
         struct DirtyBlock
         {
             uint32 frameIdx;
@@ -125,8 +93,8 @@ namespace Ogre
             }
         };
 
-        typedef vector<Block>::type BlockVec;
-        typedef vector<StrideChanger>::type StrideChangerVec;
+        typedef VboSubAllocator::Block    Block;
+        typedef VboSubAllocator::BlockVec BlockVec;
         typedef FastArray<DirtyBlock> DirtyBlockArray;
 
     protected:
@@ -141,14 +109,10 @@ namespace Ogre
             uint32              emptyFrame;
             VulkanDynamicBuffer *dynamicBuffer; //Null for CPU_INACCESSIBLE BOs.
 
-            BlockVec            freeBlocks;
-            StrideChangerVec    strideChangers;
+            VboSubAllocator     allocator;
             // clang-format on
 
-            bool isEmpty() const
-            {
-                return this->freeBlocks.size() == 1u && this->freeBlocks.back().size == this->sizeBytes;
-            }
+            bool isEmpty() const { return this->allocator.isEmpty(); }
 
             bool isAllocated() const { return this->vboName != VK_NULL_HANDLE; }
         };
@@ -401,14 +365,17 @@ namespace Ogre
         bool isVboFlagCoherent( VboFlag vboFlag ) const;
 
         inline void getMemoryStats( const Block &block, size_t vboIdx, size_t poolIdx,
-                                    size_t poolCapacity, LwString &text, MemoryStatsEntryVec &outStats,
-                                    Log *log ) const;
+                                    const VboSubAllocator &pool, size_t poolLargestFreeBlock,
+                                    LwString &text, MemoryStatsEntryVec &outStats, Log *log ) const;
 
         void deallocateEmptyVbos( const bool bDeviceStall );
 
         void switchVboPoolIndexImpl( unsigned internalVboBufferType, size_t oldPoolIdx,
                                      size_t newPoolIdx, BufferPacked *buffer ) override;
 
+        void defragmentPoolsImpl( size_t maxBytesToMove, const BufferPackedVec &candidates,
+                                  DefragmentationReport &inOutReport ) override;
+
         /**
         @brief flushAllGpuDelayedBlocks
             In Vulkan almost all GPU -> GPU are potentially in parallel. We need vkCmdPipelineBarrier
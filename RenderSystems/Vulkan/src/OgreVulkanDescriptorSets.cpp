@@ -358,12 +358,22 @@ namespace Ogre
             if( itor->isBuffer() )
             {
                 const DescriptorSetUav::BufferSlot &bufferSlot = itor->getBuffer();
-                OGRE_ASSERT_HIGH( dynamic_cast<VulkanUavBufferPacked *>( bufferSlot.buffer ) );
-                VulkanUavBufferPacked *vulkanBuffer =
-                    static_cast<VulkanUavBufferPacked *>( bufferSlot.buffer );
+                if( bufferSlot.buffer )
+                {
+                    OGRE_ASSERT_HIGH( dynamic_cast<VulkanUavBufferPacked *>( bufferSlot.buffer ) );
+                    VulkanUavBufferPacked *vulkanBuffer =
+                        static_cast<VulkanUavBufferPacked *>( bufferSlot.buffer );
 
-                vulkanBuffer->setupBufferInfo( mBuffers[numBuffers], bufferSlot.offset,
-                                               bufferSlot.sizeBytes );
+                    vulkanBuffer->setupBufferInfo( mBuffers[numBuffers], bufferSlot.offset,
+                                                   bufferSlot.sizeBytes );
+                }
+                else
+                {
+                    // Empty slot. Only valid if the shader doesn't use it
+                    mBuffers[numBuffers].buffer = VK_NULL_HANDLE;
+                    mBuffers[numBuffers].offset = 0u;
+                    mBuffers[numBuffers].range = VK_WHOLE_SIZE;
+                }
                 ++numBuffers;
             }
             else
@@ -50,6 +50,18 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     VulkanBufferInterface::~VulkanBufferInterface() {}
     //-----------------------------------------------------------------------------------
+    void VulkanBufferInterface::_setVboName( size_t vboPoolIdx, VkBuffer vboName,
+                                             size_t internalBufferStartBytes )
+    {
+        OGRE_ASSERT_LOW( !mDynamicBuffer && "Dynamic buffers can't be moved" );
+
+        mVboPoolIdx = vboPoolIdx;
+        mVboName = vboName;
+
+        mBuffer->mInternalBufferStart = internalBufferStartBytes / mBuffer->mBytesPerElement;
+        mBuffer->mFinalBufferStart = internalBufferStartBytes / mBuffer->mBytesPerElement;
+    }
+    //-----------------------------------------------------------------------------------
     void VulkanBufferInterface::_firstUpload( void *data, size_t elementStart, size_t elementCount )
     {
         // In Vulkan; immutable buffers are a charade. They're mostly there to satisfy D3D11's needs.
@@ -295,14 +295,16 @@ namespace Ogre
     }
     //-----------------------------------------------------------------------------------
     void VulkanVaoManager::getMemoryStats( const Block &block, size_t vboIdx, size_t poolIdx,
-                                           size_t poolCapacity, LwString &text,
-                                           MemoryStatsEntryVec &outStats, Log *log ) const
+                                           const VboSubAllocator &pool, size_t poolLargestFreeBlock,
+                                           LwString &text, MemoryStatsEntryVec &outStats,
+                                           Log *log ) const
     {
         if( log )
         {
             text.clear();
             text.a( c_vboTypes[vboIdx], ";", (uint64)block.offset, ";", (uint64)block.size, ";" );
-            text.a( (uint64)poolIdx, ";", (uint64)poolCapacity );
+            text.a( (uint64)poolIdx, ";", (uint64)pool.getCapacity(), ";" );
+            text.a( (uint64)pool.getFreeBytes(), ";", (uint64)poolLargestFreeBlock );
             log->logMessage( text.c_str(), LML_CRITICAL );
         }
 
@@ -312,8 +314,9 @@ namespace Ogre
 
         const bool bPoolHasTextures = vboIdx == vboTextureFlag;
 
-        MemoryStatsEntry entry( (uint32)vboIdx, (uint32)poolIdx, block.offset, block.size, poolCapacity,
-                                bPoolHasTextures );
+        MemoryStatsEntry entry( (uint32)vboIdx, (uint32)poolIdx, block.offset, block.size,
+                                pool.getCapacity(), bPoolHasTextures, pool.getFreeBytes(),
+                                poolLargestFreeBlock );
         outStats.push_back( entry );
     }
     //-----------------------------------------------------------------------------------
@@ -331,7 +334,13 @@ namespace Ogre
         LwString text( LwString::FromEmptyPointer( &tmpBuffer[0], tmpBuffer.size() ) );
 
         if( log )
-            log->logMessage( "Pool Type;Offset;Size Bytes;Pool Idx;Pool Capacity", LML_CRITICAL );
+        {
+            log->logMessage(
+                "Pool Type;Offset;Size Bytes;Pool Idx;Pool Capacity;Pool Free Bytes;Largest Free Block",
+                LML_CRITICAL );
+        }
+
+        BlockVec usedBlocks;
 
         for( unsigned vboIdx = 0; vboIdx < MAX_VBO_FLAG; ++vboIdx )
         {
@@ -344,56 +353,21 @@ namespace Ogre
                 const size_t poolIdx = static_cast<size_t>( itor - mVbos[vboIdx].begin() );
                 capacityBytes += vbo.sizeBytes;
 
-                Block usedBlock( 0, 0 );
+                const size_t largestFreeBlock = vbo.allocator.getLargestFreeBlock();
+                freeBytes += vbo.allocator.getFreeBytes();
 
-                BlockVec freeBlocks = vbo.freeBlocks;
-                while( !freeBlocks.empty() )
-                {
-                    // Find the free block that comes next
-                    BlockVec::iterator nextBlock;
-                    {
-                        BlockVec::iterator itBlock = freeBlocks.begin();
-                        BlockVec::iterator enBlock = freeBlocks.end();
+                vbo.allocator.getUsedBlocks( usedBlocks );
+                if( usedBlocks.empty() )
+                    usedBlocks.push_back( Block( 0u, 0u ) );  // Still report empty pools
 
-                        nextBlock = itBlock;
+                BlockVec::const_iterator itBlock = usedBlocks.begin();
+                BlockVec::const_iterator enBlock = usedBlocks.end();
 
-                        while( itBlock != enBlock )
-                        {
-                            if( itBlock->offset < nextBlock->offset )
-                                nextBlock = itBlock;
-                            ++itBlock;
-                        }
-                    }
-
-                    freeBytes += nextBlock->size;
-                    usedBlock.size = nextBlock->offset - usedBlock.offset;
-
-                    OGRE_ASSERT_LOW( usedBlock.size <= vbo.sizeBytes );
-                    OGRE_ASSERT_LOW( usedBlock.offset + usedBlock.size <= vbo.sizeBytes );
-
-                    // usedBlock.size could be 0 if:
-                    //  1. All of memory is free
-                    //  2. There's two contiguous free blocks, which should not happen
-                    //     due to mergeContiguousBlocks
-                    if( usedBlock.size > 0u )
-                    {
-                        getMemoryStats( usedBlock, vboIdx, poolIdx, vbo.sizeBytes, text, statsVec, log );
-                    }
-
-                    usedBlock.offset += usedBlock.size;
-                    usedBlock.size = 0;
-                    efficientVectorRemove( freeBlocks, nextBlock );
-                }
-
-                if( usedBlock.size > 0u || ( usedBlock.offset == 0 && usedBlock.size == 0 ) )
+                while( itBlock != enBlock )
                 {
-                    if( vbo.freeBlocks.empty() )
-                    {
-                        OGRE_ASSERT_LOW( usedBlock.offset == 0 && usedBlock.size == 0 );
-                        usedBlock.offset = 0u;
-                        usedBlock.size = vbo.sizeBytes;
-                    }
-                    getMemoryStats( usedBlock, vboIdx, poolIdx, vbo.sizeBytes, text, statsVec, log );
+                    getMemoryStats( *itBlock, vboIdx, poolIdx, vbo.allocator, largestFreeBlock, text,
+                                    statsVec, log );
+                    ++itBlock;
                 }
 
                 ++itor;
@@ -440,7 +414,7 @@ namespace Ogre
                 delete vbo.dynamicBuffer;
                 vbo.dynamicBuffer = 0;
 
-                vbo.freeBlocks.clear();
+                vbo.allocator.reset( 0u );
                 vbo.emptyFrame = mFrameCount;
 
                 mUnallocatedVbos[itor->vboFlag].push_back( itor->vboIdx );
@@ -474,6 +448,128 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void VulkanVaoManager::defragmentPoolsImpl( size_t maxBytesToMove,
+                                                const BufferPackedVec &candidates,
+                                                DefragmentationReport &inOutReport )
+    {
+        // BT_IMMUTABLE & BT_DEFAULT buffers live in CPU_INACCESSIBLE pools
+        VboVec &vbos = mVbos[CPU_INACCESSIBLE];
+
+        // Evacuate the pool with the least used bytes. It's the cheapest to empty.
+        size_t srcPoolIdx = std::numeric_limits<size_t>::max();
+        {
+            size_t minUsedBytes = std::numeric_limits<size_t>::max();
+
+            VboVec::const_iterator itor = vbos.begin();
+            VboVec::const_iterator endt = vbos.end();
+
+            while( itor != endt )
+            {
+                const size_t usedBytes = itor->allocator.getUsedBytes();
+                if( usedBytes && usedBytes < minUsedBytes )
+                {
+                    minUsedBytes = usedBytes;
+                    srcPoolIdx = static_cast<size_t>( itor - vbos.begin() );
+                }
+                ++itor;
+            }
+
+            if( srcPoolIdx == std::numeric_limits<size_t>::max() )
+                return;
+
+            // Don't bother if the rest of the pools (from the same memory type) can't take it all
+            size_t freeBytesElsewhere = 0u;
+            for( size_t i = 0u; i < vbos.size(); ++i )
+            {
+                if( i != srcPoolIdx && vbos[i].vkMemoryTypeIdx == vbos[srcPoolIdx].vkMemoryTypeIdx )
+                    freeBytesElsewhere += vbos[i].allocator.getFreeBytes();
+            }
+
+            if( freeBytesElsewhere < minUsedBytes )
+                return;
+        }
+
+        const Vbo &srcVbo = vbos[srcPoolIdx];
+        const size_t usedBytesBefore = srcVbo.allocator.getUsedBytes();
+        size_t bytesMovedFromPool = 0u;
+        BufferPackedVec relocatedBuffers;
+
+        BufferPackedVec::const_iterator itor = candidates.begin();
+        BufferPackedVec::const_iterator endt = candidates.end();
+
+        while( itor != endt && inOutReport.bytesMoved < maxBytesToMove )
+        {
+            BufferPacked *buffer = *itor;
+            VulkanBufferInterface *bufferInterface =
+                static_cast<VulkanBufferInterface *>( buffer->getBufferInterface() );
+            const size_t sizeBytes = buffer->_getInternalTotalSizeBytes();
+
+            if( bufferInterface->getVboPoolIndex() == srcPoolIdx &&
+                inOutReport.bytesMoved + sizeBytes <= maxBytesToMove )
+            {
+                uint32 alignment = buffer->getBytesPerElement();
+#ifdef OGRE_VK_WORKAROUND_PVR_ALIGNMENT
+                if( Workarounds::mPowerVRAlignment )
+                    alignment = uint32( Math::lcm( alignment, Workarounds::mPowerVRAlignment ) );
+#endif
+
+                size_t dstPoolIdx = std::numeric_limits<size_t>::max();
+                size_t dstOffset = 0u;
+
+                for( size_t i = 0u; i < vbos.size() && dstPoolIdx == std::numeric_limits<size_t>::max();
+                     ++i )
+                {
+                    if( i != srcPoolIdx && vbos[i].vkMemoryTypeIdx == srcVbo.vkMemoryTypeIdx &&
+                        vbos[i].allocator.allocate( sizeBytes, alignment, dstOffset ) )
+                    {
+                        dstPoolIdx = i;
+                    }
+                }
+
+                if( dstPoolIdx != std::numeric_limits<size_t>::max() )
+                {
+                    const size_t srcOffset =
+                        buffer->_getInternalBufferStart() * buffer->getBytesPerElement();
+
+                    // GPU -> GPU copy within the same BufferPacked
+                    mDevice->mGraphicsQueue.getCopyEncoder( buffer, 0, true,
+                                                            CopyEncTransitionMode::Auto );
+                    mDevice->mGraphicsQueue.getCopyEncoder( buffer, 0, false,
+                                                            CopyEncTransitionMode::Auto );
+
+                    VkBufferCopy region;
+                    region.srcOffset = srcOffset;
+                    region.dstOffset = dstOffset;
+                    region.size = sizeBytes;
+                    vkCmdCopyBuffer( mDevice->mGraphicsQueue.getCurrentCmdBuffer(), srcVbo.vkBuffer,
+                                     vbos[dstPoolIdx].vkBuffer, 1u, &region );
+
+                    bufferInterface->_setVboName( dstPoolIdx, vbos[dstPoolIdx].vkBuffer, dstOffset );
+
+                    // The copy (and previous frames) may still be reading from it. Must be delayed.
+                    deallocateVbo( srcPoolIdx, srcOffset, sizeBytes, CPU_INACCESSIBLE, false );
+
+                    bytesMovedFromPool += sizeBytes;
+                    inOutReport.bytesMoved += sizeBytes;
+                    ++inOutReport.numBuffersMoved;
+                    relocatedBuffers.push_back( buffer );
+                }
+            }
+
+            ++itor;
+        }
+
+        updateVaosOfRelocatedBuffers( relocatedBuffers );
+
+        // Once the delayed deallocations go through, the pool ends up in mEmptyVboPools
+        // and deallocateEmptyVbos takes care of releasing it.
+        if( usedBytesBefore == bytesMovedFromPool )
+        {
+            ++inOutReport.numPoolsReleased;
+            inOutReport.bytesReleased += srcVbo.sizeBytes;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     inline uint64 bytesToMegabytes( size_t sizeBytes ) { return uint64_t( sizeBytes >> 20u ); }
     //-----------------------------------------------------------------------------------
     bool VulkanVaoManager::flushAllGpuDelayedBlocks( const bool bIssueBarrier )
@@ -578,7 +674,7 @@ namespace Ogre
             while( itor != endt )
             {
                 Vbo &vbo = *itor;
-                if( vbo.freeBlocks.size() == 1u && vbo.sizeBytes == vbo.freeBlocks.back().size )
+                if( vbo.isEmpty() )
                 {
                     VaoVec::iterator itVao = mVaos.begin();
                     VaoVec::iterator enVao = mVaos.end();
@@ -948,59 +1044,30 @@ namespace Ogre
 
         VboVec &vboVec = mVbos[vboFlag];
 
-        VboVec::const_iterator itor = vboVec.begin();
-        VboVec::const_iterator endt = vboVec.end();
+        // Find a suitable VBO that can hold the requested size.
+        size_t bestVboIdx = std::numeric_limits<size_t>::max();
+        size_t bufferOffset = 0u;
+        bool bWasEmpty = false;
 
-        // clang-format off
-        // Find a suitable VBO that can hold the requested size. We prefer those free
-        // blocks that have a matching stride (the current offset is a multiple of
-        // bytesPerElement) in order to minimize the amount of memory padding.
-        size_t bestVboIdx   = std::numeric_limits<size_t>::max();
-        ptrdiff_t bestBlockIdx = -1;
-        bool foundMatchingStride = false;
-        // clang-format on
+        VboVec::iterator itor = vboVec.begin();
+        VboVec::iterator endt = vboVec.end();
 
-        while( itor != endt && !foundMatchingStride )
+        while( itor != endt && bestVboIdx == std::numeric_limits<size_t>::max() )
         {
             // First check the allocation can be done inside this Vbo
             if( ( 1u << itor->vkMemoryTypeIdx ) & textureMemTypeBits )
             {
-                BlockVec::const_iterator blockIt = itor->freeBlocks.begin();
-                BlockVec::const_iterator blockEn = itor->freeBlocks.end();
-
-                while( blockIt != blockEn && !foundMatchingStride )
-                {
-                    const Block &block = *blockIt;
-
-                    // Round to next multiple of alignment
-                    size_t newOffset = ( ( block.offset + alignment - 1 ) / alignment ) * alignment;
-                    size_t padding = newOffset - block.offset;
-
-                    if( sizeBytes + padding <= block.size )
-                    {
-                        // clang-format off
-                        bestVboIdx      = static_cast<size_t>( itor - vboVec.begin());
-                        bestBlockIdx    = blockIt - itor->freeBlocks.begin();
-                        // clang-format on
-
-                        if( newOffset == block.offset )
-                            foundMatchingStride = true;
-                    }
-
-                    ++blockIt;
-                }
+                bWasEmpty = itor->isEmpty();
+                if( itor->allocator.allocate( sizeBytes, alignment, bufferOffset ) )
+                    bestVboIdx = static_cast<size_t>( itor - vboVec.begin() );
             }
 
             ++itor;
         }
 
-        if( bestBlockIdx == -1 )
+        if( bestVboIdx == std::numeric_limits<size_t>::max() )
         {
-            // clang-format off
-            bestVboIdx      = vboVec.size();
-            bestBlockIdx    = 0;
-            foundMatchingStride = true;
-            // clang-format on
+            bestVboIdx = vboVec.size();
 
             Vbo newVbo;
 
@@ -1136,7 +1203,11 @@ namespace Ogre
             }
 
             newVbo.sizeBytes = usablePoolSize;
-            newVbo.freeBlocks.push_back( Block( 0, usablePoolSize ) );
+            newVbo.allocator.reset( usablePoolSize );
+            const bool allocated =
+                newVbo.allocator.allocate( sizeBytes, alignment, bufferOffset );
+            OGRE_ASSERT_LOW( allocated && "A new pool must fit the buffer it was created for" );
+            OGRE_UNUSED_VAR( allocated );
             newVbo.dynamicBuffer = 0;
 
             if( vboFlag != CPU_INACCESSIBLE )
@@ -1158,51 +1229,22 @@ namespace Ogre
                 vboVec.push_back( newVbo );
             }
         }
-        else
+        else if( bWasEmpty )
         {
-            Vbo &bestVbo = vboVec[bestVboIdx];
-            if( bestVbo.isEmpty() )
-            {
-                OGRE_ASSERT_HIGH( bestVbo.isAllocated() );
-
-                // The block will no longer be empty, hence no unschedule from destruction
-                VboIndex vboIndex;
-                vboIndex.vboFlag = vboFlag;
-                vboIndex.vboIdx = static_cast<uint32>( bestVboIdx );
-                OGRE_ASSERT_HIGH( mEmptyVboPools.find( vboIndex ) != mEmptyVboPools.end() &&
-                                  "If the Vbo pool was empty, it should be in mEmptyVboPools" );
-                mEmptyVboPools.erase( vboIndex );
-            }
-        }
-
-        // clang-format off
-        Vbo &bestVbo        = vboVec[bestVboIdx];
-        Block &bestBlock    = bestVbo.freeBlocks[static_cast<size_t>(bestBlockIdx)];
-        // clang-format on
+            OGRE_ASSERT_HIGH( vboVec[bestVboIdx].isAllocated() );
 
-        size_t newOffset = ( ( bestBlock.offset + alignment - 1 ) / alignment ) * alignment;
-        size_t padding = newOffset - bestBlock.offset;
-        // clang-format off
-        // Shrink our records about available data.
-        bestBlock.size   -= sizeBytes + padding;
-        bestBlock.offset = newOffset + sizeBytes;
-        // clang-format on
-
-        if( !foundMatchingStride )
-        {
-            // This is a stride changer, record as such.
-            StrideChangerVec::iterator itStride = std::lower_bound( bestVbo.strideChangers.begin(),
-                                                                    bestVbo.strideChangers.end(),  //
-                                                                    newOffset, StrideChanger() );
-            bestVbo.strideChangers.insert( itStride, StrideChanger( newOffset, padding ) );
+            // The block will no longer be empty, hence no unschedule from destruction
+            VboIndex vboIndex;
+            vboIndex.vboFlag = vboFlag;
+            vboIndex.vboIdx = static_cast<uint32>( bestVboIdx );
+            OGRE_ASSERT_HIGH( mEmptyVboPools.find( vboIndex ) != mEmptyVboPools.end() &&
+                              "If the Vbo pool was empty, it should be in mEmptyVboPools" );
+            mEmptyVboPools.erase( vboIndex );
         }
 
-        if( bestBlock.size == 0u )
-            bestVbo.freeBlocks.erase( bestVbo.freeBlocks.begin() + bestBlockIdx );
-
         // clang-format off
         outVboIdx       = bestVboIdx;
-        outBufferOffset = newOffset;
+        outBufferOffset = bufferOffset;
         // clang-format on
     }
     //-----------------------------------------------------------------------------------
@@ -1242,29 +1284,12 @@ namespace Ogre
         }
 
         Vbo &vbo = mVbos[vboFlag][vboIdx];
-        StrideChangerVec::iterator itStride =
-            std::lower_bound( vbo.strideChangers.begin(), vbo.strideChangers.end(),  //
-                              bufferOffset, StrideChanger() );
-
-        if( itStride != vbo.strideChangers.end() && itStride->offsetAfterPadding == bufferOffset )
-        {
-            // clang-format off
-            bufferOffset    -= itStride->paddedBytes;
-            sizeBytes       += itStride->paddedBytes;
-            // clang-format on
-
-            vbo.strideChangers.erase( itStride );
-        }
-
-        // See if we're contiguous to a free block and make that block grow.
-        vbo.freeBlocks.push_back( Block( bufferOffset, sizeBytes ) );
-        mergeContiguousBlocks( vbo.freeBlocks.end() - 1u, vbo.freeBlocks );
+        vbo.allocator.deallocate( bufferOffset, sizeBytes );
 
         if( vbo.isEmpty() )
         {
             // This pool is empty. Schedule for removal
             // We may reuse their memory if more memory is requested before they're actually removed.
-            OGRE_ASSERT_LOW( vbo.strideChangers.empty() );
             vbo.emptyFrame = mFrameCount;
             VboIndex vboIndex;
             vboIndex.vboFlag = vboFlag;
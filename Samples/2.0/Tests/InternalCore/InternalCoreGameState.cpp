@@ -4,6 +4,18 @@
 #include "GraphicsSystem.h"
 
 #include "Math/Array/OgreArrayVector3.h"
+#include "OgreBitwise.h"
+#include "OgreCamera.h"
+#include "OgreForwardClustered.h"
+#include "OgreLogManager.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreSceneManager.h"
+#include "OgreStringConverter.h"
+#include "OgreTextureBox.h"
+#include "OgreTimer.h"
+#include "OgreViewport.h"
+
+#include <stdlib.h>
 
 using namespace Demo;
 
@@ -109,5 +121,253 @@ void InternalCoreGameState::createScene01()
         }
     }
 
+    testPixelFormatConversion();
+    testForwardClusteredBinning();
+
     mGraphicsSystem->setQuit();
 }
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testPixelFormatConversion()
+{
+    using namespace Ogre;
+
+    // Validates the specialised bulkPixelConversion paths against per-pixel
+    // unpackColour / packColour, then measures their throughput.
+    struct FormatPair
+    {
+        PixelFormatGpu srcFormat;
+        PixelFormatGpu dstFormat;
+    };
+
+    // clang-format off
+    const FormatPair formatPairs[] = {
+        { PFG_RGBA8_UNORM,          PFG_BGRA8_UNORM },
+        { PFG_BGRA8_UNORM,          PFG_RGBA8_UNORM },
+        { PFG_BGRX8_UNORM,          PFG_BGRA8_UNORM },
+        { PFG_RGBA8_UNORM,          PFG_RGBA8_UNORM_SRGB },
+        { PFG_RGBA8_UNORM_SRGB,     PFG_RGBA8_UNORM },
+        { PFG_RGBA8_UNORM,          PFG_RGBA32_FLOAT },
+        { PFG_RGBA8_UNORM_SRGB,     PFG_RGBA32_FLOAT },
+        { PFG_BGRA8_UNORM,          PFG_RGBA32_FLOAT },
+        { PFG_RG8_UNORM,            PFG_RGBA32_FLOAT },
+        { PFG_R8_UNORM,             PFG_RGBA32_FLOAT },
+        { PFG_RGBA32_FLOAT,         PFG_RGBA8_UNORM },
+        { PFG_RGBA32_FLOAT,         PFG_RGBA8_UNORM_SRGB },
+        { PFG_RGBA32_FLOAT,         PFG_BGRA8_UNORM },
+        { PFG_RGBA16_FLOAT,         PFG_RGBA32_FLOAT },
+        { PFG_RGBA32_FLOAT,         PFG_RGBA16_FLOAT },
+        { PFG_R8_UNORM,             PFG_RGBA8_UNORM },
+        { PFG_RG8_UNORM,            PFG_RGBA8_UNORM },
+        { PFG_RG8_UNORM,            PFG_BGRA8_UNORM },
+        { PFG_D32_FLOAT,            PFG_R32_FLOAT },
+        { PFG_D16_UNORM,            PFG_R32_FLOAT },
+        { PFG_D24_UNORM_S8_UINT,    PFG_R32_FLOAT },
+        { PFG_D32_FLOAT_S8X24_UINT, PFG_R32_FLOAT },
+    };
+    // clang-format on
+
+    // Odd width to exercise the scalar tails of the SIMD paths
+    const uint32 width = 67u;
+    const uint32 height = 5u;
+
+    srand( 101 );
+
+    const size_t numPairs = sizeof( formatPairs ) / sizeof( formatPairs[0] );
+    for( size_t i = 0u; i < numPairs; ++i )
+    {
+        const PixelFormatGpu srcFormat = formatPairs[i].srcFormat;
+        const PixelFormatGpu dstFormat = formatPairs[i].dstFormat;
+
+        const uint32 srcBpp = PixelFormatGpuUtils::getBytesPerPixel( srcFormat );
+        const uint32 dstBpp = PixelFormatGpuUtils::getBytesPerPixel( dstFormat );
+
+        std::vector<uint8> srcData( width * height * srcBpp );
+        std::vector<uint8> dstData( width * height * dstBpp );
+        std::vector<uint8> refData( width * height * dstBpp );
+
+        if( PixelFormatGpuUtils::isFloat( srcFormat ) )
+        {
+            // Avoid NaNs, but do test values outside [0; 1]
+            for( size_t j = 0u; j < srcData.size(); j += sizeof( float ) )
+            {
+                const float val = static_cast<float>( rand() % 1500 ) / 1000.0f - 0.25f;
+                memcpy( &srcData[j], &val, sizeof( float ) );
+            }
+        }
+        else if( PixelFormatGpuUtils::isHalf( srcFormat ) )
+        {
+            for( size_t j = 0u; j < srcData.size(); j += sizeof( uint16 ) )
+            {
+                const uint16 val = Bitwise::floatToHalf( static_cast<float>( rand() % 4000 ) - 2000.0f );
+                memcpy( &srcData[j], &val, sizeof( uint16 ) );
+            }
+        }
+        else
+        {
+            for( size_t j = 0u; j < srcData.size(); ++j )
+                srcData[j] = static_cast<uint8>( rand() );
+        }
+
+        TextureBox srcBox( width, height, 1u, 1u, srcBpp, width * srcBpp, width * height * srcBpp );
+        TextureBox dstBox( width, height, 1u, 1u, dstBpp, width * dstBpp, width * height * dstBpp );
+        srcBox.data = &srcData[0];
+        dstBox.data = &dstData[0];
+
+        PixelFormatGpuUtils::bulkPixelConversion( srcBox, srcFormat, dstBox, dstFormat );
+
+        for( size_t j = 0u; j < width * height; ++j )
+        {
+            float rgba[4];
+            PixelFormatGpuUtils::unpackColour( rgba, srcFormat, &srcData[j * srcBpp] );
+            if( srcFormat == PFG_BGRX8_UNORM )
+                rgba[3] = 1.0f;
+            PixelFormatGpuUtils::packColour( rgba, dstFormat, &refData[j * dstBpp] );
+        }
+
+        if( PixelFormatGpuUtils::isFloat( dstFormat ) || PixelFormatGpuUtils::isHalf( dstFormat ) )
+        {
+            OGRE_ASSERT( memcmp( &dstData[0], &refData[0], dstData.size() ) == 0 );
+        }
+        else
+        {
+            // float -> unorm may round differently by 1
+            for( size_t j = 0u; j < dstData.size(); ++j )
+                OGRE_ASSERT( abs( int( dstData[j] ) - int( refData[j] ) ) <= 1 );
+        }
+    }
+
+    // Benchmark
+    const uint32 benchWidth = 1024u;
+    const uint32 benchHeight = 1024u;
+    const uint32 numIterations = 16u;
+
+    Timer timer;
+    for( size_t i = 0u; i < numPairs; ++i )
+    {
+        const PixelFormatGpu srcFormat = formatPairs[i].srcFormat;
+        const PixelFormatGpu dstFormat = formatPairs[i].dstFormat;
+
+        const uint32 srcBpp = PixelFormatGpuUtils::getBytesPerPixel( srcFormat );
+        const uint32 dstBpp = PixelFormatGpuUtils::getBytesPerPixel( dstFormat );
+
+        std::vector<uint8> srcData( benchWidth * benchHeight * srcBpp, 0u );
+        std::vector<uint8> dstData( benchWidth * benchHeight * dstBpp );
+
+        TextureBox srcBox( benchWidth, benchHeight, 1u, 1u, srcBpp, benchWidth * srcBpp,
+                           benchWidth * benchHeight * srcBpp );
+        TextureBox dstBox( benchWidth, benchHeight, 1u, 1u, dstBpp, benchWidth * dstBpp,
+                           benchWidth * benchHeight * dstBpp );
+        srcBox.data = &srcData[0];
+        dstBox.data = &dstData[0];
+
+        timer.reset();
+        for( uint32 j = 0u; j < numIterations; ++j )
+            PixelFormatGpuUtils::bulkPixelConversion( srcBox, srcFormat, dstBox, dstFormat );
+        const uint64 elapsedUs = std::max<uint64>( timer.getMicroseconds(), 1u );
+
+        const double mpixPerSec =
+            double( benchWidth * benchHeight * numIterations ) / double( elapsedUs );
+        LogManager::getSingleton().logMessage(
+            "bulkPixelConversion " + String( PixelFormatGpuUtils::toString( srcFormat ) ) + " -> " +
+            PixelFormatGpuUtils::toString( dstFormat ) + ": " +
+            StringConverter::toString( Real( mpixPerSec ) ) + " MPix/s" );
+    }
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testForwardClusteredBinning()
+{
+    using namespace Ogre;
+
+    // Measures how long ForwardClustered takes to bin many lights into its grid,
+    // both with the default exponential slicing and with user-defined slice depths.
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+
+    const uint32 numSlices = 24u;
+    const uint32 numIterations = 30u;
+    const size_t numLights = 2000u;
+
+    Camera *camera = sceneManager->createCamera( "ForwardClusteredBinning" );
+    camera->setPosition( Vector3( 1.0f, 2.0f, 3.0f ) );
+    camera->lookAt( Vector3( 30.0f, -10.0f, -200.0f ) );
+    camera->setNearClipDistance( 0.5f );
+    camera->setFarClipDistance( 800.0f );
+    camera->setAspectRatio( 16.0f / 9.0f );
+
+    // Standalone viewport. Only needed so the lights pass the visibility mask.
+    Viewport viewport( 0.0f, 0.0f, 1.0f, 1.0f );
+    viewport._setVisibilityMask( 0xFFFFFFFF, 0xFFFFFFFF );
+    camera->_notifyViewport( &viewport );
+
+    std::vector<Light *> lights;
+    lights.reserve( numLights );
+
+    srand( 101 );
+    for( size_t i = 0u; i < numLights; ++i )
+    {
+        SceneNode *lightNode = sceneManager->getRootSceneNode()->createChildSceneNode();
+        Light *light = sceneManager->createLight();
+        lightNode->attachObject( light );
+        lightNode->setPosition( Real( rand() % 600 ) - 300.0f, Real( rand() % 200 ) - 100.0f,
+                                50.0f - Real( rand() % 600 ) );
+        light->setAttenuationBasedOnRadius( Real( 2 + rand() % 40 ), 0.01f );
+
+        if( i & 0x01u )
+        {
+            const Vector3 dir( Real( rand() % 200 ) - 100.0f, Real( rand() % 200 ) - 100.0f,
+                               Real( rand() % 200 ) - 99.5f );
+            light->setType( Light::LT_SPOTLIGHT );
+            light->setDirection( dir.normalisedCopy() );
+            light->setSpotlightRange( Degree( 20.0f ), Degree( 60.0f ) );
+        }
+        else
+        {
+            light->setType( Light::LT_POINT );
+        }
+
+        lights.push_back( light );
+    }
+
+    FastArray<float> sliceDepths;
+    for( uint32 i = 1u; i < numSlices; ++i )
+        sliceDepths.push_back( 3.0f + Real( i ) * 20.0f );
+
+    for( int customSlices = 0; customSlices < 2; ++customSlices )
+    {
+        sceneManager->setForwardClustered( true, 16u, 8u, numSlices, 96u, 0u, 0u, 3.0f, 500.0f );
+        ForwardClustered *forwardClustered =
+            static_cast<ForwardClustered *>( sceneManager->getForwardPlus() );
+        if( customSlices )
+            forwardClustered->setSliceDepths( sliceDepths );
+
+        sceneManager->updateSceneGraph();
+
+        Timer timer;
+        for( uint32 i = 0u; i < numIterations; ++i )
+        {
+            // Nudge the camera so the cached grid can't be reused.
+            camera->setPosition( Vector3( 1.0f, 2.0f, 3.0f + Real( i & 0x01u ) * 0.001f ) );
+            sceneManager->updateSceneGraph();
+            forwardClustered->collectLights( camera );
+        }
+        const uint64 elapsedUs = timer.getMicroseconds();
+
+        LogManager::getSingleton().logMessage(
+            "ForwardClustered binning " + StringConverter::toString( numLights ) + " lights (" +
+            ( customSlices ? "custom" : "exponential" ) + " slices): " +
+            StringConverter::toString( Real( elapsedUs ) / Real( numIterations * 1000u ) ) + " ms" );
+    }
+
+    sceneManager->setForwardClustered( false, 0u, 0u, 0u, 0u, 0u, 0u, 0.0f, 0.0f );
+
+    std::vector<Light *>::const_iterator itor = lights.begin();
+    std::vector<Light *>::const_iterator endt = lights.end();
+    while( itor != endt )
+    {
+        SceneNode *lightNode = ( *itor )->getParentSceneNode();
+        sceneManager->destroyLight( *itor );
+        sceneManager->destroySceneNode( lightNode );
+        ++itor;
+    }
+
+    sceneManager->destroyCamera( camera );
+}
@@ -10,6 +10,9 @@ namespace Demo
 {
     class InternalCoreGameState : public TutorialGameState
     {
+        void testPixelFormatConversion();
+        void testForwardClusteredBinning();
+
     public:
         InternalCoreGameState( const Ogre::String &helpDescription );
 
@@ -44,6 +44,7 @@ namespace Ogre
     struct QueuedRenderable;
 
     class Terra;
+    class VirtualTexture;
 
     /** \addtogroup Component
      *  @{
@@ -63,6 +64,8 @@ namespace Ogre
 
         FastArray<Terra *> mLinkedTerras;
 
+        VirtualTexture *mVirtualTexture;
+
     protected:
         HlmsDatablock *createDatablockImpl( IdString datablockName, const HlmsMacroblock *macroblock,
                                             const HlmsBlendblock *blendblock,
@@ -99,6 +102,26 @@ namespace Ogre
 
         void _changeRenderSystem( RenderSystem *newRs ) override;
 
+        /** Replaces the diffuse map of all Terras with a VirtualTexture that spans the
+            whole terrain (i.e. it's sampled with the same UVs as the normal map).
+        @remarks
+            Any pass that renders Terra into a PFG_R32_UINT colour target is treated as the
+            feedback pass: instead of shading, Terra writes the tiles it needs (see
+            vtFeedbackTileId in VirtualTexture_piece_ps.any). Give that same texture to
+            VirtualTexture::setFeedbackTexture. See Tutorial_TerrainVtFeedbackNode in
+            Tutorial_Terrain.compositor.
+        @par
+            Clears the shader cache.
+        @param virtualTexture
+            nullptr to go back to the datablock's diffuse map.
+            Must outlive us, or be unset before being destroyed.
+        */
+        void            setVirtualTexture( VirtualTexture *virtualTexture );
+        VirtualTexture *getVirtualTexture() const { return mVirtualTexture; }
+
+        HlmsCache preparePassHash( const CompositorShadowNode *shadowNode, bool casterPass,
+                                   bool dualParaboloid, SceneManager *sceneManager ) override;
+
         void analyzeBarriers( BarrierSolver &barrierSolver, ResourceTransitionArray &resourceTransitions,
                               Camera *renderingCamera, const bool bCasterPass ) override;
 
@@ -149,6 +172,9 @@ namespace Ogre
         static const IdString DetailTriplanarNormal;
         static const IdString DetailTriplanarRoughness;
         static const IdString DetailTriplanarMetalness;
+
+        static const IdString UseVirtualTexture;
+        static const IdString VirtualTextureFeedback;
     };
 
     /** @} */
@@ -44,9 +44,11 @@ THE SOFTWARE.
 #include "OgreHlmsManager.h"
 #include "OgreIrradianceVolume.h"
 #include "OgreLwString.h"
+#include "OgreRenderPassDescriptor.h"
 #include "OgreRenderQueue.h"
 #include "OgreSceneManager.h"
 #include "OgreViewport.h"
+#include "OgreVirtualTexture.h"
 #include "Vao/OgreConstBufferPacked.h"
 #include "Vao/OgreVaoManager.h"
 
@@ -79,9 +81,13 @@ namespace Ogre
     const IdString TerraProperty::DetailTriplanarRoughness = IdString( "detail_triplanar_roughness" );
     const IdString TerraProperty::DetailTriplanarMetalness = IdString( "detail_triplanar_metalness" );
 
+    const IdString TerraProperty::UseVirtualTexture = IdString( "terra_virtual_texture" );
+    const IdString TerraProperty::VirtualTextureFeedback = IdString( "terra_vt_feedback" );
+
     HlmsTerra::HlmsTerra( Archive *dataFolder, ArchiveVec *libraryFolders ) :
         HlmsPbs( dataFolder, libraryFolders ),
-        mLastMovableObject( 0 )
+        mLastMovableObject( 0 ),
+        mVirtualTexture( 0 )
     {
         // Override defaults
         mType = HLMS_USER3;
@@ -271,6 +277,53 @@ namespace Ogre
         datablock->loadAllTextures();
     }
     //-----------------------------------------------------------------------------------
+    void HlmsTerra::setVirtualTexture( VirtualTexture *virtualTexture )
+    {
+        if( mVirtualTexture == virtualTexture )
+            return;
+
+        mVirtualTexture = virtualTexture;
+        // indirection & atlas go after heightMap, terrainNormals & terrainShadows
+        mReservedTexSlots = virtualTexture ? 5u : 3u;
+        // The virtual texture's properties are per pass and don't alter the pass hash.
+        clearShaderCache();
+    }
+    //-----------------------------------------------------------------------------------
+    HlmsCache HlmsTerra::preparePassHash( const CompositorShadowNode *shadowNode, bool casterPass,
+                                          bool dualParaboloid, SceneManager *sceneManager )
+    {
+        HlmsCache retVal =
+            HlmsPbs::preparePassHash( shadowNode, casterPass, dualParaboloid, sceneManager );
+
+        if( mVirtualTexture && !casterPass )
+        {
+            Vector4 vtParams0, vtParams1;
+            mVirtualTexture->getShaderParams( vtParams0, vtParams1 );
+
+            setProperty( kNoTid, TerraProperty::UseVirtualTexture, 1 );
+            setProperty( kNoTid, "terra_vt_width_in_tiles", static_cast<int32>( vtParams0.x ) );
+            setProperty( kNoTid, "terra_vt_height_in_tiles", static_cast<int32>( vtParams0.y ) );
+            setProperty( kNoTid, "terra_vt_tile_resolution", static_cast<int32>( vtParams0.z ) );
+            setProperty( kNoTid, "terra_vt_border", static_cast<int32>( vtParams0.w ) );
+            setProperty( kNoTid, "terra_vt_atlas_width", static_cast<int32>( vtParams1.x ) );
+            setProperty( kNoTid, "terra_vt_atlas_height", static_cast<int32>( vtParams1.y ) );
+            setProperty( kNoTid, "terra_vt_num_mips", static_cast<int32>( vtParams1.z ) );
+
+            // The colour target's format is part of the pass hash, thus feedback
+            // and regular passes never share shaders.
+            const RenderPassDescriptor *renderPassDesc = mRenderSystem->getCurrentPassDescriptor();
+            if( renderPassDesc->getNumColourEntries() > 0u &&
+                renderPassDesc->mColour[0].texture->getPixelFormat() == PFG_R32_UINT )
+            {
+                setProperty( kNoTid, TerraProperty::VirtualTextureFeedback, 1 );
+            }
+
+            retVal.setProperties = mT[kNoTid].setProperties;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsTerra::calculateHashForPreCreate( Renderable *renderable, PiecesMap *inOutPieces )
     {
         assert( dynamic_cast<TerrainCell *>( renderable ) &&
@@ -435,6 +488,11 @@ namespace Ogre
         {
             setTextureReg( tid, PixelShader, "terrainNormals", texSlotsStart + 1 );
             setTextureReg( tid, PixelShader, "terrainShadows", texSlotsStart + 2 );
+            if( getProperty( tid, TerraProperty::UseVirtualTexture ) )
+            {
+                setTextureReg( tid, PixelShader, "vtIndirection", texSlotsStart + 3 );
+                setTextureReg( tid, PixelShader, "vtAtlas", texSlotsStart + 4 );
+            }
         }
 
         return status;
@@ -696,6 +754,16 @@ namespace Ogre
                     mTexBufUnitSlotEnd + 1u, terraObj->getNormalMapTex(), mAreaLightMasksSamplerblock );
                 *commandBuffer->addCommand<CbTexture>() = CbTexture(
                     mTexBufUnitSlotEnd + 2u, terraObj->_getShadowMapTex(), mAreaLightMasksSamplerblock );
+
+                if( mVirtualTexture )
+                {
+                    *commandBuffer->addCommand<CbTexture>() =
+                        CbTexture( mTexBufUnitSlotEnd + 3u, mVirtualTexture->getIndirection(),
+                                   mAreaLightMasksSamplerblock );
+                    *commandBuffer->addCommand<CbTexture>() =
+                        CbTexture( mTexBufUnitSlotEnd + 4u, mVirtualTexture->getAtlas(),
+                                   mAreaLightMasksSamplerblock );
+                }
             }
             mLastMovableObject = queuedRenderable.movableObject;
         }
@@ -0,0 +1,35 @@
+@insertpiece( SetCrossPlatformSettings )
+
+@property( syntax == glsl )
+	#define ogre_U0 binding = 0
+@end
+
+layout( std430, ogre_U0 ) restrict buffer sortKeysLayout
+{
+	uint2 sortKeys[];
+};
+
+layout( local_size_x = @value( threads_per_group_x ),
+		local_size_y = @value( threads_per_group_y ),
+		local_size_z = @value( threads_per_group_z ) ) in;
+
+@insertpiece( HeaderCS )
+
+vulkan( layout( ogre_P0 ) uniform Params { )
+	uniform uint4 sortParams;
+vulkan( }; )
+
+#define p_k sortParams.x
+#define p_j sortParams.y
+#define p_numKeys sortParams.z
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+void main()
+{
+	@insertpiece( ParticleBitonicSortBodyCS )
+}
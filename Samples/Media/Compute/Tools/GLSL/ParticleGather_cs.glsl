@@ -0,0 +1,45 @@
+@insertpiece( SetCrossPlatformSettings )
+
+@property( syntax == glsl )
+	#define ogre_U0 binding = 0
+	#define ogre_U1 binding = 1
+	#define ogre_U2 binding = 2
+@end
+
+layout( std430, ogre_U0 ) writeonly restrict buffer particleOutputLayout
+{
+	uint4 particleOutput[];
+};
+
+layout( std430, ogre_U1 ) readonly restrict buffer unsortedOutputLayout
+{
+	uint4 unsortedOutput[];
+};
+
+layout( std430, ogre_U2 ) readonly restrict buffer sortKeysLayout
+{
+	uint2 sortKeys[];
+};
+
+layout( local_size_x = @value( threads_per_group_x ),
+		local_size_y = @value( threads_per_group_y ),
+		local_size_z = @value( threads_per_group_z ) ) in;
+
+@insertpiece( HeaderCS )
+
+vulkan( layout( ogre_P0 ) uniform Params { )
+	uniform uint4 gatherParams;
+vulkan( }; )
+
+#define p_numParticles gatherParams.x
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+void main()
+{
+	@insertpiece( ParticleGatherBodyCS )
+}
@@ -0,0 +1,59 @@
+@insertpiece( SetCrossPlatformSettings )
+
+@property( syntax == glsl )
+	#define ogre_U0 binding = 0
+	#define ogre_U1 binding = 1
+	#define ogre_U2 binding = 2
+@end
+
+layout( std430, ogre_U0 ) restrict buffer particleStateLayout
+{
+	float4 particleState[];
+};
+
+layout( std430, ogre_U1 ) writeonly restrict buffer particleOutputLayout
+{
+	uint4 particleOutput[];
+};
+
+@property( sort_keys )
+layout( std430, ogre_U2 ) writeonly restrict buffer sortKeysLayout
+{
+	uint2 sortKeys[];
+};
+@end
+
+layout( local_size_x = @value( threads_per_group_x ),
+		local_size_y = @value( threads_per_group_y ),
+		local_size_z = @value( threads_per_group_z ) ) in;
+
+@property( syntax == glsl )
+	ReadOnlyBufferF( 3, float4, affectors );
+@else
+	ReadOnlyBufferF( 0, float4, affectors );
+@end
+
+@insertpiece( HeaderCS )
+
+vulkan( layout( ogre_P0 ) uniform Params { )
+	uniform uint4 simParams;
+	uniform float4 simParamsF;
+vulkan( }; )
+
+#define p_quota simParams.x
+#define p_firstSlot simParams.y
+#define p_numSlots simParams.z
+#define p_numAffectors simParams.w
+#define p_timeSinceLast simParamsF.x
+#define p_cameraPos simParamsF.yzw
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+void main()
+{
+	@insertpiece( ParticleSimulateBodyCS )
+}
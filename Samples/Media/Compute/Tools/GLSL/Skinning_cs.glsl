@@ -0,0 +1,42 @@
+@insertpiece( SetCrossPlatformSettings )
+
+@property( syntax == glsl )
+	#define ogre_U0 binding = 0
+@end
+
+layout( std430, ogre_U0 ) writeonly restrict buffer dstVerticesLayout
+{
+	float4 dstVertices[];
+};
+
+layout( local_size_x = @value( threads_per_group_x ),
+		local_size_y = @value( threads_per_group_y ),
+		local_size_z = @value( threads_per_group_z ) ) in;
+
+@property( syntax == glsl )
+	ReadOnlyBufferF( 1, float4, srcVertices );
+	ReadOnlyBufferF( 2, float4, boneMatrices );
+@else
+	ReadOnlyBufferF( 0, float4, srcVertices );
+	ReadOnlyBufferF( 1, float4, boneMatrices );
+@end
+
+@insertpiece( HeaderCS )
+
+vulkan( layout( ogre_P0 ) uniform Params { )
+	uniform uint2 numVertices_boneStart;
+vulkan( }; )
+
+#define p_numVertices numVertices_boneStart.x
+#define p_boneStart numVertices_boneStart.y
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+void main()
+{
+	@insertpiece( BodyCS )
+}
@@ -0,0 +1,26 @@
+@insertpiece( SetCrossPlatformSettings )
+
+RWStructuredBuffer<uint2> sortKeys : register(u0);
+
+@insertpiece( HeaderCS )
+
+uniform uint4 sortParams;
+
+#define p_k sortParams.x
+#define p_j sortParams.y
+#define p_numKeys sortParams.z
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_GlobalInvocationID : SV_DispatchThreadId
+)
+{
+	@insertpiece( ParticleBitonicSortBodyCS )
+}
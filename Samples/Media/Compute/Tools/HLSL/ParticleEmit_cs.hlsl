@@ -0,0 +1,26 @@
+@insertpiece( SetCrossPlatformSettings )
+
+RWStructuredBuffer<float4> particleState : register(u0);
+
+ReadOnlyBuffer( 0, float4, emitted );
+
+@insertpiece( HeaderCS )
+
+uniform uint4 emitParams;
+
+#define p_numEmitted emitParams.x
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_GlobalInvocationID : SV_DispatchThreadId
+)
+{
+	@insertpiece( ParticleEmitBodyCS )
+}
@@ -0,0 +1,26 @@
+@insertpiece( SetCrossPlatformSettings )
+
+RWStructuredBuffer<uint4> particleOutput : register(u0);
+RWStructuredBuffer<uint4> unsortedOutput : register(u1);
+RWStructuredBuffer<uint2> sortKeys : register(u2);
+
+@insertpiece( HeaderCS )
+
+uniform uint4 gatherParams;
+
+#define p_numParticles gatherParams.x
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_GlobalInvocationID : SV_DispatchThreadId
+)
+{
+	@insertpiece( ParticleGatherBodyCS )
+}
@@ -0,0 +1,36 @@
+@insertpiece( SetCrossPlatformSettings )
+
+RWStructuredBuffer<float4> particleState : register(u0);
+RWStructuredBuffer<uint4> particleOutput : register(u1);
+@property( sort_keys )
+	RWStructuredBuffer<uint2> sortKeys : register(u2);
+@end
+
+ReadOnlyBuffer( 0, float4, affectors );
+
+@insertpiece( HeaderCS )
+
+uniform uint4 simParams;
+uniform float4 simParamsF;
+
+#define p_quota simParams.x
+#define p_firstSlot simParams.y
+#define p_numSlots simParams.z
+#define p_numAffectors simParams.w
+#define p_timeSinceLast simParamsF.x
+#define p_cameraPos simParamsF.yzw
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_GlobalInvocationID : SV_DispatchThreadId
+)
+{
+	@insertpiece( ParticleSimulateBodyCS )
+}
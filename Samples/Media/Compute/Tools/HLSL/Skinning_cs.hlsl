@@ -0,0 +1,28 @@
+@insertpiece( SetCrossPlatformSettings )
+
+RWStructuredBuffer<float4> dstVertices : register(u0);
+
+ReadOnlyBuffer( 0, float4, srcVertices );
+ReadOnlyBuffer( 1, float4, boneMatrices );
+
+@insertpiece( HeaderCS )
+
+uniform uint2 numVertices_boneStart;
+
+#define p_numVertices numVertices_boneStart.x
+#define p_boneStart numVertices_boneStart.y
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_GlobalInvocationID : SV_DispatchThreadId
+)
+{
+	@insertpiece( BodyCS )
+}
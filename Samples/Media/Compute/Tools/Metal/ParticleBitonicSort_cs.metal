@@ -0,0 +1,30 @@
+@insertpiece( SetCrossPlatformSettings )
+
+struct Params
+{
+	uint4 sortParams;
+};
+
+@insertpiece( HeaderCS )
+
+#define p_k p.sortParams.x
+#define p_j p.sortParams.y
+#define p_numKeys p.sortParams.z
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+kernel void main_metal
+(
+	device uint2 *sortKeys                     [[buffer(UAV_SLOT_START+0)]],
+
+	constant Params &p                         [[buffer(PARAMETER_SLOT)]],
+
+	uint3 gl_GlobalInvocationID                [[thread_position_in_grid]]
+)
+{
+	@insertpiece( ParticleBitonicSortBodyCS )
+}
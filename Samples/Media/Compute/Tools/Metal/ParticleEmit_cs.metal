@@ -0,0 +1,30 @@
+@insertpiece( SetCrossPlatformSettings )
+
+struct Params
+{
+	uint4 emitParams;
+};
+
+@insertpiece( HeaderCS )
+
+#define p_numEmitted p.emitParams.x
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+kernel void main_metal
+(
+	device float4 *particleState               [[buffer(UAV_SLOT_START+0)]],
+
+	device const float4 *emitted               [[buffer(TEX_SLOT_START+0)]],
+
+	constant Params &p                         [[buffer(PARAMETER_SLOT)]],
+
+	uint3 gl_GlobalInvocationID                [[thread_position_in_grid]]
+)
+{
+	@insertpiece( ParticleEmitBodyCS )
+}
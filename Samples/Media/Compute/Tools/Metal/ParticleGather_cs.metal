@@ -0,0 +1,30 @@
+@insertpiece( SetCrossPlatformSettings )
+
+struct Params
+{
+	uint4 gatherParams;
+};
+
+@insertpiece( HeaderCS )
+
+#define p_numParticles p.gatherParams.x
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+kernel void main_metal
+(
+	device uint4 *particleOutput               [[buffer(UAV_SLOT_START+0)]],
+	device const uint4 *unsortedOutput         [[buffer(UAV_SLOT_START+1)]],
+	device const uint2 *sortKeys               [[buffer(UAV_SLOT_START+2)]],
+
+	constant Params &p                         [[buffer(PARAMETER_SLOT)]],
+
+	uint3 gl_GlobalInvocationID                [[thread_position_in_grid]]
+)
+{
+	@insertpiece( ParticleGatherBodyCS )
+}
@@ -0,0 +1,40 @@
+@insertpiece( SetCrossPlatformSettings )
+
+struct Params
+{
+	uint4 simParams;
+	float4 simParamsF;
+};
+
+@insertpiece( HeaderCS )
+
+#define p_quota p.simParams.x
+#define p_firstSlot p.simParams.y
+#define p_numSlots p.simParams.z
+#define p_numAffectors p.simParams.w
+#define p_timeSinceLast p.simParamsF.x
+#define p_cameraPos p.simParamsF.yzw
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+kernel void main_metal
+(
+	device float4 *particleState               [[buffer(UAV_SLOT_START+0)]],
+	device uint4 *particleOutput               [[buffer(UAV_SLOT_START+1)]],
+@property( sort_keys )
+	device uint2 *sortKeys                     [[buffer(UAV_SLOT_START+2)]],
+@end
+
+	device const float4 *affectors             [[buffer(TEX_SLOT_START+0)]],
+
+	constant Params &p                         [[buffer(PARAMETER_SLOT)]],
+
+	uint3 gl_GlobalInvocationID                [[thread_position_in_grid]]
+)
+{
+	@insertpiece( ParticleSimulateBodyCS )
+}
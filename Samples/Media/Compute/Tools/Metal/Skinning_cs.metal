@@ -0,0 +1,32 @@
+@insertpiece( SetCrossPlatformSettings )
+
+struct Params
+{
+	uint2 numVertices_boneStart;
+};
+
+@insertpiece( HeaderCS )
+
+#define p_numVertices p.numVertices_boneStart.x
+#define p_boneStart p.numVertices_boneStart.y
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+kernel void main_metal
+(
+	device float4 *dstVertices				[[buffer(UAV_SLOT_START+0)]],
+
+	device const float4 *srcVertices		[[buffer(TEX_SLOT_START+0)]],
+	device const float4 *boneMatrices		[[buffer(TEX_SLOT_START+1)]],
+
+	constant Params &p						[[buffer(PARAMETER_SLOT)]],
+
+	uint3 gl_GlobalInvocationID				[[thread_position_in_grid]]
+)
+{
+	@insertpiece( BodyCS )
+}
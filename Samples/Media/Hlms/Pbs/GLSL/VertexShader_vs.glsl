@@ -21,7 +21,8 @@ layout(std140) uniform;
 @property( !hlms_particle_system )
 	vulkan_layout( OGRE_POSITION ) in vec4 vertex;
 
-	@property( hlms_normal )vulkan_layout( OGRE_NORMAL ) in float3 normal;@end
+	@property( hlms_normal && !hlms_normal_oct )vulkan_layout( OGRE_NORMAL ) in float3 normal;@end
+	@property( hlms_normal && hlms_normal_oct )vulkan_layout( OGRE_NORMAL ) in float2 normal;@end
 	@property( hlms_qtangent )vulkan_layout( OGRE_NORMAL ) in midf4 qtangent;@end
 
 	@property( normal_map && !hlms_qtangent )
@@ -61,6 +62,9 @@ layout(std140) uniform;
 @property( hlms_pose )
 	vulkan_layout( ogre_T@value(poseBuf) ) uniform samplerBuffer poseBuf;
 @end
+@property( hlms_pre_skinned )
+	ReadOnlyBufferF( @value(preSkinnedBuf), float4, preSkinnedBuf );
+@end
 // END UNIFORM GL DECLARATION
 
 void main()
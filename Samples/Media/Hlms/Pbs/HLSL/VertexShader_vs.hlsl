@@ -14,7 +14,8 @@ struct VS_INPUT
 {
 @property( !hlms_particle_system )
 	float4 vertex : POSITION;
-	@property( hlms_normal )	float3 normal : NORMAL;@end
+	@property( hlms_normal && !hlms_normal_oct )	float3 normal : NORMAL;@end
+	@property( hlms_normal && hlms_normal_oct )	float2 normal : NORMAL;@end
 	@property( hlms_qtangent )	float4 qtangent : NORMAL;@end
 
 	@property( normal_map && !hlms_qtangent )
@@ -66,6 +67,9 @@ struct PS_INPUT
 @property( hlms_pose )
 	Buffer<float4> poseBuf : register(t@value(poseBuf));
 @end
+@property( hlms_pre_skinned )
+	ReadOnlyBuffer( @value(preSkinnedBuf), float4, preSkinnedBuf );
+@end
 // END UNIFORM D3D DECLARATION
 
 PS_INPUT main( VS_INPUT input )
@@ -9,7 +9,8 @@ struct VS_INPUT
 {
 @property( !hlms_particle_system )
 	float4 position [[attribute(VES_POSITION)]];
-	@property( hlms_normal )	float3 normal [[attribute(VES_NORMAL)]];@end
+	@property( hlms_normal && !hlms_normal_oct )	float3 normal [[attribute(VES_NORMAL)]];@end
+	@property( hlms_normal && hlms_normal_oct )	float2 normal [[attribute(VES_NORMAL)]];@end
 	@property( hlms_qtangent )	midf4 qtangent [[attribute(VES_NORMAL)]];@end
 
 	@property( normal_map && !hlms_qtangent )
@@ -70,6 +71,9 @@ vertex PS_INPUT main_metal
 			, device const half4 *poseBuf	[[buffer(TEX_SLOT_START+@value(poseBuf))]]
 		@end
 	@end
+	@property( hlms_pre_skinned )
+		, device const float4 *preSkinnedBuf	[[buffer(TEX_SLOT_START+@value(preSkinnedBuf))]]
+	@end
 
 	@insertpiece( ParticleSystemDeclVS )
 
@@ -28,7 +28,11 @@ in block
 @property( !hlms_render_depth_only )
 	@property( !hlms_shadowcaster )
 		@property( !hlms_prepass )
-			layout(location = @counter(rtv_target), index = 0) out midf4 outColour;
+			@property( terra_vt_feedback )
+				layout(location = @counter(rtv_target), index = 0) out uint outColour;
+			@else
+				layout(location = @counter(rtv_target), index = 0) out midf4 outColour;
+			@end
 		@end
 		@property( hlms_gen_normals_gbuffer )
 			#define outPs_normals outNormals
@@ -74,6 +78,11 @@ vulkan_layout( ogre_t@value(terrainNormals) )	midf_tex uniform texture2D terrain
 vulkan_layout( ogre_t@value(terrainShadows) )	midf_tex uniform texture2D terrainShadows;
 vulkan( layout( ogre_s@value(terrainNormals) )	uniform sampler samplerStateTerra );
 
+@property( terra_virtual_texture )
+	vulkan_layout( ogre_t@value(vtIndirection) )	uniform texture2D vtIndirection;
+	vulkan_layout( ogre_t@value(vtAtlas) )			uniform texture2D vtAtlas;
+@end
+
 @property( hlms_forwardplus )
 	vulkan_layout( ogre_T@value(f3dGrid) ) uniform usamplerBuffer f3dGrid;
 	ReadOnlyBufferF( @value(f3dLightList), float4, f3dLightList );
@@ -128,7 +137,11 @@ vulkan( layout( ogre_s@value(terrainNormals) )	uniform sampler samplerStateTerra
 void main()
 {
 	@insertpiece( custom_ps_preExecution )
-	@insertpiece( DefaultTerraBodyPS )
+	@property( terra_vt_feedback )
+		@insertpiece( TerraVirtualTextureFeedbackBodyPS )
+	@else
+		@insertpiece( DefaultTerraBodyPS )
+	@end
 	@insertpiece( custom_ps_posExecution )
 }
 @else /// !hlms_shadowcaster
@@ -51,6 +51,11 @@ Texture2D<float3> terrainNormals	: register(t@value(terrainNormals));
 Texture2D<float4> terrainShadows	: register(t@value(terrainShadows));
 SamplerState samplerStateTerra		: register(s@value(terrainNormals));
 
+@property( terra_virtual_texture )
+	Texture2D<float4> vtIndirection	: register(t@value(vtIndirection));
+	Texture2D<float4> vtAtlas		: register(t@value(vtAtlas));
+@end
+
 @property( hlms_forwardplus )
 	Buffer<uint> f3dGrid : register(t@value(f3dGrid));
 	ReadOnlyBuffer( @value(f3dLightList), float4, f3dLightList );
@@ -99,7 +104,14 @@ SamplerState samplerStateTerra		: register(s@value(terrainNormals));
 @insertpiece( DeclVctTextures )
 @insertpiece( DeclIrradianceFieldTextures )
 
-@insertpiece( DeclOutputType )
+@property( terra_vt_feedback )
+	struct PS_OUTPUT
+	{
+		uint colour0 : SV_Target@counter(rtv_target);
+	};
+@else
+	@insertpiece( DeclOutputType )
+@end
 
 @insertpiece( custom_ps_functions )
 
@@ -113,7 +125,11 @@ SamplerState samplerStateTerra		: register(s@value(terrainNormals));
 {
 	PS_OUTPUT outPs;
 	@insertpiece( custom_ps_preExecution )
-	@insertpiece( DefaultTerraBodyPS )
+	@property( terra_vt_feedback )
+		@insertpiece( TerraVirtualTextureFeedbackBodyPS )
+	@else
+		@insertpiece( DefaultTerraBodyPS )
+	@end
 	@insertpiece( custom_ps_posExecution )
 
 @property( !hlms_render_depth_only )
@@ -50,7 +50,14 @@ constexpr sampler shadowSampler = sampler( coord::normalized,
 											compare_func::greater_equal );
 										@end
 
-@insertpiece( DeclOutputType )
+@property( terra_vt_feedback )
+	struct PS_OUTPUT
+	{
+		uint colour0 [[ color(@counter(rtv_target)) ]];
+	};
+@else
+	@insertpiece( DeclOutputType )
+@end
 
 @insertpiece( custom_ps_functions )
 
@@ -80,6 +87,11 @@ fragment @insertpiece( output_type ) main_metal
 	, texture2d<midf> terrainShadows	[[texture(@value(terrainShadows))]]
 	, sampler samplerStateTerra			[[sampler(@value(terrainNormals))]]
 
+	@property( terra_virtual_texture )
+		, texture2d<float> vtIndirection	[[texture(@value(vtIndirection))]]
+		, texture2d<float> vtAtlas			[[texture(@value(vtAtlas))]]
+	@end
+
 	@property( hlms_forwardplus )
 		, device const ushort *f3dGrid [[buffer(TEX_SLOT_START+@value(f3dGrid))]]
 		, device const float4 *f3dLightList [[buffer(TEX_SLOT_START+@value(f3dLightList))]]
@@ -136,7 +148,11 @@ fragment @insertpiece( output_type ) main_metal
 {
 	PS_OUTPUT outPs;
 	@insertpiece( custom_ps_preExecution )
-	@insertpiece( DefaultTerraBodyPS )
+	@property( terra_vt_feedback )
+		@insertpiece( TerraVirtualTextureFeedbackBodyPS )
+	@else
+		@insertpiece( DefaultTerraBodyPS )
+	@end
 	@insertpiece( custom_ps_posExecution )
 
 @property( !hlms_render_depth_only )
@@ -0,0 +1,224 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "BatchedSceneQueryTests.h"
+#include "UnitTestSuite.h"
+
+#include "Math/Array/OgreArrayRay.h"
+#include "Math/Array/OgreBooleanMask.h"
+#include "Math/Array/OgreMathlib.h"
+#include "OgreBatchedSceneQuery.h"
+#include "OgreIdString.h"
+#include "OgreMovableObject.h"
+#include "OgreRay.h"
+#include "OgreRenderSystem.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(BatchedSceneQueryTests);
+
+namespace
+{
+    // Just a box, so the query has something in the entity memory managers to hit
+    class BoxObject : public MovableObject
+    {
+        static const String msMovableType;
+
+    public:
+        BoxObject(ObjectMemoryManager *objectMemoryManager, SceneManager *manager) :
+            MovableObject(Id::generateNewId<MovableObject>(), objectMemoryManager, manager, 0u)
+        {
+            const Aabb aabb(Vector3::ZERO, Vector3::UNIT_SCALE);
+            mObjectData.mLocalAabb->setFromAabb(aabb, mObjectData.mIndex);
+            mObjectData.mWorldAabb->setFromAabb(aabb, mObjectData.mIndex);
+            mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
+            mObjectData.mWorldRadius[mObjectData.mIndex] = aabb.getRadius();
+        }
+
+        const String &getMovableType() const override { return msMovableType; }
+    };
+
+    const String BoxObject::msMovableType = "BoxObject";
+
+    struct RayTestCase
+    {
+        const char *name;
+        Vector3 origin;
+        Vector3 direction;
+        bool hit;
+        Real distance;
+    };
+
+    // All of them are tested against a box centred at the origin with a half size of 1
+    const RayTestCase c_rayTestCases[] = {
+        { "hit", Vector3(-5.0f, -4.0f, -3.0f), Vector3(5.0f, 4.0f, 3.0f), true, 0.8f },
+        // Each slab is crossed, but never at the same time. Clamping the slabs used to
+        // collapse them into a hit.
+        { "miss", Vector3(-5.0f, 3.0f, 0.0f), Vector3(1.0f, -0.1f, 0.3f), false, 0.0f },
+        { "parallel outside slab", Vector3(0.0f, 2.0f, -5.0f), Vector3::UNIT_Z, false, 0.0f },
+        { "parallel inside slab", Vector3(0.0f, 0.5f, -5.0f), Vector3::UNIT_Z, true, 4.0f },
+        // (max.y - origin.y) * (1 / direction.y) = 0 * inf = NaN
+        { "parallel on slab border", Vector3(0.0f, 1.0f, -5.0f), Vector3::UNIT_Z, true, 4.0f },
+        { "origin inside", Vector3(0.2f, 0.3f, 0.1f), Vector3(1.0f, 1.0f, 0.5f), true, 0.0f },
+        { "box behind", Vector3(0.0f, 0.0f, 5.0f), Vector3::UNIT_Z, false, 0.0f },
+    };
+    const size_t c_numRayTestCases = sizeof(c_rayTestCases) / sizeof(c_rayTestCases[0]);
+}  // namespace
+
+//--------------------------------------------------------------------------
+void BatchedSceneQueryTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root(0, "plugins.cfg", "", "BatchedSceneQueryTests.log");
+    mSceneManager = 0;
+
+    // SceneManager needs a RenderSystem
+    RenderSystem *renderSystem = mRoot->getRenderSystemByName("NULL Rendering Subsystem");
+    if (renderSystem)
+    {
+        mRoot->setRenderSystem(renderSystem);
+        mRoot->initialise(true, "BatchedSceneQueryTests Window");
+        mSceneManager = mRoot->createSceneManager(ST_GENERIC, 1u);
+    }
+}
+//--------------------------------------------------------------------------
+void BatchedSceneQueryTests::tearDown()
+{
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void BatchedSceneQueryTests::testArrayRayIntersects()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ArrayAabb arrayAabb;
+    arrayAabb.setAll(Aabb(Vector3::ZERO, Vector3::UNIT_SCALE));
+
+    const uint32 allSet = BooleanMask4::getScalarMask(BooleanMask4::getAllSetMask());
+
+    for (size_t i = 0; i < c_numRayTestCases; ++i)
+    {
+        const RayTestCase &testCase = c_rayTestCases[i];
+
+        ArrayRay arrayRay;
+        arrayRay.mOrigin.setAll(testCase.origin);
+        arrayRay.mDirection.setAll(testCase.direction);
+
+        const ArrayVector3 invDir = Mathlib::SetAll(1.0f) / arrayRay.mDirection;
+        ArrayReal distance;
+        const uint32 mask = BooleanMask4::getScalarMask(arrayRay.intersects(arrayAabb));
+        const uint32 maskInvDir =
+            BooleanMask4::getScalarMask(arrayRay.intersects(arrayAabb, invDir, distance));
+
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(testCase.name, testCase.hit ? allSet : 0u, mask);
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(testCase.name, mask, maskInvDir);
+
+        if (testCase.hit)
+        {
+            OGRE_ALIGNED_DECL(Real, scalarDistance[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT);
+            CastArrayToReal(scalarDistance, distance);
+            for (size_t j = 0; j < ARRAY_PACKED_REALS; ++j)
+            {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(testCase.name, testCase.distance,
+                                                     scalarDistance[j], 1e-5);
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void BatchedSceneQueryTests::testQuery(SceneMemoryMgrTypes sceneType, bool useBvh)
+{
+    if (!mSceneManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+
+    SceneNode *sceneNode =
+        mSceneManager->getRootSceneNode(sceneType)->createChildSceneNode(sceneType);
+    BoxObject *box =
+        OGRE_NEW BoxObject(&mSceneManager->_getEntityMemoryManager(sceneType), mSceneManager);
+    sceneNode->attachObject(box);
+
+    mSceneManager->updateSceneGraph();
+
+    BatchedSceneQuery *query = mSceneManager->createBatchedQuery();
+    if (useBvh)
+    {
+        query->buildStaticBvh();
+        CPPUNIT_ASSERT(query->hasStaticBvh());
+    }
+
+    Ray rays[c_numRayTestCases];
+    for (size_t i = 0; i < c_numRayTestCases; ++i)
+        rays[i] = Ray(c_rayTestCases[i].origin, c_rayTestCases[i].direction);
+
+    query->executeRays(rays, c_numRayTestCases, false);
+
+    for (size_t i = 0; i < c_numRayTestCases; ++i)
+    {
+        const RayTestCase &testCase = c_rayTestCases[i];
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(testCase.name, testCase.hit ? size_t(1u) : size_t(0u),
+                                     query->getNumHits(i));
+        if (testCase.hit)
+        {
+            const BatchedSceneQuery::Hit &hit = query->getHits()[query->getFirstHit(i)];
+            CPPUNIT_ASSERT_MESSAGE(testCase.name, hit.movable == box);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(testCase.name, testCase.distance, hit.distance,
+                                                 1e-5);
+        }
+    }
+
+    mSceneManager->destroyQuery(query);
+    sceneNode->detachObject(box);
+    OGRE_DELETE box;
+    mSceneManager->destroySceneNode(sceneNode);
+}
+//--------------------------------------------------------------------------
+void BatchedSceneQueryTests::testQueryDynamicObjects()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Dynamic objects are swept with ArrayRay::intersects
+    testQuery(SCENE_DYNAMIC, false);
+}
+//--------------------------------------------------------------------------
+void BatchedSceneQueryTests::testQueryStaticBvh()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // BVH traversal uses the scalar version of the slab test
+    testQuery(SCENE_STATIC, true);
+}
@@ -0,0 +1,383 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "CompositorShadowNodeTests.h"
+#include "UnitTestSuite.h"
+
+#include "Compositor/OgreCompositorManager2.h"
+#include "Compositor/OgreCompositorShadowNode.h"
+#include "Compositor/OgreCompositorShadowNodeDef.h"
+#include "Compositor/OgreCompositorWorkspace.h"
+#include "OgreCamera.h"
+#include "OgreDepthBuffer.h"
+#include "OgreException.h"
+#include "OgreHlms.h"
+#include "OgreHlmsDatablock.h"
+#include "OgreHlmsManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreRenderSystem.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreSilentMemory.h"
+#include "OgreSubMesh2.h"
+#include "OgreTextureGpuManager.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(CompositorShadowNodeTests);
+
+namespace
+{
+    const char *c_meshName = "CompositorShadowNodeTests.mesh";
+
+    size_t g_numCasterDraws = 0u;
+
+    // HlmsPbs isn't available in OgreMain. This one has no shader templates, so it skips
+    // shader compilation entirely (the NULL RenderSystem doesn't need shaders) and counts
+    // how many renderables get drawn in caster passes.
+    class HlmsDummy : public Hlms
+    {
+    public:
+        HlmsDummy() : Hlms(HLMS_USER0, "dummy", 0, 0) {}
+
+        void setupRootLayout(RootLayout &rootLayout, size_t tid) override {}
+
+        HlmsDatablock *createDatablockImpl(IdString datablockName, const HlmsMacroblock *macroblock,
+                                           const HlmsBlendblock *blendblock,
+                                           const HlmsParamVec &paramVec) override
+        {
+            return OGRE_NEW HlmsDatablock(datablockName, this, macroblock, blendblock, paramVec);
+        }
+
+        const HlmsCache *createShaderCacheEntry(uint32 renderableHash, const HlmsCache &passCache,
+                                                uint32 finalHash,
+                                                const QueuedRenderable &queuedRenderable,
+                                                HlmsCache *reservedStubEntry, uint64 deadline,
+                                                size_t threadIdx) override
+        {
+            HlmsPso pso;
+            pso.initialize();
+            if (reservedStubEntry)
+            {
+                reservedStubEntry->pso = pso;
+                return reservedStubEntry;
+            }
+            return addShaderCache(finalHash, pso);
+        }
+
+        uint32 fillBuffersFor(const HlmsCache *cache, const QueuedRenderable &queuedRenderable,
+                              bool casterPass, uint32 lastCacheHash, uint32 lastTextureHash) override
+        {
+            return 0u;
+        }
+        uint32 fillBuffersForV1(const HlmsCache *cache, const QueuedRenderable &queuedRenderable,
+                                bool casterPass, uint32 lastCacheHash,
+                                CommandBuffer *commandBuffer) override
+        {
+            return 0u;
+        }
+        uint32 fillBuffersForV2(const HlmsCache *cache, const QueuedRenderable &queuedRenderable,
+                                bool casterPass, uint32 lastCacheHash,
+                                CommandBuffer *commandBuffer) override
+        {
+            if (casterPass)
+                ++g_numCasterDraws;
+            return 0u;
+        }
+    };
+}  // namespace
+
+// A single triangle, but with the bounds of a unit box. Culling only looks at the bounds.
+static void createBoxMesh(const String &name)
+{
+    VaoManager *vaoManager = Root::getSingleton().getRenderSystem()->getVaoManager();
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back(VertexElement2(VET_FLOAT3, VES_POSITION));
+
+    const float vertices[9] = { -0.5f, -0.5f, 0.0f, 0.5f, -0.5f, 0.0f, 0.0f, 0.5f, 0.0f };
+
+    MeshPtr mesh = MeshManager::getSingleton().createManual(
+        name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+    VertexBufferPackedVec vertexBuffers;
+    vertexBuffers.push_back(vaoManager->createVertexBuffer(
+        vertexElements, 3u, BT_IMMUTABLE, const_cast<float *>(vertices), false));
+    VertexArrayObject *vao = vaoManager->createVertexArrayObject(vertexBuffers, 0, OT_TRIANGLE_LIST);
+
+    SubMesh *subMesh = mesh->createSubMesh();
+    subMesh->mVao[VpNormal].push_back(vao);
+    subMesh->mVao[VpShadow].push_back(vao);
+
+    mesh->_setBounds(Aabb(Vector3::ZERO, Vector3(0.5f)), false);
+    mesh->_setBoundingSphereRadius(Vector3(0.5f).length());
+}
+
+//--------------------------------------------------------------------------
+void CompositorShadowNodeTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root(0, "plugins.cfg", "", "CompositorShadowNodeTests.log");
+    mSceneManager = 0;
+    mCamera = 0;
+    mRenderTarget = 0;
+
+    RenderSystem *renderSystem = mRoot->getRenderSystemByName("NULL Rendering Subsystem");
+    if (renderSystem)
+    {
+        mRoot->setRenderSystem(renderSystem);
+        mRoot->initialise(true, "CompositorShadowNodeTests Window");
+        HlmsManager *hlmsManager = mRoot->getHlmsManager();
+        hlmsManager->registerHlms(OGRE_NEW HlmsDummy());
+        hlmsManager->useDefaultDatablockFrom(HLMS_USER0);
+
+        mSceneManager = mRoot->createSceneManager(ST_GENERIC, 1u);
+        mSceneManager->setShadowDirectionalLightExtrusionDistance(50.0f);
+        mSceneManager->setShadowFarDistance(50.0f);
+
+        mCamera = mSceneManager->createCamera("Main Camera");
+        mCamera->setPosition(0.0f, 5.0f, 15.0f);
+        mCamera->lookAt(Vector3::ZERO);
+        mCamera->setNearClipDistance(0.1f);
+        mCamera->setFarClipDistance(100.0f);
+
+        Light *light = mSceneManager->createLight();
+        mSceneManager->getRootSceneNode()->createChildSceneNode()->attachObject(light);
+        light->setType(Light::LT_DIRECTIONAL);
+        light->setDirection(Vector3(-1.0f, -1.0f, -1.0f).normalisedCopy());
+
+        // The NULL window has no depth buffer, so render to a texture instead
+        TextureGpuManager *textureManager = renderSystem->getTextureGpuManager();
+        mRenderTarget = textureManager->createTexture(
+            "CompositorShadowNodeTests RT", GpuPageOutStrategy::Discard,
+            TextureFlags::RenderToTexture, TextureTypes::Type2D);
+        mRenderTarget->setResolution(256u, 256u);
+        mRenderTarget->setPixelFormat(PFG_RGBA8_UNORM);
+        mRenderTarget->_setDepthBufferDefaults(DepthBuffer::POOL_DEFAULT, false, PFG_D32_FLOAT);
+        mRenderTarget->_transitionTo(GpuResidency::Resident, (uint8 *)0);
+
+        createBoxMesh(c_meshName);
+    }
+}
+//--------------------------------------------------------------------------
+void CompositorShadowNodeTests::tearDown()
+{
+    if (mSceneManager)
+    {
+        mRoot->getCompositorManager2()->removeAllWorkspaces();
+        mSceneManager->destroyAllItems();
+        MeshManager::getSingleton().remove(c_meshName);
+        mRoot->getRenderSystem()->getTextureGpuManager()->destroyTexture(mRenderTarget);
+        mRenderTarget = 0;
+        mRoot->destroySceneManager(mSceneManager);
+        mSceneManager = 0;
+    }
+
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+}
+//--------------------------------------------------------------------------
+CompositorShadowNode *CompositorShadowNodeTests::createWorkspace(bool keepContent)
+{
+    CompositorManager2 *compositorManager = mRoot->getCompositorManager2();
+
+    ShadowNodeHelper::ShadowParam shadowParam;
+    silent_memset(&shadowParam, 0, sizeof(shadowParam));
+    shadowParam.technique = SHADOWMAP_FOCUSED;
+    shadowParam.resolution[0] = ShadowNodeHelper::Resolution(1024u, 1024u);
+    shadowParam.addLightType(Light::LT_DIRECTIONAL);
+
+    ShadowNodeHelper::ShadowParamVec shadowParams;
+    shadowParams.push_back(shadowParam);
+
+    CompositorShadowNodeDef *shadowNodeDef = ShadowNodeHelper::createShadowNodeWithSettings(
+        compositorManager, mRoot->getRenderSystem()->getCapabilities(), "Test ShadowNode",
+        shadowParams, false);
+    if (keepContent)
+    {
+        TextureDefinitionBase::TextureDefinitionVec &textureDefs =
+            shadowNodeDef->getLocalTextureDefinitionsNonConst();
+        for (size_t i = 0; i < textureDefs.size(); ++i)
+            textureDefs[i].textureFlags &= ~TextureFlags::DiscardableContent;
+    }
+
+    compositorManager->createBasicWorkspaceDef("Test Workspace", ColourValue::Black,
+                                               "Test ShadowNode");
+    CompositorWorkspace *workspace = compositorManager->addWorkspace(
+        mSceneManager, mRenderTarget, mCamera, "Test Workspace", true);
+
+    return workspace->findShadowNode("Test ShadowNode");
+}
+//--------------------------------------------------------------------------
+SceneNode *CompositorShadowNodeTests::createBox(const Vector3 &position, const Vector3 &scale,
+                                               SceneMemoryMgrTypes sceneType)
+{
+    Item *item = mSceneManager->createItem(
+        c_meshName, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, sceneType);
+    SceneNode *sceneNode =
+        mSceneManager->getRootSceneNode(sceneType)->createChildSceneNode(sceneType, position);
+    sceneNode->setScale(scale);
+    sceneNode->attachObject(item);
+    return sceneNode;
+}
+//--------------------------------------------------------------------------
+size_t CompositorShadowNodeTests::renderFrame()
+{
+    g_numCasterDraws = 0u;
+    mRoot->renderOneFrame();
+    return g_numCasterDraws;
+}
+//--------------------------------------------------------------------------
+void CompositorShadowNodeTests::testShadowMapCachingRequiresKeepContent()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mSceneManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+
+    // The atlas would lose its contents between frames
+    CompositorShadowNode *shadowNode = createWorkspace(false);
+    CPPUNIT_ASSERT_THROW(shadowNode->setShadowMapCaching(0u, true), InvalidParametersException);
+    CPPUNIT_ASSERT(!shadowNode->isShadowMapCached(0u));
+}
+//--------------------------------------------------------------------------
+void CompositorShadowNodeTests::testShadowMapCaching()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mSceneManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+
+    const size_t numCasters = 5u;
+    createBox(Vector3::ZERO, Vector3(20.0f, 0.1f, 20.0f), SCENE_STATIC);
+    createBox(Vector3(-2.0f, 2.0f, -2.0f), Vector3::UNIT_SCALE, SCENE_STATIC);
+    createBox(Vector3(2.0f, 2.0f, -2.0f), Vector3::UNIT_SCALE, SCENE_STATIC);
+    createBox(Vector3(-2.0f, 2.0f, 2.0f), Vector3::UNIT_SCALE, SCENE_STATIC);
+    SceneNode *movingCaster =
+        createBox(Vector3(2.0f, 2.0f, 2.0f), Vector3::UNIT_SCALE, SCENE_DYNAMIC);
+
+    CompositorShadowNode *shadowNode = createWorkspace(true);
+
+    // Every caster is drawn every frame while the camera moves around a static scene
+    const size_t numFrames = 5u;
+    size_t numCasterDraws = 0u;
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        mCamera->move(Vector3(0.1f, 0.0f, 0.0f));
+        numCasterDraws += renderFrame();
+    }
+    CPPUNIT_ASSERT_EQUAL(numFrames * numCasters, numCasterDraws);
+
+    shadowNode->setShadowMapCaching(0u, true);
+    CPPUNIT_ASSERT(shadowNode->isShadowMapCached(0u));
+
+    // The first update fills the cache
+    CPPUNIT_ASSERT_EQUAL(numCasters, renderFrame());
+    CPPUNIT_ASSERT_EQUAL(0u, shadowNode->getNumCachedShadowMapsReused());
+    CPPUNIT_ASSERT_EQUAL(1u, shadowNode->getNumCachedShadowMapsRendered());
+
+    // Small camera movements stay within the guard band: the shadow map is reused
+    numCasterDraws = 0u;
+    uint32 numReused = 0u;
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        mCamera->move(Vector3(0.1f, 0.0f, 0.0f));
+        numCasterDraws += renderFrame();
+        numReused += shadowNode->getNumCachedShadowMapsReused();
+        CPPUNIT_ASSERT_EQUAL(0u, shadowNode->getNumCachedShadowMapsRendered());
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0u), numCasterDraws);
+    CPPUNIT_ASSERT_EQUAL(uint32(numFrames), numReused);
+
+    // A caster moved inside the window. Everything gets drawn again
+    movingCaster->translate(Vector3(0.5f, 0.0f, 0.0f));
+    CPPUNIT_ASSERT_EQUAL(numCasters, renderFrame());
+    CPPUNIT_ASSERT_EQUAL(0u, shadowNode->getNumCachedShadowMapsReused());
+    CPPUNIT_ASSERT_EQUAL(1u, shadowNode->getNumCachedShadowMapsRendered());
+
+    // And it's reused again once the caster stops
+    CPPUNIT_ASSERT_EQUAL(size_t(0u), renderFrame());
+    CPPUNIT_ASSERT_EQUAL(1u, shadowNode->getNumCachedShadowMapsReused());
+
+    // Discarding the cache forces a render too
+    shadowNode->invalidateCachedShadowMaps();
+    CPPUNIT_ASSERT_EQUAL(numCasters, renderFrame());
+    CPPUNIT_ASSERT_EQUAL(1u, shadowNode->getNumCachedShadowMapsRendered());
+}
+//--------------------------------------------------------------------------
+void CompositorShadowNodeTests::testReceiverAwareCasterCulling()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mSceneManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+
+    // The camera sees the receiver and the caster right above it, but not the caster below
+    // the receiver: the light points down, so the shadow of the latter falls outside the view
+    createBox(Vector3::ZERO, Vector3(2.0f), SCENE_DYNAMIC);
+    createBox(Vector3(0.0f, 3.0f, 0.0f), Vector3::UNIT_SCALE, SCENE_DYNAMIC);
+    createBox(Vector3(0.0f, -10.0f, 0.0f), Vector3::UNIT_SCALE, SCENE_DYNAMIC);
+
+    CompositorShadowNode *shadowNode = createWorkspace(false);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(3u), renderFrame());
+    CPPUNIT_ASSERT_EQUAL(0u, shadowNode->getNumCastersTestedByReceivers());
+    CPPUNIT_ASSERT_EQUAL(0u, shadowNode->getNumCastersCulledByReceivers());
+
+    shadowNode->setReceiverAwareCasterCulling(true);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(2u), renderFrame());
+    const uint32 numTested = shadowNode->getNumCastersTestedByReceivers();
+    const uint32 numCulled = shadowNode->getNumCastersCulledByReceivers();
+    CPPUNIT_ASSERT_EQUAL(3u, numTested);
+    CPPUNIT_ASSERT_EQUAL(1u, numCulled);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0 / 3.0, double(numCulled) / double(numTested), 1e-6);
+
+    shadowNode->setReceiverAwareCasterCulling(false);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(3u), renderFrame());
+    CPPUNIT_ASSERT_EQUAL(0u, shadowNode->getNumCastersTestedByReceivers());
+}
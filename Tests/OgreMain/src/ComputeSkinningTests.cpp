@@ -0,0 +1,273 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ComputeSkinningTests.h"
+#include "UnitTestSuite.h"
+
+#include "Compute/OgreComputeSkinning.h"
+#include "OgreHlms.h"
+#include "OgreHlmsDatablock.h"
+#include "OgreHlmsManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreRenderSystem.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSubItem.h"
+#include "OgreSubMesh2.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ComputeSkinningTests);
+
+namespace
+{
+    // HlmsPbs isn't available in OgreMain. The Items just need some datablock to exist.
+    class HlmsDummy : public Hlms
+    {
+    public:
+        HlmsDummy() : Hlms(HLMS_USER0, "dummy", 0, 0) {}
+
+        void setupRootLayout(RootLayout &rootLayout, size_t tid) override {}
+
+        HlmsDatablock *createDatablockImpl(IdString datablockName, const HlmsMacroblock *macroblock,
+                                           const HlmsBlendblock *blendblock,
+                                           const HlmsParamVec &paramVec) override
+        {
+            return OGRE_NEW HlmsDatablock(datablockName, this, macroblock, blendblock, paramVec);
+        }
+
+        uint32 fillBuffersFor(const HlmsCache *cache, const QueuedRenderable &queuedRenderable,
+                              bool casterPass, uint32 lastCacheHash, uint32 lastTextureHash) override
+        {
+            return 0u;
+        }
+        uint32 fillBuffersForV1(const HlmsCache *cache, const QueuedRenderable &queuedRenderable,
+                                bool casterPass, uint32 lastCacheHash,
+                                CommandBuffer *commandBuffer) override
+        {
+            return 0u;
+        }
+        uint32 fillBuffersForV2(const HlmsCache *cache, const QueuedRenderable &queuedRenderable,
+                                bool casterPass, uint32 lastCacheHash,
+                                CommandBuffer *commandBuffer) override
+        {
+            return 0u;
+        }
+    };
+}  // namespace
+
+// A single triangle. No skeleton is needed to track it, only the blend index map.
+static MeshPtr createTriangleMesh(const String &name, bool skinned)
+{
+    VaoManager *vaoManager = Root::getSingleton().getRenderSystem()->getVaoManager();
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back(VertexElement2(VET_FLOAT3, VES_POSITION));
+    vertexElements.push_back(VertexElement2(VET_FLOAT3, VES_NORMAL));
+    if (skinned)
+    {
+        vertexElements.push_back(VertexElement2(VET_UBYTE4, VES_BLEND_INDICES));
+        vertexElements.push_back(VertexElement2(VET_FLOAT4, VES_BLEND_WEIGHTS));
+    }
+
+    const size_t vertexSize = VaoManager::calculateVertexSize(vertexElements);
+    uint8 *vertexData =
+        reinterpret_cast<uint8 *>(OGRE_MALLOC_SIMD(vertexSize * 3u, MEMCATEGORY_GEOMETRY));
+    FreeOnDestructor vertexDataPtr(vertexData);
+    memset(vertexData, 0, vertexSize * 3u);
+    for (size_t i = 0; i < 3u; ++i)
+    {
+        float *position = reinterpret_cast<float *>(vertexData + i * vertexSize);
+        position[i] = 1.0f;
+        position[5] = 1.0f;  // normal.z
+        if (skinned)
+            position[7] = 1.0f;  // First blend weight. Blend indices are all 0
+    }
+
+    MeshPtr mesh = MeshManager::getSingleton().createManual(
+        name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+    VertexBufferPackedVec vertexBuffers;
+    vertexBuffers.push_back(
+        vaoManager->createVertexBuffer(vertexElements, 3u, BT_IMMUTABLE, vertexData, false));
+    VertexArrayObject *vao = vaoManager->createVertexArrayObject(vertexBuffers, 0, OT_TRIANGLE_LIST);
+
+    SubMesh *subMesh = mesh->createSubMesh();
+    subMesh->mVao[VpNormal].push_back(vao);
+    subMesh->mVao[VpShadow].push_back(vao);
+    if (skinned)
+        subMesh->mBlendIndexToBoneIndexMap.push_back(0u);
+
+    mesh->_setBounds(Aabb(Vector3(0.5f), Vector3(0.5f)), false);
+    mesh->_setBoundingSphereRadius(1.0f);
+
+    return mesh;
+}
+
+//--------------------------------------------------------------------------
+void ComputeSkinningTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root(0, "plugins.cfg", "", "ComputeSkinningTests.log");
+    mSceneManager = 0;
+
+    RenderSystem *renderSystem = mRoot->getRenderSystemByName("NULL Rendering Subsystem");
+    if (renderSystem)
+    {
+        mRoot->setRenderSystem(renderSystem);
+        mRoot->initialise(true, "ComputeSkinningTests Window");
+        HlmsManager *hlmsManager = mRoot->getHlmsManager();
+        hlmsManager->registerHlms(OGRE_NEW HlmsDummy());
+        hlmsManager->useDefaultDatablockFrom(HLMS_USER0);
+
+        mSceneManager = mRoot->createSceneManager(ST_GENERIC, 1u);
+        mSceneManager->setComputeSkinningEnabled(true);
+    }
+}
+//--------------------------------------------------------------------------
+void ComputeSkinningTests::tearDown()
+{
+    if (mSceneManager)
+    {
+        mSceneManager->setComputeSkinningEnabled(false);
+        mRoot->destroySceneManager(mSceneManager);
+        mSceneManager = 0;
+    }
+
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+}
+//--------------------------------------------------------------------------
+void ComputeSkinningTests::testSourceBufferRefCounting()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mSceneManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+
+    ComputeSkinning *computeSkinning = mSceneManager->getComputeSkinning();
+    CPPUNIT_ASSERT(computeSkinning);
+
+    MeshPtr meshA = createTriangleMesh("ComputeSkinningTestsA.mesh", true);
+    MeshPtr meshB = createTriangleMesh("ComputeSkinningTestsB.mesh", true);
+    Item *itemA0 = mSceneManager->createItem(meshA);
+    Item *itemA1 = mSceneManager->createItem(meshA);
+    Item *itemB = mSceneManager->createItem(meshB);
+
+    // SubItems of the same SubMesh share their source vertices
+    computeSkinning->addSubItem(itemA0->getSubItem(0));
+    computeSkinning->addSubItem(itemA1->getSubItem(0));
+    CPPUNIT_ASSERT_EQUAL(size_t(2u), computeSkinning->getNumSubItems());
+    CPPUNIT_ASSERT_EQUAL(size_t(1u), computeSkinning->getNumSourceBuffers());
+
+    // Adding twice does nothing
+    computeSkinning->addSubItem(itemA0->getSubItem(0));
+    CPPUNIT_ASSERT_EQUAL(size_t(2u), computeSkinning->getNumSubItems());
+    CPPUNIT_ASSERT_EQUAL(size_t(1u), computeSkinning->getNumSourceBuffers());
+
+    computeSkinning->addItem(itemB);
+    CPPUNIT_ASSERT_EQUAL(size_t(3u), computeSkinning->getNumSubItems());
+    CPPUNIT_ASSERT_EQUAL(size_t(2u), computeSkinning->getNumSourceBuffers());
+
+    // The source vertices must survive until the last SubItem using them is removed
+    computeSkinning->removeSubItem(itemA0->getSubItem(0));
+    CPPUNIT_ASSERT_EQUAL(size_t(2u), computeSkinning->getNumSubItems());
+    CPPUNIT_ASSERT_EQUAL(size_t(2u), computeSkinning->getNumSourceBuffers());
+
+    // Removing twice does nothing
+    computeSkinning->removeSubItem(itemA0->getSubItem(0));
+    CPPUNIT_ASSERT_EQUAL(size_t(2u), computeSkinning->getNumSubItems());
+    CPPUNIT_ASSERT_EQUAL(size_t(2u), computeSkinning->getNumSourceBuffers());
+
+    computeSkinning->removeSubItem(itemA1->getSubItem(0));
+    CPPUNIT_ASSERT_EQUAL(size_t(1u), computeSkinning->getNumSubItems());
+    CPPUNIT_ASSERT_EQUAL(size_t(1u), computeSkinning->getNumSourceBuffers());
+
+    // Adding it back after its source vertices were released must recreate them
+    computeSkinning->addSubItem(itemA0->getSubItem(0));
+    CPPUNIT_ASSERT_EQUAL(size_t(2u), computeSkinning->getNumSubItems());
+    CPPUNIT_ASSERT_EQUAL(size_t(2u), computeSkinning->getNumSourceBuffers());
+
+    // Without a compute job nothing is dispatched, so they keep vertex shader skinning
+    computeSkinning->_dispatch();
+    CPPUNIT_ASSERT(!itemA0->getSubItem(0)->getPreSkinnedBuffer());
+
+    computeSkinning->removeItem(itemB);
+    computeSkinning->removeItem(itemA0);
+    CPPUNIT_ASSERT_EQUAL(size_t(0u), computeSkinning->getNumSubItems());
+    CPPUNIT_ASSERT_EQUAL(size_t(0u), computeSkinning->getNumSourceBuffers());
+
+    computeSkinning->addItem(itemA0);
+    computeSkinning->addItem(itemB);
+    computeSkinning->removeAll();
+    CPPUNIT_ASSERT_EQUAL(size_t(0u), computeSkinning->getNumSubItems());
+    CPPUNIT_ASSERT_EQUAL(size_t(0u), computeSkinning->getNumSourceBuffers());
+
+    mSceneManager->destroyItem(itemA0);
+    mSceneManager->destroyItem(itemA1);
+    mSceneManager->destroyItem(itemB);
+    MeshManager::getSingleton().remove(meshA);
+    MeshManager::getSingleton().remove(meshB);
+}
+//--------------------------------------------------------------------------
+void ComputeSkinningTests::testUnsupportedSubItem()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mSceneManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+
+    ComputeSkinning *computeSkinning = mSceneManager->getComputeSkinning();
+
+    MeshPtr mesh = createTriangleMesh("ComputeSkinningTestsStatic.mesh", false);
+    Item *item = mSceneManager->createItem(mesh);
+
+    CPPUNIT_ASSERT_THROW(computeSkinning->addSubItem(item->getSubItem(0)),
+                         InvalidParametersException);
+
+    // addItem silently skips it instead
+    computeSkinning->addItem(item);
+    CPPUNIT_ASSERT_EQUAL(size_t(0u), computeSkinning->getNumSubItems());
+    CPPUNIT_ASSERT_EQUAL(size_t(0u), computeSkinning->getNumSourceBuffers());
+
+    mSceneManager->destroyItem(item);
+    MeshManager::getSingleton().remove(mesh);
+}
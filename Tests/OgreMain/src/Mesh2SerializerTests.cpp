@@ -0,0 +1,209 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "Mesh2SerializerTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreDataStream.h"
+#include "OgreMesh2.h"
+#include "OgreMesh2Serializer.h"
+#include "OgreMeshManager2.h"
+#include "OgreRenderSystem.h"
+#include "OgreRoot.h"
+#include "OgreSubMesh2.h"
+#include "Vao/OgreAsyncTicket.h"
+#include "Vao/OgreTexBufferPacked.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(Mesh2SerializerTests);
+
+static vector<uint8>::type readBuffer(BufferPacked *buffer)
+{
+    vector<uint8>::type retVal(buffer->getTotalSizeBytes());
+    AsyncTicketPtr asyncTicket = buffer->readRequest(0, buffer->getNumElements());
+    memcpy(&retVal[0], asyncTicket->map(), retVal.size());
+    asyncTicket->unmap();
+    return retVal;
+}
+
+static void createSubMesh(Mesh *mesh, VaoManager *vaoManager, bool halfPrecisionPoses,
+                          bool poseNormalsAndNames)
+{
+    const size_t numVertices = 16u;
+    const size_t numIndices = 24u;
+    const size_t numPoses = 3u;
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back(VertexElement2(VET_FLOAT3, VES_POSITION));
+    vertexElements.push_back(VertexElement2(VET_FLOAT3, VES_NORMAL));
+
+    float *vertexData = reinterpret_cast<float *>(
+        OGRE_MALLOC_SIMD(numVertices * 6u * sizeof(float), MEMCATEGORY_GEOMETRY));
+    FreeOnDestructor vertexDataPtr(vertexData);
+    for (size_t i = 0; i < numVertices * 6u; ++i)
+        vertexData[i] = float(i) * 0.25f - 3.0f;
+
+    uint16 *indexData = reinterpret_cast<uint16 *>(
+        OGRE_MALLOC_SIMD(numIndices * sizeof(uint16), MEMCATEGORY_GEOMETRY));
+    FreeOnDestructor indexDataPtr(indexData);
+    for (size_t i = 0; i < numIndices; ++i)
+        indexData[i] = static_cast<uint16>((i * 7u) % numVertices);
+
+    VertexBufferPackedVec vertexBuffers;
+    vertexBuffers.push_back(vaoManager->createVertexBuffer(vertexElements, numVertices,
+                                                           BT_IMMUTABLE, vertexData, false));
+    IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+        IndexBufferPacked::IT_16BIT, numIndices, BT_IMMUTABLE, indexData, false);
+    VertexArrayObject *vao =
+        vaoManager->createVertexArrayObject(vertexBuffers, indexBuffer, OT_TRIANGLE_LIST);
+
+    SubMesh *subMesh = mesh->createSubMesh();
+    subMesh->mVao[VpNormal].push_back(vao);
+    subMesh->mVao[VpShadow].push_back(vao);
+    subMesh->setMaterialName("Material" + StringConverter::toString(mesh->getNumSubMeshes()));
+
+    vector<float>::type positions(numPoses * numVertices * 3u);
+    vector<float>::type normals(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        // Multiples of 1/8 so half precision stores them exactly
+        positions[i] = float(i % 37u) * 0.125f - 2.0f;
+        normals[i] = float(i % 5u) * 0.5f - 1.0f;
+    }
+
+    const float *positionPtrs[numPoses];
+    const float *normalPtrs[numPoses];
+    String names[numPoses];
+    for (size_t i = 0; i < numPoses; ++i)
+    {
+        positionPtrs[i] = &positions[i * numVertices * 3u];
+        normalPtrs[i] = &normals[i * numVertices * 3u];
+        names[i] = "Pose" + StringConverter::toString(i);
+    }
+
+    subMesh->createPoses(positionPtrs, poseNormalsAndNames ? normalPtrs : 0, numPoses, numVertices,
+                         poseNormalsAndNames ? names : 0, halfPrecisionPoses);
+}
+
+//--------------------------------------------------------------------------
+void Mesh2SerializerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root(0, "plugins.cfg", "", "Mesh2SerializerTests.log");
+
+    RenderSystem *renderSystem = mRoot->getRenderSystemByName("NULL Rendering Subsystem");
+    if (renderSystem)
+    {
+        mRoot->setRenderSystem(renderSystem);
+        mRoot->initialise(true, "Mesh2SerializerTests Window");
+    }
+}
+//--------------------------------------------------------------------------
+void Mesh2SerializerTests::tearDown()
+{
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+}
+//--------------------------------------------------------------------------
+void Mesh2SerializerTests::testFlatRoundTrip()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mRoot->isInitialised())
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+
+    VaoManager *vaoManager = mRoot->getRenderSystem()->getVaoManager();
+    MeshManager &meshManager = MeshManager::getSingleton();
+
+    MeshPtr mesh = meshManager.createManual("Mesh2SerializerTests.mesh",
+                                            ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+    // Cover both pose layouts: half precision with normals and names,
+    // and full precision without normals nor names.
+    createSubMesh(mesh.get(), vaoManager, true, true);
+    createSubMesh(mesh.get(), vaoManager, false, false);
+    mesh->_setBounds(Aabb(Vector3::ZERO, Vector3(3.0f)), false);
+    mesh->_setBoundingSphereRadius(6.0f);
+
+    MemoryDataStream *memoryStream = OGRE_NEW MemoryDataStream(1u << 16u, true, false);
+    DataStreamPtr writeStream(memoryStream);
+    MeshSerializer serializer(vaoManager);
+    serializer.exportMesh(mesh.get(), writeStream, MESH_VERSION_2_1_FLAT);
+
+    DataStreamPtr readStream(
+        OGRE_NEW MemoryDataStream(memoryStream->getPtr(), memoryStream->tell(), false, true));
+    MeshPtr loaded = meshManager.createManual("Mesh2SerializerTests_loaded.mesh",
+                                              ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+    serializer.importMesh(readStream, loaded.get());
+
+    CPPUNIT_ASSERT_EQUAL(mesh->getNumSubMeshes(), loaded->getNumSubMeshes());
+    CPPUNIT_ASSERT(mesh->getAabb().mCenter == loaded->getAabb().mCenter);
+    CPPUNIT_ASSERT(mesh->getAabb().mHalfSize == loaded->getAabb().mHalfSize);
+
+    for (unsigned i = 0; i < mesh->getNumSubMeshes(); ++i)
+    {
+        const SubMesh *original = mesh->getSubMesh(i);
+        const SubMesh *imported = loaded->getSubMesh(i);
+
+        CPPUNIT_ASSERT_EQUAL(original->getMaterialName(), imported->getMaterialName());
+        CPPUNIT_ASSERT_EQUAL(original->mVao[VpNormal].size(), imported->mVao[VpNormal].size());
+
+        const VertexArrayObject *originalVao = original->mVao[VpNormal][0];
+        const VertexArrayObject *importedVao = imported->mVao[VpNormal][0];
+        CPPUNIT_ASSERT_EQUAL(originalVao->getVertexBuffers().size(),
+                             importedVao->getVertexBuffers().size());
+        CPPUNIT_ASSERT(originalVao->getVertexBuffers()[0]->getVertexElements() ==
+                       importedVao->getVertexBuffers()[0]->getVertexElements());
+        CPPUNIT_ASSERT(readBuffer(originalVao->getVertexBuffers()[0]) ==
+                       readBuffer(importedVao->getVertexBuffers()[0]));
+        CPPUNIT_ASSERT_EQUAL(originalVao->getIndexBuffer()->getIndexType(),
+                             importedVao->getIndexBuffer()->getIndexType());
+        CPPUNIT_ASSERT(readBuffer(originalVao->getIndexBuffer()) ==
+                       readBuffer(importedVao->getIndexBuffer()));
+
+        CPPUNIT_ASSERT_EQUAL(original->getNumPoses(), imported->getNumPoses());
+        CPPUNIT_ASSERT_EQUAL(original->getPoseHalfPrecision(), imported->getPoseHalfPrecision());
+        CPPUNIT_ASSERT_EQUAL(original->getPoseNormals(), imported->getPoseNormals());
+        CPPUNIT_ASSERT(original->getPoseIndexMap() == imported->getPoseIndexMap());
+        CPPUNIT_ASSERT(readBuffer(original->getPoseTexBuffer()) ==
+                       readBuffer(imported->getPoseTexBuffer()));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(size_t(3u), loaded->getSubMesh(0)->getPoseIndexMap().size());
+    CPPUNIT_ASSERT(loaded->getSubMesh(1)->getPoseIndexMap().empty());
+
+    meshManager.remove(mesh);
+    meshManager.remove(loaded);
+}
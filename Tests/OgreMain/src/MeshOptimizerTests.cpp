@@ -0,0 +1,281 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "MeshOptimizerTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreMeshOptimizer.h"
+#include "OgreMeshlet.h"
+#include "OgreVector3.h"
+#include "ogrestd/vector.h"
+
+#include <algorithm>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(MeshOptimizerTests);
+
+// Builds a grid of quads, with the triangles in a scrambled order
+static void buildScrambledGrid(uint32 quadsPerSide, vector<uint32>::type &outIndices,
+                               vector<Vector3>::type &outPositions)
+{
+    const uint32 verticesPerSide = quadsPerSide + 1u;
+    for (uint32 y = 0; y < verticesPerSide; ++y)
+    {
+        for (uint32 x = 0; x < verticesPerSide; ++x)
+            outPositions.push_back(Vector3(Real(x), Real(y), 0));
+    }
+
+    vector<uint32>::type triangles;
+    for (uint32 y = 0; y < quadsPerSide; ++y)
+    {
+        for (uint32 x = 0; x < quadsPerSide; ++x)
+        {
+            const uint32 v0 = y * verticesPerSide + x;
+            const uint32 v1 = v0 + 1u;
+            const uint32 v2 = v0 + verticesPerSide;
+            const uint32 v3 = v2 + 1u;
+            const uint32 quad[6] = { v0, v1, v2, v2, v1, v3 };
+            triangles.insert(triangles.end(), quad, quad + 6u);
+        }
+    }
+
+    const size_t numTriangles = triangles.size() / 3u;
+    uint32 seed = 12345u;
+    for (size_t i = numTriangles - 1u; i > 0u; --i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const size_t j = seed % (i + 1u);
+        for (size_t k = 0; k < 3u; ++k)
+            std::swap(triangles[i * 3u + k], triangles[j * 3u + k]);
+    }
+
+    outIndices.swap(triangles);
+}
+
+// Returns the triangles in a canonical form so that two lists can be
+// compared regardless of their order and winding rotation
+static vector<uint64>::type canonicalTriangles(const vector<uint32>::type &indices)
+{
+    vector<uint64>::type triangles;
+    for (size_t i = 0; i < indices.size(); i += 3u)
+    {
+        // Rotate so that the smallest index goes first (keeps the winding)
+        size_t offset = 0;
+        if (indices[i + 1u] < indices[i + offset])
+            offset = 1u;
+        if (indices[i + 2u] < indices[i + offset])
+            offset = 2u;
+        const uint64 a = indices[i + offset];
+        const uint64 b = indices[i + (offset + 1u) % 3u];
+        const uint64 c = indices[i + (offset + 2u) % 3u];
+        triangles.push_back((a << 42u) | (b << 21u) | c);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+//--------------------------------------------------------------------------
+void MeshOptimizerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void MeshOptimizerTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void MeshOptimizerTests::testAnalyzeVertexCache()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Two triangles sharing an edge: 4 transforms
+    const uint32 quad[6] = { 0, 1, 2, 2, 1, 3 };
+    MeshOptimizer::VertexCacheStats stats = MeshOptimizer::analyzeVertexCache(quad, 6u, 4u);
+    CPPUNIT_ASSERT_EQUAL((size_t)2u, stats.numTriangles);
+    CPPUNIT_ASSERT_EQUAL((size_t)4u, stats.numTransformed);
+    CPPUNIT_ASSERT_EQUAL(2.0f, stats.getAcmr());
+    CPPUNIT_ASSERT_EQUAL(1.0f, stats.getAtvr());
+
+    // With a cache of 3 entries, vertex 0 is evicted by the time it's used again
+    const uint32 fan[9] = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+    stats = MeshOptimizer::analyzeVertexCache(fan, 9u, 6u, 3u);
+    CPPUNIT_ASSERT_EQUAL((size_t)9u, stats.numTransformed);
+    stats = MeshOptimizer::analyzeVertexCache(fan, 9u, 6u, 6u);
+    CPPUNIT_ASSERT_EQUAL((size_t)6u, stats.numTransformed);
+}
+//--------------------------------------------------------------------------
+void MeshOptimizerTests::testOptimizeVertexCache()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<uint32>::type indices;
+    vector<Vector3>::type positions;
+    buildScrambledGrid(32u, indices, positions);
+
+    const vector<uint64>::type originalTriangles = canonicalTriangles(indices);
+
+    const MeshOptimizer::VertexCacheStats before =
+        MeshOptimizer::analyzeVertexCache(&indices[0], indices.size(), positions.size());
+    MeshOptimizer::optimizeVertexCache(&indices[0], indices.size(), positions.size());
+    const MeshOptimizer::VertexCacheStats after =
+        MeshOptimizer::analyzeVertexCache(&indices[0], indices.size(), positions.size());
+
+    // Same triangles, same winding, just in a different order
+    CPPUNIT_ASSERT(originalTriangles == canonicalTriangles(indices));
+
+    CPPUNIT_ASSERT(before.getAcmr() > 2.0f);
+    // A grid can't go below 0.5, a good optimizer gets close to it
+    CPPUNIT_ASSERT(after.getAcmr() < 0.8f);
+    CPPUNIT_ASSERT(after.getAtvr() < 1.6f);
+}
+//--------------------------------------------------------------------------
+void MeshOptimizerTests::testOptimizeOverdraw()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<uint32>::type indices;
+    vector<Vector3>::type positions;
+    buildScrambledGrid(32u, indices, positions);
+
+    const vector<uint64>::type originalTriangles = canonicalTriangles(indices);
+
+    MeshOptimizer::optimizeVertexCache(&indices[0], indices.size(), positions.size());
+    const MeshOptimizer::VertexCacheStats before =
+        MeshOptimizer::analyzeVertexCache(&indices[0], indices.size(), positions.size());
+    MeshOptimizer::optimizeOverdraw(&indices[0], indices.size(), &positions[0], positions.size());
+    const MeshOptimizer::VertexCacheStats after =
+        MeshOptimizer::analyzeVertexCache(&indices[0], indices.size(), positions.size());
+
+    CPPUNIT_ASSERT(originalTriangles == canonicalTriangles(indices));
+    // Clusters are split where the cache gets flushed anyway
+    CPPUNIT_ASSERT(after.getAcmr() <= before.getAcmr() * 1.05f);
+}
+//--------------------------------------------------------------------------
+void MeshOptimizerTests::testDuplicateRemap()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const float vertices[6][2] = { { 1, 2 }, { 3, 4 }, { 1, 2 }, { 5, 6 }, { 3, 4 }, { 1, 2 } };
+    const uint8 *vertexData = reinterpret_cast<const uint8 *>(vertices);
+
+    uint32 remap[6];
+    const size_t numUnique =
+        MeshOptimizer::generateDuplicateRemap(remap, vertexData, 6u, sizeof(vertices[0]));
+    CPPUNIT_ASSERT_EQUAL((size_t)3u, numUnique);
+
+    // Unique vertices keep their relative order
+    const uint32 expectedRemap[6] = { 0, 1, 0, 2, 1, 0 };
+    for (size_t i = 0; i < 6u; ++i)
+        CPPUNIT_ASSERT_EQUAL(expectedRemap[i], remap[i]);
+
+    float newVertices[3][2];
+    MeshOptimizer::remapVertices(reinterpret_cast<uint8 *>(newVertices), vertexData, 6u,
+                                 sizeof(vertices[0]), remap);
+    CPPUNIT_ASSERT_EQUAL(1.0f, newVertices[0][0]);
+    CPPUNIT_ASSERT_EQUAL(4.0f, newVertices[1][1]);
+    CPPUNIT_ASSERT_EQUAL(5.0f, newVertices[2][0]);
+
+    uint32 indices[6] = { 5, 4, 3, 2, 1, 0 };
+    MeshOptimizer::remapIndices(indices, 6u, remap);
+    const uint32 expectedIndices[6] = { 0, 1, 2, 0, 1, 0 };
+    for (size_t i = 0; i < 6u; ++i)
+        CPPUNIT_ASSERT_EQUAL(expectedIndices[i], indices[i]);
+}
+//--------------------------------------------------------------------------
+void MeshOptimizerTests::testVertexFetchRemap()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const uint32 indices[6] = { 5, 2, 4, 4, 2, 0 };
+    uint32 remap[6];
+    const size_t numUsed = MeshOptimizer::generateVertexFetchRemap(remap, indices, 6u, 6u);
+    CPPUNIT_ASSERT_EQUAL((size_t)4u, numUsed);
+
+    CPPUNIT_ASSERT_EQUAL((uint32)0u, remap[5]);
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, remap[2]);
+    CPPUNIT_ASSERT_EQUAL((uint32)2u, remap[4]);
+    CPPUNIT_ASSERT_EQUAL((uint32)3u, remap[0]);
+    // Unused vertices get dropped
+    CPPUNIT_ASSERT_EQUAL(MeshOptimizer::InvalidIndex, remap[1]);
+    CPPUNIT_ASSERT_EQUAL(MeshOptimizer::InvalidIndex, remap[3]);
+}
+//--------------------------------------------------------------------------
+void MeshOptimizerTests::testBuildMeshlets()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<uint32>::type indices;
+    vector<Vector3>::type positions;
+    buildScrambledGrid(32u, indices, positions);
+
+    const vector<uint64>::type originalTriangles = canonicalTriangles(indices);
+
+    const uint32 limits[2][2] = { { 64u, 124u }, { 16u, 10u } };
+    for (size_t l = 0; l < 2u; ++l)
+    {
+        const uint32 maxVertices = limits[l][0];
+        const uint32 maxTriangles = limits[l][1];
+
+        MeshletVec meshlets;
+        MeshOptimizer::buildMeshlets(&indices[0], indices.size(), &positions[0], positions.size(),
+                                     meshlets, maxVertices, maxTriangles);
+        CPPUNIT_ASSERT(!meshlets.empty());
+
+        // Still the same triangles, only reordered
+        CPPUNIT_ASSERT(originalTriangles == canonicalTriangles(indices));
+
+        // Meshlets are contiguous and cover the index buffer exactly once,
+        // so every triangle belongs to exactly one meshlet
+        uint32 nextIndexStart = 0u;
+        for (size_t i = 0; i < meshlets.size(); ++i)
+        {
+            const Meshlet &meshlet = meshlets[i];
+            CPPUNIT_ASSERT_EQUAL(nextIndexStart, meshlet.indexStart);
+            CPPUNIT_ASSERT(meshlet.indexCount > 0u);
+            CPPUNIT_ASSERT_EQUAL(0u, meshlet.indexCount % 3u);
+            CPPUNIT_ASSERT(meshlet.indexCount / 3u <= maxTriangles);
+            nextIndexStart += meshlet.indexCount;
+
+            vector<uint32>::type uniqueVertices(indices.begin() + meshlet.indexStart,
+                                                indices.begin() + meshlet.indexStart +
+                                                    meshlet.indexCount);
+            std::sort(uniqueVertices.begin(), uniqueVertices.end());
+            uniqueVertices.erase(std::unique(uniqueVertices.begin(), uniqueVertices.end()),
+                                 uniqueVertices.end());
+            CPPUNIT_ASSERT(uniqueVertices.size() <= maxVertices);
+
+            // The bounding sphere encloses all of its vertices
+            for (size_t j = 0; j < uniqueVertices.size(); ++j)
+            {
+                const Real distance = positions[uniqueVertices[j]].distance(meshlet.center);
+                CPPUNIT_ASSERT(distance <= meshlet.radius + 1e-4f);
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL((uint32)indices.size(), nextIndexStart);
+    }
+}
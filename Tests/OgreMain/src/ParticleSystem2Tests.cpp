@@ -0,0 +1,303 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ParticleSystem2Tests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreControllerManager.h"
+#include "OgreException.h"
+#include "OgreHlms.h"
+#include "OgreHlmsDatablock.h"
+#include "OgreHlmsManager.h"
+#include "OgreMath.h"
+#include "OgreParticleEmitter.h"
+#include "OgreRenderSystem.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreStringConverter.h"
+#include "ParticleSystem/OgreEmitter2.h"
+#include "ParticleSystem/OgreParticleAffector2.h"
+#include "ParticleSystem/OgreParticleSystem2.h"
+#include "ParticleSystem/OgreParticleSystemManager2.h"
+#include "Vao/OgreVaoManager.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ParticleSystem2Tests);
+
+namespace
+{
+    // HlmsUnlit isn't available in OgreMain. Particle systems just need its default datablock.
+    class HlmsDummy : public Hlms
+    {
+    public:
+        HlmsDummy() : Hlms(HLMS_UNLIT, "dummy", 0, 0) {}
+
+        void setupRootLayout(RootLayout &rootLayout, size_t tid) override {}
+
+        HlmsDatablock *createDatablockImpl(IdString datablockName, const HlmsMacroblock *macroblock,
+                                           const HlmsBlendblock *blendblock,
+                                           const HlmsParamVec &paramVec) override
+        {
+            return OGRE_NEW HlmsDatablock(datablockName, this, macroblock, blendblock, paramVec);
+        }
+
+        uint32 fillBuffersFor(const HlmsCache *cache, const QueuedRenderable &queuedRenderable,
+                              bool casterPass, uint32 lastCacheHash, uint32 lastTextureHash) override
+        {
+            return 0u;
+        }
+        uint32 fillBuffersForV1(const HlmsCache *cache, const QueuedRenderable &queuedRenderable,
+                                bool casterPass, uint32 lastCacheHash,
+                                CommandBuffer *commandBuffer) override
+        {
+            return 0u;
+        }
+        uint32 fillBuffersForV2(const HlmsCache *cache, const QueuedRenderable &queuedRenderable,
+                                bool casterPass, uint32 lastCacheHash,
+                                CommandBuffer *commandBuffer) override
+        {
+            return 0u;
+        }
+    };
+
+    // Linear congruential generator so emission is the same on every run.
+    class FixedSeedRandom : public Math::RandomValueProvider
+    {
+        uint32 mState;
+
+    public:
+        FixedSeedRandom() : mState(12345u) {}
+
+        Real getRandomUnit() override
+        {
+            mState = mState * 1664525u + 1013904223u;
+            return Real(mState >> 8u) / Real(0xFFFFFF);
+        }
+    };
+
+    const uint32 kQuota = 16u;
+    const Real kFrameTime = 0.1f;
+    const Vector3 kForce(0.0f, -9.8f, 1.0f);
+    const Real kScaleRate = 0.5f;
+
+    struct ParticleState
+    {
+        Vector3 position;
+        Vector3 direction;
+        Vector2 dimensions;
+        Real timeToLive;
+    };
+
+    ParticleState getParticleState(const ParticleCpuData &cpuData, size_t handle)
+    {
+        const size_t j = handle / ARRAY_PACKED_REALS;
+        const size_t idx = handle % ARRAY_PACKED_REALS;
+
+        ParticleState state;
+        cpuData.mPosition[j].getAsVector3(state.position, idx);
+        cpuData.mDirection[j].getAsVector3(state.direction, idx);
+        cpuData.mDimensions[j].getAsVector2(state.dimensions, idx);
+        state.timeToLive = reinterpret_cast<const Real *>(cpuData.mTimeToLive)[handle];
+        return state;
+    }
+}  // namespace
+
+//--------------------------------------------------------------------------
+void ParticleSystem2Tests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root(0, "plugins.cfg", "", "ParticleSystem2Tests.log");
+    mSceneManager = 0;
+
+    RenderSystem *renderSystem = mRoot->getRenderSystemByName("NULL Rendering Subsystem");
+    if (renderSystem)
+    {
+        mRoot->setRenderSystem(renderSystem);
+        mRoot->initialise(true, "ParticleSystem2Tests Window");
+        mRoot->getHlmsManager()->registerHlms(OGRE_NEW HlmsDummy());
+
+        mSceneManager = mRoot->createSceneManager(ST_GENERIC, 1u);
+        ControllerManager::getSingleton().setFrameDelay(kFrameTime);
+    }
+}
+//--------------------------------------------------------------------------
+void ParticleSystem2Tests::tearDown()
+{
+    if (mSceneManager)
+    {
+        mRoot->destroySceneManager(mSceneManager);
+        mSceneManager = 0;
+    }
+
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+}
+//--------------------------------------------------------------------------
+bool ParticleSystem2Tests::isParticleFX2Available() const
+{
+    try
+    {
+        ParticleSystemManager2::getFactory("Point");
+        ParticleSystemManager2::getAffectorFactory("LinearForce");
+        ParticleSystemManager2::getAffectorFactory("Scaler");
+    }
+    catch (Exception &)
+    {
+        return false;
+    }
+    return true;
+}
+//--------------------------------------------------------------------------
+ParticleSystemDef *ParticleSystem2Tests::createSystemDef(const String &name)
+{
+    ParticleSystemDef *systemDef = mSceneManager->createParticleSystemDef(name);
+    systemDef->setParticleQuota(kQuota);
+
+    // Emits the whole quota on the first frame. Directions & speeds are random.
+    ParticleEmitter *emitter = systemDef->addEmitter("Point")->asParticleEmitter();
+    emitter->setEmissionRate(1000.0f);
+    emitter->setAngle(Degree(60.0f));
+    emitter->setParticleVelocity(1.0f, 5.0f);
+    emitter->setTimeToLive(100.0f);
+
+    systemDef->addAffector("LinearForce")
+        ->setParameter("force_vector", StringConverter::toString(kForce));
+    systemDef->addAffector("Scaler")->setParameter("rate", StringConverter::toString(kScaleRate));
+
+    return systemDef;
+}
+//--------------------------------------------------------------------------
+void ParticleSystem2Tests::advanceFrame()
+{
+    // Lets the frame time source pick up the fixed frame delay.
+    mRoot->_fireFrameStarted();
+    mSceneManager->updateSceneGraph();
+    mRoot->_fireFrameEnded();
+    mRoot->getRenderSystem()->getVaoManager()->_update();
+}
+//--------------------------------------------------------------------------
+void ParticleSystem2Tests::testGpuSimulationFallsBackToCpu()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mSceneManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+    if (!isParticleFX2Available())
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because Plugin_ParticleFX2 is not available");
+        return;
+    }
+
+    // NULL doesn't support compute shaders. Asking for GPU simulation must not fail.
+    ParticleSystemDef *systemDef = createSystemDef("ParticleSystem2Tests/Fallback");
+    systemDef->setGpuSimulation(true);
+    systemDef->init(mRoot->getRenderSystem()->getVaoManager());
+
+    CPPUNIT_ASSERT(systemDef->getGpuSimulation());
+    CPPUNIT_ASSERT(!systemDef->isGpuSimulated());
+    CPPUNIT_ASSERT(!mSceneManager->getParticleSystemManager2()->_getGpuSimulation());
+
+    ParticleSystem2 *system = mSceneManager->createParticleSystem2(systemDef);
+    mSceneManager->getRootSceneNode()->attachObject(system);
+
+    advanceFrame();
+    CPPUNIT_ASSERT_EQUAL(size_t(kQuota), systemDef->getNumSimdActiveParticles());
+}
+//--------------------------------------------------------------------------
+void ParticleSystem2Tests::testCpuSimulationMatchesReference()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mSceneManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+    if (!isParticleFX2Available())
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because Plugin_ParticleFX2 is not available");
+        return;
+    }
+
+    FixedSeedRandom random;
+    Math::SetRandomValueProvider(&random);
+
+    ParticleSystemDef *systemDef = createSystemDef("ParticleSystem2Tests/Reference");
+    systemDef->init(mRoot->getRenderSystem()->getVaoManager());
+    CPPUNIT_ASSERT(!systemDef->isGpuSimulated());
+
+    ParticleSystem2 *system = mSceneManager->createParticleSystem2(systemDef);
+    mSceneManager->getRootSceneNode()->attachObject(system);
+
+    advanceFrame();
+
+    const ParticleCpuData cpuData = systemDef->getParticleCpuData();
+
+    // Every slot got emitted. Take it as the starting point of the reference.
+    ParticleState reference[kQuota];
+    for (size_t i = 0u; i < kQuota; ++i)
+    {
+        reference[i] = getParticleState(cpuData, i);
+        CPPUNIT_ASSERT(reference[i].timeToLive > 0.0f);
+        CPPUNIT_ASSERT(reference[i].direction.length() >= 1.0f - 1e-3f);
+    }
+
+    for (size_t frame = 0u; frame < 10u; ++frame)
+    {
+        advanceFrame();
+
+        // Same order the CPU & GPU simulations use: affectors first, then integration.
+        for (size_t i = 0u; i < kQuota; ++i)
+        {
+            ParticleState &expected = reference[i];
+            expected.direction += kForce * kFrameTime;
+            expected.dimensions += Vector2(kScaleRate * kFrameTime);
+            expected.position += expected.direction * kFrameTime;
+            expected.timeToLive -= kFrameTime;
+
+            const ParticleState actual = getParticleState(cpuData, i);
+            CPPUNIT_ASSERT(actual.position.positionEquals(expected.position, 1e-3f));
+            CPPUNIT_ASSERT(actual.direction.positionEquals(expected.direction, 1e-3f));
+            CPPUNIT_ASSERT(Math::RealEqual(actual.dimensions.x, expected.dimensions.x, 1e-3f));
+            CPPUNIT_ASSERT(Math::RealEqual(actual.dimensions.y, expected.dimensions.y, 1e-3f));
+            CPPUNIT_ASSERT(Math::RealEqual(actual.timeToLive, expected.timeToLive, 1e-3f));
+        }
+    }
+
+    Math::SetRandomValueProvider(0);
+}
@@ -0,0 +1,321 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "SkeletonCompressionTests.h"
+#include "UnitTestSuite.h"
+
+#include "Animation/OgreSkeletonAnimationDef.h"
+#include "Animation/OgreSkeletonDef.h"
+#include "Animation/OgreSkeletonTrack.h"
+#include "Math/Array/OgreKfTransformArrayMemoryManager.h"
+#include "OgreAnimation.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "OgreOldBone.h"
+#include "OgreSkeleton.h"
+#include "OgreStringConverter.h"
+
+#include <limits>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(SkeletonCompressionTests);
+
+namespace
+{
+    /// Exposes the internals compress() modifies
+    class SkeletonAnimationDefTest : public SkeletonAnimationDef
+    {
+    public:
+        const SkeletonTrackVec &getTracks() const { return mTracks; }
+        const map<IdString, size_t>::type &getBoneToWeights() const { return mBoneToWeights; }
+    };
+
+    struct KeyTransform
+    {
+        Vector3    position;
+        Quaternion orientation;
+        Vector3    scale;
+    };
+
+    /// Angle between two rotations, regardless of the sign of the quaternions
+    Real angleBetween(const Quaternion &a, const Quaternion &b)
+    {
+        const Real dot = std::min(Math::Abs(a.Dot(b)) / Math::Sqrt(a.Norm() * b.Norm()), Real(1));
+        return 2.0f * Math::ACos(dot).valueRadians();
+    }
+
+    /// Samples the track at the given frame, interpolating like applyKeyFrameRigAt
+    KeyTransform sampleTrack(const SkeletonTrack &track, size_t slot, Real frame)
+    {
+        const KeyFrameRigVec &keyFrames = track.getKeyFrames();
+        size_t prevKey = 0u;
+        while (prevKey + 1u < keyFrames.size() && keyFrames[prevKey + 1u].mFrame <= frame)
+            ++prevKey;
+        const size_t nextKey = std::min(prevKey + 1u, keyFrames.size() - 1u);
+
+        KeyTransform prev, next;
+        track.getKeyFrameTransform(prevKey, slot, prev.position, prev.orientation, prev.scale);
+        track.getKeyFrameTransform(nextKey, slot, next.position, next.orientation, next.scale);
+
+        const Real t = nextKey == prevKey ? Real(0)
+                                          : (frame - keyFrames[prevKey].mFrame) /
+                                                (keyFrames[nextKey].mFrame - keyFrames[prevKey].mFrame);
+        KeyTransform retVal;
+        retVal.position = Math::lerp(prev.position, next.position, t);
+        retVal.orientation = Quaternion::nlerp(t, prev.orientation, next.orientation, true);
+        retVal.scale = Math::lerp(prev.scale, next.scale, t);
+        return retVal;
+    }
+
+    /// Each slot exercises a different corner of the codec
+    KeyTransform buildKey(size_t key, size_t slot)
+    {
+        // Positions stop moving halfway, everything else changes at a constant rate
+        const Real k = Real(key);
+        const Real kp = Real(std::min<size_t>(key, 30u));
+        KeyTransform retVal;
+        retVal.position =
+            Vector3(Math::Sin(kp * 0.1f + Real(slot)) * 3.0f, 0.5f * kp, -2.0f + Real(slot));
+        retVal.scale = Vector3::UNIT_SCALE;
+
+        switch (slot % 4u)
+        {
+        case 0:
+            // Regular rotation
+            retVal.orientation.FromAngleAxis(Radian(k * 0.05f), Vector3(1, 2, 0.5f).normalisedCopy());
+            break;
+        case 1:
+            // Near identity: the dropped component (w) is almost 1
+            retVal.orientation.FromAngleAxis(Radian(k * 1e-4f), Vector3::UNIT_Y);
+            retVal.scale = Vector3(1.0f + k * 0.01f, 1.0f, 2.0f - k * 0.005f);
+            break;
+        case 2:
+            // Negative w. Same rotation, opposite sign
+            retVal.orientation.FromAngleAxis(Radian(k * 0.03f), Vector3::UNIT_X);
+            retVal.orientation = -retVal.orientation;
+            break;
+        default:
+            // Goes past 180 degrees, so the largest component (and its sign) changes
+            retVal.orientation.FromAngleAxis(Radian(2.5f + k * 0.02f),
+                                             Vector3(0, 1, 1).normalisedCopy());
+            break;
+        }
+
+        return retVal;
+    }
+}
+//--------------------------------------------------------------------------
+void SkeletonCompressionTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void SkeletonCompressionTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void SkeletonCompressionTests::testTrackRoundTrip()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t numKeys = 60u;
+    const Real positionTolerance = 1e-3f;
+    const Real orientationTolerance = 1e-3f;
+    const Real scaleTolerance = 1e-3f;
+
+    KfTransformArrayMemoryManager memoryManager(0, numKeys * ARRAY_PACKED_REALS,
+                                                std::numeric_limits<size_t>::max(),
+                                                numKeys * ARRAY_PACKED_REALS);
+    memoryManager.initialize();
+
+    SkeletonTrack track(0u, &memoryManager);
+    for (size_t k = 0; k < numKeys; ++k)
+    {
+        track.addKeyFrame(Real(k), 1.0f);
+        KfTransform *transform = track.getKeyFrames()[k].mBoneTransform;
+        for (size_t s = 0; s < ARRAY_PACKED_REALS; ++s)
+        {
+            const KeyTransform key = buildKey(k, s);
+            transform->mPosition.setFromVector3(key.position, s);
+            transform->mOrientation.setFromQuaternion(key.orientation, s);
+            transform->mScale.setFromVector3(key.scale, s);
+        }
+    }
+    track._setMaxUsedSlot(ARRAY_PACKED_REALS - 1u);
+
+    CPPUNIT_ASSERT(!track.isCompressed());
+    CPPUNIT_ASSERT(!track.compress(positionTolerance, orientationTolerance, scaleTolerance));
+    CPPUNIT_ASSERT(track.isCompressed());
+
+    // Interpolation reproduces the second half, so keys must have been dropped
+    CPPUNIT_ASSERT(track.getKeyFrames().size() < numKeys);
+    CPPUNIT_ASSERT_EQUAL(Real(0), track.getKeyFrames().front().mFrame);
+    CPPUNIT_ASSERT_EQUAL(Real(numKeys - 1u), track.getKeyFrames().back().mFrame);
+
+    // Keyframe reduction stays within tolerance at the original keys. Quantisation adds
+    // its own error on top, which is far below these tolerances for our ranges
+    Real maxPositionError = 0, maxOrientationError = 0, maxScaleError = 0;
+    for (size_t k = 0; k < numKeys; ++k)
+    {
+        for (size_t s = 0; s < ARRAY_PACKED_REALS; ++s)
+        {
+            const KeyTransform original = buildKey(k, s);
+            const KeyTransform decoded = sampleTrack(track, s, Real(k));
+
+            maxPositionError =
+                std::max(maxPositionError, original.position.distance(decoded.position));
+            maxOrientationError =
+                std::max(maxOrientationError, angleBetween(original.orientation, decoded.orientation));
+            const Vector3 scaleDiff = original.scale - decoded.scale;
+            maxScaleError = std::max(maxScaleError, std::max(Math::Abs(scaleDiff.x),
+                                                             std::max(Math::Abs(scaleDiff.y),
+                                                                      Math::Abs(scaleDiff.z))));
+
+            // Decoded quaternions must be unit length
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, decoded.orientation.Norm(), 1e-3);
+        }
+    }
+
+    CPPUNIT_ASSERT(maxPositionError <= positionTolerance * 2.0f);
+    CPPUNIT_ASSERT(maxOrientationError <= orientationTolerance * 2.0f);
+    CPPUNIT_ASSERT(maxScaleError <= scaleTolerance * 2.0f);
+
+    memoryManager.destroy();
+}
+//--------------------------------------------------------------------------
+void SkeletonCompressionTests::testIdentityTrack()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t numKeys = 8u;
+    KfTransformArrayMemoryManager memoryManager(0, numKeys * ARRAY_PACKED_REALS,
+                                                std::numeric_limits<size_t>::max(),
+                                                numKeys * ARRAY_PACKED_REALS);
+    memoryManager.initialize();
+
+    SkeletonTrack track(0u, &memoryManager);
+    for (size_t k = 0; k < numKeys; ++k)
+    {
+        track.addKeyFrame(Real(k), 1.0f);
+        KfTransform *transform = track.getKeyFrames()[k].mBoneTransform;
+        for (size_t s = 0; s < ARRAY_PACKED_REALS; ++s)
+        {
+            transform->mPosition.setFromVector3(Vector3::ZERO, s);
+            // Sign doesn't matter, and tiny deviations are within tolerance
+            Quaternion q(Radian(k % 2u ? 1e-5f : 0.0f), Vector3::UNIT_Z);
+            if (s % 2u)
+                q = -q;
+            transform->mOrientation.setFromQuaternion(q, s);
+            transform->mScale.setFromVector3(Vector3::UNIT_SCALE, s);
+        }
+    }
+    track._setMaxUsedSlot(ARRAY_PACKED_REALS - 1u);
+
+    CPPUNIT_ASSERT(track.compress(1e-4f, 1e-3f, 1e-4f));
+    CPPUNIT_ASSERT_EQUAL((size_t)1u, track.getKeyFrames().size());
+
+    memoryManager.destroy();
+}
+//--------------------------------------------------------------------------
+void SkeletonCompressionTests::testAnimationTrackRemap()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // A root that doesn't move and 2 * ARRAY_PACKED_REALS children that do.
+    // The root's track is removed, which shifts every other track down
+    v1::Skeleton skeleton(0, "SkeletonCompressionTests", 0, "General");
+    v1::OldBone *root = skeleton.createBone("Root");
+    const size_t numChildren = 2u * ARRAY_PACKED_REALS;
+    for (size_t i = 0; i < numChildren; ++i)
+        root->addChild(skeleton.createBone("Child" + StringConverter::toString(i)));
+    skeleton.setBindingPose();
+
+    SkeletonDef skeletonDef(&skeleton, 25.0f);
+
+    const Real length = 2.0f;
+    v1::Animation *animation = skeleton.createAnimation("Anim", length);
+    for (uint16 boneIdx = 0; boneIdx < skeleton.getNumBones(); ++boneIdx)
+    {
+        v1::OldNodeAnimationTrack *track =
+            animation->createOldNodeTrack(boneIdx, skeleton.getBone(boneIdx));
+        for (size_t k = 0; k <= 10u; ++k)
+        {
+            const Real time = length * Real(k) / 10.0f;
+            v1::TransformKeyFrame *keyFrame = track->createNodeKeyFrame(time);
+            if (boneIdx != 0u)
+            {
+                keyFrame->setTranslate(Vector3(time * Real(boneIdx), 0, 0));
+                keyFrame->setRotation(Quaternion(Radian(time * 0.1f * Real(boneIdx)), Vector3::UNIT_Y));
+            }
+        }
+    }
+
+    SkeletonAnimationDefTest animDef;
+    animDef._setSkeletonDef(&skeletonDef);
+    animDef.build(&skeleton, animation, 25.0f);
+
+    const size_t numTracksBefore = animDef.getTracks().size();
+    CPPUNIT_ASSERT_EQUAL((size_t)3u, numTracksBefore);
+    CPPUNIT_ASSERT_EQUAL(skeleton.getNumBones(), (unsigned short)animDef.getBoneToWeights().size());
+
+    // Remember which block each bone's weight pointed to
+    map<IdString, uint32>::type blockPerBone;
+    map<IdString, size_t>::type::const_iterator itor = animDef.getBoneToWeights().begin();
+    map<IdString, size_t>::type::const_iterator endt = animDef.getBoneToWeights().end();
+    while (itor != endt)
+    {
+        const size_t trackIdx = (itor->second & 0x00FFFFFF) / ARRAY_PACKED_REALS;
+        blockPerBone[itor->first] = animDef.getTracks()[trackIdx].getBoneBlockIdx();
+        ++itor;
+    }
+
+    const map<IdString, size_t>::type oldBoneToWeights = animDef.getBoneToWeights();
+
+    animDef.compress();
+    CPPUNIT_ASSERT(animDef.isCompressed());
+    CPPUNIT_ASSERT_EQUAL(numTracksBefore - 1u, animDef.getTracks().size());
+
+    // The root no longer counts as affected, everyone else must still point
+    // to the track of their own block, at the same slot & depth level
+    CPPUNIT_ASSERT(animDef.getBoneToWeights().find("Root") == animDef.getBoneToWeights().end());
+    CPPUNIT_ASSERT_EQUAL(numChildren, animDef.getBoneToWeights().size());
+
+    itor = animDef.getBoneToWeights().begin();
+    endt = animDef.getBoneToWeights().end();
+    while (itor != endt)
+    {
+        const size_t oldValue = oldBoneToWeights.find(itor->first)->second;
+        const size_t trackIdx = (itor->second & 0x00FFFFFF) / ARRAY_PACKED_REALS;
+        CPPUNIT_ASSERT(trackIdx < animDef.getTracks().size());
+        CPPUNIT_ASSERT_EQUAL(blockPerBone[itor->first], animDef.getTracks()[trackIdx].getBoneBlockIdx());
+        CPPUNIT_ASSERT_EQUAL(oldValue & 0xFF000000, itor->second & 0xFF000000);
+        CPPUNIT_ASSERT_EQUAL(oldValue % ARRAY_PACKED_REALS, itor->second % ARRAY_PACKED_REALS);
+        ++itor;
+    }
+}
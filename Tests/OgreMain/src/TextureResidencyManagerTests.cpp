@@ -0,0 +1,178 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "TextureResidencyManagerTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreImage2.h"
+#include "OgreRenderSystem.h"
+#include "OgreRoot.h"
+#include "OgreStringConverter.h"
+#include "OgreTextureGpu.h"
+#include "OgreTextureGpuManager.h"
+#include "OgreTextureResidencyManager.h"
+#include "Vao/OgreVaoManager.h"
+
+#include <cstring>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(TextureResidencyManagerTests);
+
+//--------------------------------------------------------------------------
+void TextureResidencyManagerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root(0, "plugins.cfg", "", "TextureResidencyManagerTests.log");
+    mTextureGpuManager = 0;
+
+    RenderSystem *renderSystem = mRoot->getRenderSystemByName("NULL Rendering Subsystem");
+    if (renderSystem)
+    {
+        mRoot->setRenderSystem(renderSystem);
+        mRoot->initialise(true, "TextureResidencyManagerTests Window");
+        mTextureGpuManager = renderSystem->getTextureGpuManager();
+    }
+}
+//--------------------------------------------------------------------------
+void TextureResidencyManagerTests::tearDown()
+{
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    mTextureGpuManager = 0;
+}
+//--------------------------------------------------------------------------
+TextureGpu *TextureResidencyManagerTests::createTexture(const String &name, uint32 resolution,
+                                                        uint32 textureFlags)
+{
+    Image2 *image = new Image2();
+    image->createEmptyImage(resolution, resolution, 1u, TextureTypes::Type2D, PFG_RGBA8_UNORM);
+    memset(image->getRawBuffer(), 0x7F, image->getSizeBytes());
+
+    TextureGpu *texture = mTextureGpuManager->createTexture(
+        name, GpuPageOutStrategy::Discard, textureFlags, TextureTypes::Type2D);
+    texture->scheduleTransitionTo(GpuResidency::Resident, image);
+    return texture;
+}
+//--------------------------------------------------------------------------
+void TextureResidencyManagerTests::advanceFrame()
+{
+    mRoot->getRenderSystem()->getVaoManager()->_update();
+    // Runs TextureResidencyManager::_update and waits for the transitions it schedules
+    mTextureGpuManager->waitForStreamingCompletion();
+}
+//--------------------------------------------------------------------------
+void TextureResidencyManagerTests::testPooledTexturesStayResident()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mTextureGpuManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+
+    TextureGpu *bound = createTexture("Bound", 4u, TextureFlags::AutomaticBatching);
+    TextureGpu *sharesPool = createTexture("SharesPool", 4u, TextureFlags::AutomaticBatching);
+    TextureGpu *unused = createTexture("Unused", 8u, TextureFlags::AutomaticBatching);
+    mTextureGpuManager->waitForStreamingCompletion();
+
+    CPPUNIT_ASSERT(bound->getTexturePool() != 0);
+    CPPUNIT_ASSERT(bound->getTexturePool() == sharesPool->getTexturePool());
+    CPPUNIT_ASSERT(bound->getTexturePool() != unused->getTexturePool());
+
+    // Always over budget, so anything idle gets paged out
+    TextureResidencyManager *residencyManager = mTextureGpuManager->getResidencyManager();
+    residencyManager->setGlobalBudget(1u);
+    residencyManager->setMinIdleFrames(2u);
+
+    for (size_t i = 0; i < 5u; ++i)
+    {
+        // Only one texture per pool makes it into a DescriptorSetTexture
+        bound->_touch();
+        advanceFrame();
+    }
+
+    CPPUNIT_ASSERT_EQUAL(GpuResidency::Resident, bound->getResidencyStatus());
+    CPPUNIT_ASSERT_EQUAL(GpuResidency::Resident, sharesPool->getResidencyStatus());
+    CPPUNIT_ASSERT_EQUAL(GpuResidency::OnStorage, unused->getResidencyStatus());
+    CPPUNIT_ASSERT_EQUAL(uint64(1u), residencyManager->getNumEvictions());
+}
+//--------------------------------------------------------------------------
+void TextureResidencyManagerTests::testEvictsDownToLowWatermark()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mTextureGpuManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+
+    const size_t numTextures = 11u;
+    TextureGpu *textures[numTextures];
+    for (size_t i = 0; i < numTextures; ++i)
+        textures[i] = createTexture("Texture" + StringConverter::toString(i), 4u, 0u);
+    mTextureGpuManager->waitForStreamingCompletion();
+
+    const size_t textureBytes = textures[0]->getSizeBytes();
+
+    // 11 textures, budget of 10 and low watermark of 5.
+    // We're only allowed to page out 2 per frame, so it takes 3 frames to get there.
+    TextureResidencyManager *residencyManager = mTextureGpuManager->getResidencyManager();
+    residencyManager->setGlobalBudget(textureBytes * 10u);
+    residencyManager->setLowWatermark(0.5f);
+    residencyManager->setMinIdleFrames(0u);
+    residencyManager->setMaxEvictionsPerFrame(2u);
+
+    advanceFrame();
+    CPPUNIT_ASSERT_EQUAL(uint64(2u), residencyManager->getNumEvictions());
+
+    // Back within budget, but still above the low watermark. Keep going.
+    advanceFrame();
+    CPPUNIT_ASSERT_EQUAL(uint64(4u), residencyManager->getNumEvictions());
+    advanceFrame();
+    CPPUNIT_ASSERT_EQUAL(uint64(6u), residencyManager->getNumEvictions());
+
+    for (size_t i = 0; i < 3u; ++i)
+        advanceFrame();
+    CPPUNIT_ASSERT_EQUAL(uint64(6u), residencyManager->getNumEvictions());
+    CPPUNIT_ASSERT_EQUAL(textureBytes * 5u, residencyManager->getResidentBytes());
+
+    // Creeping back over the low watermark, but within budget, doesn't restart eviction
+    createTexture("Extra0", 4u, 0u);
+    createTexture("Extra1", 4u, 0u);
+    mTextureGpuManager->waitForStreamingCompletion();
+    advanceFrame();
+    advanceFrame();
+    CPPUNIT_ASSERT_EQUAL(uint64(6u), residencyManager->getNumEvictions());
+    CPPUNIT_ASSERT_EQUAL(textureBytes * 7u, residencyManager->getResidentBytes());
+}
@@ -0,0 +1,211 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "TriangleBvhTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreMath.h"
+#include "OgreRay.h"
+#include "OgreTriangleBvh.h"
+#include "ogrestd/vector.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(TriangleBvhTests);
+
+static float randomFloat(uint32 &seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return float(seed >> 8u) / float(1u << 24u);
+}
+
+// Small random triangles scattered in [-10; 10]^3, so that the BVH gets several levels
+static void buildTriangleSoup(size_t numTriangles, vector<float>::type &outPositions,
+                              vector<uint32>::type &outIndices)
+{
+    uint32 seed = 12345u;
+    for (size_t i = 0; i < numTriangles; ++i)
+    {
+        Vector3 centre(randomFloat(seed), randomFloat(seed), randomFloat(seed));
+        centre = centre * 20.0f - 10.0f;
+        for (size_t j = 0; j < 3u; ++j)
+        {
+            outPositions.push_back(centre.x + randomFloat(seed) * 2.0f - 1.0f);
+            outPositions.push_back(centre.y + randomFloat(seed) * 2.0f - 1.0f);
+            outPositions.push_back(centre.z + randomFloat(seed) * 2.0f - 1.0f);
+        }
+    }
+
+    // Reverse the order so the index buffer isn't just the identity
+    const uint32 numVertices = static_cast<uint32>(numTriangles * 3u);
+    for (uint32 i = 0; i < numVertices; ++i)
+        outIndices.push_back(numVertices - i - 1u);
+}
+
+static Vector3 getVertex(const vector<float>::type &positions, uint32 idx)
+{
+    return Vector3(positions[idx * 3u + 0u], positions[idx * 3u + 1u], positions[idx * 3u + 2u]);
+}
+
+// Returns the distance to the closest triangle, or -1 if none was hit
+static Real bruteForceRaycast(const Ray &ray, Real maxDistance, bool positiveSide,
+                              bool negativeSide, const vector<float>::type &positions,
+                              const vector<uint32>::type &indices)
+{
+    Real closest = -1.0f;
+    for (size_t i = 0; i < indices.size(); i += 3u)
+    {
+        const std::pair<bool, Real> hit =
+            Math::intersects(ray, getVertex(positions, indices[i + 0u]),
+                             getVertex(positions, indices[i + 1u]),
+                             getVertex(positions, indices[i + 2u]), positiveSide, negativeSide);
+        if (hit.first && hit.second <= maxDistance && (closest < 0.0f || hit.second < closest))
+            closest = hit.second;
+    }
+    return closest;
+}
+
+// Casts random rays through the soup and compares the results against brute force
+static void compareAgainstBruteForce(const TriangleBvh &bvh, bool positiveSide, bool negativeSide,
+                                     const vector<float>::type &positions,
+                                     const vector<uint32>::type &indices)
+{
+    uint32 seed = 6789u;
+    size_t numHits = 0u;
+    for (size_t i = 0; i < 500u; ++i)
+    {
+        Vector3 origin(randomFloat(seed), randomFloat(seed), randomFloat(seed));
+        Vector3 target(randomFloat(seed), randomFloat(seed), randomFloat(seed));
+        origin = origin * 40.0f - 20.0f;
+        target = target * 20.0f - 10.0f;
+        // Not normalised on purpose, and some rays end midway through the soup
+        const Ray ray(origin, (target - origin) * 0.5f);
+        const Real maxDistance = (i % 4u) == 0u ? 1.5f : 100.0f;
+
+        const Real expected =
+            bruteForceRaycast(ray, maxDistance, positiveSide, negativeSide, positions, indices);
+
+        TriangleRayHit hit;
+        const bool bHit = bvh.raycast(ray, maxDistance, positiveSide, negativeSide, hit);
+
+        CPPUNIT_ASSERT_EQUAL(expected >= 0.0f, bHit);
+        if (bHit)
+        {
+            ++numHits;
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, hit.distance, 1e-3);
+
+            // The reported triangle & barycentrics must describe the hit point
+            CPPUNIT_ASSERT(hit.triangleIdx < indices.size() / 3u);
+            const Vector3 v0 = getVertex(positions, indices[hit.triangleIdx * 3u + 0u]);
+            const Vector3 v1 = getVertex(positions, indices[hit.triangleIdx * 3u + 1u]);
+            const Vector3 v2 = getVertex(positions, indices[hit.triangleIdx * 3u + 2u]);
+            const Vector3 fromBarycentric = v0 * (1.0f - hit.barycentric.x - hit.barycentric.y) +
+                                            v1 * hit.barycentric.x + v2 * hit.barycentric.y;
+            CPPUNIT_ASSERT(fromBarycentric.distance(ray.getPoint(hit.distance)) < 1e-3f);
+        }
+    }
+
+    // Make sure the test is meaningful
+    CPPUNIT_ASSERT(numHits > 50u);
+}
+//--------------------------------------------------------------------------
+void TriangleBvhTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void TriangleBvhTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void TriangleBvhTests::testEmpty()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    TriangleBvh bvh;
+    TriangleRayHit hit;
+    CPPUNIT_ASSERT_EQUAL((size_t)0u, bvh.getNumTriangles());
+    CPPUNIT_ASSERT(!bvh.raycast(Ray(Vector3::ZERO, Vector3::UNIT_Z), 100.0f, true, true, hit));
+
+    // A single triangle, without index buffer
+    const float positions[9] = { 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+    bvh.build(positions, 3u, 0, false, 0u);
+    CPPUNIT_ASSERT_EQUAL((size_t)1u, bvh.getNumTriangles());
+    CPPUNIT_ASSERT(bvh.raycast(Ray(Vector3(0.25f, 0.25f, 1.0f), Vector3::NEGATIVE_UNIT_Z), 100.0f,
+                               true, true, hit));
+    CPPUNIT_ASSERT_EQUAL((uint32)0u, hit.triangleIdx);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, hit.distance, 1e-5);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, hit.barycentric.x, 1e-5);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, hit.barycentric.y, 1e-5);
+
+    bvh.clear();
+    CPPUNIT_ASSERT_EQUAL((size_t)0u, bvh.getNumTriangles());
+    CPPUNIT_ASSERT(!bvh.raycast(Ray(Vector3(0.25f, 0.25f, 1.0f), Vector3::NEGATIVE_UNIT_Z),
+                                100.0f, true, true, hit));
+}
+//--------------------------------------------------------------------------
+void TriangleBvhTests::testAgainstBruteForce()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<float>::type positions;
+    vector<uint32>::type indices;
+    buildTriangleSoup(1000u, positions, indices);
+    const size_t numVertices = positions.size() / 3u;
+
+    TriangleBvh bvh;
+    bvh.build(&positions[0], numVertices, &indices[0], false, indices.size());
+    CPPUNIT_ASSERT_EQUAL((size_t)1000u, bvh.getNumTriangles());
+    compareAgainstBruteForce(bvh, true, true, positions, indices);
+
+    // 16-bit indices must produce the same hierarchy
+    vector<uint16>::type indices16(indices.begin(), indices.end());
+    bvh.build(&positions[0], numVertices, &indices16[0], true, indices16.size());
+    compareAgainstBruteForce(bvh, true, true, positions, indices);
+
+    // No index buffer: triangle i is made of vertices [i * 3; i * 3 + 3)
+    vector<uint32>::type identity(numVertices);
+    for (uint32 i = 0; i < numVertices; ++i)
+        identity[i] = i;
+    bvh.build(&positions[0], numVertices, 0, false, 0u);
+    compareAgainstBruteForce(bvh, true, true, positions, identity);
+}
+//--------------------------------------------------------------------------
+void TriangleBvhTests::testCulling()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<float>::type positions;
+    vector<uint32>::type indices;
+    buildTriangleSoup(1000u, positions, indices);
+
+    TriangleBvh bvh;
+    bvh.build(&positions[0], positions.size() / 3u, &indices[0], false, indices.size());
+    compareAgainstBruteForce(bvh, true, false, positions, indices);
+    compareAgainstBruteForce(bvh, false, true, positions, indices);
+}
@@ -0,0 +1,191 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "VaoManagerTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreRenderSystem.h"
+#include "OgreRoot.h"
+#include "Vao/OgreAsyncTicket.h"
+#include "Vao/OgreVaoManager.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(VaoManagerTests);
+
+static void writeTransient(const VaoManager::TransientAllocation &allocation, float value)
+{
+    float *data = reinterpret_cast<float *>(allocation.data);
+    for (size_t i = 0; i < allocation.numElements * 4u; ++i)
+        *data++ = value + float(i);
+}
+
+// Reads back what the GPU would see: the NULL RenderSystem reads from _getFinalBufferStart,
+// the same offset RenderQueue bakes into baseVertex / firstVertexIndex.
+static bool checkTransient(const VaoManager::TransientAllocation &allocation, float value)
+{
+    AsyncTicketPtr asyncTicket =
+        allocation.buffer->readRequest(allocation.elementStart, allocation.numElements);
+    const float *data = reinterpret_cast<const float *>(asyncTicket->map());
+    bool retVal = true;
+    for (size_t i = 0; i < allocation.numElements * 4u; ++i)
+        retVal &= data[i] == value + float(i);
+    asyncTicket->unmap();
+    return retVal;
+}
+
+//--------------------------------------------------------------------------
+void VaoManagerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root(0, "plugins.cfg", "", "VaoManagerTests.log");
+    mVaoManager = 0;
+
+    RenderSystem *renderSystem = mRoot->getRenderSystemByName("NULL Rendering Subsystem");
+    if (renderSystem)
+    {
+        mRoot->setRenderSystem(renderSystem);
+        mRoot->initialise(false);
+
+        // The NULL RenderSystem doesn't multi-buffer dynamic buffers by default
+        NameValuePairList params;
+        params["VaoManager::mDynamicBufferMultiplier"] = "3";
+        mRoot->createRenderWindow("VaoManagerTests Window", 1u, 1u, false, &params);
+        mVaoManager = renderSystem->getVaoManager();
+    }
+}
+//--------------------------------------------------------------------------
+void VaoManagerTests::tearDown()
+{
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    mVaoManager = 0;
+}
+//--------------------------------------------------------------------------
+void VaoManagerTests::testTransientAllocationsAcrossFrames()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mVaoManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+
+    CPPUNIT_ASSERT_EQUAL(3u, unsigned(mVaoManager->getDynamicBufferMultiplier()));
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back(VertexElement2(VET_FLOAT4, VES_POSITION));
+
+    size_t prevFinalBufferStart = 0u;
+    BufferPacked *prevBuffer = 0;
+
+    for (size_t frame = 0; frame < 2u; ++frame)
+    {
+        const float value = float(frame) * 1000.0f;
+
+        VaoManager::TransientAllocation allocation =
+            mVaoManager->allocateTransientVertices(vertexElements, 16u);
+        writeTransient(allocation, value);
+
+        // The RenderQueue bakes this into the draws before executing them
+        const size_t finalBufferStart = allocation.buffer->_getFinalBufferStart();
+
+        mVaoManager->_preCommandBufferExecution();
+
+        CPPUNIT_ASSERT_EQUAL(finalBufferStart, allocation.buffer->_getFinalBufferStart());
+        CPPUNIT_ASSERT(checkTransient(allocation, value));
+
+        if (prevBuffer)
+        {
+            // Same buffer, but a different region: the GPU may still be reading last frame's
+            CPPUNIT_ASSERT(prevBuffer == allocation.buffer);
+            CPPUNIT_ASSERT(prevFinalBufferStart != finalBufferStart);
+        }
+
+        prevBuffer = allocation.buffer;
+        prevFinalBufferStart = finalBufferStart;
+
+        mVaoManager->_update();
+    }
+}
+//--------------------------------------------------------------------------
+void VaoManagerTests::testTransientAllocationAfterExecution()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    if (!mVaoManager)
+    {
+        CPPUNIT_ASSERT_ASSERTION_PASS(
+            "This test is irrelevant because NULL RenderSystem is not available");
+        return;
+    }
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back(VertexElement2(VET_FLOAT4, VES_POSITION));
+
+    VaoManager::TransientAllocation first =
+        mVaoManager->allocateTransientVertices(vertexElements, 8u);
+    writeTransient(first, 1.0f);
+    VaoManager::TransientAllocation second =
+        mVaoManager->allocateTransientVertices(vertexElements, 8u);
+    writeTransient(second, 2000.0f);
+
+    // Allocations from the same mapping are contiguous
+    CPPUNIT_ASSERT(first.buffer == second.buffer);
+    CPPUNIT_ASSERT_EQUAL(first.elementStart + first.numElements, second.elementStart);
+
+    mVaoManager->_preCommandBufferExecution();
+
+    // A buffer can't be mapped twice in the same frame, so allocating
+    // after the RenderQueue executed must switch to another buffer.
+    VaoManager::TransientAllocation third =
+        mVaoManager->allocateTransientVertices(vertexElements, 8u);
+    writeTransient(third, 3000.0f);
+    CPPUNIT_ASSERT(third.buffer != first.buffer);
+
+    mVaoManager->_preCommandBufferExecution();
+
+    CPPUNIT_ASSERT(checkTransient(first, 1.0f));
+    CPPUNIT_ASSERT(checkTransient(second, 2000.0f));
+    CPPUNIT_ASSERT(checkTransient(third, 3000.0f));
+    CPPUNIT_ASSERT_EQUAL(size_t(24u * 16u), mVaoManager->getTransientBytesAllocated());
+
+    mVaoManager->_update();
+    CPPUNIT_ASSERT_EQUAL(size_t(0u), mVaoManager->getTransientBytesAllocated());
+
+    // Next frame starts over from the first buffer
+    VaoManager::TransientAllocation fourth =
+        mVaoManager->allocateTransientVertices(vertexElements, 8u);
+    CPPUNIT_ASSERT(fourth.buffer == first.buffer);
+    CPPUNIT_ASSERT_EQUAL(size_t(0u), fourth.elementStart);
+
+    mVaoManager->destroyTransientBuffers();
+}
@@ -0,0 +1,223 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "VboSubAllocatorTests.h"
+#include "UnitTestSuite.h"
+
+#include "Vao/OgreVboSubAllocator.h"
+
+#include <algorithm>
+
+using namespace Ogre;
+
+static bool orderBlockByOffset(const VboSubAllocator::Block &a, const VboSubAllocator::Block &b)
+{
+    return a.offset < b.offset;
+}
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(VboSubAllocatorTests);
+
+//--------------------------------------------------------------------------
+void VboSubAllocatorTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void VboSubAllocatorTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void VboSubAllocatorTests::testAllocateWholePool()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Pool sizes that aren't on a bin boundary must still be fully usable
+    VboSubAllocator allocator(1000u);
+    size_t offset = 1u;
+    CPPUNIT_ASSERT(allocator.allocate(1000u, 1u, offset));
+    CPPUNIT_ASSERT_EQUAL((size_t)0u, offset);
+    CPPUNIT_ASSERT_EQUAL((size_t)0u, allocator.getFreeBytes());
+    CPPUNIT_ASSERT_EQUAL((uint32)0u, allocator.getNumFreeBlocks());
+    CPPUNIT_ASSERT(!allocator.allocate(1u, 1u, offset));
+
+    allocator.deallocate(0u, 1000u);
+    CPPUNIT_ASSERT(allocator.isEmpty());
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, allocator.getNumFreeBlocks());
+    CPPUNIT_ASSERT_EQUAL((size_t)1000u, allocator.getLargestFreeBlock());
+}
+//--------------------------------------------------------------------------
+void VboSubAllocatorTests::testAlignment()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    VboSubAllocator allocator(4096u);
+    size_t offsetA, offsetB, offsetC;
+    CPPUNIT_ASSERT(allocator.allocate(10u, 1u, offsetA));
+    // Non power of 2 alignments are common (i.e. vertex strides)
+    CPPUNIT_ASSERT(allocator.allocate(36u, 12u, offsetB));
+    CPPUNIT_ASSERT(allocator.allocate(256u, 256u, offsetC));
+
+    CPPUNIT_ASSERT_EQUAL((size_t)0u, offsetA);
+    CPPUNIT_ASSERT_EQUAL((size_t)0u, offsetB % 12u);
+    CPPUNIT_ASSERT(offsetB >= 10u);
+    CPPUNIT_ASSERT_EQUAL((size_t)0u, offsetC % 256u);
+    CPPUNIT_ASSERT(offsetC >= offsetB + 36u);
+    CPPUNIT_ASSERT_EQUAL((size_t)(4096u - 10u - 36u - 256u), allocator.getFreeBytes());
+
+    // Padding must be given back too
+    allocator.deallocate(offsetB, 36u);
+    allocator.deallocate(offsetC, 256u);
+    allocator.deallocate(offsetA, 10u);
+    CPPUNIT_ASSERT(allocator.isEmpty());
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, allocator.getNumFreeBlocks());
+}
+//--------------------------------------------------------------------------
+void VboSubAllocatorTests::testMerging()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    VboSubAllocator allocator(400u);
+    size_t offsets[4];
+    for (size_t i = 0; i < 4u; ++i)
+    {
+        CPPUNIT_ASSERT(allocator.allocate(100u, 1u, offsets[i]));
+        CPPUNIT_ASSERT_EQUAL(i * 100u, offsets[i]);
+    }
+
+    // Free 1 & 3: two free blocks that can't merge
+    allocator.deallocate(offsets[1], 100u);
+    allocator.deallocate(offsets[3], 100u);
+    CPPUNIT_ASSERT_EQUAL((uint32)2u, allocator.getNumFreeBlocks());
+
+    VboSubAllocator::BlockVec usedBlocks;
+    allocator.getUsedBlocks(usedBlocks);
+    CPPUNIT_ASSERT_EQUAL((size_t)2u, usedBlocks.size());
+    CPPUNIT_ASSERT_EQUAL((size_t)0u, usedBlocks[0].offset);
+    CPPUNIT_ASSERT_EQUAL((size_t)200u, usedBlocks[1].offset);
+
+    // Freeing 2 must merge with both neighbours
+    allocator.deallocate(offsets[2], 100u);
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, allocator.getNumFreeBlocks());
+
+    VboSubAllocator::BlockVec freeBlocks;
+    allocator.getFreeBlocks(freeBlocks);
+    CPPUNIT_ASSERT_EQUAL((size_t)1u, freeBlocks.size());
+    CPPUNIT_ASSERT_EQUAL((size_t)100u, freeBlocks[0].offset);
+    CPPUNIT_ASSERT_EQUAL((size_t)300u, freeBlocks[0].size);
+}
+//--------------------------------------------------------------------------
+void VboSubAllocatorTests::testFragmentationStats()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    VboSubAllocator allocator(1024u);
+    CPPUNIT_ASSERT_EQUAL(0.0f, allocator.getFragmentation());
+
+    // Allocate everything in 64 byte chunks, then free every other chunk
+    size_t offsets[16];
+    for (size_t i = 0; i < 16u; ++i)
+        CPPUNIT_ASSERT(allocator.allocate(64u, 1u, offsets[i]));
+    for (size_t i = 0; i < 16u; i += 2u)
+        allocator.deallocate(offsets[i], 64u);
+
+    CPPUNIT_ASSERT_EQUAL((size_t)512u, allocator.getFreeBytes());
+    CPPUNIT_ASSERT_EQUAL((size_t)64u, allocator.getLargestFreeBlock());
+    CPPUNIT_ASSERT_EQUAL((uint32)8u, allocator.getNumFreeBlocks());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0 - 64.0 / 512.0, allocator.getFragmentation(), 1e-6);
+
+    // There's plenty of free memory, but not contiguous
+    size_t offset;
+    CPPUNIT_ASSERT(!allocator.allocate(128u, 1u, offset));
+}
+//--------------------------------------------------------------------------
+void VboSubAllocatorTests::testRandomStress()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t capacity = 16u * 1024u * 1024u;
+    VboSubAllocator allocator(capacity);
+
+    VboSubAllocator::BlockVec allocations;
+    size_t usedBytes = 0u;
+
+    uint32 seed = 12345u;
+    for (size_t i = 0; i < 20000u; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const uint32 rnd = seed >> 8u;
+
+        if (allocations.empty() || (rnd % 3u) != 0u)
+        {
+            const size_t alignments[] = { 1u, 4u, 12u, 16u, 256u };
+            const size_t alignment = alignments[rnd % 5u];
+            const size_t sizeBytes = 1u + (rnd % 65536u);
+
+            size_t offset;
+            if (allocator.allocate(sizeBytes, alignment, offset))
+            {
+                CPPUNIT_ASSERT_EQUAL((size_t)0u, offset % alignment);
+                CPPUNIT_ASSERT(offset + sizeBytes <= capacity);
+                allocations.push_back(VboSubAllocator::Block(offset, sizeBytes));
+                usedBytes += sizeBytes;
+            }
+        }
+        else
+        {
+            const size_t idx = rnd % allocations.size();
+            allocator.deallocate(allocations[idx].offset, allocations[idx].size);
+            usedBytes -= allocations[idx].size;
+            allocations[idx] = allocations.back();
+            allocations.pop_back();
+        }
+
+        CPPUNIT_ASSERT_EQUAL(usedBytes, allocator.getUsedBytes());
+    }
+
+    // No two allocations may overlap
+    VboSubAllocator::BlockVec sorted = allocations;
+    std::sort(sorted.begin(), sorted.end(), orderBlockByOffset);
+    for (size_t i = 1u; i < sorted.size(); ++i)
+        CPPUNIT_ASSERT(sorted[i - 1u].offset + sorted[i - 1u].size <= sorted[i].offset);
+
+    // Free blocks never touch each other (they'd have been merged)
+    VboSubAllocator::BlockVec freeBlocks;
+    allocator.getFreeBlocks(freeBlocks);
+    CPPUNIT_ASSERT_EQUAL((size_t)allocator.getNumFreeBlocks(), freeBlocks.size());
+    for (size_t i = 1u; i < freeBlocks.size(); ++i)
+        CPPUNIT_ASSERT(freeBlocks[i - 1u].offset + freeBlocks[i - 1u].size < freeBlocks[i].offset);
+
+    while (!allocations.empty())
+    {
+        allocator.deallocate(allocations.back().offset, allocations.back().size);
+        allocations.pop_back();
+    }
+
+    CPPUNIT_ASSERT(allocator.isEmpty());
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, allocator.getNumFreeBlocks());
+    CPPUNIT_ASSERT_EQUAL(capacity, allocator.getLargestFreeBlock());
+}
@@ -0,0 +1,151 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "VertexCompressionTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreSubMesh2.h"
+#include "OgreVector3.h"
+#include "ogrestd/vector.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(VertexCompressionTests);
+
+//--------------------------------------------------------------------------
+void VertexCompressionTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void VertexCompressionTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void VertexCompressionTests::testOctahedralNormalsRoundTrip()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // The axes, the octahedron's edges and the folded (z < 0) hemisphere are
+    // the corner cases. Fill the rest with random directions
+    vector<Vector3>::type normals;
+    for (int i = 0; i < 3; ++i)
+    {
+        Vector3 axis(Vector3::ZERO);
+        axis[i] = 1.0f;
+        normals.push_back(axis);
+        normals.push_back(-axis);
+    }
+    for (int x = -1; x <= 1; x += 2)
+    {
+        for (int y = -1; y <= 1; y += 2)
+        {
+            for (int z = -1; z <= 1; z += 2)
+                normals.push_back(Vector3(Real(x), Real(y), Real(z)).normalisedCopy());
+            normals.push_back(Vector3(Real(x), Real(y), 0).normalisedCopy());
+        }
+    }
+
+    uint32 seed = 12345u;
+    while (normals.size() < 4096u)
+    {
+        Vector3 v;
+        for (size_t i = 0; i < 3u; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            v[i] = Real(seed >> 8u) / Real(1u << 23u) - 1.0f;
+        }
+        if (v.squaredLength() > 1e-4f)
+            normals.push_back(v.normalisedCopy());
+    }
+
+    // Interleave position, normal and uv so we also check the neighbours survive
+    const size_t numVertices = normals.size();
+    const size_t floatsPerVertex = 3u + 3u + 2u;
+    vector<float>::type original(numVertices * floatsPerVertex);
+    for (size_t i = 0; i < numVertices; ++i)
+    {
+        float *vertex = &original[i * floatsPerVertex];
+        vertex[0] = Real(i);
+        vertex[1] = -Real(i);
+        vertex[2] = 0.5f;
+        vertex[3] = normals[i].x;
+        vertex[4] = normals[i].y;
+        vertex[5] = normals[i].z;
+        vertex[6] = 0.25f;
+        vertex[7] = Real(i % 7u);
+    }
+
+    const size_t bytesPerVertex = floatsPerVertex * sizeof(float);
+    const char *srcData = reinterpret_cast<const char *>(&original[0]);
+    SubMesh::SourceDataArray sourceData;
+    sourceData.push_back(SubMesh::SourceData(srcData, bytesPerVertex,
+                                             VertexElement2(VET_FLOAT3, VES_POSITION)));
+    sourceData.push_back(SubMesh::SourceData(srcData + 3u * sizeof(float), bytesPerVertex,
+                                             VertexElement2(VET_FLOAT3, VES_NORMAL)));
+    sourceData.push_back(SubMesh::SourceData(srcData + 6u * sizeof(float), bytesPerVertex,
+                                             VertexElement2(VET_FLOAT2, VES_TEXTURE_COORDINATES)));
+
+    VertexElement2Vec compressedElements;
+    compressedElements.push_back(VertexElement2(VET_FLOAT3, VES_POSITION));
+    compressedElements.push_back(VertexElement2(VET_SHORT2_SNORM, VES_NORMAL));
+    compressedElements.push_back(VertexElement2(VET_FLOAT2, VES_TEXTURE_COORDINATES));
+
+    char *compressed = SubMesh::_arrangeEfficient(sourceData, compressedElements, numVertices);
+
+    VertexElement2Vec decompressedElements;
+    char *decompressed = SubMesh::_dearrangeEfficient(compressed, numVertices, compressedElements,
+                                                      &decompressedElements);
+
+    CPPUNIT_ASSERT_EQUAL((size_t)3u, decompressedElements.size());
+    CPPUNIT_ASSERT(decompressedElements[1] == VertexElement2(VET_FLOAT3, VES_NORMAL));
+
+    Real maxAngle = 0;
+    const float *result = reinterpret_cast<const float *>(decompressed);
+    for (size_t i = 0; i < numVertices; ++i)
+    {
+        const float *srcVertex = &original[i * floatsPerVertex];
+        const float *dstVertex = &result[i * floatsPerVertex];
+
+        // Everything but the normal goes through untouched
+        for (size_t j = 0; j < 3u; ++j)
+            CPPUNIT_ASSERT_EQUAL(srcVertex[j], dstVertex[j]);
+        for (size_t j = 6u; j < floatsPerVertex; ++j)
+            CPPUNIT_ASSERT_EQUAL(srcVertex[j], dstVertex[j]);
+
+        const Vector3 decoded(dstVertex[3], dstVertex[4], dstVertex[5]);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, decoded.length(), 1e-4);
+        maxAngle = std::max(maxAngle, normals[i].angleBetween(decoded).valueRadians());
+    }
+
+    // 16 bits per component give roughly 1e-4 radians of precision
+    CPPUNIT_ASSERT(maxAngle < 1e-3f);
+
+    OGRE_FREE_SIMD(compressed, MEMCATEGORY_GEOMETRY);
+    OGRE_FREE_SIMD(decompressed, MEMCATEGORY_GEOMETRY);
+}
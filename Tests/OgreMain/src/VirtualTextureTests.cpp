@@ -0,0 +1,213 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "VirtualTextureTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreException.h"
+#include "OgreVirtualTextureCache.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(VirtualTextureTests);
+
+//--------------------------------------------------------------------------
+void VirtualTextureTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void VirtualTextureTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void VirtualTextureTests::testTileIdPacking()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const uint32 tileId = VirtualTextureTile::pack(3u, 5u, 2u);
+    CPPUNIT_ASSERT_EQUAL((uint32)3u, VirtualTextureTile::getX(tileId));
+    CPPUNIT_ASSERT_EQUAL((uint32)5u, VirtualTextureTile::getY(tileId));
+    CPPUNIT_ASSERT_EQUAL((uint8)2u, VirtualTextureTile::getMip(tileId));
+    CPPUNIT_ASSERT_EQUAL(VirtualTextureTile::pack(1u, 2u, 3u), VirtualTextureTile::getParent(tileId));
+
+    // Largest values must survive the round trip and never collide with c_invalid
+    const uint32 maxTile = VirtualTextureTile::c_maxTilesPerSide - 1u;
+    const uint32 maxId = VirtualTextureTile::pack(maxTile, maxTile, VirtualTextureTile::c_maxMips - 1u);
+    CPPUNIT_ASSERT_EQUAL(maxTile, VirtualTextureTile::getX(maxId));
+    CPPUNIT_ASSERT_EQUAL(maxTile, VirtualTextureTile::getY(maxId));
+    CPPUNIT_ASSERT_EQUAL((uint8)(VirtualTextureTile::c_maxMips - 1u), VirtualTextureTile::getMip(maxId));
+    CPPUNIT_ASSERT(maxId != VirtualTextureTile::c_invalid);
+}
+//--------------------------------------------------------------------------
+void VirtualTextureTests::testMipChain()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // 8x2 -> 4x1 -> 2x1 -> 1x1; same as TextureGpu
+    VirtualTextureCache cache(8u, 2u, 0u, 4u, 2u);
+    CPPUNIT_ASSERT_EQUAL((uint8)4u, cache.getNumMips());
+    CPPUNIT_ASSERT_EQUAL((uint32)4u, cache.getWidthInTiles(1u));
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, cache.getHeightInTiles(1u));
+    CPPUNIT_ASSERT_EQUAL((uint32)2u, cache.getWidthInTiles(2u));
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, cache.getHeightInTiles(2u));
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, cache.getWidthInTiles(3u));
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, cache.getHeightInTiles(3u));
+
+    // Non power of 2 resolutions would not match the indirection texture's mips
+    CPPUNIT_ASSERT_THROW(VirtualTextureCache(5u, 4u, 0u, 4u, 2u), InvalidParametersException);
+    CPPUNIT_ASSERT_THROW(VirtualTextureCache(4u, 3u, 0u, 4u, 2u), InvalidParametersException);
+
+    // Requested mips get clamped to the full chain
+    VirtualTextureCache clamped(4u, 4u, 10u, 4u, 2u);
+    CPPUNIT_ASSERT_EQUAL((uint8)3u, clamped.getNumMips());
+
+    VirtualTextureCache truncated(4u, 4u, 2u, 5u, 5u);
+    CPPUNIT_ASSERT_EQUAL((uint8)2u, truncated.getNumMips());
+}
+//--------------------------------------------------------------------------
+void VirtualTextureTests::testFeedbackPriority()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    VirtualTextureCache cache(4u, 4u, 0u, 8u, 4u);
+
+    const uint32 feedback[] = {
+        VirtualTextureTile::pack(0u, 0u, 0u), VirtualTextureTile::pack(0u, 0u, 0u),
+        VirtualTextureTile::pack(0u, 0u, 0u), VirtualTextureTile::pack(3u, 3u, 0u),
+        VirtualTextureTile::c_invalid,        VirtualTextureTile::pack(9u, 9u, 0u),
+        VirtualTextureTile::pack(0u, 0u, 7u)
+    };
+    cache.processFeedback(feedback, sizeof(feedback) / sizeof(feedback[0]));
+
+    VirtualTextureCache::TileIdVec tilesToLoad;
+    cache.update(1u, 100u, tilesToLoad);
+
+    // Coarser mips first (that's what we fall back to), then the most requested ones.
+    // Out of range entries must be ignored.
+    CPPUNIT_ASSERT_EQUAL((size_t)5u, tilesToLoad.size());
+    CPPUNIT_ASSERT_EQUAL(VirtualTextureTile::pack(0u, 0u, 2u), tilesToLoad[0]);
+    CPPUNIT_ASSERT_EQUAL(VirtualTextureTile::pack(0u, 0u, 1u), tilesToLoad[1]);
+    CPPUNIT_ASSERT_EQUAL(VirtualTextureTile::pack(1u, 1u, 1u), tilesToLoad[2]);
+    CPPUNIT_ASSERT_EQUAL(VirtualTextureTile::pack(0u, 0u, 0u), tilesToLoad[3]);
+    CPPUNIT_ASSERT_EQUAL(VirtualTextureTile::pack(3u, 3u, 0u), tilesToLoad[4]);
+    CPPUNIT_ASSERT_EQUAL((size_t)5u, cache.getNumLoadingTiles());
+
+    // Tiles already loading must not be requested twice
+    tilesToLoad.clear();
+    cache.processFeedback(feedback, sizeof(feedback) / sizeof(feedback[0]));
+    cache.update(2u, 100u, tilesToLoad);
+    CPPUNIT_ASSERT(tilesToLoad.empty());
+
+    // Once resident, requesting a finer tile only needs that tile
+    uint32 evictedTileId;
+    for (size_t i = 0; i < 3u; ++i)
+        cache.notifyTileLoaded(VirtualTextureTile::pack(0u, 0u, 2u - i), 3u, evictedTileId);
+    cache.requestTile(VirtualTextureTile::pack(1u, 0u, 0u));
+    cache.requestTile(VirtualTextureTile::pack(1u, 1u, 0u));
+    cache.requestTile(VirtualTextureTile::pack(1u, 1u, 0u));
+    cache.update(3u, 1u, tilesToLoad);
+    CPPUNIT_ASSERT_EQUAL((size_t)1u, tilesToLoad.size());
+    CPPUNIT_ASSERT_EQUAL(VirtualTextureTile::pack(1u, 1u, 0u), tilesToLoad[0]);
+}
+//--------------------------------------------------------------------------
+void VirtualTextureTests::testLruEviction()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    VirtualTextureCache cache(4u, 4u, 0u, 3u, 3u);
+
+    const uint32 root = VirtualTextureTile::pack(0u, 0u, 2u);
+    const uint32 tileA = VirtualTextureTile::pack(0u, 0u, 1u);
+    const uint32 tileB = VirtualTextureTile::pack(1u, 0u, 1u);
+    const uint32 tileC = VirtualTextureTile::pack(0u, 1u, 1u);
+    const uint32 tileD = VirtualTextureTile::pack(1u, 1u, 1u);
+
+    uint32 evictedTileId;
+    CPPUNIT_ASSERT_EQUAL((uint32)0u, cache.notifyTileLoaded(root, 1u, evictedTileId));
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, cache.notifyTileLoaded(tileA, 1u, evictedTileId));
+    CPPUNIT_ASSERT_EQUAL((uint32)2u, cache.notifyTileLoaded(tileB, 1u, evictedTileId));
+    CPPUNIT_ASSERT_EQUAL(VirtualTextureTile::c_invalid, evictedTileId);
+
+    // Cache is full. A is the least recently used (the root is pinned)
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, cache.notifyTileLoaded(tileC, 2u, evictedTileId));
+    CPPUNIT_ASSERT_EQUAL(tileA, evictedTileId);
+    CPPUNIT_ASSERT(!cache.isResident(tileA));
+
+    // Using B makes C the least recently used
+    VirtualTextureCache::TileIdVec tilesToLoad;
+    cache.requestTile(tileB);
+    cache.update(3u, 100u, tilesToLoad);
+    CPPUNIT_ASSERT(tilesToLoad.empty());
+
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, cache.notifyTileLoaded(tileD, 3u, evictedTileId));
+    CPPUNIT_ASSERT_EQUAL(tileC, evictedTileId);
+
+    // Everything left was used this frame. Evicting would thrash
+    CPPUNIT_ASSERT_EQUAL(VirtualTextureTile::c_invalid,
+                         cache.notifyTileLoaded(VirtualTextureTile::pack(0u, 0u, 0u), 3u,
+                                                evictedTileId));
+    CPPUNIT_ASSERT(cache.isResident(root));
+    CPPUNIT_ASSERT(cache.isResident(tileB));
+    CPPUNIT_ASSERT(cache.isResident(tileD));
+    CPPUNIT_ASSERT_EQUAL((size_t)3u, cache.getNumResidentTiles());
+}
+//--------------------------------------------------------------------------
+void VirtualTextureTests::testIndirectionFallback()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    VirtualTextureCache cache(4u, 4u, 0u, 4u, 2u);
+
+    // Nothing resident: everything is 0 (nothing to sample)
+    CPPUNIT_ASSERT(cache.updateIndirection());
+    CPPUNIT_ASSERT(!cache.updateIndirection());
+    for (size_t i = 0; i < 16u; ++i)
+        CPPUNIT_ASSERT_EQUAL((uint32)0u, cache.getIndirection(0u)[i]);
+
+    uint32 evictedTileId;
+    cache.notifyTileLoaded(VirtualTextureTile::pack(0u, 0u, 2u), 1u, evictedTileId);
+    cache.notifyTileLoaded(VirtualTextureTile::pack(1u, 0u, 1u), 1u, evictedTileId);
+    CPPUNIT_ASSERT(cache.updateIndirection());
+
+    // Slot 0 = (0, 0) mip 2; slot 1 = (1, 0) mip 1
+    const uint32 rootEntry = 0xFF020000u;
+    const uint32 tileEntry = 0xFF010001u;
+
+    CPPUNIT_ASSERT_EQUAL(rootEntry, cache.getIndirection(2u)[0]);
+    CPPUNIT_ASSERT_EQUAL(rootEntry, cache.getIndirection(1u)[0]);
+    CPPUNIT_ASSERT_EQUAL(tileEntry, cache.getIndirection(1u)[1]);
+    // Mip 0 falls back to the closest resident ancestor
+    CPPUNIT_ASSERT_EQUAL(tileEntry, cache.getIndirection(0u)[1u * 4u + 3u]);
+    CPPUNIT_ASSERT_EQUAL(rootEntry, cache.getIndirection(0u)[3u * 4u + 0u]);
+
+    cache.clear();
+    CPPUNIT_ASSERT(cache.updateIndirection());
+    CPPUNIT_ASSERT_EQUAL((uint32)0u, cache.getIndirection(2u)[0]);
+    CPPUNIT_ASSERT_EQUAL((uint32)0u, cache.getIndirection(0u)[1u * 4u + 3u]);
+}
@@ -41,8 +41,10 @@ struct UpgradeOptions
     bool halfPos;
     bool halfTexCoords;
     bool qTangents;
+    bool octahedralNormals;
     bool optimizeForShadowMapping;
     bool stripShadowMapping;
+    bool optimizeVertexCache;
 };
 
 extern UpgradeOptions opts;
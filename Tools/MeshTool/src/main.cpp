@@ -39,6 +39,7 @@ THE SOFTWARE.
 
 #include "OgreMeshManager2.h"
 #include "OgreMesh2.h"
+#include "OgreMeshOptimizer.h"
 
 #include "UpgradeOptions.h"
 
@@ -100,17 +101,23 @@ void help()
     cout << "-E endian  = Set endian mode 'big' 'little' or 'native' (default)" << endl;
     cout << "-b         = Recalculate bounding box (static meshes only)" << endl;
     cout << "-V version = Specify OGRE version format to write instead of latest" << endl;
-    cout << "             Options are: 2.1, 1.10, 1.8, 1.7, 1.4, 1.0" << endl;
+    cout << "             Options are: 2.1, 2.1flat, 1.10, 1.8, 1.7, 1.4, 1.0" << endl;
+    cout << "             2.1flat is a v2 only format (implies -v2) that loads without parsing," << endl;
+    cout << "             but can only be read on machines with the same endianness." << endl;
     cout << "-v2          Export the mesh as a v2 object. Keeps the original format otherwise." << endl;
     cout << "             Use this format if you load the mesh by the SceneManager::createItem() method." << endl;
     cout << "-v1          Export the mesh as a v1 object. Keeps the original format otherwise." << endl;
     cout << "             Use this if you load the mesh by the SceneManager::createEntity() method or if you import from v1 to v2 at runtime." << endl;
-    cout << "-O puqs    = Optimize vertex buffers for shaders." << endl;
+    cout << "-O puqos   = Optimize vertex buffers for shaders." << endl;
     cout << "             p converts POSITION to 16-bit floats" << endl;
     cout << "             q converts normal tangent and bitangent (28-36 bytes) to QTangents (8 bytes)." << endl;
     cout << "             u converts UVs to 16-bit floats." << endl;
+    cout << "             o converts normals not turned into QTangents to octahedral (12 bytes -> 4 bytes). v2 only." << endl;
     cout << "             s make shadow mapping passes have their own optimized buffers. Overrides existing ones if any." << endl;
     cout << "             S strips the buffers for shadow mapping (consumes less space and memory)." << endl;
+    cout << "-c         = Reorders triangles & vertices of v2 meshes for the vertex cache, overdraw" << endl;
+    cout << "             and vertex fetch, and removes duplicated vertices. Prints ACMR/ATVR" << endl;
+    cout << "             (average vertex shader invocations per triangle/vertex) before & after." << endl;
     cout << "-U         = Performs the opposite of -O puq: Converts 16-bit half to to float and " << endl;
     cout << "             converts QTangents to Normal + Tangent + Reflection. Needed by many" << endl;
     cout << "             other options that have to read from position, normals or UVs." << endl;
@@ -124,7 +131,7 @@ void help()
     cout << "Recommended params for GLES2 (w/ normal mapping):" << endl;
     cout << "   OgreMeshTool -e -t -ts 4 -O qs sourcefile [destfile]" << endl;
     cout << "Recommended params for modern DESKTOP (w/out normal mapping):" << endl;
-    cout << "   OgreMeshTool -e -O puqs sourcefile [destfile]" << endl;
+    cout << "   OgreMeshTool -e -O puqos sourcefile [destfile]" << endl;
     cout << "Recommended params for GLES2 (w/out normal mapping):" << endl;
     cout << "   OgreMeshTool -e -O qs sourcefile [destfile]" << endl;
 
@@ -168,8 +175,10 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     opts.halfPos        = false;
     opts.halfTexCoords  = false;
     opts.qTangents      = false;
+    opts.octahedralNormals = false;
     opts.optimizeForShadowMapping = false;
     opts.stripShadowMapping = false;
+    opts.optimizeVertexCache = false;
 
 
     UnaryOptionList::iterator ui = unOpts.find("-e");
@@ -310,6 +319,12 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
             opts.targetVersion  = v1::MESH_VERSION_2_1;
             opts.targetVersionV2= MESH_VERSION_2_1;
         }
+        else if (bi->second == "2.1flat")
+        {
+            opts.targetVersionV2= MESH_VERSION_2_1_FLAT;
+            opts.exportAsV2     = true;
+            opts.exportAsV1     = false;
+        }
 
         if( !opts.exportAsV2 )
         {
@@ -350,6 +365,9 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     ui = unOpts.find("-O");
     opts.optimizeBuffer = ui->second;
 
+    ui = unOpts.find("-c");
+    opts.optimizeVertexCache = ui->second;
+
     bi = binOpts.find("-O");
     if( !bi->second.empty() )
     {
@@ -359,6 +377,8 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
             opts.halfTexCoords = true;
         if( bi->second.find( 'q' ) != String::npos )
             opts.qTangents = true;
+        if( bi->second.find( 'o' ) != String::npos )
+            opts.octahedralNormals = true;
         if( bi->second.find( 's' ) != String::npos )
             opts.optimizeForShadowMapping = true;
         if( bi->second.find( 'S' ) != String::npos )
@@ -1038,6 +1058,23 @@ bool loadMesh( const String &source, v1::MeshPtr &v1MeshPtr, MeshPtr &v2MeshPtr,
     return retVal;
 }
 
+void optimizeVertexCache( MeshPtr &v2Mesh )
+{
+    cout << "Optimizing for the vertex cache..." << endl;
+
+    // Keep the shadow mapping buffers the way they were
+    Mesh::msOptimizeForShadowMapping = v2Mesh->hasIndependentShadowMappingVaos();
+
+    MeshOptimizer::VertexCacheStats before, after;
+    MeshOptimizer::optimize( v2Mesh.get(), MeshOptimizer::OptimizeAll, &before, &after );
+
+    Mesh::msOptimizeForShadowMapping = false;
+
+    cout << "  Vertices: " << before.numVertices << " -> " << after.numVertices << endl;
+    cout << "  ACMR: " << before.getAcmr() << " -> " << after.getAcmr() << endl;
+    cout << "  ATVR: " << before.getAtvr() << " -> " << after.getAtvr() << endl;
+}
+
 void saveMesh( const String &destination, v1::MeshPtr &v1Mesh, MeshPtr &v2Mesh,
                v1::SkeletonPtr &v1Skeleton,
                Ogre::MeshSerializer &meshSerializer2, v1::XMLMeshSerializer &xmlMeshSerializer,
@@ -1074,8 +1111,17 @@ void saveMesh( const String &destination, v1::MeshPtr &v1Mesh, MeshPtr &v2Mesh,
             }
 
             if( v1Mesh )
+            {
                 v2Mesh->importV1( v1Mesh.get(), false, false, false );
 
+                // v1 meshes don't support octahedral normals, convert them now
+                if( opts.optimizeBuffer && opts.octahedralNormals )
+                    v2Mesh->arrangeEfficient( false, false, false, true );
+            }
+
+            if( opts.optimizeVertexCache )
+                optimizeVertexCache( v2Mesh );
+
             cout << "Saving as a v2 mesh..." << endl;
             meshSerializer2.exportMesh( v2Mesh.get(), destination, opts.targetVersionV2, opts.endian );
         }
@@ -1225,6 +1271,7 @@ int main(int numargs, char** args)
         unOptList["-b"] = false;
         unOptList["-O"] = false;
         unOptList["-U"] = false;
+        unOptList["-c"] = false;
         unOptList["-v1"]= false;
         unOptList["-v2"]= false;
         binOptList["-l"] = "";
@@ -1325,7 +1372,10 @@ int main(int numargs, char** args)
             if( v1Mesh )
                 mesh->arrangeEfficient( opts.halfPos, opts.halfTexCoords, opts.qTangents );
             if( v2Mesh )
-                v2Mesh->arrangeEfficient( opts.halfPos, opts.halfTexCoords, opts.qTangents );
+            {
+                v2Mesh->arrangeEfficient( opts.halfPos, opts.halfTexCoords, opts.qTangents,
+                                          opts.octahedralNormals );
+            }
         }
 
         if (opts.recalcBounds)